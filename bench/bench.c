@@ -0,0 +1,355 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module measures the cost of the control loop hot paths on a Cortex-M3 under QEMU 
+   (see tools/bench.py).  The modules are the firmware sources, built with soft-float as on the 
+   PSoC5LP; hal.c stands in for the hardware and the modules which are not benchmarked.
+
+   The result of each benchmark is the average number of instructions per call measured with the 
+   icount clock of QEMU (see target.c).  QEMU does not model wait states or multi-cycle instructions,
+   so the counts are a lower bound of the cycles on the target and are meant for comparison against
+   a baseline rather than against 'config bench'.  The counts include a few instructions of loop
+   overhead per call.
+
+   Output: one JSON object per line, i.e., the calibration, a line per benchmark and a final line:
+
+       {"calibration":{"ticks":<ticks per TARGET_NOPS_DIFF instructions>}}
+       {"bench":"<name>","calls":<calls>,"insns":<instructions per call>}
+       {"done":<number of benchmarks>}
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "freesoc.h"
+#include "consts.h"
+#include "utils.h"
+#include "pid_controller.h"
+#include "pidbank.h"
+#include "caltable.h"
+#include "encoder.h"
+#include "odom.h"
+#include "conparser.h"
+#include "hal.h"
+#include "target.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define BENCH_NUM_CALLS         (256)
+#define BENCH_NUM_PARSES        (32)
+#define BENCH_NUM_CALIBRATIONS  (64)
+#define BENCH_MAX_LINE_LEN      (80)
+
+/* The inputs of a benchmark cycle through a table so that the branches of a function are exercised */
+#define BENCH_NUM_INPUTS        (16)
+#define BENCH_INPUT_MASK        (BENCH_NUM_INPUTS - 1)
+
+#define BENCH_ENC_SAMPLE_MS     ((UINT32) SAMPLE_TIME_MS(ENC_SAMPLE_RATE))
+#define BENCH_ODOM_SAMPLE_MS    ((UINT32) SAMPLE_TIME_MS(ODOM_SAMPLE_RATE))
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef void (*BENCH_FUNC_TYPE)(UINT16 num_calls);
+
+typedef struct _bench_tag
+{
+    CHAR const * const name;
+    BENCH_FUNC_TYPE run;
+    UINT16 num_calls;
+} BENCH_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static PIDControl pid;
+static MOVING_AVERAGE_FLOAT_TYPE moving_average;
+static FLOAT cps_inputs[BENCH_NUM_INPUTS];
+static FLOAT velocity_inputs[BENCH_NUM_INPUTS];
+static FLOAT heading_inputs[BENCH_NUM_INPUTS];
+
+static const CHAR parse_lines[][BENCH_MAX_LINE_LEN] = {
+    "motor --left-speed=0.2 --right-speed=-0.2 --duration=1.0",
+    "config rate --pid-rate=200 --save",
+    "pid tune left --rule=tl",
+    "motion val square left",
+};
+#define BENCH_NUM_PARSE_LINES   (sizeof(parse_lines) / sizeof(parse_lines[0]))
+
+/* Keeps the benchmark calculations from being optimized away */
+static volatile FLOAT bench_sink;
+static volatile PWM_TYPE bench_pwm;
+static volatile CONPARSER_RESULT_TYPE bench_result;
+
+/*---------------------------------------------------------------------------------------------------
+ * Benchmarks
+ *-------------------------------------------------------------------------------------------------*/
+
+/* The wheel controller of pid_controller.c */
+static void BenchPidCompute(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        PIDSetpointSet(&pid, cps_inputs[ii & BENCH_INPUT_MASK]);
+        PIDInputSet(&pid, cps_inputs[(ii + 1) & BENCH_INPUT_MASK]);
+        PIDCompute(&pid);
+    }
+    bench_sink = PIDOutputGet(&pid);
+}
+
+/* The inner loop as run by Pid_Update, i.e., both wheel controllers through Cal_CpsToPwm */
+static void BenchPidBankInner(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        PidBank_Process(PID_LOOP_INNER);
+    }
+}
+
+static void BenchMovingAverage(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        bench_sink = MovingAverageFloat(&moving_average, cps_inputs[ii & BENCH_INPUT_MASK]);
+    }
+}
+
+static void BenchUniToDiff(UINT16 num_calls)
+{
+    UINT16 ii;
+    FLOAT left;
+    FLOAT right;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        UniToDiff(velocity_inputs[ii & BENCH_INPUT_MASK], velocity_inputs[(ii + 1) & BENCH_INPUT_MASK], &left, &right);
+        bench_sink = left + right;
+    }
+}
+
+static void BenchDiffToUni(UINT16 num_calls)
+{
+    UINT16 ii;
+    FLOAT linear;
+    FLOAT angular;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        DiffToUni(velocity_inputs[ii & BENCH_INPUT_MASK], velocity_inputs[(ii + 1) & BENCH_INPUT_MASK], &linear, &angular);
+        bench_sink = linear + angular;
+    }
+}
+
+static void BenchNormalizeHeading(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        bench_sink = NormalizeHeading(heading_inputs[ii & BENCH_INPUT_MASK]);
+    }
+}
+
+/* The table path of Cal_CpsToPwm */
+static void BenchCalTable(UINT16 num_calls)
+{
+    CAL_TABLE_EVAL_TYPE *p_table = Hal_GetMotorTable();
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        bench_pwm = CalTable_CpsToPwm(p_table, (INT16) cps_inputs[ii & BENCH_INPUT_MASK]);
+    }
+}
+
+/* The sample path of Cal_CpsToPwm, i.e., CpsToPwm in cal.c */
+static void BenchCalSamples(UINT16 num_calls)
+{
+    CAL_DATA_TYPE *p_data = Hal_GetMotorData();
+    UINT16 ii;
+    INT16 cps;
+    UINT8 lower;
+    UINT8 upper;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        cps = constrain((INT16) cps_inputs[ii & BENCH_INPUT_MASK], p_data->cps_min, p_data->cps_max);
+        BinaryRangeSearch(cps, &p_data->cps_data[0], CAL_DATA_SIZE, &lower, &upper);
+        bench_pwm = Interpolate(cps, p_data->cps_data[lower], p_data->cps_data[upper], p_data->pwm_data[lower], p_data->pwm_data[upper]);
+    }
+}
+
+/* Every call samples the encoders */
+static void BenchEncoderUpdate(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        Hal_Advance(BENCH_ENC_SAMPLE_MS);
+        Encoder_Update();
+    }
+}
+
+/* Every call updates the pose */
+static void BenchOdomUpdate(UINT16 num_calls)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        Hal_Advance(BENCH_ODOM_SAMPLE_MS);
+        Odom_Update();
+    }
+}
+
+/* A console line, including the copy of the line which the parser modifies */
+static void BenchParser(UINT16 num_calls)
+{
+    CHAR line[BENCH_MAX_LINE_LEN];
+    DocoptArgs args;
+    UINT16 ii;
+    
+    for (ii = 0; ii < num_calls; ++ii)
+    {
+        strcpy(line, parse_lines[ii % BENCH_NUM_PARSE_LINES]);
+        bench_result = ConParser_Parse(line, &args);
+    }
+}
+
+static const BENCH_TYPE benchmarks[] = {
+    /* name                 run                     calls */
+    {"pid_compute",         BenchPidCompute,        BENCH_NUM_CALLS},
+    {"pidbank_inner",       BenchPidBankInner,      BENCH_NUM_CALLS},
+    {"moving_average",      BenchMovingAverage,     BENCH_NUM_CALLS},
+    {"uni_to_diff",         BenchUniToDiff,         BENCH_NUM_CALLS},
+    {"diff_to_uni",         BenchDiffToUni,         BENCH_NUM_CALLS},
+    {"normalize_heading",   BenchNormalizeHeading,  BENCH_NUM_CALLS},
+    {"cal_table",           BenchCalTable,          BENCH_NUM_CALLS},
+    {"cal_samples",         BenchCalSamples,        BENCH_NUM_CALLS},
+    {"encoder_update",      BenchEncoderUpdate,     BENCH_NUM_CALLS},
+    {"odom_update",         BenchOdomUpdate,        BENCH_NUM_CALLS},
+    {"parser",              BenchParser,            BENCH_NUM_PARSES},
+};
+#define BENCH_NUM_BENCHMARKS    (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Setup
+ * Description: Initializes the modules as main.c does and fills the input tables.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Setup()
+{
+    UINT8 ii;
+    
+    Hal_Init();
+    
+    Encoder_Init();
+    Odom_Init();
+    PidBank_Init();
+    
+    Encoder_Start();
+    Odom_Start();
+    PidBank_Start();
+    
+    /* Note: the encoders are sampled once so that the wheel controllers see a speed */
+    Hal_Advance(BENCH_ENC_SAMPLE_MS);
+    Encoder_Update();
+    
+    PIDInit(&pid, 1.5, 4.0, 0.05, 1.0, SAMPLE_TIME_SEC(PID_SAMPLE_RATE), 0.0, 4000.0, AUTOMATIC, DIRECT, NULL);
+    
+    moving_average.n = 5;
+    moving_average.last = 0;
+    
+    for (ii = 0; ii < BENCH_NUM_INPUTS; ++ii)
+    {
+        cps_inputs[ii] = -2000.0 + 4000.0 * ii / (BENCH_NUM_INPUTS - 1);
+        velocity_inputs[ii] = -0.5 + 1.0 * ii / (BENCH_NUM_INPUTS - 1);
+        heading_inputs[ii] = -3.0 * PI + 6.0 * PI * ii / (BENCH_NUM_INPUTS - 1);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Calibrate
+ * Description: Measures the ticks of TARGET_NOPS_DIFF instructions (see target.c).
+ * Parameters: None
+ * Return: UINT32 - the ticks of BENCH_NUM_CALIBRATIONS times TARGET_NOPS_DIFF instructions
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT32 Calibrate()
+{
+    UINT32 start;
+    UINT32 short_ticks;
+    UINT32 long_ticks;
+    UINT8 ii;
+    
+    start = Target_Ticks();
+    for (ii = 0; ii < BENCH_NUM_CALIBRATIONS; ++ii)
+    {
+        Target_ShortNops();
+    }
+    short_ticks = Target_Ticks() - start;
+    
+    start = Target_Ticks();
+    for (ii = 0; ii < BENCH_NUM_CALIBRATIONS; ++ii)
+    {
+        Target_LongNops();
+    }
+    long_ticks = Target_Ticks() - start;
+    
+    return long_ticks - short_ticks;
+}
+
+int main(void)
+{
+    CHAR line[BENCH_MAX_LINE_LEN];
+    BENCH_TYPE const *p_bench;
+    UINT32 calibration;
+    UINT32 start;
+    UINT32 elapsed;
+    UINT32 insns;
+    UINT8 ii;
+    
+    Setup();
+    
+    calibration = Calibrate();
+    snprintf(line, sizeof line, "{\"calibration\":{\"ticks\":%lu}}\n", 
+             (unsigned long) (calibration / BENCH_NUM_CALIBRATIONS));
+    Target_Write(line);
+    
+    for (ii = 0; ii < BENCH_NUM_BENCHMARKS; ++ii)
+    {
+        p_bench = &benchmarks[ii];
+        
+        start = Target_Ticks();
+        p_bench->run(p_bench->num_calls);
+        elapsed = Target_Ticks() - start;
+        
+        /* instructions = ticks * instructions per tick, rounded */
+        insns = (UINT32) (((uint64_t) elapsed * TARGET_NOPS_DIFF * BENCH_NUM_CALIBRATIONS + 
+                           (uint64_t) calibration * p_bench->num_calls / 2) / 
+                          ((uint64_t) calibration * p_bench->num_calls));
+        
+        snprintf(line, sizeof line, "{\"bench\":\"%s\",\"calls\":%u,\"insns\":%lu}\n", 
+                 p_bench->name, p_bench->num_calls, (unsigned long) insns);
+        Target_Write(line);
+    }
+    
+    snprintf(line, sizeof line, "{\"done\":%u}\n", (unsigned) BENCH_NUM_BENCHMARKS);
+    Target_Write(line);
+    
+    return 0;
+}
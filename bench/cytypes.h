@@ -0,0 +1,18 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: The benchmark build stands in for the PSoC Creator generated cytypes.h.  Only the 
+   fixed width types are needed by the modules that are benchmarked (see bench.c).
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef CYTYPES_H
+#define CYTYPES_H
+
+#include <stdint.h>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+
+#endif
@@ -0,0 +1,274 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module stands in for the hardware and for the modules that are not benchmarked.
+   The calibration is a forward table with a deadband of 40 pwm whose response flattens towards full
+   speed (the same shape as test_caltable.c), used for both wheels and both directions.
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "hal.h"
+#include "cal.h"
+#include "control.h"
+#include "motor.h"
+#include "debug.h"
+#include "serial.h"
+#include "assertion.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define HAL_CAL_DOMAIN          (500)
+#define HAL_CAL_DEADBAND        (40)
+
+/* Wheel counts per millisecond, i.e., about 0.3 m/s with a slight curve to the left */
+#define HAL_LEFT_COUNT_PER_MS   (1)
+#define HAL_RIGHT_COUNT_PER_MS  (2)
+
+/* Wheel speed targets (count/sec) and robot velocity targets of the controllers */
+#define HAL_LEFT_TARGET_CPS     (1200.0)
+#define HAL_RIGHT_TARGET_CPS    (1500.0)
+#define HAL_LINEAR_TARGET       (0.3)
+#define HAL_ANGULAR_TARGET      (0.2)
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static UINT32 hal_millis;
+static INT32 left_count;
+static INT32 right_count;
+
+static CAL_DATA_TYPE motor_data;
+static CAL_TABLE_TYPE motor_table;
+static CAL_TABLE_EVAL_TYPE motor_eval;
+
+static CAL_PID_TYPE pid_gains = {1.5, 4.0, 0.05, 1.0};
+static CAL_PID_SCHED_TYPE pid_schedule;
+static CAL_MOTOR_MODEL_TYPE motor_model;
+
+/* Keeps the outputs of the controllers from being optimized away */
+static volatile PWM_TYPE hal_pwm;
+static volatile FLOAT hal_sink;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Hal_Init
+ * Description: Builds the calibration table and resets the simulated time and wheel counts.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Hal_Init()
+{
+    UINT8 ii;
+    UINT16 offset;
+    
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        offset = CalTable_SampleOffset(ii, HAL_CAL_DOMAIN);
+        motor_data.pwm_data[ii] = PWM_STOP + offset;
+        motor_data.cps_data[ii] = offset < HAL_CAL_DEADBAND ? 0 : (INT16) ((offset - HAL_CAL_DEADBAND) * (1000 - offset) / 100);
+    }
+    motor_data.cps_min = motor_data.cps_data[0];
+    motor_data.cps_max = motor_data.cps_data[CAL_NUM_SAMPLES - 1];
+    
+    CalTable_Compress(&motor_data, &motor_table);
+    CalTable_Decode(&motor_table, &motor_eval);
+    
+    memset(&pid_schedule, 0, sizeof pid_schedule);
+    memset(&motor_model, 0, sizeof motor_model);
+    
+    hal_millis = 0;
+    left_count = 0;
+    right_count = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Hal_Advance
+ * Description: Advances the simulated time and the wheel counts.
+ * Parameters: milliseconds - the time to advance
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Hal_Advance(UINT32 milliseconds)
+{
+    hal_millis += milliseconds;
+    left_count += HAL_LEFT_COUNT_PER_MS * milliseconds;
+    right_count += HAL_RIGHT_COUNT_PER_MS * milliseconds;
+}
+
+CAL_DATA_TYPE* Hal_GetMotorData()
+{
+    return &motor_data;
+}
+
+CAL_TABLE_EVAL_TYPE* Hal_GetMotorTable()
+{
+    return &motor_eval;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Time, Components
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 millis()
+{
+    return hal_millis;
+}
+
+UINT32 micros()
+{
+    return hal_millis * 1000;
+}
+
+void CyDelay(uint32 milliseconds)
+{
+    Hal_Advance(milliseconds);
+}
+
+int32 Left_QuadDec_GetCounter(void)
+{
+    return left_count;
+}
+
+void Left_QuadDec_SetCounter(int32 value)
+{
+    left_count = value;
+}
+
+void Left_QuadDec_Start(void)
+{
+}
+
+int32 Right_QuadDec_GetCounter(void)
+{
+    return right_count;
+}
+
+void Right_QuadDec_SetCounter(int32 value)
+{
+    right_count = value;
+}
+
+void Right_QuadDec_Start(void)
+{
+}
+
+void Diag_Pin_Write(uint8 value)
+{
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Control, Motor
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Control_LeftGetCmdVelocityCps()
+{
+    return HAL_LEFT_TARGET_CPS;
+}
+
+FLOAT Control_RightGetCmdVelocityCps()
+{
+    return HAL_RIGHT_TARGET_CPS;
+}
+
+FLOAT Control_GetCmdLinearVelocity()
+{
+    return HAL_LINEAR_TARGET;
+}
+
+FLOAT Control_GetCmdAngularVelocity()
+{
+    return HAL_ANGULAR_TARGET;
+}
+
+void Control_SetLinearCorrection(FLOAT correction)
+{
+    hal_sink = correction;
+}
+
+void Control_SetAngularCorrection(FLOAT correction)
+{
+    hal_sink = correction;
+}
+
+void Control_WriteOdom(FLOAT linear, FLOAT angular, FLOAT left_dist, FLOAT right_dist, FLOAT heading)
+{
+    hal_sink = heading;
+}
+
+void Motor_LeftSetPwm(PWM_TYPE pwm)
+{
+    hal_pwm = pwm;
+}
+
+void Motor_RightSetPwm(PWM_TYPE pwm)
+{
+    hal_pwm = pwm;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Calibration
+ *-------------------------------------------------------------------------------------------------*/
+
+/* Note: Cal_CpsToPwm takes the table path of cal.c, i.e., the path of a calibrated robot */
+PWM_TYPE Cal_CpsToPwm(WHEEL_TYPE wheel, FLOAT cps)
+{
+    PWM_TYPE pwm = PWM_STOP;
+    
+    if ((INT16) cps != 0)
+    {
+        pwm = CalTable_CpsToPwm(&motor_eval, (INT16) cps);
+        pwm = constrain(pwm, MIN_PWM_VALUE, MAX_PWM_VALUE);
+    }
+    
+    return pwm;
+}
+
+UINT16 Cal_GetCalibrationStatusBit(UINT16 bit)
+{
+    return bit == CAL_MOTOR_BIT || bit == CAL_PID_BIT;
+}
+
+CAL_PID_TYPE* Cal_GetPidGains(PID_ENUM_TYPE pid)
+{
+    return &pid_gains;
+}
+
+CAL_PID_SCHED_TYPE* Cal_GetPidSchedule(PID_ENUM_TYPE pid)
+{
+    return &pid_schedule;
+}
+
+BOOL Cal_IsPidScheduleValid(CAL_PID_SCHED_TYPE* const sched)
+{
+    return FALSE;
+}
+
+CAL_MOTOR_MODEL_TYPE* Cal_GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir)
+{
+    return &motor_model;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Debug, Serial, Assertion
+ *-------------------------------------------------------------------------------------------------*/
+UINT16 Debug_IsEnabled(UINT16 flag)
+{
+    return 0;
+}
+
+void Ser_PutString(CHAR const * const str)
+{
+}
+
+void Ser_PutStringFormat(CHAR const * const fmt, ...)
+{
+}
+
+void assertion(UINT8 test, char* const msg, char* const file, int line)
+{
+}
@@ -0,0 +1,25 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module stands in for the hardware and for the modules that are not benchmarked,
+   so that the hot paths of the firmware run unchanged on a Cortex-M3 under QEMU (see bench.c).  The
+   robot drives at a constant speed: each millisecond of simulated time advances the wheel counts.
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef HAL_H
+#define HAL_H
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+#include "calstore.h"
+#include "caltable.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Hal_Init();
+void Hal_Advance(UINT32 milliseconds);
+CAL_DATA_TYPE* Hal_GetMotorData();
+CAL_TABLE_EVAL_TYPE* Hal_GetMotorTable();
+
+#endif
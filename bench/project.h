@@ -0,0 +1,25 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: The benchmark build stands in for the PSoC Creator generated project.h.  It declares 
+   the component API called by the modules that are benchmarked; hal.c implements it.
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <string.h>
+#include "cytypes.h"
+
+#define CYDEV_EE_BASE (0x40008000u)
+
+void CyDelay(uint32 milliseconds);
+
+int32 Left_QuadDec_GetCounter(void);
+void Left_QuadDec_SetCounter(int32 value);
+void Left_QuadDec_Start(void);
+int32 Right_QuadDec_GetCounter(void);
+void Right_QuadDec_SetCounter(int32 value);
+void Right_QuadDec_Start(void);
+
+void Diag_Pin_Write(uint8 value);
+
+#endif
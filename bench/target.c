@@ -0,0 +1,190 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module is the bare-metal runtime of the benchmark on the QEMU lm3s6965evb machine.
+
+   Ticks: The system tick runs from the processor clock and counts down from its 24-bit reload value;
+   the tick interrupt extends it to 32 bits.  Under 'qemu -icount' the processor clock advances by a
+   fixed time per instruction, so ticks are proportional to instructions executed.  The ratio depends
+   on the icount shift and the clock of the machine and is measured by bench.c with the two nop 
+   sequences below, which differ by exactly TARGET_NOPS_DIFF instructions.
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "target.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define SYST_CSR                (*(volatile UINT32 *) 0xE000E010)
+#define SYST_RVR                (*(volatile UINT32 *) 0xE000E014)
+#define SYST_CVR                (*(volatile UINT32 *) 0xE000E018)
+
+#define SYST_CSR_ENABLE         (0x00000001)
+#define SYST_CSR_TICKINT        (0x00000002)
+#define SYST_CSR_CLKSOURCE      (0x00000004)
+#define SYST_RELOAD             (0x00FFFFFF)
+#define SYST_BITS               (24)
+
+#define SEMIHOST_SYS_WRITE0     (0x04)
+#define SEMIHOST_SYS_EXIT       (0x18)
+#define SEMIHOST_APP_EXIT       (0x20026)
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+/* Defined by lm3s6965.ld */
+extern UINT32 _sidata;
+extern UINT32 _sdata;
+extern UINT32 _edata;
+extern UINT32 _sbss;
+extern UINT32 _ebss;
+extern UINT32 _estack;
+
+static volatile UINT32 tick_wraps;
+
+/*---------------------------------------------------------------------------------------------------
+ * Prototypes
+ *-------------------------------------------------------------------------------------------------*/
+int main(void);
+void Reset_Handler(void);
+void SysTick_Handler(void);
+void Fault_Handler(void);
+
+/*---------------------------------------------------------------------------------------------------
+ * Vector Table
+ *-------------------------------------------------------------------------------------------------*/
+__attribute__ ((section(".isr_vector"), used))
+static void (* const vector_table[])(void) = {
+    (void (*)(void)) &_estack,
+    Reset_Handler,
+    Fault_Handler,      /* NMI */
+    Fault_Handler,      /* Hard fault */
+    Fault_Handler,      /* Memory management fault */
+    Fault_Handler,      /* Bus fault */
+    Fault_Handler,      /* Usage fault */
+    0, 0, 0, 0,
+    Fault_Handler,      /* SVCall */
+    Fault_Handler,      /* Debug monitor */
+    0,
+    Fault_Handler,      /* PendSV */
+    SysTick_Handler,
+};
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Semihost
+ * Description: Makes a semihosting call to the host (QEMU -semihosting).
+ * Parameters: op - the operation
+ *             arg - the argument of the operation
+ * Return: UINT32 - the result of the operation
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT32 Semihost(UINT32 op, UINT32 arg)
+{
+    register UINT32 r0 __asm__ ("r0") = op;
+    register UINT32 r1 __asm__ ("r1") = arg;
+    
+    __asm__ volatile ("bkpt 0xab" : "+r" (r0) : "r" (r1) : "memory");
+    
+    return r0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Reset_Handler
+ * Description: Initializes the data and bss sections, starts the system tick and runs the benchmark.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Reset_Handler(void)
+{
+    UINT32 *src = &_sidata;
+    UINT32 *dst;
+    
+    for (dst = &_sdata; dst < &_edata; )
+    {
+        *dst++ = *src++;
+    }
+    for (dst = &_sbss; dst < &_ebss; )
+    {
+        *dst++ = 0;
+    }
+    
+    SYST_RVR = SYST_RELOAD;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_ENABLE | SYST_CSR_TICKINT | SYST_CSR_CLKSOURCE;
+    
+    main();
+    Target_Exit();
+}
+
+void SysTick_Handler(void)
+{
+    tick_wraps++;
+}
+
+/* Note: A fault ends the run; bench.py reports the benchmarks which did not complete */
+void Fault_Handler(void)
+{
+    Target_Write("{\"fault\":1}\n");
+    Target_Exit();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Target_Ticks
+ * Description: Returns the 32-bit tick count.  The wrap count is re-read in case the tick interrupt
+ *              occurs between the reads (see micros in time.c).
+ * Parameters: None
+ * Return: UINT32 - ticks (see the module description)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 Target_Ticks()
+{
+    UINT32 wraps;
+    UINT32 value;
+    
+    do
+    {
+        wraps = tick_wraps;
+        value = SYST_CVR;
+    } while (wraps != tick_wraps);
+    
+    return (wraps << SYST_BITS) + (SYST_RELOAD - value);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Target_ShortNops/Target_LongNops
+ * Description: Execute 24 and 1024 nops respectively, i.e., TARGET_NOPS_DIFF apart, so that the call
+ *              and return cancel when the ticks of the two are subtracted.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+__attribute__ ((naked, noinline))
+void Target_ShortNops()
+{
+    __asm__ volatile (".rept 24\n\tnop\n\t.endr\n\tbx lr");
+}
+
+__attribute__ ((naked, noinline))
+void Target_LongNops()
+{
+    __asm__ volatile (".rept 1024\n\tnop\n\t.endr\n\tbx lr");
+}
+
+void Target_Write(CHAR const * const str)
+{
+    Semihost(SEMIHOST_SYS_WRITE0, (UINT32) str);
+}
+
+void Target_Exit()
+{
+    Semihost(SEMIHOST_SYS_EXIT, SEMIHOST_APP_EXIT);
+    for (;;)
+    {
+    }
+}
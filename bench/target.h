@@ -0,0 +1,30 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module is the bare-metal runtime of the benchmark on the QEMU lm3s6965evb 
+   machine (a Cortex-M3 like the PSoC5LP): the vector table, the startup code, a tick counter driven 
+   by the system tick and output through semihosting.
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef TARGET_H
+#define TARGET_H
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* The difference in length of the two calibration sequences (see Target_ShortNops/Target_LongNops) */
+#define TARGET_NOPS_DIFF    (1000)
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 Target_Ticks();
+void Target_ShortNops();
+void Target_LongNops();
+void Target_Write(CHAR const * const str);
+void Target_Exit();
+
+#endif
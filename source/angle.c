@@ -0,0 +1,536 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides single-precision and fixed-point angle math which is cheap on a
+   processor without an FPU.
+   
+   The heading math previously used the double-precision libm functions (PI is a double) and wrapped
+   angles with a division.  On the Cortex-M3 every one of those is a soft-float library call.  Here:
+   
+       Angle_Wrap     - wraps to (-PI, PI] with a compare and subtract; the division is only used when the
+                        angle is more than one revolution out, which a heading updated every sample never is.
+       Angle_SinCos   - reduces to +/-PI/4 and evaluates the Cephes single-precision polynomials.  The error
+                        is within a few float ulps (< 2e-6).
+       Angle_Atan2    - reduces to an octant and evaluates the Abramowitz & Stegun 4.4.49 polynomial.  The
+                        error is about 1e-5 rad.
+       
+   The fixed-point functions work in binary angles (brads, 65536 per revolution) where wrapping is the
+   natural integer overflow:
+   
+       Angle_SinQ15   - a quarter-wave table of 65 entries with linear interpolation.  The error is less
+                        than 4 LSB (1.2e-4).
+       Angle_Atan2Brad - the octant reduced approximation atan(z) = PI/4 z + 0.273 z (1 - z).  The error is
+                        less than 0.004 rad (42 brads).
+   
+   Angle_Benchmark measures the cycles of each function against the libm function it replaces along with
+   the maximum error (see 'config bench').
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <math.h>
+#include "angle.h"
+#include "serial.h"
+#include "time.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define ANGLE_INV_TWOPI     (0.159154943f)
+#define ANGLE_TWO_OVER_PI   (0.636619772f)
+#define ANGLE_RAD_TO_BRAD   (10430.3784f)
+#define ANGLE_BRAD_TO_RAD   (9.58737992e-5f)
+
+/* PI/2 split into three parts so that the reduction (x - q * PI/2) does not lose precision (Cephes) */
+#define ANGLE_DP1 (1.5703125f)
+#define ANGLE_DP2 (4.83751296997070312e-4f)
+#define ANGLE_DP3 (7.54978995489188216e-8f)
+
+/* Brad quarter-wave table: 64 steps of 256 brads */
+#define ANGLE_SIN_TABLE_SHIFT   (8)
+#define ANGLE_SIN_TABLE_STEPS   (64)
+
+#define ANGLE_BENCH_NUM_SAMPLES (64)
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+/* sin(i * PI/128) in Q15, i = 0 .. 64 */
+static const INT16 sin_table[ANGLE_SIN_TABLE_STEPS + 1] = {
+        0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+     6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+    12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+    23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+    32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+    32767
+};
+
+/* Keeps the benchmark calculations from being optimized away */
+static volatile FLOAT bench_sink;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_Wrap
+ * Description: Wraps an angle to the range (-PI, PI].
+ * Parameters: angle - the angle (radian)
+ * Return: FLOAT - the wrapped angle (radian)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Angle_Wrap(FLOAT angle)
+{
+    /* Note: The common case is an angle that is in range or one revolution out */
+    if (angle > ANGLE_PI)
+    {
+        angle -= ANGLE_TWOPI;
+    }
+    else if (angle <= -ANGLE_PI)
+    {
+        angle += ANGLE_TWOPI;
+    }
+    else
+    {
+        return angle;
+    }
+    
+    if (angle > ANGLE_PI || angle <= -ANGLE_PI)
+    {
+        angle -= ANGLE_TWOPI * (FLOAT) (INT32) (angle * ANGLE_INV_TWOPI);
+        if (angle > ANGLE_PI)
+        {
+            angle -= ANGLE_TWOPI;
+        }
+        else if (angle <= -ANGLE_PI)
+        {
+            angle += ANGLE_TWOPI;
+        }
+    }
+    
+    return angle;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_Error
+ * Description: Returns the shortest signed angle from actual to target.
+ * Parameters: target - the target angle (radian)
+ *             actual - the actual angle (radian)
+ * Return: FLOAT - the error in the range (-PI, PI] (radian)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Angle_Error(FLOAT target, FLOAT actual)
+{
+    return Angle_Wrap(target - actual);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_IsReached
+ * Description: Determines if a rotation has reached (or just passed) the target angle.
+ * Parameters: target - the target angle (radian)
+ *             actual - the actual angle (radian)
+ *             sign - the direction of rotation: 1 for CCW, -1 for CW
+ *             tolerance - the amount the actual angle may be past the target (radian)
+ * Return: BOOL - TRUE if the target is reached; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Angle_IsReached(FLOAT target, FLOAT actual, INT8 sign, FLOAT tolerance)
+{
+    FLOAT past;
+    
+    past = sign * Angle_Error(actual, target);
+    
+    return past >= 0.0f && past <= tolerance;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_SinCos
+ * Description: Calculates the sine and cosine of an angle.
+ * Parameters: angle - the angle (radian)
+ *             sine - the sine
+ *             cosine - the cosine
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Angle_SinCos(FLOAT angle, FLOAT* const sine, FLOAT* const cosine)
+{
+    INT32 quadrant;
+    FLOAT x;
+    FLOAT z;
+    FLOAT s;
+    FLOAT c;
+    
+    /* Reduce to +/-PI/4 about the nearest multiple of PI/2 */
+    x = Angle_Wrap(angle);
+    quadrant = (INT32) (x * ANGLE_TWO_OVER_PI + (x >= 0.0f ? 0.5f : -0.5f));
+    x = ((x - quadrant * ANGLE_DP1) - quadrant * ANGLE_DP2) - quadrant * ANGLE_DP3;
+    z = x * x;
+    
+    s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * x + x;
+    c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+    
+    switch (quadrant & 3)
+    {
+        case 0:
+            *sine = s;
+            *cosine = c;
+            break;
+            
+        case 1:
+            *sine = c;
+            *cosine = -s;
+            break;
+            
+        case 2:
+            *sine = -s;
+            *cosine = -c;
+            break;
+            
+        case 3:
+        default:
+            *sine = -c;
+            *cosine = s;
+            break;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_Atan2
+ * Description: Calculates the angle of the vector (x, y).
+ * Parameters: y - the y component
+ *             x - the x component
+ * Return: FLOAT - the angle in the range [-PI, PI] (radian); 0 for the zero vector.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Angle_Atan2(FLOAT y, FLOAT x)
+{
+    FLOAT ax = x >= 0.0f ? x : -x;
+    FLOAT ay = y >= 0.0f ? y : -y;
+    FLOAT z;
+    FLOAT s;
+    FLOAT angle;
+    
+    if (ax == 0.0f && ay == 0.0f)
+    {
+        return 0.0f;
+    }
+    
+    /* Reduce to the first octant, i.e., z = tan(angle) in [0, 1] */
+    z = ax >= ay ? ay / ax : ax / ay;
+    s = z * z;
+    angle = z * (0.9998660f + s * (-0.3302995f + s * (0.1801410f + s * (-0.0851330f + s * 0.0208351f))));
+    
+    if (ay > ax)
+    {
+        angle = ANGLE_HALFPI - angle;
+    }
+    if (x < 0.0f)
+    {
+        angle = ANGLE_PI - angle;
+    }
+    
+    return y < 0.0f ? -angle : angle;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_RadToBrad
+ * Description: Converts an angle from radians to binary angle.  The angle is wrapped.
+ * Parameters: angle - the angle (radian)
+ * Return: ANGLE_BRAD_TYPE - the angle (brad)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+ANGLE_BRAD_TYPE Angle_RadToBrad(FLOAT angle)
+{
+    return (ANGLE_BRAD_TYPE) (INT32) (Angle_Wrap(angle) * ANGLE_RAD_TO_BRAD + (angle >= 0.0f ? 0.5f : -0.5f));
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_BradToRad
+ * Description: Converts an angle from binary angle to radians.
+ * Parameters: angle - the angle (brad)
+ * Return: FLOAT - the angle in the range [-PI, PI) (radian)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Angle_BradToRad(ANGLE_BRAD_TYPE angle)
+{
+    return angle * ANGLE_BRAD_TO_RAD;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_SinQ15
+ * Description: Calculates the sine of a binary angle.
+ * Parameters: angle - the angle (brad)
+ * Return: INT16 - the sine (Q15)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+INT16 Angle_SinQ15(ANGLE_BRAD_TYPE angle)
+{
+    UINT16 brad = (UINT16) angle;
+    UINT16 offset;
+    UINT16 index;
+    UINT16 frac;
+    INT32 value;
+    
+    /* Fold the second and fourth quadrants onto the first and third */
+    offset = brad & (ANGLE_BRAD_HALFPI - 1);
+    if (brad & ANGLE_BRAD_HALFPI)
+    {
+        offset = ANGLE_BRAD_HALFPI - offset;
+    }
+    
+    index = offset >> ANGLE_SIN_TABLE_SHIFT;
+    frac = offset & ((1 << ANGLE_SIN_TABLE_SHIFT) - 1);
+    value = sin_table[index];
+    if (index < ANGLE_SIN_TABLE_STEPS)
+    {
+        value += ((sin_table[index + 1] - value) * frac) >> ANGLE_SIN_TABLE_SHIFT;
+    }
+    
+    /* The third and fourth quadrants are negative */
+    return (INT16) (brad & ANGLE_BRAD_PI ? -value : value);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_CosQ15
+ * Description: Calculates the cosine of a binary angle.
+ * Parameters: angle - the angle (brad)
+ * Return: INT16 - the cosine (Q15)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+INT16 Angle_CosQ15(ANGLE_BRAD_TYPE angle)
+{
+    return Angle_SinQ15((ANGLE_BRAD_TYPE) (angle + ANGLE_BRAD_HALFPI));
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_Atan2Brad
+ * Description: Calculates the binary angle of the vector (x, y).
+ * Parameters: y - the y component
+ *             x - the x component
+ * Return: ANGLE_BRAD_TYPE - the angle (brad); 0 for the zero vector.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+ANGLE_BRAD_TYPE Angle_Atan2Brad(INT32 y, INT32 x)
+{
+    INT32 ax = x >= 0 ? x : -x;
+    INT32 ay = y >= 0 ? y : -y;
+    INT32 z;
+    INT32 angle;
+    
+    if (ax == 0 && ay == 0)
+    {
+        return 0;
+    }
+    
+    /* Scale the components so that the Q15 quotient fits in 32 bits (a hardware divide) */
+    while (ax > 0xFFFF || ay > 0xFFFF)
+    {
+        ax >>= 1;
+        ay >>= 1;
+    }
+    
+    /* z = tan(angle) in Q15, and 0.273 rad is 2847 brads */
+    z = ax >= ay ? (ay << 15) / ax : (ax << 15) / ay;
+    angle = (ANGLE_BRAD_QUARTERPI * z + 2847 * ((z * (32768 - z)) >> 15)) >> 15;
+    
+    if (ay > ax)
+    {
+        angle = ANGLE_BRAD_HALFPI - angle;
+    }
+    if (x < 0)
+    {
+        angle = ANGLE_BRAD_PI - angle;
+    }
+    
+    return (ANGLE_BRAD_TYPE) (y < 0 ? -angle : angle);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PrintBenchmark
+ * Description: Prints the result of a benchmark.
+ * Parameters: name - the name of the function
+ *             cycles - the average cycles of the function
+ *             ref_cycles - the average cycles of the libm function it replaces
+ *             max_error - the maximum error against the libm function
+ *             as_json - if TRUE, print as JSON; otherwise, print as plain text.
+ *             last - TRUE if this is the last benchmark printed
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PrintBenchmark(CHAR* const name, UINT32 cycles, UINT32 ref_cycles, FLOAT max_error, BOOL as_json, BOOL last)
+{
+    if (as_json)
+    {
+        Ser_PutStringFormat("\"%s\":{\"cycles\":%ld,\"ref_cycles\":%ld,\"max_error\":%.7f}%s", 
+                            name, cycles, ref_cycles, max_error, last ? "" : ",");
+    }
+    else
+    {
+        Ser_PutStringFormat("%-14s: %5ld cycles (libm %5ld), max error %.7f\r\n", name, cycles, ref_cycles, max_error);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Angle_Benchmark
+ * Description: Measures the average cycles of each function and of the libm function it replaces, and
+ *              the maximum error against libm, over a sweep of angles.
+ * Parameters: as_json - if TRUE, print as JSON; otherwise, print as plain text.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Angle_Benchmark(BOOL as_json)
+{
+    FLOAT angles[ANGLE_BENCH_NUM_SAMPLES];
+    FLOAT results[ANGLE_BENCH_NUM_SAMPLES];
+    FLOAT sines[ANGLE_BENCH_NUM_SAMPLES];
+    FLOAT cosines[ANGLE_BENCH_NUM_SAMPLES];
+    FLOAT error;
+    FLOAT max_error;
+    UINT32 start;
+    UINT32 elapsed;
+    UINT32 ref_elapsed;
+    UINT8 ii;
+    
+    /* Note: the sweep covers +/- 1.5 revolutions so that the wrap is exercised */
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        angles[ii] = -1.5f * ANGLE_TWOPI + (3.0f * ANGLE_TWOPI * ii) / (ANGLE_BENCH_NUM_SAMPLES - 1);
+    }
+    
+    if (as_json)
+    {
+        Ser_PutString("{");
+    }
+    
+    /* Wrap: the alternative is atan2(sin(angle), cos(angle)) (see utils.h) */
+    start = cycles();
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        results[ii] = Angle_Wrap(angles[ii]);
+    }
+    elapsed = cycles() - start;
+    
+    start = cycles();
+    max_error = 0.0f;
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        bench_sink = atan2(sin(angles[ii]), cos(angles[ii]));
+        error = Angle_Wrap(results[ii] - bench_sink);
+        max_error = max(max_error, abs(error));
+    }
+    ref_elapsed = cycles() - start;
+    PrintBenchmark("wrap", elapsed / ANGLE_BENCH_NUM_SAMPLES, ref_elapsed / ANGLE_BENCH_NUM_SAMPLES, max_error, as_json, FALSE);
+    
+    /* Sine/cosine */
+    start = cycles();
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        Angle_SinCos(angles[ii], &sines[ii], &cosines[ii]);
+    }
+    elapsed = cycles() - start;
+    
+    start = cycles();
+    max_error = 0.0f;
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        bench_sink = sin(angles[ii]);
+        error = sines[ii] - bench_sink;
+        max_error = max(max_error, abs(error));
+        bench_sink = cos(angles[ii]);
+        error = cosines[ii] - bench_sink;
+        max_error = max(max_error, abs(error));
+    }
+    ref_elapsed = cycles() - start;
+    PrintBenchmark("sincos", elapsed / ANGLE_BENCH_NUM_SAMPLES, ref_elapsed / ANGLE_BENCH_NUM_SAMPLES, max_error, as_json, FALSE);
+    
+    /* Atan2: the sines/cosines from above are used as the vectors */
+    start = cycles();
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        results[ii] = Angle_Atan2(sines[ii], cosines[ii]);
+    }
+    elapsed = cycles() - start;
+    
+    start = cycles();
+    max_error = 0.0f;
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        bench_sink = atan2(sines[ii], cosines[ii]);
+        error = Angle_Wrap(results[ii] - bench_sink);
+        max_error = max(max_error, abs(error));
+    }
+    ref_elapsed = cycles() - start;
+    PrintBenchmark("atan2", elapsed / ANGLE_BENCH_NUM_SAMPLES, ref_elapsed / ANGLE_BENCH_NUM_SAMPLES, max_error, as_json, FALSE);
+    
+    /* Fixed-point sine: the reference includes the conversion to Q15 */
+    start = cycles();
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        results[ii] = Angle_SinQ15(Angle_RadToBrad(angles[ii]));
+    }
+    elapsed = cycles() - start;
+    
+    start = cycles();
+    max_error = 0.0f;
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        bench_sink = sin(angles[ii]) * ANGLE_Q15_ONE;
+        error = (results[ii] - bench_sink) / ANGLE_Q15_ONE;
+        max_error = max(max_error, abs(error));
+    }
+    ref_elapsed = cycles() - start;
+    PrintBenchmark("sin_q15", elapsed / ANGLE_BENCH_NUM_SAMPLES, ref_elapsed / ANGLE_BENCH_NUM_SAMPLES, max_error, as_json, FALSE);
+    
+    /* Fixed-point atan2: the vectors are the Q15 sines/cosines */
+    start = cycles();
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        results[ii] = Angle_Atan2Brad((INT32) (sines[ii] * ANGLE_Q15_ONE), (INT32) (cosines[ii] * ANGLE_Q15_ONE));
+    }
+    elapsed = cycles() - start;
+    
+    start = cycles();
+    max_error = 0.0f;
+    for (ii = 0; ii < ANGLE_BENCH_NUM_SAMPLES; ++ii)
+    {
+        bench_sink = atan2(sines[ii], cosines[ii]);
+        error = Angle_Wrap(Angle_BradToRad((ANGLE_BRAD_TYPE) results[ii]) - bench_sink);
+        max_error = max(max_error, abs(error));
+    }
+    ref_elapsed = cycles() - start;
+    PrintBenchmark("atan2_brad", elapsed / ANGLE_BENCH_NUM_SAMPLES, ref_elapsed / ANGLE_BENCH_NUM_SAMPLES, max_error, as_json, TRUE);
+    
+    if (as_json)
+    {
+        Ser_PutString("}\r\n");
+    }
+}
+
+/* [] END OF FILE */
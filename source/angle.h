@@ -0,0 +1,80 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides single-precision and fixed-point angle math which is cheap on a
+   processor without an FPU.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef ANGLE_H
+#define ANGLE_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Macros
+ *-------------------------------------------------------------------------------------------------*/
+/* Note: PI (consts.h) is a double, so these are used to keep the calculations in single-precision */
+#define ANGLE_PI        (3.14159265f)
+#define ANGLE_TWOPI     (6.28318531f)
+#define ANGLE_HALFPI    (1.57079633f)
+#define ANGLE_QUARTERPI (0.78539816f)
+
+/* Binary angles (brads) represent a revolution as 65536 counts so that wrapping is free */
+#define ANGLE_BRAD_PER_REV  (65536L)
+#define ANGLE_BRAD_PI       (32768L)
+#define ANGLE_BRAD_HALFPI   (16384L)
+#define ANGLE_BRAD_QUARTERPI (8192L)
+
+/* Fixed-point sine/cosine values are Q15, i.e., 32767 is 1.0 */
+#define ANGLE_Q15_ONE   (32767)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef INT16 ANGLE_BRAD_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Angle_Wrap(FLOAT angle);
+FLOAT Angle_Error(FLOAT target, FLOAT actual);
+BOOL Angle_IsReached(FLOAT target, FLOAT actual, INT8 sign, FLOAT tolerance);
+void Angle_SinCos(FLOAT angle, FLOAT* const sine, FLOAT* const cosine);
+FLOAT Angle_Atan2(FLOAT y, FLOAT x);
+
+ANGLE_BRAD_TYPE Angle_RadToBrad(FLOAT angle);
+FLOAT Angle_BradToRad(ANGLE_BRAD_TYPE angle);
+INT16 Angle_SinQ15(ANGLE_BRAD_TYPE angle);
+INT16 Angle_CosQ15(ANGLE_BRAD_TYPE angle);
+ANGLE_BRAD_TYPE Angle_Atan2Brad(INT32 y, INT32 x);
+
+void Angle_Benchmark(BOOL as_json);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,144 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the mode arena.  The calibration commands keep large sample
+   buffers which are only needed while the command runs, and only one of these commands runs at a time
+   (each claims the motors, see disp.c).  Rather than each module reserving its buffers permanently, 
+   the buffers are allocated from the arena when the command starts and released when it ends, so the
+   RAM they need is the largest user's rather than the sum.
+   
+   Allocation is a bump of the used count; there is no free of a single block.  The arena has one
+   owner at a time: allocations by another owner fail until the owner releases the arena.  A release
+   by a module which does not own the arena is ignored, so a shared stop routine can release safely.
+   
+   Note: The arena size is checked at build time by the users (ARENA_ASSERT_FITS) and the RAM used by
+   each module is reported from the linked image by ramreport.py.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "arena.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define ARENA_ALIGNMENT (sizeof(UINT32))
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+/* Note: UINT32 elements keep every block word aligned */
+static UINT32 arena[ARENA_SIZE / sizeof(UINT32)];
+static ARENA_OWNER_TYPE arena_owner;
+static UINT16 arena_used;
+static UINT16 arena_peak;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Arena_Init
+ * Description: Initializes the arena.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Arena_Init()
+{
+    arena_owner = ARENA_OWNER_NONE;
+    arena_used = 0;
+    arena_peak = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Arena_Alloc
+ * Description: Allocates a zeroed block from the arena.
+ * Parameters: owner - the module allocating the block
+ *             size - the size of the block in bytes
+ * Return: pointer to the block, NULL if the arena is owned by another module or the block does not fit
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void* Arena_Alloc(ARENA_OWNER_TYPE owner, UINT16 size)
+{
+    UINT8 *p_block;
+    UINT16 aligned_size;
+    
+    if (owner == ARENA_OWNER_NONE || (arena_owner != ARENA_OWNER_NONE && arena_owner != owner))
+    {
+        return NULL;
+    }
+    
+    aligned_size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (aligned_size > ARENA_SIZE - arena_used)
+    {
+        return NULL;
+    }
+    
+    p_block = (UINT8 *) arena + arena_used;
+    memset(p_block, 0, aligned_size);
+    
+    arena_owner = owner;
+    arena_used += aligned_size;
+    arena_peak = max(arena_peak, arena_used);
+    
+    return p_block;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Arena_Release
+ * Description: Releases all of the blocks allocated by the owner.
+ * Parameters: owner - the module releasing the arena
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Arena_Release(ARENA_OWNER_TYPE owner)
+{
+    if (owner == arena_owner)
+    {
+        arena_owner = ARENA_OWNER_NONE;
+        arena_used = 0;
+    }
+}
+
+ARENA_OWNER_TYPE Arena_GetOwner()
+{
+    return arena_owner;
+}
+
+UINT16 Arena_GetUsed()
+{
+    return arena_used;
+}
+
+UINT16 Arena_GetPeak()
+{
+    return arena_peak;
+}
+
+/* [] END OF FILE */
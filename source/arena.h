@@ -1,64 +1,64 @@
-/* 
-MIT License
-
-Copyright (c) 2017 Tim Slator
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-/*---------------------------------------------------------------------------------------------------
-   Description: This module provides the implementation of the angular velocity PID.
- *-------------------------------------------------------------------------------------------------*/    
-
-#ifndef ANGPID_H
-#define ANGPID_H
-    
-/*---------------------------------------------------------------------------------------------------
- * Includes
- *-------------------------------------------------------------------------------------------------*/    
-#include "freesoc.h"
-    
-/*---------------------------------------------------------------------------------------------------
- * Macros
- *-------------------------------------------------------------------------------------------------*/    
-    
-
-/*---------------------------------------------------------------------------------------------------
- * Types
- *-------------------------------------------------------------------------------------------------*/
-
-
-/*---------------------------------------------------------------------------------------------------
- * Functions
- *-------------------------------------------------------------------------------------------------*/    
-void AngPid_Init();
-void AngPid_Start();
-void AngPid_Process();
-
-void AngPid_SetGains(FLOAT theta_kp, FLOAT theta_ki, FLOAT theta_kd, FLOAT theta_kf);
-void AngPid_GetGains(FLOAT* const theta_kp, FLOAT* const theta_ki, FLOAT* const theta_kd, FLOAT* const theta_kf);
-
-void AngPid_Reset();
-void AngPid_Enable(BOOL enable);
-void AngPid_Bypass(BOOL bypass);
-
-
-#endif
-
-/* [] END OF FILE */
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the mode arena, a single block of RAM shared by the commands
+   which are never run at the same time.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef ARENA_H
+#define ARENA_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* Sized for the largest user, the PID calibration response capture (see calpid.c) */
+#define ARENA_SIZE (4096)
+
+/* Fails the build when a type allocated from the arena does not fit */
+#define ARENA_ASSERT_FITS(type)  typedef char arena_fits_##type[(sizeof(type) <= ARENA_SIZE) ? 1 : -1]
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {ARENA_OWNER_NONE, ARENA_OWNER_CALMOTOR, ARENA_OWNER_CALPID, ARENA_OWNER_CALSNAP, ARENA_OWNER_LAST} ARENA_OWNER_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Arena_Init();
+void* Arena_Alloc(ARENA_OWNER_TYPE owner, UINT16 size);
+void Arena_Release(ARENA_OWNER_TYPE owner);
+ARENA_OWNER_TYPE Arena_GetOwner();
+UINT16 Arena_GetUsed();
+UINT16 Arena_GetPeak();
+
+#endif
+
+/* [] END OF FILE */
@@ -31,16 +31,18 @@ SOFTWARE.
  * Includes
  *-------------------------------------------------------------------------------------------------*/
 #include <stdlib.h>
+#include <string.h>
 #include "cal.h"
+#include "caltable.h"
 #include "motor.h"
 #include "pwm.h"
 #include "encoder.h"
 #include "control.h"
 #include "utils.h"
 #include "serial.h"
+#include "emit.h"
 #include "pid.h"
-#include "pidleft.h"
-#include "pidright.h"
+#include "pidbank.h"
 #include "nvstore.h"
 #include "calmotor.h"
 #include "valmotor.h"
@@ -123,12 +125,29 @@ SOFTWARE.
 #define RIGHT_PID_KD_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->right_gains.kd)
 #define RIGHT_PID_KF_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->right_gains.kf)
 
+#define LINEAR_PID_KP_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->linear_gains.kp)
+#define LINEAR_PID_KI_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->linear_gains.ki)
+#define LINEAR_PID_KD_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->linear_gains.kd)
+#define LINEAR_PID_KF_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->linear_gains.kf)
+
+#define ANGULAR_PID_KP_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->angular_gains.kp)
+#define ANGULAR_PID_KI_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->angular_gains.ki)
+#define ANGULAR_PID_KD_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->angular_gains.kd)
+#define ANGULAR_PID_KF_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->angular_gains.kf)
+
+#define LEFT_PID_SCHED_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->left_sched)
+#define RIGHT_PID_SCHED_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->right_sched)
+
+#define RATES_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->rates)
+
 #define STATUS_OFFSET NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->status)
 
 #define ANGULAR_BIAS_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->angular_bias)
 #define LINEAR_BIAS_OFFSET (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(&p_cal_eeprom->linear_bias)
 
 #define MOTOR_DATA_OFFSET(wheel, dir) (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(WHEEL_DIR_TO_CAL_DATA[wheel][dir])
+#define MOTOR_TABLE_OFFSET(wheel, dir) (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(WHEEL_DIR_TO_CAL_TABLE[wheel][dir])
+#define MOTOR_MODEL_OFFSET(wheel, dir) (UINT16) NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(WHEEL_DIR_TO_CAL_MODEL[wheel][dir])
 
 /*---------------------------------------------------------------------------------------------------
  * Types
@@ -153,6 +172,18 @@ static volatile CAL_EEPROM_TYPE *p_cal_eeprom;
 
 static CAL_DATA_TYPE * WHEEL_DIR_TO_CAL_DATA[2][2];
 
+/* SRAM copy of the motor calibration tables.  Count/sec to pwm conversion is done from this copy so that the tables
+   can be refined at runtime (see calrefine.c) without writing to EEPROM on every change.
+*/
+static CAL_DATA_TYPE motor_data_ram[2][2];
+
+/* Compressed motor calibration tables (see caltable.c).  The EEPROM copy is decoded into SRAM for conversion. */
+static CAL_TABLE_TYPE * WHEEL_DIR_TO_CAL_TABLE[2][2];
+static CAL_TABLE_EVAL_TYPE motor_table_ram[2][2];
+
+/* First-order motor models identified during motor calibration (see calmotor.c) */
+static CAL_MOTOR_MODEL_TYPE * WHEEL_DIR_TO_CAL_MODEL[2][2];
+
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/
@@ -271,42 +302,117 @@ void Cal_PrintSamples(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_DATA_TYPE *cal_data, U
                 {"cps": 0, "pwm": 1500}
             ]}
         */
-        static char buffer[2000];
-        int offset;
-        int ii;
-
-        offset = 0;
-        memset(buffer, 0, sizeof(buffer));
-
-        offset += sprintf(buffer + offset, "{\"wheel\":\"%s\",", wheel == WHEEL_LEFT ? "left" : "right");
-        offset += sprintf(buffer + offset, "\"direction\":\"%s\",", dir == DIR_FORWARD ? "forward" : "backward");
-        offset += sprintf(buffer + offset, "\"min\":%d,", cal_data->cps_min);
-        offset += sprintf(buffer + offset, "\"max\":%d,", cal_data->cps_max);
-        offset += sprintf(buffer + offset, "\"values\":[");
-        for (ii = 0; ii < CAL_NUM_SAMPLES - 1; ++ii)
+        UINT8 ii;
+
+        Emit_ObjectBegin(NULL);
+        Emit_KeyString("wheel", wheel == WHEEL_LEFT ? "left" : "right");
+        Emit_KeyString("direction", dir == DIR_FORWARD ? "forward" : "backward");
+        Emit_KeyInt("min", cal_data->cps_min);
+        Emit_KeyInt("max", cal_data->cps_max);
+        Emit_ArrayBegin("values");
+        for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
         {
-            offset += sprintf(buffer + offset, "{\"cps\":%d,\"pwm\":%d},", cal_data->cps_data[ii], cal_data->pwm_data[ii]);
+            Emit_ObjectBegin(NULL);
+            Emit_KeyInt("cps", cal_data->cps_data[ii]);
+            Emit_KeyInt("pwm", cal_data->pwm_data[ii]);
+            Emit_ObjectEnd();
         }
-        offset += sprintf(buffer + offset, "{\"cps\":%d,\"pwm\":%d}]}\r\n", cal_data->cps_data[ii], cal_data->pwm_data[ii]);
-
-        Ser_PutString(buffer);
+        Emit_ArrayEnd();
+        Emit_ObjectEnd();
+        Emit_Newline();
     }
     else
     {
         UINT8 ii;
         
-        Ser_PutStringFormat("%s-%s - min/max: %d/%d\r\n", 
-                            wheel == WHEEL_LEFT ? "Left" : "Right", 
-                            dir == DIR_FORWARD ? "Forward" : "Backward", 
-                            cal_data->cps_min, 
-                            cal_data->cps_max);
+        Emit_String(wheel == WHEEL_LEFT ? "Left-" : "Right-");
+        Emit_String(dir == DIR_FORWARD ? "Forward" : "Backward");
+        Emit_String(" - min/max: ");
+        Emit_Int(cal_data->cps_min);
+        Emit_Char('/');
+        Emit_Int(cal_data->cps_max);
+        Emit_Newline();
         
-        for (ii = 0; ii < CAL_NUM_SAMPLES - 1; ++ii)
+        for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
         {
-            Ser_PutStringFormat("%ld:%d ", cal_data->cps_data[ii], cal_data->pwm_data[ii]);
+            Emit_Int(cal_data->cps_data[ii]);
+            Emit_Char(':');
+            Emit_Int(cal_data->pwm_data[ii]);
+            if (ii < CAL_NUM_SAMPLES - 1)
+            {
+                Emit_Char(' ');
+            }
         }
-        Ser_PutStringFormat("%ld:%d\r\n\r\n", cal_data->cps_data[ii], cal_data->pwm_data[ii]);
+        Emit_Newline();
+        Emit_String("table knots: ");
+        Emit_Int(motor_table_ram[wheel][dir].num_knots);
+        Emit_Newline();
+        Emit_Newline();
     }
+
+    Cal_PrintMotorModel(wheel, dir, WHEEL_DIR_TO_CAL_MODEL[wheel][dir], as_json);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_PrintMotorModel
+ * Description: Prints the first-order motor model.  Called from the CalMotor module.
+ * Parameters: wheel - either left or right
+ *             dir - either forward or backward 
+ *             model - pointer to structure containing the motor model
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_PrintMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_MOTOR_MODEL_TYPE* const model, UINT8 as_json)
+{
+    if (as_json)
+    {
+        Emit_ObjectBegin(NULL);
+        Emit_KeyString("wheel", wheel == WHEEL_LEFT ? "left" : "right");
+        Emit_KeyString("direction", dir == DIR_FORWARD ? "forward" : "backward");
+        Emit_ObjectBegin("model");
+        Emit_KeyFixed("gain", model->gain, 3);
+        Emit_KeyFixed("tau", model->tau, 3);
+        Emit_KeyInt("deadband", model->deadband);
+        Emit_KeyBool("valid", model->valid);
+        Emit_ObjectEnd();
+        Emit_ObjectEnd();
+        Emit_Newline();
+    }
+    else
+    {
+        Emit_String(wheel == WHEEL_LEFT ? "Left-" : "Right-");
+        Emit_String(dir == DIR_FORWARD ? "Forward" : "Backward");
+        Emit_String(" model - gain: ");
+        Emit_Fixed(model->gain, 3);
+        Emit_String(", tau: ");
+        Emit_Fixed(model->tau, 3);
+        Emit_String(", deadband: ");
+        Emit_Int(model->deadband);
+        Emit_String(model->valid ? "" : " (invalid)");
+        Emit_Newline();
+        Emit_Newline();
+    }
+    Emit_Flush();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PrintGains
+ * Description: Prints the plain text gains, e.g., " PID - P: 1.000, I: 0.500, D: 0.000, F: 0.100".
+ * Parameters: prefix - the text before the proportional gain, e.g., " PID - P: "
+ *             kp, ki, kd, kf - the gains
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PrintGains(CHAR const * const prefix, FLOAT kp, FLOAT ki, FLOAT kd, FLOAT kf)
+{
+    Emit_String(prefix);
+    Emit_Fixed(kp, 3);
+    Emit_String(", I: ");
+    Emit_Fixed(ki, 3);
+    Emit_String(", D: ");
+    Emit_Fixed(kd, 3);
+    Emit_String(", F: ");
+    Emit_Fixed(kf, 3);
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -324,16 +430,22 @@ void Cal_PrintPidGains(WHEEL_TYPE wheel, FLOAT* const gains, UINT8 as_json)
         /*
             {"wheel":"left", "p":%.3f,"i":%.3f,"d":%.3f,"f":%.3f}
         */
-        Ser_PutStringFormat("{\"wheel\":\"%s\",\"p\":%.3f,\"i\":%.3f,\"d\":%.3f,\"f\":%.3f}\r\n", 
-                            wheel == WHEEL_LEFT ? "left" : "right", 
-                            gains[0], gains[1], gains[2], gains[3]);
+        Emit_ObjectBegin(NULL);
+        Emit_KeyString("wheel", wheel == WHEEL_LEFT ? "left" : "right");
+        Emit_KeyFixed("p", gains[0], 3);
+        Emit_KeyFixed("i", gains[1], 3);
+        Emit_KeyFixed("d", gains[2], 3);
+        Emit_KeyFixed("f", gains[3], 3);
+        Emit_ObjectEnd();
+        Emit_Newline();
     }
     else
     {
-        Ser_PutStringFormat("%s PID - P: %.3f, I: %.3f, D: %.3f, F: %.3f\r\n", 
-                            wheel == WHEEL_LEFT ? "Left" : "Right", 
-                            gains[0], gains[1], gains[2], gains[3]);
+        Emit_String(wheel == WHEEL_LEFT ? "Left" : "Right");
+        PrintGains(" PID - P: ", gains[0], gains[1], gains[2], gains[3]);
+        Emit_Newline();
     }
+    Emit_Flush();
 }
 
 void Cal_PrintLeftPidGains(BOOL as_json)
@@ -347,6 +459,7 @@ void Cal_PrintLeftPidGains(BOOL as_json)
     gains[2] = p_pid->kd;
     gains[3] = p_pid->kf;
     Cal_PrintPidGains(WHEEL_LEFT, gains, as_json);
+    Cal_PrintPidSchedule(WHEEL_LEFT, Cal_GetPidSchedule(PID_TYPE_LEFT), as_json);
 }
 
 void Cal_PrintRightPidGains(BOOL as_json)
@@ -360,6 +473,7 @@ void Cal_PrintRightPidGains(BOOL as_json)
     gains[2] = p_pid->kd;
     gains[3] = p_pid->kf;
     Cal_PrintPidGains(WHEEL_RIGHT, gains, as_json);            
+    Cal_PrintPidSchedule(WHEEL_RIGHT, Cal_GetPidSchedule(PID_TYPE_RIGHT), as_json);
 }
 
 void Cal_PrintAllPidGains(BOOL as_json)
@@ -368,17 +482,83 @@ void Cal_PrintAllPidGains(BOOL as_json)
     Cal_PrintRightPidGains(as_json);
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_PrintPidSchedule
+ * Description: Prints the speed-scheduled PID gains.  Nothing is printed if there is no schedule.
+ * Parameters: wheel - the wheel
+ *             sched - the gain schedule
+ *             as_json - TRUE to print as JSON; otherwise, plain text
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_PrintPidSchedule(WHEEL_TYPE wheel, CAL_PID_SCHED_TYPE* const sched, UINT8 as_json)
+{
+    UINT8 ii;
+    CAL_PID_TYPE *p_gains;
+    
+    if (!Cal_IsPidScheduleValid(sched))
+    {
+        return;
+    }
+    
+    if (as_json)
+    {
+        /*
+            {"wheel":"left","sched":[{"cps":%d,"p":%.3f,"i":%.3f,"d":%.3f,"f":%.3f}, ...]}
+        */
+        Emit_ObjectBegin(NULL);
+        Emit_KeyString("wheel", wheel == WHEEL_LEFT ? "left" : "right");
+        Emit_ArrayBegin("sched");
+        for (ii = 0; ii < sched->num_bands; ++ii)
+        {
+            p_gains = &sched->gains[ii];
+            Emit_ObjectBegin(NULL);
+            Emit_KeyInt("cps", sched->cps[ii]);
+            Emit_KeyFixed("p", p_gains->kp, 3);
+            Emit_KeyFixed("i", p_gains->ki, 3);
+            Emit_KeyFixed("d", p_gains->kd, 3);
+            Emit_KeyFixed("f", p_gains->kf, 3);
+            Emit_ObjectEnd();
+        }
+        Emit_ArrayEnd();
+        Emit_ObjectEnd();
+        Emit_Newline();
+    }
+    else
+    {
+        Emit_String(wheel == WHEEL_LEFT ? "Left" : "Right");
+        Emit_String(" PID schedule");
+        Emit_Newline();
+        for (ii = 0; ii < sched->num_bands; ++ii)
+        {
+            p_gains = &sched->gains[ii];
+            Emit_String("    ");
+            Emit_Int(ii);
+            Emit_String(": cps: ");
+            Emit_Int(sched->cps[ii]);
+            PrintGains(" - P: ", p_gains->kp, p_gains->ki, p_gains->kd, p_gains->kf);
+            Emit_Newline();
+        }
+    }
+    Emit_Flush();
+}
+
 void Cal_PrintStatus(UINT8 as_json)
 {
     if (as_json)
     {
         /* TODO: Consider parsing out the bits of status into fields in the json */
-        Ser_PutStringFormat("{\"status\":%02x}\r\n", p_cal_eeprom->status);
+        Emit_String("{\"status\":");
+        Emit_Hex(p_cal_eeprom->status, 2);
+        Emit_Char('}');
     }
     else
     {
-        Ser_PutStringFormat("Status - %02x\r\n", p_cal_eeprom->status);
+        Emit_String("Status - ");
+        Emit_Hex(p_cal_eeprom->status, 2);
     }
+    Emit_Newline();
+    Emit_Flush();
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -391,12 +571,20 @@ void Cal_PrintBias(UINT8 as_json)
 {
     if (as_json)
     {
-        Ser_PutStringFormat("{\"linear\":%.2f,\"angular\":%.2f}\r\n", Cal_GetLinearBias(), Cal_GetAngularBias());
+        Emit_ObjectBegin(NULL);
+        Emit_KeyFixed("linear", Cal_GetLinearBias(), 2);
+        Emit_KeyFixed("angular", Cal_GetAngularBias(), 2);
+        Emit_ObjectEnd();
     }
     else
     {
-        Ser_PutStringFormat("Linear Bias: %.2f, Angular Bias: %.2f\r\n", Cal_GetLinearBias(), Cal_GetAngularBias());
+        Emit_String("Linear Bias: ");
+        Emit_Fixed(Cal_GetLinearBias(), 2);
+        Emit_String(", Angular Bias: ");
+        Emit_Fixed(Cal_GetAngularBias(), 2);
     }
+    Emit_Newline();
+    Emit_Flush();
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -1012,6 +1200,16 @@ void Cal_Init()
     WHEEL_DIR_TO_CAL_DATA[WHEEL_RIGHT][DIR_FORWARD] = (CAL_DATA_TYPE *) &p_cal_eeprom->right_motor_fwd;
     WHEEL_DIR_TO_CAL_DATA[WHEEL_RIGHT][DIR_BACKWARD] = (CAL_DATA_TYPE *) &p_cal_eeprom->right_motor_bwd;
 
+    WHEEL_DIR_TO_CAL_TABLE[WHEEL_LEFT][DIR_FORWARD] = (CAL_TABLE_TYPE *) &p_cal_eeprom->left_table_fwd;
+    WHEEL_DIR_TO_CAL_TABLE[WHEEL_LEFT][DIR_BACKWARD] = (CAL_TABLE_TYPE *) &p_cal_eeprom->left_table_bwd;
+    WHEEL_DIR_TO_CAL_TABLE[WHEEL_RIGHT][DIR_FORWARD] = (CAL_TABLE_TYPE *) &p_cal_eeprom->right_table_fwd;
+    WHEEL_DIR_TO_CAL_TABLE[WHEEL_RIGHT][DIR_BACKWARD] = (CAL_TABLE_TYPE *) &p_cal_eeprom->right_table_bwd;
+
+    WHEEL_DIR_TO_CAL_MODEL[WHEEL_LEFT][DIR_FORWARD] = (CAL_MOTOR_MODEL_TYPE *) &p_cal_eeprom->left_model_fwd;
+    WHEEL_DIR_TO_CAL_MODEL[WHEEL_LEFT][DIR_BACKWARD] = (CAL_MOTOR_MODEL_TYPE *) &p_cal_eeprom->left_model_bwd;
+    WHEEL_DIR_TO_CAL_MODEL[WHEEL_RIGHT][DIR_FORWARD] = (CAL_MOTOR_MODEL_TYPE *) &p_cal_eeprom->right_model_fwd;
+    WHEEL_DIR_TO_CAL_MODEL[WHEEL_RIGHT][DIR_BACKWARD] = (CAL_MOTOR_MODEL_TYPE *) &p_cal_eeprom->right_model_bwd;
+
 
     Cal_LeftTarget = LeftTarget;
     Cal_RightTarget = RightTarget;
@@ -1039,6 +1237,8 @@ void Cal_Start()
     Cal_Clear();
     */
     Control_SetCalibrationStatus(status);
+    
+    Cal_LoadMotorData();
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -1276,6 +1476,109 @@ CAL_PID_TYPE* Cal_GetPidGains(PID_ENUM_TYPE pid)
     return (CAL_PID_TYPE *) NULL;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_GetPidSchedule
+ * Description: Returns the speed-scheduled PID gains stored in EEPROM.
+ * Parameters: pid - the pid
+ * Return: pointer to CAL_PID_SCHED_TYPE or NULL if the pid has no schedule.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CAL_PID_SCHED_TYPE* Cal_GetPidSchedule(PID_ENUM_TYPE pid)
+{
+    switch (pid)
+    {
+        case PID_TYPE_LEFT:
+            return (CAL_PID_SCHED_TYPE *) &p_cal_eeprom->left_sched;
+
+        case PID_TYPE_RIGHT:
+            return (CAL_PID_SCHED_TYPE *) &p_cal_eeprom->right_sched;
+            
+        case PID_TYPE_LINEAR:
+        case PID_TYPE_ANGULAR:
+        default:
+            return (CAL_PID_SCHED_TYPE *) NULL;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_IsPidScheduleValid
+ * Description: Checks that a gain schedule has at least one band and that the band speeds are in 
+ *              ascending order.
+ * Parameters: sched - the gain schedule
+ * Return: BOOL - TRUE if the schedule is valid; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Cal_IsPidScheduleValid(CAL_PID_SCHED_TYPE* const sched)
+{
+    UINT8 ii;
+    
+    if (sched == NULL || sched->num_bands == 0 || sched->num_bands > CAL_PID_SCHED_MAX_BANDS)
+    {
+        return FALSE;
+    }
+    
+    for (ii = 1; ii < sched->num_bands; ++ii)
+    {
+        if (sched->cps[ii] <= sched->cps[ii - 1])
+        {
+            return FALSE;
+        }
+    }
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_SetPidSchedule
+ * Description: Writes the speed-scheduled PID gains to EEPROM.
+ * Parameters: pid - the pid
+ *             sched - the gain schedule
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_SetPidSchedule(PID_ENUM_TYPE pid, CAL_PID_SCHED_TYPE* const sched)
+{
+    switch (pid)
+    {
+        case PID_TYPE_LEFT:
+            Nvstore_WriteBytes((UINT8 *) sched, sizeof(*sched), LEFT_PID_SCHED_OFFSET);
+            break;
+
+        case PID_TYPE_RIGHT:
+            Nvstore_WriteBytes((UINT8 *) sched, sizeof(*sched), RIGHT_PID_SCHED_OFFSET);
+            break;
+            
+        case PID_TYPE_LINEAR:
+        case PID_TYPE_ANGULAR:
+        default:
+            break;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_GetSampleRates
+ * Description: Returns the encoder, PID and odometry sample rates stored in EEPROM.
+ * Parameters: None
+ * Return: pointer to CAL_RATE_TYPE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CAL_RATE_TYPE* Cal_GetSampleRates()
+{
+    return (CAL_RATE_TYPE *) &p_cal_eeprom->rates;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_SetSampleRates
+ * Description: Writes the encoder, PID and odometry sample rates to EEPROM.
+ * Parameters: rates - the sample rates
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_SetSampleRates(CAL_RATE_TYPE* const rates)
+{
+    Nvstore_WriteBytes((UINT8 *) rates, sizeof(*rates), RATES_OFFSET);
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Cal_SetLeftRightVelocity
  * Description: Sets the left/right velocity for calibration/validation.  This routine is called from 
@@ -1303,6 +1606,7 @@ PWM_TYPE Cal_CpsToPwm(WHEEL_TYPE wheel, FLOAT cps)
 {
     static UINT8 send_once = 0;
     PWM_TYPE pwm;
+    DIR_TYPE dir;
     
     
     pwm = PWM_STOP;
@@ -1312,10 +1616,24 @@ PWM_TYPE Cal_CpsToPwm(WHEEL_TYPE wheel, FLOAT cps)
     if (Cal_GetCalibrationStatusBit(CAL_MOTOR_BIT))
     {
     
-        CAL_DATA_TYPE *p_cal_data = WHEEL_DIR_TO_CAL_DATA[wheel][cps >= 0 ? 0 : 1];
+        dir = cps >= 0 ? DIR_FORWARD : DIR_BACKWARD;
         
-        cps = constrain((INT16) cps, p_cal_data->cps_min, p_cal_data->cps_max);
-        pwm = CpsToPwm((INT16) cps, &p_cal_data->cps_data[0], &p_cal_data->pwm_data[0], CAL_DATA_SIZE);
+        /* Use the compressed table when available; otherwise, fall back to the calibration samples */
+        if (motor_table_ram[wheel][dir].num_knots > 0)
+        {
+            if ((INT16) cps != 0)
+            {
+                pwm = CalTable_CpsToPwm(&motor_table_ram[wheel][dir], (INT16) cps);
+                pwm = constrain(pwm, MIN_PWM_VALUE, MAX_PWM_VALUE);
+            }
+        }
+        else
+        {
+            CAL_DATA_TYPE *p_cal_data = &motor_data_ram[wheel][dir];
+            
+            cps = constrain((INT16) cps, p_cal_data->cps_min, p_cal_data->cps_max);
+            pwm = CpsToPwm((INT16) cps, &p_cal_data->cps_data[0], &p_cal_data->pwm_data[0], CAL_DATA_SIZE);
+        }
     }
     else
     {
@@ -1513,7 +1831,19 @@ void Cal_SetGains(PID_ENUM_TYPE pid, FLOAT* const gains)
             break;
             
         case PID_TYPE_LINEAR:
+            Nvstore_WriteFloat(gains[0], LINEAR_PID_KP_OFFSET);
+            Nvstore_WriteFloat(gains[1], LINEAR_PID_KI_OFFSET);
+            Nvstore_WriteFloat(gains[2], LINEAR_PID_KD_OFFSET);
+            Nvstore_WriteFloat(gains[3], LINEAR_PID_KF_OFFSET);
+            break;
+            
         case PID_TYPE_ANGULAR:
+            Nvstore_WriteFloat(gains[0], ANGULAR_PID_KP_OFFSET);
+            Nvstore_WriteFloat(gains[1], ANGULAR_PID_KI_OFFSET);
+            Nvstore_WriteFloat(gains[2], ANGULAR_PID_KD_OFFSET);
+            Nvstore_WriteFloat(gains[3], ANGULAR_PID_KF_OFFSET);
+            break;
+            
         default:
             break;
     }
@@ -1521,8 +1851,42 @@ void Cal_SetGains(PID_ENUM_TYPE pid, FLOAT* const gains)
 
 void Cal_SetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_DATA_TYPE *data)
 {
+    CAL_TABLE_TYPE table;
+    
     /* Write the calibration to non-volatile storage */
     Nvstore_WriteBytes((UINT8 *) data, sizeof(*data), MOTOR_DATA_OFFSET(wheel, dir));
+    
+    /* Keep the SRAM copy in sync.  Note: data may be the SRAM copy itself when refined tables are persisted. */
+    if (data != &motor_data_ram[wheel][dir])
+    {
+        memcpy(&motor_data_ram[wheel][dir], data, sizeof(*data));
+    }
+
+    /* Write the compressed table.  If the data cannot be compressed an invalid table is written and conversion 
+       falls back to the calibration samples.
+     */
+    CalTable_Compress(data, &table);
+    Nvstore_WriteBytes((UINT8 *) &table, sizeof(table), MOTOR_TABLE_OFFSET(wheel, dir));
+    CalTable_Decode(&table, &motor_table_ram[wheel][dir]);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_UpdateMotorTable
+ * Description: Rebuilds the SRAM compressed table from the SRAM motor calibration data, e.g., after 
+ *              the data has been refined.  The EEPROM table is not changed.
+ * Parameters: wheel - left/right wheel
+ *             dir - forward/backward direction
+ * Return: UINT8 - the number of knots, 0 if the data could not be compressed
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT8 Cal_UpdateMotorTable(WHEEL_TYPE wheel, DIR_TYPE dir)
+{
+    CAL_TABLE_TYPE table;
+    
+    CalTable_Compress(&motor_data_ram[wheel][dir], &table);
+    CalTable_Decode(&table, &motor_table_ram[wheel][dir]);
+    
+    return motor_table_ram[wheel][dir].num_knots;
 }
 
 CAL_DATA_TYPE* Cal_GetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir)
@@ -1530,6 +1894,82 @@ CAL_DATA_TYPE* Cal_GetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir)
     return WHEEL_DIR_TO_CAL_DATA[wheel][dir];
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_GetMotorModel
+ * Description: Returns the first-order motor model stored in EEPROM.
+ * Parameters: wheel - left/right wheel
+ *             dir - forward/backward direction
+ * Return: pointer to CAL_MOTOR_MODEL_TYPE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CAL_MOTOR_MODEL_TYPE* Cal_GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir)
+{
+    return WHEEL_DIR_TO_CAL_MODEL[wheel][dir];
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_SetMotorModel
+ * Description: Writes the first-order motor model to EEPROM.
+ * Parameters: wheel - left/right wheel
+ *             dir - forward/backward direction
+ *             model - the motor model
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_SetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_MOTOR_MODEL_TYPE* const model)
+{
+    Nvstore_WriteBytes((UINT8 *) model, sizeof(*model), MOTOR_MODEL_OFFSET(wheel, dir));
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_GetRamMotorData
+ * Description: Returns the SRAM copy of the motor calibration data used for count/sec to pwm 
+ *              conversion.  Changes to the SRAM copy are not persisted until written with 
+ *              Cal_SetMotorData.
+ * Parameters: wheel - left/right wheel
+ *             dir - forward/backward direction
+ * Return: pointer to CAL_DATA_TYPE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CAL_DATA_TYPE* Cal_GetRamMotorData(WHEEL_TYPE wheel, DIR_TYPE dir)
+{
+    return &motor_data_ram[wheel][dir];
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Cal_LoadMotorData
+ * Description: Copies the motor calibration data from EEPROM into SRAM, discarding any runtime
+ *              refinement that has not been persisted.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Cal_LoadMotorData()
+{
+    memcpy(&motor_data_ram[WHEEL_LEFT][DIR_FORWARD], WHEEL_DIR_TO_CAL_DATA[WHEEL_LEFT][DIR_FORWARD], sizeof(CAL_DATA_TYPE));
+    memcpy(&motor_data_ram[WHEEL_LEFT][DIR_BACKWARD], WHEEL_DIR_TO_CAL_DATA[WHEEL_LEFT][DIR_BACKWARD], sizeof(CAL_DATA_TYPE));
+    memcpy(&motor_data_ram[WHEEL_RIGHT][DIR_FORWARD], WHEEL_DIR_TO_CAL_DATA[WHEEL_RIGHT][DIR_FORWARD], sizeof(CAL_DATA_TYPE));
+    memcpy(&motor_data_ram[WHEEL_RIGHT][DIR_BACKWARD], WHEEL_DIR_TO_CAL_DATA[WHEEL_RIGHT][DIR_BACKWARD], sizeof(CAL_DATA_TYPE));
+    
+    /* Calibrations stored before the compressed tables existed are compressed from the SRAM copy */
+    if (!CalTable_Decode(WHEEL_DIR_TO_CAL_TABLE[WHEEL_LEFT][DIR_FORWARD], &motor_table_ram[WHEEL_LEFT][DIR_FORWARD]))
+    {
+        Cal_UpdateMotorTable(WHEEL_LEFT, DIR_FORWARD);
+    }
+    if (!CalTable_Decode(WHEEL_DIR_TO_CAL_TABLE[WHEEL_LEFT][DIR_BACKWARD], &motor_table_ram[WHEEL_LEFT][DIR_BACKWARD]))
+    {
+        Cal_UpdateMotorTable(WHEEL_LEFT, DIR_BACKWARD);
+    }
+    if (!CalTable_Decode(WHEEL_DIR_TO_CAL_TABLE[WHEEL_RIGHT][DIR_FORWARD], &motor_table_ram[WHEEL_RIGHT][DIR_FORWARD]))
+    {
+        Cal_UpdateMotorTable(WHEEL_RIGHT, DIR_FORWARD);
+    }
+    if (!CalTable_Decode(WHEEL_DIR_TO_CAL_TABLE[WHEEL_RIGHT][DIR_BACKWARD], &motor_table_ram[WHEEL_RIGHT][DIR_BACKWARD]))
+    {
+        Cal_UpdateMotorTable(WHEEL_RIGHT, DIR_BACKWARD);
+    }
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Cal_CalMaxCps
  * Description: Calculates the minimum of the maximum CPS values between the left/right motors. 
@@ -1563,7 +2003,7 @@ FLOAT Cal_CalcMaxCps()
     right_max = min(right_fwd_max, right_bwd_max);
     
     max_leftright_cps = min(left_max, right_max);
-    max_leftright_pid = min(LEFTPID_MAX, RIGHTPID_MAX);
+    max_leftright_pid = PIDBANK_WHEEL_MAX;
 
     return min(max_leftright_cps, max_leftright_pid);
 }
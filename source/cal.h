@@ -75,6 +75,7 @@ SOFTWARE.
 #define CAL_PID_BIT             (0x0002)
 #define CAL_LINEAR_BIT          (0x0004)
 #define CAL_ANGULAR_BIT         (0x0008)
+#define CAL_CASCADE_BIT         (0x0010)
 #define CAL_VERBOSE_BIT         (0x0080)
     
 #define CAL_SCALE_FACTOR (100)
@@ -197,10 +198,12 @@ void Cal_PrintRightMotorParams(BOOL as_json);
 void Cal_PrintAllMotorParams(BOOL as_json);
 void Cal_PrintMotorParams(WHEEL_TYPE wheel, BOOL as_json);
 void Cal_PrintSamples(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_DATA_TYPE* const cal_data, UINT8 as_json);
+void Cal_PrintMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_MOTOR_MODEL_TYPE* const model, UINT8 as_json);
 void Cal_PrintPidGains(WHEEL_TYPE wheel, FLOAT* const gains, UINT8 as_json);
 void Cal_PrintLeftPidGains(BOOL as_json);
 void Cal_PrintRightPidGains(BOOL as_json);
 void Cal_PrintAllPidGains(BOOL as_json);
+void Cal_PrintPidSchedule(WHEEL_TYPE wheel, CAL_PID_SCHED_TYPE* const sched, UINT8 as_json);
 
 
 void Cal_CalcTriangularProfile(UINT8 num_points, FLOAT lower_limit, FLOAT upper_limit, FLOAT* const forward_output, FLOAT* const backward_output);
@@ -216,7 +219,17 @@ CAL_PID_TYPE* Cal_GetPidGains(PID_ENUM_TYPE pid);
 UINT16 Cal_GetStatus();
 void Cal_PrintStatus(UINT8 as_json);
 void Cal_SetGains(PID_ENUM_TYPE pid, FLOAT* const gains);
+CAL_PID_SCHED_TYPE* Cal_GetPidSchedule(PID_ENUM_TYPE pid);
+BOOL Cal_IsPidScheduleValid(CAL_PID_SCHED_TYPE* const sched);
+void Cal_SetPidSchedule(PID_ENUM_TYPE pid, CAL_PID_SCHED_TYPE* const sched);
+CAL_RATE_TYPE* Cal_GetSampleRates();
+void Cal_SetSampleRates(CAL_RATE_TYPE* const rates);
 CAL_DATA_TYPE* Cal_GetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir);
+CAL_MOTOR_MODEL_TYPE* Cal_GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir);
+void Cal_SetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_MOTOR_MODEL_TYPE* const model);
+CAL_DATA_TYPE* Cal_GetRamMotorData(WHEEL_TYPE wheel, DIR_TYPE dir);
+void Cal_LoadMotorData();
+UINT8 Cal_UpdateMotorTable(WHEEL_TYPE wheel, DIR_TYPE dir);
 
 void Cal_SetAngularBias(FLOAT bias);
 void Cal_SetLinearBias(FLOAT bias);
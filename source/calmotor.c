@@ -36,6 +36,13 @@ SOFTWARE.
     for left motor forward, left motor backward, right motor forward and right motor backward.  The calibration data is
     stored in NVRAM on the Psoc and pointers to the calibration data are passed to the motor module.
     
+    The sweep also identifies a first-order model of each motor (see CAL_MOTOR_MODEL_TYPE):
+        - deadband is the smallest pwm offset at which the wheel turns
+        - gain is the least-squares slope of count/sec vs pwm offset above the deadband
+        - tau is the time for the wheel speed to make 63.2% of the change between consecutive pwm steps,
+          averaged over the steps weighted by the size of the change
+    The model is used by the wheel PIDs as a feedforward of the commanded acceleration (see pidbank.c).
+    
     Upon startup, the calibration data is made available to the motors via pointers to NVRAM (Note: the EEPROM component
     maps NVRAM to memory so there is no appreciable overhead in reading from NVRAM (or so I believe until proven otherwise)
 
@@ -46,6 +53,7 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/
 #include <stdio.h>
 #include <limits.h>
+#include <string.h>
 #include "calmotor.h"
 #include "motor.h"
 #include "pwm.h"
@@ -56,9 +64,10 @@ SOFTWARE.
 #include "utils.h"
 #include "debug.h"
 #include "pid.h"
-#include "pidleft.h"
-#include "pidright.h"
 #include "control.h"
+#include "caltable.h"
+#include "pidbank.h"
+#include "arena.h"
 
 /*---------------------------------------------------------------------------------------------------
  * Constants
@@ -67,9 +76,25 @@ SOFTWARE.
 #define CALIBRATION_ITERATION_DONE (255)
 #define MAX_CPS_ARRAY (51)
 #define NUM_MOTOR_CAL_PARAMS (4)
-#define PWM_TEST_TIME (250)
+#define NUM_MOTOR_CAL_PAIRS (2)
+#define PWM_TEST_TIME (250)  // maximum dwell per pwm step (millisecond)
 #define CPS_SAMPLE_TIME (25)
+/* Settling detection: a pwm step is considered settled when the last SETTLE_WINDOW_SIZE count/sec samples
+   have a standard deviation and a first-to-last change within tolerance.  The tolerance is a percentage of the
+   mean count/sec, but never less than SETTLE_TOLERANCE_MIN_CPS because at CPS_SAMPLE_TIME one encoder count
+   is worth 40 count/sec.
+*/
+#define SETTLE_WINDOW_SIZE (4)
+#define SETTLE_TOLERANCE_PERCENT (5)
+#define SETTLE_TOLERANCE_MIN_CPS (80)
+#define MAX_CONFIDENCE (100)
 #define MOTOR_RAMP_DOWN_TIME (1000) // millisecond
+/* Motor model identification: the step response is recorded for each pwm step, and only steps with a change
+   in count/sec of at least TAU_MIN_DELTA_CPS are used to estimate the time constant.
+*/
+#define MAX_STEP_SAMPLES (PWM_TEST_TIME / CPS_SAMPLE_TIME + 2)
+#define TAU_MIN_DELTA_CPS (200)
+#define TAU_RISE_FRACTION (0.632)
 
 /*---------------------------------------------------------------------------------------------------
  * Macros
@@ -93,29 +118,67 @@ typedef struct _cal_motor_params
     INT32       *p_cps_avg;
     SET_MOTOR_PWM_FUNC_TYPE set_pwm;
     RAMP_DOWN_PWM_FUNC_TYPE ramp_down;
+    RAMP_DONE_FUNC_TYPE ramp_done;
     GET_RAW_COUNT_FUNC_TYPE get_count;
     RESET_COUNT_FUNC_TYPE reset;
+    /* Per-run state: kept here (rather than in function statics) so that both wheels can be 
+       calibrated at the same time.
+    */
+    BOOL        pwm_running;
+    UINT32      pwm_start_time;
+    UINT32      sample_start_time;
+    INT32       last_count;
+    UINT8       num_cps_samples_collected;
+    INT32       settle_window[SETTLE_WINDOW_SIZE];
+    UINT32      dwell_time;
+    UINT16      num_steps;
+    UINT16      num_settled;
+    BOOL        iteration_done;
+    BOOL        stopping;
+    /* Motor model identification */
+    INT32       step_cps[MAX_STEP_SAMPLES];
+    UINT16      step_time[MAX_STEP_SAMPLES];
+    INT32       prev_cps;
+    FLOAT       tau_sum;
+    FLOAT       tau_weight;
 } CAL_MOTOR_PARAMS;
 
-
-/*---------------------------------------------------------------------------------------------------
- * Variables
- *-------------------------------------------------------------------------------------------------*/
 /* Note: Calibration performs several iterations over the full range of the motor speed in order gather 
    enough data to determine an average count/sec.  While the final count/sec value stored is INT16
    (in order to save space) the arrays that sum and average the count/sec values must be int32 to 
    avoid overflow.
+
+   Each wheel has its own set of arrays so that the left and right wheels can be calibrated in parallel.  The
+   forward and backward runs for a wheel are always sequential, so they share the wheel's arrays.
+   
+   The arrays are only needed while calibrating, so they are allocated from the mode arena (see arena.c).
 */
-static INT32         cal_cps_samples[CAL_NUM_SAMPLES];
-static UINT16        cal_pwm_samples[CAL_NUM_SAMPLES];
-static INT32         cal_cps_avg[CAL_NUM_SAMPLES];
+typedef struct _cal_motor_buffers
+{
+    INT32       cps_samples[2][CAL_NUM_SAMPLES];
+    PWM_TYPE    pwm_samples[2][CAL_NUM_SAMPLES];
+    INT32       cps_avg[2][CAL_NUM_SAMPLES];
+    /* Per-step confidence (0 - 100) in the measured count/sec, the lowest value over all iterations is kept */
+    UINT8       confidence[2][CAL_NUM_SAMPLES];
+} CAL_MOTOR_BUFFERS_TYPE;
+
+ARENA_ASSERT_FITS(CAL_MOTOR_BUFFERS_TYPE);
+
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static CAL_MOTOR_BUFFERS_TYPE *buffers;
 static CAL_DATA_TYPE cal_data;
+static CAL_MOTOR_MODEL_TYPE cal_model;
 
 static CAL_MOTOR_PARAMS *cal_params;
 
 static UINT8 motor_cal_iterations;
+static BOOL motor_cal_parallel;
     
 /* The PWM params: start, end, step are defined for each motor (left/right) and each direction (forward/backward)
+   Note: step is the uniform spacing; the calibration samples are placed between start and end by CalTable_SampleOffset.
    In general, the servo interface to the motors is defined as follows:
         1500 - stop
         2000 - full forward
@@ -175,15 +238,32 @@ static CAL_MOTOR_PARAMS motor_cal_params[NUM_MOTOR_CAL_PARAMS] =
         /* iterations */ DEFAULT_MOTOR_CAL_ITERATION,
         /* pwm_time */ PWM_TEST_TIME,
         /* pwm_index */ 0,
-        /* p_pwm_samples */ &cal_pwm_samples[0],
+        /* p_pwm_samples */ NULL,
         /* sample_time */ CPS_SAMPLE_TIME,
         /* sample_index */ 0,
-        /* p_cps_samples */ &cal_cps_samples[0],
-        /* cal_cps_avg */ &cal_cps_avg[0],
+        /* p_cps_samples */ NULL,
+        /* cal_cps_avg */ NULL,
         Motor_LeftSetPwm,
         Motor_LeftRampDown,
+        Motor_LeftRampDone,
         Encoder_LeftGetRawCount,
-        Encoder_LeftReset
+        Encoder_LeftReset,
+        /* pwm_running */ FALSE,
+        /* pwm_start_time */ 0,
+        /* sample_start_time */ 0,
+        /* last_count */ 0,
+        /* num_cps_samples_collected */ 0,
+        /* settle_window */ {0},
+        /* dwell_time */ 0,
+        /* num_steps */ 0,
+        /* num_settled */ 0,
+        /* iteration_done */ FALSE,
+        /* stopping */ FALSE,
+        /* step_cps */ {0},
+        /* step_time */ {0},
+        /* prev_cps */ 0,
+        /* tau_sum */ 0.0,
+        /* tau_weight */ 0.0
     }, 
     {
         "left-backward",
@@ -192,15 +272,32 @@ static CAL_MOTOR_PARAMS motor_cal_params[NUM_MOTOR_CAL_PARAMS] =
         /* iterations */ DEFAULT_MOTOR_CAL_ITERATION,
         /* pwm_time */ PWM_TEST_TIME,
         0,
-        /* p_pwm_samples */ &cal_pwm_samples[0],
+        /* p_pwm_samples */ NULL,
         /* sample_time */ CPS_SAMPLE_TIME,
         0,
-        /* p_cps_samples */ &cal_cps_samples[0],
-        /* cal_cps_avg */ &cal_cps_avg[0],
+        /* p_cps_samples */ NULL,
+        /* cal_cps_avg */ NULL,
         Motor_LeftSetPwm,
         Motor_LeftRampDown,
+        Motor_LeftRampDone,
         Encoder_LeftGetRawCount,
-        Encoder_LeftReset        
+        Encoder_LeftReset,
+        /* pwm_running */ FALSE,
+        /* pwm_start_time */ 0,
+        /* sample_start_time */ 0,
+        /* last_count */ 0,
+        /* num_cps_samples_collected */ 0,
+        /* settle_window */ {0},
+        /* dwell_time */ 0,
+        /* num_steps */ 0,
+        /* num_settled */ 0,
+        /* iteration_done */ FALSE,
+        /* stopping */ FALSE,
+        /* step_cps */ {0},
+        /* step_time */ {0},
+        /* prev_cps */ 0,
+        /* tau_sum */ 0.0,
+        /* tau_weight */ 0.0
     }, 
     {
         "right-forward",
@@ -209,15 +306,32 @@ static CAL_MOTOR_PARAMS motor_cal_params[NUM_MOTOR_CAL_PARAMS] =
         /* iterations */ DEFAULT_MOTOR_CAL_ITERATION,
         /* pwm_time */ PWM_TEST_TIME,
         0,
-        /* p_pwm_samples */ &cal_pwm_samples[0],
+        /* p_pwm_samples */ NULL,
         /* sample_time */ CPS_SAMPLE_TIME,
         0,
-        /* p_cps_samples */ &cal_cps_samples[0],
-        /* cal_cps_avg */ &cal_cps_avg[0],
+        /* p_cps_samples */ NULL,
+        /* cal_cps_avg */ NULL,
         Motor_RightSetPwm,
         Motor_RightRampDown,
+        Motor_RightRampDone,
         Encoder_RightGetRawCount,
-        Encoder_RightReset
+        Encoder_RightReset,
+        /* pwm_running */ FALSE,
+        /* pwm_start_time */ 0,
+        /* sample_start_time */ 0,
+        /* last_count */ 0,
+        /* num_cps_samples_collected */ 0,
+        /* settle_window */ {0},
+        /* dwell_time */ 0,
+        /* num_steps */ 0,
+        /* num_settled */ 0,
+        /* iteration_done */ FALSE,
+        /* stopping */ FALSE,
+        /* step_cps */ {0},
+        /* step_time */ {0},
+        /* prev_cps */ 0,
+        /* tau_sum */ 0.0,
+        /* tau_weight */ 0.0
     }, 
     {
         "right-backward",
@@ -226,18 +340,45 @@ static CAL_MOTOR_PARAMS motor_cal_params[NUM_MOTOR_CAL_PARAMS] =
         /* iterations */ DEFAULT_MOTOR_CAL_ITERATION,
         /* pwm_time */ PWM_TEST_TIME,
         0,
-        /* p_pwm_samples */ &cal_pwm_samples[0],
+        /* p_pwm_samples */ NULL,
         /* sample_time */ CPS_SAMPLE_TIME,
         0,
-        /* p_cps_samples */ &cal_cps_samples[0],
-        /* cal_cps_avg */ &cal_cps_avg[0],
+        /* p_cps_samples */ NULL,
+        /* cal_cps_avg */ NULL,
         Motor_RightSetPwm,
         Motor_RightRampDown,
+        Motor_RightRampDone,
         Encoder_RightGetRawCount,
-        Encoder_RightReset
+        Encoder_RightReset,
+        /* pwm_running */ FALSE,
+        /* pwm_start_time */ 0,
+        /* sample_start_time */ 0,
+        /* last_count */ 0,
+        /* num_cps_samples_collected */ 0,
+        /* settle_window */ {0},
+        /* dwell_time */ 0,
+        /* num_steps */ 0,
+        /* num_settled */ 0,
+        /* iteration_done */ FALSE,
+        /* stopping */ FALSE,
+        /* step_cps */ {0},
+        /* step_time */ {0},
+        /* prev_cps */ 0,
+        /* tau_sum */ 0.0,
+        /* tau_weight */ 0.0
     }
 };
 
+/* When calibrating both wheels in parallel, each wheel running forward is paired with the other wheel running 
+   backward.  The robot spins in place rather than driving off the bench or across the floor.
+   Note: indices refer to motor_cal_params above.
+*/
+static const UINT8 motor_cal_pairs[NUM_MOTOR_CAL_PAIRS][2] = 
+{
+    /* left-forward, right-backward */ {0, 3},
+    /* left-backward, right-forward */ {1, 2}
+};
+
 static UINT8 motor_cal_index;
 static UINT8 motor_cal_end;
 
@@ -294,96 +435,294 @@ static void CalculateMinMaxCpsSample(INT32* const samples, INT32* const min, INT
 /*---------------------------------------------------------------------------------------------------
  * Name: InitCalibrationParams
  * Description: Calculates an array of pwm values based on the specified wheel, and direction. 
- * Parameters: wheel - left/right wheel 
- *             dir - forward/backward direction
- *             pwm_samples - array of pwm values
- *             reverse_pwm - indicates the ordering within the pwm samples
+ * Parameters: params - the motor calibration parameters (wheel, direction, sample arrays)
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
-static void InitCalibrationParams()
+static void InitCalibrationParams(CAL_MOTOR_PARAMS* const params)
 {
     UINT8 ii;
-    UINT16 pwm;
-    UINT16 pwm_start;
-    INT16 pwm_step;
+    UINT16 pwm_full;
+    UINT16 pwm_domain;
+    UINT16 pwm_offset;
     WHEEL_TYPE wheel;
     DIR_TYPE dir;
      
-    wheel = cal_params->wheel;
-    dir = cal_params->direction;
+    wheel = params->wheel;
+    dir = params->direction;
         
-    pwm_start = pwm_params[wheel][dir].start;
-    pwm_step = pwm_params[wheel][dir].step;
+    pwm_full = dir == DIR_FORWARD ? pwm_params[wheel][dir].end : pwm_params[wheel][dir].start;
+    pwm_domain = pwm_full > PWM_STOP ? pwm_full - PWM_STOP : PWM_STOP - pwm_full;
      
     /* The pwm samples are filled in from lowest value to highest PWM value.  This ensures that the
        corresponding count/sec values (stored in a different array) are ordered from lowest value to
        highest value, i.e., forward: 0 to max cps, reverse: -max cps to 0.
+     
+       The samples are not evenly spaced: they are dense near PWM_STOP where the motor response is 
+       nonlinear and sparse towards full speed (see CalTable_SampleOffset).
     */
-    for (ii =0, pwm = pwm_start; ii < CAL_NUM_SAMPLES; ++ii, pwm += pwm_step)
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
     {
-        cal_params->p_pwm_samples[ii] = pwm;
-        cal_params->p_cps_samples[ii] = 0;
-        cal_params->p_cps_avg[ii] = 0;
+        pwm_offset = CalTable_SampleOffset(PWM_CALC_OFFSET(dir, ii), pwm_domain);
+        params->p_pwm_samples[ii] = pwm_full > PWM_STOP ? PWM_STOP + pwm_offset : PWM_STOP - pwm_offset;
+        params->p_cps_samples[ii] = 0;
+        params->p_cps_avg[ii] = 0;
+        buffers->confidence[wheel][ii] = MAX_CONFIDENCE;
     }
   
     /* The first pwm entry is always PWM_STOP and it must correspond to CPS value 0 in order to stop the motor.  So,
        So, set pwm_index to start at 1.
     */
-    cal_params->pwm_index = 1;
-    cal_params->iterations = motor_cal_iterations;
+    params->pwm_index = 1;
+    params->iterations = motor_cal_iterations;
+    params->pwm_running = FALSE;
+    params->iteration_done = FALSE;
+    params->stopping = FALSE;
+    params->dwell_time = 0;
+    params->num_steps = 0;
+    params->num_settled = 0;
+    params->prev_cps = 0;
+    params->tau_sum = 0.0;
+    params->tau_weight = 0.0;
  }
   
-static UINT8 GetNextPwm(PWM_TYPE* const pwm)
+static UINT8 GetNextPwm(CAL_MOTOR_PARAMS* const params, PWM_TYPE* const pwm)
 {
     UINT8 index;
 
-    if (cal_params->pwm_index < CAL_NUM_SAMPLES)
+    if (params->pwm_index < CAL_NUM_SAMPLES)
     {
-        index = PWM_CALC_OFFSET(cal_params->direction, cal_params->pwm_index);
-        *pwm = cal_params->p_pwm_samples[index];
-        cal_params->cps_index = index;
-        cal_params->pwm_index++;
+        index = PWM_CALC_OFFSET(params->direction, params->pwm_index);
+        *pwm = params->p_pwm_samples[index];
+        params->cps_index = index;
+        params->pwm_index++;
         return 0;
     }
     
     /* Reset the pwm_index for next run.  this is needed doing an average and multiple iterations 
        are run because there is no initialziation between iterations 
     */
-    cal_params->pwm_index = 1;            
+    params->pwm_index = 1;            
     
     return 1;        
 }
 
-static UINT8 PerformMotorCalibrationIteration()
+/*---------------------------------------------------------------------------------------------------
+ * Name: StopMotorCalibrationIteration
+ * Description: Ramps down and stops the motor at the end of a pwm sweep.  The ramp is stepped from 
+ *              the main loop so this routine is called until it returns TRUE.
+ * Parameters: params - the motor calibration parameters
+ * Return: BOOL - TRUE when the motor is stopped, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL StopMotorCalibrationIteration(CAL_MOTOR_PARAMS* const params)
+{
+    /* We've finished running a series of pwm values:
+        1. Ramp down the motor speed to be nice to the motor
+        2. Stop the motors (just to make sure)
+    */
+    if (!params->stopping)
+    {
+        params->ramp_down(MOTOR_RAMP_DOWN_TIME);
+        params->stopping = TRUE;
+    }
+    
+    if (params->ramp_done())
+    {
+        params->set_pwm(PWM_STOP);
+        params->stopping = FALSE;
+        return TRUE;
+    }
+    
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalculateCpsStatistics
+ * Description: Calculates the mean, variance and trend of the count/sec samples in the settling window.
+ * Parameters: params - the motor calibration parameters
+ *             mean - the mean count/sec of the window
+ *             variance - the variance of the count/sec samples in the window
+ *             trend - the change from the oldest to the newest count/sec sample in the window
+ * Return: UINT8 - the number of samples in the window
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 CalculateCpsStatistics(CAL_MOTOR_PARAMS* const params, FLOAT* const mean, FLOAT* const variance, FLOAT* const trend)
 {
-    static UINT8 pwm_running = FALSE;
-    static UINT32 pwm_start_time = 0;
-    static UINT32 sample_start_time = 0;
-    static INT32 last_count = 0;
-    static UINT8 num_cps_samples_collected;
+    UINT8 ii;
+    UINT8 num_samples;
+    UINT8 newest;
+    UINT8 oldest;
+    FLOAT sum;
+    FLOAT diff;
+
+    num_samples = min(params->num_cps_samples_collected, SETTLE_WINDOW_SIZE);
+    *mean = 0.0;
+    *variance = 0.0;
+    *trend = 0.0;
     
+    if (num_samples == 0)
+    {
+        return 0;
+    }
+
+    for (ii = 0, sum = 0.0; ii < num_samples; ++ii)
+    {
+        sum += params->settle_window[ii];
+    }
+    *mean = sum / num_samples;
+
+    for (ii = 0, sum = 0.0; ii < num_samples; ++ii)
+    {
+        diff = params->settle_window[ii] - *mean;
+        sum += diff * diff;
+    }
+    *variance = sum / num_samples;
+
+    /* The window is a ring buffer indexed by the number of samples collected */
+    newest = (params->num_cps_samples_collected - 1) % SETTLE_WINDOW_SIZE;
+    oldest = params->num_cps_samples_collected < SETTLE_WINDOW_SIZE ? 0 : params->num_cps_samples_collected % SETTLE_WINDOW_SIZE;
+    *trend = params->settle_window[newest] - params->settle_window[oldest];
+    
+    return num_samples;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: IsCpsSettled
+ * Description: Determines whether the wheel speed has reached steady state for the current pwm step.
+ * Parameters: params - the motor calibration parameters
+ * Return: BOOL - TRUE if the count/sec samples are settled, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL IsCpsSettled(CAL_MOTOR_PARAMS* const params)
+{
+    FLOAT mean;
+    FLOAT variance;
+    FLOAT trend;
+    FLOAT tolerance;
+    UINT8 num_samples;
+
+    num_samples = CalculateCpsStatistics(params, &mean, &variance, &trend);
+    if (num_samples < SETTLE_WINDOW_SIZE)
+    {
+        return FALSE;
+    }
+
+    tolerance = max(abs(mean) * SETTLE_TOLERANCE_PERCENT / 100.0, SETTLE_TOLERANCE_MIN_CPS);
+
+    /* Note: comparing the variance against the squared tolerance avoids a sqrt per sample */
+    return variance <= tolerance * tolerance && abs(trend) <= tolerance;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: AccumulateTimeConstant
+ * Description: Estimates the time constant from the step response of the current pwm step, i.e., the
+ *              time at which the wheel speed makes 63.2% of the change from the previous step to the 
+ *              settled speed.  The crossing is interpolated between the count/sec samples which are
+ *              placed at the middle of their sample period.
+ * Parameters: params - the motor calibration parameters
+ *             settled_cps - the steady state count/sec of the step
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void AccumulateTimeConstant(CAL_MOTOR_PARAMS* const params, FLOAT settled_cps)
+{
+    UINT8 ii;
+    UINT8 num_samples;
+    FLOAT delta;
+    FLOAT frac;
+    FLOAT last_frac;
+    FLOAT last_time;
+    FLOAT cross_time;
+
+    delta = settled_cps - params->prev_cps;
+    if (abs(delta) < TAU_MIN_DELTA_CPS)
+    {
+        return;
+    }
+
+    num_samples = min(params->num_cps_samples_collected, MAX_STEP_SAMPLES);
+    last_frac = 0.0;
+    last_time = 0.0;
+    for (ii = 0; ii < num_samples; ++ii)
+    {
+        frac = (params->step_cps[ii] - params->prev_cps) / delta;
+        if (frac >= TAU_RISE_FRACTION)
+        {
+            cross_time = last_time + (params->step_time[ii] - last_time) * (TAU_RISE_FRACTION - last_frac) / (frac - last_frac);
+            params->tau_sum += abs(delta) * cross_time / MILLIS_PER_SECOND;
+            params->tau_weight += abs(delta);
+            return;
+        }
+        last_frac = frac;
+        last_time = params->step_time[ii];
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: FinishCalibrationStep
+ * Description: Stores the steady state count/sec for the current pwm step along with its confidence.
+ *              The confidence is 100 minus the coefficient of variation (in percent) of the samples
+ *              in the settling window.
+ * Parameters: params - the motor calibration parameters
+ *             dwell - the time (in milliseconds) spent on the pwm step
+ *             settled - indicates whether the step settled or ran to the maximum dwell
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void FinishCalibrationStep(CAL_MOTOR_PARAMS* const params, UINT32 dwell, BOOL settled)
+{
+    FLOAT mean;
+    FLOAT variance;
+    FLOAT trend;
+    FLOAT cv;
+    UINT8 confidence;
+
+    CalculateCpsStatistics(params, &mean, &variance, &trend);
+
+    /* Note: cps_index is set when select the pwm (see GetNextPwm) */
+    params->p_cps_samples[params->cps_index] = (INT32) mean;
+
+    AccumulateTimeConstant(params, mean);
+    params->prev_cps = (INT32) mean;
+
+    if (mean == 0.0)
+    {
+        confidence = variance == 0.0 ? MAX_CONFIDENCE : 0;
+    }
+    else
+    {
+        cv = MAX_CONFIDENCE * sqrt(variance) / abs(mean);
+        confidence = (UINT8) constrain(MAX_CONFIDENCE - cv, 0.0, MAX_CONFIDENCE);
+    }
+
+    if (confidence < buffers->confidence[params->wheel][params->cps_index])
+    {
+        buffers->confidence[params->wheel][params->cps_index] = confidence;
+    }
+    
+    params->dwell_time += dwell;
+    params->num_steps++;
+    params->num_settled += settled ? 1 : 0;
+}
+
+static UINT8 PerformMotorCalibrationIteration(CAL_MOTOR_PARAMS* const params)
+{
     UINT32 now;
     UINT32 pwm_delta;
     PWM_TYPE pwm;
     UINT32 sample;
     UINT8 result;
     INT32 count;
-    INT32 total_sample_time;
-    INT32 total_counts;
 
-    if (!pwm_running)
+    if (!params->pwm_running)
     {        
-        result = GetNextPwm(&pwm);
+        result = GetNextPwm(params, &pwm);
         if (result)
         {
-            /* We've finished running a series of pwm values:
-                1. Ramp down the motor speed to be nice to the motor
-                2. Stop the motors (just to make sure)
-                3. Reset the pwm index (we might not be the last iteration)
+            /* Note: the motor is left running at the last pwm; the caller is responsible for stopping it 
+               (see StopMotorCalibrationIteration) so that paired motors can be stopped together.
             */
-            cal_params->ramp_down(MOTOR_RAMP_DOWN_TIME);
-            cal_params->set_pwm(PWM_STOP);
             return CALIBRATION_ITERATION_DONE;
         }
 
@@ -392,95 +731,245 @@ static UINT8 PerformMotorCalibrationIteration()
             2. Set the running flag
             3. Grab the current time for pwm running and cps sampling
         */
-        cal_params->set_pwm(pwm);
+        params->set_pwm(pwm);
 
-        num_cps_samples_collected = 0;
-        pwm_running = TRUE;
-        cal_params->reset();
-        last_count = cal_params->get_count();
-        pwm_start_time = millis();
-        sample_start_time = millis();
+        params->num_cps_samples_collected = 0;
+        params->pwm_running = TRUE;
+        params->reset();
+        params->last_count = params->get_count();
+        params->pwm_start_time = millis();
+        params->sample_start_time = millis();
     }
     
-    if (pwm_running)
+    if (params->pwm_running)
     {   
         now = millis();
-        pwm_delta = now - pwm_start_time;
-        sample = now - sample_start_time;
+        pwm_delta = now - params->pwm_start_time;
+        sample = now - params->sample_start_time;
         
         /* Is the pwm time up? */
-        if (pwm_delta < cal_params->pwm_time)
+        if (pwm_delta < params->pwm_time)
         {                
             /* Is is time to sample? */
-            if (sample > cal_params->sample_time)
+            if (sample > params->sample_time)
             {
-                /* Note: cps_index is set when select the pwm (see GetNextPwm) */
-                sample_start_time = millis();
-                count = cal_params->get_count();
-                cal_params->p_cps_samples[cal_params->cps_index] += (count - last_count);
-                last_count = count;
-                num_cps_samples_collected++;
+                /* Convert the counts over the actual elapsed sample time to count/sec and add it to
+                   the settling window.
+                */
+                params->sample_start_time = now;
+                count = params->get_count();
+                params->settle_window[params->num_cps_samples_collected % SETTLE_WINDOW_SIZE] = 
+                    (count - params->last_count) * MILLIS_PER_SECOND / (INT32) sample;
+                params->last_count = count;
+                if (params->num_cps_samples_collected < MAX_STEP_SAMPLES)
+                {
+                    params->step_cps[params->num_cps_samples_collected] = 
+                        params->settle_window[params->num_cps_samples_collected % SETTLE_WINDOW_SIZE];
+                    params->step_time[params->num_cps_samples_collected] = pwm_delta - sample / 2;
+                }
+                params->num_cps_samples_collected++;
+
+                /* Move on as soon as the wheel speed has settled */
+                if (IsCpsSettled(params))
+                {
+                    FinishCalibrationStep(params, pwm_delta, TRUE);
+                    params->pwm_running = FALSE;
+                }
             }
         }
         else
         {
-            /* Pwm time is up */
-
-            /* Calculate total sample time, count average and counts/second */
-            total_sample_time = cal_params->sample_time * num_cps_samples_collected;
-            total_counts = cal_params->p_cps_samples[cal_params->cps_index];
-            cal_params->p_cps_samples[cal_params->cps_index] = total_counts * MILLIS_PER_SECOND / total_sample_time;
-            //Ser_PutStringFormat("tst: %d, tc: %d, cps: %d\r\n", total_sample_time, total_counts, cal_params->p_cps_samples[params->cps_index]);
-            pwm_running = FALSE;
+            /* Pwm time is up, i.e., the step did not settle within the maximum dwell */
+            FinishCalibrationStep(params, pwm_delta, FALSE);
+            params->pwm_running = FALSE;
         } 
     }
     
     return CAL_OK;
 }
 
-static UINT8 PerformMotorCalibrateAverage()
+/*---------------------------------------------------------------------------------------------------
+ * Name: AccumulateMotorCalibrationIteration
+ * Description: Adds the count/sec values of a completed iteration to the running sum and clears the
+ *              samples for the next iteration.
+ * Parameters: params - the motor calibration parameters
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void AccumulateMotorCalibrationIteration(CAL_MOTOR_PARAMS* const params)
+{
+    UINT8 ii;
+
+    params->iterations--;
+    
+    /* Each iteration starts from a stopped motor */
+    params->prev_cps = 0;
+
+    /* Sum the collected cps's */
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        params->p_cps_avg[ii] += params->p_cps_samples[ii];
+        params->p_cps_samples[ii] = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalculateMotorCalibrationAverage
+ * Description: Divides the summed count/sec values by the number of iterations.
+ * Parameters: params - the motor calibration parameters
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void CalculateMotorCalibrationAverage(CAL_MOTOR_PARAMS* const params)
 {
     UINT8 ii;
+
+    /* Calculate average cps's */
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        params->p_cps_avg[ii] = params->p_cps_avg[ii]/motor_cal_iterations;
+        //Ser_PutStringFormat("Avg CPS (%d): %d\r\n", params->p_pwm_samples[ii], params->p_cps_avg[ii]);
+    }
+}
+
+static UINT8 PerformMotorCalibrateAverage(CAL_MOTOR_PARAMS* const params)
+{
     UINT8 result;
     
-    if (cal_params->iterations > 0)
+    if (params->iterations > 0)
     {
-        result = PerformMotorCalibrationIteration();
-        if (result == CALIBRATION_ITERATION_DONE)
+        if (!params->iteration_done)
+        {
+            result = PerformMotorCalibrationIteration(params);
+            params->iteration_done = result == CALIBRATION_ITERATION_DONE;
+        }
+        
+        if (params->iteration_done && StopMotorCalibrationIteration(params))
         {            
-            cal_params->iterations--;
-            
-            /* Sum the collected cps's */
-            for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
-            {
-                cal_params->p_cps_avg[ii] += cal_params->p_cps_samples[ii];
-                cal_params->p_cps_samples[ii] = 0;
-            }
+            AccumulateMotorCalibrationIteration(params);
+            params->iteration_done = FALSE;
         }
         return CAL_OK;
     }
     
-    /* Calculate average cps's */
-    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    CalculateMotorCalibrationAverage(params);
+    
+    return CALIBRATION_ITERATION_DONE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PerformParallelMotorCalibrateAverage
+ * Description: Runs the calibration iterations for two motors at the same time.  The pwm sweeps of 
+ *              both motors are kept in lock step: a motor that finishes its sweep is held at its last
+ *              pwm until the other motor finishes, then both are stopped and the next iteration is 
+ *              started for both.
+ * Parameters: first - the motor calibration parameters of the first motor
+ *             second - the motor calibration parameters of the second motor
+ * Return: UINT8 - CAL_OK, CALIBRATION_ITERATION_DONE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 PerformParallelMotorCalibrateAverage(CAL_MOTOR_PARAMS* const first, CAL_MOTOR_PARAMS* const second)
+{
+    /* Note: both motors are initialized with the same number of iterations and are stopped together so 
+       checking the first is sufficient.
+    */
+    if (first->iterations > 0)
     {
-        cal_params->p_cps_avg[ii] = cal_params->p_cps_avg[ii]/motor_cal_iterations;
-        //Ser_PutStringFormat("Avg CPS (%d): %d\r\n", cal_params->p_pwm_samples[ii], cal_params->p_cps_avg[ii]);
+        if (!first->iteration_done)
+        {
+            first->iteration_done = PerformMotorCalibrationIteration(first) == CALIBRATION_ITERATION_DONE;
+        }
+        
+        if (!second->iteration_done)
+        {
+            second->iteration_done = PerformMotorCalibrationIteration(second) == CALIBRATION_ITERATION_DONE;
+        }
+        
+        /* Both motors ramp down together; a motor that stops first reports stopped until the other does.
+           Note: & rather than && so that both ramps are polled.
+        */
+        if (first->iteration_done && second->iteration_done && 
+            StopMotorCalibrationIteration(first) & StopMotorCalibrationIteration(second))
+        {
+            AccumulateMotorCalibrationIteration(first);
+            AccumulateMotorCalibrationIteration(second);
+            first->iteration_done = FALSE;
+            second->iteration_done = FALSE;
+        }
+        return CAL_OK;
     }
     
+    CalculateMotorCalibrationAverage(first);
+    CalculateMotorCalibrationAverage(second);
+    
     return CALIBRATION_ITERATION_DONE;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: IdentifyMotorModel
+ * Description: Identifies the first-order motor model from the averaged count/sec samples and the
+ *              time constant accumulated over the pwm steps.
+ * Parameters: params - the motor calibration parameters
+ *             model - the identified motor model
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void IdentifyMotorModel(CAL_MOTOR_PARAMS* const params, CAL_MOTOR_MODEL_TYPE* const model)
+{
+    UINT8 ii;
+    FLOAT offset;
+    FLOAT sum_xy;
+    FLOAT sum_xx;
+    UINT16 deadband;
+    UINT16 pwm_offset;
+
+    memset(model, 0, sizeof(*model));
+
+    /* The deadband is the smallest pwm offset at which the wheel turns */
+    deadband = USHRT_MAX;
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        pwm_offset = abs((INT16) (params->p_pwm_samples[ii] - PWM_STOP));
+        if (params->p_cps_avg[ii] != 0 && pwm_offset < deadband)
+        {
+            deadband = pwm_offset;
+        }
+    }
+    
+    if (deadband == USHRT_MAX)
+    {
+        return;
+    }
+
+    /* Least-squares fit of |count/sec| = gain * (pwm offset - deadband), i.e., through the deadband */
+    sum_xy = 0.0;
+    sum_xx = 0.0;
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        pwm_offset = abs((INT16) (params->p_pwm_samples[ii] - PWM_STOP));
+        if (params->p_cps_avg[ii] != 0)
+        {
+            offset = pwm_offset - deadband;
+            sum_xy += offset * abs(params->p_cps_avg[ii]);
+            sum_xx += offset * offset;
+        }
+    }
+
+    model->deadband = deadband;
+    model->gain = sum_xx > 0.0 ? sum_xy / sum_xx : 0.0;
+    model->tau = params->tau_weight > 0.0 ? params->tau_sum / params->tau_weight : 0.0;
+    model->valid = model->gain > 0.0 && model->tau > 0.0;
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: StoreMotorCalibration
- * Description: 
- * Parameters: wheel - 
- *             dir -
- *             cps_samples -
- *             pwm_samples - 
+ * Description: Copies the averaged count/sec and pwm values into the calibration data format and
+ *              writes them to NVRAM.
+ * Parameters: params - the motor calibration parameters
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
-static void StoreMotorCalibration()
+static void StoreMotorCalibration(CAL_MOTOR_PARAMS* const params)
 {
     UINT8 ii;
 
@@ -494,35 +983,71 @@ static void StoreMotorCalibration()
     /* Remove unwanted spurious neg/pos values */
     for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
     {
-        if (cal_params->direction == DIR_FORWARD)
+        if (params->direction == DIR_FORWARD)
         {
-            if (cal_params->p_cps_avg[ii] < 0)
+            if (params->p_cps_avg[ii] < 0)
             {
-                cal_params->p_cps_avg[ii] = 0;
+                params->p_cps_avg[ii] = 0;
             }
         }
 
-        if (cal_params->direction == DIR_BACKWARD)
+        if (params->direction == DIR_BACKWARD)
         {
-            if (cal_params->p_cps_avg[ii] > 0)
+            if (params->p_cps_avg[ii] > 0)
             {
-                cal_params->p_cps_avg[ii] = 0;
+                params->p_cps_avg[ii] = 0;
             }
         }
     }
 
-    CalculateMinMaxCpsSample(cal_params->p_cps_avg, (INT32 *) &cal_data.cps_min, (INT32 *) &cal_data.cps_max);
+    CalculateMinMaxCpsSample(params->p_cps_avg, (INT32 *) &cal_data.cps_min, (INT32 *) &cal_data.cps_max);
     
     for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
     {
         /* Note: Just a reminder, count/sec storage is INT16 */
-        cal_data.pwm_data[ii] = (INT16) cal_params->p_pwm_samples[ii];
-        cal_data.cps_data[ii] = (INT16) cal_params->p_cps_avg[ii];       
+        cal_data.pwm_data[ii] = (INT16) params->p_pwm_samples[ii];
+        cal_data.cps_data[ii] = (INT16) params->p_cps_avg[ii];       
     }
 
-    Cal_SetMotorData(cal_params->wheel, cal_params->direction, &cal_data);
+    Cal_SetMotorData(params->wheel, params->direction, &cal_data);
+    
+    IdentifyMotorModel(params, &cal_model);
+    Cal_SetMotorModel(params->wheel, params->direction, &cal_model);
+    PidBank_LoadFeedforward();
 }
   
+/*---------------------------------------------------------------------------------------------------
+ * Name: PrintMotorCalibrationSummary
+ * Description: Prints the time saved by settling detection, i.e., the time spent on the pwm steps vs
+ *              running every step to the maximum dwell, and the per-step confidence.
+ * Parameters: params - the motor calibration parameters
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PrintMotorCalibrationSummary(CAL_MOTOR_PARAMS* const params)
+{
+    UINT8 ii;
+    UINT32 max_dwell_time;
+
+    max_dwell_time = params->num_steps * params->pwm_time;
+    
+    Ser_PutStringFormat("%s: dwell %d ms, saved %d ms, settled %d of %d steps\r\n", 
+                        params->label,
+                        params->dwell_time,
+                        max_dwell_time - params->dwell_time,
+                        params->num_settled,
+                        params->num_steps);
+    
+    Ser_PutString("confidence:");
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        Ser_PutStringFormat("%s%d", ii % 10 == 0 ? "\r\n  " : " ", buffers->confidence[params->wheel][ii]);
+    }
+    Ser_PutString("\r\n");
+    
+    Cal_PrintMotorModel(params->wheel, params->direction, Cal_GetMotorModel(params->wheel, params->direction), FALSE);
+}
+
 static UINT8 PerformMotorCalibration()
 {
     static UINT8 running = FALSE;
@@ -533,18 +1058,59 @@ static UINT8 PerformMotorCalibration()
         Ser_PutStringFormat("%s-%s Calibration\r\n", wheel_str[cal_params->wheel], direction_str[cal_params->direction]);
 
         Motor_SetPwm(PWM_STOP, PWM_STOP);
-        InitCalibrationParams();
+        InitCalibrationParams(cal_params);
+        
+        running = TRUE;
+    }
+    
+    if ( running )
+    {
+        result = PerformMotorCalibrateAverage(cal_params);
+        if (result)
+        {        
+            Motor_SetPwm(PWM_STOP, PWM_STOP);
+            StoreMotorCalibration(cal_params);
+            PrintMotorCalibrationSummary(cal_params);
+            Ser_PutString("Complete\r\n");
+            running = FALSE;
+            return CALIBRATION_ITERATION_DONE;
+        }
+    }
+    
+    return CAL_OK;
+}
+
+static UINT8 PerformParallelMotorCalibration()
+{
+    static UINT8 running = FALSE;
+    CAL_MOTOR_PARAMS *first;
+    CAL_MOTOR_PARAMS *second;
+    UINT8 result;
+    
+    first = &motor_cal_params[motor_cal_pairs[motor_cal_index][0]];
+    second = &motor_cal_params[motor_cal_pairs[motor_cal_index][1]];
+
+    if ( !running )
+    {
+        Ser_PutStringFormat("%s/%s Calibration\r\n", first->label, second->label);
+
+        Motor_SetPwm(PWM_STOP, PWM_STOP);
+        InitCalibrationParams(first);
+        InitCalibrationParams(second);
         
         running = TRUE;
     }
     
     if ( running )
     {
-        result = PerformMotorCalibrateAverage();
+        result = PerformParallelMotorCalibrateAverage(first, second);
         if (result)
         {        
             Motor_SetPwm(PWM_STOP, PWM_STOP);
-            StoreMotorCalibration();
+            StoreMotorCalibration(first);
+            StoreMotorCalibration(second);
+            PrintMotorCalibrationSummary(first);
+            PrintMotorCalibrationSummary(second);
             Ser_PutString("Complete\r\n");
             running = FALSE;
             return CALIBRATION_ITERATION_DONE;
@@ -579,8 +1145,37 @@ static UINT8 NextCalParams(void)
 /*----------------------------------------------------------------------------------------------------------------------
  * Module Interface Routines
  *---------------------------------------------------------------------------------------------------------------------*/
-void CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters)
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalMotor_Init
+ * Description: Initializes motor calibration for the specified wheel(s).
+ * Parameters: wheel - the wheel to calibrate (left, right, both)
+ *             iters - the number of iterations over which the count/sec values are averaged
+ *             parallel - calibrate the left and right wheels at the same time (only applies to both 
+ *                        wheels)
+ * Return: BOOL - TRUE if the calibration buffers were allocated; otherwise, FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters, BOOL parallel)
 {
+    UINT8 ii;
+    WHEEL_TYPE params_wheel;
+    
+    buffers = (CAL_MOTOR_BUFFERS_TYPE *) Arena_Alloc(ARENA_OWNER_CALMOTOR, sizeof(CAL_MOTOR_BUFFERS_TYPE));
+    if (buffers == NULL)
+    {
+        return FALSE;
+    }
+    
+    for (ii = 0; ii < NUM_MOTOR_CAL_PARAMS; ++ii)
+    {
+        params_wheel = motor_cal_params[ii].wheel;
+        motor_cal_params[ii].p_pwm_samples = buffers->pwm_samples[params_wheel];
+        motor_cal_params[ii].p_cps_samples = buffers->cps_samples[params_wheel];
+        motor_cal_params[ii].p_cps_avg = buffers->cps_avg[params_wheel];
+    }
+    
+    motor_cal_parallel = FALSE;
+    
     if (wheel == WHEEL_LEFT)
     {
         InitCalParams(0, 2);
@@ -589,6 +1184,12 @@ void CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters)
     {
         InitCalParams(2, 4);
     }
+    else if (parallel) // WHEEL_BOTH
+    {
+        /* Note: In parallel mode, motor_cal_index/motor_cal_end index motor_cal_pairs */
+        InitCalParams(0, NUM_MOTOR_CAL_PAIRS);
+        motor_cal_parallel = TRUE;
+    }
     else // WHEEL_BOTH
     {
         InitCalParams(0, 4);
@@ -597,6 +1198,41 @@ void CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters)
     motor_cal_iterations = iters;
     
     Motor_SetPwm(PWM_STOP, PWM_STOP);
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalMotor_Release
+ * Description: Releases the calibration buffers.  Called when the calibration ends or is stopped.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalMotor_Release(void)
+{
+    Arena_Release(ARENA_OWNER_CALMOTOR);
+    buffers = NULL;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalMotor_GetConfidence
+ * Description: Returns the confidence in the count/sec of a calibration sample, i.e., 100 minus the 
+ *              coefficient of variation (in percent), of the last direction calibrated for the wheel.
+ *              Only valid until the calibration buffers are released.
+ * Parameters: wheel - the wheel (left, right)
+ *             index - the calibration sample index
+ * Return: UINT8 - the confidence (0 - 100), 0 if the buffers are not allocated
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT8 CalMotor_GetConfidence(WHEEL_TYPE wheel, UINT8 index)
+{
+    if (buffers == NULL || wheel > WHEEL_RIGHT || index >= CAL_NUM_SAMPLES)
+    {
+        return 0;
+    }
+    
+    return buffers->confidence[wheel][index];
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -610,7 +1246,17 @@ void CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters)
  *-------------------------------------------------------------------------------------------------*/
 UINT8 CalMotor_Update(void)
 {
-    UINT8 result = PerformMotorCalibration();
+    UINT8 result;
+    
+    if (motor_cal_parallel)
+    {
+        result = PerformParallelMotorCalibration();
+    }
+    else
+    {
+        result = PerformMotorCalibration();
+    }
+    
     if ( result == CALIBRATION_ITERATION_DONE )
     {
         result = NextCalParams();
@@ -45,7 +45,9 @@ SOFTWARE.
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/
-void CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters);
+BOOL CalMotor_Init(WHEEL_TYPE wheel, UINT8 iters, BOOL parallel);
+void CalMotor_Release(void);
 UINT8 CalMotor_Update(void);
+UINT8 CalMotor_GetConfidence(WHEEL_TYPE wheel, UINT8 index);
     
 #endif    
\ No newline at end of file
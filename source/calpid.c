@@ -25,6 +25,21 @@ SOFTWARE.
 
 /*---------------------------------------------------------------------------------------------------
    Description: This module provides the implementation for calibrating the PID.
+   
+   The step response is captured in a RAM ring buffer from the PID sample (see PidBank_SetSampleHook)
+   and dumped when the motors have stopped, so the capture does not depend on the serial link and does
+   not perturb the response.  At high PID rates, every Nth sample is captured so that the run fits in
+   the buffer.  The buffer is allocated from the mode arena (see arena.c) for the duration of the 
+   calibration.
+   
+   The binary dump is:
+   
+       'P' 'C'                    - magic
+       count (UINT16)             - the number of samples
+       period (FLOAT)             - the time between samples (sec)
+       count x setpoint, input, output, iterm (FLOAT)
+       
+   All values are little endian.
  *-------------------------------------------------------------------------------------------------*/    
 
 /*---------------------------------------------------------------------------------------------------
@@ -37,8 +52,7 @@ SOFTWARE.
 #include "serial.h"
 #include "nvstore.h"
 #include "pid.h"
-#include "pidleft.h"
-#include "pidright.h"
+#include "pidbank.h"
 #include "utils.h"
 #include "encoder.h"
 #include "time.h"
@@ -46,12 +60,30 @@ SOFTWARE.
 #include "debug.h"
 #include "control.h"
 #include "odom.h"
+#include "rate.h"
 #include "assertion.h"
+#include "arena.h"
 
 /*---------------------------------------------------------------------------------------------------
  * Constants
  *-------------------------------------------------------------------------------------------------*/
 #define STEP_VELOCITY_PERCENT  (0.8)    // 80% of maximum velocity
+#define CAPTURE_SIZE  (256)             // 4 KB, see ARENA_SIZE
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _capture_sample_tag
+{
+    FLOAT setpoint;
+    FLOAT input;
+    FLOAT output;
+    FLOAT iterm;
+} CAPTURE_SAMPLE_TYPE;
+
+typedef CAPTURE_SAMPLE_TYPE CAPTURE_BUFFER_TYPE[CAPTURE_SIZE];
+
+ARENA_ASSERT_FITS(CAPTURE_BUFFER_TYPE);
 
 /*---------------------------------------------------------------------------------------------------
  * Variables
@@ -65,6 +97,12 @@ static FLOAT max_cps;
 static CALVAL_PID_PARAMS *p_pid_params;
 static FLOAT step_velocity;
 
+static CAPTURE_SAMPLE_TYPE *capture;
+static UINT16 capture_head;
+static UINT16 capture_count;
+static UINT16 capture_decimation;
+static UINT16 capture_tick;
+
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/
@@ -142,11 +180,11 @@ static void UpdatePidGains(WHEEL_TYPE wheel, BOOL impulse)
         switch (wheel)
         {
             case WHEEL_LEFT:
-                LeftPid_SetGains(gains.kp, gains.ki, gains.kd, gains.kf);
+                PidBank_SetGains(PID_TYPE_LEFT, gains.kp, gains.ki, gains.kd, gains.kf);
                 break;
                 
             case WHEEL_RIGHT:
-                RightPid_SetGains(gains.kp, gains.ki, gains.kd, gains.kf);
+                PidBank_SetGains(PID_TYPE_RIGHT, gains.kp, gains.ki, gains.kd, gains.kf);
                 break;  
                 
             default:
@@ -190,6 +228,81 @@ static void SetVelocity(WHEEL_TYPE wheel, FLOAT step)
     
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: CaptureSample
+ * Description: PID sample hook which stores every Nth sample in the capture buffer.  When the buffer
+ *              is full, the oldest sample is overwritten.
+ * Parameters: setpoint - the PID setpoint
+ *             input - the PID input
+ *             output - the PID output
+ *             iterm - the PID integral term
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void CaptureSample(FLOAT setpoint, FLOAT input, FLOAT output, FLOAT iterm)
+{
+    CAPTURE_SAMPLE_TYPE *p_sample;
+    
+    if (++capture_tick < capture_decimation)
+    {
+        return;
+    }
+    capture_tick = 0;
+    
+    p_sample = &capture[capture_head];
+    p_sample->setpoint = setpoint;
+    p_sample->input = input;
+    p_sample->output = output;
+    p_sample->iterm = iterm;
+    
+    capture_head = (capture_head + 1) % CAPTURE_SIZE;
+    if (capture_count < CAPTURE_SIZE)
+    {
+        capture_count++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: StartCapture
+ * Description: Clears the capture buffer and hooks the PID sample.  The decimation is chosen so that
+ *              the run time fits in the buffer at the current PID rate.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void StartCapture()
+{
+    UINT32 num_samples;
+    
+    num_samples = (p_pid_params->run_time * Rate_Get(RATE_PID)) / 1000;
+    capture_decimation = (num_samples + CAPTURE_SIZE - 1) / CAPTURE_SIZE;
+    capture_decimation = max(capture_decimation, 1);
+    capture_tick = capture_decimation - 1;
+    capture_head = 0;
+    capture_count = 0;
+    
+    PidBank_SetSampleHook(p_pid_params->pid_type, CaptureSample);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: WriteFloat
+ * Description: Writes a FLOAT as four bytes.
+ * Parameters: value - the value
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void WriteFloat(FLOAT value)
+{
+    UINT8 bytes[4];
+    UINT8 ii;
+    
+    FloatToFourBytes(value, bytes);
+    for (ii = 0; ii < sizeof bytes; ++ii)
+    {
+        Ser_WriteByte(bytes[ii]);
+    }
+}
+
 /*----------------------------------------------------------------------------------------------------------------------
  * Module Interface Routines
  *---------------------------------------------------------------------------------------------------------------------*/
@@ -198,12 +311,21 @@ static void SetVelocity(WHEEL_TYPE wheel, FLOAT step)
 /*---------------------------------------------------------------------------------------------------
  * Name: CalPid_Init
  * Description: Initializes the PID calibration module 
- * Parameters: None 
- * Return: None
+ * Parameters: wheel - the wheel to calibrate (left or right)
+ *             impulse - TRUE to apply an impulse; otherwise, a step
+ *             step - the step velocity (percent of maximum)
+ *             no_debug - TRUE to disable the PID debug output while calibrating
+ * Return: BOOL - TRUE if the capture buffer was allocated; otherwise, FALSE
  * 
  *-------------------------------------------------------------------------------------------------*/
-void CalPid_Init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL no_debug)
+BOOL CalPid_Init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL no_debug)
 {
+    capture = (CAPTURE_SAMPLE_TYPE *) Arena_Alloc(ARENA_OWNER_CALPID, sizeof(CAPTURE_BUFFER_TYPE));
+    if (capture == NULL)
+    {
+        return FALSE;
+    }
+
     Ser_PutStringFormat("%s PID calibration\r\n", WheelToString(wheel, FORMAT_LOWER));
 
     SetupDebug(wheel, no_debug);
@@ -218,8 +340,11 @@ void CalPid_Init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL no_debug)
     Odom_Reset();
 
     SetVelocity(wheel, step);    
+    StartCapture();
 
     start_time = millis();
+    
+    return TRUE;
 }
 
 
@@ -241,9 +366,90 @@ UINT8 CalPid_Update()
         return CAL_OK;
     }
 
+    PidBank_SetSampleHook(p_pid_params->pid_type, NULL);
     return CAL_COMPLETE;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalPid_DumpCapture
+ * Description: Writes the captured response, oldest sample first, as JSON or binary (see above).
+ * Parameters: binary - TRUE to write binary; otherwise, JSON
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalPid_DumpCapture(BOOL binary)
+{
+    CAPTURE_SAMPLE_TYPE *p_sample;
+    FLOAT period;
+    UINT16 index;
+    UINT16 ii;
+    UINT8 count[2];
+    
+    period = capture_decimation * SAMPLE_TIME_SEC(Rate_Get(RATE_PID));
+    index = capture_count < CAPTURE_SIZE ? 0 : capture_head;
+    
+    if (binary)
+    {
+        Uint16ToTwoBytes(capture_count, count);
+        Ser_WriteByte('P');
+        Ser_WriteByte('C');
+        Ser_WriteByte(count[0]);
+        Ser_WriteByte(count[1]);
+        WriteFloat(period);
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"capture\":{\"pid\":\"%s\",\"period\":%.4f,\"count\":%d,\"samples\":[", 
+                            p_pid_params->name, period, capture_count);
+    }
+    
+    for (ii = 0; ii < capture_count; ++ii)
+    {
+        p_sample = &capture[index];
+        if (binary)
+        {
+            WriteFloat(p_sample->setpoint);
+            WriteFloat(p_sample->input);
+            WriteFloat(p_sample->output);
+            WriteFloat(p_sample->iterm);
+        }
+        else
+        {
+            Ser_PutStringFormat("%s[%.3f,%.3f,%.3f,%.3f]", 
+                                ii == 0 ? "" : ",",
+                                p_sample->setpoint,
+                                p_sample->input,
+                                p_sample->output,
+                                p_sample->iterm);
+        }
+        index = (index + 1) % CAPTURE_SIZE;
+    }
+    
+    if (!binary)
+    {
+        Ser_PutString("]}}\r\n");
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalPid_Release
+ * Description: Releases the capture buffer.  Called after the capture is dumped or when the 
+ *              calibration is stopped, in which case the PID sample must no longer be captured.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalPid_Release()
+{
+    if (p_pid_params != NULL)
+    {
+        PidBank_SetSampleHook(p_pid_params->pid_type, NULL);
+    }
+    Arena_Release(ARENA_OWNER_CALPID);
+    capture = NULL;
+    capture_count = 0;
+}
+
 
 /*-------------------------------------------------------------------------------*/
 /* [] END OF FILE */
\ No newline at end of file
@@ -46,8 +46,10 @@ SOFTWARE.
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/
-void CalPid_Init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL no_debug);
+BOOL CalPid_Init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL no_debug);
 UINT8 CalPid_Update();
+void CalPid_DumpCapture(BOOL binary);
+void CalPid_Release();
 
 
 #endif
\ No newline at end of file
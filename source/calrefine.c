@@ -0,0 +1,404 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides online refinement of the motor calibration tables.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/* 
+    Explanation of Online Refinement:
+
+    Motor calibration (see calmotor.c) is performed once, but the wheel response drifts with battery voltage, load and
+    temperature.  During normal operation, each wheel is observed at the refine sample rate.  When a wheel has been held
+    at (nearly) the same pwm for a number of samples, the measured count/sec is compared with the count/sec predicted 
+    by the SRAM copy of the calibration table (see Cal_GetRamMotorData).  The error is distributed across the two table
+    entries that bracket the pwm in proportion to their distance from the pwm (a least mean squares update).
+
+    The updates are bounded:
+        - each update is limited to a few count/sec per entry
+        - each entry can deviate from the EEPROM table by a limited amount
+        - the table is kept in ascending count/sec order (required by BinaryRangeSearch)
+        - the pwm stop entry is never changed
+
+    The refined tables are written back to EEPROM periodically but only while both motors are stopped.  This bounds
+    EEPROM wear and keeps the EEPROM write time out of the control loop.  Once persisted, the refined table becomes
+    the new baseline for the deviation bound.
+ */
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "calrefine.h"
+#include "config.h"
+#include "cal.h"
+#include "motor.h"
+#include "encoder.h"
+#include "time.h"
+#include "utils.h"
+#include "consts.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define REFINE_SAMPLE_TIME_MS       SAMPLE_TIME_MS(REFINE_SAMPLE_RATE)
+#define REFINE_STEADY_COUNT         (5)         // number of samples the pwm must be held
+#define REFINE_PWM_TOLERANCE        (3)         // pwm change allowed between samples while steady
+#define REFINE_MIN_CPS              (100)       // count/sec, ignore observations near the deadband
+#define REFINE_MIN_ERROR_CPS        (20)        // count/sec, ignore errors within the encoder noise
+#define REFINE_GAIN                 (0.05)
+#define REFINE_MAX_STEP_CPS         (5)         // count/sec, maximum change per entry per update
+#define REFINE_MAX_DEVIATION_CPS    (150)       // count/sec, maximum deviation from the EEPROM table
+#define REFINE_PERSIST_TIME_MS      (300000)    // 5 minutes
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _refine_wheel_tag
+{
+    WHEEL_TYPE wheel;
+    GET_MOTOR_PWM_FUNC_TYPE get_pwm;
+    GET_ENCODER_FUNC_TYPE get_cps;
+    PWM_TYPE last_pwm;
+    UINT8 steady_count;
+} REFINE_WHEEL_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL refine_enabled;
+static BOOL table_dirty[2][2];
+static UINT32 last_persist_time;
+static CAL_REFINE_STATS_TYPE refine_stats;
+
+static REFINE_WHEEL_TYPE refine_wheels[2] = 
+{
+    {WHEEL_LEFT, Motor_LeftGetPwm, Encoder_LeftGetCntsPerSec, PWM_STOP, 0},
+    {WHEEL_RIGHT, Motor_RightGetPwm, Encoder_RightGetCntsPerSec, PWM_STOP, 0}
+};
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: FindPwmSegment
+ * Description: Finds the pair of table entries whose pwm values bracket the specified pwm.
+ *              Note: the pwm values in a table are monotonic but, depending on the wheel, may be 
+ *              ascending or descending.
+ * Parameters: data - the calibration table
+ *             pwm - the pwm to be located
+ *             lower - the index of the first entry of the pair
+ *             fraction - the position of pwm between the pair, 0.0 at lower, 1.0 at lower + 1
+ * Return: BOOL - TRUE if the pwm is within the table, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL FindPwmSegment(CAL_DATA_TYPE* const data, PWM_TYPE pwm, UINT8* const lower, FLOAT* const fraction)
+{
+    UINT8 ii;
+    INT16 pwm0;
+    INT16 pwm1;
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES - 1; ++ii)
+    {
+        pwm0 = (INT16) data->pwm_data[ii];
+        pwm1 = (INT16) data->pwm_data[ii + 1];
+
+        if (pwm0 != pwm1 && in_range((INT16) pwm, min(pwm0, pwm1), max(pwm0, pwm1)))
+        {
+            *lower = ii;
+            *fraction = (FLOAT) ((INT16) pwm - pwm0) / (FLOAT) (pwm1 - pwm0);
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: AdjustEntry
+ * Description: Applies a bounded adjustment to a count/sec table entry.
+ * Parameters: data - the SRAM calibration table
+ *             baseline - the EEPROM calibration table
+ *             index - the index of the entry to adjust
+ *             delta - the requested change in count/sec
+ * Return: BOOL - TRUE if the entry was changed, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL AdjustEntry(CAL_DATA_TYPE* const data, CAL_DATA_TYPE* const baseline, UINT8 index, FLOAT delta)
+{
+    INT16 step;
+    INT16 value;
+    INT16 lower_bound;
+    INT16 upper_bound;
+
+    /* The stop entry must always map to 0 count/sec */
+    if (data->pwm_data[index] == PWM_STOP)
+    {
+        return FALSE;
+    }
+
+    step = (INT16) (delta + (delta > 0 ? 0.5 : -0.5));
+    step = constrain(step, -REFINE_MAX_STEP_CPS, REFINE_MAX_STEP_CPS);
+    if (step == 0)
+    {
+        return FALSE;
+    }
+
+    /* Bound the deviation from the persisted table, then keep the table in ascending order */
+    lower_bound = baseline->cps_data[index] - REFINE_MAX_DEVIATION_CPS;
+    upper_bound = baseline->cps_data[index] + REFINE_MAX_DEVIATION_CPS;
+    value = constrain(data->cps_data[index] + step, lower_bound, upper_bound);
+
+    if (index > 0)
+    {
+        value = max(value, data->cps_data[index - 1]);
+    }
+    if (index < CAL_NUM_SAMPLES - 1)
+    {
+        value = min(value, data->cps_data[index + 1]);
+    }
+
+    if (value == data->cps_data[index])
+    {
+        return FALSE;
+    }
+
+    data->cps_data[index] = value;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: RefineWheel
+ * Description: Observes the pwm and count/sec of a wheel and, if the wheel is steady, refines the
+ *              calibration table entries bracketing the pwm.
+ * Parameters: rw - the wheel to be observed
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void RefineWheel(REFINE_WHEEL_TYPE* const rw)
+{
+    PWM_TYPE pwm;
+    FLOAT cps;
+    INT16 pwm_change;
+    DIR_TYPE dir;
+    CAL_DATA_TYPE *data;
+    CAL_DATA_TYPE *baseline;
+    UINT8 lower;
+    FLOAT fraction;
+    FLOAT predicted;
+    FLOAT error;
+    BOOL changed;
+
+    pwm = rw->get_pwm();
+    cps = rw->get_cps();
+
+    pwm_change = (INT16) pwm - (INT16) rw->last_pwm;
+    rw->last_pwm = pwm;
+    if (abs(pwm_change) > REFINE_PWM_TOLERANCE)
+    {
+        rw->steady_count = 0;
+        return;
+    }
+
+    if (rw->steady_count < REFINE_STEADY_COUNT)
+    {
+        rw->steady_count++;
+        return;
+    }
+
+    if (abs(cps) < REFINE_MIN_CPS)
+    {
+        return;
+    }
+
+    dir = cps >= 0 ? DIR_FORWARD : DIR_BACKWARD;
+    data = Cal_GetRamMotorData(rw->wheel, dir);
+    baseline = Cal_GetMotorData(rw->wheel, dir);
+
+    if (!FindPwmSegment(data, pwm, &lower, &fraction))
+    {
+        return;
+    }
+
+    refine_stats.num_observations++;
+
+    predicted = data->cps_data[lower] + fraction * (data->cps_data[lower + 1] - data->cps_data[lower]);
+    error = cps - predicted;
+    if (abs(error) < REFINE_MIN_ERROR_CPS)
+    {
+        return;
+    }
+
+    changed = AdjustEntry(data, baseline, lower, REFINE_GAIN * (1.0 - fraction) * error);
+    changed |= AdjustEntry(data, baseline, lower + 1, REFINE_GAIN * fraction * error);
+
+    if (changed)
+    {
+        /* The table is in ascending order so min/max are the end points */
+        data->cps_min = data->cps_data[0];
+        data->cps_max = data->cps_data[CAL_NUM_SAMPLES - 1];
+        table_dirty[rw->wheel][dir] = TRUE;
+        Cal_UpdateMotorTable(rw->wheel, dir);
+        refine_stats.num_updates++;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PersistTables
+ * Description: Writes the refined calibration tables to EEPROM.  Only tables that have changed are
+ *              written and only while both motors are stopped.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PersistTables()
+{
+    UINT8 wheel;
+    UINT8 dir;
+    BOOL persisted;
+
+    if (millis() - last_persist_time < REFINE_PERSIST_TIME_MS)
+    {
+        return;
+    }
+
+    if (Motor_LeftGetPwm() != PWM_STOP || Motor_RightGetPwm() != PWM_STOP)
+    {
+        return;
+    }
+
+    persisted = FALSE;
+    for (wheel = WHEEL_LEFT; wheel <= WHEEL_RIGHT; ++wheel)
+    {
+        for (dir = DIR_FORWARD; dir <= DIR_BACKWARD; ++dir)
+        {
+            if (table_dirty[wheel][dir])
+            {
+                Cal_SetMotorData(wheel, dir, Cal_GetRamMotorData(wheel, dir));
+                table_dirty[wheel][dir] = FALSE;
+                persisted = TRUE;
+            }
+        }
+    }
+
+    if (persisted)
+    {
+        refine_stats.num_persists++;
+    }
+    last_persist_time = millis();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalRefine_Init
+ * Description: Initializes the online refinement module.  Refinement is enabled by default when 
+ *              CAL_REFINE_ENABLED is defined in config.h.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalRefine_Init()
+{
+#ifdef CAL_REFINE_ENABLED
+    refine_enabled = TRUE;
+#else
+    refine_enabled = FALSE;
+#endif
+    memset(table_dirty, 0, sizeof table_dirty);
+    memset(&refine_stats, 0, sizeof refine_stats);
+    last_persist_time = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalRefine_Start
+ * Description: Starts the online refinement module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalRefine_Start()
+{
+    refine_wheels[WHEEL_LEFT].last_pwm = PWM_STOP;
+    refine_wheels[WHEEL_LEFT].steady_count = 0;
+    refine_wheels[WHEEL_RIGHT].last_pwm = PWM_STOP;
+    refine_wheels[WHEEL_RIGHT].steady_count = 0;
+    last_persist_time = millis();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalRefine_Update
+ * Description: Called from the main loop.  Internally, it enforces the refine sampling rate.
+ *              Refinement is only performed when the motors are calibrated, i.e., it is suspended
+ *              while motor calibration is running.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalRefine_Update()
+{
+    static UINT32 last_update_time = REFINE_SCHED_OFFSET;
+    UINT32 delta_time;
+
+    if (!refine_enabled || !Cal_GetCalibrationStatusBit(CAL_MOTOR_BIT))
+    {
+        return;
+    }
+
+    delta_time = millis() - last_update_time;
+    if (delta_time >= REFINE_SAMPLE_TIME_MS)
+    {
+        last_update_time = millis();
+
+        RefineWheel(&refine_wheels[WHEEL_LEFT]);
+        RefineWheel(&refine_wheels[WHEEL_RIGHT]);
+        PersistTables();
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalRefine_Enable
+ * Description: Enables/Disables online refinement.  Refinement that has not been persisted is kept
+ *              in SRAM when disabled.
+ * Parameters: enable - TRUE to enable, FALSE to disable
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalRefine_Enable(BOOL enable)
+{
+    refine_enabled = enable;
+    refine_wheels[WHEEL_LEFT].steady_count = 0;
+    refine_wheels[WHEEL_RIGHT].steady_count = 0;
+}
+
+BOOL CalRefine_IsEnabled()
+{
+    return refine_enabled;
+}
+
+void CalRefine_GetStats(CAL_REFINE_STATS_TYPE* const stats)
+{
+    *stats = refine_stats;
+}
+
+/* [] END OF FILE */
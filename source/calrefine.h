@@ -1,64 +1,60 @@
-/* 
-MIT License
-
-Copyright (c) 2017 Tim Slator
-
-Permission is hereby granted, free of charge, to any person obtaining a copy
-of this software and associated documentation files (the "Software"), to deal
-in the Software without restriction, including without limitation the rights
-to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-copies of the Software, and to permit persons to whom the Software is
-furnished to do so, subject to the following conditions:
-
-The above copyright notice and this permission notice shall be included in all
-copies or substantial portions of the Software.
-
-THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-SOFTWARE.
-*/
-
-/*---------------------------------------------------------------------------------------------------
-   Description: This module provides the implementation of the linear velocity PID.
- *-------------------------------------------------------------------------------------------------*/    
-
-#ifndef UNIPID_H
-#define UNIPID_H
-    
-/*---------------------------------------------------------------------------------------------------
- * Includes
- *-------------------------------------------------------------------------------------------------*/    
-#include "freesoc.h"
-    
-/*---------------------------------------------------------------------------------------------------
- * Macros
- *-------------------------------------------------------------------------------------------------*/    
-    
-
-/*---------------------------------------------------------------------------------------------------
- * Types
- *-------------------------------------------------------------------------------------------------*/
-
-
-/*---------------------------------------------------------------------------------------------------
- * Functions
- *-------------------------------------------------------------------------------------------------*/    
-void UniPid_Init();
-void UniPid_Start();
-void UniPid_Process();
-
-void UniPid_SetGains(FLOAT theta_kp, FLOAT theta_ki, FLOAT theta_kd, FLOAT theta_kf);
-void UniPid_GetGains(FLOAT* const theta_kp, FLOAT* const theta_ki, FLOAT* const theta_kd, FLOAT* const theta_kf);
-
-void UniPid_Reset();
-void UniPid_Enable(BOOL enable);
-void UniPid_Bypass(BOOL bypass);
-
-
-#endif
-
-/* [] END OF FILE */
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides online refinement of the motor calibration tables.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef CALREFINE_H
+#define CALREFINE_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+#include "cal.h"    
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/    
+typedef struct _cal_refine_stats_tag
+{
+    UINT32 num_observations;
+    UINT32 num_updates;
+    UINT32 num_persists;
+} CAL_REFINE_STATS_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void CalRefine_Init();
+void CalRefine_Start();
+void CalRefine_Update();
+void CalRefine_Enable(BOOL enable);
+BOOL CalRefine_IsEnabled();
+void CalRefine_GetStats(CAL_REFINE_STATS_TYPE* const stats);
+
+#endif
+
+/* [] END OF FILE */
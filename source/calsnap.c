@@ -0,0 +1,719 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the calibration snapshot, a CRC checked image of selected 
+   sections of the calibration EEPROM.  A robot is provisioned from a calibrated robot of the same
+   build by exporting its snapshot (config export) and importing it (config import) instead of 
+   repeating the motor, PID and bias calibrations.
+   
+   The sections are:
+       motor - the motor calibration samples, the compressed tables and the motor models
+       pid - the left/right and linear/angular gains and the gain schedules
+       bias - the linear/angular bias
+       rate - the sample rates
+       
+   The snapshot is a header, one record (EEPROM offset, size, bytes) per EEPROM range of the selected
+   sections and a CRC-16/CCITT.  The export streams the snapshot from EEPROM, as binary or as base64 
+   in CALSNAP_CHUNK_LENGTH character chunks, without a buffer.  The import collects the base64 chunks 
+   in a buffer from the mode arena (see arena.c) and, on commit, checks the CRC, that every record 
+   matches a range of this firmware and the content before anything is written to EEPROM.  The
+   calibration status bits of the imported sections are taken from the snapshot.
+   
+   Note: The imported motor data and PID gains are applied immediately.  The sample rates are applied
+   at the next reset.  The motor and PID calibrations cannot run while an import holds the arena.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "calsnap.h"
+#include "cal.h"
+#include "calstore.h"
+#include "nvstore.h"
+#include "pidbank.h"
+#include "rate.h"
+#include "arena.h"
+#include "emit.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define NUM_RANGES (sizeof(ranges) / sizeof(ranges[0]))
+#define CRC_INIT (0xFFFF)
+#define CRC_POLY (0x1021)
+#define BASE64_PAD ('=')
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _calsnap_range_tag
+{
+    UINT8 section;
+    UINT16 offset;
+    UINT16 size;
+} CALSNAP_RANGE_TYPE;
+
+typedef struct _calsnap_buffer_tag
+{
+    UINT8 bytes[CALSNAP_MAX_SIZE];
+} CALSNAP_BUFFER_TYPE;
+
+ARENA_ASSERT_FITS(CALSNAP_BUFFER_TYPE);
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static volatile CAL_EEPROM_TYPE *p_cal_eeprom;
+
+static const CALSNAP_RANGE_TYPE ranges[] = {
+    {CALSNAP_MOTOR_BIT, offsetof(CAL_EEPROM_TYPE, left_table_fwd), 4 * sizeof(CAL_TABLE_TYPE)},
+    {CALSNAP_MOTOR_BIT, offsetof(CAL_EEPROM_TYPE, left_model_fwd), 4 * sizeof(CAL_MOTOR_MODEL_TYPE)},
+    {CALSNAP_MOTOR_BIT, offsetof(CAL_EEPROM_TYPE, left_motor_fwd), 4 * sizeof(CAL_DATA_TYPE)},
+    {CALSNAP_PID_BIT, offsetof(CAL_EEPROM_TYPE, left_gains), 2 * sizeof(CAL_PID_TYPE)},
+    {CALSNAP_PID_BIT, offsetof(CAL_EEPROM_TYPE, linear_gains), 2 * sizeof(CAL_PID_TYPE)},
+    {CALSNAP_PID_BIT, offsetof(CAL_EEPROM_TYPE, left_sched), 2 * sizeof(CAL_PID_SCHED_TYPE)},
+    {CALSNAP_BIAS_BIT, offsetof(CAL_EEPROM_TYPE, linear_bias), 2 * sizeof(FLOAT)},
+    {CALSNAP_RATE_BIT, offsetof(CAL_EEPROM_TYPE, rates), sizeof(CAL_RATE_TYPE)}
+};
+
+/* The calibration status bits belonging to each section */
+static const struct
+{
+    UINT8 section;
+    UINT16 status;
+} section_status[] = {
+    {CALSNAP_MOTOR_BIT, CAL_MOTOR_BIT},
+    {CALSNAP_PID_BIT, CAL_PID_BIT | CAL_CASCADE_BIT},
+    {CALSNAP_BIAS_BIT, CAL_LINEAR_BIT | CAL_ANGULAR_BIT}
+};
+
+static const CHAR base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const CHAR * const result_strings[CALSNAP_LAST] = {
+    "ok",
+    "import not started",
+    "arena in use",
+    "invalid base64",
+    "snapshot too long",
+    "invalid header",
+    "CRC mismatch",
+    "record does not match this firmware",
+    "invalid calibration values"
+};
+
+/* Export state */
+static CALSNAP_FORMAT_TYPE export_format;
+static UINT16 export_crc;
+static UINT8 export_bytes[3];
+static UINT8 export_num_bytes;
+static CHAR export_chunk[CALSNAP_CHUNK_LENGTH + 1];
+static UINT8 export_chunk_length;
+
+/* Import state */
+static UINT8 *import_buffer;
+static UINT16 import_length;
+static BOOL import_padded;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: FlushChunk
+ * Description: Writes the pending base64 characters as a line (text) or an array item (JSON).
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void FlushChunk()
+{
+    if (export_chunk_length == 0)
+    {
+        return;
+    }
+    
+    export_chunk[export_chunk_length] = '\0';
+    if (export_format == CALSNAP_FORMAT_JSON)
+    {
+        Emit_ItemString(export_chunk);
+    }
+    else
+    {
+        Emit_String(export_chunk);
+        Emit_Newline();
+    }
+    export_chunk_length = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: EncodeQuantum
+ * Description: Encodes the pending (1 to 3) bytes as 4 base64 characters.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void EncodeQuantum()
+{
+    UINT32 bits;
+    UINT8 ii;
+    
+    bits = ((UINT32) export_bytes[0] << 16) | ((UINT32) export_bytes[1] << 8) | export_bytes[2];
+    for (ii = 0; ii < 4; ++ii)
+    {
+        export_chunk[export_chunk_length++] = ii <= export_num_bytes ? base64_chars[(bits >> (18 - 6 * ii)) & 0x3F] : BASE64_PAD;
+    }
+    
+    export_bytes[0] = export_bytes[1] = export_bytes[2] = 0;
+    export_num_bytes = 0;
+    
+    if (export_chunk_length == CALSNAP_CHUNK_LENGTH)
+    {
+        FlushChunk();
+    }
+}
+
+static void ExportByte(UINT8 value)
+{
+    export_crc = CalSnap_Crc16(export_crc, &value, 1);
+    
+    if (export_format == CALSNAP_FORMAT_BINARY)
+    {
+        Emit_Char((CHAR) value);
+        return;
+    }
+    
+    export_bytes[export_num_bytes++] = value;
+    if (export_num_bytes == 3)
+    {
+        EncodeQuantum();
+    }
+}
+
+static void ExportBytes(UINT8 const volatile * const bytes, UINT16 length)
+{
+    UINT16 ii;
+    
+    for (ii = 0; ii < length; ++ii)
+    {
+        ExportByte(bytes[ii]);
+    }
+}
+
+static INT8 DecodeChar(CHAR ch)
+{
+    CHAR const *p_ch;
+    
+    p_ch = strchr(base64_chars, ch);
+    return (ch != '\0' && p_ch != NULL) ? (INT8) (p_ch - base64_chars) : -1;
+}
+
+static BOOL IsGainValid(CAL_PID_TYPE const * const gains)
+{
+    return isfinite(gains->kp) && isfinite(gains->ki) && isfinite(gains->kd) && isfinite(gains->kf);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: IsContentValid
+ * Description: Checks the values of a record which are used without further checks: the gains
+ *              must be finite, the gain schedules valid (or empty) and the rates valid (or zero).
+ * Parameters: offset - the EEPROM offset of the record
+ *             bytes - the record bytes
+ * Return: TRUE if the values are valid, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL IsContentValid(UINT16 offset, UINT8 * const bytes)
+{
+    CAL_PID_TYPE *p_gains;
+    CAL_PID_SCHED_TYPE *p_sched;
+    CAL_RATE_TYPE *p_rates;
+    FLOAT *p_bias;
+    UINT8 ii;
+    UINT8 jj;
+    
+    switch (offset)
+    {
+        case offsetof(CAL_EEPROM_TYPE, left_gains):
+        case offsetof(CAL_EEPROM_TYPE, linear_gains):
+            p_gains = (CAL_PID_TYPE *) bytes;
+            return IsGainValid(&p_gains[0]) && IsGainValid(&p_gains[1]);
+            
+        case offsetof(CAL_EEPROM_TYPE, left_sched):
+            p_sched = (CAL_PID_SCHED_TYPE *) bytes;
+            for (ii = 0; ii < 2; ++ii)
+            {
+                if (p_sched[ii].num_bands == 0)
+                {
+                    continue;
+                }
+                if (!Cal_IsPidScheduleValid(&p_sched[ii]))
+                {
+                    return FALSE;
+                }
+                for (jj = 0; jj < p_sched[ii].num_bands; ++jj)
+                {
+                    if (!IsGainValid(&p_sched[ii].gains[jj]))
+                    {
+                        return FALSE;
+                    }
+                }
+            }
+            return TRUE;
+            
+        case offsetof(CAL_EEPROM_TYPE, linear_bias):
+            p_bias = (FLOAT *) bytes;
+            return isfinite(p_bias[0]) && isfinite(p_bias[1]);
+            
+        case offsetof(CAL_EEPROM_TYPE, rates):
+            p_rates = (CAL_RATE_TYPE *) bytes;
+            if (p_rates->enc_hz == 0 && p_rates->pid_hz == 0 && p_rates->odom_hz == 0 && p_rates->outer_hz == 0)
+            {
+                return TRUE;
+            }
+            return Rate_IsValid(p_rates->enc_hz, p_rates->pid_hz, p_rates->odom_hz, p_rates->outer_hz);
+            
+        default:
+            return TRUE;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Validate
+ * Description: Validates the imported snapshot.  Every range of the selected sections must be present
+ *              exactly once and no other record is allowed.
+ * Parameters: None
+ * Return: CALSNAP_OK if the snapshot can be written, otherwise the error
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static CALSNAP_RESULT_TYPE Validate()
+{
+    CALSNAP_HEADER_TYPE *p_header;
+    CALSNAP_RECORD_TYPE *p_record;
+    UINT16 crc;
+    UINT16 index;
+    UINT16 end;
+    UINT16 found;
+    UINT8 ii;
+    
+    p_header = (CALSNAP_HEADER_TYPE *) import_buffer;
+    if (import_length < sizeof(CALSNAP_HEADER_TYPE) + sizeof(crc) ||
+        p_header->magic != CALSNAP_MAGIC ||
+        p_header->version != CALSNAP_VERSION ||
+        p_header->sections == 0 ||
+        (p_header->sections & ~CALSNAP_ALL_BITS) ||
+        import_length != sizeof(CALSNAP_HEADER_TYPE) + p_header->length + sizeof(crc))
+    {
+        return CALSNAP_BAD_HEADER;
+    }
+    
+    end = import_length - sizeof(crc);
+    memcpy(&crc, &import_buffer[end], sizeof(crc));
+    if (crc != CalSnap_Crc16(CRC_INIT, import_buffer, end))
+    {
+        return CALSNAP_BAD_CRC;
+    }
+    
+    found = 0;
+    index = sizeof(CALSNAP_HEADER_TYPE);
+    while (index < end)
+    {
+        if (end - index < sizeof(CALSNAP_RECORD_TYPE))
+        {
+            return CALSNAP_BAD_RECORD;
+        }
+        p_record = (CALSNAP_RECORD_TYPE *) &import_buffer[index];
+        index += sizeof(CALSNAP_RECORD_TYPE);
+        
+        for (ii = 0; ii < NUM_RANGES; ++ii)
+        {
+            if (ranges[ii].offset == p_record->offset && ranges[ii].size == p_record->size)
+            {
+                break;
+            }
+        }
+        if (ii == NUM_RANGES || 
+            !(ranges[ii].section & p_header->sections) || 
+            (found & (1 << ii)) ||
+            end - index < p_record->size)
+        {
+            return CALSNAP_BAD_RECORD;
+        }
+        found |= 1 << ii;
+        
+        if (!IsContentValid(p_record->offset, &import_buffer[index]))
+        {
+            return CALSNAP_BAD_CONTENT;
+        }
+        index += p_record->size;
+    }
+    
+    for (ii = 0; ii < NUM_RANGES; ++ii)
+    {
+        if ((ranges[ii].section & p_header->sections) && !(found & (1 << ii)))
+        {
+            return CALSNAP_BAD_RECORD;
+        }
+    }
+    
+    return CALSNAP_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Write
+ * Description: Writes the validated snapshot to EEPROM, sets the calibration status of the imported
+ *              sections and reloads the motor data, the feedforward and the PID gains.  Note: the
+ *              feedforward is loaded from the imported motor models, with or without the PID section.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Write()
+{
+    CALSNAP_HEADER_TYPE *p_header;
+    CALSNAP_RECORD_TYPE *p_record;
+    UINT16 index;
+    UINT16 bit;
+    UINT8 ii;
+    
+    p_header = (CALSNAP_HEADER_TYPE *) import_buffer;
+    
+    index = sizeof(CALSNAP_HEADER_TYPE);
+    while (index < sizeof(CALSNAP_HEADER_TYPE) + p_header->length)
+    {
+        p_record = (CALSNAP_RECORD_TYPE *) &import_buffer[index];
+        index += sizeof(CALSNAP_RECORD_TYPE);
+        Nvstore_WriteBytes(&import_buffer[index], p_record->size, p_record->offset);
+        index += p_record->size;
+    }
+    
+    for (ii = 0; ii < sizeof(section_status) / sizeof(section_status[0]); ++ii)
+    {
+        if (!(section_status[ii].section & p_header->sections))
+        {
+            continue;
+        }
+        for (bit = 0x0001; bit != 0; bit <<= 1)
+        {
+            if (bit & section_status[ii].status & p_header->status)
+            {
+                Cal_SetCalibrationStatusBit(bit);
+            }
+            else if (bit & section_status[ii].status)
+            {
+                Cal_ClearCalibrationStatusBit(bit);
+            }
+        }
+    }
+    
+    if (p_header->sections & CALSNAP_MOTOR_BIT)
+    {
+        Cal_LoadMotorData();
+        PidBank_LoadFeedforward();
+    }
+    if (p_header->sections & CALSNAP_PID_BIT)
+    {
+        PidBank_Start();
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_Init
+ * Description: Initializes the calibration snapshot module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalSnap_Init()
+{
+    p_cal_eeprom = NVSTORE_CAL_EEPROM_BASE;
+    import_buffer = NULL;
+    import_length = 0;
+    import_padded = FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_GetSize
+ * Description: Returns the size of the snapshot of the given sections.
+ * Parameters: sections - the sections (CALSNAP_XXX_BIT)
+ * Return: the size (bytes)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT16 CalSnap_GetSize(UINT8 sections)
+{
+    UINT16 size;
+    UINT8 ii;
+    
+    size = sizeof(CALSNAP_HEADER_TYPE) + sizeof(UINT16);
+    for (ii = 0; ii < NUM_RANGES; ++ii)
+    {
+        if (ranges[ii].section & sections)
+        {
+            size += sizeof(CALSNAP_RECORD_TYPE) + ranges[ii].size;
+        }
+    }
+    
+    return size;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_Export
+ * Description: Writes the snapshot of the given sections to the serial port.
+ *              JSON: {"sections":15,"length":1506,"data":["<base64 chunk>", ...]}
+ *              Text: a summary line and a line per base64 chunk
+ *              Binary: the snapshot bytes
+ * Parameters: sections - the sections (CALSNAP_XXX_BIT)
+ *             format - the format
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalSnap_Export(UINT8 sections, CALSNAP_FORMAT_TYPE format)
+{
+    CALSNAP_HEADER_TYPE header;
+    CALSNAP_RECORD_TYPE record;
+    UINT16 crc;
+    UINT8 ii;
+    
+    sections &= CALSNAP_ALL_BITS;
+    
+    export_format = format;
+    export_crc = CRC_INIT;
+    export_num_bytes = 0;
+    export_chunk_length = 0;
+    memset(export_bytes, 0, sizeof(export_bytes));
+    
+    header.magic = CALSNAP_MAGIC;
+    header.version = CALSNAP_VERSION;
+    header.sections = sections;
+    header.status = p_cal_eeprom->status;
+    header.length = CalSnap_GetSize(sections) - sizeof(CALSNAP_HEADER_TYPE) - sizeof(crc);
+    
+    if (format == CALSNAP_FORMAT_JSON)
+    {
+        Emit_ObjectBegin(NULL);
+        Emit_KeyInt("sections", sections);
+        Emit_KeyInt("length", CalSnap_GetSize(sections));
+        Emit_ArrayBegin("data");
+    }
+    else if (format == CALSNAP_FORMAT_TEXT)
+    {
+        Emit_String("Snapshot - sections: ");
+        Emit_Int(sections);
+        Emit_String(", length: ");
+        Emit_Int(CalSnap_GetSize(sections));
+        Emit_Newline();
+    }
+    
+    ExportBytes((UINT8 *) &header, sizeof(header));
+    for (ii = 0; ii < NUM_RANGES; ++ii)
+    {
+        if (ranges[ii].section & sections)
+        {
+            record.offset = ranges[ii].offset;
+            record.size = ranges[ii].size;
+            ExportBytes((UINT8 *) &record, sizeof(record));
+            ExportBytes((UINT8 const volatile *) p_cal_eeprom + ranges[ii].offset, ranges[ii].size);
+        }
+    }
+    
+    /* Note: ExportByte updates the CRC, so the CRC is copied first */
+    crc = export_crc;
+    ExportBytes((UINT8 *) &crc, sizeof(crc));
+    
+    if (format != CALSNAP_FORMAT_BINARY)
+    {
+        if (export_num_bytes > 0)
+        {
+            EncodeQuantum();
+        }
+        FlushChunk();
+    }
+    
+    if (format == CALSNAP_FORMAT_JSON)
+    {
+        Emit_ArrayEnd();
+        Emit_ObjectEnd();
+        Emit_Newline();
+    }
+    Emit_Flush();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_ImportBegin
+ * Description: Starts an import.  The import buffer is allocated from the mode arena and any 
+ *              import in progress is discarded.
+ * Parameters: None
+ * Return: CALSNAP_OK, or CALSNAP_NO_MEMORY if the arena is in use
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CALSNAP_RESULT_TYPE CalSnap_ImportBegin()
+{
+    CalSnap_ImportAbort();
+    
+    import_buffer = (UINT8 *) Arena_Alloc(ARENA_OWNER_CALSNAP, sizeof(CALSNAP_BUFFER_TYPE));
+    return import_buffer != NULL ? CALSNAP_OK : CALSNAP_NO_MEMORY;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_ImportData
+ * Description: Decodes a base64 chunk of the snapshot into the import buffer.  The chunk length
+ *              must be a multiple of 4 and only the last chunk may be padded.
+ * Parameters: data - the base64 chunk
+ * Return: CALSNAP_OK, or the error
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CALSNAP_RESULT_TYPE CalSnap_ImportData(CHAR const * const data)
+{
+    UINT32 bits;
+    UINT16 length;
+    UINT16 ii;
+    UINT8 jj;
+    UINT8 num_pad;
+    INT8 value;
+    
+    if (import_buffer == NULL)
+    {
+        return CALSNAP_NOT_STARTED;
+    }
+    
+    length = strlen(data);
+    if (length % 4 != 0 || import_padded)
+    {
+        return CALSNAP_BAD_ENCODING;
+    }
+    
+    for (ii = 0; ii < length; ii += 4)
+    {
+        bits = 0;
+        num_pad = 0;
+        for (jj = 0; jj < 4; ++jj)
+        {
+            if (data[ii + jj] == BASE64_PAD && jj >= 2 && ii + 4 == length)
+            {
+                num_pad++;
+                value = 0;
+            }
+            else
+            {
+                value = DecodeChar(data[ii + jj]);
+                if (value < 0 || num_pad > 0)
+                {
+                    return CALSNAP_BAD_ENCODING;
+                }
+            }
+            bits = (bits << 6) | value;
+        }
+        
+        if (import_length + 3 - num_pad > CALSNAP_MAX_SIZE)
+        {
+            return CALSNAP_TOO_LONG;
+        }
+        for (jj = 0; jj < 3 - num_pad; ++jj)
+        {
+            import_buffer[import_length++] = (bits >> (16 - 8 * jj)) & 0xFF;
+        }
+        import_padded = num_pad > 0;
+    }
+    
+    return CALSNAP_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_ImportCommit
+ * Description: Validates the imported snapshot and, if valid, writes it to EEPROM.  The import
+ *              ends (and the arena is released) whether or not the snapshot is valid.
+ * Parameters: sections - the imported sections (CALSNAP_XXX_BIT), set on success
+ * Return: CALSNAP_OK, or the error
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CALSNAP_RESULT_TYPE CalSnap_ImportCommit(UINT8* const sections)
+{
+    CALSNAP_RESULT_TYPE result;
+    
+    if (import_buffer == NULL)
+    {
+        return CALSNAP_NOT_STARTED;
+    }
+    
+    result = Validate();
+    if (result == CALSNAP_OK)
+    {
+        Write();
+        *sections = ((CALSNAP_HEADER_TYPE *) import_buffer)->sections;
+    }
+    
+    CalSnap_ImportAbort();
+    return result;
+}
+
+void CalSnap_ImportAbort()
+{
+    if (import_buffer != NULL)
+    {
+        Arena_Release(ARENA_OWNER_CALSNAP);
+    }
+    import_buffer = NULL;
+    import_length = 0;
+    import_padded = FALSE;
+}
+
+UINT16 CalSnap_GetImportLength()
+{
+    return import_length;
+}
+
+CHAR const * CalSnap_GetResultString(CALSNAP_RESULT_TYPE result)
+{
+    return result < CALSNAP_LAST ? result_strings[result] : "";
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalSnap_Crc16
+ * Description: Updates a CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) with the given bytes.
+ * Parameters: crc - the CRC of the preceding bytes, 0xFFFF for the first bytes
+ *             data - the bytes
+ *             length - the number of bytes
+ * Return: the updated CRC
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT16 CalSnap_Crc16(UINT16 crc, UINT8 const * const data, UINT16 length)
+{
+    UINT16 ii;
+    UINT8 bit;
+    
+    for (ii = 0; ii < length; ++ii)
+    {
+        crc ^= (UINT16) data[ii] << 8;
+        for (bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ CRC_POLY : crc << 1;
+        }
+    }
+    
+    return crc;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the calibration snapshot, a CRC checked image of selected 
+   sections of the calibration EEPROM which is exported from one robot and imported into another.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef CALSNAP_H
+#define CALSNAP_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define CALSNAP_MOTOR_BIT   (0x01)
+#define CALSNAP_PID_BIT     (0x02)
+#define CALSNAP_BIAS_BIT    (0x04)
+#define CALSNAP_RATE_BIT    (0x08)
+#define CALSNAP_ALL_BITS    (0x0F)
+
+#define CALSNAP_MAGIC       (0x5343)    /* "CS" */
+#define CALSNAP_VERSION     (1)
+
+/* Size of the import buffer, all sections are 1506 bytes */
+#define CALSNAP_MAX_SIZE    (1536)
+
+/* Number of base64 characters per exported line.  A line fits the console line with the
+   config import --data= prefix (see MAX_LINE_LENGTH).
+ */
+#define CALSNAP_CHUNK_LENGTH (96)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+/* Snapshot layout (little endian):
+       header
+       records, one per EEPROM range of the selected sections: offset, size, bytes
+       CRC-16/CCITT of the header and records
+ */
+typedef struct _calsnap_header_tag
+{
+    UINT16 magic;
+    UINT8 version;
+    UINT8 sections;
+    UINT16 status;      /* calibration status bits */
+    UINT16 length;      /* bytes of records */
+} __attribute__ ((packed)) CALSNAP_HEADER_TYPE;
+
+typedef struct _calsnap_record_tag
+{
+    UINT16 offset;      /* offset in the calibration EEPROM */
+    UINT16 size;
+} __attribute__ ((packed)) CALSNAP_RECORD_TYPE;
+
+typedef enum {CALSNAP_FORMAT_JSON, CALSNAP_FORMAT_TEXT, CALSNAP_FORMAT_BINARY} CALSNAP_FORMAT_TYPE;
+
+typedef enum 
+{
+    CALSNAP_OK,
+    CALSNAP_NOT_STARTED,
+    CALSNAP_NO_MEMORY,
+    CALSNAP_BAD_ENCODING,
+    CALSNAP_TOO_LONG,
+    CALSNAP_BAD_HEADER,
+    CALSNAP_BAD_CRC,
+    CALSNAP_BAD_RECORD,
+    CALSNAP_BAD_CONTENT,
+    CALSNAP_LAST
+} CALSNAP_RESULT_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void CalSnap_Init();
+UINT16 CalSnap_GetSize(UINT8 sections);
+void CalSnap_Export(UINT8 sections, CALSNAP_FORMAT_TYPE format);
+CALSNAP_RESULT_TYPE CalSnap_ImportBegin();
+CALSNAP_RESULT_TYPE CalSnap_ImportData(CHAR const * const data);
+CALSNAP_RESULT_TYPE CalSnap_ImportCommit(UINT8* const sections);
+void CalSnap_ImportAbort();
+UINT16 CalSnap_GetImportLength();
+CHAR const * CalSnap_GetResultString(CALSNAP_RESULT_TYPE result);
+UINT16 CalSnap_Crc16(UINT16 crc, UINT8 const * const data, UINT16 length);
+
+#endif
+
+/* [] END OF FILE */
@@ -40,6 +40,11 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/
 #define CAL_NUM_SAMPLES (51)
 #define CAL_DATA_SIZE (CAL_NUM_SAMPLES)    
+#define CAL_TABLE_MAX_KNOTS (25)
+#define CAL_TABLE_VALID (0x80)
+#define CAL_TABLE_DESCENDING (0x01)
+#define CAL_PID_SCHED_MAX_BANDS (4)
+#define CAL_MACRO_DATA_SIZE (568)
     
 /*---------------------------------------------------------------------------------------------------
  * Types
@@ -55,6 +60,21 @@ SOFTWARE.
     // Note: Total size is 208 bytes, at 16 bytes per row, 13 rows
 } __attribute__ ((packed)) CAL_DATA_TYPE;
 
+/* Compressed piecewise-linear form of CAL_DATA_TYPE (see caltable.c).  Knots are placed where the count/sec to pwm
+   curve bends, so the count/sec of each knot is stored in full and the pwm is stored as the change from the previous 
+   knot.
+ */
+typedef struct _CAL_TABLE_TYPE
+{
+    UINT8  num_knots;
+    UINT8  flags;
+    UINT16 pwm_start;
+    INT16  cps_knots[CAL_TABLE_MAX_KNOTS];
+    UINT8  pwm_deltas[CAL_TABLE_MAX_KNOTS];
+    UINT8  reserved_1;
+    // Note: Total size is 80 bytes, at 16 bytes per row, 5 rows
+} __attribute__ ((packed)) CAL_TABLE_TYPE;
+
 typedef struct _cal_pid_tag
 {
     FLOAT kp;
@@ -64,6 +84,59 @@ typedef struct _cal_pid_tag
     // Note: Total size is 16 bytes, 1 row
 } __attribute__ ((packed)) CAL_PID_TYPE;
 
+/* Speed-scheduled PID gains.  Each band holds a gain set for a |commanded count/sec|.  The gains are linearly
+   interpolated between bands and held constant below the first band and above the last band.  A schedule with
+   no bands is not used.
+ */
+typedef struct _cal_pid_sched_tag
+{
+    UINT8 num_bands;
+    UINT8 reserved_1;
+    UINT16 cps[CAL_PID_SCHED_MAX_BANDS];
+    CAL_PID_TYPE gains[CAL_PID_SCHED_MAX_BANDS];
+    UINT8 reserved_2[6];
+    // Note: Total size is 80 bytes, at 16 bytes per row, 5 rows
+} __attribute__ ((packed)) CAL_PID_SCHED_TYPE;
+
+/* Runtime sample rates of the encoder, PID, odometry and outer loop updates.  A rate of zero (erased EEPROM) selects the
+   compile-time default (see consts.h).
+ */
+typedef struct _cal_rate_tag
+{
+    UINT16 enc_hz;
+    UINT16 pid_hz;
+    UINT16 odom_hz;
+    UINT16 outer_hz;
+    UINT8 reserved_1[8];
+    // Note: Total size is 16 bytes, 1 row
+} __attribute__ ((packed)) CAL_RATE_TYPE;
+
+/* First-order motor model identified from the motor calibration sweep (see calmotor.c), i.e., above the deadband:
+       d(count/sec)/dt = (gain * (|pwm - PWM_STOP| - deadband) - count/sec) / tau
+ */
+typedef struct _cal_motor_model_tag
+{
+    FLOAT gain;             /* count/sec per pwm */
+    FLOAT tau;              /* time constant (second) */
+    UINT16 deadband;        /* pwm offset from PWM_STOP */
+    UINT8 valid;            /* TRUE when identified, 0 (erased EEPROM) is not valid */
+    UINT8 reserved_1[5];
+    // Note: Total size is 16 bytes, 1 row
+} __attribute__ ((packed)) CAL_MOTOR_MODEL_TYPE;
+
+/* Console macros (see macro.c).  The data holds the macros back to back, each a header (size, name, number of steps)
+   followed by its steps, each a length and a compiled command (see ConParser_Compile).  The compiled commands refer
+   to the parser tables, so the store is only valid for the parser signature it was recorded with.
+ */
+typedef struct _cal_macro_store_tag
+{
+    UINT16 signature;       /* CONPARSER_SIGNATURE */
+    UINT16 length;          /* bytes of data used, 0 (erased EEPROM) is empty */
+    UINT8 reserved_1[4];
+    UINT8 data[CAL_MACRO_DATA_SIZE];
+    // Note: Total size is 576 bytes, 36 rows
+} __attribute__ ((packed)) CAL_MACRO_STORE_TYPE;
+
 typedef struct _eeprom_tag
 {
     // the following fields are padded to 16 bytes (1 row)
@@ -82,7 +155,18 @@ typedef struct _eeprom_tag
     FLOAT angular_bias;             /*   44 */
     CAL_PID_TYPE linear_gains;      /*   48 */
     CAL_PID_TYPE angular_gains;     /*   64 */
-    UINT8 reserved[1136];           /*   80 */
+    CAL_TABLE_TYPE left_table_fwd;  /*   80 */
+    CAL_TABLE_TYPE left_table_bwd;  /*  160 */
+    CAL_TABLE_TYPE right_table_fwd; /*  240 */
+    CAL_TABLE_TYPE right_table_bwd; /*  320 */
+    CAL_PID_SCHED_TYPE left_sched;  /*  400 */
+    CAL_PID_SCHED_TYPE right_sched; /*  480 */
+    CAL_RATE_TYPE rates;            /*  560 */
+    CAL_MOTOR_MODEL_TYPE left_model_fwd;    /*  576 */
+    CAL_MOTOR_MODEL_TYPE left_model_bwd;    /*  592 */
+    CAL_MOTOR_MODEL_TYPE right_model_fwd;   /*  608 */
+    CAL_MOTOR_MODEL_TYPE right_model_bwd;   /*  624 */
+    CAL_MACRO_STORE_TYPE macros;    /*  640 */
     CAL_DATA_TYPE left_motor_fwd;   /* 1216 */
     CAL_DATA_TYPE left_motor_bwd;   /* 1424 */
     CAL_DATA_TYPE right_motor_fwd;  /* 1632 */
@@ -0,0 +1,374 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides compression and evaluation of the motor calibration tables.
+ *-------------------------------------------------------------------------------------------------*/
+
+/* 
+    Explanation of Calibration Tables:
+
+    The motor response is most nonlinear near the deadband around PWM_STOP and nearly linear towards full speed.  
+    Motor calibration therefore places its pwm samples quadratically (see CalTable_SampleOffset), i.e., the samples 
+    near PWM_STOP are 4 pwm apart and the samples near full speed are 16 pwm apart.
+
+    The resulting CAL_DATA_TYPE table (51 samples) is compressed into a CAL_TABLE_TYPE table:
+        1. Samples with the same count/sec are merged keeping the sample furthest from PWM_STOP, i.e., the deadband
+           edge.  Count/sec 0 is always converted to PWM_STOP so the PWM_STOP sample is not needed.
+        2. Knots are chosen greedily: each segment is extended while every sample it skips is within a pwm tolerance
+           of the segment.  If there are too many knots the tolerance is doubled and the compression repeated.
+        3. The pwm of each knot is stored as the change from the previous knot (one byte).
+
+    Typically, the deadband edge and the knee of the curve are kept while the linear upper end collapses to a few
+    knots.  At 80 bytes the compressed table is less than half of the 208 byte CAL_DATA_TYPE.
+
+    For evaluation, the table is decoded into SRAM with a precomputed slope for each segment.  The segment used by the
+    last conversion is checked first because the wheel speed changes slowly between PID updates; otherwise, a binary
+    search over the knots is performed.
+ */
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "caltable.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define LINEAR_SPACING_PERCENT  (40)    // the linear portion of the sample spacing, the remainder is quadratic
+#define INITIAL_TOLERANCE_PWM   (2)     // the maximum pwm error of a skipped sample
+#define MAX_PWM_DELTA           (255)   // pwm deltas are stored as UINT8
+#define SLOPE_SCALE             (65536)
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: MergeSamples
+ * Description: Copies the samples into strictly ascending count/sec order.  Samples with the same 
+ *              count/sec are merged keeping the sample furthest from PWM_STOP.  Samples that are out of
+ *              order, i.e., noise, are dropped.
+ * Parameters: data - the calibration data
+ *             cps - the merged count/sec samples
+ *             pwm - the merged pwm samples
+ * Return: UINT8 - the number of merged samples
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 MergeSamples(CAL_DATA_TYPE* const data, INT16* const cps, INT16* const pwm)
+{
+    UINT8 ii;
+    UINT8 num_samples;
+    INT16 new_distance;
+    INT16 old_distance;
+
+    num_samples = 0;
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        if (num_samples > 0)
+        {
+            if (data->cps_data[ii] < cps[num_samples - 1])
+            {
+                continue;
+            }
+
+            if (data->cps_data[ii] == cps[num_samples - 1])
+            {
+                new_distance = (INT16) data->pwm_data[ii] - PWM_STOP;
+                old_distance = pwm[num_samples - 1] - PWM_STOP;
+                if (abs(new_distance) > abs(old_distance))
+                {
+                    pwm[num_samples - 1] = (INT16) data->pwm_data[ii];
+                }
+                continue;
+            }
+        }
+
+        cps[num_samples] = data->cps_data[ii];
+        pwm[num_samples] = (INT16) data->pwm_data[ii];
+        num_samples++;
+    }
+
+    return num_samples;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: SegmentFits
+ * Description: Determines if the segment between two samples represents the samples between them.
+ * Parameters: cps - the merged count/sec samples
+ *             pwm - the merged pwm samples
+ *             first - the index of the first sample of the segment
+ *             last - the index of the last sample of the segment
+ *             tolerance - the maximum pwm error of a skipped sample
+ * Return: BOOL - TRUE if the segment fits, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL SegmentFits(INT16* const cps, INT16* const pwm, UINT8 first, UINT8 last, INT16 tolerance)
+{
+    UINT8 ii;
+    INT32 pwm_delta;
+    INT32 error;
+
+    pwm_delta = pwm[last] - pwm[first];
+    if (abs(pwm_delta) > MAX_PWM_DELTA)
+    {
+        return FALSE;
+    }
+
+    for (ii = first + 1; ii < last; ++ii)
+    {
+        error = pwm[first] + pwm_delta * (cps[ii] - cps[first]) / (cps[last] - cps[first]) - pwm[ii];
+        if (abs(error) > tolerance)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: SelectKnots
+ * Description: Greedily selects the knots of a piecewise linear fit of the merged samples.
+ * Parameters: cps - the merged count/sec samples
+ *             pwm - the merged pwm samples
+ *             num_samples - the number of merged samples
+ *             tolerance - the maximum pwm error of a skipped sample
+ *             knots - the indices of the selected samples
+ * Return: UINT8 - the number of knots, 0 if more than CAL_TABLE_MAX_KNOTS are needed
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 SelectKnots(INT16* const cps, INT16* const pwm, UINT8 num_samples, INT16 tolerance, UINT8* const knots)
+{
+    UINT8 first;
+    UINT8 last;
+    UINT8 num_knots;
+
+    knots[0] = 0;
+    num_knots = 1;
+    first = 0;
+
+    while (first < num_samples - 1)
+    {
+        last = first + 1;
+        while (last + 1 < num_samples && SegmentFits(cps, pwm, first, last + 1, tolerance))
+        {
+            last++;
+        }
+
+        if (num_knots == CAL_TABLE_MAX_KNOTS)
+        {
+            return 0;
+        }
+
+        knots[num_knots++] = last;
+        first = last;
+    }
+
+    return num_knots;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTable_SampleOffset
+ * Description: Calculates the pwm offset from PWM_STOP of a motor calibration sample.  The spacing 
+ *              grows linearly with the index so that the samples are dense near the deadband and 
+ *              sparse at full speed:
+ *                  offset = domain * (a*u + (1 - a)*u^2), where u = index / (CAL_NUM_SAMPLES - 1)
+ * Parameters: index - the sample index, 0 is PWM_STOP, CAL_NUM_SAMPLES - 1 is full speed
+ *             domain - the pwm distance from PWM_STOP to full speed
+ * Return: UINT16 - the pwm offset
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT16 CalTable_SampleOffset(UINT8 index, UINT16 domain)
+{
+    INT32 last;
+    INT32 numerator;
+
+    last = CAL_NUM_SAMPLES - 1;
+    numerator = (INT32) domain * (LINEAR_SPACING_PERCENT * index * last + (100 - LINEAR_SPACING_PERCENT) * index * index);
+
+    return (UINT16) ((numerator + 50 * last * last) / (100 * last * last));
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTable_Compress
+ * Description: Compresses motor calibration data into a piecewise linear table.
+ * Parameters: data - the calibration data (ascending count/sec order)
+ *             table - the compressed table
+ * Return: UINT8 - the number of knots, 0 if the data could not be compressed
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT8 CalTable_Compress(CAL_DATA_TYPE* const data, CAL_TABLE_TYPE* const table)
+{
+    INT16 cps[CAL_NUM_SAMPLES];
+    INT16 pwm[CAL_NUM_SAMPLES];
+    UINT8 knots[CAL_TABLE_MAX_KNOTS];
+    UINT8 num_samples;
+    UINT8 num_knots;
+    INT16 tolerance;
+    INT16 pwm_delta;
+    UINT8 ii;
+
+    memset(table, 0, sizeof(*table));
+
+    num_samples = MergeSamples(data, cps, pwm);
+    if (num_samples < 2)
+    {
+        return 0;
+    }
+
+    for (tolerance = INITIAL_TOLERANCE_PWM, num_knots = 0; num_knots == 0 && tolerance <= MAX_PWM_DELTA; tolerance *= 2)
+    {
+        num_knots = SelectKnots(cps, pwm, num_samples, tolerance, knots);
+    }
+
+    if (num_knots == 0)
+    {
+        return 0;
+    }
+
+    table->flags = pwm[knots[num_knots - 1]] < pwm[knots[0]] ? CAL_TABLE_DESCENDING : 0;
+    table->pwm_start = (UINT16) pwm[knots[0]];
+    for (ii = 0; ii < num_knots; ++ii)
+    {
+        table->cps_knots[ii] = cps[knots[ii]];
+        if (ii > 0)
+        {
+            pwm_delta = pwm[knots[ii]] - pwm[knots[ii - 1]];
+            if (table->flags & CAL_TABLE_DESCENDING)
+            {
+                pwm_delta = -pwm_delta;
+            }
+
+            /* The pwm must be monotonic and each step must fit in a byte */
+            if (!in_range(pwm_delta, 0, MAX_PWM_DELTA))
+            {
+                memset(table, 0, sizeof(*table));
+                return 0;
+            }
+            table->pwm_deltas[ii] = (UINT8) pwm_delta;
+        }
+    }
+
+    table->num_knots = num_knots;
+    table->flags |= CAL_TABLE_VALID;
+
+    return num_knots;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTable_Decode
+ * Description: Decodes a compressed table for evaluation.
+ * Parameters: table - the compressed table
+ *             eval - the decoded table
+ * Return: BOOL - TRUE if the table is valid, otherwise FALSE (num_knots of eval is set to 0)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL CalTable_Decode(CAL_TABLE_TYPE* const table, CAL_TABLE_EVAL_TYPE* const eval)
+{
+    UINT8 ii;
+    INT16 sign;
+
+    eval->num_knots = 0;
+    eval->last_segment = 0;
+
+    if (!(table->flags & CAL_TABLE_VALID) || !in_range(table->num_knots, 2, CAL_TABLE_MAX_KNOTS))
+    {
+        return FALSE;
+    }
+
+    sign = table->flags & CAL_TABLE_DESCENDING ? -1 : 1;
+
+    eval->cps[0] = table->cps_knots[0];
+    eval->pwm[0] = (INT16) table->pwm_start;
+    for (ii = 1; ii < table->num_knots; ++ii)
+    {
+        /* Count/sec must be strictly ascending, otherwise the EEPROM contents are not a table */
+        if (table->cps_knots[ii] <= table->cps_knots[ii - 1])
+        {
+            return FALSE;
+        }
+
+        eval->cps[ii] = table->cps_knots[ii];
+        eval->pwm[ii] = eval->pwm[ii - 1] + sign * table->pwm_deltas[ii];
+        eval->slope[ii - 1] = (INT32) (eval->pwm[ii] - eval->pwm[ii - 1]) * SLOPE_SCALE / (eval->cps[ii] - eval->cps[ii - 1]);
+    }
+    eval->slope[ii - 1] = 0;
+
+    eval->num_knots = table->num_knots;
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTable_CpsToPwm
+ * Description: Converts count/sec to pwm using a decoded table.  The count/sec is limited to the 
+ *              range of the table.
+ * Parameters: eval - the decoded table
+ *             cps - the count/sec
+ * Return: PWM_TYPE - the pwm
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+PWM_TYPE CalTable_CpsToPwm(CAL_TABLE_EVAL_TYPE* const eval, INT16 cps)
+{
+    UINT8 segment;
+    UINT8 lower;
+    UINT8 upper;
+    UINT8 middle;
+    INT32 offset;
+
+    cps = constrain(cps, eval->cps[0], eval->cps[eval->num_knots - 1]);
+
+    segment = eval->last_segment;
+    if (cps < eval->cps[segment] || cps > eval->cps[segment + 1])
+    {
+        lower = 0;
+        upper = eval->num_knots - 1;
+        while (upper - lower > 1)
+        {
+            middle = (lower + upper) / 2;
+            if (cps < eval->cps[middle])
+            {
+                upper = middle;
+            }
+            else
+            {
+                lower = middle;
+            }
+        }
+        segment = lower;
+        eval->last_segment = segment;
+    }
+
+    offset = eval->slope[segment] * (cps - eval->cps[segment]);
+    offset = (offset + (offset >= 0 ? SLOPE_SCALE / 2 : -SLOPE_SCALE / 2)) / SLOPE_SCALE;
+
+    return (PWM_TYPE) (eval->pwm[segment] + offset);
+}
+
+/* [] END OF FILE */
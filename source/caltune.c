@@ -0,0 +1,428 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the implementation of relay-feedback (Astrom-Hagglund) auto-tuning
+   of the wheel PIDs.
+   
+   The wheel PID is bypassed and the wheel is driven by a relay around an operating point, i.e., the
+   commanded speed switches between bias + d and bias - d each time the measured speed crosses the
+   bias (with hysteresis).  The wheel settles into a limit cycle whose period is the ultimate period,
+   Tu, and whose amplitude, a, gives the ultimate gain:
+   
+       Ku = 4 * d / (pi * sqrt(a^2 - e^2))     where e is the relay hysteresis
+       
+   The PID gains are then calculated from Ku and Tu using the selected tuning rule.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "caltune.h"
+#include "cal.h"
+#include "control.h"
+#include "encoder.h"
+#include "pid.h"
+#include "pidbank.h"
+#include "serial.h"
+#include "time.h"
+#include "utils.h"
+#include "consts.h"
+#include "assertion.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define TUNE_BIAS_PERCENT       (0.5)       /* relay operating point, percent of maximum speed */
+#define TUNE_RELAY_PERCENT      (0.2)       /* relay amplitude, percent of maximum speed */
+#define TUNE_HYSTERESIS_PERCENT (0.02)      /* relay hysteresis, percent of maximum speed */
+
+#define TUNE_SAMPLE_TIME_MS     SAMPLE_TIME_MS(PID_SAMPLE_RATE)
+#define TUNE_SETTLE_TIME_MS     (1500)      /* time at the operating point before the relay starts */
+#define TUNE_TIMEOUT_MS         (20000)
+
+#define TUNE_DISCARD_CYCLES     (2)         /* cycles ignored while the limit cycle develops */
+#define TUNE_NUM_CYCLES         (4)         /* cycles averaged to determine Ku and Tu */
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {TUNE_STATE_SETTLE, TUNE_STATE_RELAY} TUNE_STATE_TYPE;
+
+typedef struct _tune_rule_tag
+{
+    CHAR name[8];
+    FLOAT kp_ku;                /* Kp as a fraction of Ku */
+    FLOAT ti_tu;                /* Ti as a fraction of Tu */
+    FLOAT td_tu;                /* Td as a fraction of Tu */
+} TUNE_RULE_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static const TUNE_RULE_TYPE tune_rules[CAL_TUNE_RULE_LAST] = {
+    /* name         Kp/Ku   Ti/Tu   Td/Tu */
+    {"zn",          0.600,  0.500,  0.125},
+    {"zn-pi",       0.450,  0.833,  0.000},
+    {"tl",          0.455,  2.200,  0.159},
+    {"tl-pi",       0.313,  2.200,  0.000},
+    {"pessen",      0.700,  0.400,  0.150},
+    {"some",        0.330,  0.500,  0.330},
+    {"none",        0.200,  0.500,  0.330},
+};
+
+static WHEEL_TYPE tune_wheel;
+static CAL_TUNE_RULE_TYPE tune_rule;
+static TUNE_STATE_TYPE tune_state;
+
+static FLOAT bias;
+static FLOAT relay;
+static FLOAT hysteresis;
+static BOOL relay_high;
+
+static UINT32 start_time;
+static UINT32 last_sample_time;
+static UINT32 last_switch_time;
+static BOOL have_switch;
+
+static FLOAT peak_max;
+static FLOAT peak_min;
+static UINT8 num_cycles;
+static UINT32 period_sum;
+static FLOAT amplitude_sum;
+
+static CAL_TUNE_RESULT_TYPE tune_result;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+static void SetVelocity(FLOAT cps)
+{
+    if (tune_wheel == WHEEL_LEFT)
+    {
+        Control_SetLeftRightVelocityCps(cps, 0.0);
+    }
+    else
+    {
+        Control_SetLeftRightVelocityCps(0.0, cps);
+    }
+}
+
+static FLOAT GetVelocity()
+{
+    return tune_wheel == WHEEL_LEFT ? Encoder_LeftGetCntsPerSec() : Encoder_RightGetCntsPerSec();
+}
+
+static PID_ENUM_TYPE WheelToPid(WHEEL_TYPE wheel)
+{
+    return wheel == WHEEL_LEFT ? PID_TYPE_LEFT : PID_TYPE_RIGHT;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Finish
+ * Description: Stops the wheel, returns the PID to normal operation and calculates the result.
+ * Parameters: valid - TRUE if the required number of cycles were measured; otherwise, FALSE.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Finish(BOOL valid)
+{
+    FLOAT amplitude;
+    FLOAT kp;
+    FLOAT ki;
+    FLOAT kd;
+    FLOAT kf;
+
+    SetVelocity(0.0);
+    Pid_BypassAll(FALSE);
+
+    tune_result.valid = FALSE;
+    tune_result.num_cycles = num_cycles > TUNE_DISCARD_CYCLES ? num_cycles - TUNE_DISCARD_CYCLES : 0;
+    
+    if (!valid)
+    {
+        Ser_PutString("No stable oscillation found\r\n");
+        return;
+    }
+    
+    amplitude = amplitude_sum / TUNE_NUM_CYCLES;
+    if (amplitude <= hysteresis)
+    {
+        Ser_PutString("Oscillation amplitude is within the relay hysteresis\r\n");
+        return;
+    }
+    
+    tune_result.amplitude = amplitude;
+    tune_result.tu = (FLOAT) period_sum / (TUNE_NUM_CYCLES * MS_IN_SEC);
+    tune_result.ku = (4.0 * relay) / (PI * sqrt(amplitude * amplitude - hysteresis * hysteresis));
+    
+    CalTune_ComputeGains(tune_rule, tune_result.ku, tune_result.tu, &tune_result.gains);
+    
+    /* Note: The relay test does not say anything about the feedforward gain so keep the current one */
+    PidBank_GetGains(WheelToPid(tune_wheel), &kp, &ki, &kd, &kf);
+    tune_result.gains.kf = kf;
+    
+    tune_result.valid = TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ProcessRelay
+ * Description: Switches the relay and measures the limit cycle.  A cycle is measured between
+ *              successive high-to-low relay switches.
+ * Parameters: now - the current time (ms)
+ *             cps - the measured wheel speed
+ * Return: BOOL - TRUE when the required number of cycles are measured; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL ProcessRelay(UINT32 now, FLOAT cps)
+{
+    UINT32 period;
+    FLOAT amplitude;
+    
+    peak_max = max(peak_max, cps);
+    peak_min = min(peak_min, cps);
+    
+    if (relay_high && cps > bias + hysteresis)
+    {
+        relay_high = FALSE;
+        SetVelocity(bias - relay);
+        
+        if (have_switch)
+        {
+            period = now - last_switch_time;
+            amplitude = (peak_max - peak_min) / 2.0;
+            num_cycles++;
+            
+            Ser_PutStringFormat("cycle %d: period %ld ms, amplitude %.1f cps%s\r\n", 
+                                num_cycles, period, amplitude, num_cycles <= TUNE_DISCARD_CYCLES ? " (discarded)" : "");
+            
+            if (num_cycles > TUNE_DISCARD_CYCLES)
+            {
+                period_sum += period;
+                amplitude_sum += amplitude;
+            }
+        }
+        
+        have_switch = TRUE;
+        last_switch_time = now;
+        peak_max = cps;
+        peak_min = cps;
+        
+        return num_cycles >= TUNE_DISCARD_CYCLES + TUNE_NUM_CYCLES;
+    }
+    
+    if (!relay_high && cps < bias - hysteresis)
+    {
+        relay_high = TRUE;
+        SetVelocity(bias + relay);
+    }
+    
+    return FALSE;
+}
+
+/*----------------------------------------------------------------------------------------------------------------------
+ * Module Interface Routines
+ *---------------------------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_ParseRule
+ * Description: Converts a tuning rule name to the tuning rule.
+ * Parameters: name - the rule name, e.g., zn, tl
+ *             rule - the tuning rule
+ * Return: BOOL - TRUE if the name is a valid rule; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL CalTune_ParseRule(CHAR* const name, CAL_TUNE_RULE_TYPE* const rule)
+{
+    UINT8 ii;
+    
+    for (ii = 0; ii < CAL_TUNE_RULE_LAST; ++ii)
+    {
+        if (strcmp(name, tune_rules[ii].name) == 0)
+        {
+            *rule = (CAL_TUNE_RULE_TYPE) ii;
+            return TRUE;
+        }
+    }
+    
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_RuleToString
+ * Description: Returns the name of the tuning rule.
+ * Parameters: rule - the tuning rule
+ * Return: CHAR* - the rule name
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CHAR* CalTune_RuleToString(CAL_TUNE_RULE_TYPE rule)
+{
+    return rule < CAL_TUNE_RULE_LAST ? (CHAR *) tune_rules[rule].name : "unknown";
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_ComputeGains
+ * Description: Calculates the PID gains from the ultimate gain and period using the tuning rule.
+ *              Note: The feedforward gain is not changed.
+ * Parameters: rule - the tuning rule
+ *             ku - the ultimate gain
+ *             tu - the ultimate period (sec)
+ *             gains - the calculated gains
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalTune_ComputeGains(CAL_TUNE_RULE_TYPE rule, FLOAT ku, FLOAT tu, CAL_PID_TYPE* const gains)
+{
+    FLOAT ti;
+    
+    ASSERTION(rule < CAL_TUNE_RULE_LAST, "Unknown tuning rule");
+    
+    ti = tune_rules[rule].ti_tu * tu;
+    
+    gains->kp = tune_rules[rule].kp_ku * ku;
+    gains->ki = ti > 0.0 ? gains->kp / ti : 0.0;
+    gains->kd = gains->kp * tune_rules[rule].td_tu * tu;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_Init
+ * Description: Starts the relay auto-tune of the specified wheel.
+ * Parameters: wheel - the wheel to tune (left or right)
+ *             rule - the tuning rule used to calculate the gains
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void CalTune_Init(WHEEL_TYPE wheel, CAL_TUNE_RULE_TYPE rule)
+{
+    FLOAT max_cps;
+
+    ASSERTION(wheel == WHEEL_LEFT || wheel == WHEEL_RIGHT, "Unexpected wheel");
+    
+    tune_wheel = wheel;
+    tune_rule = rule;
+    
+    max_cps = Cal_CalcMaxCps();
+    bias = TUNE_BIAS_PERCENT * max_cps;
+    relay = TUNE_RELAY_PERCENT * max_cps;
+    hysteresis = TUNE_HYSTERESIS_PERCENT * max_cps;
+    
+    Ser_PutStringFormat("%s PID auto-tune, rule: %s, bias: %.1f, relay: %.1f, hysteresis: %.1f\r\n", 
+                        WheelToString(wheel, FORMAT_LOWER), 
+                        CalTune_RuleToString(rule),
+                        bias, relay, hysteresis);
+
+    memset(&tune_result, 0, sizeof tune_result);
+    relay_high = TRUE;
+    have_switch = FALSE;
+    num_cycles = 0;
+    period_sum = 0;
+    amplitude_sum = 0.0;
+    
+    /* Note: With the PID bypassed, the commanded speed goes straight to the wheel, i.e., the relay
+       replaces the PID in the loop.
+     */
+    Control_SetLeftRightVelocityOverride(TRUE);
+    Pid_Reset();
+    Pid_BypassAll(TRUE);
+    Encoder_Reset();
+    
+    tune_state = TUNE_STATE_SETTLE;
+    SetVelocity(bias);
+    
+    start_time = millis();
+    last_sample_time = start_time;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_Update
+ * Description: Called periodically from the main loop to run the relay and measure the limit cycle.
+ * Parameters: None 
+ * Return: UINT8 - CAL_OK, CAL_COMPLETE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT8 CalTune_Update()
+{
+    UINT32 now;
+    FLOAT cps;
+    
+    now = millis();
+    if (now - start_time >= TUNE_TIMEOUT_MS)
+    {
+        Finish(FALSE);
+        return CAL_COMPLETE;
+    }
+    
+    if (now - last_sample_time < TUNE_SAMPLE_TIME_MS)
+    {
+        return CAL_OK;
+    }
+    last_sample_time = now;
+    
+    cps = GetVelocity();
+    
+    switch (tune_state)
+    {
+        case TUNE_STATE_SETTLE:
+            if (now - start_time >= TUNE_SETTLE_TIME_MS)
+            {
+                tune_state = TUNE_STATE_RELAY;
+                relay_high = TRUE;
+                peak_max = cps;
+                peak_min = cps;
+                SetVelocity(bias + relay);
+            }
+            break;
+            
+        case TUNE_STATE_RELAY:
+            if (ProcessRelay(now, cps))
+            {
+                Finish(TRUE);
+                return CAL_COMPLETE;
+            }
+            break;
+            
+        default:
+            break;
+    }
+    
+    return CAL_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalTune_GetResult
+ * Description: Returns the result of the last auto-tune.
+ * Parameters: None 
+ * Return: CAL_TUNE_RESULT_TYPE*
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+CAL_TUNE_RESULT_TYPE* CalTune_GetResult()
+{
+    return &tune_result;
+}
+
+/*-------------------------------------------------------------------------------*/
+/* [] END OF FILE */
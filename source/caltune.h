@@ -0,0 +1,77 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the implementation of relay-feedback (Astrom-Hagglund) auto-tuning
+   of the wheel PIDs.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef CALTUNE_H
+#define CALTUNE_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+#include "calstore.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum 
+{
+    CAL_TUNE_RULE_ZN,           /* Ziegler-Nichols PID */
+    CAL_TUNE_RULE_ZN_PI,        /* Ziegler-Nichols PI */
+    CAL_TUNE_RULE_TL,           /* Tyreus-Luyben PID */
+    CAL_TUNE_RULE_TL_PI,        /* Tyreus-Luyben PI */
+    CAL_TUNE_RULE_PESSEN,       /* Pessen integral rule */
+    CAL_TUNE_RULE_SOME,         /* Some overshoot */
+    CAL_TUNE_RULE_NONE,         /* No overshoot */
+    CAL_TUNE_RULE_LAST
+} CAL_TUNE_RULE_TYPE;
+
+typedef struct _cal_tune_result_tag
+{
+    BOOL valid;
+    FLOAT ku;                   /* ultimate gain */
+    FLOAT tu;                   /* ultimate period (sec) */
+    FLOAT amplitude;            /* average oscillation amplitude (count/sec) */
+    UINT8 num_cycles;
+    CAL_PID_TYPE gains;
+} CAL_TUNE_RESULT_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+BOOL CalTune_ParseRule(CHAR* const name, CAL_TUNE_RULE_TYPE* const rule);
+CHAR* CalTune_RuleToString(CAL_TUNE_RULE_TYPE rule);
+void CalTune_ComputeGains(CAL_TUNE_RULE_TYPE rule, FLOAT ku, FLOAT tu, CAL_PID_TYPE* const gains);
+
+void CalTune_Init(WHEEL_TYPE wheel, CAL_TUNE_RULE_TYPE rule);
+UINT8 CalTune_Update();
+CAL_TUNE_RESULT_TYPE* CalTune_GetResult();
+
+
+#endif
+
+/* [] END OF FILE */
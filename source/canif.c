@@ -311,4 +311,21 @@ void CANIF_UpdateHeartbeat(UINT32 heartbeat)
     WriteHeartbeatMsg(heartbeat);
 }
 
+/* Note: The CAN component does not have a path mailbox, so paths are uploaded over I2C or the console and the
+   path status is not published on the CAN bus.
+ */
+UINT8 CANIF_ReadPathControl(UINT8* const index, UINT8* const count, FLOAT* const speed, FLOAT* const lookahead, FLOAT* const points)
+{
+    *index = 0;
+    *count = 0;
+    *speed = 0.0;
+    *lookahead = 0.0;
+    
+    return 0;
+}
+
+void CANIF_WritePathStatus(UINT8 state, UINT8 num_points, UINT8 segment, FLOAT progress, FLOAT cross_track)
+{
+}
+
 /* [] END OF FILE */
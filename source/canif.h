@@ -65,6 +65,9 @@ void CANIF_WritePosition(FLOAT x_position, FLOAT y_position);
 void CANIF_WriteHeading(FLOAT heading);
 void CANIF_UpdateHeartbeat(UINT32 heartbeat);
 
+UINT8 CANIF_ReadPathControl(UINT8* const index, UINT8* const count, FLOAT* const speed, FLOAT* const lookahead, FLOAT* const points);
+void CANIF_WritePathStatus(UINT8 state, UINT8 num_points, UINT8 segment, FLOAT progress, FLOAT cross_track);
+
 #endif
 
 /* [] END OF FILE */
\ No newline at end of file
@@ -56,6 +56,8 @@ SOFTWARE.
 #define WritePosition                   I2CIF_WritePosition
 #define WriteHeading                    I2CIF_WriteHeading
 #define UpdateHeartbeat                 I2CIF_UpdateHeartbeat
+#define ReadPathControl                 I2CIF_ReadPathControl
+#define WritePathStatus                 I2CIF_WritePathStatus
 
 #elif !defined(ENABLE_I2CIF) && defined(ENABLE_CANIF)
 #include "canif.h"    
@@ -72,6 +74,8 @@ SOFTWARE.
 #define WritePosition                   CANIF_WritePosition
 #define WriteHeading                    CANIF_WriteHeading
 #define UpdateHeartbeat                 CANIF_UpdateHeartbeat
+#define ReadPathControl                 CANIF_ReadPathControl
+#define WritePathStatus                 CANIF_WritePathStatus
 
 #else
 #error "Only one interface can be defined at a time!"
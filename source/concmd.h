@@ -11,6 +11,8 @@ typedef struct _command_if
     BOOL (* update)();
     BOOL (* status)();
     void (* results)();
+    /* Optional: releases whatever the command is driving when the command is killed */
+    void (* stop)();
 } CONCMD_IF_TYPE;
 
 typedef CONCMD_IF_TYPE * const CONCMD_IF_PTR_TYPE;
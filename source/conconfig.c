@@ -1,16 +1,25 @@
 #include <stdarg.h>
+#include <string.h>
 #include "conconfig.h"
 #include "consts.h"
 #include "debug.h"
 #include "cal.h"
+#include "rate.h"
+#include "angle.h"
+#include "control.h"
+#include "profile.h"
 #include "utils.h"
+#include "emit.h"
+#include "calsnap.h"
+#include "calrefine.h"
 
-typedef enum {CONFIG_FIRST = 0, CONFIG_DEBUG=CONFIG_FIRST, CONFIG_CLEAR, CONFIG_SHOW, CONFIG_LAST} CONFIG_CMD_TYPE;
+typedef enum {CONFIG_FIRST = 0, CONFIG_DEBUG=CONFIG_FIRST, CONFIG_CLEAR, CONFIG_SHOW, CONFIG_RATE, CONFIG_BENCH, CONFIG_ACCEL, CONFIG_SHAPE, CONFIG_REFINE, CONFIG_EXPORT, CONFIG_IMPORT, CONFIG_LAST} CONFIG_CMD_TYPE;
 
 typedef struct _tag_config_show
 {
     UINT16 mask;
     BOOL plain_text;
+    EMIT_STREAM_TYPE stream;
 } CONFIG_SHOW_TYPE;
 
 typedef struct _tag_config_debug
@@ -25,12 +34,71 @@ typedef struct _tag_config_clear
     BOOL plain_text;
 } CONFIG_CLEAR_TYPE;
 
+typedef struct _tag_config_rate
+{
+    UINT16 rates[RATE_LAST];
+    BOOL save;
+    BOOL plain_text;
+} CONFIG_RATE_TYPE;
+
+typedef struct _tag_config_bench
+{
+    BOOL plain_text;
+} CONFIG_BENCH_TYPE;
+
+typedef struct _tag_config_accel
+{
+    FLOAT lin_accel;
+    FLOAT lin_jerk;
+    FLOAT ang_accel;
+    FLOAT ang_jerk;
+    BOOL plain_text;
+} CONFIG_ACCEL_TYPE;
+
+typedef struct _tag_config_shape
+{
+    BOOL set_policy;
+    CONTROL_SHAPE_TYPE policy;
+    BOOL reset;
+    BOOL plain_text;
+} CONFIG_SHAPE_TYPE;
+
+typedef struct _tag_config_refine
+{
+    BOOL set_enable;
+    BOOL enable;
+    BOOL plain_text;
+} CONFIG_REFINE_TYPE;
+
+typedef struct _tag_config_export
+{
+    UINT8 sections;
+    CALSNAP_FORMAT_TYPE format;
+    EMIT_STREAM_TYPE stream;
+} CONFIG_EXPORT_TYPE;
+
+typedef struct _tag_config_import
+{
+    CONCONFIG_IMPORT_ACTION_TYPE action;
+    CHAR data[CALSNAP_CHUNK_LENGTH + 1];
+    CALSNAP_RESULT_TYPE result;
+    UINT8 sections;
+    BOOL plain_text;
+} CONFIG_IMPORT_TYPE;
+
 
 static BOOL is_running;
 
 static CONFIG_DEBUG_TYPE config_debug;
 static CONFIG_SHOW_TYPE config_show;
 static CONFIG_CLEAR_TYPE config_clear;
+static CONFIG_RATE_TYPE config_rate;
+static CONFIG_BENCH_TYPE config_bench;
+static CONFIG_ACCEL_TYPE config_accel;
+static CONFIG_SHAPE_TYPE config_shape;
+static CONFIG_REFINE_TYPE config_refine;
+static CONFIG_EXPORT_TYPE config_export;
+static CONFIG_IMPORT_TYPE config_import;
 
 
 static CONCMD_IF_TYPE cmd_if_array[CONFIG_LAST];
@@ -77,30 +145,46 @@ static void config_debug_results(void)
 
 /*-------------------------------------------------------------------
     Config Show
+
+    The output is sent a chunk per update (see Emit_Chunk).
 */
 
 static CONCMD_IF_PTR_TYPE config_show_init(UINT16 mask, BOOL plain_text)
 {
     config_show.mask = mask;
     config_show.plain_text = plain_text;
+    Emit_StreamInit(&config_show.stream);
     is_running = TRUE;
 
     return &cmd_if_array[CONFIG_SHOW];
 }
 
-static BOOL config_show_update(void)
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PrintParam/PrintParamLine
+ * Description: Prints a line of the physical parameters (see config show --params).
+ * Parameters: label - the label, including the separator
+ *             value - the value
+ *             decimals - the number of decimals
+ *             units - the units, including the leading space
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PrintParam(CHAR const * const label, FLOAT value, UINT8 decimals, CHAR const * const units)
 {
-    is_running = FALSE;
-    return is_running;
+    Emit_String(label);
+    Emit_Fixed(value, decimals);
+    Emit_String(units);
+    Emit_Newline();
 }
 
-static BOOL config_show_status(void)
+static void PrintParamLine(CHAR const * const line)
 {
-    return is_running;
+    Emit_String(line);
+    Emit_Newline();
 }
 
-
-static void config_show_results(void)
+static void config_show_emit(void)
 {
     switch (config_show.mask)
     {
@@ -117,7 +201,10 @@ static void config_show_results(void)
             break;
             
         case CONCONFIG_DEBUG_BIT:
-            Ser_PutStringFormat("0x%02x\r\n", Debug_GetMask());
+            Emit_String("0x");
+            Emit_Hex(Debug_GetMask(), 2);
+            Emit_Newline();
+            Emit_Flush();
             break;
 
         case CONCONFIG_STATUS_BIT:
@@ -126,47 +213,65 @@ static void config_show_results(void)
             
         case CONCONFIG_PARAMS_BIT:
         {
-            Ser_WriteLine("----------- Physical Characteristics -----------", TRUE);
-            Ser_PutStringFormat("Track Width         : %.4f meter\r\n", TRACK_WIDTH);
-            Ser_PutStringFormat("Wheel Radius        : %.4f meter\r\n", WHEEL_RADIUS);
-            Ser_PutStringFormat("Wheel Diameter      : %.4f meter\r\n", WHEEL_DIAMETER);
-            Ser_PutStringFormat("Wheel Circumference : %.4f meter\r\n", WHEEL_CIRCUMFERENCE);
-            Ser_PutStringFormat("Wheel Max Rotation  : %2.0f RPM\r\n", MAX_WHEEL_RPM);
-            Ser_PutStringFormat("Wheel Encoder Tick  : %d tick/rev\r\n", WHEEL_ENCODER_TICK_PER_REV);
-            Ser_PutStringFormat("Wheel Encoder Count : %d count/rev\r\n", WHEEL_COUNT_PER_REV);
-            Ser_WriteLine("", TRUE);
-            Ser_WriteLine(      "------------ Wheel Rates -----------", TRUE);
-            Ser_PutStringFormat("Wheel (meter/count)   : %.4f\r\n", WHEEL_METER_PER_COUNT);
-            Ser_PutStringFormat("Wheel (radian/count)  : %.4f\r\n", WHEEL_RADIAN_PER_COUNT);            
-            Ser_PutStringFormat("Wheel (radian/second) : %.4f\r\n", MAX_WHEEL_RADIAN_PER_SECOND);
-            Ser_PutStringFormat("Wheel (count/meter)   : %.4f\r\n", WHEEL_COUNT_PER_METER);
-            Ser_PutStringFormat("Wheel (count/radian)  : %.4f\r\n", WHEEL_COUNT_PER_RADIAN);
-            Ser_WriteLine("", TRUE);
-            Ser_WriteLine("---------------------------- Wheel Maxes ---------------------------", TRUE);
-            Ser_PutStringFormat("Wheel Forward Max  : %.4f meter/second\r\n", MAX_WHEEL_FORWARD_LINEAR_VELOCITY);
-            Ser_PutStringFormat("Wheel Forward Max  : %.4f count/second\r\n", MAX_WHEEL_FORWARD_COUNT_PER_SEC);
-            Ser_PutStringFormat("Wheel Backward Max : %.4f meter/second\r\n", MAX_WHEEL_BACKWARD_LINEAR_VELOCITY);
-            Ser_PutStringFormat("Wheel Backward Max : %.4f count/second\r\n", MAX_WHEEL_BACKWARD_COUNT_PER_SEC);
-            Ser_WriteLine("", TRUE);
-            Ser_PutStringFormat("Wheel CW Max       : %.4f radian/second\r\n", MAX_WHEEL_CW_ANGULAR_VELOCITY);
-            Ser_PutStringFormat("Wheel CW Max       : %.4f count/second\r\n", MAX_WHEEL_CW_COUNT_PER_SEC);
-            Ser_PutStringFormat("Wheel CCW Max      : %.4f radian/second\r\n", MIN_WHEEL_CCW_ANGULAR_VELOCITY);
-            Ser_PutStringFormat("Wheel CCW Max      : %.4f count/second\r\n", MAX_WHEEL_CCW_COUNT_PER_SEC);
-            Ser_WriteLine("", TRUE);
-            Ser_WriteLine("---------------------------- Robot Max ---------------------------", TRUE);
-            Ser_PutStringFormat("Robot Max Rotation : %.4f RPM\r\n", MAX_ROBOT_RPM);
-            Ser_PutStringFormat("Robot Rotation     : %.4f meter/rev\r\n", ROBOT_METER_PER_REV);
-            Ser_PutStringFormat("Robot Rotation     : %.4f count/rev\r\n", ROBOT_COUNT_PER_REV);
-            Ser_PutStringFormat("Robot Forward Max  : %.4f meter/second\r\n", MAX_WHEEL_FORWARD_LINEAR_VELOCITY);
-            Ser_PutStringFormat("Robot Backward Max : %.4f meter/second\r\n", MAX_WHEEL_BACKWARD_LINEAR_VELOCITY);
-            Ser_PutStringFormat("Robot CW Max       : %.4f radian/second\r\n", MAX_ROBOT_CW_RADIAN_PER_SECOND);
-            Ser_PutStringFormat("Robot CCW Max      : %.4f radian/second\r\n", MAX_ROBOT_CCW_RADIAN_PER_SECOND);
+            PrintParamLine("----------- Physical Characteristics -----------");
+            PrintParam("Track Width         : ", TRACK_WIDTH, 4, " meter");
+            PrintParam("Wheel Radius        : ", WHEEL_RADIUS, 4, " meter");
+            PrintParam("Wheel Diameter      : ", WHEEL_DIAMETER, 4, " meter");
+            PrintParam("Wheel Circumference : ", WHEEL_CIRCUMFERENCE, 4, " meter");
+            PrintParam("Wheel Max Rotation  : ", MAX_WHEEL_RPM, 0, " RPM");
+            PrintParam("Wheel Encoder Tick  : ", WHEEL_ENCODER_TICK_PER_REV, 0, " tick/rev");
+            PrintParam("Wheel Encoder Count : ", WHEEL_COUNT_PER_REV, 0, " count/rev");
+            PrintParamLine("");
+            PrintParamLine("------------ Wheel Rates -----------");
+            PrintParam("Wheel (meter/count)   : ", WHEEL_METER_PER_COUNT, 4, "");
+            PrintParam("Wheel (radian/count)  : ", WHEEL_RADIAN_PER_COUNT, 4, "");
+            PrintParam("Wheel (radian/second) : ", MAX_WHEEL_RADIAN_PER_SECOND, 4, "");
+            PrintParam("Wheel (count/meter)   : ", WHEEL_COUNT_PER_METER, 4, "");
+            PrintParam("Wheel (count/radian)  : ", WHEEL_COUNT_PER_RADIAN, 4, "");
+            PrintParamLine("");
+            PrintParamLine("---------------------------- Wheel Maxes ---------------------------");
+            PrintParam("Wheel Forward Max  : ", MAX_WHEEL_FORWARD_LINEAR_VELOCITY, 4, " meter/second");
+            PrintParam("Wheel Forward Max  : ", MAX_WHEEL_FORWARD_COUNT_PER_SEC, 4, " count/second");
+            PrintParam("Wheel Backward Max : ", MAX_WHEEL_BACKWARD_LINEAR_VELOCITY, 4, " meter/second");
+            PrintParam("Wheel Backward Max : ", MAX_WHEEL_BACKWARD_COUNT_PER_SEC, 4, " count/second");
+            PrintParamLine("");
+            PrintParam("Wheel CW Max       : ", MAX_WHEEL_CW_ANGULAR_VELOCITY, 4, " radian/second");
+            PrintParam("Wheel CW Max       : ", MAX_WHEEL_CW_COUNT_PER_SEC, 4, " count/second");
+            PrintParam("Wheel CCW Max      : ", MIN_WHEEL_CCW_ANGULAR_VELOCITY, 4, " radian/second");
+            PrintParam("Wheel CCW Max      : ", MAX_WHEEL_CCW_COUNT_PER_SEC, 4, " count/second");
+            PrintParamLine("");
+            PrintParamLine("---------------------------- Robot Max ---------------------------");
+            PrintParam("Robot Max Rotation : ", MAX_ROBOT_RPM, 4, " RPM");
+            PrintParam("Robot Rotation     : ", ROBOT_METER_PER_REV, 4, " meter/rev");
+            PrintParam("Robot Rotation     : ", ROBOT_COUNT_PER_REV, 4, " count/rev");
+            PrintParam("Robot Forward Max  : ", MAX_WHEEL_FORWARD_LINEAR_VELOCITY, 4, " meter/second");
+            PrintParam("Robot Backward Max : ", MAX_WHEEL_BACKWARD_LINEAR_VELOCITY, 4, " meter/second");
+            PrintParam("Robot CW Max       : ", MAX_ROBOT_CW_RADIAN_PER_SECOND, 4, " radian/second");
+            PrintParam("Robot CCW Max      : ", MAX_ROBOT_CCW_RADIAN_PER_SECOND, 4, " radian/second");
+            Emit_Flush();
 
             break; 
         }
     }
 }
 
+static BOOL config_show_update(void)
+{
+    is_running = Emit_Chunk(&config_show.stream, config_show_emit);
+    return is_running;
+}
+
+static BOOL config_show_status(void)
+{
+    return is_running;
+}
+
+static void config_show_stop(void)
+{
+    Emit_Cancel(&config_show.stream);
+    is_running = FALSE;
+}
+
 /*-------------------------------------------------------------------
     Config Clear
 
@@ -181,7 +286,7 @@ static CONCMD_IF_PTR_TYPE config_clear_init(UINT16 mask, BOOL plain_text)
     config_clear.plain_text = plain_text;
 
     is_running = TRUE;
-    return &cmd_if_array[CONFIG_SHOW];
+    return &cmd_if_array[CONFIG_CLEAR];
 }
 
 static BOOL config_clear_update(void)
@@ -199,6 +304,404 @@ static void config_clear_results(void)
 {    
 }
 
+/*-------------------------------------------------------------------
+    Config Rate
+
+    Rates which are not given are unchanged.  The new rates take effect
+    immediately and are stored in EEPROM only when requested.
+*/
+
+static CONCMD_IF_PTR_TYPE config_rate_init(INT32 enc_rate, INT32 pid_rate, INT32 odom_rate, INT32 outer_rate, BOOL save, BOOL plain_text)
+{
+    if ((IS_VALID_INT(enc_rate) && !in_range(enc_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE)) ||
+        (IS_VALID_INT(pid_rate) && !in_range(pid_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE)) ||
+        (IS_VALID_INT(odom_rate) && !in_range(odom_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE)) ||
+        (IS_VALID_INT(outer_rate) && !in_range(outer_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE)))
+    {
+        Ser_PutStringFormat("Rates must be between %d and %d Hz\r\n", MIN_SAMPLE_RATE, MAX_SAMPLE_RATE);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    config_rate.rates[RATE_ENC] = IS_VALID_INT(enc_rate) ? enc_rate : Rate_Get(RATE_ENC);
+    config_rate.rates[RATE_PID] = IS_VALID_INT(pid_rate) ? pid_rate : Rate_Get(RATE_PID);
+    config_rate.rates[RATE_ODOM] = IS_VALID_INT(odom_rate) ? odom_rate : Rate_Get(RATE_ODOM);
+    config_rate.rates[RATE_OUTER] = IS_VALID_INT(outer_rate) ? outer_rate : Rate_Get(RATE_OUTER);
+    config_rate.save = save;
+    config_rate.plain_text = plain_text;
+
+    if (!Rate_IsValid(config_rate.rates[RATE_ENC], 
+                      config_rate.rates[RATE_PID], 
+                      config_rate.rates[RATE_ODOM], 
+                      config_rate.rates[RATE_OUTER]))
+    {
+        Ser_WriteLine("The PID rate must not exceed the encoder rate and the outer rate must not exceed the PID rate", TRUE);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_RATE];
+}
+
+static BOOL config_rate_update(void)
+{
+    Rate_Set(config_rate.rates[RATE_ENC], 
+             config_rate.rates[RATE_PID], 
+             config_rate.rates[RATE_ODOM], 
+             config_rate.rates[RATE_OUTER]);
+    if (config_rate.save)
+    {
+        Rate_Save();
+    }
+
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_rate_status(void)
+{
+    return is_running;
+}
+
+static void config_rate_results(void)
+{
+    Rate_Print(!config_rate.plain_text);
+}
+
+/*-------------------------------------------------------------------
+    Config Bench
+
+    Measures the cycles and accuracy of the angle math against libm and
+    the per-tick cost of the velocity profile.  The benchmark runs once
+    when the results are printed.
+*/
+
+static CONCMD_IF_PTR_TYPE config_bench_init(BOOL plain_text)
+{
+    config_bench.plain_text = plain_text;
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_BENCH];
+}
+
+static BOOL config_bench_update(void)
+{
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_bench_status(void)
+{
+    return is_running;
+}
+
+static void config_bench_results(void)
+{
+    Angle_Benchmark(!config_bench.plain_text);
+    Profile_Benchmark(!config_bench.plain_text);
+}
+
+/*-------------------------------------------------------------------
+    Config Accel
+
+    Limits which are not given are unchanged.  A jerk of zero selects a
+    trapezoidal (acceleration limited) profile.  The limits are not stored.
+*/
+
+static CONCMD_IF_PTR_TYPE config_accel_init(FLOAT lin_accel, FLOAT lin_jerk, FLOAT ang_accel, FLOAT ang_jerk, BOOL plain_text)
+{
+    FLOAT curr_lin_accel;
+    FLOAT curr_lin_jerk;
+    FLOAT curr_ang_accel;
+    FLOAT curr_ang_jerk;
+
+    if ((IS_VALID_FLOAT(lin_accel) && lin_accel <= 0.0) ||
+        (IS_VALID_FLOAT(lin_jerk) && lin_jerk < 0.0) ||
+        (IS_VALID_FLOAT(ang_accel) && ang_accel <= 0.0) ||
+        (IS_VALID_FLOAT(ang_jerk) && ang_jerk < 0.0))
+    {
+        Ser_WriteLine("Acceleration must be positive and jerk must not be negative", TRUE);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    Control_GetProfileLimits(&curr_lin_accel, &curr_lin_jerk, &curr_ang_accel, &curr_ang_jerk);
+
+    config_accel.lin_accel = IS_VALID_FLOAT(lin_accel) ? lin_accel : curr_lin_accel;
+    config_accel.lin_jerk = IS_VALID_FLOAT(lin_jerk) ? lin_jerk : curr_lin_jerk;
+    config_accel.ang_accel = IS_VALID_FLOAT(ang_accel) ? ang_accel : curr_ang_accel;
+    config_accel.ang_jerk = IS_VALID_FLOAT(ang_jerk) ? ang_jerk : curr_ang_jerk;
+    config_accel.plain_text = plain_text;
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_ACCEL];
+}
+
+static BOOL config_accel_update(void)
+{
+    Control_SetProfileLimits(config_accel.lin_accel, 
+                             config_accel.lin_jerk, 
+                             config_accel.ang_accel, 
+                             config_accel.ang_jerk);
+
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_accel_status(void)
+{
+    return is_running;
+}
+
+static void config_accel_results(void)
+{
+    if (config_accel.plain_text)
+    {
+        Ser_PutStringFormat("Linear: accel %.3f m/s^2, jerk %.3f m/s^3\r\n", config_accel.lin_accel, config_accel.lin_jerk);
+        Ser_PutStringFormat("Angular: accel %.3f rad/s^2, jerk %.3f rad/s^3\r\n", config_accel.ang_accel, config_accel.ang_jerk);
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"linear\":{\"accel\":%.3f,\"jerk\":%.3f},\"angular\":{\"accel\":%.3f,\"jerk\":%.3f}}\r\n",
+                            config_accel.lin_accel, config_accel.lin_jerk, config_accel.ang_accel, config_accel.ang_jerk);
+    }
+}
+
+/*-------------------------------------------------------------------
+    Config Shape
+
+    Selects how a command outside of the wheel envelope is fitted and
+    reports the saturation counters.  The counters are reported before
+    they are reset.
+*/
+
+static CONCMD_IF_PTR_TYPE config_shape_init(BOOL curvature, BOOL angular, BOOL reset, BOOL plain_text)
+{
+    config_shape.set_policy = curvature || angular;
+    config_shape.policy = angular ? CONTROL_SHAPE_ANGULAR : CONTROL_SHAPE_CURVATURE;
+    config_shape.reset = reset;
+    config_shape.plain_text = plain_text;
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_SHAPE];
+}
+
+static BOOL config_shape_update(void)
+{
+    if (config_shape.set_policy)
+    {
+        Control_SetShapePolicy(config_shape.policy);
+    }
+
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_shape_status(void)
+{
+    return is_running;
+}
+
+static void config_shape_results(void)
+{
+    CONTROL_SHAPE_STATS_TYPE stats;
+    CHAR *policy;
+
+    Control_GetShapeStats(&stats);
+    policy = Control_GetShapePolicy() == CONTROL_SHAPE_ANGULAR ? "angular" : "curvature";
+
+    if (config_shape.plain_text)
+    {
+        Ser_PutStringFormat("Policy: %s\r\n", policy);
+        Ser_PutStringFormat("Saturation events: %lu\r\n", stats.events);
+        Ser_PutStringFormat("Saturated updates: %lu of %lu\r\n", stats.saturated, stats.updates);
+        Ser_PutStringFormat("Peak demand: %.3f\r\n", stats.peak_demand);
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"policy\":\"%s\",\"events\":%lu,\"saturated\":%lu,\"updates\":%lu,\"peak\":%.3f}\r\n",
+                            policy, stats.events, stats.saturated, stats.updates, stats.peak_demand);
+    }
+
+    if (config_shape.reset)
+    {
+        Control_ResetShapeStats();
+    }
+}
+
+/*-------------------------------------------------------------------
+    Config Refine
+
+    Enables/disables the online refinement of the motor calibration
+    tables (see calrefine.c) and reports the refinement counters.
+*/
+
+static CONCMD_IF_PTR_TYPE config_refine_init(BOOL enable, BOOL disable, BOOL plain_text)
+{
+    config_refine.set_enable = enable || disable;
+    config_refine.enable = enable;
+    config_refine.plain_text = plain_text;
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_REFINE];
+}
+
+static BOOL config_refine_update(void)
+{
+    if (config_refine.set_enable)
+    {
+        CalRefine_Enable(config_refine.enable);
+    }
+
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_refine_status(void)
+{
+    return is_running;
+}
+
+static void config_refine_results(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    CalRefine_GetStats(&stats);
+
+    if (config_refine.plain_text)
+    {
+        Ser_PutStringFormat("Refinement: %s\r\n", CalRefine_IsEnabled() ? "enabled" : "disabled");
+        Ser_PutStringFormat("Observations: %lu\r\n", stats.num_observations);
+        Ser_PutStringFormat("Updates: %lu\r\n", stats.num_updates);
+        Ser_PutStringFormat("Persists: %lu\r\n", stats.num_persists);
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"enabled\":%d,\"observations\":%lu,\"updates\":%lu,\"persists\":%lu}\r\n",
+                            CalRefine_IsEnabled(), stats.num_observations, stats.num_updates, stats.num_persists);
+    }
+}
+
+/*-------------------------------------------------------------------
+    Config Export
+
+    Writes the calibration snapshot of the selected sections (see calsnap.c)
+    as JSON, plain text or binary, a chunk per update (see Emit_Chunk).
+*/
+
+static CONCMD_IF_PTR_TYPE config_export_init(UINT8 sections, BOOL binary, BOOL plain_text)
+{
+    config_export.sections = sections;
+    config_export.format = binary ? CALSNAP_FORMAT_BINARY : plain_text ? CALSNAP_FORMAT_TEXT : CALSNAP_FORMAT_JSON;
+    Emit_StreamInit(&config_export.stream);
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_EXPORT];
+}
+
+static void config_export_emit(void)
+{
+    CalSnap_Export(config_export.sections, config_export.format);
+}
+
+static BOOL config_export_update(void)
+{
+    is_running = Emit_Chunk(&config_export.stream, config_export_emit);
+    return is_running;
+}
+
+static BOOL config_export_status(void)
+{
+    return is_running;
+}
+
+static void config_export_stop(void)
+{
+    Emit_Cancel(&config_export.stream);
+    is_running = FALSE;
+}
+
+/*-------------------------------------------------------------------
+    Config Import
+
+    The snapshot is imported with a begin, the base64 chunks of the export,
+    one per command, and a commit.  Nothing is written until the commit
+    validates the whole snapshot.
+*/
+
+static CONCMD_IF_PTR_TYPE config_import_init(CONCONFIG_IMPORT_ACTION_TYPE action, CHAR* const data, BOOL plain_text)
+{
+    if (action == CONCONFIG_IMPORT_DATA && strlen(data) > CALSNAP_CHUNK_LENGTH)
+    {
+        Ser_PutStringFormat("Data must be at most %d characters\r\n", CALSNAP_CHUNK_LENGTH);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    config_import.action = action;
+    config_import.plain_text = plain_text;
+    config_import.sections = 0;
+    if (action == CONCONFIG_IMPORT_DATA)
+    {
+        strcpy(config_import.data, data);
+    }
+
+    is_running = TRUE;
+    return &cmd_if_array[CONFIG_IMPORT];
+}
+
+static BOOL config_import_update(void)
+{
+    switch (config_import.action)
+    {
+        case CONCONFIG_IMPORT_BEGIN:
+            config_import.result = CalSnap_ImportBegin();
+            break;
+
+        case CONCONFIG_IMPORT_DATA:
+            config_import.result = CalSnap_ImportData(config_import.data);
+            break;
+
+        case CONCONFIG_IMPORT_COMMIT:
+            config_import.result = CalSnap_ImportCommit(&config_import.sections);
+            break;
+
+        case CONCONFIG_IMPORT_ABORT:
+        default:
+            CalSnap_ImportAbort();
+            config_import.result = CALSNAP_OK;
+            break;
+    }
+
+    /* Note: A chunk which cannot be decoded leaves a gap, so the import is started over */
+    if (config_import.result != CALSNAP_OK && config_import.action == CONCONFIG_IMPORT_DATA)
+    {
+        CalSnap_ImportAbort();
+    }
+
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL config_import_status(void)
+{
+    return is_running;
+}
+
+static void config_import_results(void)
+{
+    if (config_import.plain_text)
+    {
+        Ser_PutStringFormat("Import: %s, length: %d, sections: %d\r\n",
+                            CalSnap_GetResultString(config_import.result),
+                            CalSnap_GetImportLength(),
+                            config_import.sections);
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"result\":\"%s\",\"length\":%d,\"sections\":%d}\r\n",
+                            CalSnap_GetResultString(config_import.result),
+                            CalSnap_GetImportLength(),
+                            config_import.sections);
+    }
+}
+
 void ConConfig_Init(void)
 {    
     cmd_if_array[CONFIG_DEBUG].update = config_debug_update;
@@ -211,11 +714,46 @@ void ConConfig_Init(void)
 
     cmd_if_array[CONFIG_SHOW].update = config_show_update;
     cmd_if_array[CONFIG_SHOW].status = config_show_status;
-    cmd_if_array[CONFIG_SHOW].results = config_show_results;
+    cmd_if_array[CONFIG_SHOW].stop = config_show_stop;
+
+    cmd_if_array[CONFIG_RATE].update = config_rate_update;
+    cmd_if_array[CONFIG_RATE].status = config_rate_status;
+    cmd_if_array[CONFIG_RATE].results = config_rate_results;
+
+    cmd_if_array[CONFIG_BENCH].update = config_bench_update;
+    cmd_if_array[CONFIG_BENCH].status = config_bench_status;
+    cmd_if_array[CONFIG_BENCH].results = config_bench_results;
+
+    cmd_if_array[CONFIG_ACCEL].update = config_accel_update;
+    cmd_if_array[CONFIG_ACCEL].status = config_accel_status;
+    cmd_if_array[CONFIG_ACCEL].results = config_accel_results;
+
+    cmd_if_array[CONFIG_SHAPE].update = config_shape_update;
+    cmd_if_array[CONFIG_SHAPE].status = config_shape_status;
+    cmd_if_array[CONFIG_SHAPE].results = config_shape_results;
+
+    cmd_if_array[CONFIG_REFINE].update = config_refine_update;
+    cmd_if_array[CONFIG_REFINE].status = config_refine_status;
+    cmd_if_array[CONFIG_REFINE].results = config_refine_results;
+
+    cmd_if_array[CONFIG_EXPORT].update = config_export_update;
+    cmd_if_array[CONFIG_EXPORT].status = config_export_status;
+    cmd_if_array[CONFIG_EXPORT].stop = config_export_stop;
+
+    cmd_if_array[CONFIG_IMPORT].update = config_import_update;
+    cmd_if_array[CONFIG_IMPORT].status = config_import_status;
+    cmd_if_array[CONFIG_IMPORT].results = config_import_results;
 
     memset(&config_debug, 0, sizeof config_debug);
     memset(&config_show, 0, sizeof config_show);
     memset(&config_clear, 0, sizeof config_clear);
+    memset(&config_rate, 0, sizeof config_rate);
+    memset(&config_bench, 0, sizeof config_bench);
+    memset(&config_accel, 0, sizeof config_accel);
+    memset(&config_shape, 0, sizeof config_shape);
+    memset(&config_refine, 0, sizeof config_refine);
+    memset(&config_export, 0, sizeof config_export);
+    memset(&config_import, 0, sizeof config_import);
 
     is_running = FALSE;
 }
@@ -239,4 +777,39 @@ CONCMD_IF_PTR_TYPE ConConfig_InitConfigClear(UINT16 mask, BOOL plain_text)
     return config_clear_init(mask, plain_text);
 }
 
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigRate(INT32 enc_rate, INT32 pid_rate, INT32 odom_rate, INT32 outer_rate, BOOL save, BOOL plain_text)
+{
+    return config_rate_init(enc_rate, pid_rate, odom_rate, outer_rate, save, plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigBench(BOOL plain_text)
+{
+    return config_bench_init(plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigAccel(FLOAT lin_accel, FLOAT lin_jerk, FLOAT ang_accel, FLOAT ang_jerk, BOOL plain_text)
+{
+    return config_accel_init(lin_accel, lin_jerk, ang_accel, ang_jerk, plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigShape(BOOL curvature, BOOL angular, BOOL reset, BOOL plain_text)
+{
+    return config_shape_init(curvature, angular, reset, plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigRefine(BOOL enable, BOOL disable, BOOL plain_text)
+{
+    return config_refine_init(enable, disable, plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigExport(UINT8 sections, BOOL binary, BOOL plain_text)
+{
+    return config_export_init(sections, binary, plain_text);
+}
+
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigImport(CONCONFIG_IMPORT_ACTION_TYPE action, CHAR* const data, BOOL plain_text)
+{
+    return config_import_init(action, data, plain_text);
+}
+
 /* [] END OF FILE */
\ No newline at end of file
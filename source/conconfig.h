@@ -5,11 +5,19 @@
 #include "concmd.h"
 
 typedef enum { CONCONFIG_MOTOR_BIT=0x0001, CONCONFIG_PID_BIT=0x0002, CONCONFIG_BIAS_BIT=0x0004, CONCONFIG_DEBUG_BIT=0x0008, CONCONFIG_STATUS_BIT=0x0010, CONCONFIG_PARAMS_BIT=0x0020} CONCONFIG_BITS_TYPE;
+typedef enum { CONCONFIG_IMPORT_BEGIN, CONCONFIG_IMPORT_DATA, CONCONFIG_IMPORT_COMMIT, CONCONFIG_IMPORT_ABORT } CONCONFIG_IMPORT_ACTION_TYPE;
 
 void ConConfig_Init(void);
 void ConConfig_Start(void);
 CONCMD_IF_PTR_TYPE ConConfig_InitConfigDebug(BOOL enable, UINT16 mask);
 CONCMD_IF_PTR_TYPE ConConfig_InitConfigShow(UINT16 mask, BOOL plain_text);
 CONCMD_IF_PTR_TYPE ConConfig_InitConfigClear(UINT16 mask, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigRate(INT32 enc_rate, INT32 pid_rate, INT32 odom_rate, INT32 outer_rate, BOOL save, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigBench(BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigAccel(FLOAT lin_accel, FLOAT lin_jerk, FLOAT ang_accel, FLOAT ang_jerk, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigShape(BOOL curvature, BOOL angular, BOOL reset, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigRefine(BOOL enable, BOOL disable, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigExport(UINT8 sections, BOOL binary, BOOL plain_text);
+CONCMD_IF_PTR_TYPE ConConfig_InitConfigImport(CONCONFIG_IMPORT_ACTION_TYPE action, CHAR* const data, BOOL plain_text);
 
 #endif
\ No newline at end of file
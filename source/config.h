@@ -46,6 +46,11 @@ SOFTWARE.
 #define ENABLE_I2CIF
 //#define ENABLE_CANIF
 
+/* Enable online refinement of the motor calibration tables (see calrefine.c) at startup.  Refinement can also be
+   enabled/disabled from the console (see config refine).
+*/
+//#define CAL_REFINE_ENABLED
+
 
 #endif
 
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <stdarg.h>
 #include "conmotion.h"
 #include "cal.h"
@@ -6,12 +7,15 @@
 #include "encoder.h"
 #include "serial.h"
 #include "utils.h"
+#include "angle.h"
 #include "debug.h"
 #include "time.h"
 #include "assertion.h"
+#include "traj.h"
+#include "pursuit.h"
 
 typedef enum {MOTION_FIRST = 0, MOTION_CAL_LINEAR=MOTION_FIRST, MOTION_CAL_ANGULAR, MOTION_CAL_UMBMARK, MOTION_VAL_LINEAR, MOTION_VAL_ANGULAR, MOTION_VAL_CIRCLE,
-    MOTION_VAL_SQUARE, MOTION_VAL_OUTANDBACK, MOTION_LAST} MOTION_CMD_TYPE;
+    MOTION_VAL_SQUARE, MOTION_VAL_OUTANDBACK, MOTION_PATH, MOTION_LAST} MOTION_CMD_TYPE;
 
 
 typedef struct _tag_motion_val_outandback
@@ -55,113 +59,23 @@ typedef struct _tag_motion_cal_angular
 {
     FLOAT angle;
 } MOTION_CAL_ANGULAR_TYPE;
-typedef struct _tag_motion_cal_linear
+typedef struct _tag_motion_path
 {
-    FLOAT distance;
-}MOTION_CAL_LINEAR_TYPE;
+    CONMOTION_PATH_ACTION_TYPE action;
+    BOOL as_json;
+} MOTION_PATH_TYPE;
 
-typedef struct _tag_move
+typedef struct _tag_motion_cal_linear
 {
-    FLOAT direction;
-    FLOAT speed;
-    FLOAT timeout;
-    FLOAT goal;
-    BOOL is_moving;
     FLOAT distance;
-    void (*start)(void *);
-    BOOL (*is_at_goal)(void *);
-} MOVE_TYPE;
-
-static BOOL pause_is_at_goal(void *this);
-static void pause_start(void *this);
-static BOOL angular_is_at_goal(void *this);
-static void angular_start(void *this);
-static BOOL linear_is_at_goal(void *this);
-static void linear_start(void *this);
-
-
-typedef enum { MOVE_FIRST=0, MOVE_LINEAR=MOVE_FIRST, MOVE_ANGULAR, MOVE_PAUSE, MOVE_LAST } MOVE_ENUM_TYPE;
-
-static MOVE_TYPE linear_move = {
-    DIR_FORWARD, // direction
-    0.2, // speed
-    10.0, // timeout
-    1.0, // goal
-    FALSE,
-    1.0, // distance
-    linear_start,
-    linear_is_at_goal
-};
-
-static MOVE_TYPE angular_move = {
-    DIR_CCW, // direction
-    0.3, // speed
-    10.0, // timeout
-    360, // goal
-    FALSE,
-    1.0, // distance
-    angular_start,
-    angular_is_at_goal
-};
-
-static MOVE_TYPE pause_move = {
-    DIR_NONE, // direction
-    0.0, // speed
-    1.0, // timeout
-    0.0, // goal
-    FALSE,
-    0.0, // distance
-    pause_start,
-    pause_is_at_goal
-};
-
-static UINT8 move_index = 0;
-static MOVE_TYPE * square_move[16] = {
-    /* Side 1 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move,
-
-    /* Side 2 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move,
-
-    /* Side 3 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move,
-
-    /* Side 4 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move
-};
-
-static MOVE_TYPE * oandb_move[8] = 
-{
-    /* Leg 1 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move,
-
-    /* Leg 2 */
-    &linear_move, 
-    &pause_move, 
-    &angular_move,
-    &pause_move,
-};
-
-static MOVE_TYPE *gen_move_seq[1];
-static MOVE_TYPE *p_move;
-static MOVE_TYPE **p_move_seq;
-static UINT8 max_move_seq;
+}MOTION_CAL_LINEAR_TYPE;
 
+/* Note: The validation moves are queued as trajectory segments (see traj.c) which are executed from the
+   main loop.  A pause between segments lets odometry settle.
+ */
+#define VAL_PAUSE_DURATION (0.5)    /* second */
+#define VAL_SQUARE_NUM_SIDES (4)
+#define VAL_CIRCLE_SPEED (0.2)      /* meter/sec */
 
 static BOOL is_running;
 
@@ -173,163 +87,56 @@ static MOTION_VAL_ANGULAR_TYPE motion_val_angular;
 static MOTION_VAL_SQUARE_TYPE motion_val_square;
 static MOTION_VAL_CIRCLE_TYPE motion_val_circle;
 static MOTION_VAL_OUTANDBACK_TYPE motion_val_outandback;
+static MOTION_PATH_TYPE motion_path;
 
 static CONCMD_IF_TYPE cmd_if_array[MOTION_LAST];
 
-static FLOAT cmd_linear_velocity;
-static FLOAT cmd_angular_velocity;
-static UINT32 cmd_timeout;
-
-static UINT32 start_time;
-
-static void linear_start(void *this)
-{   
-    FLOAT x_pos;
-    FLOAT y_pos;
-    FLOAT end_pos;
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    Ser_WriteLine("Starting Linear ...", TRUE);
-
-    Odom_GetXYPosition(&x_pos, &y_pos);
-    linear->goal = sqrt(x_pos*x_pos + y_pos*y_pos) + linear->distance;
-    
-    cmd_linear_velocity = linear->direction == DIR_FORWARD ? linear->speed : -linear->speed;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = linear->timeout;
-    linear->is_moving = TRUE;
-}
-
-static BOOL linear_is_at_goal(void *this)
+static void StartTrajectory(void)
 {
-    FLOAT x_pos;
-    FLOAT y_pos;
-    FLOAT curr_pos;
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    Odom_GetXYPosition(&x_pos, &y_pos);
-    curr_pos = sqrt(x_pos*x_pos + y_pos*y_pos);
-    if (lessthan_float(curr_pos, linear->goal, 0.0001))
-    {
-        return FALSE;
-    }
-
-    Ser_WriteLine("Linear Complete", TRUE);
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 5000;
-    linear->is_moving = FALSE;
-
-    return TRUE;
-}
-
-static void angular_start(void *this)
-{
-    FLOAT heading;
-    FLOAT end_heading;
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    Ser_WriteLine("Starting Rotate ...", TRUE);
-
-    heading = Odom_GetHeading();
-    linear->goal = NormalizeHeading(heading + DEGREES_TO_RADIANS(linear->distance));
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = linear->direction == DIR_CW ? -linear->speed : linear->speed;
-    cmd_timeout = 0;
-    linear->is_moving = TRUE;
-    start_time = millis();
-}
-
-static BOOL angular_is_at_goal(void *this)
-{
-    UINT32 delta;
-    FLOAT heading;
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    /* Note: Wait a small amount of time before evaulating the heading */
-    delta = millis() - start_time;
-    if (delta < 500)
-    {
-        return VAL_OK;
-    }
+    Odom_Reset();
+    Control_OverrideDebug(TRUE);
 
-    heading = Odom_GetHeading();
-    if (!equal_float(heading, linear->goal, 0.01))
+    is_running = Traj_Execute();
+    if (!is_running)
     {
-        return FALSE;
+        Ser_WriteLine("Trajectory not started", TRUE);
     }
-
-    Ser_WriteLine("Rotote Complete", TRUE);
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    linear->is_moving = FALSE;
-    return TRUE;
 }
 
-static void pause_start(void *this)
+static BOOL UpdateTrajectory(void)
 {
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    linear = linear;
-
-    Ser_WriteLine("Starting Pause ...", TRUE);
-
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 0;
-    linear->is_moving = TRUE;
-    start_time = millis();
+    is_running = Traj_IsRunning();
+    return is_running;
 }
 
-static BOOL pause_is_at_goal(void *this)
+static void TrajectoryResults(void)
 {
-    UINT32 delta;
-    MOVE_TYPE *linear = (MOVE_TYPE *)this;
-
-    /* Note: Wait a small amount of time before evaulating the heading */
-    delta = millis() - start_time;
-    if (delta < linear->timeout)
-    {
-        return FALSE;
-    }
+    TRAJ_STATUS_TYPE status;
+    FLOAT x_pos;
+    FLOAT y_pos;
 
-    Ser_WriteLine("Pause Complete", TRUE);
-    linear->is_moving = TRUE;
-    return TRUE;
-}
+    Traj_GetStatus(&status);
+    Odom_GetXYPosition(&x_pos, &y_pos);
 
-static UINT8 ExecuteMove()
-{
-    if (!p_move->is_moving)
-    {
-        p_move->start(p_move);
-        return VAL_OK;
-    }
-    else
-    {
-        if (p_move->is_at_goal(p_move))
-        {
-            return VAL_COMPLETE;
-        }
-        return VAL_OK;
-    }
+    Ser_PutStringFormat("%s: segment %d of %d, position %.3f, %.3f, heading %.3f\r\n",
+        status.state == TRAJ_STATE_DONE ? "Motion Complete" : "Motion Failed",
+        status.segment + 1,
+        status.num_segments,
+        x_pos,
+        y_pos,
+        Odom_GetHeading());
 
-    return VAL_COMPLETE;
+    Traj_Stop();
+    Control_OverrideDebug(FALSE);
 }
 
-static UINT8 SetNextMove()
+/* Note: Shared by all of the motion commands.  It is only called when a command is killed. */
+static void motion_stop(void)
 {
-    move_index++;
-    p_move = p_move_seq[move_index];
-    
-    return move_index == max_move_seq ? VAL_COMPLETE : VAL_OK;
-}
+    Traj_Stop();
+    Control_OverrideDebug(FALSE);
 
-static void SetCommandVelocity(FLOAT *linear, FLOAT *angular, UINT32 *timeout)
-{
-    *linear = cmd_linear_velocity;
-    *angular = cmd_angular_velocity;
-    *timeout = cmd_timeout;
+    is_running = FALSE;
 }
 
 /*------------------------------------------------------------------------------------------
@@ -424,41 +231,16 @@ static CONCMD_IF_PTR_TYPE motion_val_linear_init(FLOAT distance)
     Ser_PutStringFormat("Motion Val Linear Init: %.3f\r\n",
         motion_val_linear.distance);
     
-    Odom_Reset();
-        
-    linear_move.direction = distance > 0 ? DIR_FORWARD : DIR_BACKWARD;
-    linear_move.distance = distance;
-    linear_move.speed = 0.3;
-    linear_move.timeout = 10;
-
-    move_index = 0;
-    max_move_seq = 1;
-    gen_move_seq[move_index] = &linear_move;
-    p_move_seq = &gen_move_seq[move_index];
-    p_move = p_move_seq[move_index];
-
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 0;
-    Control_SetCommandVelocityFunc(SetCommandVelocity);
-
-    is_running = TRUE;
+    Traj_Clear();
+    Traj_AddLine(distance, 0.3);
+    StartTrajectory();
 
     return &cmd_if_array[MOTION_VAL_LINEAR];
 }
 
 static BOOL motion_val_linear_update(void)
 {
-    UINT8 result;
-
-    result = ExecuteMove();
-    if (result == VAL_COMPLETE)
-    {
-        result = SetNextMove();
-    }
-
-    is_running = result == VAL_OK;
-    return is_running;
+    return UpdateTrajectory();
 }
 
 static BOOL motion_val_linear_status(void)
@@ -468,12 +250,7 @@ static BOOL motion_val_linear_status(void)
 
 static void motion_val_linear_results(void)
 {
-//    Ser_PutStringFormat("Start Position: %.3f, %.3f\r\n", motion_val_linear.start_x_pos, motion_val_linear.start_y_pos);
-//    Ser_PutStringFormat("Est End Position: %.3f, %.3f\r\n", motion_val_linear.end_x_pos, motion_val_linear.end_y_pos);
-//    Ser_PutStringFormat("Actual End Position: %.3f, %.3f\r\n", motion_val_linear.actual_x_pos, motion_val_linear.actual_y_pos);
-//    FLOAT x_error = motion_val_linear.end_x_pos-motion_val_linear.actual_x_pos;
-//    FLOAT y_error = motion_val_linear.end_y_pos-motion_val_linear.actual_y_pos;
-//    Ser_PutStringFormat("Error/%%Error: x pos %.3f/%.3f, y pos %.3f/%.3f\r\n", x_error, x_error/motion_val_linear.end_x_pos, y_error, y_error/motion_val_linear.end_y_pos);
+    TrajectoryResults();
 }
 
 /*------------------------------------------------------------------------------------------
@@ -481,49 +258,21 @@ static void motion_val_linear_results(void)
 */
 static CONCMD_IF_PTR_TYPE motion_val_angular_init(FLOAT angle)
 {
-    Ser_PutStringFormat("Motion Val Linear Init: %.3f\r\n",
-        motion_val_angular.angle);
-    
     motion_val_angular.angle = angle;
 
-    Odom_Reset();
-    angular_move.direction = angle > 0 ? DIR_CCW : DIR_CW;
-    angular_move.distance = angle;
-    angular_move.speed = 0.5;
-    angular_move.timeout = 10;
-    
-    move_index = 0;
-    max_move_seq = 1;
-    gen_move_seq[move_index] = &angular_move;
-    p_move_seq = &gen_move_seq[move_index];
-    p_move = p_move_seq[move_index];
-    
-    Control_OverrideDebug(TRUE);
-    
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 0;
-    Control_SetCommandVelocityFunc(SetCommandVelocity);    
-    
-    is_running = TRUE;
+    Ser_PutStringFormat("Motion Val Angular Init: %.3f\r\n",
+        motion_val_angular.angle);
     
-    start_time = millis();
+    Traj_Clear();
+    Traj_AddTurn(DEGREES_TO_RADIANS(angle), 0.5);
+    StartTrajectory();
 
     return &cmd_if_array[MOTION_VAL_ANGULAR];
 }
 
 static BOOL motion_val_angular_update(void)
 {
-    UINT8 result;
-
-    result = ExecuteMove();
-    if (result == VAL_COMPLETE)
-    {
-        result = SetNextMove();
-    }
-
-    is_running = result == VAL_OK;
-    return is_running;    
+    return UpdateTrajectory();
 }
 
 static BOOL motion_val_angular_status(void)
@@ -533,11 +282,7 @@ static BOOL motion_val_angular_status(void)
 
 static void motion_val_angular_results(void)
 {
-//    Ser_PutStringFormat("Start Heading: %f\r\n", motion_val_angular.start_heading);
-//    Ser_PutStringFormat("Est End Heading: %f\r\n", motion_val_angular.end_heading);
-//    Ser_PutStringFormat("Actual End Heading: %f\r\n", motion_val_angular.actual_heading);
-//    FLOAT heading_error = motion_val_angular.end_heading-motion_val_angular.actual_heading;
-//    Ser_PutStringFormat("Error %f/%f\r\n", heading_error, heading_error/motion_val_angular.end_heading);
+    TrajectoryResults();
 }
 
 /*------------------------------------------------------------------------------------------
@@ -545,46 +290,27 @@ static void motion_val_angular_results(void)
 */
 static CONCMD_IF_PTR_TYPE  motion_val_square_init(BOOL left, FLOAT side)
 {
+    UINT8 ii;
+
     motion_val_square.left = left;
     motion_val_square.side = side;
 
-    Odom_Reset();
-
-    linear_move.distance = side;
-    angular_move.direction = left ? DIR_CCW : DIR_CW;
-    
-    /* Initialize the move array to have square moves or create a static array and point to it. */
-    #define MAX_SQUARE_MOVE (16)
-    move_index = 0;
-    max_move_seq = MAX_SQUARE_MOVE;
-    p_move_seq = &square_move[move_index];
-    p_move = p_move_seq[move_index];
-
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 0;
-    Control_SetCommandVelocityFunc(SetCommandVelocity);
-    
-    Control_OverrideDebug(TRUE);
-    //Debug_Enable(DEBUG_ODOM_ENABLE_BIT|DEBUG_LEFT_ENCODER_ENABLE_BIT|DEBUG_RIGHT_ENCODER_ENABLE_BIT);
+    Traj_Clear();
+    for (ii = 0; ii < VAL_SQUARE_NUM_SIDES; ++ii)
+    {
+        Traj_AddLine(side, 0.2);
+        Traj_AddPause(VAL_PAUSE_DURATION);
+        Traj_AddTurn(left ? PI / 2 : -PI / 2, 0.3);
+        Traj_AddPause(VAL_PAUSE_DURATION);
+    }
+    StartTrajectory();
     
-    is_running = TRUE;
-
     return &cmd_if_array[MOTION_VAL_SQUARE];
 }
 
 static BOOL motion_val_square_update(void)
 {
-    UINT8 result;
-
-    result = ExecuteMove();
-    if (result == VAL_COMPLETE)
-    {
-        result = SetNextMove();
-    }
-
-    is_running = result == VAL_OK;
-    return is_running;
+    return UpdateTrajectory();
 }
 
 static BOOL motion_val_square_status(void)
@@ -594,8 +320,7 @@ static BOOL motion_val_square_status(void)
 
 static void motion_val_square_results(void)
 {
-    Control_OverrideDebug(FALSE);
-    Control_RestoreCommandVelocityFunc();
+    TrajectoryResults();
 }
 
 /*------------------------------------------------------------------------------------------
@@ -606,34 +331,24 @@ static CONCMD_IF_PTR_TYPE motion_val_circle_init(BOOL cw, FLOAT radius)
     motion_val_circle.cw = cw;
     motion_val_circle.radius = radius;
     
-    /*
-        so, to drive in a circle of a certain radius what is needed?
-            specify a robot angular velocity
-            specify a radius rotation
-    
-        Use middle value of Robot Velocity to calculate Robot W
-        Set Robot V/W into Control velocity
-
-        Vavg = MAX_WHEEL_METER_PER_SECOND / 2.0;
-        Wavg = Vavg/R
-
-        UniToDiff(Vavg, Wavg, Vl, Vr)
-        
-    
-    
-    */
-
-
-    
-    is_running = TRUE;
+    /* A zero radius circle is a full turn in place */
+    Traj_Clear();
+    if (radius == 0.0)
+    {
+        Traj_AddTurn(cw ? -2 * PI : 2 * PI, 0.5);
+    }
+    else
+    {
+        Traj_AddArc(2 * PI * radius, cw ? -radius : radius, VAL_CIRCLE_SPEED);
+    }
+    StartTrajectory();
 
     return &cmd_if_array[MOTION_VAL_CIRCLE];
 }
 
 static BOOL motion_val_circle_update(void)
 {
-    is_running = FALSE;
-    return is_running;
+    return UpdateTrajectory();
 }
 
 static BOOL motion_val_circle_status(void)
@@ -643,63 +358,219 @@ static BOOL motion_val_circle_status(void)
 
 static void motion_val_circle_results(void)
 {
-
+    TrajectoryResults();
 }
 
 /*------------------------------------------------------------------------------------------
-    Motion Validation Circle
+    Motion Validation Out and Back
 */
 static CONCMD_IF_PTR_TYPE  motion_val_outandback_init(FLOAT distance)
 {
+    UINT8 ii;
+
     motion_val_outandback.distance = distance;
 
-    linear_move.direction = distance > 0 ? DIR_FORWARD : DIR_BACKWARD;
-    linear_move.distance = distance;
-    linear_move.speed = 0.2;
-    angular_move.direction = DIR_CW;
-    angular_move.distance = 180;
-    angular_move.speed = 0.5;
-    /* Initialize the move array to have square moves or create a static array and point to it. */
-    move_index = 0;
-    max_move_seq = 8;
-    p_move_seq = &oandb_move[move_index];
-    p_move = p_move_seq[move_index];
-
-    cmd_linear_velocity = 0.0;
-    cmd_angular_velocity = 0.0;
-    cmd_timeout = 0;
-    Control_SetCommandVelocityFunc(SetCommandVelocity);
-    
-    Control_OverrideDebug(TRUE);
-    //Debug_Enable(DEBUG_ODOM_ENABLE_BIT|DEBUG_LEFT_ENCODER_ENABLE_BIT|DEBUG_RIGHT_ENCODER_ENABLE_BIT);
+    Traj_Clear();
+    for (ii = 0; ii < 2; ++ii)
+    {
+        Traj_AddLine(distance, 0.2);
+        Traj_AddPause(VAL_PAUSE_DURATION);
+        Traj_AddTurn(-PI, 0.5);
+        Traj_AddPause(VAL_PAUSE_DURATION);
+    }
+    StartTrajectory();
     
-    is_running = TRUE;
-
     return &cmd_if_array[MOTION_VAL_OUTANDBACK];
 }
 
 static BOOL motion_val_outandback_update(void)
 {
-    UINT8 result;
+    return UpdateTrajectory();
+}
+
+static BOOL motion_val_outandback_status(void)
+{
+    return is_running;
+}
+
+static void motion_val_outandback_results(void)
+{
+    TrajectoryResults();
+}
+
+/*------------------------------------------------------------------------------------------
+    Motion Path
+
+    Points are appended to the pursuit path (see pursuit.c) and the path is followed from the
+    main loop.  Path start runs as a job, which claims the motors, until the path ends or the
+    job is killed; the other path commands complete immediately.
+*/
+static BOOL parse_point(CHAR** const p_text, FLOAT* const x, FLOAT* const y)
+{
+    CHAR *p_end;
+
+    *x = strtod(*p_text, &p_end);
+    if (p_end == *p_text || *p_end != ',')
+    {
+        return FALSE;
+    }
+
+    *p_text = p_end + 1;
+    *y = strtod(*p_text, &p_end);
+    if (p_end == *p_text || (*p_end != ',' && *p_end != '\0'))
+    {
+        return FALSE;
+    }
+
+    *p_text = *p_end == ',' ? p_end + 1 : p_end;
+    return TRUE;
+}
+
+static BOOL parse_points(CHAR* const text)
+{
+    PURSUIT_STATUS_TYPE status;
+    CHAR *p_curr;
+    FLOAT x;
+    FLOAT y;
+    UINT8 count;
+
+    if (text == NULL || *text == '\0')
+    {
+        return FALSE;
+    }
+
+    /* Note: points are formatted as x1,y1,x2,y2,...  The whole list is checked before any point is
+       added so that a malformed list leaves the path unchanged.
+     */
+    Pursuit_GetStatus(&status);
+    count = 0;
+    p_curr = text;
+    while (*p_curr != '\0')
+    {
+        if (!parse_point(&p_curr, &x, &y))
+        {
+            return FALSE;
+        }
+        count++;
+    }
+
+    if (status.num_points + count > PURSUIT_MAX_POINTS)
+    {
+        return FALSE;
+    }
+
+    p_curr = text;
+    while (*p_curr != '\0')
+    {
+        parse_point(&p_curr, &x, &y);
+        Pursuit_AddPoint(x, y);
+    }
+
+    return TRUE;
+}
+
+static CHAR * const path_state_names[] = {"idle", "running", "done", "failed"};
+
+static CONCMD_IF_PTR_TYPE motion_path_init(CONMOTION_PATH_ACTION_TYPE action, CHAR* const points, FLOAT speed, FLOAT lookahead, BOOL plain_text)
+{
+    motion_path.action = action;
+    motion_path.as_json = !plain_text;
 
-    result = ExecuteMove();
-    if (result == VAL_COMPLETE)
+    switch (action)
     {
-        result = SetNextMove();
+        case CONMOTION_PATH_ADD:
+            if (Pursuit_IsRunning() || !parse_points(points))
+            {
+                Ser_PutStringFormat("Points must be formatted as x1,y1,x2,y2,... (at most %d, not while running)\r\n", PURSUIT_MAX_POINTS);
+                return (CONCMD_IF_TYPE *) NULL;
+            }
+            break;
+
+        case CONMOTION_PATH_START:
+            /* Note: speed and lookahead are NaN when not given which selects the defaults */
+            if (!Pursuit_Execute(speed, lookahead))
+            {
+                Ser_WriteLine("Path not started", TRUE);
+                return (CONCMD_IF_TYPE *) NULL;
+            }
+            break;
+
+        case CONMOTION_PATH_STOP:
+            Pursuit_Stop();
+            break;
+
+        case CONMOTION_PATH_CLEAR:
+            Pursuit_Stop();
+            Pursuit_Clear();
+            break;
+
+        case CONMOTION_PATH_SHOW:
+        default:
+            break;
     }
 
-    is_running = result == VAL_OK;
+    is_running = TRUE;
+    return &cmd_if_array[MOTION_PATH];
+}
+
+static BOOL motion_path_update(void)
+{
+    is_running = motion_path.action == CONMOTION_PATH_START ? Pursuit_IsRunning() : FALSE;
     return is_running;
 }
 
-static BOOL motion_val_outandback_status(void)
+static BOOL motion_path_status(void)
 {
     return is_running;
 }
 
-static void motion_val_outandback_results(void)
+static void motion_path_stop(void)
 {
+    if (motion_path.action == CONMOTION_PATH_START)
+    {
+        Pursuit_Stop();
+    }
+    is_running = FALSE;
+}
+
+static void motion_path_results(void)
+{
+    PURSUIT_STATUS_TYPE status;
+    FLOAT x;
+    FLOAT y;
+    UINT8 ii;
+
+    Pursuit_GetStatus(&status);
 
+    if (motion_path.as_json)
+    {
+        Ser_PutStringFormat("{\"state\":\"%s\",\"num_points\":%d,\"segment\":%d,\"progress\":%.3f,\"cross_track\":%.3f",
+            path_state_names[status.state], status.num_points, status.segment, status.progress, status.cross_track);
+        if (motion_path.action == CONMOTION_PATH_SHOW)
+        {
+            Ser_PutString(",\"points\":[");
+            for (ii = 0; ii < status.num_points; ++ii)
+            {
+                Pursuit_GetPoint(ii, &x, &y);
+                Ser_PutStringFormat("%s[%.3f,%.3f]", ii ? "," : "", x, y);
+            }
+            Ser_PutString("]");
+        }
+        Ser_PutString("}\r\n");
+    }
+    else
+    {
+        Ser_PutStringFormat("Path: %s, points: %d, segment: %d, progress: %.3f, cross-track: %.3f\r\n",
+            path_state_names[status.state], status.num_points, status.segment, status.progress, status.cross_track);
+        if (motion_path.action == CONMOTION_PATH_SHOW)
+        {
+            for (ii = 0; ii < status.num_points; ++ii)
+            {
+                Pursuit_GetPoint(ii, &x, &y);
+                Ser_PutStringFormat("%2d: %.3f, %.3f\r\n", ii, x, y);
+            }
+        }
+    }
 }
 
 /*------------------------------------------------------------------------------------------
@@ -710,28 +581,41 @@ void ConMotion_Init(void)
     cmd_if_array[MOTION_CAL_LINEAR].update = motion_cal_linear_update;
     cmd_if_array[MOTION_CAL_LINEAR].status = motion_cal_linear_status;
     cmd_if_array[MOTION_CAL_LINEAR].results = motion_cal_linear_results;    
+    cmd_if_array[MOTION_CAL_LINEAR].stop = motion_stop;
     cmd_if_array[MOTION_CAL_ANGULAR].update = motion_cal_angular_update;
     cmd_if_array[MOTION_CAL_ANGULAR].status = motion_cal_angular_status;
     cmd_if_array[MOTION_CAL_ANGULAR].results = motion_cal_angular_results;
+    cmd_if_array[MOTION_CAL_ANGULAR].stop = motion_stop;
     cmd_if_array[MOTION_CAL_UMBMARK].update = motion_cal_umbmark_update;
     cmd_if_array[MOTION_CAL_UMBMARK].status = motion_cal_umbmark_status;
     cmd_if_array[MOTION_CAL_UMBMARK].results = motion_cal_umbmark_results;
+    cmd_if_array[MOTION_CAL_UMBMARK].stop = motion_stop;
 
     cmd_if_array[MOTION_VAL_LINEAR].update = motion_val_linear_update;
     cmd_if_array[MOTION_VAL_LINEAR].status = motion_val_linear_status;
     cmd_if_array[MOTION_VAL_LINEAR].results = motion_val_linear_results;
+    cmd_if_array[MOTION_VAL_LINEAR].stop = motion_stop;
     cmd_if_array[MOTION_VAL_ANGULAR].update = motion_val_angular_update;
     cmd_if_array[MOTION_VAL_ANGULAR].status = motion_val_angular_status;
     cmd_if_array[MOTION_VAL_ANGULAR].results = motion_val_angular_results;
+    cmd_if_array[MOTION_VAL_ANGULAR].stop = motion_stop;
     cmd_if_array[MOTION_VAL_CIRCLE].update = motion_val_circle_update;
     cmd_if_array[MOTION_VAL_CIRCLE].status = motion_val_circle_status;
     cmd_if_array[MOTION_VAL_CIRCLE].results = motion_val_circle_results;
+    cmd_if_array[MOTION_VAL_CIRCLE].stop = motion_stop;
     cmd_if_array[MOTION_VAL_SQUARE].update = motion_val_square_update;
     cmd_if_array[MOTION_VAL_SQUARE].status = motion_val_square_status;
     cmd_if_array[MOTION_VAL_SQUARE].results = motion_val_square_results;
+    cmd_if_array[MOTION_VAL_SQUARE].stop = motion_stop;
     cmd_if_array[MOTION_VAL_OUTANDBACK].update = motion_val_outandback_update;
     cmd_if_array[MOTION_VAL_OUTANDBACK].status = motion_val_outandback_status;
     cmd_if_array[MOTION_VAL_OUTANDBACK].results = motion_val_outandback_results;
+    cmd_if_array[MOTION_VAL_OUTANDBACK].stop = motion_stop;
+
+    cmd_if_array[MOTION_PATH].update = motion_path_update;
+    cmd_if_array[MOTION_PATH].status = motion_path_status;
+    cmd_if_array[MOTION_PATH].results = motion_path_results;
+    cmd_if_array[MOTION_PATH].stop = motion_path_stop;
 
     is_running = FALSE;
 }
@@ -776,6 +660,11 @@ CONCMD_IF_PTR_TYPE ConMotion_InitMotionValOutAndBack(FLOAT distance)
     return motion_val_outandback_init(distance);
 }
 
+CONCMD_IF_PTR_TYPE ConMotion_InitMotionPath(CONMOTION_PATH_ACTION_TYPE action, CHAR* const points, FLOAT speed, FLOAT lookahead, BOOL plain_text)
+{
+    return motion_path_init(action, points, speed, lookahead, plain_text);
+}
+
 void ConMotion_Start(void)
 {
 
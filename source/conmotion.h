@@ -4,6 +4,8 @@
 #include "freesoc.h"
 #include "concmd.h"
 
+typedef enum {CONMOTION_PATH_ADD, CONMOTION_PATH_START, CONMOTION_PATH_STOP, CONMOTION_PATH_CLEAR, CONMOTION_PATH_SHOW} CONMOTION_PATH_ACTION_TYPE;
+
 
 void ConMotion_Init(void);
 void ConMotion_Start(void);
@@ -18,5 +20,7 @@ CONCMD_IF_PTR_TYPE ConMotion_InitMotionValSquare(BOOL left, FLOAT side);
 CONCMD_IF_PTR_TYPE ConMotion_InitMotionValCircle(BOOL cw, FLOAT radius);
 CONCMD_IF_PTR_TYPE ConMotion_InitMotionValOutAndBack(FLOAT distance);
 
+CONCMD_IF_PTR_TYPE ConMotion_InitMotionPath(CONMOTION_PATH_ACTION_TYPE action, CHAR* const points, FLOAT speed, FLOAT lookahead, BOOL plain_text);
+
 
 #endif
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "calmotor.h"
 #include "valmotor.h"
 #include "debug.h"
+#include "emit.h"
 
 #define MIN_DURATION (0.1)
 #define MAX_DURATION (60)
@@ -58,6 +59,7 @@ typedef struct _tag_motor_cal
 {
     WHEEL_TYPE wheel;
     UINT8 iters;
+    BOOL parallel;
 } MOTOR_CAL_TYPE;
 
 typedef struct _tag_motor_val
@@ -73,6 +75,7 @@ typedef struct _tag_motor_show
 {
     WHEEL_TYPE wheel;
     BOOL plain_text;
+    EMIT_STREAM_TYPE stream;
 } MOTOR_SHOW_TYPE;
 
 
@@ -132,6 +135,23 @@ static void SetWheelSpeed(WHEEL_TYPE wheel, FLOAT value)
 }
 
 
+/* Note: Shared by all of the commands that drive the motors.  It is only called when a command is killed
+   and returns the motors and control to the state they have when no command is running.
+*/
+static void motor_stop(void)
+{
+    SetLeftRightSpeed(0.0, 0.0);
+    Control_SetLeftRightVelocityCps(0, 0);
+    Control_SetLeftRightVelocityOverride(FALSE);
+    Control_EnableAcceleration(TRUE);
+    Control_RestoreCommandVelocityFunc();
+    Pid_BypassAll(FALSE);
+    Control_OverrideDebug(FALSE);
+    CalMotor_Release();
+
+    is_running = FALSE;
+}
+
 /*----------------------------------------------------------------------------
     Motor Repeat Routines
 */
@@ -224,7 +244,7 @@ static void motor_repeat_results(void)
 /*----------------------------------------------------------------------------
     Motor Calibration Routines
 */
-static CONCMD_IF_PTR_TYPE motor_cal_init(WHEEL_TYPE wheel, INT8 iters)
+static CONCMD_IF_PTR_TYPE motor_cal_init(WHEEL_TYPE wheel, INT8 iters, BOOL parallel)
 {
     Ser_WriteLine("Starting Motor Calibration", TRUE);
     
@@ -232,9 +252,17 @@ static CONCMD_IF_PTR_TYPE motor_cal_init(WHEEL_TYPE wheel, INT8 iters)
     {
         return FALSE;
     }
+
+    /* Note: The calibration buffers are allocated first so that nothing is changed if they are not available */
+    if (!CalMotor_Init(wheel, iters, parallel))
+    {
+        Ser_WriteLine("Calibration buffers not available", TRUE);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
     
     motor_cal.wheel = wheel;
     motor_cal.iters = iters;
+    motor_cal.parallel = parallel;
 
     Ser_WriteLine("Initialize motor calibration", TRUE);
     Debug_Store();
@@ -243,8 +271,6 @@ static CONCMD_IF_PTR_TYPE motor_cal_init(WHEEL_TYPE wheel, INT8 iters)
     Pid_Enable(FALSE, FALSE, FALSE);
     Ser_WriteLine("Performing motor calibration", TRUE);
 
-    CalMotor_Init(motor_cal.wheel, motor_cal.iters);
-
     is_running = TRUE;
     return &cmd_if_array[MOTOR_CAL];
 }
@@ -264,6 +290,7 @@ static BOOL motor_cal_status(void)
 
 static void motor_cal_results(void)
 {
+    CalMotor_Release();
     Ser_WriteLine("Motor calibration complete", TRUE);
     Cal_SetCalibrationStatusBit(CAL_MOTOR_BIT);
     Debug_Restore();
@@ -408,11 +435,14 @@ static void motor_move_results(void)
 
 /*----------------------------------------------------------------------------
     Motor Show Routines
+
+    The output is sent a chunk per update (see Emit_Chunk).
 */
 static CONCMD_IF_PTR_TYPE motor_show_init(WHEEL_TYPE wheel, BOOL plain_text)
 {
     motor_show.wheel = wheel;
     motor_show.plain_text = plain_text;
+    Emit_StreamInit(&motor_show.stream);
     
     is_running = TRUE;
     Ser_WriteLine("Motor Show Init", TRUE);
@@ -420,18 +450,23 @@ static CONCMD_IF_PTR_TYPE motor_show_init(WHEEL_TYPE wheel, BOOL plain_text)
     return &cmd_if_array[MOTOR_SHOW];
 }
 
+static void motor_show_emit(void)
+{
+    Cal_PrintMotorParams(motor_show.wheel, !motor_show.plain_text);
+}
 static BOOL motor_show_update(void)
 {
-    is_running = FALSE;
+    is_running = Emit_Chunk(&motor_show.stream, motor_show_emit);
     return is_running;
 }
 static BOOL motor_show_status(void)
 {
     return is_running;
 }
-static void motor_show_results(void)
+static void motor_show_stop(void)
 {
-    Cal_PrintMotorParams(motor_show.wheel, !motor_show.plain_text);
+    Emit_Cancel(&motor_show.stream);
+    is_running = FALSE;
 }
 
 /*----------------------------------------------------------------------------
@@ -443,18 +478,22 @@ void ConMotor_Init(void)
     cmd_if_array[MOTOR_REPEAT].update = motor_repeat_update;
     cmd_if_array[MOTOR_REPEAT].status = motor_repeat_status;
     cmd_if_array[MOTOR_REPEAT].results = motor_repeat_results;
+    cmd_if_array[MOTOR_REPEAT].stop = motor_stop;
     cmd_if_array[MOTOR_CAL].update = motor_cal_update;
     cmd_if_array[MOTOR_CAL].status = motor_cal_status;
     cmd_if_array[MOTOR_CAL].results = motor_cal_results;
+    cmd_if_array[MOTOR_CAL].stop = motor_stop;
     cmd_if_array[MOTOR_VAL].update = motor_val_update;
     cmd_if_array[MOTOR_VAL].status = motor_val_status;
     cmd_if_array[MOTOR_VAL].results = motor_val_results;
+    cmd_if_array[MOTOR_VAL].stop = motor_stop;
     cmd_if_array[MOTOR_MOVE].update = motor_move_update;
     cmd_if_array[MOTOR_MOVE].status = motor_move_status;
     cmd_if_array[MOTOR_MOVE].results = motor_move_results;
+    cmd_if_array[MOTOR_MOVE].stop = motor_stop;
     cmd_if_array[MOTOR_SHOW].update = motor_show_update;
     cmd_if_array[MOTOR_SHOW].status = motor_show_status;
-    cmd_if_array[MOTOR_SHOW].results = motor_show_results;
+    cmd_if_array[MOTOR_SHOW].stop = motor_show_stop;
 
     memset(&motor_repeat, 0, sizeof motor_repeat);
     memset(&motor_move, 0, sizeof motor_move);
@@ -488,9 +527,10 @@ CONCMD_IF_PTR_TYPE ConMotor_InitMotorRepeat(
 
 CONCMD_IF_PTR_TYPE ConMotor_InitMotorCal(
             WHEEL_TYPE wheel,
-            INT8 iters)
+            INT8 iters,
+            BOOL parallel)
 {
-    return motor_cal_init(wheel, iters);
+    return motor_cal_init(wheel, iters, parallel);
 }
             
 CONCMD_IF_PTR_TYPE ConMotor_InitMotorVal(
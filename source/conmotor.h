@@ -18,7 +18,8 @@ CONCMD_IF_PTR_TYPE ConMotor_InitMotorRepeat(
             BOOL no_accel);
 CONCMD_IF_PTR_TYPE ConMotor_InitMotorCal(
             WHEEL_TYPE wheel,
-            INT8 iters);
+            INT8 iters,
+            BOOL parallel);
 CONCMD_IF_PTR_TYPE ConMotor_InitMotorVal(
             WHEEL_TYPE wheel,
             DIR_TYPE direction,
@@ -1,704 +1,777 @@
-#ifdef __cplusplus
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-#include "conparser.h"
-#else
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdbool.h>
+/* Generated by conparser.py from conparser.docopt.  Do not edit. */
+#include <stddef.h>
 #include <string.h>
 #include "conparser.h"
-#endif
-
-
-const char help_message[] =
-"Arlobot Console\r\n"
-"\r\n"
-"Usage:\r\n"
-"    motor --left-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor --right-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor (--left-speed=<speed> --right-speed=<speed>) [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep left --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep right --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters> [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor show [--plain-text]\r\n"
-"    motor cal [left|right] [--iters=<iters>] [--with-debug]\r\n"
-"    motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    motor help\r\n"
-"    pid cal left ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid cal right ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid val (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val left (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val right (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid show [left|right] [--plain-text]\r\n"
-"    pid help\r\n"
-"    config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|all] | --mask=<mask>)\r\n"
-"    config show [motor|pid|bias|debug|status|params] [--plain-text]\r\n"
-"    config clear (motor|pid|bias|debug|all)\r\n"
-"    config help\r\n"
-"    motion cal linear [--speed] [--distance=<distance>]\r\n"
-"    motion cal angular [--speed] [--angle=<angle>]\r\n"
-"    motion cal umbmark\r\n"
-"    motion val linear [--linear-speed=<speed>] [--distance=<distance>]\r\n"
-"    motion val angular [--angular-speed=<speed>] [--angle=<angle>]\r\n"
-"    motion val square (left|right) [--side=<side>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion val circle (cw|ccw) [--radius=<radius>] [--angular-speed=<speed>]\r\n"
-"    motion val out-and-back [--distance=<distance>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion help\r\n"
-"    help\r\n"
-"    \r\n"
-"\r\n"
-"Options:\r\n"
-"    -l --left-speed=<speed>     Speed of the left motor (meter/second)\r\n"
-"    -r --right-speed=<speed>    Speed of the right motor (meter/second)\r\n"
-"    -d --duration=<duration>    Duration in seconds [default: 5]\r\n"
-"    -m --mask=<mask>            Bitmap of debug flags\r\n"
-"    -p --plain-text             Display output as plain text (default is JSON)\r\n"
-"    -w --with-debug             Enable PID debug output\r\n"
-"    -i --impulse                Enable impulse response\r\n"
-"    -s --distance=<distance>    Amount of travel (meter) [default: 1.0]\r\n"
-"    -g --angle=<angle>          Amount of travel (degree)   [default: 360] \r\n"
-"    -t --iters=<iters>          Number of iterations per wheel [default: 3]\r\n"
-"    -e --step=<step>            Percentage of maximum speed to use for step response [default: 0.8]\r\n"
-"    -a --radius=<radius>        Radius of the circle [default: 0.0]\r\n"
-"    -h --side=<side>            Side of the square [default: 1.0]\r\n"
-"    -n --min-percent=<percent>  Minimum value for profile range specified in percent of maximum speed [default: 0.2]\r\n"
-"    -x --max-percent=<percent>  Maximum value for profile range specified in percent of maximum speed [default: 0.8]\r\n"
-"    -f --first=<speed>          First speed of the cycle\r\n"
-"    -o --second=<speed>         Second speed of the cycle\r\n"
-"    -v --intvl=<interval>       Time between speed change [default: 10]\r\n"
-"    -u --num-points=<points>    Number of velocity values [default: 7]\r\n"
-"    -q --no-pid                 Disables PID control\r\n"
-"    -j --no-accel               Disables acceleration profile\r\n"
-"    -z --no-control             Bypasses the Control/Safety module";
-
-const char usage_pattern[] =
-"Usage:\r\n"
-"    motor --left-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor --right-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor (--left-speed=<speed> --right-speed=<speed>) [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep left --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep right --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters> [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor show [--plain-text]\r\n"
-"    motor cal [left|right] [--iters=<iters>] [--with-debug]\r\n"
-"    motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    motor help\r\n"
-"    pid cal left ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid cal right ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid val (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val left (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val right (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid show [left|right] [--plain-text]\r\n"
-"    pid help\r\n"
-"    config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|all] | --mask=<mask>)\r\n"
-"    config show [motor|pid|bias|debug|status|params] [--plain-text]\r\n"
-"    config clear (motor|pid|bias|debug|all)\r\n"
-"    config help\r\n"
-"    motion cal linear [--speed] [--distance=<distance>]\r\n"
-"    motion cal angular [--speed] [--angle=<angle>]\r\n"
-"    motion cal umbmark\r\n"
-"    motion val linear [--linear-speed=<speed>] [--distance=<distance>]\r\n"
-"    motion val angular [--angular-speed=<speed>] [--angle=<angle>]\r\n"
-"    motion val square (left|right) [--side=<side>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion val circle (cw|ccw) [--radius=<radius>] [--angular-speed=<speed>]\r\n"
-"    motion val out-and-back [--distance=<distance>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion help\r\n"
-"    help";
-
-const char motor_help_message[] = 
-"Motor Help\r\n"
-"Usage:\r\n"
-"    motor --left-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor --right-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor (--left-speed=<speed> --right-speed=<speed>) [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep left --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep right --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters> [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor show [--plain-text]\r\n"
-"    motor cal [left|right] [--iters=<iters>] [--with-debug]\r\n"
-"    motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    motor help\r\n"
-"\r\n"
-"Options:\r\n"
-"    -z --no-control             Bypasses the Control/Safety module\r\n"
-"    -r --right-speed=<speed>    Speed of the right motor (meter/second)\r\n"
-"    -u --num-points=<points>    Number of velocity values [default: 7]\r\n"
-"    -t --iters=<iters>          Number of iterations per wheel [default: 3]\r\n"
-"    -d --duration=<duration>    Duration in seconds [default: 5]\r\n"
-"    -f --first=<speed>          First speed of the cycle\r\n"
-"    -n --min-percent=<percent>  Minimum value for profile range specified in percent of maximum speed [default: 0.2]\r\n"
-"    -x --max-percent=<percent>  Maximum value for profile range specified in percent of maximum speed [default: 0.8]\r\n"
-"    -p --plain-text             Display output as plain text (default is JSON)\r\n"
-"    -o --second=<speed>         Second speed of the cycle\r\n"
-"    -q --no-pid                 Disables PID control\r\n"
-"    -w --with-debug             Enable PID debug output\r\n"
-"    -v --intvl=<interval>       Time between speed change [default: 10]\r\n"
-"    -j --no-accel               Disables acceleration profile";
-
-const char motor_usage_pattern[] =
-"Motor Usage\r\n"
-"Usage:\r\n"
-"    motor --left-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor --right-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor (--left-speed=<speed> --right-speed=<speed>) [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep left --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor rep right --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters> [--no-pid] [--no-accel] [--no-control]\r\n"
-"    motor show [--plain-text]\r\n"
-"    motor cal [left|right] [--iters=<iters>] [--with-debug]\r\n"
-"    motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    motor help";
-
-const char pid_help_message[] =
-"Pid Help\r\n"
-"Usage:\r\n"
-"    pid cal left ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid cal right ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid val (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val left (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val right (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid show [left|right] [--plain-text]\r\n"
-"    pid help\r\n"
-"\r\n"
-"Options:\r\n"
-"    -p --plain-text             Display output as plain text (default is JSON)\r\n"
-"    -u --num-points=<points>    Number of velocity values [default: 7]\r\n"
-"    -n --min-percent=<percent>  Minimum value for profile range specified in percent of maximum speed [default: 0.2]\r\n"
-"    -x --max-percent=<percent>  Maximum value for profile range specified in percent of maximum speed [default: 0.8]\r\n"
-"    -w --with-debug             Enable PID debug output";
-
-const char pid_usage_pattern[] =
-"Pid Usage\r\n"
-"Usage:\r\n"
-"    pid cal left ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid cal right ([--impulse] | [--step=<step>]) [--with-debug]\r\n"
-"    pid val (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val left (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid val right (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]\r\n"
-"    pid show [left|right] [--plain-text]\r\n"
-"    pid help";
-
-const char config_help_message[] =
-"Config Help\r\n"
-"Usage:\r\n"
-"    config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|all] | --mask=<mask>)\r\n"
-"    config show [motor|pid|bias|debug|status|params] [--plain-text]\r\n"
-"    config clear (motor|pid|bias|debug|all)\r\n"
-"    config help\r\n"
-"\r\n"
-"Options:\r\n"
-"    -p --plain-text             Display output as plain text (default is JSON)\r\n"
-"    -m --mask=<mask>            Bitmap of debug flags";
-
-const char config_usage_pattern[] =
-"Config Usage\r\n"
-"Usage:\r\n"
-"    config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|all] | --mask=<mask>)\r\n"
-"    config show [motor|pid|bias|debug|status|params] [--plain-text]\r\n"
-"    config clear (motor|pid|bias|debug|all)\r\n"
-"    config help";
-
-const char motion_help_message[] =
-"Motion Help\r\n"
-"Usage:\r\n"
-"    motion cal linear [--speed] [--distance=<distance>]\r\n"
-"    motion cal angular [--speed] [--angle=<angle>]\r\n"
-"    motion cal umbmark\r\n"
-"    motion val linear [--linear-speed=<speed>] [--distance=<distance>]\r\n"
-"    motion val angular [--angular-speed=<speed>] [--angle=<angle>]\r\n"
-"    motion val square (left|right) [--side=<side>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion val circle (cw|ccw) [--radius=<radius>] [--angular-speed=<speed>]\r\n"
-"    motion val out-and-back [--distance=<distance>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion help\r\n"
-"\r\n"
-"Options:\r\n"
-"    -g --angle=<angle>          Amount of travel (degree)   [default: 360] \r\n"
-"    -a --radius=<radius>        Radius of the circle [default: 0.0]\r\n"
-"    -h --side=<side>            Side of the square [default: 1.0]\r\n"
-"    -s --distance=<distance>    Amount of travel (meter) [default: 1.0]";
-
-const char motion_usage_pattern[] =
-"Motion Usage\r\n"
-"Usage:\r\n"
-"    motion cal linear [--speed] [--distance=<distance>]\r\n"
-"    motion cal angular [--speed] [--angle=<angle>]\r\n"
-"    motion cal umbmark\r\n"
-"    motion val linear [--linear-speed=<speed>] [--distance=<distance>]\r\n"
-"    motion val angular [--angular-speed=<speed>] [--angle=<angle>]\r\n"
-"    motion val square (left|right) [--side=<side>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion val circle (cw|ccw) [--radius=<radius>] [--angular-speed=<speed>]\r\n"
-"    motion val out-and-back [--distance=<distance>] [--linear-speed=<speed>] [--angular-speed=<speed>]\r\n"
-"    motion help";
 
+#define KW_COMMAND (0)
+#define KW_FLAG (1)
+#define KW_OPTION (2)
 
+#define NUM_KEYWORDS (108)
+#define NO_KEYWORD (0xFF)
 
-typedef struct {
-    const char *name;
-    bool value;
-} Command;
+#define ARG_INT(args, offset) (*(int *) ((UINT8 *) (args) + (offset)))
+#define ARG_STR(args, offset) (*(char **) ((UINT8 *) (args) + (offset)))
 
 typedef struct {
     const char *name;
-    char *value;
-    char **array;
-} Argument;
+    UINT8 kind;
+    UINT16 offset;
+} KEYWORD_TYPE;
 
 typedef struct {
-    const char *oshort;
-    const char *olong;
-    bool argcount;
-    bool value;
-    char *argument;
-} Option;
+    UINT8 group;
+    UINT8 sub;
+    UINT8 route;
+} ROUTE_TYPE;
 
 typedef struct {
-    int n_commands;
-    int n_arguments;
-    int n_options;
-    Command *commands;
-    Argument *arguments;
-    Option *options;
-} Elements;
-
-
-/*
- * Tokens object
- */
-
-typedef struct Tokens {
-    int argc;
-    char **argv;
-    int i;
-    char *current;
-} Tokens;
-
-Tokens tokens_new(int argc, char **argv) {
-    Tokens ts = {argc, argv, 0, argv[0]};
-    return ts;
+    UINT16 offset;
+    const char *value;
+} DEFAULT_TYPE;
+
+const char conparser_title[] = "Arlobot Console";
+
+const char * const conparser_routes[CONPARSER_ROUTE_LAST] = {
+    "",
+    "motor",
+    "motor rep",
+    "motor show",
+    "motor cal",
+    "motor val",
+    "motor help",
+    "pid cal",
+    "pid val",
+    "pid show",
+    "pid tune",
+    "pid sched",
+    "pid cascade",
+    "pid help",
+    "config debug",
+    "config show",
+    "config clear",
+    "config rate",
+    "config accel",
+    "config shape",
+    "config refine",
+    "config bench",
+    "config export",
+    "config import",
+    "config help",
+    "motion cal",
+    "motion val",
+    "motion path",
+    "motion help",
+    "jobs",
+    "kill",
+    "macro record",
+    "macro end",
+    "macro run",
+    "macro show",
+    "macro delete",
+    "macro help",
+    "help"
+};
+
+const CONPARSER_HELP_TYPE conparser_usage[CONPARSER_NUM_USAGE] = {
+    {"motor --left-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor --right-speed=<speed> [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor (--left-speed=<speed> --right-speed=<speed>) [--duration=<duration>] [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor rep --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor rep left --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters>  [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor rep right --first=<speed> --second=<speed> --intvl=<interval> --iters=<iters> [--no-pid] [--no-accel] [--no-control]", CONPARSER_GROUP_MOTOR},
+    {"motor show [--plain-text]", CONPARSER_GROUP_MOTOR},
+    {"motor cal [left|right] [--iters=<iters>] [--with-debug] [--parallel]", CONPARSER_GROUP_MOTOR},
+    {"motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]", CONPARSER_GROUP_MOTOR},
+    {"motor help", CONPARSER_GROUP_MOTOR},
+    {"pid cal left ([--impulse] | [--step=<step>]) [--with-debug] [--binary]", CONPARSER_GROUP_PID},
+    {"pid cal right ([--impulse] | [--step=<step>]) [--with-debug] [--binary]", CONPARSER_GROUP_PID},
+    {"pid val (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]", CONPARSER_GROUP_PID},
+    {"pid val left (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]", CONPARSER_GROUP_PID},
+    {"pid val right (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]", CONPARSER_GROUP_PID},
+    {"pid show [left|right] [--plain-text]", CONPARSER_GROUP_PID},
+    {"pid tune (left|right) [--rule=<rule>]", CONPARSER_GROUP_PID},
+    {"pid sched (left|right) --band=<band> --cps=<cps> --gains=<gains>", CONPARSER_GROUP_PID},
+    {"pid sched (left|right) clear", CONPARSER_GROUP_PID},
+    {"pid cascade (enable|disable) [linear|angular]", CONPARSER_GROUP_PID},
+    {"pid cascade (linear|angular) --gains=<gains>", CONPARSER_GROUP_PID},
+    {"pid cascade show [--plain-text]", CONPARSER_GROUP_PID},
+    {"pid help", CONPARSER_GROUP_PID},
+    {"config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|trace|all] | --mask=<mask>)", CONPARSER_GROUP_CONFIG},
+    {"config show [motor|pid|bias|debug|status|params] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config clear (motor|pid|bias|debug|all)", CONPARSER_GROUP_CONFIG},
+    {"config rate [--enc-rate=<hz>] [--pid-rate=<hz>] [--odom-rate=<hz>] [--outer-rate=<hz>] [--save] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config accel [--lin-accel=<mps2>] [--lin-jerk=<mps3>] [--ang-accel=<rps2>] [--ang-jerk=<rps3>] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config shape [curvature|angular] [--reset] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config refine [enable|disable] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config bench [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config export [motor|pid|bias|rate] [--binary] [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config import (begin|commit|abort) [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config import --data=<data> [--plain-text]", CONPARSER_GROUP_CONFIG},
+    {"config help", CONPARSER_GROUP_CONFIG},
+    {"motion cal linear [--speed] [--distance=<distance>]", CONPARSER_GROUP_MOTION},
+    {"motion cal angular [--speed] [--angle=<angle>]", CONPARSER_GROUP_MOTION},
+    {"motion cal umbmark", CONPARSER_GROUP_MOTION},
+    {"motion val linear [--linear-speed=<speed>] [--distance=<distance>]", CONPARSER_GROUP_MOTION},
+    {"motion val angular [--angular-speed=<speed>] [--angle=<angle>]", CONPARSER_GROUP_MOTION},
+    {"motion val square (left|right) [--side=<side>] [--linear-speed=<speed>] [--angular-speed=<speed>]", CONPARSER_GROUP_MOTION},
+    {"motion val circle (cw|ccw) [--radius=<radius>] [--angular-speed=<speed>]", CONPARSER_GROUP_MOTION},
+    {"motion val out-and-back [--distance=<distance>] [--linear-speed=<speed>] [--angular-speed=<speed>]", CONPARSER_GROUP_MOTION},
+    {"motion path add --points=<points>", CONPARSER_GROUP_MOTION},
+    {"motion path start [--linear-speed=<speed>] [--lookahead=<distance>]", CONPARSER_GROUP_MOTION},
+    {"motion path (stop|clear)", CONPARSER_GROUP_MOTION},
+    {"motion path show [--plain-text]", CONPARSER_GROUP_MOTION},
+    {"motion help", CONPARSER_GROUP_MOTION},
+    {"jobs [--plain-text]", CONPARSER_GROUP_JOBS},
+    {"kill (all | --id=<id>)", CONPARSER_GROUP_KILL},
+    {"macro record --name=<name>", CONPARSER_GROUP_MACRO},
+    {"macro end", CONPARSER_GROUP_MACRO},
+    {"macro run --name=<name> [--plain-text]", CONPARSER_GROUP_MACRO},
+    {"macro show [--plain-text]", CONPARSER_GROUP_MACRO},
+    {"macro delete (all | --name=<name>)", CONPARSER_GROUP_MACRO},
+    {"macro help", CONPARSER_GROUP_MACRO},
+    {"help", CONPARSER_GROUP_HELP}
+};
+
+const CONPARSER_HELP_TYPE conparser_options[CONPARSER_NUM_OPTIONS] = {
+    {"-l --left-speed=<speed>     Speed of the left motor (meter/second)", 0x01},
+    {"-r --right-speed=<speed>    Speed of the right motor (meter/second)", 0x01},
+    {"-d --duration=<duration>    Duration in seconds [default: 5]", 0x01},
+    {"-m --mask=<mask>            Bitmap of debug flags", 0x04},
+    {"-p --plain-text             Display output as plain text (default is JSON)", 0x5F},
+    {"-w --with-debug             Enable PID debug output", 0x03},
+    {"-k --parallel               Calibrate left and right motors at the same time", 0x01},
+    {"-y --rule=<rule>            PID tuning rule: zn, zn-pi, tl, tl-pi, pessen, some, none [default: zn]", 0x02},
+    {"-b --band=<band>            PID gain schedule band (0 - 3)", 0x02},
+    {"-c --cps=<cps>              PID gain schedule band speed (count/sec)", 0x02},
+    {"--gains=<gains>             PID gains as kp,ki,kd,kf", 0x02},
+    {"--enc-rate=<hz>             Encoder sample rate (Hz)", 0x04},
+    {"--pid-rate=<hz>             PID sample rate (Hz)", 0x04},
+    {"--odom-rate=<hz>            Odometry sample rate (Hz)", 0x04},
+    {"--outer-rate=<hz>           Outer (linear/angular velocity) PID sample rate (Hz)", 0x04},
+    {"--save                      Store the sample rates in EEPROM", 0x04},
+    {"--lin-accel=<mps2>          Maximum linear acceleration (meter/second^2)", 0x04},
+    {"--lin-jerk=<mps3>           Maximum linear jerk (meter/second^3), 0 for a trapezoid ramp", 0x04},
+    {"--ang-accel=<rps2>          Maximum angular acceleration (radian/second^2)", 0x04},
+    {"--ang-jerk=<rps3>           Maximum angular jerk (radian/second^3), 0 for a trapezoid ramp", 0x04},
+    {"--reset                     Clear the command saturation counters", 0x04},
+    {"-i --impulse                Enable impulse response", 0x02},
+    {"--binary                    Dump the PID calibration capture/calibration snapshot as binary (default is JSON)", 0x06},
+    {"--data=<data>               Base64 chunk of a calibration snapshot (see config export)", 0x04},
+    {"--id=<id>                   Id of the job to kill (see jobs)", 0x20},
+    {"--name=<name>               Name of a console macro (up to 7 characters)", 0x40},
+    {"--points=<points>           Path points as x1,y1,x2,y2,... (meter), appended to the path", 0x08},
+    {"--lookahead=<distance>      Path lookahead distance (meter)", 0x08},
+    {"-s --distance=<distance>    Amount of travel (meter) [default: 1.0]", 0x08},
+    {"-g --angle=<angle>          Amount of travel (degree)   [default: 360] ", 0x08},
+    {"-t --iters=<iters>          Number of iterations per wheel [default: 3]", 0x01},
+    {"-e --step=<step>            Percentage of maximum speed to use for step response [default: 0.8]", 0x02},
+    {"-a --radius=<radius>        Radius of the circle [default: 0.0]", 0x08},
+    {"-h --side=<side>            Side of the square [default: 1.0]", 0x08},
+    {"-n --min-percent=<percent>  Minimum value for profile range specified in percent of maximum speed [default: 0.2]", 0x03},
+    {"-x --max-percent=<percent>  Maximum value for profile range specified in percent of maximum speed [default: 0.8]", 0x03},
+    {"-f --first=<speed>          First speed of the cycle", 0x01},
+    {"-o --second=<speed>         Second speed of the cycle", 0x01},
+    {"-v --intvl=<interval>       Time between speed change [default: 10]", 0x01},
+    {"-u --num-points=<points>    Number of velocity values [default: 7]", 0x03},
+    {"-q --no-pid                 Disables PID control", 0x01},
+    {"-j --no-accel               Disables acceleration profile", 0x01},
+    {"-z --no-control             Bypasses the Control/Safety module", 0x01}
+};
+
+static const INT16 displace[NUM_KEYWORDS] = {
+    -108, 0, 1, 0, -104, 0, 0, -102, -100, -96, -94, 0,
+    0, -90, -89, 2, -87, -86, -84, 0, 2, 0, -75, 0,
+    1, 0, -71, -70, 1, 0, 1, -64, -63, -62, -61, -60,
+    2, 1, 0, 1, -56, -54, 2, 0, -52, 0, 2, 3,
+    -50, 0, 0, 0, 1, 1, 0, -48, -47, 0, -45, 1,
+    -44, 0, 0, 4, 2, -39, -37, 1, -29, -22, 1, -21,
+    -20, 0, 4, -19, 7, 1, 0, 0, -17, -16, 0, 0,
+    0, 3, -12, -10, -9, 0, -7, 0, 0, 12, -5, 6,
+    0, -4, 0, -3, -1, 1, 5, 0, 0, 0, 1, 0
+};
+
+static const KEYWORD_TYPE keywords[NUM_KEYWORDS] = {
+    {"linear", KW_COMMAND, offsetof(DocoptArgs, linear)},
+    {"right", KW_COMMAND, offsetof(DocoptArgs, right)},
+    {"--plain-text", KW_FLAG, offsetof(DocoptArgs, plain_text)},
+    {"jobs", KW_COMMAND, offsetof(DocoptArgs, jobs)},
+    {"--save", KW_FLAG, offsetof(DocoptArgs, save)},
+    {"umbmark", KW_COMMAND, offsetof(DocoptArgs, umbmark)},
+    {"--speed", KW_FLAG, offsetof(DocoptArgs, speed)},
+    {"val", KW_COMMAND, offsetof(DocoptArgs, val)},
+    {"debug", KW_COMMAND, offsetof(DocoptArgs, debug)},
+    {"--data", KW_OPTION, offsetof(DocoptArgs, data)},
+    {"abort", KW_COMMAND, offsetof(DocoptArgs, abort)},
+    {"--angle", KW_OPTION, offsetof(DocoptArgs, angle)},
+    {"tune", KW_COMMAND, offsetof(DocoptArgs, tune)},
+    {"--distance", KW_OPTION, offsetof(DocoptArgs, distance)},
+    {"--linear-speed", KW_OPTION, offsetof(DocoptArgs, linear_speed)},
+    {"--odom-rate", KW_OPTION, offsetof(DocoptArgs, odom_rate)},
+    {"bias", KW_COMMAND, offsetof(DocoptArgs, bias)},
+    {"--pid-rate", KW_OPTION, offsetof(DocoptArgs, pid_rate)},
+    {"--duration", KW_OPTION, offsetof(DocoptArgs, duration)},
+    {"lmotor", KW_COMMAND, offsetof(DocoptArgs, lmotor)},
+    {"renc", KW_COMMAND, offsetof(DocoptArgs, renc)},
+    {"cascade", KW_COMMAND, offsetof(DocoptArgs, cascade)},
+    {"--lin-jerk", KW_OPTION, offsetof(DocoptArgs, lin_jerk)},
+    {"delete", KW_COMMAND, offsetof(DocoptArgs, delete)},
+    {"--radius", KW_OPTION, offsetof(DocoptArgs, radius)},
+    {"config", KW_COMMAND, offsetof(DocoptArgs, config)},
+    {"status", KW_COMMAND, offsetof(DocoptArgs, status)},
+    {"sched", KW_COMMAND, offsetof(DocoptArgs, sched)},
+    {"--points", KW_OPTION, offsetof(DocoptArgs, points)},
+    {"--max-percent", KW_OPTION, offsetof(DocoptArgs, max_percent)},
+    {"--impulse", KW_FLAG, offsetof(DocoptArgs, impulse)},
+    {"square", KW_COMMAND, offsetof(DocoptArgs, square)},
+    {"circle", KW_COMMAND, offsetof(DocoptArgs, circle)},
+    {"--intvl", KW_OPTION, offsetof(DocoptArgs, intvl)},
+    {"record", KW_COMMAND, offsetof(DocoptArgs, record)},
+    {"macro", KW_COMMAND, offsetof(DocoptArgs, macro)},
+    {"--id", KW_OPTION, offsetof(DocoptArgs, id)},
+    {"--mask", KW_OPTION, offsetof(DocoptArgs, mask)},
+    {"stop", KW_COMMAND, offsetof(DocoptArgs, stop)},
+    {"enable", KW_COMMAND, offsetof(DocoptArgs, enable)},
+    {"bench", KW_COMMAND, offsetof(DocoptArgs, bench)},
+    {"--no-pid", KW_FLAG, offsetof(DocoptArgs, no_pid)},
+    {"--band", KW_OPTION, offsetof(DocoptArgs, band)},
+    {"backward", KW_COMMAND, offsetof(DocoptArgs, backward)},
+    {"forward", KW_COMMAND, offsetof(DocoptArgs, forward)},
+    {"shape", KW_COMMAND, offsetof(DocoptArgs, shape)},
+    {"--no-control", KW_FLAG, offsetof(DocoptArgs, no_control)},
+    {"cw", KW_COMMAND, offsetof(DocoptArgs, cw)},
+    {"kill", KW_COMMAND, offsetof(DocoptArgs, kill)},
+    {"--parallel", KW_FLAG, offsetof(DocoptArgs, parallel)},
+    {"start", KW_COMMAND, offsetof(DocoptArgs, start)},
+    {"left", KW_COMMAND, offsetof(DocoptArgs, left)},
+    {"--with-debug", KW_FLAG, offsetof(DocoptArgs, with_debug)},
+    {"--no-accel", KW_FLAG, offsetof(DocoptArgs, no_accel)},
+    {"motion", KW_COMMAND, offsetof(DocoptArgs, motion)},
+    {"--left-speed", KW_OPTION, offsetof(DocoptArgs, left_speed)},
+    {"--rule", KW_OPTION, offsetof(DocoptArgs, rule)},
+    {"--iters", KW_OPTION, offsetof(DocoptArgs, iters)},
+    {"--cps", KW_OPTION, offsetof(DocoptArgs, cps)},
+    {"--lin-accel", KW_OPTION, offsetof(DocoptArgs, lin_accel)},
+    {"odom", KW_COMMAND, offsetof(DocoptArgs, odom)},
+    {"--min-percent", KW_OPTION, offsetof(DocoptArgs, min_percent)},
+    {"lpid", KW_COMMAND, offsetof(DocoptArgs, lpid)},
+    {"--first", KW_OPTION, offsetof(DocoptArgs, first)},
+    {"pid", KW_COMMAND, offsetof(DocoptArgs, pid)},
+    {"begin", KW_COMMAND, offsetof(DocoptArgs, begin)},
+    {"--side", KW_OPTION, offsetof(DocoptArgs, side)},
+    {"help", KW_COMMAND, offsetof(DocoptArgs, help)},
+    {"disable", KW_COMMAND, offsetof(DocoptArgs, disable)},
+    {"params", KW_COMMAND, offsetof(DocoptArgs, params)},
+    {"path", KW_COMMAND, offsetof(DocoptArgs, path)},
+    {"commit", KW_COMMAND, offsetof(DocoptArgs, commit)},
+    {"accel", KW_COMMAND, offsetof(DocoptArgs, accel)},
+    {"--outer-rate", KW_OPTION, offsetof(DocoptArgs, outer_rate)},
+    {"motor", KW_COMMAND, offsetof(DocoptArgs, motor)},
+    {"rmotor", KW_COMMAND, offsetof(DocoptArgs, rmotor)},
+    {"lenc", KW_COMMAND, offsetof(DocoptArgs, lenc)},
+    {"cal", KW_COMMAND, offsetof(DocoptArgs, cal)},
+    {"run", KW_COMMAND, offsetof(DocoptArgs, run)},
+    {"rate", KW_COMMAND, offsetof(DocoptArgs, rate)},
+    {"--step", KW_OPTION, offsetof(DocoptArgs, step)},
+    {"refine", KW_COMMAND, offsetof(DocoptArgs, refine)},
+    {"export", KW_COMMAND, offsetof(DocoptArgs, export)},
+    {"curvature", KW_COMMAND, offsetof(DocoptArgs, curvature)},
+    {"--lookahead", KW_OPTION, offsetof(DocoptArgs, lookahead)},
+    {"--right-speed", KW_OPTION, offsetof(DocoptArgs, right_speed)},
+    {"add", KW_COMMAND, offsetof(DocoptArgs, add)},
+    {"rpid", KW_COMMAND, offsetof(DocoptArgs, rpid)},
+    {"clear", KW_COMMAND, offsetof(DocoptArgs, clear)},
+    {"out-and-back", KW_COMMAND, offsetof(DocoptArgs, out_and_back)},
+    {"--angular-speed", KW_OPTION, offsetof(DocoptArgs, angular_speed)},
+    {"--ang-jerk", KW_OPTION, offsetof(DocoptArgs, ang_jerk)},
+    {"--reset", KW_FLAG, offsetof(DocoptArgs, reset)},
+    {"trace", KW_COMMAND, offsetof(DocoptArgs, trace)},
+    {"angular", KW_COMMAND, offsetof(DocoptArgs, angular)},
+    {"--gains", KW_OPTION, offsetof(DocoptArgs, gains)},
+    {"--enc-rate", KW_OPTION, offsetof(DocoptArgs, enc_rate)},
+    {"rep", KW_COMMAND, offsetof(DocoptArgs, rep)},
+    {"--name", KW_OPTION, offsetof(DocoptArgs, name)},
+    {"ccw", KW_COMMAND, offsetof(DocoptArgs, ccw)},
+    {"--binary", KW_FLAG, offsetof(DocoptArgs, binary)},
+    {"--num-points", KW_OPTION, offsetof(DocoptArgs, num_points)},
+    {"--second", KW_OPTION, offsetof(DocoptArgs, second)},
+    {"--ang-accel", KW_OPTION, offsetof(DocoptArgs, ang_accel)},
+    {"end", KW_COMMAND, offsetof(DocoptArgs, end)},
+    {"show", KW_COMMAND, offsetof(DocoptArgs, show)},
+    {"import", KW_COMMAND, offsetof(DocoptArgs, import)},
+    {"all", KW_COMMAND, offsetof(DocoptArgs, all)}
+};
+
+/* Short options by letter, a - z */
+static const UINT8 short_options[26] = {
+    0x18, 0x2A, 0x3A, 0x12, 0x50, 0x3F, 0x0B, 0x42, 0x1E, 0x35, 0x31, 0x37,
+    0x25, 0x3D, 0x66, 0x02, 0x29, 0x55, 0x0D, 0x39, 0x65, 0x21, 0x34, 0x1D,
+    0x38, 0x2E
+};
+
+static const DEFAULT_TYPE defaults[12] = {
+    {offsetof(DocoptArgs, angle), "360"},
+    {offsetof(DocoptArgs, distance), "1.0"},
+    {offsetof(DocoptArgs, duration), "5"},
+    {offsetof(DocoptArgs, intvl), "10"},
+    {offsetof(DocoptArgs, iters), "3"},
+    {offsetof(DocoptArgs, max_percent), "0.8"},
+    {offsetof(DocoptArgs, min_percent), "0.2"},
+    {offsetof(DocoptArgs, num_points), "7"},
+    {offsetof(DocoptArgs, radius), "0.0"},
+    {offsetof(DocoptArgs, rule), "zn"},
+    {offsetof(DocoptArgs, side), "1.0"},
+    {offsetof(DocoptArgs, step), "0.8"}
+};
+
+static const ROUTE_TYPE routes[37] = {
+    {0x4A, 0x61, CONPARSER_ROUTE_MOTOR_REP},
+    {0x4A, 0x69, CONPARSER_ROUTE_MOTOR_SHOW},
+    {0x4A, 0x4D, CONPARSER_ROUTE_MOTOR_CAL},
+    {0x4A, 0x07, CONPARSER_ROUTE_MOTOR_VAL},
+    {0x4A, 0x43, CONPARSER_ROUTE_MOTOR_HELP},
+    {0x40, 0x4D, CONPARSER_ROUTE_PID_CAL},
+    {0x40, 0x07, CONPARSER_ROUTE_PID_VAL},
+    {0x40, 0x69, CONPARSER_ROUTE_PID_SHOW},
+    {0x40, 0x0C, CONPARSER_ROUTE_PID_TUNE},
+    {0x40, 0x1B, CONPARSER_ROUTE_PID_SCHED},
+    {0x40, 0x15, CONPARSER_ROUTE_PID_CASCADE},
+    {0x40, 0x43, CONPARSER_ROUTE_PID_HELP},
+    {0x19, 0x08, CONPARSER_ROUTE_CONFIG_DEBUG},
+    {0x19, 0x69, CONPARSER_ROUTE_CONFIG_SHOW},
+    {0x19, 0x58, CONPARSER_ROUTE_CONFIG_CLEAR},
+    {0x19, 0x4F, CONPARSER_ROUTE_CONFIG_RATE},
+    {0x19, 0x48, CONPARSER_ROUTE_CONFIG_ACCEL},
+    {0x19, 0x2D, CONPARSER_ROUTE_CONFIG_SHAPE},
+    {0x19, 0x51, CONPARSER_ROUTE_CONFIG_REFINE},
+    {0x19, 0x28, CONPARSER_ROUTE_CONFIG_BENCH},
+    {0x19, 0x52, CONPARSER_ROUTE_CONFIG_EXPORT},
+    {0x19, 0x6A, CONPARSER_ROUTE_CONFIG_IMPORT},
+    {0x19, 0x43, CONPARSER_ROUTE_CONFIG_HELP},
+    {0x36, 0x4D, CONPARSER_ROUTE_MOTION_CAL},
+    {0x36, 0x07, CONPARSER_ROUTE_MOTION_VAL},
+    {0x36, 0x46, CONPARSER_ROUTE_MOTION_PATH},
+    {0x36, 0x43, CONPARSER_ROUTE_MOTION_HELP},
+    {0x23, 0x22, CONPARSER_ROUTE_MACRO_RECORD},
+    {0x23, 0x68, CONPARSER_ROUTE_MACRO_END},
+    {0x23, 0x4E, CONPARSER_ROUTE_MACRO_RUN},
+    {0x23, 0x69, CONPARSER_ROUTE_MACRO_SHOW},
+    {0x23, 0x17, CONPARSER_ROUTE_MACRO_DELETE},
+    {0x23, 0x43, CONPARSER_ROUTE_MACRO_HELP},
+    {0x4A, 0xFF, CONPARSER_ROUTE_MOTOR},
+    {0x03, 0xFF, CONPARSER_ROUTE_JOBS},
+    {0x30, 0xFF, CONPARSER_ROUTE_KILL},
+    {0x43, 0xFF, CONPARSER_ROUTE_HELP}
+};
+
+static UINT32 hash(UINT32 seed, const char *str)
+{
+    UINT32 h = seed ^ 0x811C9DC5UL;
+
+    while (*str)
+    {
+        h = (h ^ (UINT8) *str++) * 0x01000193UL;
+    }
+
+    return h;
 }
 
-Tokens* tokens_move(Tokens *ts) {
-    if (ts->i < ts->argc) {
-        ts->current = ts->argv[++ts->i];
-    }
-    if (ts->i == ts->argc) {
-        ts->current = NULL;
+static UINT8 find_keyword(const char *name)
+{
+    INT16 d;
+    UINT8 index;
+
+    d = displace[hash(0, name) % NUM_KEYWORDS];
+    index = d < 0 ? (UINT8) (-d - 1) : (UINT8) (hash((UINT32) d, name) % NUM_KEYWORDS);
+
+    return strcmp(keywords[index].name, name) == 0 ? index : NO_KEYWORD;
+}
+
+/* Long options can be abbreviated to a unique prefix, e.g., --dur=5 */
+static UINT8 find_option_prefix(const char *name)
+{
+    UINT8 ii;
+    UINT8 found = NO_KEYWORD;
+    size_t length = strlen(name);
+
+    for (ii = 0; ii < NUM_KEYWORDS; ++ii)
+    {
+        if (keywords[ii].kind != KW_COMMAND && strncmp(keywords[ii].name, name, length) == 0)
+        {
+            if (found != NO_KEYWORD)
+            {
+                return NO_KEYWORD;
+            }
+            found = ii;
+        }
     }
-    return ts;
+
+    return found;
 }
 
+static char * next_token(char **next)
+{
+    char *token = *next;
+
+    while (*token == ' ')
+    {
+        token++;
+    }
 
-/*
- * ARGV parsing functions
- */
+    if (*token == '\0')
+    {
+        return NULL;
+    }
 
-int parse_doubledash(Tokens *ts, Elements *elements) {
-    //int n_commands = elements->n_commands;
-    //int n_arguments = elements->n_arguments;
-    //Command *commands = elements->commands;
-    //Argument *arguments = elements->arguments;
+    *next = token;
+    while (**next != ' ' && **next != '\0')
+    {
+        (*next)++;
+    }
+
+    if (**next == ' ')
+    {
+        **next = '\0';
+        (*next)++;
+    }
 
-    // not implemented yet
-    // return parsed + [Argument(None, v) for v in tokens]
-    return 0;
+    return token;
 }
 
-int parse_long(Tokens *ts, Elements *elements) {
-    int i;
-    int len_prefix;
-    int n_options = elements->n_options;
-    char *eq = strchr(ts->current, '=');
-    Option *option;
-    Option *options = elements->options;
-
-    len_prefix = (eq-(ts->current))/sizeof(char);
-    for (i=0; i < n_options; i++) {
-        option = &options[i];
-        if (!strncmp(ts->current, option->olong, len_prefix))
-            break;
+static CONPARSER_RESULT_TYPE set_option(DocoptArgs * const args, UINT8 index, char *value, char **next)
+{
+    if (keywords[index].kind == KW_FLAG)
+    {
+        if (value != NULL)
+        {
+            return CONPARSER_UNEXPECTED_ARGUMENT;
+        }
+        ARG_INT(args, keywords[index].offset) = 1;
+        return CONPARSER_OK;
     }
-    if (i == n_options) {
-        // TODO '%s is not a unique prefix
-        fprintf(stderr, "%s is not recognized\n", ts->current);
-        return 1;
+
+    if (value == NULL)
+    {
+        value = next_token(next);
+        if (value == NULL)
+        {
+            return CONPARSER_MISSING_ARGUMENT;
+        }
     }
-    tokens_move(ts);
-    if (option->argcount) {
-        if (eq == NULL) {
-            if (ts->current == NULL) {
-                fprintf(stderr, "%s requires argument\n", option->olong);
-                return 1;
-            }
-            option->argument = ts->current;
-            tokens_move(ts);
-        } else {
-            option->argument = eq + 1;
+    ARG_STR(args, keywords[index].offset) = value;
+
+    return CONPARSER_OK;
+}
+
+static CONPARSER_RESULT_TYPE parse_short(DocoptArgs * const args, char *token, char **next)
+{
+    UINT8 index;
+    CONPARSER_RESULT_TYPE result;
+
+    for (; *token != '\0'; ++token)
+    {
+        index = *token >= 'a' && *token <= 'z' ? short_options[*token - 'a'] : NO_KEYWORD;
+        if (index == NO_KEYWORD)
+        {
+            return CONPARSER_UNKNOWN_WORD;
         }
-    } else {
-        if (eq != NULL) {
-            fprintf(stderr, "%s must not have an argument\n", option->olong);
-            return 1;
+
+        if (keywords[index].kind == KW_OPTION)
+        {
+            /* The rest of the token, if any, is the argument, e.g., -d5 */
+            return set_option(args, index, token[1] != '\0' ? token + 1 : NULL, next);
+        }
+
+        result = set_option(args, index, NULL, next);
+        if (result != CONPARSER_OK)
+        {
+            return result;
         }
-        option->value = true;
     }
-    return 0;
+
+    return CONPARSER_OK;
 }
 
-int parse_shorts(Tokens *ts, Elements *elements) {
-    char *raw;
-    int i;
-    int n_options = elements->n_options;
-    Option *option;
-    Option *options = elements->options;
-
-    raw = &ts->current[1];
-    tokens_move(ts);
-    while (raw[0] != '\0') {
-        for (i=0; i < n_options; i++) {
-            option = &options[i];
-            if (option->oshort != NULL && option->oshort[1] == raw[0])
-                break;
+static void set_defaults(DocoptArgs * const args)
+{
+    UINT8 ii;
+
+    memset(args, 0, sizeof *args);
+    for (ii = 0; ii < sizeof defaults / sizeof defaults[0]; ++ii)
+    {
+        ARG_STR(args, defaults[ii].offset) = (char *) defaults[ii].value;
+    }
+}
+
+static CONPARSER_ROUTE_TYPE find_route(UINT8 group, UINT8 sub)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < sizeof routes / sizeof routes[0]; ++ii)
+    {
+        if (routes[ii].group == group && (routes[ii].sub == sub || routes[ii].sub == NO_KEYWORD))
+        {
+            return (CONPARSER_ROUTE_TYPE) routes[ii].route;
         }
-        if (i == n_options) {
-            // TODO -%s is specified ambiguously %d times
-            fprintf(stderr, "-%c is not recognized\n", raw[0]);
-            return 1;
+    }
+
+    return CONPARSER_ROUTE_NONE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ConParser_Parse
+ * Description: Parses a console line into args.  The line is tokenized in place and the option
+ *              arguments point into the line.  The first two command words select the route.
+ * Parameters: line - the console line (modified)
+ *             args - the parsed commands, options and route
+ * Return: CONPARSER_OK if all words and options are known, otherwise the reason for the failure
+ *
+ *-------------------------------------------------------------------------------------------------*/
+CONPARSER_RESULT_TYPE ConParser_Parse(char * const line, DocoptArgs * const args)
+{
+    char *next = line;
+    char *token;
+    char *value;
+    UINT8 index;
+    UINT8 commands[2] = {NO_KEYWORD, NO_KEYWORD};
+    UINT8 num_commands = 0;
+    CONPARSER_RESULT_TYPE result;
+
+    set_defaults(args);
+
+    while ((token = next_token(&next)) != NULL)
+    {
+        if (token[0] == '-' && token[1] == '-')
+        {
+            value = strchr(token, '=');
+            if (value != NULL)
+            {
+                *value++ = '\0';
+            }
+
+            index = find_keyword(token);
+            if (index == NO_KEYWORD)
+            {
+                index = find_option_prefix(token);
+            }
+            if (index == NO_KEYWORD || keywords[index].kind == KW_COMMAND)
+            {
+                return CONPARSER_UNKNOWN_WORD;
+            }
+
+            result = set_option(args, index, value, &next);
+        }
+        else if (token[0] == '-' && token[1] != '\0')
+        {
+            result = parse_short(args, token + 1, &next);
         }
-        raw++;
-        if (!option->argcount) {
-            option->value = true;
-        } else {
-            if (raw[0] == '\0') {
-                if (ts->current == NULL) {
-                    fprintf(stderr, "%s requires argument\n", option->oshort);
-                    return 1;
-                }
-                raw = ts->current;
-                tokens_move(ts);
+        else
+        {
+            index = find_keyword(token);
+            if (index == NO_KEYWORD || keywords[index].kind != KW_COMMAND)
+            {
+                return CONPARSER_UNKNOWN_WORD;
             }
-            option->argument = raw;
-            break;
+
+            ARG_INT(args, keywords[index].offset) = 1;
+            if (num_commands < 2)
+            {
+                commands[num_commands++] = index;
+            }
+            result = CONPARSER_OK;
+        }
+
+        if (result != CONPARSER_OK)
+        {
+            return result;
         }
     }
-    return 0;
+
+    args->route = find_route(commands[0], commands[1]);
+
+    return CONPARSER_OK;
 }
 
-int parse_argcmd(Tokens *ts, Elements *elements) {
-    int i;
-    int n_commands = elements->n_commands;
-    //int n_arguments = elements->n_arguments;
-    Command *command;
-    Command *commands = elements->commands;
-    //Argument *arguments = elements->arguments;
-
-    for (i=0; i < n_commands; i++) {
-        command = &commands[i];
-        if (!strcmp(command->name, ts->current)){
-            command->value = true;
-            tokens_move(ts);
-            return 0;
+/* A compiled command is the route followed by the index of each keyword that is set and, for an option with an
+   argument, the argument as a NUL-terminated string.  Arguments that are still the default are not stored.
+*/
+static BOOL is_default(UINT16 offset, const char *value)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < sizeof defaults / sizeof defaults[0]; ++ii)
+    {
+        if (defaults[ii].offset == offset && defaults[ii].value == value)
+        {
+            return TRUE;
         }
     }
-    // not implemented yet, just skip for now
-    // parsed.append(Argument(None, tokens.move()))
-    /*fprintf(stderr, "! argument '%s' has been ignored\n", ts->current);
-    fprintf(stderr, "  '");
-    for (i=0; i<ts->argc ; i++)
-        fprintf(stderr, "%s ", ts->argv[i]);
-    fprintf(stderr, "'\n");*/
-    tokens_move(ts);
-    // Return 1 if we didn't find a command
-    return 1;
+
+    return FALSE;
 }
 
-int parse_args(Tokens *ts, Elements *elements) {
-    int ret;
-
-    while (ts->current != NULL) {
-        if (strcmp(ts->current, "--") == 0) {
-            ret = parse_doubledash(ts, elements);
-            if (!ret) break;
-        } else if (ts->current[0] == '-' && ts->current[1] == '-') {
-            ret = parse_long(ts, elements);
-        } else if (ts->current[0] == '-' && ts->current[1] != '\0') {
-            ret = parse_shorts(ts, elements);
-        } else
-            ret = parse_argcmd(ts, elements);
-        if (ret) return ret;
+static BOOL append(char * const line, UINT8 * const pos, UINT8 size, const char *text)
+{
+    size_t length = strlen(text);
+
+    if (*pos + length >= size)
+    {
+        return FALSE;
     }
-    return 0;
+
+    memcpy(&line[*pos], text, length + 1);
+    *pos += (UINT8) length;
+
+    return TRUE;
 }
 
-int elems_to_args(Elements *elements, DocoptArgs *args, bool help,
-                  const char *version){
-    Command *command;
-    Argument *argument;
-    Option *option;
-    int i;
-
-    // fix gcc-related compiler warnings (unused)
-    (void)command;
-    (void)argument;
-
-    /* options */
-    for (i=0; i < elements->n_options; i++) {
-        option = &elements->options[i];
-        if (help && option->value && !strcmp(option->olong, "--help")) {
-            printf("%s", args->help_message);
-            return 1;
-        } else if (version && option->value &&
-                   !strcmp(option->olong, "--version")) {
-            printf("%s\n", version);
-            return 1;
-        } else if (!strcmp(option->olong, "--impulse")) {
-            args->impulse = option->value;
-        } else if (!strcmp(option->olong, "--no-accel")) {
-            args->no_accel = option->value;
-        } else if (!strcmp(option->olong, "--no-control")) {
-            args->no_control = option->value;
-        } else if (!strcmp(option->olong, "--no-pid")) {
-            args->no_pid = option->value;
-        } else if (!strcmp(option->olong, "--plain-text")) {
-            args->plain_text = option->value;
-        } else if (!strcmp(option->olong, "--speed")) {
-            args->speed = option->value;
-        } else if (!strcmp(option->olong, "--with-debug")) {
-            args->with_debug = option->value;
-        } else if (!strcmp(option->olong, "--angle")) {
-            if (option->argument)
-                args->angle = option->argument;
-        } else if (!strcmp(option->olong, "--angular-speed")) {
-            if (option->argument)
-                args->angular_speed = option->argument;
-        } else if (!strcmp(option->olong, "--distance")) {
-            if (option->argument)
-                args->distance = option->argument;
-        } else if (!strcmp(option->olong, "--duration")) {
-            if (option->argument)
-                args->duration = option->argument;
-        } else if (!strcmp(option->olong, "--first")) {
-            if (option->argument)
-                args->first = option->argument;
-        } else if (!strcmp(option->olong, "--intvl")) {
-            if (option->argument)
-                args->intvl = option->argument;
-        } else if (!strcmp(option->olong, "--iters")) {
-            if (option->argument)
-                args->iters = option->argument;
-        } else if (!strcmp(option->olong, "--left-speed")) {
-            if (option->argument)
-                args->left_speed = option->argument;
-        } else if (!strcmp(option->olong, "--linear-speed")) {
-            if (option->argument)
-                args->linear_speed = option->argument;
-        } else if (!strcmp(option->olong, "--mask")) {
-            if (option->argument)
-                args->mask = option->argument;
-        } else if (!strcmp(option->olong, "--max-percent")) {
-            if (option->argument)
-                args->max_percent = option->argument;
-        } else if (!strcmp(option->olong, "--min-percent")) {
-            if (option->argument)
-                args->min_percent = option->argument;
-        } else if (!strcmp(option->olong, "--num-points")) {
-            if (option->argument)
-                args->num_points = option->argument;
-        } else if (!strcmp(option->olong, "--radius")) {
-            if (option->argument)
-                args->radius = option->argument;
-        } else if (!strcmp(option->olong, "--right-speed")) {
-            if (option->argument)
-                args->right_speed = option->argument;
-        } else if (!strcmp(option->olong, "--second")) {
-            if (option->argument)
-                args->second = option->argument;
-        } else if (!strcmp(option->olong, "--side")) {
-            if (option->argument)
-                args->side = option->argument;
-        } else if (!strcmp(option->olong, "--step")) {
-            if (option->argument)
-                args->step = option->argument;
-        }
+UINT8 ConParser_Compile(DocoptArgs const * const args, UINT8 * const code, UINT8 size)
+{
+    UINT8 ii;
+    UINT8 length = 0;
+    const char *value;
+    size_t value_length;
+
+    if (size == 0 || args->route == CONPARSER_ROUTE_NONE)
+    {
+        return 0;
     }
-    /* commands */
-    for (i=0; i < elements->n_commands; i++) {
-        command = &elements->commands[i];
-        if (!strcmp(command->name, "all")) {
-            args->all = command->value;
-        } else if (!strcmp(command->name, "angular")) {
-            args->angular = command->value;
-        } else if (!strcmp(command->name, "backward")) {
-            args->backward = command->value;
-        } else if (!strcmp(command->name, "bias")) {
-            args->bias = command->value;
-        } else if (!strcmp(command->name, "cal")) {
-            args->cal = command->value;
-        } else if (!strcmp(command->name, "ccw")) {
-            args->ccw = command->value;
-        } else if (!strcmp(command->name, "circle")) {
-            args->circle = command->value;
-        } else if (!strcmp(command->name, "clear")) {
-            args->clear = command->value;
-        } else if (!strcmp(command->name, "config")) {
-            args->config = command->value;
-        } else if (!strcmp(command->name, "cw")) {
-            args->cw = command->value;
-        } else if (!strcmp(command->name, "debug")) {
-            args->debug = command->value;
-        } else if (!strcmp(command->name, "disable")) {
-            args->disable = command->value;
-        } else if (!strcmp(command->name, "enable")) {
-            args->enable = command->value;
-        } else if (!strcmp(command->name, "forward")) {
-            args->forward = command->value;
-        } else if (!strcmp(command->name, "help")) {
-            args->help = command->value;
-        } else if (!strcmp(command->name, "left")) {
-            args->left = command->value;
-        } else if (!strcmp(command->name, "lenc")) {
-            args->lenc = command->value;
-        } else if (!strcmp(command->name, "linear")) {
-            args->linear = command->value;
-        } else if (!strcmp(command->name, "lmotor")) {
-            args->lmotor = command->value;
-        } else if (!strcmp(command->name, "lpid")) {
-            args->lpid = command->value;
-        } else if (!strcmp(command->name, "motion")) {
-            args->motion = command->value;
-        } else if (!strcmp(command->name, "motor")) {
-            args->motor = command->value;
-        } else if (!strcmp(command->name, "odom")) {
-            args->odom = command->value;
-        } else if (!strcmp(command->name, "out-and-back")) {
-            args->out_and_back = command->value;
-        } else if (!strcmp(command->name, "params")) {
-            args->params = command->value;
-        } else if (!strcmp(command->name, "pid")) {
-            args->pid = command->value;
-        } else if (!strcmp(command->name, "renc")) {
-            args->renc = command->value;
-        } else if (!strcmp(command->name, "rep")) {
-            args->rep = command->value;
-        } else if (!strcmp(command->name, "right")) {
-            args->right = command->value;
-        } else if (!strcmp(command->name, "rmotor")) {
-            args->rmotor = command->value;
-        } else if (!strcmp(command->name, "rpid")) {
-            args->rpid = command->value;
-        } else if (!strcmp(command->name, "show")) {
-            args->show = command->value;
-        } else if (!strcmp(command->name, "square")) {
-            args->square = command->value;
-        } else if (!strcmp(command->name, "status")) {
-            args->status = command->value;
-        } else if (!strcmp(command->name, "umbmark")) {
-            args->umbmark = command->value;
-        } else if (!strcmp(command->name, "val")) {
-            args->val = command->value;
+
+    code[length++] = (UINT8) args->route;
+    for (ii = 0; ii < NUM_KEYWORDS; ++ii)
+    {
+        if (keywords[ii].kind == KW_OPTION)
+        {
+            value = ARG_STR(args, keywords[ii].offset);
+            if (value == NULL || is_default(keywords[ii].offset, value))
+            {
+                continue;
+            }
+
+            value_length = strlen(value) + 1;
+            if (length + 1 + value_length > size)
+            {
+                return 0;
+            }
+
+            code[length++] = ii;
+            memcpy(&code[length], value, value_length);
+            length += (UINT8) value_length;
+        }
+        else if (ARG_INT(args, keywords[ii].offset))
+        {
+            if (length + 1 > size)
+            {
+                return 0;
+            }
+
+            code[length++] = ii;
         }
     }
-    /* arguments */
-    for (i=0; i < elements->n_arguments; i++) {
-        argument = &elements->arguments[i];
+
+    return length;
+}
+
+/* The option arguments point into the code, so it must outlive the command */
+CONPARSER_RESULT_TYPE ConParser_Load(UINT8 const * const code, UINT8 length, DocoptArgs * const args)
+{
+    UINT8 pos = 1;
+    UINT8 index;
+    UINT8 const *end;
+
+    set_defaults(args);
+
+    if (length == 0 || code[0] == CONPARSER_ROUTE_NONE || code[0] >= CONPARSER_ROUTE_LAST)
+    {
+        return CONPARSER_UNKNOWN_WORD;
     }
-    return 0;
+
+    while (pos < length)
+    {
+        index = code[pos++];
+        if (index >= NUM_KEYWORDS)
+        {
+            return CONPARSER_UNKNOWN_WORD;
+        }
+
+        if (keywords[index].kind == KW_OPTION)
+        {
+            end = pos < length ? memchr(&code[pos], '\0', length - pos) : NULL;
+            if (end == NULL)
+            {
+                return CONPARSER_MISSING_ARGUMENT;
+            }
+
+            ARG_STR(args, keywords[index].offset) = (char *) &code[pos];
+            pos = (UINT8) (end - code + 1);
+        }
+        else
+        {
+            ARG_INT(args, keywords[index].offset) = 1;
+        }
+    }
+
+    args->route = (CONPARSER_ROUTE_TYPE) code[0];
+
+    return CONPARSER_OK;
 }
 
+/* Writes the compiled command back as a command line, e.g., for listing, and returns its length (0 on error) */
+UINT8 ConParser_Decompile(UINT8 const * const code, UINT8 length, char * const line, UINT8 size)
+{
+    UINT8 ii;
+    UINT8 pos = 0;
+    UINT8 index;
+    UINT8 group = NO_KEYWORD;
+    UINT8 sub = NO_KEYWORD;
+    BOOL is_ok;
+
+    if (size == 0 || length == 0 || code[0] == CONPARSER_ROUTE_NONE || code[0] >= CONPARSER_ROUTE_LAST)
+    {
+        return 0;
+    }
+
+    /* The route name already has the leading command words */
+    for (ii = 0; ii < sizeof routes / sizeof routes[0]; ++ii)
+    {
+        if (routes[ii].route == code[0])
+        {
+            group = routes[ii].group;
+            sub = routes[ii].sub;
+            break;
+        }
+    }
+
+    line[0] = '\0';
+    is_ok = append(line, &pos, size, conparser_routes[code[0]]);
+
+    ii = 1;
+    while (is_ok && ii < length)
+    {
+        index = code[ii++];
+        if (index >= NUM_KEYWORDS)
+        {
+            return 0;
+        }
+
+        if (index == group || index == sub)
+        {
+            continue;
+        }
+
+        is_ok = append(line, &pos, size, " ") && append(line, &pos, size, keywords[index].name);
+
+        if (is_ok && keywords[index].kind == KW_OPTION)
+        {
+            if (ii >= length || memchr(&code[ii], '\0', length - ii) == NULL)
+            {
+                return 0;
+            }
+
+            is_ok = append(line, &pos, size, "=") && append(line, &pos, size, (const char *) &code[ii]);
+            ii += (UINT8) (strlen((const char *) &code[ii]) + 1);
+        }
+    }
 
-/*
- * Main docopt function
- */
-
-DocoptArgs docopt(int argc, char *argv[], bool help, const char *version, int* success) {
-    DocoptArgs args = {
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, (char*) "360",
-        NULL, (char*) "1.0", (char*) "5", NULL, (char*) "10", (char*) "3", NULL,
-        NULL, NULL, (char*) "0.8", (char*) "0.2", (char*) "7", (char*) "0.0",
-        NULL, NULL, (char*) "1.0", (char*) "0.8",
-        usage_pattern, help_message, motor_usage_pattern, motor_help_message,
-        pid_usage_pattern, pid_help_message, config_usage_pattern, config_help_message,
-        motion_usage_pattern, motion_help_message
-    };
-    Tokens ts;
-    Command commands[] = {
-        {"all", 0},
-        {"angular", 0},
-        {"backward", 0},
-        {"bias", 0},
-        {"cal", 0},
-        {"ccw", 0},
-        {"circle", 0},
-        {"clear", 0},
-        {"config", 0},
-        {"cw", 0},
-        {"debug", 0},
-        {"disable", 0},
-        {"enable", 0},
-        {"forward", 0},
-        {"help", 0},
-        {"left", 0},
-        {"lenc", 0},
-        {"linear", 0},
-        {"lmotor", 0},
-        {"lpid", 0},
-        {"motion", 0},
-        {"motor", 0},
-        {"odom", 0},
-        {"out-and-back", 0},
-        {"params", 0},
-        {"pid", 0},
-        {"renc", 0},
-        {"rep", 0},
-        {"right", 0},
-        {"rmotor", 0},
-        {"rpid", 0},
-        {"show", 0},
-        {"square", 0},
-        {"status", 0},
-        {"umbmark", 0},
-        {"val", 0}
-    };
-    Argument arguments[] = {
-    };
-    Option options[] = {
-        {"-i", "--impulse", 0, 0, NULL},
-        {"-j", "--no-accel", 0, 0, NULL},
-        {"-z", "--no-control", 0, 0, NULL},
-        {"-q", "--no-pid", 0, 0, NULL},
-        {"-p", "--plain-text", 0, 0, NULL},
-        {NULL, "--speed", 0, 0, NULL},
-        {"-w", "--with-debug", 0, 0, NULL},
-        {"-g", "--angle", 1, 0, NULL},
-        {NULL, "--angular-speed", 1, 0, NULL},
-        {"-s", "--distance", 1, 0, NULL},
-        {"-d", "--duration", 1, 0, NULL},
-        {"-f", "--first", 1, 0, NULL},
-        {"-v", "--intvl", 1, 0, NULL},
-        {"-t", "--iters", 1, 0, NULL},
-        {"-l", "--left-speed", 1, 0, NULL},
-        {NULL, "--linear-speed", 1, 0, NULL},
-        {"-m", "--mask", 1, 0, NULL},
-        {"-x", "--max-percent", 1, 0, NULL},
-        {"-n", "--min-percent", 1, 0, NULL},
-        {"-u", "--num-points", 1, 0, NULL},
-        {"-a", "--radius", 1, 0, NULL},
-        {"-r", "--right-speed", 1, 0, NULL},
-        {"-o", "--second", 1, 0, NULL},
-        {"-h", "--side", 1, 0, NULL},
-        {"-e", "--step", 1, 0, NULL}
-    };
-    Elements elements = {36, 0, 25, commands, arguments, options};
-
-    *success = 1;
-    
-    ts = tokens_new(argc, argv);
-    if (parse_args(&ts, &elements))
-        *success = -1;//exit(EXIT_FAILURE);
-    if (elems_to_args(&elements, &args, help, version))
-        *success = 0;//exit(EXIT_SUCCESS);
-    
-    return args;
+    return is_ok ? pos : 0;
 }
@@ -1,87 +1,202 @@
+/* Generated by conparser.py from conparser.docopt.  Do not edit. */
 #ifndef CONPARSER_H
 #define CONPARSER_H
 
-#include <stdbool.h>
+#include "types.h"
+
+typedef enum {
+    CONPARSER_GROUP_MOTOR = 0x01,
+    CONPARSER_GROUP_PID = 0x02,
+    CONPARSER_GROUP_CONFIG = 0x04,
+    CONPARSER_GROUP_MOTION = 0x08,
+    CONPARSER_GROUP_JOBS = 0x10,
+    CONPARSER_GROUP_KILL = 0x20,
+    CONPARSER_GROUP_MACRO = 0x40,
+    CONPARSER_GROUP_HELP = 0x80
+} CONPARSER_GROUP_TYPE;
+
+typedef enum {
+    CONPARSER_ROUTE_NONE,
+    CONPARSER_ROUTE_MOTOR,
+    CONPARSER_ROUTE_MOTOR_REP,
+    CONPARSER_ROUTE_MOTOR_SHOW,
+    CONPARSER_ROUTE_MOTOR_CAL,
+    CONPARSER_ROUTE_MOTOR_VAL,
+    CONPARSER_ROUTE_MOTOR_HELP,
+    CONPARSER_ROUTE_PID_CAL,
+    CONPARSER_ROUTE_PID_VAL,
+    CONPARSER_ROUTE_PID_SHOW,
+    CONPARSER_ROUTE_PID_TUNE,
+    CONPARSER_ROUTE_PID_SCHED,
+    CONPARSER_ROUTE_PID_CASCADE,
+    CONPARSER_ROUTE_PID_HELP,
+    CONPARSER_ROUTE_CONFIG_DEBUG,
+    CONPARSER_ROUTE_CONFIG_SHOW,
+    CONPARSER_ROUTE_CONFIG_CLEAR,
+    CONPARSER_ROUTE_CONFIG_RATE,
+    CONPARSER_ROUTE_CONFIG_ACCEL,
+    CONPARSER_ROUTE_CONFIG_SHAPE,
+    CONPARSER_ROUTE_CONFIG_REFINE,
+    CONPARSER_ROUTE_CONFIG_BENCH,
+    CONPARSER_ROUTE_CONFIG_EXPORT,
+    CONPARSER_ROUTE_CONFIG_IMPORT,
+    CONPARSER_ROUTE_CONFIG_HELP,
+    CONPARSER_ROUTE_MOTION_CAL,
+    CONPARSER_ROUTE_MOTION_VAL,
+    CONPARSER_ROUTE_MOTION_PATH,
+    CONPARSER_ROUTE_MOTION_HELP,
+    CONPARSER_ROUTE_JOBS,
+    CONPARSER_ROUTE_KILL,
+    CONPARSER_ROUTE_MACRO_RECORD,
+    CONPARSER_ROUTE_MACRO_END,
+    CONPARSER_ROUTE_MACRO_RUN,
+    CONPARSER_ROUTE_MACRO_SHOW,
+    CONPARSER_ROUTE_MACRO_DELETE,
+    CONPARSER_ROUTE_MACRO_HELP,
+    CONPARSER_ROUTE_HELP,
+    CONPARSER_ROUTE_LAST
+} CONPARSER_ROUTE_TYPE;
+
+typedef enum {
+    CONPARSER_OK,
+    CONPARSER_UNKNOWN_WORD,
+    CONPARSER_MISSING_ARGUMENT,
+    CONPARSER_UNEXPECTED_ARGUMENT
+} CONPARSER_RESULT_TYPE;
 
 typedef struct {
     /* commands */
+    int abort;
+    int accel;
+    int add;
     int all;
     int angular;
     int backward;
+    int begin;
+    int bench;
     int bias;
     int cal;
+    int cascade;
     int ccw;
     int circle;
     int clear;
+    int commit;
     int config;
+    int curvature;
     int cw;
     int debug;
+    int delete;
     int disable;
     int enable;
+    int end;
+    int export;
     int forward;
     int help;
+    int import;
+    int jobs;
+    int kill;
     int left;
     int lenc;
     int linear;
     int lmotor;
     int lpid;
+    int macro;
     int motion;
     int motor;
     int odom;
     int out_and_back;
     int params;
+    int path;
     int pid;
+    int rate;
+    int record;
+    int refine;
     int renc;
     int rep;
     int right;
     int rmotor;
     int rpid;
+    int run;
+    int sched;
+    int shape;
     int show;
     int square;
+    int start;
     int status;
+    int stop;
+    int trace;
+    int tune;
     int umbmark;
     int val;
     /* options without arguments */
+    int binary;
     int impulse;
     int no_accel;
     int no_control;
     int no_pid;
+    int parallel;
     int plain_text;
+    int reset;
+    int save;
     int speed;
     int with_debug;
     /* options with arguments */
+    char *ang_accel;
+    char *ang_jerk;
     char *angle;
     char *angular_speed;
+    char *band;
+    char *cps;
+    char *data;
     char *distance;
     char *duration;
+    char *enc_rate;
     char *first;
+    char *gains;
+    char *id;
     char *intvl;
     char *iters;
     char *left_speed;
+    char *lin_accel;
+    char *lin_jerk;
     char *linear_speed;
+    char *lookahead;
     char *mask;
     char *max_percent;
     char *min_percent;
+    char *name;
     char *num_points;
+    char *odom_rate;
+    char *outer_rate;
+    char *pid_rate;
+    char *points;
     char *radius;
     char *right_speed;
+    char *rule;
     char *second;
     char *side;
     char *step;
     /* special */
-    const char *usage_pattern;
-    const char *help_message;
-    const char *motor_usage_pattern;
-    const char *motor_help_message;
-    const char *pid_usage_pattern;
-    const char *pid_help_message;
-    const char *config_usage_pattern;
-    const char *config_help_message;
-    const char *motion_usage_pattern;
-    const char *motion_help_message;
+    CONPARSER_ROUTE_TYPE route;
 } DocoptArgs;
 
-DocoptArgs docopt(int argc, char *argv[], bool help, const char *version, int* success);
+typedef struct {
+    const char *text;
+    UINT8 groups;
+} CONPARSER_HELP_TYPE;
+
+#define CONPARSER_NUM_USAGE (57)
+#define CONPARSER_NUM_OPTIONS (43)
+#define CONPARSER_SIGNATURE (0x622E)
+
+extern const char conparser_title[];
+extern const char * const conparser_routes[CONPARSER_ROUTE_LAST];
+extern const CONPARSER_HELP_TYPE conparser_usage[CONPARSER_NUM_USAGE];
+extern const CONPARSER_HELP_TYPE conparser_options[CONPARSER_NUM_OPTIONS];
 
+CONPARSER_RESULT_TYPE ConParser_Parse(char * const line, DocoptArgs * const args);
+UINT8 ConParser_Compile(DocoptArgs const * const args, UINT8 * const code, UINT8 size);
+CONPARSER_RESULT_TYPE ConParser_Load(UINT8 const * const code, UINT8 length, DocoptArgs * const args);
+UINT8 ConParser_Decompile(UINT8 const * const code, UINT8 length, char * const line, UINT8 size);
 
 #endif
@@ -1,47 +1,791 @@
 '''Usage:
-    conparser.py motor (--left-speed=<speed> | --right-speed=<speed> | --left-speed=<speed> --right-speed=<speed>) [--duration=<duration>]
-    conparser.py motor repeat [left|right] --first-speed=<speed> --second-speed=<speed> --interval=<interval>
-    conparser.py motor stop [left|right]
-    conparser.py motor show [--plain-text]
-    conparser.py motor cal [left|right] [--iters=<iters>] [--with-debug]
-    conparser.py motor val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]
-    conparser.py pid cal (left|right) ([--impulse] | [--step=<step>]) [--with-debug]
-    conparser.py pid val [left|right] (forward|backward) [--min-percent=<percent>] [--max-percent=<percent>] [--num-points=<points>]
-    conparser.py pid show [left|right] [--plain-text]
-    conparser.py config debug (enable|disable) ([lmotor|rmotor|lenc|renc|lpid|rpid|odom|all] | --mask=<mask>)
-    conparser.py config show [motor|encoder|pid|bias|debug] [--plain-text]
-    conparser.py config clear (motor|encoder|pid|bias|debug|all) [--plain-text]
-    conparser.py motion cal linear [--distance=<distance>]
-    conparser.py motion cal angular [--angle=<angle>]
-    conparser.py motion val linear [--distance=<distance>]
-    conparser.py motion val angular [--angle=<angle>]
-    conparser.py motion val square (left|right) [--side=<side>]
-    conparser.py motion val circle (cw|ccw) [--radius=<radius>]
-    conparser.py motion out-and-back [--distance=<distance>]
-    
+    conparser.py [generate] [--docopt=<file>] [--output=<name>]
+    conparser.py report [--docopt=<file>]
+
+Generates the console command parser (conparser.c/conparser.h) from the docopt
+description of the console commands.
+
+The generated parser is table driven:
+    * every command word and long option is found with a minimal perfect hash
+      (hash and displace) and written directly into DocoptArgs,
+    * short options are found with a direct lookup by letter,
+    * the first two command words select a route (e.g., CONPARSER_ROUTE_CONFIG_RATE)
+      which the dispatcher (disp.c) binds to the ConXXX_Init functions,
+    * the help text is stored once and filtered by command group at runtime,
+    * a parsed command can be compiled to a compact form (the route, the keyword
+      indices and the option arguments) and loaded again without parsing, e.g.,
+      the console macros (see macro.c).  CONPARSER_SIGNATURE changes whenever the
+      keyword or route tables do, so stale compiled commands can be detected.
+
+The report prints the size of the generated tables for a 32-bit target.
 
 Options:
-    --speed=<speed>          Speed of the motor (meter/second)
-    --duration=<duration>    Duration in seconds [default: 5]
-    --mask=<mask>            Bitmap of debug flags
-    --plain-text             Display output as plain text (default is JSON)
-    --with-debug             Enable PID debug output
-    --impulse                Enable impulse response
-    --distance=<distance>    Amount of travel (meter) [default: 1.0]
-    --angle=<angle>          Amount of travel (degree)   [default: 360] 
-    --iters=<iters>          Number of iterations per wheel [default: 3]
-    --step=<step>            Percentage of maximum speed to use for step response [default: 0.8]
-    --radius=<radius>        Radius of the circle [default: 0.0]
-    --side=<side>            Side of the square [default: 1.0]
-    --min-percent=<percent>  Minimum value for profile range specified in percent of maximum speed [default: 0.2]
-    --max-percent=<percent>  Maximum value for profile range specified in percent of maximum speed [default: 0.8]
-    --first-speed=<speed>    First speed of the cycle
-    --second-speed=<speed>   Second speed of the cycle
-    --interval=<interval>    Time between speed change
-    --num-points=<points>    Number of velocity values [default: 7]
+    --docopt=<file>     Docopt description of the console [default: conparser.docopt]
+    --output=<name>     Base name of the generated files [default: conparser]
+'''
+
+import re
+
+
+HEADER = '/* Generated by conparser.py from %s.  Do not edit. */\n'
+
+TOKEN_RE = re.compile(r'--[\w-]+(?:=<[^>]+>)?|-\w|<[^>]+>|[\w-]+|[()\[\]|]')
+OPTION_RE = re.compile(r'^\s+(?:(-\w)\s+)?(--[\w-]+)(=<[^>]+>)?\s{2,}(.*)$')
+DEFAULT_RE = re.compile(r'\[default: ([^\]]+)\]')
+
+KW_COMMAND = 'KW_COMMAND'
+KW_FLAG = 'KW_FLAG'
+KW_OPTION = 'KW_OPTION'
+
+NO_KEYWORD = 0xFF
+
+FNV_BASIS = 0x811C9DC5
+FNV_PRIME = 0x01000193
+
+
+class Option(object):
+
+    def __init__(self, short, long, has_arg, help_line=None, default=None):
+        self.short = short
+        self.long = long
+        self.has_arg = has_arg
+        self.help_line = help_line
+        self.default = default
+        self.groups = 0
+
+    @property
+    def field(self):
+        return c_name(self.long[2:])
+
+
+class Console(object):
+
+    def __init__(self, text):
+        self.title = ''
+        self.usage = []         # (text, group)
+        self.options = []       # Option, in the order of the Options section
+        self.commands = set()
+        self.groups = []
+        self.routes = []        # (group, sub or None)
+        self._parse(text)
+
+    def _parse(self, text):
+        section = None
+        title = []
+        for line in text.splitlines():
+            if line.startswith('Usage:'):
+                section = 'usage'
+            elif line.startswith('Options:'):
+                section = 'options'
+            elif section is None:
+                if line.strip():
+                    title.append(line.strip())
+            elif section == 'usage' and line.strip():
+                self._parse_usage(line.strip())
+            elif section == 'options':
+                self._parse_option(line)
+        self.title = ' '.join(title)
+        self._add_usage_options()
+
+    def _parse_usage(self, line):
+        tokens = TOKEN_RE.findall(line)[1:]     # drop the program name
+        text = line.split(None, 1)[1]
+        words = [t for t in tokens if re.match(r'^[\w][\w-]*$', t)]
+        group = tokens[0]
+        if group not in self.groups:
+            self.groups.append(group)
+        self.commands.update(words)
+        sub = tokens[1] if len(tokens) > 1 and re.match(r'^[\w][\w-]*$', tokens[1]) else None
+        if (group, sub) not in self.routes:
+            self.routes.append((group, sub))
+        self.usage.append((text, group, tokens))
+
+    def _parse_option(self, line):
+        match = OPTION_RE.match(line)
+        if match:
+            short, long, arg, description = match.groups()
+            default = DEFAULT_RE.search(description)
+            self.options.append(Option(short, long, arg is not None, line[4:],
+                                       default.group(1) if default else None))
+
+    def _add_usage_options(self):
+        '''Options can be used in the usage without a description, e.g. --speed'''
+        known = dict((o.long, o) for o in self.options)
+        for text, group, tokens in self.usage:
+            for token in tokens:
+                if token.startswith('--'):
+                    long = token.split('=')[0]
+                    if long not in known:
+                        known[long] = Option(None, long, '=' in token)
+                        self.options.append(known[long])
+                    known[long].groups |= self.group_bit(group)
+
+    def group_bit(self, group):
+        return 1 << self.groups.index(group)
+
+    @property
+    def flags(self):
+        return sorted([o for o in self.options if not o.has_arg], key=lambda o: o.long)
+
+    @property
+    def arg_options(self):
+        return sorted([o for o in self.options if o.has_arg], key=lambda o: o.long)
+
+
+def c_name(name):
+    return name.replace('-', '_')
+
+
+def c_string(s):
+    return '"%s"' % s.replace('\\', '\\\\').replace('"', '\\"')
+
+
+def route_name(group, sub):
+    name = 'CONPARSER_ROUTE_' + c_name(group).upper()
+    if sub:
+        name += '_' + c_name(sub).upper()
+    return name
+
+
+def group_name(group):
+    return 'CONPARSER_GROUP_' + c_name(group).upper()
+
+
+def fnv_hash(seed, key):
+    '''Must match hash() in the generated parser'''
+    h = (seed ^ FNV_BASIS) & 0xFFFFFFFF
+    for c in key.encode():
+        h = ((h ^ c) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def signature(keywords, slots, routes):
+    '''Folds the keyword table and the route order into 16 bits; compiled commands refer to both by index'''
+    h = 0
+    for key in slots:
+        h = fnv_hash(h, '%s:%s' % (key, keywords[key][0]))
+    for group, sub in routes:
+        h = fnv_hash(h, '%s %s' % (group, sub or ''))
+    return ((h >> 16) ^ h) & 0xFFFF
+
+
+def perfect_hash(keys):
+    '''Hash and displace: a key is placed at hash(displace[hash(0, key) % n], key) % n or, for a bucket with a
+       single key, directly at slot -displace - 1.  Returns the displacements and the keys in slot order.
+    '''
+    n = len(keys)
+    buckets = [[] for _ in range(n)]
+    for key in keys:
+        buckets[fnv_hash(0, key) % n].append(key)
+
+    displace = [0] * n
+    slots = [None] * n
+    for bucket in sorted(range(n), key=lambda b: -len(buckets[b])):
+        items = buckets[bucket]
+        if len(items) <= 1:
+            break
+        seed = 1
+        while True:
+            placed = [fnv_hash(seed, key) % n for key in items]
+            if len(set(placed)) == len(placed) and all(slots[p] is None for p in placed):
+                break
+            seed += 1
+        for key, p in zip(items, placed):
+            slots[p] = key
+        displace[bucket] = seed
+
+    free = [i for i in range(n) if slots[i] is None]
+    for bucket in range(n):
+        if len(buckets[bucket]) == 1:
+            p = free.pop()
+            slots[p] = buckets[bucket][0]
+            displace[bucket] = -p - 1
+
+    return displace, slots
+
+
+class Generator(object):
+
+    def __init__(self, console, source):
+        self.console = console
+        self.source = source
+
+        self.keywords = {}
+        for command in sorted(console.commands):
+            self.keywords[command] = (KW_COMMAND, c_name(command))
+        for option in console.options:
+            self.keywords[option.long] = (KW_OPTION if option.has_arg else KW_FLAG, option.field)
+        self.displace, self.slots = perfect_hash(sorted(self.keywords))
+        self.index = dict((key, i) for i, key in enumerate(self.slots))
+
+    def header(self, name):
+        c = self.console
+        out = [HEADER % self.source]
+        out.append('#ifndef %s_H\n#define %s_H\n\n#include "types.h"\n\n' % (name.upper(), name.upper()))
+
+        out.append('typedef enum {\n')
+        out.append(',\n'.join('    %s = 0x%02X' % (group_name(g), c.group_bit(g)) for g in c.groups))
+        out.append('\n} CONPARSER_GROUP_TYPE;\n\n')
+
+        out.append('typedef enum {\n    CONPARSER_ROUTE_NONE,\n')
+        out.append(''.join('    %s,\n' % route_name(g, s) for g, s in c.routes))
+        out.append('    CONPARSER_ROUTE_LAST\n} CONPARSER_ROUTE_TYPE;\n\n')
+
+        out.append('typedef enum {\n'
+                   '    CONPARSER_OK,\n'
+                   '    CONPARSER_UNKNOWN_WORD,\n'
+                   '    CONPARSER_MISSING_ARGUMENT,\n'
+                   '    CONPARSER_UNEXPECTED_ARGUMENT\n'
+                   '} CONPARSER_RESULT_TYPE;\n\n')
+
+        out.append('typedef struct {\n    /* commands */\n')
+        out.append(''.join('    int %s;\n' % c_name(w) for w in sorted(c.commands)))
+        out.append('    /* options without arguments */\n')
+        out.append(''.join('    int %s;\n' % o.field for o in c.flags))
+        out.append('    /* options with arguments */\n')
+        out.append(''.join('    char *%s;\n' % o.field for o in c.arg_options))
+        out.append('    /* special */\n    CONPARSER_ROUTE_TYPE route;\n} DocoptArgs;\n\n')
+
+        out.append('typedef struct {\n    const char *text;\n    UINT8 groups;\n} CONPARSER_HELP_TYPE;\n\n')
+        out.append('#define CONPARSER_NUM_USAGE (%d)\n' % len(c.usage))
+        out.append('#define CONPARSER_NUM_OPTIONS (%d)\n' % len([o for o in c.options if o.help_line]))
+        out.append('#define CONPARSER_SIGNATURE (0x%04X)\n\n' % signature(self.keywords, self.slots, c.routes))
+        out.append('extern const char conparser_title[];\n')
+        out.append('extern const char * const conparser_routes[CONPARSER_ROUTE_LAST];\n')
+        out.append('extern const CONPARSER_HELP_TYPE conparser_usage[CONPARSER_NUM_USAGE];\n')
+        out.append('extern const CONPARSER_HELP_TYPE conparser_options[CONPARSER_NUM_OPTIONS];\n\n')
+        out.append('CONPARSER_RESULT_TYPE ConParser_Parse(char * const line, DocoptArgs * const args);\n')
+        out.append('UINT8 ConParser_Compile(DocoptArgs const * const args, UINT8 * const code, UINT8 size);\n')
+        out.append('CONPARSER_RESULT_TYPE ConParser_Load(UINT8 const * const code, UINT8 length, DocoptArgs * const args);\n')
+        out.append('UINT8 ConParser_Decompile(UINT8 const * const code, UINT8 length, char * const line, UINT8 size);\n\n')
+        out.append('#endif\n')
+        return ''.join(out)
+
+    def source_file(self, name):
+        c = self.console
+        n = len(self.slots)
+        out = [HEADER % self.source]
+        out.append('#include <stddef.h>\n#include <string.h>\n#include "%s.h"\n\n' % name)
+        out.append('#define KW_COMMAND (0)\n#define KW_FLAG (1)\n#define KW_OPTION (2)\n\n')
+        out.append('#define NUM_KEYWORDS (%d)\n#define NO_KEYWORD (0x%02X)\n\n' % (n, NO_KEYWORD))
+        out.append('#define ARG_INT(args, offset) (*(int *) ((UINT8 *) (args) + (offset)))\n')
+        out.append('#define ARG_STR(args, offset) (*(char **) ((UINT8 *) (args) + (offset)))\n\n')
+
+        out.append('typedef struct {\n    const char *name;\n    UINT8 kind;\n    UINT16 offset;\n} KEYWORD_TYPE;\n\n')
+        out.append('typedef struct {\n    UINT8 group;\n    UINT8 sub;\n    UINT8 route;\n} ROUTE_TYPE;\n\n')
+        out.append('typedef struct {\n    UINT16 offset;\n    const char *value;\n} DEFAULT_TYPE;\n\n')
+
+        out.append('const char conparser_title[] = %s;\n\n' % c_string(c.title))
+
+        out.append('const char * const conparser_routes[CONPARSER_ROUTE_LAST] = {\n    "",\n')
+        out.append(',\n'.join('    %s' % c_string(g + (' ' + s if s else '')) for g, s in c.routes))
+        out.append('\n};\n\n')
+
+        out.append('const CONPARSER_HELP_TYPE conparser_usage[CONPARSER_NUM_USAGE] = {\n')
+        out.append(',\n'.join('    {%s, %s}' % (c_string(text), group_name(group)) for text, group, _ in c.usage))
+        out.append('\n};\n\n')
+
+        out.append('const CONPARSER_HELP_TYPE conparser_options[CONPARSER_NUM_OPTIONS] = {\n')
+        out.append(',\n'.join('    {%s, 0x%02X}' % (c_string(o.help_line), o.groups) for o in c.options if o.help_line))
+        out.append('\n};\n\n')
+
+        out.append('static const INT16 displace[NUM_KEYWORDS] = {\n')
+        out.append(wrap(['%d' % d for d in self.displace]))
+        out.append('};\n\n')
+
+        out.append('static const KEYWORD_TYPE keywords[NUM_KEYWORDS] = {\n')
+        entries = []
+        for key in self.slots:
+            kind, field = self.keywords[key]
+            entries.append('    {%s, %s, offsetof(DocoptArgs, %s)}' % (c_string(key), kind, field))
+        out.append(',\n'.join(entries))
+        out.append('\n};\n\n')
+
+        shorts = dict((o.short[1], self.index[o.long]) for o in c.options if o.short)
+        out.append('/* Short options by letter, a - z */\n')
+        out.append('static const UINT8 short_options[26] = {\n')
+        out.append(wrap(['0x%02X' % shorts.get(chr(ord('a') + i), NO_KEYWORD) for i in range(26)]))
+        out.append('};\n\n')
+
+        defaults = [o for o in c.arg_options if o.default is not None]
+        out.append('static const DEFAULT_TYPE defaults[%d] = {\n' % len(defaults))
+        out.append(',\n'.join('    {offsetof(DocoptArgs, %s), %s}' % (o.field, c_string(o.default)) for o in defaults))
+        out.append('\n};\n\n')
+
+        # Routes with a sub-command are matched before the group fallback, e.g. 'motor rep' before 'motor'
+        routes = sorted(c.routes, key=lambda r: r[1] is None)
+        out.append('static const ROUTE_TYPE routes[%d] = {\n' % len(routes))
+        out.append(',\n'.join('    {0x%02X, 0x%02X, %s}' % (self.index[g], self.index[s] if s else NO_KEYWORD, route_name(g, s))
+                              for g, s in routes))
+        out.append('\n};\n\n')
+
+        out.append(PARSER_CODE)
+        out.append(COMPILER_CODE)
+        return ''.join(out)
+
+    def report(self):
+        c = self.console
+        strings = sum(len(k) + 1 for k in self.slots)
+        help_text = len(c.title) + 1 + sum(len(t) + 1 for t, _, _ in c.usage) + \
+                    sum(len(o.help_line) + 1 for o in c.options if o.help_line)
+        defaults = [o for o in c.arg_options if o.default is not None]
+        rows = [
+            ('keyword table', 8 * len(self.slots)),
+            ('keyword names', strings),
+            ('displacements', 2 * len(self.displace)),
+            ('short options', 26),
+            ('routes', 3 * len(c.routes)),
+            ('route names', 4 * (len(c.routes) + 1) + sum(len(g) + (len(s) + 1 if s else 0) + 1 for g, s in c.routes) + 1),
+            ('defaults', 8 * len(defaults) + sum(len(o.default) + 1 for o in defaults)),
+            ('help tables', 8 * (len(c.usage) + len([o for o in c.options if o.help_line]))),
+            ('help text', help_text),
+        ]
+        print('Flash (32-bit target):')
+        for label, size in rows:
+            print('    %-16s %6d bytes' % (label, size))
+        print('    %-16s %6d bytes' % ('total', sum(size for _, size in rows)))
+        print('RAM:')
+        print('    %-16s %6d bytes' % ('DocoptArgs', 4 * (len(c.commands) + len(c.flags) + len(c.arg_options) + 1)))
+        print('    %-16s %6d bytes' % ('static', 0))
+        print('Keywords: %d, routes: %d' % (len(self.slots), len(c.routes)))
+
+
+def wrap(values, per_line=12):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(values[i:i + per_line]))
+    return ',\n'.join(lines) + '\n'
+
+
+PARSER_CODE = r'''static UINT32 hash(UINT32 seed, const char *str)
+{
+    UINT32 h = seed ^ 0x%08XUL;
+
+    while (*str)
+    {
+        h = (h ^ (UINT8) *str++) * 0x%08XUL;
+    }
+
+    return h;
+}
+
+static UINT8 find_keyword(const char *name)
+{
+    INT16 d;
+    UINT8 index;
+
+    d = displace[hash(0, name) %% NUM_KEYWORDS];
+    index = d < 0 ? (UINT8) (-d - 1) : (UINT8) (hash((UINT32) d, name) %% NUM_KEYWORDS);
+
+    return strcmp(keywords[index].name, name) == 0 ? index : NO_KEYWORD;
+}
+
+/* Long options can be abbreviated to a unique prefix, e.g., --dur=5 */
+static UINT8 find_option_prefix(const char *name)
+{
+    UINT8 ii;
+    UINT8 found = NO_KEYWORD;
+    size_t length = strlen(name);
+
+    for (ii = 0; ii < NUM_KEYWORDS; ++ii)
+    {
+        if (keywords[ii].kind != KW_COMMAND && strncmp(keywords[ii].name, name, length) == 0)
+        {
+            if (found != NO_KEYWORD)
+            {
+                return NO_KEYWORD;
+            }
+            found = ii;
+        }
+    }
+
+    return found;
+}
+
+static char * next_token(char **next)
+{
+    char *token = *next;
+
+    while (*token == ' ')
+    {
+        token++;
+    }
+
+    if (*token == '\0')
+    {
+        return NULL;
+    }
+
+    *next = token;
+    while (**next != ' ' && **next != '\0')
+    {
+        (*next)++;
+    }
+
+    if (**next == ' ')
+    {
+        **next = '\0';
+        (*next)++;
+    }
+
+    return token;
+}
+
+static CONPARSER_RESULT_TYPE set_option(DocoptArgs * const args, UINT8 index, char *value, char **next)
+{
+    if (keywords[index].kind == KW_FLAG)
+    {
+        if (value != NULL)
+        {
+            return CONPARSER_UNEXPECTED_ARGUMENT;
+        }
+        ARG_INT(args, keywords[index].offset) = 1;
+        return CONPARSER_OK;
+    }
+
+    if (value == NULL)
+    {
+        value = next_token(next);
+        if (value == NULL)
+        {
+            return CONPARSER_MISSING_ARGUMENT;
+        }
+    }
+    ARG_STR(args, keywords[index].offset) = value;
+
+    return CONPARSER_OK;
+}
+
+static CONPARSER_RESULT_TYPE parse_short(DocoptArgs * const args, char *token, char **next)
+{
+    UINT8 index;
+    CONPARSER_RESULT_TYPE result;
+
+    for (; *token != '\0'; ++token)
+    {
+        index = *token >= 'a' && *token <= 'z' ? short_options[*token - 'a'] : NO_KEYWORD;
+        if (index == NO_KEYWORD)
+        {
+            return CONPARSER_UNKNOWN_WORD;
+        }
+
+        if (keywords[index].kind == KW_OPTION)
+        {
+            /* The rest of the token, if any, is the argument, e.g., -d5 */
+            return set_option(args, index, token[1] != '\0' ? token + 1 : NULL, next);
+        }
+
+        result = set_option(args, index, NULL, next);
+        if (result != CONPARSER_OK)
+        {
+            return result;
+        }
+    }
+
+    return CONPARSER_OK;
+}
+
+static void set_defaults(DocoptArgs * const args)
+{
+    UINT8 ii;
+
+    memset(args, 0, sizeof *args);
+    for (ii = 0; ii < sizeof defaults / sizeof defaults[0]; ++ii)
+    {
+        ARG_STR(args, defaults[ii].offset) = (char *) defaults[ii].value;
+    }
+}
+
+static CONPARSER_ROUTE_TYPE find_route(UINT8 group, UINT8 sub)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < sizeof routes / sizeof routes[0]; ++ii)
+    {
+        if (routes[ii].group == group && (routes[ii].sub == sub || routes[ii].sub == NO_KEYWORD))
+        {
+            return (CONPARSER_ROUTE_TYPE) routes[ii].route;
+        }
+    }
+
+    return CONPARSER_ROUTE_NONE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ConParser_Parse
+ * Description: Parses a console line into args.  The line is tokenized in place and the option
+ *              arguments point into the line.  The first two command words select the route.
+ * Parameters: line - the console line (modified)
+ *             args - the parsed commands, options and route
+ * Return: CONPARSER_OK if all words and options are known, otherwise the reason for the failure
+ *
+ *-------------------------------------------------------------------------------------------------*/
+CONPARSER_RESULT_TYPE ConParser_Parse(char * const line, DocoptArgs * const args)
+{
+    char *next = line;
+    char *token;
+    char *value;
+    UINT8 index;
+    UINT8 commands[2] = {NO_KEYWORD, NO_KEYWORD};
+    UINT8 num_commands = 0;
+    CONPARSER_RESULT_TYPE result;
+
+    set_defaults(args);
+
+    while ((token = next_token(&next)) != NULL)
+    {
+        if (token[0] == '-' && token[1] == '-')
+        {
+            value = strchr(token, '=');
+            if (value != NULL)
+            {
+                *value++ = '\0';
+            }
+
+            index = find_keyword(token);
+            if (index == NO_KEYWORD)
+            {
+                index = find_option_prefix(token);
+            }
+            if (index == NO_KEYWORD || keywords[index].kind == KW_COMMAND)
+            {
+                return CONPARSER_UNKNOWN_WORD;
+            }
+
+            result = set_option(args, index, value, &next);
+        }
+        else if (token[0] == '-' && token[1] != '\0')
+        {
+            result = parse_short(args, token + 1, &next);
+        }
+        else
+        {
+            index = find_keyword(token);
+            if (index == NO_KEYWORD || keywords[index].kind != KW_COMMAND)
+            {
+                return CONPARSER_UNKNOWN_WORD;
+            }
+
+            ARG_INT(args, keywords[index].offset) = 1;
+            if (num_commands < 2)
+            {
+                commands[num_commands++] = index;
+            }
+            result = CONPARSER_OK;
+        }
+
+        if (result != CONPARSER_OK)
+        {
+            return result;
+        }
+    }
+
+    args->route = find_route(commands[0], commands[1]);
+
+    return CONPARSER_OK;
+}
+''' % (FNV_BASIS, FNV_PRIME)
+
+COMPILER_CODE = r'''
+/* A compiled command is the route followed by the index of each keyword that is set and, for an option with an
+   argument, the argument as a NUL-terminated string.  Arguments that are still the default are not stored.
+*/
+static BOOL is_default(UINT16 offset, const char *value)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < sizeof defaults / sizeof defaults[0]; ++ii)
+    {
+        if (defaults[ii].offset == offset && defaults[ii].value == value)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static BOOL append(char * const line, UINT8 * const pos, UINT8 size, const char *text)
+{
+    size_t length = strlen(text);
+
+    if (*pos + length >= size)
+    {
+        return FALSE;
+    }
+
+    memcpy(&line[*pos], text, length + 1);
+    *pos += (UINT8) length;
+
+    return TRUE;
+}
+
+UINT8 ConParser_Compile(DocoptArgs const * const args, UINT8 * const code, UINT8 size)
+{
+    UINT8 ii;
+    UINT8 length = 0;
+    const char *value;
+    size_t value_length;
+
+    if (size == 0 || args->route == CONPARSER_ROUTE_NONE)
+    {
+        return 0;
+    }
+
+    code[length++] = (UINT8) args->route;
+    for (ii = 0; ii < NUM_KEYWORDS; ++ii)
+    {
+        if (keywords[ii].kind == KW_OPTION)
+        {
+            value = ARG_STR(args, keywords[ii].offset);
+            if (value == NULL || is_default(keywords[ii].offset, value))
+            {
+                continue;
+            }
+
+            value_length = strlen(value) + 1;
+            if (length + 1 + value_length > size)
+            {
+                return 0;
+            }
+
+            code[length++] = ii;
+            memcpy(&code[length], value, value_length);
+            length += (UINT8) value_length;
+        }
+        else if (ARG_INT(args, keywords[ii].offset))
+        {
+            if (length + 1 > size)
+            {
+                return 0;
+            }
+
+            code[length++] = ii;
+        }
+    }
+
+    return length;
+}
+
+/* The option arguments point into the code, so it must outlive the command */
+CONPARSER_RESULT_TYPE ConParser_Load(UINT8 const * const code, UINT8 length, DocoptArgs * const args)
+{
+    UINT8 pos = 1;
+    UINT8 index;
+    UINT8 const *end;
+
+    set_defaults(args);
+
+    if (length == 0 || code[0] == CONPARSER_ROUTE_NONE || code[0] >= CONPARSER_ROUTE_LAST)
+    {
+        return CONPARSER_UNKNOWN_WORD;
+    }
+
+    while (pos < length)
+    {
+        index = code[pos++];
+        if (index >= NUM_KEYWORDS)
+        {
+            return CONPARSER_UNKNOWN_WORD;
+        }
+
+        if (keywords[index].kind == KW_OPTION)
+        {
+            end = pos < length ? memchr(&code[pos], '\0', length - pos) : NULL;
+            if (end == NULL)
+            {
+                return CONPARSER_MISSING_ARGUMENT;
+            }
+
+            ARG_STR(args, keywords[index].offset) = (char *) &code[pos];
+            pos = (UINT8) (end - code + 1);
+        }
+        else
+        {
+            ARG_INT(args, keywords[index].offset) = 1;
+        }
+    }
+
+    args->route = (CONPARSER_ROUTE_TYPE) code[0];
+
+    return CONPARSER_OK;
+}
+
+/* Writes the compiled command back as a command line, e.g., for listing, and returns its length (0 on error) */
+UINT8 ConParser_Decompile(UINT8 const * const code, UINT8 length, char * const line, UINT8 size)
+{
+    UINT8 ii;
+    UINT8 pos = 0;
+    UINT8 index;
+    UINT8 group = NO_KEYWORD;
+    UINT8 sub = NO_KEYWORD;
+    BOOL is_ok;
+
+    if (size == 0 || length == 0 || code[0] == CONPARSER_ROUTE_NONE || code[0] >= CONPARSER_ROUTE_LAST)
+    {
+        return 0;
+    }
+
+    /* The route name already has the leading command words */
+    for (ii = 0; ii < sizeof routes / sizeof routes[0]; ++ii)
+    {
+        if (routes[ii].route == code[0])
+        {
+            group = routes[ii].group;
+            sub = routes[ii].sub;
+            break;
+        }
+    }
+
+    line[0] = '\0';
+    is_ok = append(line, &pos, size, conparser_routes[code[0]]);
+
+    ii = 1;
+    while (is_ok && ii < length)
+    {
+        index = code[ii++];
+        if (index >= NUM_KEYWORDS)
+        {
+            return 0;
+        }
+
+        if (index == group || index == sub)
+        {
+            continue;
+        }
+
+        is_ok = append(line, &pos, size, " ") && append(line, &pos, size, keywords[index].name);
+
+        if (is_ok && keywords[index].kind == KW_OPTION)
+        {
+            if (ii >= length || memchr(&code[ii], '\0', length - ii) == NULL)
+            {
+                return 0;
+            }
+
+            is_ok = append(line, &pos, size, "=") && append(line, &pos, size, (const char *) &code[ii]);
+            ii += (UINT8) (strlen((const char *) &code[ii]) + 1);
+        }
+    }
+
+    return is_ok ? pos : 0;
+}
 '''
 
+
 if __name__ == "__main__":
     import docopt
-    
-    print(docopt.docopt(__doc__))
\ No newline at end of file
+
+    args = docopt.docopt(__doc__)
+    source = args['--docopt']
+    console = Console(open(source).read())
+    generator = Generator(console, source)
+
+    if args['report']:
+        generator.report()
+    else:
+        name = args['--output']
+        with open(name + '.h', 'w') as f:
+            f.write(generator.header(name))
+        with open(name + '.c', 'w') as f:
+            f.write(generator.source_file(name))
@@ -5,21 +5,24 @@
 #include "cal.h"
 #include "calstore.h"
 #include "calpid.h"
+#include "caltune.h"
 #include "control.h"
 #include "encoder.h"
 #include "odom.h"
 #include "pid.h"
-#include "pidleft.h"
-#include "pidright.h"
+#include "rate.h"
+#include "pidbank.h"
 #include "valpid.h"
 #include "utils.h"
 #include "debug.h"
+#include "emit.h"
 #include "assertion.h"
 
 typedef struct _tag_pid_show
 {
     WHEEL_TYPE wheel;
     BOOL as_json;
+    EMIT_STREAM_TYPE stream;
 } PID_SHOW_TYPE;
 
 typedef struct _tag_pid_cal
@@ -28,6 +31,7 @@ typedef struct _tag_pid_cal
     BOOL impulse;
     FLOAT step;
     BOOL with_debug;
+    BOOL binary;
 } PID_CAL_TYPE;
 
 typedef struct _tag_pid_val
@@ -39,13 +43,36 @@ typedef struct _tag_pid_val
     UINT8 num_points;
 } PID_VAL_TYPE;
 
-typedef enum {PID_SHOW, PID_CAL, PID_VAL, PID_LAST} PID_CMD_TYPE;
+typedef struct _tag_pid_tune
+{
+    WHEEL_TYPE wheel;
+    CAL_TUNE_RULE_TYPE rule;
+} PID_TUNE_TYPE;
+
+typedef struct _tag_pid_sched
+{
+    WHEEL_TYPE wheel;
+    BOOL clear;
+    CAL_PID_SCHED_TYPE sched;
+} PID_SCHED_TYPE;
+
+typedef struct _tag_pid_cascade
+{
+    CONPID_CASCADE_ACTION_TYPE action;
+    UINT8 mask;
+    BOOL as_json;
+} PID_CASCADE_TYPE;
+
+typedef enum {PID_SHOW, PID_CAL, PID_VAL, PID_TUNE, PID_SCHED, PID_CASCADE, PID_LAST} PID_CMD_TYPE;
     
 
 static BOOL is_running;
 static PID_SHOW_TYPE pid_show;
 static PID_CAL_TYPE pid_cal;
 static PID_VAL_TYPE pid_val;
+static PID_TUNE_TYPE pid_tune;
+static PID_SCHED_TYPE pid_sched;
+static PID_CASCADE_TYPE pid_cascade;
 
 static CONCMD_IF_TYPE cmd_if_array[PID_LAST];
 
@@ -59,23 +86,13 @@ static CONCMD_IF_PTR_TYPE pid_show_init(WHEEL_TYPE wheel, BOOL plain_text)
 
     pid_show.wheel = wheel;
     pid_show.as_json = !plain_text;
+    Emit_StreamInit(&pid_show.stream);
     
     is_running = TRUE;
     return &cmd_if_array[PID_SHOW];
 }
 
-static BOOL pid_show_update(void)
-{
-    is_running = FALSE;
-    return is_running;
-}
-
-static BOOL pid_show_status(void)
-{
-    return is_running;
-}
-
-static void pid_show_results(void)
+static void pid_show_emit(void)
 {
     switch (pid_show.wheel)
     {
@@ -93,10 +110,40 @@ static void pid_show_results(void)
     }
 }
 
+static BOOL pid_show_update(void)
+{
+    is_running = Emit_Chunk(&pid_show.stream, pid_show_emit);
+    return is_running;
+}
+
+static BOOL pid_show_status(void)
+{
+    return is_running;
+}
+
+static void pid_show_stop(void)
+{
+    Emit_Cancel(&pid_show.stream);
+    is_running = FALSE;
+}
+
+/* Note: Shared by the commands that drive the motors (cal, val and tune).  It is only called when a
+   command is killed.
+*/
+static void pid_stop(void)
+{
+    Control_SetLeftRightVelocityCps(0, 0);
+    Control_SetLeftRightVelocityOverride(FALSE);
+    Control_OverrideDebug(FALSE);
+    CalPid_Release();
+
+    is_running = FALSE;
+}
+
 /*----------------------------------------------------------------------------
     PID Calibration Routines
 */
-static CONCMD_IF_PTR_TYPE pid_cal_init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL with_debug)
+static CONCMD_IF_PTR_TYPE pid_cal_init(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL with_debug, BOOL binary)
 {
     Ser_WriteLine("PID Calibration Init", TRUE);
 
@@ -109,16 +156,24 @@ static CONCMD_IF_PTR_TYPE pid_cal_init(WHEEL_TYPE wheel, BOOL impulse, FLOAT ste
     pid_cal.wheel = wheel;
     pid_cal.impulse = impulse;
     pid_cal.step = step;
-    pid_cal.with_debug = TRUE; //with_debug;
+    pid_cal.with_debug = with_debug;
+    pid_cal.binary = binary;
 
-    Ser_PutStringFormat("wheel: %s impulse: %d, step: %.3f, with_debug: %d\r\n", 
+    Ser_PutStringFormat("wheel: %s impulse: %d, step: %.3f, with_debug: %d, binary: %d\r\n", 
                         WheelToString(pid_cal.wheel, FORMAT_LOWER), 
                         pid_cal.impulse, 
                         pid_cal.step, 
-                        pid_cal.with_debug); 
+                        pid_cal.with_debug,
+                        pid_cal.binary); 
 
-    /* Note: By default, calibration should always have debug.  Change the console arguments to use --no-debug instead of --with-debug */
-    CalPid_Init(wheel, impulse, step, !pid_cal.with_debug);
+    /* Note: The response is captured in RAM and dumped in the results, so the per-sample debug output
+       is only needed to watch the response live (and it perturbs the response).
+     */
+    if (!CalPid_Init(wheel, impulse, step, !pid_cal.with_debug))
+    {
+        Ser_WriteLine("Calibration buffers not available", TRUE);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
 
     is_running = TRUE;
     return &cmd_if_array[PID_CAL];
@@ -153,12 +208,12 @@ static void pid_cal_results(void)
     switch (pid_cal.wheel)
     {
         case WHEEL_LEFT:
-            LeftPid_GetGains(&gains[0], &gains[1], &gains[2], &gains[3]);
+            PidBank_GetGains(PID_TYPE_LEFT, &gains[0], &gains[1], &gains[2], &gains[3]);
             Cal_SetGains(PID_TYPE_LEFT, gains);
             break;
             
         case WHEEL_RIGHT:
-            RightPid_GetGains(&gains[0], &gains[1], &gains[2], &gains[3]);
+            PidBank_GetGains(PID_TYPE_RIGHT, &gains[0], &gains[1], &gains[2], &gains[3]);
             Cal_SetGains(PID_TYPE_RIGHT, gains);
             break;
 
@@ -185,6 +240,10 @@ static void pid_cal_results(void)
             break;
     }    
 
+    /* Note: The motors are stopped, so the dump does not disturb the response */
+    CalPid_DumpCapture(pid_cal.binary);
+    CalPid_Release();
+
     /* Note: I want to calculate these parameters after each calibration run
     https://www.mathworks.com/help/control/ref/stepinfo.html?requestedDomain=www.mathworks.com    
     http://www.mee.tcd.ie/~corrigad/3c1/control_ho2_2012_students.pdf
@@ -236,6 +295,374 @@ static void pid_val_results(void)
     ValPid_Results();
 }
 
+/*----------------------------------------------------------------------------
+    PID Auto-Tune Routines
+*/
+static CONCMD_IF_PTR_TYPE pid_tune_init(WHEEL_TYPE wheel, CHAR* const rule)
+{
+    if (!Cal_GetCalibrationStatusBit(CAL_MOTOR_BIT))
+    {
+        Ser_PutStringFormat("Motor calibration not performed (%02x)\r\n", Cal_GetStatus());
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    if (wheel != WHEEL_LEFT && wheel != WHEEL_RIGHT)
+    {
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    if (!CalTune_ParseRule(rule, &pid_tune.rule))
+    {
+        Ser_PutStringFormat("Unknown tuning rule: %s\r\n", rule);
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    pid_tune.wheel = wheel;
+
+    CalTune_Init(pid_tune.wheel, pid_tune.rule);
+
+    is_running = TRUE;
+    return &cmd_if_array[PID_TUNE];
+}
+
+static BOOL pid_tune_update(void)
+{
+    UINT8 result;
+
+    result = CalTune_Update();
+    is_running = result == CAL_OK;
+
+    return is_running;
+}
+
+static BOOL pid_tune_status(void)
+{
+    return is_running;
+}
+
+static void pid_tune_results(void)
+{
+    CAL_TUNE_RESULT_TYPE *p_result;
+    PID_ENUM_TYPE pid;
+    FLOAT gains[4];
+
+    Control_SetLeftRightVelocityCps(0, 0);
+    Control_SetLeftRightVelocityOverride(FALSE);
+
+    p_result = CalTune_GetResult();
+    if (!p_result->valid)
+    {
+        Ser_PutStringFormat("\r\n%s PID auto-tune failed, gains not changed\r\n", pid_tune.wheel == WHEEL_LEFT ? "Left" : "Right");
+        return;
+    }
+
+    Ser_PutStringFormat("\r\n%s PID auto-tune complete\r\n", pid_tune.wheel == WHEEL_LEFT ? "Left" : "Right");
+    Ser_PutStringFormat("ku: %.3f, tu: %.3f sec, amplitude: %.1f cps, cycles: %d\r\n", 
+                        p_result->ku, p_result->tu, p_result->amplitude, p_result->num_cycles);
+
+    pid = pid_tune.wheel == WHEEL_LEFT ? PID_TYPE_LEFT : PID_TYPE_RIGHT;
+    gains[0] = p_result->gains.kp;
+    gains[1] = p_result->gains.ki;
+    gains[2] = p_result->gains.kd;
+    gains[3] = p_result->gains.kf;
+
+    PidBank_SetGains(pid, gains[0], gains[1], gains[2], gains[3]);
+    Cal_SetGains(pid, gains);
+    Cal_SetCalibrationStatusBit(CAL_PID_BIT);
+
+    Ser_PutString("\r\nPrinting PID auto-tune results\r\n");
+    if (pid_tune.wheel == WHEEL_LEFT)
+    {
+        Cal_PrintLeftPidGains(TRUE);
+    }
+    else
+    {
+        Cal_PrintRightPidGains(TRUE);
+    }
+}
+
+/*----------------------------------------------------------------------------
+    PID Gain Schedule Routines
+*/
+static BOOL parse_gains(CHAR* const text, CAL_PID_TYPE* const gains)
+{
+    FLOAT values[4];
+    CHAR *p_curr;
+    CHAR *p_end;
+    UINT8 ii;
+
+    if (text == NULL)
+    {
+        return FALSE;
+    }
+
+    /* Note: gains are formatted as kp,ki,kd,kf */
+    p_curr = text;
+    for (ii = 0; ii < 4; ++ii)
+    {
+        values[ii] = strtod(p_curr, &p_end);
+        if (p_end == p_curr)
+        {
+            return FALSE;
+        }
+
+        p_curr = p_end;
+        if (ii < 3)
+        {
+            if (*p_curr != ',')
+            {
+                return FALSE;
+            }
+            p_curr++;
+        }
+    }
+
+    gains->kp = values[0];
+    gains->ki = values[1];
+    gains->kd = values[2];
+    gains->kf = values[3];
+
+    return *p_curr == '\0';
+}
+
+static CONCMD_IF_PTR_TYPE pid_sched_init(WHEEL_TYPE wheel, BOOL clear, INT32 band, INT32 cps, CHAR* const gains)
+{
+    CAL_PID_SCHED_TYPE *p_sched;
+    CAL_PID_TYPE *p_gains;
+    PID_ENUM_TYPE pid;
+
+    if (wheel != WHEEL_LEFT && wheel != WHEEL_RIGHT)
+    {
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    pid = wheel == WHEEL_LEFT ? PID_TYPE_LEFT : PID_TYPE_RIGHT;
+    pid_sched.wheel = wheel;
+    pid_sched.clear = clear;
+
+    memset(&pid_sched.sched, 0, sizeof pid_sched.sched);
+    p_sched = Cal_GetPidSchedule(pid);
+    if (Cal_IsPidScheduleValid(p_sched))
+    {
+        pid_sched.sched = *p_sched;
+    }
+
+    if (clear)
+    {
+        memset(&pid_sched.sched, 0, sizeof pid_sched.sched);
+    }
+    else
+    {
+        /* Note: bands are edited in place or added at the end */
+        if (!in_range(band, 0, CAL_PID_SCHED_MAX_BANDS - 1) || band > pid_sched.sched.num_bands)
+        {
+            Ser_PutStringFormat("Band must be between 0 and %d\r\n", min(pid_sched.sched.num_bands, CAL_PID_SCHED_MAX_BANDS - 1));
+            return (CONCMD_IF_TYPE *) NULL;
+        }
+
+        if (!in_range(cps, 0, INT16_MAX))
+        {
+            Ser_WriteLine("Invalid band speed", TRUE);
+            return (CONCMD_IF_TYPE *) NULL;
+        }
+
+        if (!parse_gains(gains, &pid_sched.sched.gains[band]))
+        {
+            Ser_WriteLine("Gains must be formatted as kp,ki,kd,kf", TRUE);
+            return (CONCMD_IF_TYPE *) NULL;
+        }
+
+        pid_sched.sched.cps[band] = cps;
+        if (band == pid_sched.sched.num_bands)
+        {
+            pid_sched.sched.num_bands++;
+        }
+
+        if (!Cal_IsPidScheduleValid(&pid_sched.sched))
+        {
+            Ser_WriteLine("Band speeds must be in ascending order", TRUE);
+            return (CONCMD_IF_TYPE *) NULL;
+        }
+    }
+
+    Cal_SetPidSchedule(pid, &pid_sched.sched);
+    PidBank_SetSchedule(pid, &pid_sched.sched);
+
+    /* Without a schedule, go back to the single gain set */
+    if (clear && Cal_GetCalibrationStatusBit(CAL_PID_BIT))
+    {
+        p_gains = Cal_GetPidGains(pid);
+        PidBank_SetGains(pid, p_gains->kp, p_gains->ki, p_gains->kd, p_gains->kf);
+    }
+
+    is_running = TRUE;
+    return &cmd_if_array[PID_SCHED];
+}
+
+static BOOL pid_sched_update(void)
+{
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL pid_sched_status(void)
+{
+    return is_running;
+}
+
+static void pid_sched_results(void)
+{
+    if (pid_sched.clear)
+    {
+        Ser_PutStringFormat("%s PID schedule cleared\r\n", pid_sched.wheel == WHEEL_LEFT ? "Left" : "Right");
+    }
+    else
+    {
+        Cal_PrintPidSchedule(pid_sched.wheel, &pid_sched.sched, FALSE);
+    }
+}
+
+/*----------------------------------------------------------------------------
+    PID Cascade Routines
+
+    The outer (linear/angular velocity) PIDs are enabled/disabled individually
+    or together.  Gains are set for one PID at a time and stored in EEPROM.
+*/
+static CONCMD_IF_PTR_TYPE pid_cascade_init(CONPID_CASCADE_ACTION_TYPE action, UINT8 mask, CHAR* const gains, BOOL plain_text)
+{
+    CAL_PID_TYPE cal_gains;
+    FLOAT values[4];
+    PID_ENUM_TYPE pid;
+    BOOL enable;
+
+    pid_cascade.action = action;
+    pid_cascade.mask = mask ? mask : CONPID_CASCADE_ALL_BITS;
+    pid_cascade.as_json = !plain_text;
+
+    switch (action)
+    {
+        case CONPID_CASCADE_ENABLE:
+        case CONPID_CASCADE_DISABLE:
+            enable = action == CONPID_CASCADE_ENABLE;
+            Pid_EnableCascade(pid_cascade.mask & CONPID_CASCADE_LINEAR_BIT ? enable : PidBank_IsEnabled(PID_TYPE_LINEAR),
+                              pid_cascade.mask & CONPID_CASCADE_ANGULAR_BIT ? enable : PidBank_IsEnabled(PID_TYPE_ANGULAR));
+            break;
+
+        case CONPID_CASCADE_GAINS:
+            if (mask != CONPID_CASCADE_LINEAR_BIT && mask != CONPID_CASCADE_ANGULAR_BIT)
+            {
+                return (CONCMD_IF_TYPE *) NULL;
+            }
+
+            if (!parse_gains(gains, &cal_gains))
+            {
+                Ser_WriteLine("Gains must be formatted as kp,ki,kd,kf", TRUE);
+                return (CONCMD_IF_TYPE *) NULL;
+            }
+
+            /* Note: The first gains stored clear the gains of the other PID so that no EEPROM garbage is loaded */
+            if (!Cal_GetCalibrationStatusBit(CAL_CASCADE_BIT))
+            {
+                memset(values, 0, sizeof values);
+                Cal_SetGains(PID_TYPE_LINEAR, values);
+                Cal_SetGains(PID_TYPE_ANGULAR, values);
+            }
+
+            pid = mask == CONPID_CASCADE_LINEAR_BIT ? PID_TYPE_LINEAR : PID_TYPE_ANGULAR;
+            values[0] = cal_gains.kp;
+            values[1] = cal_gains.ki;
+            values[2] = cal_gains.kd;
+            values[3] = cal_gains.kf;
+            PidBank_SetGains(pid, cal_gains.kp, cal_gains.ki, cal_gains.kd, cal_gains.kf);
+            Cal_SetGains(pid, values);
+            Cal_SetCalibrationStatusBit(CAL_CASCADE_BIT);
+            break;
+
+        case CONPID_CASCADE_SHOW:
+        default:
+            break;
+    }
+
+    is_running = TRUE;
+    return &cmd_if_array[PID_CASCADE];
+}
+
+static BOOL pid_cascade_update(void)
+{
+    is_running = FALSE;
+    return is_running;
+}
+
+static BOOL pid_cascade_status(void)
+{
+    return is_running;
+}
+
+static void print_cascade_pid(PID_ENUM_TYPE pid, CHAR* const name, BOOL as_json)
+{
+    FLOAT kp;
+    FLOAT ki;
+    FLOAT kd;
+    FLOAT kf;
+
+    PidBank_GetGains(pid, &kp, &ki, &kd, &kf);
+
+    if (as_json)
+    {
+        Ser_PutStringFormat("\"%s\":{\"enabled\":%d,\"kp\":%.3f,\"ki\":%.3f,\"kd\":%.3f,\"kf\":%.3f},", 
+                            name, PidBank_IsEnabled(pid), kp, ki, kd, kf);
+    }
+    else
+    {
+        Ser_PutStringFormat("%-8s: %-8s P: %.3f, I: %.3f, D: %.3f, F: %.3f\r\n", 
+                            name, PidBank_IsEnabled(pid) ? "enabled" : "disabled", kp, ki, kd, kf);
+    }
+}
+
+static void print_cascade_loop(PID_LOOP_TYPE loop, CHAR* const name, UINT16 rate, BOOL as_json)
+{
+    PID_LOOP_STATS_TYPE *p_stats = Pid_GetLoopStats(loop);
+
+    if (as_json)
+    {
+        Ser_PutStringFormat("\"%s\":{\"rate\":%d,\"count\":%ld,\"last_us\":%ld,\"max_us\":%ld,\"max_period_ms\":%ld}", 
+                            name, rate, p_stats->count, p_stats->last_us, p_stats->max_us, p_stats->max_period_ms);
+    }
+    else
+    {
+        Ser_PutStringFormat("%-8s: %d Hz, count: %ld, last: %ld us, max: %ld us, max period: %ld ms\r\n", 
+                            name, rate, p_stats->count, p_stats->last_us, p_stats->max_us, p_stats->max_period_ms);
+    }
+}
+
+static void pid_cascade_results(void)
+{
+    if (pid_cascade.as_json)
+    {
+        Ser_PutString("{");
+    }
+
+    print_cascade_pid(PID_TYPE_LINEAR, "linear", pid_cascade.as_json);
+    print_cascade_pid(PID_TYPE_ANGULAR, "angular", pid_cascade.as_json);
+    print_cascade_loop(PID_LOOP_INNER, "inner", Rate_Get(RATE_PID), pid_cascade.as_json);
+    if (pid_cascade.as_json)
+    {
+        Ser_PutString(",");
+    }
+    print_cascade_loop(PID_LOOP_OUTER, "outer", Rate_Get(RATE_OUTER), pid_cascade.as_json);
+
+    if (pid_cascade.as_json)
+    {
+        Ser_PutString("}\r\n");
+    }
+
+    /* The statistics cover the time since the last show */
+    if (pid_cascade.action == CONPID_CASCADE_SHOW)
+    {
+        Pid_ResetLoopStats();
+    }
+}
+
 /*----------------------------------------------------------------------------
     ConPid Module
 */
@@ -244,17 +671,32 @@ void ConPid_Init(void)
 {
     cmd_if_array[PID_SHOW].update = pid_show_update;
     cmd_if_array[PID_SHOW].status = pid_show_status;
-    cmd_if_array[PID_SHOW].results = pid_show_results;
+    cmd_if_array[PID_SHOW].stop = pid_show_stop;
     cmd_if_array[PID_CAL].update = pid_cal_update;
     cmd_if_array[PID_CAL].status = pid_cal_status;
     cmd_if_array[PID_CAL].results = pid_cal_results;
+    cmd_if_array[PID_CAL].stop = pid_stop;
     cmd_if_array[PID_VAL].update = pid_val_update;
     cmd_if_array[PID_VAL].status = pid_val_status;
     cmd_if_array[PID_VAL].results = pid_val_results;
+    cmd_if_array[PID_VAL].stop = pid_stop;
+    cmd_if_array[PID_TUNE].update = pid_tune_update;
+    cmd_if_array[PID_TUNE].status = pid_tune_status;
+    cmd_if_array[PID_TUNE].results = pid_tune_results;
+    cmd_if_array[PID_TUNE].stop = pid_stop;
+    cmd_if_array[PID_SCHED].update = pid_sched_update;
+    cmd_if_array[PID_SCHED].status = pid_sched_status;
+    cmd_if_array[PID_SCHED].results = pid_sched_results;
+    cmd_if_array[PID_CASCADE].update = pid_cascade_update;
+    cmd_if_array[PID_CASCADE].status = pid_cascade_status;
+    cmd_if_array[PID_CASCADE].results = pid_cascade_results;
 
     memset(&pid_show, 0, sizeof pid_show);
     memset(&pid_cal, 0, sizeof pid_cal);
     memset(&pid_val, 0, sizeof pid_val);
+    memset(&pid_tune, 0, sizeof pid_tune);
+    memset(&pid_sched, 0, sizeof pid_sched);
+    memset(&pid_cascade, 0, sizeof pid_cascade);
     
     is_running = FALSE;
 }
@@ -269,9 +711,9 @@ CONCMD_IF_PTR_TYPE ConPid_InitPidShow(WHEEL_TYPE wheel, BOOL plain_text)
     return pid_show_init(wheel, plain_text);
 }
 
-CONCMD_IF_PTR_TYPE ConPid_InitPidCal(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL with_debug)
+CONCMD_IF_PTR_TYPE ConPid_InitPidCal(WHEEL_TYPE wheel, BOOL impulse, FLOAT step, BOOL with_debug, BOOL binary)
 {
-    return pid_cal_init(wheel, impulse, step, with_debug);
+    return pid_cal_init(wheel, impulse, step, with_debug, binary);
 }
 
 CONCMD_IF_PTR_TYPE ConPid_InitPidVal(WHEEL_TYPE wheel, DIR_TYPE direction,
@@ -282,4 +724,19 @@ CONCMD_IF_PTR_TYPE ConPid_InitPidVal(WHEEL_TYPE wheel, DIR_TYPE direction,
     return pid_val_init(wheel, direction, min_percent, max_percent, num_points);
 }
 
+CONCMD_IF_PTR_TYPE ConPid_InitPidTune(WHEEL_TYPE wheel, CHAR* const rule)
+{
+    return pid_tune_init(wheel, rule);
+}
+
+CONCMD_IF_PTR_TYPE ConPid_InitPidSched(WHEEL_TYPE wheel, BOOL clear, INT32 band, INT32 cps, CHAR* const gains)
+{
+    return pid_sched_init(wheel, clear, band, cps, gains);
+}
+
+CONCMD_IF_PTR_TYPE ConPid_InitPidCascade(CONPID_CASCADE_ACTION_TYPE action, UINT8 mask, CHAR* const gains, BOOL plain_text)
+{
+    return pid_cascade_init(action, mask, gains, plain_text);
+}
+
 
@@ -4,6 +4,12 @@
 #include "freesoc.h"
 #include "concmd.h"
     
+#define CONPID_CASCADE_LINEAR_BIT   (0x01)
+#define CONPID_CASCADE_ANGULAR_BIT  (0x02)
+#define CONPID_CASCADE_ALL_BITS     (CONPID_CASCADE_LINEAR_BIT | CONPID_CASCADE_ANGULAR_BIT)
+
+typedef enum {CONPID_CASCADE_SHOW, CONPID_CASCADE_ENABLE, CONPID_CASCADE_DISABLE, CONPID_CASCADE_GAINS} CONPID_CASCADE_ACTION_TYPE;
+
 void ConPid_Init(void);
 void ConPid_Start(void);
 
@@ -12,10 +18,21 @@ CONCMD_IF_PTR_TYPE ConPid_InitPidShow(WHEEL_TYPE wheel,
 CONCMD_IF_PTR_TYPE ConPid_InitPidCal(WHEEL_TYPE wheel, 
                                          BOOL impulse, 
                                          FLOAT step, 
-                                         BOOL with_debug);
+                                         BOOL with_debug,
+                                         BOOL binary);
 CONCMD_IF_PTR_TYPE ConPid_InitPidVal(WHEEL_TYPE wheel, DIR_TYPE direction,
                                          FLOAT min_percent,
                                          FLOAT max_percent,
                                          INT8 num_points);
+CONCMD_IF_PTR_TYPE ConPid_InitPidTune(WHEEL_TYPE wheel, CHAR* const rule);
+CONCMD_IF_PTR_TYPE ConPid_InitPidSched(WHEEL_TYPE wheel, 
+                                           BOOL clear, 
+                                           INT32 band, 
+                                           INT32 cps, 
+                                           CHAR* const gains);
+CONCMD_IF_PTR_TYPE ConPid_InitPidCascade(CONPID_CASCADE_ACTION_TYPE action, 
+                                             UINT8 mask, 
+                                             CHAR* const gains, 
+                                             BOOL plain_text);
     
 #endif
\ No newline at end of file
@@ -105,6 +105,7 @@ static void HandleZeroLengthInput()
 
 static void HandleLineParsing(CHAR * const line)
 {
+    ResetCommand();
     Parser_Parse(line, &command);
     if (command.is_exit)
     {
@@ -152,28 +153,15 @@ void Console_Update()
 {
     INT8 length;
     CHAR line[MAX_LINE_LENGTH];
-    BOOL result;
-
-    /* Since all of the is_running interface routines are just returning is_running maybe there is no need for
-       this function in the interface.  Maybe just dispatch has the routine for the purposes of tracking
-       progress.  Or, maybe there is no need for Disp_IsRunning at all and Disp_Update can handle the 
-       same functionality with different return values:
-            -1 - nothing is active
-            1 - still running
-            0 - all done
+
+    /* Commands run as jobs (see disp.c), so the console keeps reading lines while jobs are running.  The
+       prompt is displayed again each time a job reports its results.
     */
     if (Disp_IsRunning())
     {
-        result = Disp_Update();
-        if (result)
-        {
-            /* Only a single outstanding command is allowed - explicit return until dispatch is done */
-            return;
-        }
-        else
+        Disp_Update();
+        if (Disp_Results())
         {
-            Disp_Results();
-            ResetCommand();
             DisplayPrompt();
         }        
     }
@@ -94,15 +94,25 @@ Sample Rates
 #define ENC_SAMPLE_RATE     (50) /* Hz */
 #define PID_SAMPLE_RATE     (50) /* Hz */
 #define ODOM_SAMPLE_RATE    (50) /* Hz */
+#define OUTER_SAMPLE_RATE   (10) /* Hz */
+#define REFINE_SAMPLE_RATE  (10) /* Hz */
 #define HEARTBEAT_RATE      (2)  /* Hz */
 #define STATUS_LED_RATE     (2)  /* Hz */
 
+/* The encoder, PID, odometry and outer loop rates above are defaults which can be changed at runtime (see rate.c).  The main loop
+   schedules updates in whole milliseconds which limits the maximum rate.
+ */
+#define MIN_SAMPLE_RATE     (10)  /* Hz */
+#define MAX_SAMPLE_RATE     (500) /* Hz */
+
 /* The following defines and macro provide a mechanism to distribute the sampling across the main loop, i.e., keep the
    sampling from happening all of the same time, by introducing a one-time initial delay or sampling offset.
  */
 #define ENC_SCHED_OFFSET    (7)   /* ms */
 #define PID_SCHED_OFFSET    (11)  /* ms */
 #define ODOM_SCHED_OFFSET   (23)  /* ms */
+#define OUTER_SCHED_OFFSET  (17)  /* ms */
+#define REFINE_SCHED_OFFSET (31)  /* ms */
 
 
 #endif
\ No newline at end of file
@@ -34,6 +34,7 @@ SOFTWARE.
 /*---------------------------------------------------------------------------------------------------
  * Includes
  *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
 #include "control.h"
 #include "motor.h"
 #include "cal.h"
@@ -44,6 +45,7 @@ SOFTWARE.
 #include "ccif.h"
 #include "diag.h"
 #include "consts.h"
+#include "profile.h"
 
 /*---------------------------------------------------------------------------------------------------
  * Defines
@@ -55,8 +57,12 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/
 #define MAX_CMD_VELOCITY_TIMEOUT (2000)
 
+/* Default velocity profile: 0 to maximum velocity within the response time, of which the acceleration takes 
+   ACCEL_RISE_TIME to reach maximum acceleration (see Profile_RampTime).
+*/
 #define LINEAR_RESPONSE_TIME (1.0)
 #define ANGULAR_RESPONSE_TIME (1.0)
+#define ACCEL_RISE_TIME (0.25)
 
 /*---------------------------------------------------------------------------------------------------
  * Types
@@ -73,6 +79,11 @@ static FLOAT right_velocity_cps;
 static FLOAT max_linear;  // m/s
 static FLOAT max_angular; // r/s
 
+/* The command as read, before profiling and shaping (see trace.c) */
+static FLOAT input_linear_mps;
+static FLOAT input_angular_rps;
+static UINT32 input_timeout;
+
 static BOOL debug_override;
 static UINT8 left_right_cmd_velocity_override;
 static BOOL acceleration_enabled;
@@ -80,6 +91,20 @@ static BOOL acceleration_enabled;
 static FLOAT linear_gain;
 static FLOAT linear_trim;
 
+/* Corrections from the outer (linear/angular velocity) PIDs */
+static FLOAT linear_correction_mps;
+static FLOAT angular_correction_rps;
+
+/* Jerk-limited velocity profiles applied to the commanded linear/angular velocity */
+static PROFILE_TYPE linear_profile;
+static PROFILE_TYPE angular_profile;
+static UINT32 last_profile_time;
+
+/* Command shaping to the wheel velocity envelope */
+static CONTROL_SHAPE_TYPE shape_policy;
+static CONTROL_SHAPE_STATS_TYPE shape_stats;
+static BOOL is_saturated;
+
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Update_Debug
@@ -141,6 +166,15 @@ static void Update_Debug(UINT16 bits)
     {
         Debug_Disable(DEBUG_SAMPLE_ENABLE_BIT);
     }
+
+    if (bits & TRACE_DEBUG_BIT)
+    {
+        Debug_Enable(DEBUG_TRACE_ENABLE_BIT);
+    }
+    else
+    {
+        Debug_Disable(DEBUG_TRACE_ENABLE_BIT);
+    }
 }
     
 /*---------------------------------------------------------------------------------------------------
@@ -157,6 +191,14 @@ void Control_Init()
     linear_trim = 0.0;
     left_right_cmd_velocity_override = FALSE;
     acceleration_enabled = TRUE;
+    linear_correction_mps = 0.0;
+    angular_correction_rps = 0.0;
+    shape_policy = CONTROL_SHAPE_CURVATURE;
+    input_linear_mps = 0.0;
+    input_angular_rps = 0.0;
+    input_timeout = 0;
+    memset(&shape_stats, 0, sizeof shape_stats);
+    is_saturated = FALSE;
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -168,8 +210,91 @@ void Control_Init()
  *-------------------------------------------------------------------------------------------------*/ 
 void Control_Start()
 {   
+    FLOAT accel;
+    
     max_linear = CalcMaxLinearVelocity();
     max_angular = CalcMaxAngularVelocity();    
+    
+    accel = max_linear / (LINEAR_RESPONSE_TIME - ACCEL_RISE_TIME);
+    Profile_Init(&linear_profile, accel, accel / ACCEL_RISE_TIME);
+    accel = max_angular / (ANGULAR_RESPONSE_TIME - ACCEL_RISE_TIME);
+    Profile_Init(&angular_profile, accel, accel / ACCEL_RISE_TIME);
+    last_profile_time = millis();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ShapeVelocity
+ * Description: Fits the linear/angular velocity to the wheel velocity envelope, i.e., neither wheel
+ *              exceeds MAX_WHEEL_RADIAN_PER_SECOND.  In terms of the robot maximums, the envelope is
+ *
+ *                  |v|/max_linear + |w|/max_angular <= 1
+ *
+ *              When the command is outside the envelope it is adjusted according to the shape policy:
+ *                  CONTROL_SHAPE_CURVATURE - linear and angular are scaled together so the path curvature
+ *                                            (w/v) is unchanged.
+ *                  CONTROL_SHAPE_ANGULAR - angular is kept (up to max_angular) and linear is reduced to
+ *                                          the remaining wheel velocity.
+ * Parameters: (in/out) linear - linear velocity (meter/sec)
+ *             (in/out) angular - angular velocity (rad/sec)
+ * Return: FLOAT - the commanded fraction of the envelope before shaping, > 1.0 means saturated
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+static FLOAT ShapeVelocity(FLOAT* const linear, FLOAT* const angular)
+{
+    FLOAT demand;
+    FLOAT linear_limit;
+    
+    demand = abs(*linear) / max_linear + abs(*angular) / max_angular;
+    
+    if (demand > 1.0)
+    {
+        switch (shape_policy)
+        {
+            case CONTROL_SHAPE_ANGULAR:
+                *angular = constrain(*angular, -max_angular, max_angular);
+                linear_limit = max_linear * (1.0 - abs(*angular) / max_angular);
+                *linear = constrain(*linear, -linear_limit, linear_limit);
+                break;
+                
+            case CONTROL_SHAPE_CURVATURE:
+            default:
+                *linear /= demand;
+                *angular /= demand;
+                break;
+        }
+    }
+    
+    return demand;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: UpdateShapeStats
+ * Description: Counts saturation of the commanded velocity and reflects it in the device status so
+ *              that the host can adapt its commands.
+ * Parameters: demand - the commanded fraction of the wheel envelope (see ShapeVelocity)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+static void UpdateShapeStats(FLOAT demand)
+{
+    shape_stats.updates++;
+    shape_stats.peak_demand = max(shape_stats.peak_demand, demand);
+    
+    if (demand > 1.0)
+    {
+        shape_stats.saturated++;
+        if (!is_saturated)
+        {
+            shape_stats.events++;
+            is_saturated = TRUE;
+            SetDeviceStatusBit(STATUS_CMD_SATURATED_BIT);
+        }
+    }
+    else if (is_saturated)
+    {
+        is_saturated = FALSE;
+        ClearDeviceStatusBit(STATUS_CMD_SATURATED_BIT);
+    }
 }
 
 static void SetCmdVelocity(FLOAT linear, FLOAT angular)
@@ -179,17 +304,23 @@ static void SetCmdVelocity(FLOAT linear, FLOAT angular)
     
     if (!left_right_cmd_velocity_override)
     {    
-        /* Note: This function is called from the unipid to track angular velocity.  Basically, we are taking the adjustment
-           to linear/angular velocity and converting to left/right velocity (in rad/s).  The left/right pids will pick
-           up left/right velocity (converted to count/s) and track linear velocity.
+        /* Note: The outer (linear/angular velocity) PIDs adjust the commanded linear/angular velocity and the result
+           is converted to left/right velocity (in rad/s).  The left/right pids will pick up left/right velocity 
+           (converted to count/s) and track it.  A stop command is never corrected so that the robot stops.
         */
+        if (linear != 0.0 || angular != 0.0)
+        {
+            linear += linear_correction_mps;
+            angular += angular_correction_rps;
+        }
+        
+        /* The correction can push an otherwise feasible command out of the envelope */
+        ShapeVelocity(&linear, &angular);
+        
         UniToDiff(linear, angular, &left_velocity_rps, &right_velocity_rps);
         
         left_velocity_cps = left_velocity_rps * WHEEL_COUNT_PER_RADIAN;
         right_velocity_cps = right_velocity_rps * WHEEL_COUNT_PER_RADIAN;
-        
-        //left_cmd_velocity = constrain(MAX_WHEEL_BACKWARD_LINEAR_VELOCITY, left_cmd_velocity, MAX_WHEEL_FORWARD_LINEAR_VELOCITY);
-        //right_cmd_velocity = constrain(MAX_WHEEL_BACKWARD_LINEAR_VELOCITY, right_cmd_velocity,MAX_WHEEL_FORWARD_LINEAR_VELOCITY);
     }
     
 }
@@ -208,6 +339,8 @@ void Control_Update()
     UINT32 timeout;
     UINT16 device_control;
     UINT16 debug_control;
+    UINT32 now;
+    FLOAT dt;
         
     
     CONTROL_UPDATE_START();
@@ -248,13 +381,32 @@ void Control_Update()
     }
     
     control_cmd_velocity(&linear_velocity_mps, &angular_velocity_rps, &timeout);
+    input_linear_mps = linear_velocity_mps;
+    input_angular_rps = angular_velocity_rps;
+    input_timeout = timeout;
 
-    //EnsureAngularVelocity(&linear_cmd_velocity, &angular_cmd_velocity);    
-        
+    now = millis();
+    dt = (now - last_profile_time) / (FLOAT) MILLIS_PER_SECOND;
+    last_profile_time = now;
+    
     if (acceleration_enabled)
     {
-        linear_velocity_mps = LimitLinearAccel(linear_velocity_mps, max_linear, LINEAR_RESPONSE_TIME);
-        angular_velocity_rps = LimitAngularAccel(angular_velocity_rps, max_angular, ANGULAR_RESPONSE_TIME);
+        linear_velocity_mps = Profile_Update(&linear_profile, linear_velocity_mps, dt);
+        angular_velocity_rps = Profile_Update(&angular_profile, angular_velocity_rps, dt);
+    }
+    else
+    {
+        /* Keep the profiles at the commanded velocity so that enabling acceleration does not bump */
+        Profile_Reset(&linear_profile, linear_velocity_mps);
+        Profile_Reset(&angular_profile, angular_velocity_rps);
+    }
+
+    /* Shape the profiled command to the wheel envelope.  The shaped command is also the target of the outer
+       PIDs so they do not wind up chasing a velocity the wheels cannot reach.
+    */
+    if (!left_right_cmd_velocity_override)
+    {
+        UpdateShapeStats(ShapeVelocity(&linear_velocity_mps, &angular_velocity_rps));
     }
 
     /* Here seems like a reasonable place to evaluate safety, e.g., can we execute the requested speed change safely
@@ -287,8 +439,13 @@ void Control_Update()
     {
         if (timeout > MAX_CMD_VELOCITY_TIMEOUT)
         {
+            /* Zero the linear/angular velocity also so that an outer PID correction does not restart the motors */
+            linear_velocity_mps = 0;
+            angular_velocity_rps = 0;
             left_velocity_cps = 0;
             right_velocity_cps = 0;
+            Profile_Reset(&linear_profile, 0.0);
+            Profile_Reset(&angular_profile, 0.0);
         }
     }
     
@@ -423,6 +580,77 @@ FLOAT Control_RightGetCmdVelocityCps()
     *linear = linear_velocity_mps;
     *angular = angular_velocity_rps;
 }
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetInputVelocity
+ * Description: Accessor function used to return the linear/angular velocity command as it was last read, i.e.,
+ *              before the velocity profile and shaping are applied.
+ * Parameters: (out) linear - linear velocity (meter/sec)
+ *             (out) angular - angular velocity (rad/sec)
+ *             (out) timeout - time since the last command (millisecond)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_GetInputVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout)
+{
+    *linear = input_linear_mps;
+    *angular = input_angular_rps;
+    *timeout = input_timeout;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetCmdLinearVelocity
+ * Description: Accessor function used to return the commanded linear velocity.  This is the target of
+ *              the outer linear velocity PID.
+ * Parameters: None
+ * Return: FLOAT - linear velocity (meter/sec)
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+FLOAT Control_GetCmdLinearVelocity()
+{
+    return left_right_cmd_velocity_override ? 0.0 : linear_velocity_mps;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetCmdAngularVelocity
+ * Description: Accessor function used to return the commanded angular velocity.  This is the target of
+ *              the outer angular velocity PID.
+ * Parameters: None
+ * Return: FLOAT - angular velocity (rad/sec)
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+FLOAT Control_GetCmdAngularVelocity()
+{
+    return left_right_cmd_velocity_override ? 0.0 : angular_velocity_rps;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_SetLinearCorrection
+ * Description: Sets the linear velocity correction from the outer linear velocity PID and applies it to
+ *              the left/right commanded velocity.
+ * Parameters: (in) correction - linear velocity correction (meter/sec)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_SetLinearCorrection(FLOAT correction)
+{
+    linear_correction_mps = correction;
+    SetCmdVelocity(linear_velocity_mps, angular_velocity_rps);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_SetAngularCorrection
+ * Description: Sets the angular velocity correction from the outer angular velocity PID and applies it to
+ *              the left/right commanded velocity.
+ * Parameters: (in) correction - angular velocity correction (rad/sec)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_SetAngularCorrection(FLOAT correction)
+{
+    angular_correction_rps = correction;
+    SetCmdVelocity(linear_velocity_mps, angular_velocity_rps);
+}
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Control_SetCmdVelocity
@@ -442,6 +670,89 @@ void Control_EnableAcceleration(BOOL enable)
     acceleration_enabled = enable;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_SetProfileLimits
+ * Description: Sets the acceleration and jerk limits of the linear/angular velocity profiles.
+ * Parameters: linear_accel - linear acceleration (meter/sec^2)
+ *             linear_jerk - linear jerk (meter/sec^3), 0 for a trapezoid ramp
+ *             angular_accel - angular acceleration (rad/sec^2)
+ *             angular_jerk - angular jerk (rad/sec^3), 0 for a trapezoid ramp
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_SetProfileLimits(FLOAT linear_accel, FLOAT linear_jerk, FLOAT angular_accel, FLOAT angular_jerk)
+{
+    Profile_SetLimits(&linear_profile, linear_accel, linear_jerk);
+    Profile_SetLimits(&angular_profile, angular_accel, angular_jerk);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetProfileLimits
+ * Description: Returns the acceleration and jerk limits of the linear/angular velocity profiles.
+ * Parameters: linear_accel - linear acceleration (meter/sec^2)
+ *             linear_jerk - linear jerk (meter/sec^3)
+ *             angular_accel - angular acceleration (rad/sec^2)
+ *             angular_jerk - angular jerk (rad/sec^3)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_GetProfileLimits(FLOAT* const linear_accel, FLOAT* const linear_jerk, FLOAT* const angular_accel, FLOAT* const angular_jerk)
+{
+    *linear_accel = linear_profile.max_accel;
+    *linear_jerk = linear_profile.max_jerk;
+    *angular_accel = angular_profile.max_accel;
+    *angular_jerk = angular_profile.max_jerk;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_SetShapePolicy
+ * Description: Sets the policy used to fit the commanded velocity to the wheel envelope.
+ * Parameters: policy - CONTROL_SHAPE_CURVATURE or CONTROL_SHAPE_ANGULAR
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_SetShapePolicy(CONTROL_SHAPE_TYPE policy)
+{
+    shape_policy = policy;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetShapePolicy
+ * Description: Returns the policy used to fit the commanded velocity to the wheel envelope.
+ * Parameters: None
+ * Return: CONTROL_SHAPE_TYPE
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+CONTROL_SHAPE_TYPE Control_GetShapePolicy()
+{
+    return shape_policy;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_GetShapeStats
+ * Description: Returns the command saturation statistics.
+ * Parameters: (out) stats - the saturation statistics
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_GetShapeStats(CONTROL_SHAPE_STATS_TYPE* const stats)
+{
+    *stats = shape_stats;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Control_ResetShapeStats
+ * Description: Clears the command saturation statistics.  The saturated status bit is left as is and
+ *              follows the next command.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+void Control_ResetShapeStats()
+{
+    memset(&shape_stats, 0, sizeof shape_stats);
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Control_OverrideDebug
  * Description: Function used to override the debug mask.  Used primarily during calibration.
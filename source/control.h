@@ -45,12 +45,22 @@ SOFTWARE.
 #define CONTROL_CLEAR_CALIBRATION        (0x0004)
 
 #define STATUS_HB25_CNTRL_INIT_BIT (0x0001)
+#define STATUS_CMD_SATURATED_BIT   (0x0002)
+
+/* Path upload control register, see i2cif.c and pursuit.c */
+#define PATH_CONTROL_LOAD_BIT      (0x01)
+#define PATH_CONTROL_START_BIT     (0x02)
+#define PATH_CONTROL_STOP_BIT      (0x04)
+#define PATH_CONTROL_CLEAR_BIT     (0x08)
+
+#define PATH_WINDOW_NUM_POINTS     (4)
     
 #define ENCODER_DEBUG_BIT   (0x0001)
 #define PID_DEBUG_BIT       (0x0002)
 #define MOTOR_DEBUG_BIT     (0x0004)
 #define ODOM_DEBUG_BIT      (0x0008)
 #define SAMPLE_DEBUG_BIT    (0x0010)
+#define TRACE_DEBUG_BIT     (0x0020)
     
 
 
@@ -59,6 +69,17 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/
 typedef void (*COMMAND_FUNC_TYPE)(FLOAT *linear, FLOAT *angular, UINT32 *timeout);
 
+/* Policy used to fit a linear/angular velocity command to the wheel velocity envelope */
+typedef enum {CONTROL_SHAPE_CURVATURE, CONTROL_SHAPE_ANGULAR} CONTROL_SHAPE_TYPE;
+
+typedef struct _control_shape_stats
+{
+    UINT32 events;      /* number of times the command entered saturation */
+    UINT32 updates;     /* number of control updates */
+    UINT32 saturated;   /* number of control updates in saturation */
+    FLOAT peak_demand;  /* largest commanded fraction of the wheel envelope, > 1.0 is saturated */
+} CONTROL_SHAPE_STATS_TYPE;
+
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/
@@ -70,7 +91,12 @@ void Control_RestoreCommandVelocityFunc();
 FLOAT Control_LeftGetCmdVelocityCps();
 FLOAT Control_RightGetCmdVelocityCps();
 void Control_GetCmdVelocity(FLOAT* const linear, FLOAT* const angular);
+void Control_GetInputVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout);
 void Control_SetCmdVelocity(FLOAT linear, FLOAT angular);
+FLOAT Control_GetCmdLinearVelocity();
+FLOAT Control_GetCmdAngularVelocity();
+void Control_SetLinearCorrection(FLOAT correction);
+void Control_SetAngularCorrection(FLOAT correction);
 void Control_OverrideDebug(BOOL override);
 
 void Control_SetDeviceStatusBit(UINT16 bit);
@@ -87,6 +113,12 @@ void Control_SetLeftRightVelocityOverride(BOOL enable);
 void Control_SetLeftRightVelocityMps(FLOAT left, FLOAT right);
 void Control_SetLeftRightVelocityCps(FLOAT left, FLOAT right);
 void Control_EnableAcceleration(BOOL enable);
+void Control_SetProfileLimits(FLOAT linear_accel, FLOAT linear_jerk, FLOAT angular_accel, FLOAT angular_jerk);
+void Control_GetProfileLimits(FLOAT* const linear_accel, FLOAT* const linear_jerk, FLOAT* const angular_accel, FLOAT* const angular_jerk);
+void Control_SetShapePolicy(CONTROL_SHAPE_TYPE policy);
+CONTROL_SHAPE_TYPE Control_GetShapePolicy();
+void Control_GetShapeStats(CONTROL_SHAPE_STATS_TYPE* const stats);
+void Control_ResetShapeStats();
 
 #endif
 
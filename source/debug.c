@@ -53,8 +53,6 @@ static UINT16 saved_debug_control_enabled;
 void Debug_Init()
 {
 #ifdef COMMS_DEBUG_ENABLED  
-    memset(formatted_string, 0, sizeof(formatted_string));
-
 #if defined LEFT_ENC_DUMP_ENABLED
     debug_control_enabled |= DEBUG_LEFT_ENCODER_ENABLE_BIT;
 #endif
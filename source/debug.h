@@ -53,6 +53,7 @@ SOFTWARE.
 #define DEBUG_SAMPLE_ENABLE_BIT             (0x0080)
 #define DEBUG_UNIPID_ENABLE_BIT             (0x0100)
 #define DEBUG_ANGPID_ENABLE_BIT             (0x0200)
+#define DEBUG_TRACE_ENABLE_BIT              (0x0400)
 
 
 /* The following defines enable "dump" logging methods for each feature */
@@ -73,7 +74,10 @@ SOFTWARE.
 //#define MAIN_LOOP_DELTA_ENABLED
 //#define SENSOR_UPDATE_DELTA_ENABLED
     
-char formatted_string[256];
+/* Note: The formatted string is on the stack of the caller rather than a static buffer, so it only takes
+   RAM while a debug line is written.
+ */
+#define DEBUG_STRING_LENGTH (256)
 
 #define NONE    0x00
 #define DBG     0x1F
@@ -87,11 +91,13 @@ char formatted_string[256];
 #define WHERESTR "[FILE : %s, FUNC : %s, LINE : %d]: "
 #define WHEREARG __FILE__,__func__,__LINE__
 #define INSIDE_DEBUG_DETAIL(...)    do {                                                                \
+                                    CHAR formatted_string[DEBUG_STRING_LENGTH];                         \
                                     snprintf(formatted_string, sizeof(formatted_string), __VA_ARGS__);  \
                                     Ser_PutString(formatted_string);                                    \
                                     } while (0)
 
 #define INSIDE_DEBUG(...)           do {                                                                     \
+                                    CHAR formatted_string[DEBUG_STRING_LENGTH];                         \
                                     snprintf(formatted_string, sizeof(formatted_string), __VA_ARGS__);  \
                                     Ser_PutString(formatted_string);                                    \
                                     } while (0)                                
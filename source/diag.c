@@ -49,6 +49,9 @@ SOFTWARE.
 static UINT32 last_heartbeat_time;
 static UINT32 heartbeat;
 static UINT32 last_led_time;
+static UINT32 last_loop_time;
+static UINT32 loop_count;
+static UINT32 loop_rate;
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Diag_Init
@@ -63,6 +66,9 @@ void Diag_Init()
     last_heartbeat_time = millis();
     heartbeat = 0;
     last_led_time = millis();
+    last_loop_time = millis();
+    loop_count = 0;
+    loop_rate = 0;
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -79,7 +85,8 @@ void Diag_Start()
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Diag_Update
- * Description: Updates the heartbeat timer and writes the heartbeat counter to I2C.
+ * Description: Updates the heartbeat timer and writes the heartbeat counter to I2C.  Also, measures
+ *              the main loop rate (Diag_Update is called once per main loop).
  * Parameters: None
  * Return: None
  * 
@@ -107,6 +114,29 @@ void Diag_Start()
         
         LED_Write(~LED_Read());
     }
+    
+    loop_count++;
+    delta_time = now - last_loop_time;
+    if (delta_time >= MS_IN_SEC)
+    {
+        last_loop_time = now;
+        
+        loop_rate = (loop_count * MS_IN_SEC) / delta_time;
+        loop_count = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Diag_GetLoopRate
+ * Description: Returns the number of main loop iterations per second measured over the last second.
+ *              The main loop rate falls as the sample rates rise, so it is a measure of CPU headroom.
+ * Parameters: None
+ * Return: UINT32 - main loop iterations/second
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 Diag_GetLoopRate()
+{
+    return loop_rate;
 }
 
 /* [] END OF FILE */
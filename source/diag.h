@@ -93,6 +93,7 @@ SOFTWARE.
 void Diag_Init();
 void Diag_Start();
 void Diag_Update();
+UINT32 Diag_GetLoopRate();
 
 #endif 
 
@@ -27,6 +27,7 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/    
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "disp.h"
 #include "serial.h"
 #include "concmd.h"
@@ -34,6 +35,10 @@ SOFTWARE.
 #include "conconfig.h"
 #include "conpid.h"
 #include "conmotion.h"
+#include "calsnap.h"
+#include "macro.h"
+#include "arena.h"
+#include "emit.h"
 #include "debug.h"
 #include "utils.h"
 
@@ -42,213 +47,411 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/    
 #define BOOL_TO_BITMASK(value, bit)  (value ? 1 << bit : 0)
 
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/    
+#define MAX_DEFERRED_RESULTS (8)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/    
+typedef CONCMD_IF_PTR_TYPE (*VALIDATE_FUNC_TYPE)(COMMAND_TYPE* const command);
+typedef UINT8 (*CLAIM_FUNC_TYPE)(COMMAND_TYPE* const command);
+
+typedef struct
+{
+    VALIDATE_FUNC_TYPE validate;
+    UINT8 resources;
+    /* Optional: returns the resources claimed in addition to the route's, e.g., by the steps of a macro */
+    CLAIM_FUNC_TYPE claim;
+} ROUTE_TYPE;
+
+typedef struct
+{
+    CONCMD_IF_TYPE *cmd;
+    UINT8 id;
+    UINT8 resources;
+    CONPARSER_ROUTE_TYPE route;
+} JOB_TYPE;
+
+typedef enum
+{
+    DISP_JOBS,
+    DISP_KILL,
+    DISP_MACRO,
+    DISP_MACRO_RUN,
+    DISP_MACRO_SHOW,
+    DISP_LAST
+} DISP_CMD_TYPE;
+
+/* A macro step is loaded from its compiled form into command, whose arguments point into the cursor's copy of the
+   step.  The results of the steps are deferred and reported together when the macro is done, or before a step which
+   conflicts with a deferred step (see start_macro_step).
+*/
+typedef struct
+{
+    MACRO_CURSOR_TYPE cursor;
+    COMMAND_TYPE command;
+    CONCMD_IF_TYPE *cmd;
+    CONPARSER_ROUTE_TYPE route;
+    CONCMD_IF_TYPE *deferred[MAX_DEFERRED_RESULTS];
+    UINT8 deferred_resources;
+    UINT8 num_deferred;
+    UINT8 num_done;
+    MACRO_RESULT_TYPE result;
+    BOOL is_done;
+    BOOL plain_text;
+} MACRO_RUN_TYPE;
+
+typedef struct
+{
+    CONPARSER_ROUTE_TYPE route;
+    MACRO_RESULT_TYPE result;
+    UINT8 num_steps;
+} MACRO_EDIT_TYPE;
+
 
 /*---------------------------------------------------------------------------------------------------
  * Variables
  *-------------------------------------------------------------------------------------------------*/    
-static CONCMD_IF_TYPE * p_active_command;
+static JOB_TYPE jobs[DISP_MAX_JOBS];
+static UINT8 last_job_id;
+static BOOL jobs_plain_text;
+static UINT8 num_killed;
+static MACRO_RUN_TYPE macro_run;
+static MACRO_EDIT_TYPE macro_edit;
+static BOOL macro_show_plain_text;
+static EMIT_STREAM_TYPE macro_show_stream;
+static BOOL is_macro_show_running;
+
+static CONCMD_IF_TYPE disp_cmd_if_array[DISP_LAST];
+
+/* Note: The macro commands look up the routes of their steps (see below) */
+static const ROUTE_TYPE routes[CONPARSER_ROUTE_LAST];
 
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/    
 
-static CONCMD_IF_PTR_TYPE validate_config_command(COMMAND_TYPE* const command)
+static CONCMD_IF_PTR_TYPE validate_config_clear_command(COMMAND_TYPE* const command)
 {
-    /* Note: The args flags have contextual meaning.  To resolve ambiguity, 'clear' is processed
-       before 'debug': 
+    UINT8 mask = 0;
 
-            config clear debug
-            vs
-            config debug mask
-    */
-
-    if (command->args.clear)
+    if (command->args.all)
     {
-        UINT8 mask = 0;
-
-        if (command->args.all)
-        {
-            mask = 0x0001F;
-        }
-        else
-        {
-            mask |= command->args.motor ? CONCONFIG_MOTOR_BIT : 0;
-            mask |= command->args.pid ? CONCONFIG_PID_BIT : 0;
-            mask |= command->args.bias ? CONCONFIG_BIAS_BIT : 0;
-            mask |= command->args.debug ? CONCONFIG_DEBUG_BIT : 0;
-        }
-
-        return ConConfig_InitConfigClear(mask, command->args.plain_text);
+        mask = 0x0001F;
     }
-    else if (command->args.show)
+    else
     {
-        UINT8 mask = 0;
-
         mask |= command->args.motor ? CONCONFIG_MOTOR_BIT : 0;
         mask |= command->args.pid ? CONCONFIG_PID_BIT : 0;
         mask |= command->args.bias ? CONCONFIG_BIAS_BIT : 0;
         mask |= command->args.debug ? CONCONFIG_DEBUG_BIT : 0;
-        mask |= command->args.status ? CONCONFIG_STATUS_BIT : 0;
-        mask |= command->args.params ? CONCONFIG_PARAMS_BIT : 0;
+    }
+
+    return ConConfig_InitConfigClear(mask, command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_show_command(COMMAND_TYPE* const command)
+{
+    UINT8 mask = 0;
+
+    mask |= command->args.motor ? CONCONFIG_MOTOR_BIT : 0;
+    mask |= command->args.pid ? CONCONFIG_PID_BIT : 0;
+    mask |= command->args.bias ? CONCONFIG_BIAS_BIT : 0;
+    mask |= command->args.debug ? CONCONFIG_DEBUG_BIT : 0;
+    mask |= command->args.status ? CONCONFIG_STATUS_BIT : 0;
+    mask |= command->args.params ? CONCONFIG_PARAMS_BIT : 0;
+
+    return ConConfig_InitConfigShow(mask, command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_rate_command(COMMAND_TYPE* const command)
+{
+    return ConConfig_InitConfigRate(STR_TO_INT(command->args.enc_rate), 
+                                    STR_TO_INT(command->args.pid_rate), 
+                                    STR_TO_INT(command->args.odom_rate), 
+                                    STR_TO_INT(command->args.outer_rate), 
+                                    command->args.save, 
+                                    command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_bench_command(COMMAND_TYPE* const command)
+{
+    return ConConfig_InitConfigBench(command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_export_command(COMMAND_TYPE* const command)
+{
+    UINT8 sections = 0;
+
+    sections |= command->args.motor ? CALSNAP_MOTOR_BIT : 0;
+    sections |= command->args.pid ? CALSNAP_PID_BIT : 0;
+    sections |= command->args.bias ? CALSNAP_BIAS_BIT : 0;
+    sections |= command->args.rate ? CALSNAP_RATE_BIT : 0;
+
+    return ConConfig_InitConfigExport(sections ? sections : CALSNAP_ALL_BITS, command->args.binary, command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_import_command(COMMAND_TYPE* const command)
+{
+    CONCONFIG_IMPORT_ACTION_TYPE action;
+
+    action = command->args.begin ? CONCONFIG_IMPORT_BEGIN :
+             command->args.commit ? CONCONFIG_IMPORT_COMMIT :
+             command->args.abort ? CONCONFIG_IMPORT_ABORT : CONCONFIG_IMPORT_DATA;
+
+    return ConConfig_InitConfigImport(action, command->args.data, command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_accel_command(COMMAND_TYPE* const command)
+{
+    return ConConfig_InitConfigAccel(STR_TO_FLOAT(command->args.lin_accel), 
+                                     STR_TO_FLOAT(command->args.lin_jerk), 
+                                     STR_TO_FLOAT(command->args.ang_accel), 
+                                     STR_TO_FLOAT(command->args.ang_jerk), 
+                                     command->args.plain_text);
+}
 
-        return ConConfig_InitConfigShow(mask, command->args.plain_text);
+static CONCMD_IF_PTR_TYPE validate_config_shape_command(COMMAND_TYPE* const command)
+{
+    return ConConfig_InitConfigShape(command->args.curvature, 
+                                     command->args.angular, 
+                                     command->args.reset, 
+                                     command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_refine_command(COMMAND_TYPE* const command)
+{
+    return ConConfig_InitConfigRefine(command->args.enable, 
+                                      command->args.disable, 
+                                      command->args.plain_text);
+}
+
+static CONCMD_IF_PTR_TYPE validate_config_debug_command(COMMAND_TYPE* const command)
+{
+    UINT16 mask = 0;
+
+    if (command->args.all)
+    {
+        mask = 0x03FF;
+    }
+    else if (command->args.mask)
+    {
+        mask = STR_TO_INT(command->args.mask);
     }
-    else if (command->args.debug)
+    else
     {
-        UINT16 mask = 0;
+        mask |= command->args.lenc ? DEBUG_LEFT_ENCODER_ENABLE_BIT : 0;
+        mask |= command->args.renc ? DEBUG_RIGHT_ENCODER_ENABLE_BIT : 0;
+        mask |= command->args.lpid ? DEBUG_LEFT_PID_ENABLE_BIT : 0;
+        mask |= command->args.rpid ? DEBUG_RIGHT_PID_ENABLE_BIT : 0;
+        mask |= command->args.lmotor ? DEBUG_LEFT_MOTOR_ENABLE_BIT : 0;
+        mask |= command->args.rmotor ? DEBUG_RIGHT_MOTOR_ENABLE_BIT : 0;
+        mask |= command->args.odom ? DEBUG_ODOM_ENABLE_BIT : 0;
+        mask |= command->args.trace ? DEBUG_TRACE_ENABLE_BIT : 0;
+    }
 
-        if (command->args.all)
-        {
-            mask = 0x03FF;
-        }
-        else if (command->args.mask)
-        {
-            mask = STR_TO_INT(command->args.mask);
-        }
-        else
-        {
-            mask |= command->args.lenc ? DEBUG_LEFT_ENCODER_ENABLE_BIT : 0;
-            mask |= command->args.renc ? DEBUG_RIGHT_ENCODER_ENABLE_BIT : 0;
-            mask |= command->args.lpid ? DEBUG_LEFT_PID_ENABLE_BIT : 0;
-            mask |= command->args.rpid ? DEBUG_RIGHT_PID_ENABLE_BIT : 0;
-            mask |= command->args.lmotor ? DEBUG_LEFT_MOTOR_ENABLE_BIT : 0;
-            mask |= command->args.rmotor ? DEBUG_RIGHT_MOTOR_ENABLE_BIT : 0;
-            mask |= command->args.odom ? DEBUG_ODOM_ENABLE_BIT : 0;
-        }
+    return ConConfig_InitConfigDebug(command->args.enable, mask);
+}
+
+static CONCMD_IF_PTR_TYPE validate_motor_move_command(COMMAND_TYPE* const command)
+{
+    return ConMotor_InitMotorMove(
+        STR_TO_FLOAT(command->args.left_speed),
+        STR_TO_FLOAT(command->args.right_speed),
+        STR_TO_FLOAT(command->args.duration),
+        command->args.no_pid,
+        command->args.no_accel);
+}
+
+static CONCMD_IF_PTR_TYPE validate_motor_show_command(COMMAND_TYPE* const command)
+{
+    int wheel;
 
-        return ConConfig_InitConfigDebug(command->args.enable, mask);
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+
+    if (wheel >= 0)
+    {
+        return ConMotor_InitMotorShow(wheel, command->args.plain_text);
     }
 
     return (CONCMD_IF_TYPE *) NULL;
 }
 
-static CONCMD_IF_PTR_TYPE validate_motor_command(COMMAND_TYPE* const command)
+static CONCMD_IF_PTR_TYPE validate_motor_rep_command(COMMAND_TYPE* const command)
 {
-    if (command->args.show)
-    {
-        int wheel;
+    int wheel;
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
+    wheel = GET_WHEEL(command->args.left, command->args.right);
 
-        if (wheel >= 0)
-        {
-            return ConMotor_InitMotorShow(wheel, command->args.plain_text);
-        }
-    }
-    else if (command->args.rep)
+    if (wheel >= 0)
     {
-        int wheel;
+        return ConMotor_InitMotorRepeat(
+            (WHEEL_TYPE) wheel,
+            STR_TO_FLOAT(command->args.first),
+            STR_TO_FLOAT(command->args.second),
+            STR_TO_FLOAT(command->args.intvl),
+            (UINT8) STR_TO_INT(command->args.iters),
+            command->args.no_pid,
+            command->args.no_accel);
+    }
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
+    return (CONCMD_IF_TYPE *) NULL;
+}
 
-        if (wheel >= 0)
-        {
-            return ConMotor_InitMotorRepeat(
-                (WHEEL_TYPE) wheel,
-                STR_TO_FLOAT(command->args.first),
-                STR_TO_FLOAT(command->args.second),
-                STR_TO_FLOAT(command->args.intvl),
-                (UINT8) STR_TO_INT(command->args.iters),
-                command->args.no_pid,
-                command->args.no_accel);
-        }
-    }
-    else if (command->args.cal)
-    {   
-        int wheel;
-        UINT8 iters;
+static CONCMD_IF_PTR_TYPE validate_motor_cal_command(COMMAND_TYPE* const command)
+{
+    int wheel;
+    UINT8 iters;
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
-        iters = (UINT8) STR_TO_INT(command->args.iters);
-        if (wheel >= 0)
-        {
-            return ConMotor_InitMotorCal(
-                (WHEEL_TYPE) wheel,
-                iters);
-        }
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+    iters = (UINT8) STR_TO_INT(command->args.iters);
+    if (wheel >= 0)
+    {
+        return ConMotor_InitMotorCal(
+            (WHEEL_TYPE) wheel,
+            iters,
+            command->args.parallel);
     }
-    else if (command->args.val)
+
+    return (CONCMD_IF_TYPE *) NULL;
+}
+
+static CONCMD_IF_PTR_TYPE validate_motor_val_command(COMMAND_TYPE* const command)
+{
+    int wheel;
+    int direction;
+
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+    direction = GET_DIRECTON(command->args.forward, command->args.backward);
+
+    if (wheel >= 0 && direction >= 0)
     {
-        int wheel;
-        int direction;
+        return ConMotor_InitMotorVal(
+            (WHEEL_TYPE) wheel,
+            (DIR_TYPE) direction,
+            STR_TO_FLOAT(command->args.min_percent),
+            STR_TO_FLOAT(command->args.max_percent),
+            (UINT8) STR_TO_INT(command->args.num_points));
+    }
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
-        direction = GET_DIRECTON(command->args.forward, command->args.backward);
+    return (CONCMD_IF_TYPE *) NULL;
+}
 
-        if (wheel >= 0 && direction >= 0)
-        {
-            return ConMotor_InitMotorVal(
-                (WHEEL_TYPE) wheel,
-                (DIR_TYPE) direction,
-                STR_TO_FLOAT(command->args.min_percent),
-                STR_TO_FLOAT(command->args.max_percent),
-                (UINT8) STR_TO_INT(command->args.num_points));
-        }
+static CONCMD_IF_PTR_TYPE validate_pid_cascade_command(COMMAND_TYPE* const command)
+{
+    UINT8 mask = 0;
+
+    mask |= command->args.linear ? CONPID_CASCADE_LINEAR_BIT : 0;
+    mask |= command->args.angular ? CONPID_CASCADE_ANGULAR_BIT : 0;
+
+    if (command->args.show)
+    {
+        return ConPid_InitPidCascade(CONPID_CASCADE_SHOW, mask, NULL, command->args.plain_text);
     }
-    else
+    else if (command->args.enable || command->args.disable)
     {
-        return ConMotor_InitMotorMove(
-            STR_TO_FLOAT(command->args.left_speed),
-            STR_TO_FLOAT(command->args.right_speed),
-            STR_TO_FLOAT(command->args.duration),
-            command->args.no_pid,
-            command->args.no_accel);
+        return ConPid_InitPidCascade(command->args.enable ? CONPID_CASCADE_ENABLE : CONPID_CASCADE_DISABLE, 
+                                     mask, 
+                                     NULL, 
+                                     command->args.plain_text);
+    }
+    else if (command->args.gains)
+    {
+        return ConPid_InitPidCascade(CONPID_CASCADE_GAINS, mask, command->args.gains, command->args.plain_text);
     }
 
     return (CONCMD_IF_TYPE *) NULL;
 }
 
-static CONCMD_IF_PTR_TYPE validate_pid_command(COMMAND_TYPE* const command)
+static CONCMD_IF_PTR_TYPE validate_pid_show_command(COMMAND_TYPE* const command)
 {
-    if (command->args.show)
+    int wheel;
+
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+
+    if (wheel >= 0)
     {
-        int wheel;
+        return ConPid_InitPidShow(wheel, command->args.plain_text);
+    }
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
+    return (CONCMD_IF_TYPE *) NULL;
+}
 
-        if (wheel >= 0)
-        {
-            return ConPid_InitPidShow(wheel, command->args.plain_text);
-        }
+static CONCMD_IF_PTR_TYPE validate_pid_cal_command(COMMAND_TYPE* const command)
+{
+    int wheel;
+    FLOAT step;
+
+    step = 0.0;
+
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+    if (command->args.step)
+    {
+        step = STR_TO_FLOAT(command->args.step);
     }
-    else if (command->args.cal)
+
+    if (wheel >= 0)
     {
-        int wheel;
-        FLOAT step;
+        return ConPid_InitPidCal(wheel,
+                                 command->args.impulse,
+                                 step,
+                                 command->args.with_debug,
+                                 command->args.binary);
+    }
 
-        step = 0.0;
+    return (CONCMD_IF_TYPE *) NULL;
+}
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
-        if (command->args.step)
-        {
-            step = STR_TO_FLOAT(command->args.step);
-        }
+static CONCMD_IF_PTR_TYPE validate_pid_sched_command(COMMAND_TYPE* const command)
+{
+    int wheel;
 
-        if (wheel >= 0)
-        {
-            return ConPid_InitPidCal(wheel,
-                                                command->args.impulse,
-                                                step,
-                                                command->args.with_debug);
-        }
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+
+    if (wheel >= 0)
+    {
+        return ConPid_InitPidSched(wheel,
+                                   command->args.clear,
+                                   STR_TO_INT(command->args.band),
+                                   STR_TO_INT(command->args.cps),
+                                   command->args.gains);
     }
-    else if (command->args.val)
+
+    return (CONCMD_IF_TYPE *) NULL;
+}
+
+static CONCMD_IF_PTR_TYPE validate_pid_tune_command(COMMAND_TYPE* const command)
+{
+    int wheel;
+
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+
+    if (wheel >= 0)
     {
-        int wheel;
-        int direction;
+        return ConPid_InitPidTune(wheel, command->args.rule);
+    }
 
-        wheel = GET_WHEEL(command->args.left, command->args.right);
-        direction = GET_DIRECTON(command->args.forward, command->args.backward);
+    return (CONCMD_IF_TYPE *) NULL;
+}
 
-        if (wheel >= 0 && direction >= 0)
-        {
-            return ConPid_InitPidVal(
-                wheel,
-                direction,
-                STR_TO_FLOAT(command->args.min_percent),
-                STR_TO_FLOAT(command->args.max_percent),
-                STR_TO_INT(command->args.num_points));
-        }
+static CONCMD_IF_PTR_TYPE validate_pid_val_command(COMMAND_TYPE* const command)
+{
+    int wheel;
+    int direction;
+
+    wheel = GET_WHEEL(command->args.left, command->args.right);
+    direction = GET_DIRECTON(command->args.forward, command->args.backward);
+
+    if (wheel >= 0 && direction >= 0)
+    {
+        return ConPid_InitPidVal(
+            wheel,
+            direction,
+            STR_TO_FLOAT(command->args.min_percent),
+            STR_TO_FLOAT(command->args.max_percent),
+            STR_TO_INT(command->args.num_points));
     }
 
     return (CONCMD_IF_TYPE *) NULL;
@@ -299,28 +502,639 @@ static CONCMD_IF_PTR_TYPE validate_motion_val_commands(COMMAND_TYPE* const comma
     return (CONCMD_IF_TYPE *) NULL;
 }
 
-static CONCMD_IF_PTR_TYPE validate_motion_command(COMMAND_TYPE* const command)
+/* Path start drives the wheels until the path ends, the other path commands only edit or show the path */
+static UINT8 claim_motion_path(COMMAND_TYPE* const command)
+{
+    return command->args.start ? DISP_RESOURCE_MOTORS : 0;
+}
+
+static CONCMD_IF_PTR_TYPE validate_motion_path_command(COMMAND_TYPE* const command)
 {
-    if (command->args.cal)
+    if (command->args.add)
     {
-        return validate_motion_cal_commands(command);
+        return ConMotion_InitMotionPath(CONMOTION_PATH_ADD, command->args.points, NAN, NAN, FALSE);
     }
-    else if (command->args.val)
+    else if (command->args.start)
     {
-        return validate_motion_val_commands(command);
+        return ConMotion_InitMotionPath(CONMOTION_PATH_START, 
+                                        NULL, 
+                                        STR_TO_FLOAT(command->args.linear_speed), 
+                                        STR_TO_FLOAT(command->args.lookahead), 
+                                        FALSE);
+    }
+    else if (command->args.stop || command->args.clear)
+    {
+        return ConMotion_InitMotionPath(command->args.stop ? CONMOTION_PATH_STOP : CONMOTION_PATH_CLEAR, NULL, NAN, NAN, FALSE);
+    }
+    else if (command->args.show)
+    {
+        return ConMotion_InitMotionPath(CONMOTION_PATH_SHOW, NULL, NAN, NAN, command->args.plain_text);
     }
 
     return (CONCMD_IF_TYPE *) NULL;
 }
 
+static JOB_TYPE * find_job(UINT8 id)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
+    {
+        if (jobs[ii].cmd && jobs[ii].id == id)
+        {
+            return &jobs[ii];
+        }
+    }
+
+    return (JOB_TYPE *) NULL;
+}
+
+static JOB_TYPE * find_free_job(void)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
+    {
+        if (jobs[ii].cmd == NULL)
+        {
+            return &jobs[ii];
+        }
+    }
+
+    return (JOB_TYPE *) NULL;
+}
+
+static JOB_TYPE * find_job_claiming(UINT8 resources)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
+    {
+        if (jobs[ii].cmd && (jobs[ii].resources & resources))
+        {
+            return &jobs[ii];
+        }
+    }
+
+    return (JOB_TYPE *) NULL;
+}
+
+static void kill_job(JOB_TYPE * const job)
+{
+    if (job->cmd->stop)
+    {
+        job->cmd->stop();
+    }
+
+    Ser_PutStringFormat("killed %d: %s\r\n", job->id, conparser_routes[job->route]);
+    job->cmd = (CONCMD_IF_TYPE *) NULL;
+    num_killed++;
+}
+
+/*-------------------------------------------------------------------
+    Jobs
+*/
+static CONCMD_IF_PTR_TYPE validate_jobs_command(COMMAND_TYPE* const command)
+{
+    jobs_plain_text = command->args.plain_text;
+    return &disp_cmd_if_array[DISP_JOBS];
+}
+
+static BOOL jobs_update(void)
+{
+    return FALSE;
+}
+
+static BOOL jobs_status(void)
+{
+    return FALSE;
+}
+
+static void jobs_results(void)
+{
+    UINT8 ii;
+    UINT8 count = 0;
+
+    if (!jobs_plain_text)
+    {
+        Ser_PutString("{\"jobs\":[");
+    }
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
+    {
+        if (jobs[ii].cmd)
+        {
+            if (jobs_plain_text)
+            {
+                Ser_PutStringFormat("%d: %s (resources 0x%02x)\r\n", jobs[ii].id, conparser_routes[jobs[ii].route], jobs[ii].resources);
+            }
+            else
+            {
+                Ser_PutStringFormat("%s{\"id\":%d,\"command\":\"%s\",\"resources\":%d}", 
+                                    count > 0 ? "," : "", 
+                                    jobs[ii].id, 
+                                    conparser_routes[jobs[ii].route], 
+                                    jobs[ii].resources);
+            }
+            count++;
+        }
+    }
+
+    if (!jobs_plain_text)
+    {
+        Ser_PutString("]}\r\n");
+    }
+    else if (count == 0)
+    {
+        Ser_PutString("no jobs\r\n");
+    }
+}
+
+/*-------------------------------------------------------------------
+    Kill
+*/
+static CONCMD_IF_PTR_TYPE validate_kill_command(COMMAND_TYPE* const command)
+{
+    JOB_TYPE *job;
+    UINT8 ii;
+
+    num_killed = 0;
+
+    if (command->args.all)
+    {
+        for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
+        {
+            if (jobs[ii].cmd)
+            {
+                kill_job(&jobs[ii]);
+            }
+        }
+
+        return &disp_cmd_if_array[DISP_KILL];
+    }
+
+    job = IS_VALID_INT(STR_TO_INT(command->args.id)) ? find_job((UINT8) STR_TO_INT(command->args.id)) : NULL;
+    if (job)
+    {
+        kill_job(job);
+        return &disp_cmd_if_array[DISP_KILL];
+    }
+
+    return (CONCMD_IF_TYPE *) NULL;
+}
+
+static BOOL kill_update(void)
+{
+    return FALSE;
+}
+
+static BOOL kill_status(void)
+{
+    return FALSE;
+}
+
+static void kill_results(void)
+{
+    Ser_PutStringFormat("%d job(s) killed\r\n", num_killed);
+}
+
+/*-------------------------------------------------------------------
+    Macros
+*/
+
+/* A command is recorded, and replayed, as a macro step if it is dispatched as a job that claims a resource.  The
+   macro commands, jobs, kill and help are not.
+*/
+static BOOL is_recordable(ROUTE_TYPE const * const route)
+{
+    return route->validate && route->resources && !(route->resources & DISP_RESOURCE_CONMACRO);
+}
+
+static CONCMD_IF_PTR_TYPE edit_macro(CONPARSER_ROUTE_TYPE route, MACRO_RESULT_TYPE result)
+{
+    macro_edit.route = route;
+    macro_edit.result = result;
+    return &disp_cmd_if_array[DISP_MACRO];
+}
+
+static CONCMD_IF_PTR_TYPE validate_macro_step(COMMAND_TYPE* const command)
+{
+    return edit_macro(command->args.route, Macro_Record(&command->args));
+}
+
+static CONCMD_IF_PTR_TYPE validate_macro_record_command(COMMAND_TYPE* const command)
+{
+    return edit_macro(CONPARSER_ROUTE_MACRO_RECORD, Macro_Begin(command->args.name));
+}
+
+static CONCMD_IF_PTR_TYPE validate_macro_end_command(COMMAND_TYPE* const command)
+{
+    macro_edit.num_steps = 0;
+    return edit_macro(CONPARSER_ROUTE_MACRO_END, Macro_End(&macro_edit.num_steps));
+}
+
+static CONCMD_IF_PTR_TYPE validate_macro_delete_command(COMMAND_TYPE* const command)
+{
+    if (command->args.all)
+    {
+        Macro_Clear();
+        return edit_macro(CONPARSER_ROUTE_MACRO_DELETE, MACRO_OK);
+    }
+
+    return edit_macro(CONPARSER_ROUTE_MACRO_DELETE, Macro_Delete(command->args.name));
+}
+
+static BOOL macro_update(void)
+{
+    return FALSE;
+}
+
+static BOOL macro_status(void)
+{
+    return FALSE;
+}
+
+static void macro_results(void)
+{
+    if (macro_edit.route == CONPARSER_ROUTE_MACRO_END && macro_edit.result == MACRO_OK)
+    {
+        Ser_PutStringFormat("%d step(s) recorded\r\n", macro_edit.num_steps);
+    }
+    else
+    {
+        Ser_PutStringFormat("%s: %s\r\n", conparser_routes[macro_edit.route], Macro_GetResultString(macro_edit.result));
+    }
+}
+
+/* The steps of a macro claim their resources for as long as the macro runs.  Steps whose route claims more than its
+   resources are loaded so that the route can look at the arguments.
+*/
+static UINT8 claim_macro_run(COMMAND_TYPE* const command)
+{
+    static COMMAND_TYPE step;
+    MACRO_CURSOR_TYPE cursor;
+    ROUTE_TYPE const *route;
+    UINT8 resources = 0;
+
+    if (Macro_Open(command->args.name, &cursor) == MACRO_OK)
+    {
+        while (Macro_NextStep(&cursor) == MACRO_OK)
+        {
+            if (cursor.code[0] >= CONPARSER_ROUTE_LAST)
+            {
+                continue;
+            }
+
+            route = &routes[cursor.code[0]];
+            resources |= route->resources;
+            if (route->claim && ConParser_Load(cursor.code, cursor.length, &step.args) == CONPARSER_OK)
+            {
+                resources |= route->claim(&step);
+            }
+        }
+    }
+
+    return resources;
+}
+
+static CONCMD_IF_PTR_TYPE validate_macro_run_command(COMMAND_TYPE* const command)
+{
+    MACRO_RESULT_TYPE result;
+
+    result = Macro_Open(command->args.name, &macro_run.cursor);
+    if (result != MACRO_OK)
+    {
+        Ser_PutStringFormat("\r\nmacro run: %s\r\n", Macro_GetResultString(result));
+        return (CONCMD_IF_TYPE *) NULL;
+    }
+
+    macro_run.cmd = (CONCMD_IF_TYPE *) NULL;
+    macro_run.num_deferred = 0;
+    macro_run.deferred_resources = 0;
+    macro_run.num_done = 0;
+    macro_run.result = MACRO_OK;
+    macro_run.is_done = FALSE;
+    macro_run.plain_text = command->args.plain_text;
+
+    return &disp_cmd_if_array[DISP_MACRO_RUN];
+}
+
+static void report_deferred_results(void)
+{
+    UINT8 ii;
+
+    for (ii = 0; ii < macro_run.num_deferred; ++ii)
+    {
+        if (macro_run.deferred[ii]->results)
+        {
+            macro_run.deferred[ii]->results();
+        }
+    }
+
+    macro_run.num_deferred = 0;
+    macro_run.deferred_resources = 0;
+}
+
+static BOOL start_macro_step(void)
+{
+    ROUTE_TYPE const *route;
+    MACRO_RESULT_TYPE result;
+
+    result = Macro_NextStep(&macro_run.cursor);
+    if (result != MACRO_OK)
+    {
+        macro_run.result = result == MACRO_NOT_FOUND ? MACRO_OK : result;
+        return FALSE;
+    }
+
+    /* The step is loaded from its compiled form, i.e., it is not parsed again */
+    if (ConParser_Load(macro_run.cursor.code, macro_run.cursor.length, &macro_run.command.args) != CONPARSER_OK)
+    {
+        macro_run.result = MACRO_STALE;
+        return FALSE;
+    }
+
+    route = &routes[macro_run.command.args.route];
+    if (!is_recordable(route))
+    {
+        macro_run.result = MACRO_NOT_ALLOWED;
+        return FALSE;
+    }
+
+    /* Note: The ConXXX modules keep a single copy of the command state, and a calibration holds the arena until its
+       results are reported (e.g., motor cal releases it for pid cal), so the deferred results are reported before a
+       step of the same module, or any step while the arena is in use, is started
+    */
+    if ((macro_run.deferred_resources & route->resources & ~DISP_RESOURCE_MOTORS) ||
+        Arena_GetOwner() != ARENA_OWNER_NONE)
+    {
+        report_deferred_results();
+    }
+
+    macro_run.cmd = route->validate(&macro_run.command);
+    if (macro_run.cmd == NULL)
+    {
+        macro_run.result = MACRO_BAD_STEP;
+        return FALSE;
+    }
+
+    macro_run.route = macro_run.command.args.route;
+
+    return TRUE;
+}
+
+static BOOL macro_run_update(void)
+{
+    if (macro_run.cmd)
+    {
+        if (macro_run.cmd->update)
+        {
+            macro_run.cmd->update();
+        }
+
+        if (macro_run.cmd->status && macro_run.cmd->status())
+        {
+            return TRUE;
+        }
+
+        if (macro_run.num_deferred == MAX_DEFERRED_RESULTS)
+        {
+            report_deferred_results();
+        }
+
+        macro_run.deferred[macro_run.num_deferred] = macro_run.cmd;
+        macro_run.deferred_resources |= routes[macro_run.route].resources;
+        macro_run.num_deferred++;
+        macro_run.num_done++;
+        macro_run.cmd = (CONCMD_IF_TYPE *) NULL;
+    }
+
+    /* Note: The next step starts as soon as the previous step is done */
+    if (!macro_run.is_done && !start_macro_step())
+    {
+        macro_run.is_done = TRUE;
+    }
+
+    return !macro_run.is_done;
+}
+
+static BOOL macro_run_status(void)
+{
+    return !macro_run.is_done;
+}
+
+static void macro_run_results(void)
+{
+    report_deferred_results();
+
+    if (macro_run.plain_text)
+    {
+        Ser_PutStringFormat("macro %s: %d of %d step(s) done, %s\r\n", 
+                            macro_run.cursor.name, 
+                            macro_run.num_done, 
+                            macro_run.cursor.num_steps, 
+                            Macro_GetResultString(macro_run.result));
+    }
+    else
+    {
+        Ser_PutStringFormat("{\"macro\":\"%s\",\"steps\":%d,\"done\":%d,\"result\":\"%s\"}\r\n", 
+                            macro_run.cursor.name, 
+                            macro_run.cursor.num_steps, 
+                            macro_run.num_done, 
+                            Macro_GetResultString(macro_run.result));
+    }
+}
+
+static void macro_run_stop(void)
+{
+    if (macro_run.cmd && macro_run.cmd->stop)
+    {
+        macro_run.cmd->stop();
+    }
+
+    macro_run.cmd = (CONCMD_IF_TYPE *) NULL;
+    macro_run.num_deferred = 0;
+    macro_run.deferred_resources = 0;
+    macro_run.is_done = TRUE;
+}
+
+/* The output is sent a chunk per update (see Emit_Chunk) */
+static CONCMD_IF_PTR_TYPE validate_macro_show_command(COMMAND_TYPE* const command)
+{
+    macro_show_plain_text = command->args.plain_text;
+    Emit_StreamInit(&macro_show_stream);
+    is_macro_show_running = TRUE;
+    return &disp_cmd_if_array[DISP_MACRO_SHOW];
+}
+
+static void macro_show_emit(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+    CHAR line[MAX_LINE_LENGTH];
+    UINT8 ii;
+
+    if (!macro_show_plain_text)
+    {
+        Emit_ObjectBegin(NULL);
+        Emit_ArrayBegin("macros");
+    }
+
+    for (ii = 0; Macro_OpenIndex(ii, &cursor) == MACRO_OK; ++ii)
+    {
+        if (macro_show_plain_text)
+        {
+            Emit_String(cursor.name);
+            Emit_Char(':');
+            Emit_Newline();
+        }
+        else
+        {
+            Emit_ObjectBegin(NULL);
+            Emit_KeyString("name", cursor.name);
+            Emit_ArrayBegin("steps");
+        }
+
+        while (Macro_NextStep(&cursor) == MACRO_OK)
+        {
+            if (ConParser_Decompile(cursor.code, cursor.length, line, sizeof line) == 0)
+            {
+                strcpy(line, "?");
+            }
+
+            if (macro_show_plain_text)
+            {
+                Emit_String("    ");
+                Emit_String(line);
+                Emit_Newline();
+            }
+            else
+            {
+                Emit_ItemString(line);
+            }
+        }
+
+        if (!macro_show_plain_text)
+        {
+            Emit_ArrayEnd();
+            Emit_ObjectEnd();
+        }
+    }
+
+    if (macro_show_plain_text)
+    {
+        if (Macro_IsStale())
+        {
+            Emit_String("stale macros (recorded with different console commands)");
+            Emit_Newline();
+        }
+        else if (ii == 0)
+        {
+            Emit_String("no macros");
+            Emit_Newline();
+        }
+        Emit_String("free: ");
+        Emit_Int(Macro_GetFree());
+        Emit_String(" bytes");
+        Emit_Newline();
+    }
+    else
+    {
+        Emit_ArrayEnd();
+        Emit_KeyInt("free", Macro_GetFree());
+        Emit_KeyBool("stale", Macro_IsStale());
+        Emit_KeyBool("recording", Macro_IsRecording());
+        Emit_ObjectEnd();
+        Emit_Newline();
+    }
+
+    Emit_Flush();
+}
+
+static BOOL macro_show_update(void)
+{
+    is_macro_show_running = Emit_Chunk(&macro_show_stream, macro_show_emit);
+    return is_macro_show_running;
+}
+
+static BOOL macro_show_status(void)
+{
+    return is_macro_show_running;
+}
+
+static void macro_show_stop(void)
+{
+    Emit_Cancel(&macro_show_stream);
+    is_macro_show_running = FALSE;
+}
+
+/* Note: The parser selects the route from the leading command words, so each validate function only sees its
+   own command.  Routes without an entry, e.g., help, are not dispatched.
+
+   Each command claims the module that owns it (the ConXXX modules keep a single copy of the command state) and,
+   if it drives the wheels, the motors.  Commands that do not share a resource run concurrently, e.g., config show
+   while motion val square is running.
+*/
+static const ROUTE_TYPE routes[CONPARSER_ROUTE_LAST] = {
+    [CONPARSER_ROUTE_MOTOR] = {validate_motor_move_command, DISP_RESOURCE_CONMOTOR | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTOR_REP] = {validate_motor_rep_command, DISP_RESOURCE_CONMOTOR | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTOR_SHOW] = {validate_motor_show_command, DISP_RESOURCE_CONMOTOR},
+    [CONPARSER_ROUTE_MOTOR_CAL] = {validate_motor_cal_command, DISP_RESOURCE_CONMOTOR | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTOR_VAL] = {validate_motor_val_command, DISP_RESOURCE_CONMOTOR | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_PID_CAL] = {validate_pid_cal_command, DISP_RESOURCE_CONPID | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_PID_VAL] = {validate_pid_val_command, DISP_RESOURCE_CONPID | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_PID_SHOW] = {validate_pid_show_command, DISP_RESOURCE_CONPID},
+    [CONPARSER_ROUTE_PID_TUNE] = {validate_pid_tune_command, DISP_RESOURCE_CONPID | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_PID_SCHED] = {validate_pid_sched_command, DISP_RESOURCE_CONPID},
+    [CONPARSER_ROUTE_PID_CASCADE] = {validate_pid_cascade_command, DISP_RESOURCE_CONPID},
+    [CONPARSER_ROUTE_CONFIG_DEBUG] = {validate_config_debug_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_SHOW] = {validate_config_show_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_CLEAR] = {validate_config_clear_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_RATE] = {validate_config_rate_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_ACCEL] = {validate_config_accel_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_SHAPE] = {validate_config_shape_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_REFINE] = {validate_config_refine_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_BENCH] = {validate_config_bench_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_EXPORT] = {validate_config_export_command, DISP_RESOURCE_CONCONFIG},
+    [CONPARSER_ROUTE_CONFIG_IMPORT] = {validate_config_import_command, DISP_RESOURCE_CONCONFIG | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTION_CAL] = {validate_motion_cal_commands, DISP_RESOURCE_CONMOTION | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTION_VAL] = {validate_motion_val_commands, DISP_RESOURCE_CONMOTION | DISP_RESOURCE_MOTORS},
+    [CONPARSER_ROUTE_MOTION_PATH] = {validate_motion_path_command, DISP_RESOURCE_CONMOTION, claim_motion_path},
+    [CONPARSER_ROUTE_JOBS] = {validate_jobs_command, 0},
+    [CONPARSER_ROUTE_KILL] = {validate_kill_command, 0},
+    [CONPARSER_ROUTE_MACRO_RECORD] = {validate_macro_record_command, DISP_RESOURCE_CONMACRO},
+    [CONPARSER_ROUTE_MACRO_END] = {validate_macro_end_command, DISP_RESOURCE_CONMACRO},
+    [CONPARSER_ROUTE_MACRO_RUN] = {validate_macro_run_command, DISP_RESOURCE_CONMACRO, claim_macro_run},
+    [CONPARSER_ROUTE_MACRO_SHOW] = {validate_macro_show_command, DISP_RESOURCE_CONMACRO},
+    [CONPARSER_ROUTE_MACRO_DELETE] = {validate_macro_delete_command, DISP_RESOURCE_CONMACRO},
+};
+
 /*---------------------------------------------------------------------------------------------------
  * Module Interface
  *-------------------------------------------------------------------------------------------------*/    
 
 void Disp_Init(void)
 {
-    p_active_command = (CONCMD_IF_TYPE *) NULL;
+    memset(jobs, 0, sizeof jobs);
+    last_job_id = 0;
+
+    disp_cmd_if_array[DISP_JOBS].update = jobs_update;
+    disp_cmd_if_array[DISP_JOBS].status = jobs_status;
+    disp_cmd_if_array[DISP_JOBS].results = jobs_results;
+    disp_cmd_if_array[DISP_KILL].update = kill_update;
+    disp_cmd_if_array[DISP_KILL].status = kill_status;
+    disp_cmd_if_array[DISP_KILL].results = kill_results;
+    disp_cmd_if_array[DISP_MACRO].update = macro_update;
+    disp_cmd_if_array[DISP_MACRO].status = macro_status;
+    disp_cmd_if_array[DISP_MACRO].results = macro_results;
+    disp_cmd_if_array[DISP_MACRO_RUN].update = macro_run_update;
+    disp_cmd_if_array[DISP_MACRO_RUN].status = macro_run_status;
+    disp_cmd_if_array[DISP_MACRO_RUN].results = macro_run_results;
+    disp_cmd_if_array[DISP_MACRO_RUN].stop = macro_run_stop;
+    disp_cmd_if_array[DISP_MACRO_SHOW].update = macro_show_update;
+    disp_cmd_if_array[DISP_MACRO_SHOW].status = macro_show_status;
+    disp_cmd_if_array[DISP_MACRO_SHOW].stop = macro_show_stop;
     
+    Macro_Init();
     ConConfig_Init();
     ConMotor_Init();
     ConPid_Init();
@@ -335,60 +1149,146 @@ void Disp_Start(void)
     ConMotion_Start();
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Disp_IsRunning
+ * Description: Reports whether any job is in the job table.
+ * Parameters: None
+ * Return: TRUE if at least one job is running or has results pending, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
 BOOL Disp_IsRunning(void)
 {
-    if (p_active_command && p_active_command->status)
+    UINT8 ii;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
     {
-        return p_active_command->status();
+        if (jobs[ii].cmd)
+        {
+            return TRUE;
+        }
     }
     
     return FALSE;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Disp_Update
+ * Description: Updates every running job.  A job whose update returns FALSE is done and its results are
+ *              reported by the next call to Disp_Results.
+ * Parameters: None
+ * Return: TRUE if at least one job is still running, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
 BOOL Disp_Update()
 {
-    if (p_active_command && p_active_command->update)
+    UINT8 ii;
+    BOOL is_running = FALSE;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
     {
-        return p_active_command->update();
+        if (jobs[ii].cmd && jobs[ii].cmd->update && jobs[ii].cmd->update())
+        {
+            is_running = TRUE;
+        }
     }
     
-    return FALSE;
+    return is_running;
 }
 
-void Disp_Results()
+/*---------------------------------------------------------------------------------------------------
+ * Name: Disp_Results
+ * Description: Reports the results of the jobs that are done and removes them from the job table.
+ * Parameters: None
+ * Return: TRUE if any results were reported, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
+BOOL Disp_Results()
 {
-    if (p_active_command && p_active_command->results)
+    UINT8 ii;
+    CONCMD_IF_TYPE *cmd;
+    BOOL is_reported = FALSE;
+
+    for (ii = 0; ii < DISP_MAX_JOBS; ++ii)
     {
-        p_active_command->results();
+        cmd = jobs[ii].cmd;
+        if (cmd && !(cmd->status && cmd->status()))
+        {
+            /* Note: The job is removed first so it is not listed by its own results, e.g., jobs */
+            jobs[ii].cmd = (CONCMD_IF_TYPE *) NULL;
+            if (cmd->results)
+            {
+                cmd->results();
+            }
+            is_reported = TRUE;
+        }
     }
 
-    p_active_command = (CONCMD_IF_TYPE *) NULL;
+    return is_reported;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Disp_Dispatch
+ * Description: Starts the command as a new job if a job slot is free and none of the resources the
+ *              command claims are claimed by a running job.  While a macro is recorded, the commands
+ *              which can be replayed are stored as steps of the macro instead.
+ * Parameters: command - the parsed command
+ * Return: None (command->is_valid is TRUE if the job was started)
+ * 
+ *-------------------------------------------------------------------------------------------------*/ 
 void Disp_Dispatch(COMMAND_TYPE* const command)
 {
-    p_active_command = (CONCMD_IF_TYPE *) NULL;
+    ROUTE_TYPE const *route;
+    VALIDATE_FUNC_TYPE validate;
+    UINT8 resources;
+    JOB_TYPE *job;
+    JOB_TYPE *busy;
+    CONCMD_IF_TYPE *cmd;
 
-    /* Note: config needs to be checked first to eliminate any ambiguity between config the command and config */
-    if (command->args.config)
+    command->is_valid = FALSE;
+
+    route = command->args.route < CONPARSER_ROUTE_LAST ? &routes[command->args.route] : NULL;
+    if (route == NULL || route->validate == NULL)
     {
-        p_active_command = validate_config_command(command);
+        return;
     }
-    else if (command->args.pid)
+
+    if (Macro_IsRecording() && is_recordable(route))
     {
-        p_active_command = validate_pid_command(command);
+        validate = validate_macro_step;
+        resources = 0;
     }
-    else if (command->args.motor)
-    {   
-        p_active_command = validate_motor_command(command);
+    else
+    {
+        validate = route->validate;
+        resources = route->resources | (route->claim ? route->claim(command) : 0);
     }
-    else if (command->args.motion)
+
+    busy = find_job_claiming(resources);
+    if (busy)
     {
-        p_active_command = validate_motion_command(command);
+        Ser_PutStringFormat("\r\nbusy: job %d (%s) is running\r\n", busy->id, conparser_routes[busy->route]);
+        return;
+    }
+
+    job = find_free_job();
+    if (job == NULL)
+    {
+        Ser_PutString("\r\nbusy: no free job slots\r\n");
+        return;
     }
-    
-    command->is_valid = p_active_command != (CONCMD_IF_TYPE *) NULL ? TRUE : FALSE;    
 
-} 
+    cmd = validate(command);
+    if (cmd)
+    {
+        /* Note: Job ids wrap, but skip 0 so that it never refers to a job */
+        last_job_id = last_job_id == 0xFF ? 1 : last_job_id + 1;
 
-/* [] END OF FILE */
\ No newline at end of file
+        job->cmd = cmd;
+        job->id = last_job_id;
+        job->resources = resources;
+        job->route = command->args.route;
+    }
+    
+    command->is_valid = cmd != (CONCMD_IF_TYPE *) NULL ? TRUE : FALSE;    
+
+}
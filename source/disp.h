@@ -31,6 +31,19 @@ SOFTWARE.
 #include "freesoc.h"
 #include "conparser.h"
     
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/    
+#define DISP_MAX_JOBS (4)
+
+/* Resources claimed by a job.  A job is only started if none of its resources are claimed by a running job. */
+#define DISP_RESOURCE_MOTORS    (0x01)
+#define DISP_RESOURCE_CONCONFIG (0x02)
+#define DISP_RESOURCE_CONMOTOR  (0x04)
+#define DISP_RESOURCE_CONPID    (0x08)
+#define DISP_RESOURCE_CONMOTION (0x10)
+#define DISP_RESOURCE_CONMACRO  (0x20)
+    
 /*---------------------------------------------------------------------------------------------------
  * Types
  *-------------------------------------------------------------------------------------------------*/    
@@ -49,7 +62,7 @@ typedef struct _tag_command
 void Disp_Init(void);
 void Disp_Start(void);
 BOOL Disp_IsRunning(void);
-void Disp_Results();
+BOOL Disp_Results();
 BOOL Disp_Update();
 void Disp_Dispatch(COMMAND_TYPE* const command);
     
@@ -1,12 +1,16 @@
+/* Note: clock_gettime/CLOCK_MONOTONIC (see the benchmark) are POSIX, not ISO C */
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include "conparser.h"
 
 #define ENABLE_MOTOR_TESTS
 //#define ENABLE_PID_TESTS
 
-#define MAX_NUM_ELMS (10)
-#define MAX_STR_LEN (63)
+#define MAX_LINE_LEN (80)
+#define NUM_BENCH_ITERS (20000)
 #ifdef ENABLE_MOTOR_TESTS
 #define NUM_MOTOR_TESTS (48)
 #else
@@ -24,10 +28,7 @@
 
 #define NUM_TESTS (NUM_MOTOR_TESTS+NUM_PID_TESTS)
 
-static char args_strs[MAX_NUM_ELMS][MAX_STR_LEN];
-static char args_ptrs[sizeof(char *) * MAX_NUM_ELMS] = {0};
-
-static char test_strs[NUM_TESTS][80] = {
+static const char test_strs[NUM_TESTS][MAX_LINE_LEN] = {
     /* Motor Options */
 #ifdef ENABLE_MOTOR_TESTS
     "motor --left-speed=0.2",
@@ -186,51 +187,19 @@ static char test_strs[NUM_TESTS][80] = {
 };
 
 
-static void init_args_storage(char **ppargs)
-{
-    int ii;
-    *ppargs = args_ptrs;
-    
-    for (ii = 0; ii < MAX_NUM_ELMS; ++ii)
-    {
-        ppargs[ii] = args_strs[ii];
-    }
-}
-
-static int args_str_array(char *str, char **args)
-{
-   const char s[2] = " ";
-   char *token;
-   int index = 0;
-   int ii;
-   
-   /* get the first token */
-   token = strtok(str, s);
-   
-   /* walk through other tokens */
-   while( token != NULL ) {
-      strcpy(args[index], token);
-      index++;
-      token = strtok(NULL, s);
-   }
-   
-   return index;
-}
-
-static void evaluate_test_string(char *test_str, char **ppargs)
+static void evaluate_test_string(const char *test_str)
 {
-    int num_args;
+    char line[MAX_LINE_LEN];
     DocoptArgs parsed;
-    int success;
+    CONPARSER_RESULT_TYPE result;
 
-    num_args = args_str_array(test_str, ppargs);    
-    parsed = docopt(num_args, ppargs, /* help */ 1, /* version */ "2.0rc2", &success);
-    printf("Success: %d\n", success);
+    strcpy(line, test_str);
+    result = ConParser_Parse(line, &parsed);
+    printf("Result: %d, Route: %d\n", result, parsed.route);
 
     printf("Commands\n");
     printf("    motor == %s\n", parsed.motor ? "true" : "false");
-    printf("    repeat == %s\n", parsed.stop ? "true" : "false");
-    printf("    stop == %s\n", parsed.stop ? "true" : "false");
+    printf("    rep == %s\n", parsed.rep ? "true" : "false");
     printf("    show == %s\n", parsed.show ? "true" : "false");
     printf("    left == %s\n", parsed.left ? "true" : "false");
     printf("    right == %s\n", parsed.right ? "true" : "false");
@@ -277,22 +246,50 @@ static void evaluate_test_string(char *test_str, char **ppargs)
     //return parsed;
 }
 
-int main(int argc, char *argv[])
+/* Parses every test string NUM_BENCH_ITERS times and reports the average time per line */
+static void benchmark(void)
 {
-    int num_args;
-    char **ppargs;
+    char line[MAX_LINE_LEN];
+    DocoptArgs parsed;
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+    long num_lines = 0;
     int ii;
+    int jj;
 
-    DocoptArgs parsed;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (ii = 0; ii < NUM_BENCH_ITERS; ++ii)
+    {
+        for (jj = 0; jj < NUM_TESTS; ++jj)
+        {
+            strcpy(line, test_strs[jj]);
+            ConParser_Parse(line, &parsed);
+            num_lines++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    elapsed = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("%ld lines, %.1f ns/line, sizeof(DocoptArgs) = %u\n", num_lines, elapsed / num_lines, (unsigned) sizeof parsed);
+}
 
-    init_args_storage(ppargs);
+int main(int argc, char *argv[])
+{
+    int ii;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        benchmark();
+        return 0;
+    }
 
     for (ii = 0; ii < NUM_TESTS; ++ii)
     {
         printf("---------------------------------------------------------\n");
         printf("Parsing Test %d : %s\n", ii+1, test_strs[ii]);
         printf("---------------------------------------------------------\n");
-        evaluate_test_string(test_strs[ii], ppargs);
+        evaluate_test_string(test_strs[ii]);
     }
 
     return 0;
@@ -0,0 +1,613 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a streaming JSON/CSV writer for the console output.
+   
+   The show commands print hundreds of values.  Formatting each one with Ser_PutStringFormat runs
+   vsnprintf into a stack buffer and then waits for the USB endpoint to send the (often short) string
+   as its own packet, so a dump takes one USB frame per value.  Instead, the writer formats the values
+   directly into a packet sized buffer which is sent when it is full (or flushed), so a dump takes one 
+   USB frame per packet and the main loop is held up for a fraction of the time.
+   
+   Numbers are formatted without printf: integers by repeated division and FLOATs as fixed point 
+   with the given number of decimals, rounded to nearest, e.g., Emit_Fixed(-1.2345, 3) is -1.235 (the
+   output of %.3f).  Values too large for fixed point fall back to snprintf.
+   
+   JSON objects and arrays and CSV rows nest up to EMIT_MAX_DEPTH levels; the separators are inserted
+   by the writer:
+   
+       Emit_ObjectBegin(NULL);                       {
+       Emit_KeyString("wheel", "left");              "wheel":"left"
+       Emit_ArrayBegin("values");                    ,"values":[
+       Emit_ItemInt(1);                              1
+       Emit_ItemInt(2);                              ,2
+       Emit_ArrayEnd();                              ]
+       Emit_ObjectEnd();                             }
+       Emit_Newline();                               \r\n
+       Emit_Flush();
+       
+   A CSV row is a level without brackets which ends with a newline.
+   
+   Note: The buffered output must be flushed before anything else is written to the serial port.
+   
+   The show commands send their output in chunks, one packet per update of the command, so that a
+   long dump does not hold up the main loop (see Emit_Chunk).  The writer keeps no copy of the output,
+   so the command writes its whole output again for each chunk and only the bytes from the end of the
+   previous chunk are kept.  A check of the bytes already sent detects output that changed between
+   chunks, e.g., a table updated by a calibration while it is shown.  Past the end of the chunk, the
+   numbers are not formatted, so a chunk costs at most one pass over the output.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include "emit.h"
+#include "serial.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define MAX_INT_DIGITS (10)
+/* Largest magnitude formatted as fixed point, i.e., the scaled value fits in a UINT32 */
+#define MAX_FIXED_VALUE (4.0e9)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {LEVEL_OBJECT, LEVEL_ARRAY, LEVEL_ROW} LEVEL_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 buffer[EMIT_BUFFER_SIZE];
+static UINT8 length;
+
+static LEVEL_TYPE levels[EMIT_MAX_DEPTH];
+static UINT8 depth;
+/* Bit N is set once the level at depth N has an item, i.e., the next item needs a separator */
+static UINT8 has_items;
+
+static const UINT32 scales[EMIT_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+/* The chunked output: while is_chunked, position counts the bytes written and only the bytes from
+   start are buffered.  check is the check of the bytes before start.
+ */
+static BOOL is_chunked;
+static UINT16 position;
+static UINT16 start;
+static UINT16 check;
+/* The stream which is being sent, the other streams wait so that the outputs are not interleaved */
+static EMIT_STREAM_TYPE *owner;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: EmitUint
+ * Description: Writes an unsigned integer, zero padded to the minimum number of digits.
+ * Parameters: value - the value
+ *             min_digits - the minimum number of digits
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void EmitUint(UINT32 value, UINT8 min_digits)
+{
+    CHAR digits[MAX_INT_DIGITS];
+    UINT8 count;
+    
+    count = 0;
+    do
+    {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0 || count < min_digits);
+    
+    while (count > 0)
+    {
+        Emit_Char(digits[--count]);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: UpdateCheck
+ * Description: Adds a byte to the check of a chunked output.
+ * Parameters: value - the check
+ *             ch - the byte
+ * Return: UINT16 - the updated check
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT16 UpdateCheck(UINT16 value, UINT8 ch)
+{
+    return (UINT16) ((value << 1) | (value >> 15)) + ch;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: IsChunkFull
+ * Description: Indicates whether the chunk is full, i.e., the rest of the output is not sent by
+ *              this chunk and only has to be counted.
+ * Parameters: None
+ * Return: BOOL - TRUE if the chunk is full; otherwise, FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL IsChunkFull()
+{
+    return is_chunked && length == EMIT_BUFFER_SIZE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: BeginItem
+ * Description: Writes the separator, if needed, before an item of the current level.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void BeginItem()
+{
+    UINT8 bit;
+    
+    if (depth == 0)
+    {
+        return;
+    }
+    
+    bit = 1 << (depth - 1);
+    if (has_items & bit)
+    {
+        Emit_Char(',');
+    }
+    has_items |= bit;
+}
+
+static void EmitQuoted(CHAR const * const str)
+{
+    CHAR const *p_ch;
+    
+    Emit_Char('"');
+    for (p_ch = str; *p_ch != '\0'; ++p_ch)
+    {
+        if (*p_ch == '"' || *p_ch == '\\')
+        {
+            Emit_Char('\\');
+        }
+        Emit_Char(*p_ch);
+    }
+    Emit_Char('"');
+}
+
+static void BeginKey(CHAR const * const key)
+{
+    BeginItem();
+    if (key != NULL)
+    {
+        EmitQuoted(key);
+        Emit_Char(':');
+    }
+}
+
+static void Push(LEVEL_TYPE level)
+{
+    if (depth < EMIT_MAX_DEPTH)
+    {
+        levels[depth] = level;
+        has_items &= ~(1 << depth);
+        depth++;
+    }
+}
+
+static void Pop()
+{
+    if (depth > 0)
+    {
+        depth--;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Init
+ * Description: Initializes the writer.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Init()
+{
+    length = 0;
+    depth = 0;
+    has_items = 0;
+    is_chunked = FALSE;
+    owner = NULL;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Flush
+ * Description: Sends the buffered output.  Must be called at the end of the output.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Flush()
+{
+    /* Note: A chunk is sent by Emit_Chunk */
+    if (is_chunked)
+    {
+        return;
+    }
+    
+    if (length > 0)
+    {
+        /* Note: The output is written at once, so this waits for the endpoint (see Emit_Chunk) */
+        while (!Ser_WriteData(buffer, length))
+        {
+        }
+        length = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_StreamInit
+ * Description: Starts a chunked output from the beginning.
+ * Parameters: stream - the stream
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_StreamInit(EMIT_STREAM_TYPE* const stream)
+{
+    stream->offset = 0;
+    stream->check = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Chunk
+ * Description: Sends the next chunk, at most one packet, of a chunked output.  Called from the update
+ *              of a command until it returns FALSE.  Nothing is sent while another stream is being
+ *              sent or the endpoint is busy, the chunk is tried again on the next call.
+ * Parameters: stream - the stream
+ *             emit - writes the whole output, the same output on every call
+ * Return: BOOL - TRUE while there is output to send; otherwise, FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Emit_Chunk(EMIT_STREAM_TYPE* const stream, EMIT_FUNC_TYPE emit)
+{
+    UINT8 ii;
+    
+    if (owner != NULL && owner != stream)
+    {
+        return TRUE;
+    }
+    owner = stream;
+    
+    is_chunked = TRUE;
+    position = 0;
+    start = stream->offset;
+    check = 0;
+    length = 0;
+    depth = 0;
+    has_items = 0;
+    
+    emit();
+    
+    is_chunked = FALSE;
+    
+    if (position < start || check != stream->check)
+    {
+        length = 0;
+        owner = NULL;
+        Ser_PutString("\r\noutput changed while it was sent\r\n");
+        return FALSE;
+    }
+    
+    if (length > 0)
+    {
+        if (!Ser_WriteData(buffer, length))
+        {
+            length = 0;
+            return TRUE;
+        }
+        
+        for (ii = 0; ii < length; ++ii)
+        {
+            check = UpdateCheck(check, buffer[ii]);
+        }
+        stream->offset += length;
+        stream->check = check;
+        length = 0;
+    }
+    
+    if (position > stream->offset)
+    {
+        return TRUE;
+    }
+    
+    owner = NULL;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Cancel
+ * Description: Stops a chunked output, e.g., when the command is killed.
+ * Parameters: stream - the stream
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Cancel(EMIT_STREAM_TYPE* const stream)
+{
+    if (owner == stream)
+    {
+        owner = NULL;
+    }
+}
+
+void Emit_Char(CHAR ch)
+{
+    if (is_chunked)
+    {
+        if (position < start)
+        {
+            check = UpdateCheck(check, (UINT8) ch);
+        }
+        else if (length < EMIT_BUFFER_SIZE)
+        {
+            buffer[length++] = (UINT8) ch;
+        }
+        position++;
+        return;
+    }
+    
+    buffer[length++] = (UINT8) ch;
+    if (length == EMIT_BUFFER_SIZE)
+    {
+        Emit_Flush();
+    }
+}
+
+void Emit_String(CHAR const * const str)
+{
+    CHAR const *p_ch;
+    
+    for (p_ch = str; *p_ch != '\0'; ++p_ch)
+    {
+        Emit_Char(*p_ch);
+    }
+}
+
+void Emit_Int(INT32 value)
+{
+    if (IsChunkFull())
+    {
+        position++;
+        return;
+    }
+    
+    if (value < 0)
+    {
+        Emit_Char('-');
+        /* Note: negated as unsigned so that INT32_MIN is formatted correctly */
+        EmitUint(-(UINT32) value, 1);
+    }
+    else
+    {
+        EmitUint(value, 1);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Hex
+ * Description: Writes an unsigned integer in lower case hexadecimal (the output of %0Nx).
+ * Parameters: value - the value
+ *             min_digits - the minimum number of digits, zero padded
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Hex(UINT32 value, UINT8 min_digits)
+{
+    CHAR digits[2 * sizeof(UINT32)];
+    UINT8 count;
+    
+    count = 0;
+    do
+    {
+        digits[count++] = "0123456789abcdef"[value & 0xF];
+        value >>= 4;
+    } while (value > 0 || (count < min_digits && count < sizeof digits));
+    
+    while (count > 0)
+    {
+        Emit_Char(digits[--count]);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_Fixed
+ * Description: Writes a FLOAT with a fixed number of decimals (the output of %.Nf).
+ * Parameters: value - the value
+ *             decimals - the number of decimals, at most EMIT_MAX_DECIMALS
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Fixed(FLOAT value, UINT8 decimals)
+{
+    CHAR str[32];
+    FLOAT magnitude;
+    UINT32 scale;
+    UINT32 scaled;
+    
+    if (IsChunkFull())
+    {
+        position++;
+        return;
+    }
+    
+    decimals = min(decimals, EMIT_MAX_DECIMALS);
+    scale = scales[decimals];
+    
+    if (isnan(value))
+    {
+        Emit_String("nan");
+        return;
+    }
+    
+    magnitude = value < 0 ? -value : value;
+    if (isinf(value) || magnitude * scale >= MAX_FIXED_VALUE)
+    {
+        snprintf(str, sizeof str, "%.*f", decimals, value);
+        Emit_String(str);
+        return;
+    }
+    
+    if (value < 0)
+    {
+        Emit_Char('-');
+    }
+    
+    scaled = (UINT32) (magnitude * scale + 0.5f);
+    EmitUint(scaled / scale, 1);
+    if (decimals > 0)
+    {
+        Emit_Char('.');
+        EmitUint(scaled % scale, decimals);
+    }
+}
+
+void Emit_Newline()
+{
+    Emit_Char('\r');
+    Emit_Char('\n');
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_ObjectBegin/Emit_ArrayBegin
+ * Description: Begins a JSON object/array.
+ * Parameters: key - the key of the object/array in the enclosing object, NULL for an array item or
+ *                   the outermost object/array
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_ObjectBegin(CHAR const * const key)
+{
+    BeginKey(key);
+    Emit_Char('{');
+    Push(LEVEL_OBJECT);
+}
+
+void Emit_ObjectEnd()
+{
+    Pop();
+    Emit_Char('}');
+}
+
+void Emit_ArrayBegin(CHAR const * const key)
+{
+    BeginKey(key);
+    Emit_Char('[');
+    Push(LEVEL_ARRAY);
+}
+
+void Emit_ArrayEnd()
+{
+    Pop();
+    Emit_Char(']');
+}
+
+void Emit_KeyString(CHAR const * const key, CHAR const * const value)
+{
+    BeginKey(key);
+    EmitQuoted(value);
+}
+
+void Emit_KeyInt(CHAR const * const key, INT32 value)
+{
+    BeginKey(key);
+    Emit_Int(value);
+}
+
+void Emit_KeyFixed(CHAR const * const key, FLOAT value, UINT8 decimals)
+{
+    BeginKey(key);
+    Emit_Fixed(value, decimals);
+}
+
+void Emit_KeyBool(CHAR const * const key, BOOL value)
+{
+    BeginKey(key);
+    Emit_String(value ? "true" : "false");
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_RowBegin/Emit_RowEnd
+ * Description: Begins/ends a CSV row.  The items of a row are separated by commas and the row ends
+ *              with a newline.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_RowBegin()
+{
+    Push(LEVEL_ROW);
+}
+
+void Emit_RowEnd()
+{
+    Pop();
+    Emit_Newline();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Emit_ItemString/Emit_ItemInt/Emit_ItemFixed
+ * Description: Writes an item of a JSON array or CSV row.  Strings are quoted in JSON only.
+ * Parameters: value - the value
+ *             decimals - the number of decimals
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_ItemString(CHAR const * const value)
+{
+    BeginItem();
+    if (depth > 0 && levels[depth - 1] == LEVEL_ROW)
+    {
+        Emit_String(value);
+    }
+    else
+    {
+        EmitQuoted(value);
+    }
+}
+
+void Emit_ItemInt(INT32 value)
+{
+    BeginItem();
+    Emit_Int(value);
+}
+
+void Emit_ItemFixed(FLOAT value, UINT8 decimals)
+{
+    BeginItem();
+    Emit_Fixed(value, decimals);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,93 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a streaming JSON/CSV writer for the console output.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef EMIT_H
+#define EMIT_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* One USB full speed bulk packet (see USBUART_BUFFER_SIZE) */
+#define EMIT_BUFFER_SIZE (64)
+/* The maximum nesting of objects, arrays and rows */
+#define EMIT_MAX_DEPTH (8)
+#define EMIT_MAX_DECIMALS (6)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+/* Writes the whole output of a command (see Emit_Chunk) */
+typedef void (*EMIT_FUNC_TYPE)(void);
+
+/* The progress of a chunked output, kept by the command between updates */
+typedef struct
+{
+    UINT16 offset;
+    UINT16 check;
+} EMIT_STREAM_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Emit_Init();
+void Emit_Flush();
+
+void Emit_StreamInit(EMIT_STREAM_TYPE* const stream);
+BOOL Emit_Chunk(EMIT_STREAM_TYPE* const stream, EMIT_FUNC_TYPE emit);
+void Emit_Cancel(EMIT_STREAM_TYPE* const stream);
+
+void Emit_Char(CHAR ch);
+void Emit_String(CHAR const * const str);
+void Emit_Int(INT32 value);
+void Emit_Hex(UINT32 value, UINT8 min_digits);
+void Emit_Fixed(FLOAT value, UINT8 decimals);
+void Emit_Newline();
+
+void Emit_ObjectBegin(CHAR const * const key);
+void Emit_ObjectEnd();
+void Emit_ArrayBegin(CHAR const * const key);
+void Emit_ArrayEnd();
+void Emit_KeyString(CHAR const * const key, CHAR const * const value);
+void Emit_KeyInt(CHAR const * const key, INT32 value);
+void Emit_KeyFixed(CHAR const * const key, FLOAT value, UINT8 decimals);
+void Emit_KeyBool(CHAR const * const key, BOOL value);
+
+void Emit_RowBegin();
+void Emit_RowEnd();
+void Emit_ItemString(CHAR const * const value);
+void Emit_ItemInt(INT32 value);
+void Emit_ItemFixed(FLOAT value, UINT8 decimals);
+
+#endif
+
+/* [] END OF FILE */
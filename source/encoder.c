@@ -66,8 +66,10 @@ SOFTWARE.
  * Constants
  *-------------------------------------------------------------------------------------------------*/    
 #define ENC_SAMPLE_TIME_MS  SAMPLE_TIME_MS(ENC_SAMPLE_RATE)
-#define ENC_SAMPLE_TIME_SEC SAMPLE_TIME_SEC(ENC_SAMPLE_RATE)
 
+/* Note: The number of samples is for the default sample rate (ENC_SAMPLE_RATE).  At other rates, the number of samples 
+   is scaled so that the filters average over the same time.
+ */
 #define NUM_DELTA_COUNT_SAMPLES (5)
 #define NUM_AVG_CPS_SAMPLES (5)
 
@@ -120,6 +122,9 @@ static ENCODER_TYPE right_enc = {
     /* set enc count */     Right_QuadDec_SetCounter,
 };
 
+static UINT32 sample_time_ms = ENC_SAMPLE_TIME_MS;
+static UINT32 last_update_time = ENC_SCHED_OFFSET;
+
 #if defined (LEFT_ENC_DUMP_ENABLED) || defined (RIGHT_ENC_DUMP_ENABLED)
 /*---------------------------------------------------------------------------------------------------
  * Name: DumpEncoder
@@ -170,6 +175,25 @@ static void Encoder_Sample(ENCODER_TYPE* const enc, UINT32 delta_time)
     enc->delta_dist = (WHEEL_METER_PER_REV * enc->delta_count) / WHEEL_COUNT_PER_REV;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: ScaleFilter
+ * Description: Changes the number of samples of a moving average filter without disturbing the 
+ *              current average.
+ * Parameters: ma - the moving average filter
+ *             n - the number of samples
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void ScaleFilter(MOVING_AVERAGE_FLOAT_TYPE* const ma, FLOAT n)
+{
+    /* Note: The filter holds the average times the number of samples */
+    if (ma->n > 0)
+    {
+        ma->last = ma->last * n / ma->n;
+    }
+    ma->n = n;
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Encoder_Init
  * Description: Initializes the encoder structures
@@ -205,6 +229,7 @@ void Encoder_Init()
     right_enc.avg_cps = 0;
     right_enc.avg_mps = 0;
     
+    sample_time_ms = ENC_SAMPLE_TIME_MS;
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -232,14 +257,13 @@ void Encoder_Start()
  *-------------------------------------------------------------------------------------------------*/
 void Encoder_Update()
 {
-    static UINT32 last_update_time = ENC_SCHED_OFFSET;
     static UINT32 delta_time;
     
     ENCODER_UPDATE_START();
     
     delta_time = millis() - last_update_time;
     ENC_DEBUG_DELTA(delta_time);
-    if (delta_time >= ENC_SAMPLE_TIME_MS)
+    if (delta_time >= sample_time_ms)
     {
         last_update_time = millis();
         
@@ -252,6 +276,31 @@ void Encoder_Update()
     ENCODER_UPDATE_END();
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Encoder_SetSampleTime
+ * Description: Sets the encoder sampling period and rescales the moving average filters to span 
+ *              the same time as at the default sample rate.
+ * Parameters: period - the sampling period in milliseconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Encoder_SetSampleTime(UINT32 period)
+{
+    FLOAT scale = ENC_SAMPLE_TIME_MS / (FLOAT) period;
+    FLOAT delta_count_n = NUM_DELTA_COUNT_SAMPLES * scale;
+    FLOAT avg_cps_n = NUM_AVG_CPS_SAMPLES * scale;
+    
+    delta_count_n = max(delta_count_n, 1.0);
+    avg_cps_n = max(avg_cps_n, 1.0);
+    
+    ScaleFilter(&left_enc.delta_count_ma, delta_count_n);
+    ScaleFilter(&left_enc.avg_cps_ma, avg_cps_n);
+    ScaleFilter(&right_enc.delta_count_ma, delta_count_n);
+    ScaleFilter(&right_enc.avg_cps_ma, avg_cps_n);
+    
+    sample_time_ms = period;
+}
+
 void Encoder_LeftReset()
 {
     Left_QuadDec_SetCounter(0);
@@ -262,6 +311,23 @@ void Encoder_RightReset()
     Right_QuadDec_SetCounter(0);
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Encoder_GetSample
+ * Description: Returns the time and the left/right counts of the last encoder sample.  Unlike the raw
+ *              count, the sampled counts are the counts from which the current speed was calculated.
+ * Parameters: (out) time - the time of the sample (millisecond)
+ *             (out) left - the left encoder count
+ *             (out) right - the right encoder count
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Encoder_GetSample(UINT32* const time, INT32* const left, INT32* const right)
+{
+    *time = last_update_time;
+    *left = left_enc.count;
+    *right = right_enc.count;
+}
+
 INT32 Encoder_LeftGetRawCount()
 {
     return Left_QuadDec_GetCounter();
@@ -49,12 +49,14 @@ typedef void (*RESET_COUNT_FUNC_TYPE)();
 void Encoder_Init();
 void Encoder_Start();
 void Encoder_Update();
+void Encoder_SetSampleTime(UINT32 period);
 
 void Encoder_LeftReset();
 void Encoder_RightReset();
 
 INT32 Encoder_LeftGetRawCount();
 INT32 Encoder_RightGetRawCount();
+void Encoder_GetSample(UINT32* const time, INT32* const left, INT32* const right);
 
 FLOAT Encoder_LeftGetCntsPerSec();
 FLOAT Encoder_RightGetCntsPerSec();
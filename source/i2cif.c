@@ -36,11 +36,16 @@ SOFTWARE.
 #include "utils.h"
 #include "debug.h"
 #include "cal.h"
+#include "control.h"
 
 
 /*---------------------------------------------------------------------------------------------------
  * Constants
  *-------------------------------------------------------------------------------------------------*/    
+/* The version of the I2C data layout (see below).  Version 1 is the layout up to offset 40, which has no version
+   register.
+ */
+#define I2CIF_LAYOUT_VERSION    (2)
 
 /*---------------------------------------------------------------------------------------------------
  * Macros
@@ -80,6 +85,7 @@ SOFTWARE.
     ------------------------------ Read/Write Boundary --------------------------------------------
       12           2         [device status]                contains bits that represent the status of the Psoc device
                                                                - Bit 0: HB25 Motor Controller Initialized
+                                                               - Bit 1: Command Velocity Saturated
       14           2         [calibration status]           contains bits that represent the calibration state
                                                                - Bit 0: Count/Sec to PWM
                                                                - Bit 1: PID
@@ -92,6 +98,37 @@ SOFTWARE.
       28           4         [y position]                   measured y position
       32           4         [heading]                      measured heading
       36           4         [heartbeat]                    used for testing the i2c communication
+    ------------------------------ End of Layout Version 1 ----------------------------------------
+      40           1         [layout version]               I2CIF_LAYOUT_VERSION
+           <------ Path Status ------>
+      41           1         [path state]                   0: idle, 1: running, 2: done, 3: failed
+      42           1         [path points]                  number of points loaded
+      43           1         [path segment]                 the path segment nearest the robot
+      44           4         [path progress]                fraction of the path length travelled
+      48           4         [cross-track error]            signed distance from the path in meter, positive to the left
+        <------- Path Window -------->
+      52           1         [path control]                 the path register supports (cleared when applied)
+                                                                - Bit 0: load the window points
+                                                                - Bit 1: start following the path
+                                                                - Bit 2: stop following the path
+                                                                - Bit 3: clear the path
+      53           1         [path index]                   index of the first window point in the path
+      54           1         [path count]                   number of window points (1 - 4)
+      55           1         [reserved]
+      56           4         [path speed]                   cruise speed in meter/second, 0 for the default
+      60           4         [path lookahead]               lookahead distance in meter, 0 for the default
+      64          32         [path points]                  4 x (x, y) points in meter
+
+    The layout of version 1 is unchanged and the registers added since are appended, so a host written for version 1
+    works as before.  A host checks the layout version before it uses the appended registers.
+
+    The EZI2C component has a single read/write boundary, so with the path window appended the whole buffer is
+    writable.  The registers from 12 to 51 are read-only by convention; the status registers and the layout version
+    are restored when a write is seen (see I2CIF_ReadCmdVelocity), and the others are rewritten on every update.
+
+    A path is uploaded in a burst of window writes: the host writes the window (offset 53 onwards), then writes the path
+    control, and waits for the path control to read back 0 before writing the next window.  The path control is the
+    doorbell, so it must be written after the window it applies to.  The last window may also set the start bit.
  */
 
 /* Define the portion of the I2C Slave that Read/Write */
@@ -123,12 +160,45 @@ typedef struct
     UINT32     heartbeat;
 } __attribute__ ((packed)) READONLY_TYPE;
 
+/* Define the path following status
+ */
+typedef struct
+{
+    UINT8 state;
+    UINT8 num_points;
+    UINT8 segment;
+    FLOAT progress;
+    FLOAT cross_track;
+} __attribute__ ((packed)) PATH_STATUS;
+
+/* Define the path window
+ */
+typedef struct
+{
+    UINT8  control;
+    UINT8  index;
+    UINT8  count;
+    UINT8  reserved;
+    FLOAT  speed;
+    FLOAT  lookahead;
+    FLOAT  points[2 * PATH_WINDOW_NUM_POINTS];
+} __attribute__ ((packed)) PATH_WINDOW;
+
+/* Define the registers appended to layout version 1 */
+typedef struct
+{
+    UINT8       layout_version;
+    PATH_STATUS path;
+    PATH_WINDOW path_window;
+} __attribute__ ((packed)) APPENDED_TYPE;
+
 /* Define the I2C Slave data interface */
 typedef struct
 {
     READWRITE_TYPE read_write;
-    /*---------R/W Boundary -----------*/
+    /*---------R/W Boundary (Layout Version 1) -----------*/
     READONLY_TYPE read_only;
+    APPENDED_TYPE appended;
 } __attribute__ ((packed)) I2C_DATASTRUCT;
 
 #ifdef TEST_I2C
@@ -187,6 +257,7 @@ static UINT16 device_status;
 void I2CIF_Init()
 {
     memset( (void *) &i2c_buf, 0, sizeof(i2c_buf));
+    i2c_buf.appended.layout_version = I2CIF_LAYOUT_VERSION;
 #ifdef TEST_I2C    
     memset( (void *) &i2c_test, 0, sizeof(i2c_test));
 #endif    
@@ -212,7 +283,8 @@ void I2CIF_Start()
 #ifdef TEST_I2C    
     EZI2C_Slave_SetBuffer1(sizeof(i2c_test), sizeof(i2c_test.read_write), (volatile UINT8 *) &i2c_test);
 #else
-    EZI2C_Slave_SetBuffer1(sizeof(i2c_buf), sizeof(i2c_buf.read_write), (volatile UINT8 *) &i2c_buf);
+    /* Note: The path window is at the end of the buffer, so the whole buffer is writable (see the layout above) */
+    EZI2C_Slave_SetBuffer1(sizeof(i2c_buf), sizeof(i2c_buf), (volatile UINT8 *) &i2c_buf);
 #endif
 }
 
@@ -255,10 +327,12 @@ UINT16 I2CIF_ReadDebugControl()
 void I2CIF_ReadCmdVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout)
 {
     /* GetActivity() returns the status of the I2C activity: write, read, busy, or error
-       Wrt to I2C writes, only the first 12 bytes can be written to.  Of those 12 bytes, 2 are for the control register,
+       Wrt to I2C writes, the first 12 bytes and the path window are written to.  Of the first 12 bytes, 2 are for the control register,
        2 are for the calibration register, and 8 are for the commanded velocity (left and right).  The commanded 
        velocity will always be written to more often than the control and calibration registers, so checking for write
-       status is reasonably good way to know if we have received any recent velocity commands.
+       status is reasonably good way to know if we have received any recent velocity commands.  The path window is 
+       written in a short burst before a path is followed and, while a path is followed, the command velocity is taken
+       from the path follower (see pursuit.c).
     
        When a write has occurred on the I2C bus, we assume it was a velocity command, and reset the command velocity 
        timeout; otherwise, we accumulate time which will be checked against the maximum command velocity timeout.
@@ -272,6 +346,11 @@ void I2CIF_ReadCmdVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* co
     if (i2c_write_occurred & EZI2C_Slave_STATUS_WRITE1)
     {
         cmd_velocity_timeout = 0;
+
+        /* The registers which are not rewritten on every update are restored in case the host wrote to them */
+        i2c_buf.read_only.device_status = device_status;
+        i2c_buf.read_only.calibration_status = calibration_status;
+        i2c_buf.appended.layout_version = I2CIF_LAYOUT_VERSION;
     }
     else
     {
@@ -380,6 +459,61 @@ void I2CIF_UpdateHeartbeat(UINT32 heartbeat)
     i2c_buf.read_only.heartbeat = heartbeat;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: I2CIF_ReadPathControl
+ * Description: Accessor function used to read the path window.  The path control is cleared so the
+ *              host knows the window was applied and the next window can be written.
+ * Parameters: index - the index of the first window point
+ *             count - the number of window points
+ *             speed - the cruise speed (meter/second)
+ *             lookahead - the lookahead distance (meter)
+ *             points - the window points as x, y pairs (2 * PATH_WINDOW_NUM_POINTS values)
+ * Return: UINT8 - the path control bits, 0 if there is nothing to apply
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT8 I2CIF_ReadPathControl(UINT8* const index, UINT8* const count, FLOAT* const speed, FLOAT* const lookahead, FLOAT* const points)
+{
+    UINT8 control;
+    UINT8 ii;
+    
+    control = i2c_buf.appended.path_window.control;
+    if (control)
+    {
+        *index = i2c_buf.appended.path_window.index;
+        *count = i2c_buf.appended.path_window.count;
+        *speed = i2c_buf.appended.path_window.speed;
+        *lookahead = i2c_buf.appended.path_window.lookahead;
+        for (ii = 0; ii < 2 * PATH_WINDOW_NUM_POINTS; ++ii)
+        {
+            points[ii] = i2c_buf.appended.path_window.points[ii];
+        }
+        
+        i2c_buf.appended.path_window.control = 0;
+    }
+    
+    return control;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: I2CIF_WritePathStatus
+ * Description: Accessor function used to write the path following status.
+ * Parameters: state - the path state
+ *             num_points - the number of points loaded
+ *             segment - the path segment nearest the robot
+ *             progress - the fraction of the path length travelled
+ *             cross_track - the cross-track error (meter)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void I2CIF_WritePathStatus(UINT8 state, UINT8 num_points, UINT8 segment, FLOAT progress, FLOAT cross_track)
+{
+    i2c_buf.appended.path.state = state;
+    i2c_buf.appended.path.num_points = num_points;
+    i2c_buf.appended.path.segment = segment;
+    i2c_buf.appended.path.progress = progress;
+    i2c_buf.appended.path.cross_track = cross_track;
+}
+
 #ifdef TEST_I2C
 void I2CIF_Test()
 {
@@ -72,6 +72,9 @@ void I2CIF_WritePosition(FLOAT x_position, FLOAT y_position);
 void I2CIF_WriteHeading(FLOAT heading);
 void I2CIF_UpdateHeartbeat(UINT32 heartbeat);
 
+UINT8 I2CIF_ReadPathControl(UINT8* const index, UINT8* const count, FLOAT* const speed, FLOAT* const lookahead, FLOAT* const points);
+void I2CIF_WritePathStatus(UINT8 state, UINT8 num_points, UINT8 segment, FLOAT progress, FLOAT cross_track);
+
 #ifdef TEST_I2C
 void I2CIF_Test();
 #endif
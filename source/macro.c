@@ -0,0 +1,444 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the console macros, named command scripts which are stored in 
+   the calibration EEPROM (see CAL_MACRO_STORE_TYPE) and replayed back to back by the dispatcher.
+   
+   A macro is recorded from the console: macro record starts it and every command entered until
+   macro end is stored as a step instead of being run.  The steps are stored compiled (see
+   ConParser_Compile), so a replay loads the arguments of each step directly (see ConParser_Load)
+   without tokenizing or looking up the keywords again.
+   
+   The macros are stored back to back, the macro being recorded is always the last one.  Deleting a
+   macro moves the macros after it down.  A step is written before the macro header and the store
+   length, so an interrupted write loses at most the step being recorded.
+   
+   Note: The compiled commands refer to the parser tables by index.  When the console commands change
+   (see CONPARSER_SIGNATURE), the stored macros are stale and are discarded by the next macro record.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include "macro.h"
+#include "calstore.h"
+#include "nvstore.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define STORE_OFFSET    (offsetof(CAL_EEPROM_TYPE, macros))
+#define DATA_OFFSET     (offsetof(CAL_EEPROM_TYPE, macros.data))
+#define NO_MACRO        (0xFFFF)
+/* One EEPROM row */
+#define MOVE_CHUNK_SIZE (16)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _macro_header_tag
+{
+    UINT16 size;        /* bytes of the header and steps */
+    CHAR name[MACRO_NAME_LENGTH];
+    UINT8 num_steps;
+} __attribute__ ((packed)) MACRO_HEADER_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static volatile CAL_MACRO_STORE_TYPE *p_store;
+static UINT16 recording;
+
+static CHAR const * const result_strings[MACRO_LAST] = {
+    "ok",
+    "not found",
+    "bad name",
+    "no space",
+    "too long",
+    "not recording",
+    "not allowed",
+    "bad step",
+    "stale"
+};
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+static UINT16 GetLength()
+{
+    UINT16 length = p_store->length;
+
+    return (p_store->signature == CONPARSER_SIGNATURE && length <= CAL_MACRO_DATA_SIZE) ? length : 0;
+}
+
+static void WriteLength(UINT16 length)
+{
+    UINT16 values[2];
+
+    values[0] = CONPARSER_SIGNATURE;
+    values[1] = length;
+    Nvstore_WriteBytes((UINT8 *) values, sizeof values, STORE_OFFSET);
+}
+
+static void ReadBytes(UINT16 offset, UINT8* const bytes, UINT16 num_bytes)
+{
+    UINT16 ii;
+
+    for (ii = 0; ii < num_bytes; ++ii)
+    {
+        bytes[ii] = p_store->data[offset + ii];
+    }
+}
+
+/* Finds the macro with the given name or, if name is NULL, the macro at the given index */
+static UINT16 FindMacro(CHAR const * const name, UINT8 index, MACRO_HEADER_TYPE* const header)
+{
+    UINT16 offset = 0;
+    UINT16 length = GetLength();
+    UINT8 count = 0;
+
+    while (offset + sizeof(MACRO_HEADER_TYPE) <= length)
+    {
+        ReadBytes(offset, (UINT8 *) header, sizeof(MACRO_HEADER_TYPE));
+        if (header->size < sizeof(MACRO_HEADER_TYPE) || offset + header->size > length)
+        {
+            /* Note: The rest of the store is unusable, e.g., the last step of a recording was interrupted */
+            break;
+        }
+
+        if (name ? strncmp(header->name, name, MACRO_NAME_LENGTH) == 0 : count == index)
+        {
+            return offset;
+        }
+
+        count++;
+        offset += header->size;
+    }
+
+    return NO_MACRO;
+}
+
+static void RemoveMacro(UINT16 offset, UINT16 size)
+{
+    UINT8 chunk[MOVE_CHUNK_SIZE];
+    UINT16 length = GetLength();
+    UINT16 pos;
+    UINT16 num_bytes;
+
+    for (pos = offset + size; pos < length; pos += num_bytes)
+    {
+        num_bytes = min(MOVE_CHUNK_SIZE, length - pos);
+        ReadBytes(pos, chunk, num_bytes);
+        Nvstore_WriteBytes(chunk, num_bytes, DATA_OFFSET + pos - size);
+    }
+
+    WriteLength(length - size);
+
+    if (recording != NO_MACRO && recording > offset)
+    {
+        recording -= size;
+    }
+}
+
+static MACRO_RESULT_TYPE OpenMacro(UINT16 offset, MACRO_HEADER_TYPE const * const header, MACRO_CURSOR_TYPE* const cursor)
+{
+    if (offset == NO_MACRO)
+    {
+        return MACRO_NOT_FOUND;
+    }
+
+    memcpy(cursor->name, header->name, MACRO_NAME_LENGTH);
+    cursor->name[MACRO_NAME_LENGTH - 1] = '\0';
+    cursor->num_steps = header->num_steps;
+    cursor->step = 0;
+    cursor->next = offset + sizeof(MACRO_HEADER_TYPE);
+    cursor->end = offset + header->size;
+    cursor->length = 0;
+
+    return MACRO_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_Init
+ * Description: Initializes the console macro module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Macro_Init()
+{
+    volatile CAL_EEPROM_TYPE *p_cal_eeprom = NVSTORE_CAL_EEPROM_BASE;
+
+    p_store = &p_cal_eeprom->macros;
+    recording = NO_MACRO;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_Begin
+ * Description: Starts recording a macro.  A macro with the same name is replaced and a stale store
+ *              is cleared.
+ * Parameters: name - the macro name (up to MACRO_NAME_LENGTH - 1 characters)
+ * Return: MACRO_OK if recording, otherwise the error
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_Begin(CHAR const * const name)
+{
+    MACRO_HEADER_TYPE header;
+    UINT16 offset;
+    UINT16 length;
+
+    if (name == NULL || name[0] == '\0' || strlen(name) >= MACRO_NAME_LENGTH)
+    {
+        return MACRO_BAD_NAME;
+    }
+
+    recording = NO_MACRO;
+
+    if (Macro_IsStale())
+    {
+        WriteLength(0);
+    }
+
+    offset = FindMacro(name, 0, &header);
+    if (offset != NO_MACRO)
+    {
+        RemoveMacro(offset, header.size);
+    }
+
+    length = GetLength();
+    if (length + sizeof(MACRO_HEADER_TYPE) > CAL_MACRO_DATA_SIZE)
+    {
+        return MACRO_NO_SPACE;
+    }
+
+    memset(&header, 0, sizeof header);
+    header.size = sizeof header;
+    strncpy(header.name, name, MACRO_NAME_LENGTH);
+    Nvstore_WriteBytes((UINT8 *) &header, sizeof header, DATA_OFFSET + length);
+    WriteLength(length + sizeof header);
+
+    recording = length;
+
+    return MACRO_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_Record
+ * Description: Appends the command as a step of the macro being recorded.
+ * Parameters: args - the parsed command
+ * Return: MACRO_OK if the step was stored, otherwise the error
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_Record(DocoptArgs const * const args)
+{
+    MACRO_HEADER_TYPE header;
+    UINT8 step[1 + MACRO_MAX_CODE_LENGTH];
+    UINT16 length;
+
+    if (recording == NO_MACRO)
+    {
+        return MACRO_NOT_RECORDING;
+    }
+
+    step[0] = ConParser_Compile(args, &step[1], MACRO_MAX_CODE_LENGTH);
+    if (step[0] == 0)
+    {
+        return MACRO_TOO_LONG;
+    }
+
+    length = GetLength();
+    ReadBytes(recording, (UINT8 *) &header, sizeof header);
+    if (length + 1 + step[0] > CAL_MACRO_DATA_SIZE || header.num_steps == 0xFF)
+    {
+        return MACRO_NO_SPACE;
+    }
+
+    Nvstore_WriteBytes(step, 1 + step[0], DATA_OFFSET + length);
+
+    header.size += 1 + step[0];
+    header.num_steps++;
+    Nvstore_WriteBytes((UINT8 *) &header, sizeof header, DATA_OFFSET + recording);
+    WriteLength(length + 1 + step[0]);
+
+    return MACRO_OK;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_End
+ * Description: Stops recording.  A macro without steps is removed.
+ * Parameters: num_steps - returns the number of steps recorded
+ * Return: MACRO_OK, or MACRO_NOT_RECORDING if no macro is being recorded
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_End(UINT8* const num_steps)
+{
+    MACRO_HEADER_TYPE header;
+    UINT16 offset = recording;
+
+    if (recording == NO_MACRO)
+    {
+        return MACRO_NOT_RECORDING;
+    }
+
+    recording = NO_MACRO;
+
+    ReadBytes(offset, (UINT8 *) &header, sizeof header);
+    *num_steps = header.num_steps;
+    if (header.num_steps == 0)
+    {
+        RemoveMacro(offset, header.size);
+    }
+
+    return MACRO_OK;
+}
+
+BOOL Macro_IsRecording()
+{
+    return recording != NO_MACRO;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_Delete
+ * Description: Removes the macro, which also stops its recording.
+ * Parameters: name - the macro name
+ * Return: MACRO_OK, or MACRO_NOT_FOUND
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_Delete(CHAR const * const name)
+{
+    MACRO_HEADER_TYPE header;
+    UINT16 offset;
+
+    offset = name ? FindMacro(name, 0, &header) : NO_MACRO;
+    if (offset == NO_MACRO)
+    {
+        return MACRO_NOT_FOUND;
+    }
+
+    if (offset == recording)
+    {
+        recording = NO_MACRO;
+    }
+
+    RemoveMacro(offset, header.size);
+
+    return MACRO_OK;
+}
+
+void Macro_Clear()
+{
+    recording = NO_MACRO;
+    WriteLength(0);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_IsStale
+ * Description: Reports whether the stored macros were recorded with different console commands.
+ * Parameters: None
+ * Return: TRUE if the store holds macros which cannot be replayed, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Macro_IsStale()
+{
+    return p_store->length != 0 && (p_store->signature != CONPARSER_SIGNATURE || p_store->length > CAL_MACRO_DATA_SIZE);
+}
+
+UINT16 Macro_GetFree()
+{
+    return CAL_MACRO_DATA_SIZE - GetLength();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_Open/Macro_OpenIndex
+ * Description: Opens the macro, by name or by position, for reading its steps (see Macro_NextStep).
+ * Parameters: name - the macro name
+ *             index - the position of the macro in the store
+ *             cursor - returns the macro
+ * Return: MACRO_OK, MACRO_NOT_FOUND or MACRO_STALE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_Open(CHAR const * const name, MACRO_CURSOR_TYPE* const cursor)
+{
+    MACRO_HEADER_TYPE header;
+
+    if (Macro_IsStale())
+    {
+        return MACRO_STALE;
+    }
+
+    return OpenMacro(name ? FindMacro(name, 0, &header) : NO_MACRO, &header, cursor);
+}
+
+MACRO_RESULT_TYPE Macro_OpenIndex(UINT8 index, MACRO_CURSOR_TYPE* const cursor)
+{
+    MACRO_HEADER_TYPE header;
+
+    if (Macro_IsStale())
+    {
+        return MACRO_STALE;
+    }
+
+    return OpenMacro(FindMacro(NULL, index, &header), &header, cursor);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Macro_NextStep
+ * Description: Copies the next compiled step of the macro into the cursor (code, length).
+ * Parameters: cursor - the open macro
+ * Return: MACRO_OK, MACRO_NOT_FOUND after the last step or MACRO_STALE if the step is damaged
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+MACRO_RESULT_TYPE Macro_NextStep(MACRO_CURSOR_TYPE* const cursor)
+{
+    UINT8 length;
+
+    if (cursor->step >= cursor->num_steps || cursor->next >= cursor->end)
+    {
+        return MACRO_NOT_FOUND;
+    }
+
+    length = p_store->data[cursor->next];
+    if (length == 0 || length > MACRO_MAX_CODE_LENGTH || cursor->next + 1 + length > cursor->end)
+    {
+        return MACRO_STALE;
+    }
+
+    ReadBytes(cursor->next + 1, cursor->code, length);
+    cursor->length = length;
+    cursor->next += 1 + length;
+    cursor->step++;
+
+    return MACRO_OK;
+}
+
+CHAR const * Macro_GetResultString(MACRO_RESULT_TYPE result)
+{
+    return result < MACRO_LAST ? result_strings[result] : "";
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,97 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the console macros, named command scripts stored compiled in the 
+   calibration EEPROM and replayed by the dispatcher (see disp.c).
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef MACRO_H
+#define MACRO_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+#include "conparser.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* Including the terminating NUL */
+#define MACRO_NAME_LENGTH       (8)
+/* Maximum size of a compiled command.  A compiled command is shorter than its command line. */
+#define MACRO_MAX_CODE_LENGTH   (96)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum 
+{
+    MACRO_OK,
+    MACRO_NOT_FOUND,
+    MACRO_BAD_NAME,
+    MACRO_NO_SPACE,
+    MACRO_TOO_LONG,
+    MACRO_NOT_RECORDING,
+    MACRO_NOT_ALLOWED,
+    MACRO_BAD_STEP,
+    MACRO_STALE,
+    MACRO_LAST
+} MACRO_RESULT_TYPE;
+
+/* Reads the steps of a macro.  The current step is copied from EEPROM into code so that the arguments loaded from it 
+   (see ConParser_Load) stay valid while the step runs.
+ */
+typedef struct _macro_cursor_tag
+{
+    CHAR name[MACRO_NAME_LENGTH];
+    UINT8 num_steps;
+    UINT8 step;
+    UINT16 next;
+    UINT16 end;
+    UINT8 length;
+    UINT8 code[MACRO_MAX_CODE_LENGTH];
+} MACRO_CURSOR_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Macro_Init();
+MACRO_RESULT_TYPE Macro_Begin(CHAR const * const name);
+MACRO_RESULT_TYPE Macro_Record(DocoptArgs const * const args);
+MACRO_RESULT_TYPE Macro_End(UINT8* const num_steps);
+BOOL Macro_IsRecording();
+MACRO_RESULT_TYPE Macro_Delete(CHAR const * const name);
+void Macro_Clear();
+BOOL Macro_IsStale();
+UINT16 Macro_GetFree();
+MACRO_RESULT_TYPE Macro_Open(CHAR const * const name, MACRO_CURSOR_TYPE* const cursor);
+MACRO_RESULT_TYPE Macro_OpenIndex(UINT8 index, MACRO_CURSOR_TYPE* const cursor);
+MACRO_RESULT_TYPE Macro_NextStep(MACRO_CURSOR_TYPE* const cursor);
+CHAR const * Macro_GetResultString(MACRO_RESULT_TYPE result);
+
+#endif
+
+/* [] END OF FILE */
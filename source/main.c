@@ -39,9 +39,17 @@ SOFTWARE.
 #include "pid.h"
 #include "odom.h"
 #include "cal.h"
+#include "calsnap.h"
+#include "calrefine.h"
+#include "traj.h"
+#include "pursuit.h"
+#include "arena.h"
+#include "rate.h"
+#include "trace.h"
 #include "nvstore.h"
 #include "usbif.h"
 #include "serial.h"
+#include "emit.h"
 #include "utils.h"
 #include "console.h"
 
@@ -52,9 +60,11 @@ int main()
 {   
     CyGlobalIntEnable;
     
+    Arena_Init();
     Nvstore_Init();
     USBIF_Init();
     Ser_Init();
+    Emit_Init();
     Console_Init();
     Debug_Init();
     Debug_Start();    
@@ -68,6 +78,12 @@ int main()
     Pid_Init();
     Odom_Init();
     Cal_Init();
+    CalSnap_Init();
+    CalRefine_Init();
+    Traj_Init();
+    Pursuit_Init();
+    Rate_Init();
+    Trace_Init();
     
     Nvstore_Start();
     USBIF_Start();
@@ -81,6 +97,11 @@ int main()
     Pid_Start();
     Odom_Start();
     Cal_Start();
+    CalRefine_Start();
+    Traj_Start();
+    Pursuit_Start();
+    Rate_Start();
+    Trace_Start();
                 
     Debug_DisableAll();
     
@@ -91,15 +112,30 @@ int main()
         /* Update any control changes */
         Control_Update();   // reads and validates linear/angular
         
+        /* Step any motor ramps in progress */
+        Motor_Update();     // steps left/right pwm towards the ramp target
+        
         /* Update encoder-related values */
         Encoder_Update();   // measures current left/right speed
 
         /* Apply the velocity command to PIDs */
         Pid_Update();       // tracks linear/angular velocity
 
+        /* Refine the motor calibration */
+        CalRefine_Update(); // compares steady left/right pwm with measured speed
+
         /* Update the odometry calculation */
         Odom_Update();      // measures left/right speed, x/y position, heading, linear/angular
         
+        /* Trace the control loop for replay on the host */
+        Trace_Update();     // writes the command, encoder counts, pwm and pose at each encoder sample
+        
+        /* Step any trajectory in progress */
+        Traj_Update();      // sets linear/angular from the along-track progress
+        
+        /* Follow any uploaded path */
+        Pursuit_Update();   // sets linear/angular towards the lookahead point on the path
+        
         /* Diagnostic update */
         Diag_Update();
 
@@ -82,6 +82,12 @@ typedef struct _motor_tag
     STOP_PWM_FUNC_TYPE      stop;
     SET_MOTOR_PWM_FUNC_TYPE set_pwm;
     GET_MOTOR_PWM_FUNC_TYPE get_pwm;
+    /* Ramp state: the ramp is stepped from Motor_Update */
+    BOOL ramp_active;
+    PWM_TYPE ramp_target;
+    INT16 ramp_step;
+    UINT32 ramp_interval;
+    UINT32 ramp_last_time;
 } MOTOR_TYPE;
 
 static MOTOR_TYPE left_motor = {
@@ -91,7 +97,12 @@ static MOTOR_TYPE left_motor = {
     Left_HB25_PWM_Start,
     Left_HB25_PWM_Stop,
     Left_HB25_PWM_WriteCompare,
-    Left_HB25_PWM_ReadCompare
+    Left_HB25_PWM_ReadCompare,
+    FALSE,
+    PWM_STOP,
+    0,
+    0,
+    0
 };
 
 static MOTOR_TYPE right_motor = {
@@ -101,7 +112,12 @@ static MOTOR_TYPE right_motor = {
     Right_HB25_PWM_Start,
     Right_HB25_PWM_Stop,
     Right_HB25_PWM_WriteCompare,
-    Right_HB25_PWM_ReadCompare
+    Right_HB25_PWM_ReadCompare,
+    FALSE,
+    PWM_STOP,
+    0,
+    0,
+    0
 };
 
 /*---------------------------------------------------------------------------------------------------
@@ -170,13 +186,14 @@ void Motor_Start()
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_LeftSetPwm
- * Description: Sets the left motor PWM value
+ * Description: Sets the left motor PWM value.  Cancels a ramp in progress.
  * Parameters: pwm - the pwm value to be set.  Range from 1000 - 2000
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
 void Motor_LeftSetPwm(PWM_TYPE pwm)
 {
+    left_motor.ramp_active = FALSE;
     pwm = constrain(pwm, MIN_PWM_VALUE, MAX_PWM_VALUE);
     left_motor.set_pwm(pwm);
     MOTOR_DUMP(&left_motor);
@@ -184,13 +201,14 @@ void Motor_LeftSetPwm(PWM_TYPE pwm)
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_RightSetPwm
- * Description: Sets the right motor PWM value
+ * Description: Sets the right motor PWM value.  Cancels a ramp in progress.
  * Parameters: pwm - the pwm value to be set.  Range from 1000 - 2000
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
 void Motor_RightSetPwm(PWM_TYPE pwm)
 {
+    right_motor.ramp_active = FALSE;
     pwm = constrain(pwm, MIN_PWM_VALUE, MAX_PWM_VALUE);
     right_motor.set_pwm(pwm);
     MOTOR_DUMP(&right_motor);
@@ -251,13 +269,15 @@ void Motor_GetPwm(PWM_TYPE* const left, PWM_TYPE* const right)
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_Stop
  * Description: Stops both left/right motors by setting the PWM to stop, stopping the PWM component,
- *              and disabling the motor driver.
+ *              and disabling the motor driver.  Ramps in progress are canceled.
  * Parameters: None
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
 void Motor_Stop()
 {
+    left_motor.ramp_active = FALSE;
+    right_motor.ramp_active = FALSE;
     left_motor.set_pwm(PWM_STOP);
     right_motor.set_pwm(PWM_STOP);
     left_motor.stop();
@@ -309,7 +329,8 @@ void Motor_Stop()
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Ramp
- * Description: Ramps the motor velocity to the target over the given time (in milliseconds).
+ * Description: Starts ramping the motor velocity to the target over the given time (in milliseconds).
+ *              The ramp is stepped by Motor_Update; this routine does not block.
  * Parameters: motor - the relevant motor, left or right
  *             time_ms - the time in milliseconds over which the motor speed will be reduced.
  *             target - the target pwm
@@ -320,25 +341,53 @@ void Motor_Stop()
  static void Ramp(MOTOR_TYPE* const motor, UINT32 time_ms, PWM_TYPE target, PWM_TYPE step)
 {
     INT16 pwm_step;
-    PWM_TYPE pwm;
     UINT32 time_delay;
 
     pwm_step = step;
     CalcRampParams(motor, time_ms, target, &pwm_step, &time_delay);
-    pwm = motor->get_pwm();
-    
-    do
-    {
-        pwm += pwm_step;
-        motor->set_pwm(pwm);
-        CyDelay(time_delay);
-    } while (pwm != target);
 
+    motor->ramp_target = target;
+    motor->ramp_step = pwm_step;
+    motor->ramp_interval = time_delay;
+    motor->ramp_last_time = millis();
+    motor->ramp_active = pwm_step != 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: StepRamp
+ * Description: Applies the ramp steps that are due.  The last step is limited to the target so the
+ *              ramp always ends on the target pwm.
+ * Parameters: motor - the relevant motor, left or right
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void StepRamp(MOTOR_TYPE* const motor)
+{
+    INT16 pwm;
+    INT16 remaining;
+
+    while (motor->ramp_active && millis() - motor->ramp_last_time >= motor->ramp_interval)
+    {
+        motor->ramp_last_time += motor->ramp_interval;
+        
+        pwm = (INT16) motor->get_pwm() + motor->ramp_step;
+        remaining = (INT16) motor->ramp_target - pwm;
+        
+        /* Done when the step reaches or passes the target */
+        if (remaining == 0 || (remaining > 0) != (motor->ramp_step > 0))
+        {
+            pwm = (INT16) motor->ramp_target;
+            motor->ramp_active = FALSE;
+        }
+        
+        motor->set_pwm((PWM_TYPE) pwm);
+    }
 }
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_LeftRamp
- * Description: Ramps the left motor velocity to the target over the given time (in milliseconds).
+ * Description: Starts ramping the left motor velocity to the target over the given time (in milliseconds).
+ *              Poll Motor_LeftRampDone for completion.
  * Parameters: time - the time in milliseconds over which the motor speed will be adjusted.
  * Return: None
  * 
@@ -350,7 +399,8 @@ void Motor_Stop()
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_RightRamp
- * Description: Ramps the right motor velocity to the target over the given time (in milliseconds).
+ * Description: Starts ramping the right motor velocity to the target over the given time (in milliseconds).
+ *              Poll Motor_RightRampDone for completion.
  * Parameters: time - the time in milliseconds over which the motor speed will be adjusted.
  * Return: None
  * 
@@ -362,7 +412,8 @@ void Motor_Stop()
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_LeftRampDown
- * Description: Ramps down the left motor velocity over the given time (in milliseconds).
+ * Description: Starts ramping down the left motor velocity over the given time (in milliseconds).
+ *              Poll Motor_LeftRampDone for completion.
  * Parameters: time - the time in milliseconds over which the motor speed will be reduced.
  * Return: None
  * 
@@ -374,7 +425,8 @@ void Motor_LeftRampDown(UINT32 time)
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Motor_RightRampDown
- * Description: Ramps down the right motor velocity over the given time (in milliseconds).
+ * Description: Starts ramping down the right motor velocity over the given time (in milliseconds).
+ *              Poll Motor_RightRampDone for completion.
  * Parameters: time - the time in milliseconds over which the motor speed will be reduced.
  * Return: None
  * 
@@ -384,5 +436,43 @@ void Motor_RightRampDown(UINT32 time)
     Ramp(&right_motor, time, PWM_STOP, 10);
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Motor_LeftRampDone
+ * Description: Reports whether the left motor ramp has completed (or was canceled).
+ * Parameters: None
+ * Return: BOOL - TRUE if no ramp is in progress, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Motor_LeftRampDone()
+{
+    return !left_motor.ramp_active;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Motor_RightRampDone
+ * Description: Reports whether the right motor ramp has completed (or was canceled).
+ * Parameters: None
+ * Return: BOOL - TRUE if no ramp is in progress, otherwise FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Motor_RightRampDone()
+{
+    return !right_motor.ramp_active;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Motor_Update
+ * Description: Called from the main loop.  Steps the left/right motor ramps.  Both motors may ramp
+ *              at the same time.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Motor_Update()
+{
+    StepRamp(&left_motor);
+    StepRamp(&right_motor);
+}
+
 
 /* [] END OF FILE */
@@ -43,6 +43,7 @@ SOFTWARE.
 typedef void (*SET_MOTOR_PWM_FUNC_TYPE)(PWM_TYPE pwm);
 typedef PWM_TYPE (*GET_MOTOR_PWM_FUNC_TYPE)();
 typedef void (*RAMP_DOWN_PWM_FUNC_TYPE)(UINT32 millis);
+typedef BOOL (*RAMP_DONE_FUNC_TYPE)();
 
     
 /*---------------------------------------------------------------------------------------------------
@@ -51,6 +52,7 @@ typedef void (*RAMP_DOWN_PWM_FUNC_TYPE)(UINT32 millis);
 void Motor_Init();
 void Motor_Start();
 void Motor_Stop();
+void Motor_Update();
 
 void Motor_LeftSetPwm(PWM_TYPE pwm);
 void Motor_RightSetPwm(PWM_TYPE pwm);
@@ -64,6 +66,8 @@ void Motor_LeftRamp(UINT32 time, PWM_TYPE target);
 void Motor_RightRamp(UINT32 time, PWM_TYPE target);
 void Motor_LeftRampDown(UINT32 time);
 void Motor_RightRampDown(UINT32 time);
+BOOL Motor_LeftRampDone();
+BOOL Motor_RightRampDone();
 
 #endif
 
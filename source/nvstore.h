@@ -52,8 +52,16 @@ SOFTWARE.
     
  */
         
-#define NVSTORE_CAL_EEPROM_BASE                 ((volatile CAL_EEPROM_TYPE *) CYDEV_EE_BASE);
-#define NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(addr) ((UINT16)((UINT8 *)addr - (UINT8 *) CYDEV_EE_BASE))
+/* Under unit testing the EEPROM is an array defined by the test, which the Nvstore_WriteBytes mock writes to */
+#ifdef FREESOC_TEST
+extern UINT8 nvstore_test_eeprom[];
+#define NVSTORE_EEPROM_BASE                     (nvstore_test_eeprom)
+#else
+#define NVSTORE_EEPROM_BASE                     (CYDEV_EE_BASE)
+#endif
+        
+#define NVSTORE_CAL_EEPROM_BASE                 ((volatile CAL_EEPROM_TYPE *) NVSTORE_EEPROM_BASE);
+#define NVSTORE_CAL_EEPROM_ADDR_TO_OFFSET(addr) ((UINT16)((UINT8 *)addr - (UINT8 *) NVSTORE_EEPROM_BASE))
 
 /*---------------------------------------------------------------------------------------------------
  * Constants
@@ -41,6 +41,7 @@ SOFTWARE.
 #include "cal.h"
 #include "control.h"
 #include "consts.h"
+#include "angle.h"
 
 
 /*---------------------------------------------------------------------------------------------------
@@ -75,6 +76,8 @@ static FLOAT angular_meas_velocity;
 static FLOAT linear_bias;
 static FLOAT angular_bias;
 
+static UINT32 sample_time_ms = ODOM_SAMPLE_TIME_MS;
+
 
 /*---------------------------------------------------------------------------------------------------
  * Functions
@@ -122,6 +125,7 @@ void Odom_Init()
     theta = 0.0;
     linear_meas_velocity = 0.0;
     angular_meas_velocity = 0.0;
+    sample_time_ms = ODOM_SAMPLE_TIME_MS;
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -165,7 +169,7 @@ void Odom_Update()
     
     delta_time = millis() - last_update_time;
     ODOM_DEBUG_DELTA(delta_time);
-    if (delta_time >= ODOM_SAMPLE_TIME_MS)
+    if (delta_time >= sample_time_ms)
     {
         last_update_time = millis();
         
@@ -233,13 +237,16 @@ void Odom_Update()
         FLOAT left_delta_dist = 2 * PI * WHEEL_RADIUS * (FLOAT) left_delta_tick / WHEEL_COUNT_PER_REV;
         FLOAT right_delta_dist = 2 * PI * WHEEL_RADIUS * (FLOAT) right_delta_tick / WHEEL_COUNT_PER_REV;
         FLOAT center_delta_dist = linear_bias * (left_delta_dist + right_delta_dist) / 2.0;
+        FLOAT sin_theta;
+        FLOAT cos_theta;
         
         theta += angular_bias * (right_delta_dist - left_delta_dist)/TRACK_WIDTH;
         /* Constrain theta to -PI to PI */
         theta = NormalizeHeading(theta);
 
-        x_position += center_delta_dist * cos(theta);
-        y_position += center_delta_dist * sin(theta);
+        Angle_SinCos(theta, &sin_theta, &cos_theta);
+        x_position += center_delta_dist * cos_theta;
+        y_position += center_delta_dist * sin_theta;
         
 #endif        
 
@@ -251,6 +258,18 @@ void Odom_Update()
     ODOM_UPDATE_END();    
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Odom_SetSampleTime
+ * Description: Sets the odometry sampling period, i.e., the rate at which odometry is published.
+ * Parameters: period - the sampling period in milliseconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Odom_SetSampleTime(UINT32 period)
+{
+    sample_time_ms = period;
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Odom_Reset
  * Description: Resets the odometry fields and updates them in the I2C interface.
@@ -41,6 +41,7 @@ SOFTWARE.
 void Odom_Init();
 void Odom_Start();
 void Odom_Update();
+void Odom_SetSampleTime(UINT32 period);
 void Odom_Reset();
 FLOAT Odom_GetHeading();
 void Odom_GetMeasVelocity(FLOAT* const linear, FLOAT* const angular);
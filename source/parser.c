@@ -1,5 +1,3 @@
-
-
 /*---------------------------------------------------------------------------------------------------
  * Includes
  *-------------------------------------------------------------------------------------------------*/    
@@ -8,121 +6,97 @@
 #include "serial.h"
 
 
-#define MAX_NUM_ELMS (10)
-#define MAX_STR_LEN (MAX_LINE_LENGTH)
-
-static const char SPACE_STR[2] = " ";
+static BOOL EnforceArgumentMutualExclusion(BOOL arg1, BOOL arg2)
+{
+    if ((arg1 && arg2) || (!arg1 && !arg2))
+    {
+        return FALSE;
+    }
 
-static char args_strs[MAX_NUM_ELMS][MAX_STR_LEN];
-static char* args_ptrs[MAX_NUM_ELMS];
-static char **ppargs;
+    return TRUE;
+}
 
-static void init_args_storage()
+static void PrintHelp(const CONPARSER_HELP_TYPE *help, UINT8 num_help, UINT8 groups)
 {
-    int ii;
-    ppargs = &args_ptrs[0];
-    
-    for (ii = 0; ii < MAX_NUM_ELMS; ++ii)
+    UINT8 ii;
+
+    for (ii = 0; ii < num_help; ++ii)
     {
-        ppargs[ii] = args_strs[ii];
+        if (help[ii].groups & groups)
+        {
+            Ser_PutStringFormat("    %s\r\n", help[ii].text);
+        }
     }
 }
 
-static int args_str_array(CHAR * const str)
+static void PrintUsage(UINT8 groups)
 {
-   CHAR *token;
-   int index = 0;
-   
-   /* get the first token */
-   token = strtok(str, SPACE_STR);
-   
-   /* walk through other tokens */
-   while( token != NULL ) {
-      strcpy(ppargs[index], token);
-      index++;
-      token = strtok(NULL, SPACE_STR);
-   }
-   
-   return index;
+    Ser_PutStringFormat("%s\r\n\r\nUsage:\r\n", conparser_title);
+    PrintHelp(conparser_usage, CONPARSER_NUM_USAGE, groups);
 }
 
-static BOOL EnforceArgumentMutualExclusion(BOOL arg1, BOOL arg2)
+static UINT8 GetHelpGroups(DocoptArgs const * const args)
 {
-    if ((arg1 && arg2) || (!arg1 && !arg2))
+    if (args->motor)
     {
-        return FALSE;
+        return CONPARSER_GROUP_MOTOR;
+    }
+    else if (args->pid)
+    {
+        return CONPARSER_GROUP_PID;
+    }
+    else if (args->config)
+    {
+        return CONPARSER_GROUP_CONFIG;
+    }
+    else if (args->motion)
+    {
+        return CONPARSER_GROUP_MOTION;
+    }
+    else if (args->macro)
+    {
+        return CONPARSER_GROUP_MACRO;
     }
 
-    return TRUE;
+    return 0xFF;
 }
 
 void Parser_Init(void)
 {
-    memset(args_strs, 0, sizeof args_strs);
-    memset(args_ptrs, 0, sizeof args_ptrs);
-    ppargs = 0;
 }
 
 void Parser_Start(void)
 {
-    init_args_storage();
 }
 
 void Parser_Parse(CHAR* const line, COMMAND_TYPE* const cmd)
 {
-    int success;
-    int num_args;
+    UINT8 groups;
     
     if (strcmp(line, "exit") == 0)
     {
         cmd->is_exit = TRUE;
     }
     
-    num_args = args_str_array(line);      
-    cmd->args = docopt(num_args, ppargs, 1, "0.1.0", &success); 
-    Ser_PutStringFormat("\r\nSuccess: %d\r\n", success);
+    /* The line is tokenized in place and the option arguments point into it, so it must outlive the command */
+    if (ConParser_Parse(line, &cmd->args) != CONPARSER_OK)
+    {
+        PrintUsage(0xFF);
+        cmd->is_parsed = FALSE;
+        return;
+    }
 
-    switch (success)
+    if (cmd->args.help)
     {
-        case -1:
-            Ser_PutString((CHAR * const) cmd->args.usage_pattern);
-            cmd->is_parsed = FALSE;
-            return;
-    
-    
-        case 1:
-            if (cmd->args.help)
-            {
-                if (cmd->args.motor)
-                {
-                    Ser_PutString((CHAR * const) cmd->args.motor_help_message);
-                }
-                else if (cmd->args.pid)
-                {
-                    Ser_PutString((CHAR * const) cmd->args.pid_help_message);
-                }
-                else if (cmd->args.config)
-                {
-                    Ser_PutString((CHAR * const) cmd->args.config_help_message);
-                }
-                else if (cmd->args.motion)
-                {
-                    Ser_PutString((CHAR * const) cmd->args.motion_help_message);
-                }
-                else
-                {
-                    Ser_PutString((CHAR * const) cmd->args.help_message);
-                }
-
-                cmd->is_parsed = FALSE;
-                return;
-            }
-            else
-            {
-                cmd->is_parsed = TRUE;                
-            }            
+        groups = GetHelpGroups(&cmd->args);
+        PrintUsage(groups);
+        Ser_PutString("\r\nOptions:\r\n");
+        PrintHelp(conparser_options, CONPARSER_NUM_OPTIONS, groups);
+        cmd->is_parsed = FALSE;
+        return;
     }
 
+    cmd->is_parsed = cmd->args.route != CONPARSER_ROUTE_NONE;
     
     /* Note: There are things that the C parser does not enforce that the Python parser does.  This is a just consequence
        of the implementation.  In particular, the C parser does not enforce required syntax, e.g. (blah1|blah2).  I
@@ -168,4 +142,3 @@ void Parser_Parse(CHAR* const line, COMMAND_TYPE* const cmd)
     Ser_PutStringFormat("Command Is Parsed: %d\r\n", cmd->is_parsed);
     
 }
-
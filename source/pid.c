@@ -25,13 +25,19 @@ SOFTWARE.
 
 /*---------------------------------------------------------------------------------------------------
    Description: This module provides a general abstraction for PID control.  There are PIDs for each
-   wheel (left, right) and for linear and angular velocity.
+   wheel (left, right) and for the robot linear/angular velocity which are held and computed by the PID
+   bank (see pidbank.c).
+   
+   The PIDs form a cascade: the inner (wheel) loop runs at the PID rate and the outer (linear/angular)
+   loop runs at the lower outer rate.  The loops are scheduled so that at most one loop runs per pass
+   of the main loop, with the inner loop taking priority.
  *-------------------------------------------------------------------------------------------------*/
 
 /*---------------------------------------------------------------------------------------------------
  * Includes
  *-------------------------------------------------------------------------------------------------*/    
 #include <stdio.h>
+#include <string.h>
 #include "config.h"
 #include "time.h"
 #include "control.h"
@@ -39,9 +45,7 @@ SOFTWARE.
 #include "motor.h"
 #include "odom.h"
 #include "pid.h"
-#include "pidang.h"
-#include "pidleft.h"
-#include "pidright.h"
+#include "pidbank.h"
 #include "utils.h"
 #include "debug.h"
 #include "diag.h"
@@ -60,6 +64,7 @@ SOFTWARE.
  * Constants
  *-------------------------------------------------------------------------------------------------*/    
 #define PID_SAMPLE_TIME_MS  SAMPLE_TIME_MS(PID_SAMPLE_RATE)
+#define OUTER_SAMPLE_TIME_MS  SAMPLE_TIME_MS(OUTER_SAMPLE_RATE)
 
 /*---------------------------------------------------------------------------------------------------
  * Types
@@ -68,35 +73,13 @@ SOFTWARE.
 /*---------------------------------------------------------------------------------------------------
  * Variables
  *-------------------------------------------------------------------------------------------------*/    
+static UINT32 sample_time_ms[PID_LOOP_LAST] = {PID_SAMPLE_TIME_MS, OUTER_SAMPLE_TIME_MS};
+static PID_LOOP_STATS_TYPE loop_stats[PID_LOOP_LAST];
 
 /*---------------------------------------------------------------------------------------------------
  * Functions
  *-------------------------------------------------------------------------------------------------*/    
 
-#if defined (LEFT_PID_DUMP_ENABLED) ||  \
-    defined (RIGHT_PID_DUMP_ENABLED) || \
-    defined (UNIPID_DUMP_ENABLED) ||    \
-    defined (ANGPID_DUMP_ENABLED)
-
-void DumpPid(char* const name, UINT16 debug_bit, PIDControl* const pid)
-{
-    if ( Debug_IsEnabled(debug_bit) )
-    {
-        DEBUG_PRINT_ARG("{\"%s pid\": {\"set_point\":%.3f, \"input\":%.3f, \"error\":%.3f, \"last_input\":%.3f, \"iterm\":%.3f, \"output\":%.3f }}\r\n",
-            name, 
-            IS_NAN_DEFAULT(pid->setpoint, 0), 
-            IS_NAN_DEFAULT(pid->input, 0), 
-            IS_NAN_DEFAULT(pid->setpoint - pid->input, 0), 
-            IS_NAN_DEFAULT(pid->lastInput, 0), 
-            IS_NAN_DEFAULT(pid->iTerm, 0), 
-            IS_NAN_DEFAULT(pid->output, 0)
-        );
-    }
-}
-
-#endif
-
-
 /*---------------------------------------------------------------------------------------------------
  * Name: Pid_Init
  * Description: Starts the EEPROM component used for storing calibration information.
@@ -106,9 +89,10 @@ void DumpPid(char* const name, UINT16 debug_bit, PIDControl* const pid)
  *-------------------------------------------------------------------------------------------------*/
 void Pid_Init()
 {
-    //AngPid_Init();
-    LeftPid_Init();    
-    RightPid_Init();
+    PidBank_Init();
+    sample_time_ms[PID_LOOP_INNER] = PID_SAMPLE_TIME_MS;
+    sample_time_ms[PID_LOOP_OUTER] = OUTER_SAMPLE_TIME_MS;
+    Pid_ResetLoopStats();
 }
     
 /*---------------------------------------------------------------------------------------------------
@@ -120,40 +104,101 @@ void Pid_Init()
  *-------------------------------------------------------------------------------------------------*/
 void Pid_Start()
 {
-    //AngPid_Start();
-    LeftPid_Start();    
-    RightPid_Start();
+    PidBank_Start();
 }
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Pid_Update
- * Description: Updates the left/right PID fields.  This function is called from the main loop and
- *              enforces the PID sampling rate.
+ * Description: Updates the PIDs.  This function is called from the main loop and enforces the
+ *              sampling rate of the inner and outer loops.  When both loops are due, the inner loop
+ *              runs and the outer loop runs on the next pass.
  * Parameters: None
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
 void Pid_Update()
 {
-    static UINT32 last_update_time = PID_SCHED_OFFSET;
-    UINT32 delta_time;
+    static UINT32 last_update_time[PID_LOOP_LAST] = {PID_SCHED_OFFSET, OUTER_SCHED_OFFSET};
+    UINT32 delta_time[PID_LOOP_LAST];
+    PID_LOOP_TYPE loop;
+    PID_LOOP_STATS_TYPE *p_stats;
+    UINT32 start_us;
     
     PID_UPDATE_START();
 
-    delta_time = millis() - last_update_time;
-    PID_DEBUG_DELTA(delta_time);
-    if (delta_time >= PID_SAMPLE_TIME_MS)
+    delta_time[PID_LOOP_INNER] = millis() - last_update_time[PID_LOOP_INNER];
+    delta_time[PID_LOOP_OUTER] = millis() - last_update_time[PID_LOOP_OUTER];
+    PID_DEBUG_DELTA(delta_time[PID_LOOP_INNER]);
+    
+    if (delta_time[PID_LOOP_INNER] >= sample_time_ms[PID_LOOP_INNER])
+    {
+        loop = PID_LOOP_INNER;
+    }
+    else if (delta_time[PID_LOOP_OUTER] >= sample_time_ms[PID_LOOP_OUTER])
+    {
+        loop = PID_LOOP_OUTER;
+    }
+    else
+    {
+        loop = PID_LOOP_LAST;
+    }
+    
+    if (loop != PID_LOOP_LAST)
     {    
-        last_update_time = millis();
+        last_update_time[loop] = millis();
         
-        //AngPid_Process();
-        LeftPid_Process();
-        RightPid_Process();
+        start_us = micros();
+        PidBank_Process(loop);
+        
+        p_stats = &loop_stats[loop];
+        p_stats->count++;
+        p_stats->last_us = micros() - start_us;
+        p_stats->max_us = max(p_stats->max_us, p_stats->last_us);
+        p_stats->max_period_ms = max(p_stats->max_period_ms, delta_time[loop]);
     }
     
     PID_UPDATE_END();    
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pid_SetSampleTime
+ * Description: Sets the sampling period of a PID loop.  The PID gains are re-discretized for the new
+ *              period.
+ * Parameters: loop - the inner or outer loop
+ *             period - the sampling period in milliseconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pid_SetSampleTime(PID_LOOP_TYPE loop, UINT32 period)
+{
+    sample_time_ms[loop] = period;
+    PidBank_SetSampleTime(loop, period / (FLOAT) MS_IN_SEC);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pid_GetLoopStats
+ * Description: Returns the execution statistics of a PID loop.
+ * Parameters: loop - the inner or outer loop
+ * Return: PID_LOOP_STATS_TYPE* - the loop statistics
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+PID_LOOP_STATS_TYPE* Pid_GetLoopStats(PID_LOOP_TYPE loop)
+{
+    return &loop_stats[loop];
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pid_ResetLoopStats
+ * Description: Clears the execution statistics of the PID loops.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pid_ResetLoopStats()
+{
+    memset(loop_stats, 0, sizeof loop_stats);
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Pid_SetLeftRightTarget
  * Description: Sets the left/right get_target fields to a different function.
@@ -166,8 +211,8 @@ void Pid_Update()
  *-------------------------------------------------------------------------------------------------*/
 void Pid_SetLeftRightTarget(GET_TARGET_FUNC_TYPE left_target, GET_TARGET_FUNC_TYPE right_target)
 {
-    LeftPid_SetTarget(left_target);
-    RightPid_SetTarget(right_target);
+    PidBank_SetTarget(PID_TYPE_LEFT, left_target);
+    PidBank_SetTarget(PID_TYPE_RIGHT, right_target);
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -179,8 +224,8 @@ void Pid_SetLeftRightTarget(GET_TARGET_FUNC_TYPE left_target, GET_TARGET_FUNC_TY
  *-------------------------------------------------------------------------------------------------*/
 void Pid_RestoreLeftRightTarget()
 {
-    LeftPid_RestoreTarget();
-    RightPid_RestoreTarget();
+    PidBank_RestoreTarget(PID_TYPE_LEFT);
+    PidBank_RestoreTarget(PID_TYPE_RIGHT);
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -192,59 +237,64 @@ void Pid_RestoreLeftRightTarget()
  *-------------------------------------------------------------------------------------------------*/
 void Pid_Reset()
 {
-    AngPid_Reset();
-    LeftPid_Reset();
-    RightPid_Reset();
+    PidBank_Reset(PID_TYPE_LEFT);
+    PidBank_Reset(PID_TYPE_RIGHT);
+    PidBank_Reset(PID_TYPE_LINEAR);
+    PidBank_Reset(PID_TYPE_ANGULAR);
 }
 
 /*---------------------------------------------------------------------------------------------------
  * Name: Pid_Enable
  * Description: Enables/Disables the PID.  This is needed for motor and PID calibration.
- * Parameters: None
+ *              Note: The outer loop is not re-enabled when calibration completes; it is enabled
+ *              from the console (see Pid_EnableCascade).
+ * Parameters: left - enable/disable the left wheel PID
+ *             right - enable/disable the right wheel PID
+ *             uni - enable/disable the outer (linear/angular) PIDs
  * Return: None
  * 
  *-------------------------------------------------------------------------------------------------*/
 void Pid_Enable(BOOL left, BOOL right, BOOL uni)
 {
-    //AngPid_Enable(uni);
-    LeftPid_Enable(left);
-    RightPid_Enable(right);
-}
-
-void Pid_Bypass(BOOL left, BOOL right, BOOL uni)
-{
-    LeftPid_Bypass(left);
-    RightPid_Bypass(right);
-    //AngPid_Bypass(uni);
+    PidBank_Enable(PID_TYPE_LEFT, left);
+    PidBank_Enable(PID_TYPE_RIGHT, right);
+    Pid_EnableCascade(uni, uni);
 }
 
-void Pid_BypassAll(BOOL bypass)
-{
-    //AngPid_Bypass(bypass);
-    LeftPid_Bypass(bypass);
-    RightPid_Bypass(bypass);
-}
-
-BOOL Pid_SetGains(PIDControl* const p_pid, CAL_PID_TYPE* const p_gains)
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pid_EnableCascade
+ * Description: Enables/Disables the outer (linear/angular velocity) PIDs.
+ * Parameters: linear - enable/disable the linear velocity PID
+ *             angular - enable/disable the angular velocity PID
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pid_EnableCascade(BOOL linear, BOOL angular)
 {
-    BOOL result = FALSE;
-
-    // Note: the PID gains are stored in EEPROM.  The EEPROM cannot be accessed until the EEPROM
-    // component is started which is handled in the Nvstore module.  
-    // Pid_Start is called after Nvstore_Start.
-    
-    if (Cal_GetCalibrationStatusBit(CAL_PID_BIT))
+    /* Start from a clean state so a stale integrator does not kick the robot */
+    if (linear && !PidBank_IsEnabled(PID_TYPE_LINEAR))
     {
-        PIDTuningsSet(p_pid, p_gains->kp, p_gains->ki, p_gains->kd, p_gains->kf);
-        result = TRUE;
+        PidBank_Reset(PID_TYPE_LINEAR);
     }
-    else
+    if (angular && !PidBank_IsEnabled(PID_TYPE_ANGULAR))
     {
-        Ser_PutString("No valid PID calibration\r\n");        
+        PidBank_Reset(PID_TYPE_ANGULAR);
     }
     
-    return result;
+    PidBank_Enable(PID_TYPE_LINEAR, linear);
+    PidBank_Enable(PID_TYPE_ANGULAR, angular);
 }
 
+void Pid_Bypass(BOOL left, BOOL right, BOOL uni)
+{
+    PidBank_Bypass(PID_TYPE_LEFT, left);
+    PidBank_Bypass(PID_TYPE_RIGHT, right);
+}
+
+void Pid_BypassAll(BOOL bypass)
+{
+    PidBank_Bypass(PID_TYPE_LEFT, bypass);
+    PidBank_Bypass(PID_TYPE_RIGHT, bypass);
+}
 
 /* [] END OF FILE */
@@ -24,7 +24,8 @@ SOFTWARE.
 
 /*---------------------------------------------------------------------------------------------------
    Description: This module provides a general abstraction for PID control.  There are PIDs for each
-   wheel (left, right) and for linear and angular velocity.
+   wheel (left, right) and for the robot linear/angular velocity which are held and computed by the PID
+   bank (see pidbank.c).
  *-------------------------------------------------------------------------------------------------*/
 
 #ifndef PID_H
@@ -35,8 +36,18 @@ SOFTWARE.
  *-------------------------------------------------------------------------------------------------*/    
 #include "freesoc.h"
 #include "pidtypes.h"
-#include "calstore.h"
-#include "pid_controller.h"
+    
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+/* Execution statistics of a PID loop */
+typedef struct _pid_loop_stats_tag
+{
+    UINT32 count;           /* number of samples */
+    UINT32 last_us;         /* execution time of the last sample (microsecond) */
+    UINT32 max_us;          /* maximum execution time (microsecond) */
+    UINT32 max_period_ms;   /* maximum time between samples (millisecond) */
+} PID_LOOP_STATS_TYPE;
     
 /*---------------------------------------------------------------------------------------------------
  * Functions
@@ -44,15 +55,16 @@ SOFTWARE.
 void Pid_Init();
 void Pid_Start();
 void Pid_Update();
+void Pid_SetSampleTime(PID_LOOP_TYPE loop, UINT32 period);
+PID_LOOP_STATS_TYPE* Pid_GetLoopStats(PID_LOOP_TYPE loop);
+void Pid_ResetLoopStats();
 void Pid_SetLeftRightTarget(GET_TARGET_FUNC_TYPE left_target, GET_TARGET_FUNC_TYPE right_target);
 void Pid_RestoreLeftRightTarget();
 void Pid_Reset();
 void Pid_Enable(BOOL left, BOOL right, BOOL uni);
+void Pid_EnableCascade(BOOL linear, BOOL angular);
 void Pid_Bypass(BOOL left, BOOL right, BOOL uni);
 void Pid_BypassAll(BOOL bypass);
-BOOL Pid_SetGains(PIDControl* const p_pid, CAL_PID_TYPE* const p_gains);
-
-void DumpPid(char* const name, UINT16 debug_bit, PIDControl* const pid);
 
 #endif
 
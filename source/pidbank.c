@@ -0,0 +1,836 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a bank of PID controllers.  Each controller is a row in the
+   descriptor table which names the controller's input source and output sink.  The controller state
+   is held in a structure-of-arrays so that the bank can be computed in a single loop per sample.
+   
+   The controllers form a cascade of two loops which are processed at their own rates: the inner loop
+   controls the wheel velocity, and the outer loop controls the robot linear/angular velocity by
+   correcting the command of the inner loop.  The outer controllers are disabled by default.
+   
+   PidBank_Process runs in three phases over the controllers of one loop:
+   
+       gather  - read the target and input for each enabled controller
+       compute - run the PID calculation for all enabled controllers in AUTOMATIC mode
+       scatter - write each controller's output (or target when bypassed) to its sink
+       
+   The gains are stored as given and as altered for the sample time (ki * dt, kd / dt).  When the sample time 
+   changes, the altered gains are recomputed from the given gains.
+   
+   A controller may have speed-scheduled gains (see CAL_PID_SCHED_TYPE).  The gains are interpolated from
+   |setpoint| in the gather phase, and only when the setpoint changes.  Because the integrator accumulates
+   ki * error (rather than the error alone), a change in gains does not bump the integral contribution to
+   the output.
+   
+   The wheel controllers have a model-based feedforward when the motor models identified by motor
+   calibration are valid (see calmotor.c).  The count/sec to pwm conversion (see Cal_CpsToPwm) already 
+   inverts the static gain and deadband of the motor, so the feedforward adds the dynamics of the first-order
+   model in count/sec:
+   
+       feedforward = setpoint + tau * d(setpoint)/dt
+       
+   where tau is the time constant for the direction of travel.  The feedforward replaces kf * setpoint so that 
+   the PID terms only correct the residual.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/    
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "control.h"
+#include "encoder.h"
+#include "motor.h"
+#include "cal.h"
+#include "pidbank.h"
+#include "utils.h"
+#include "debug.h"
+#include "serial.h"
+#include "assertion.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Macros
+ *-------------------------------------------------------------------------------------------------*/    
+#if defined (LEFT_PID_DUMP_ENABLED) || defined (RIGHT_PID_DUMP_ENABLED)
+#define PIDBANK_DUMP(index)  DumpPid(index)
+#else
+#define PIDBANK_DUMP(index)
+#endif
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define PIDBANK_NUM_PIDS (4)
+#define PIDBANK_INVALID_INDEX (0xFF)
+#define PIDBANK_SAMPLE_TIME_SEC SAMPLE_TIME_SEC(PID_SAMPLE_RATE)
+#define PIDBANK_OUTER_SAMPLE_TIME_SEC SAMPLE_TIME_SEC(OUTER_SAMPLE_RATE)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _pid_bank_tag
+{
+    FLOAT setpoint[PIDBANK_NUM_PIDS];
+    FLOAT input[PIDBANK_NUM_PIDS];
+    FLOAT last_input[PIDBANK_NUM_PIDS];
+    FLOAT iterm[PIDBANK_NUM_PIDS];
+    FLOAT output[PIDBANK_NUM_PIDS];
+    FLOAT target[PIDBANK_NUM_PIDS];
+    FLOAT sign[PIDBANK_NUM_PIDS];
+    FLOAT out_min[PIDBANK_NUM_PIDS];
+    FLOAT out_max[PIDBANK_NUM_PIDS];
+
+    /* Gains altered for the sample time, i.e., used in the calculation */
+    FLOAT kp[PIDBANK_NUM_PIDS];
+    FLOAT ki[PIDBANK_NUM_PIDS];
+    FLOAT kd[PIDBANK_NUM_PIDS];
+    FLOAT kf[PIDBANK_NUM_PIDS];
+    
+    /* Gains as provided, i.e., for display and storage */
+    FLOAT disp_kp[PIDBANK_NUM_PIDS];
+    FLOAT disp_ki[PIDBANK_NUM_PIDS];
+    FLOAT disp_kd[PIDBANK_NUM_PIDS];
+    FLOAT disp_kf[PIDBANK_NUM_PIDS];
+
+    BOOL enabled[PIDBANK_NUM_PIDS];
+    BOOL automatic[PIDBANK_NUM_PIDS];
+    
+    /* Speed scheduling: the setpoint at which the gains were last interpolated */
+    BOOL scheduled[PIDBANK_NUM_PIDS];
+    FLOAT sched_setpoint[PIDBANK_NUM_PIDS];
+
+    GET_TARGET_FUNC_TYPE target_source[PIDBANK_NUM_PIDS];
+    GET_TARGET_FUNC_TYPE old_target_source[PIDBANK_NUM_PIDS];
+    
+    PIDBANK_SAMPLE_FUNC_TYPE sample_hook[PIDBANK_NUM_PIDS];
+    
+    /* Model-based feedforward: the time constant per direction (see DIR_TYPE) and the previous setpoint */
+    BOOL feedforward[PIDBANK_NUM_PIDS];
+    FLOAT ff_tau[PIDBANK_NUM_PIDS][2];
+    FLOAT last_setpoint[PIDBANK_NUM_PIDS];
+} PID_BANK_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/    
+
+/* Note: Adding a controller means adding a row here (and a source/sink case if the controller
+   reads or writes something new).
+ */
+static const PID_DESC_TYPE pid_desc[PIDBANK_NUM_PIDS] = {
+    /* name     id                  loop            debug bit                   source                  default target                  sink                    magnitude   out min             out max */
+    {"left",    PID_TYPE_LEFT,      PID_LOOP_INNER, DEBUG_LEFT_PID_ENABLE_BIT,  PID_SOURCE_LEFT_CPS,    Control_LeftGetCmdVelocityCps,  PID_SINK_LEFT_PWM,      TRUE,       PIDBANK_WHEEL_MIN,  PIDBANK_WHEEL_MAX},
+    {"right",   PID_TYPE_RIGHT,     PID_LOOP_INNER, DEBUG_RIGHT_PID_ENABLE_BIT, PID_SOURCE_RIGHT_CPS,   Control_RightGetCmdVelocityCps, PID_SINK_RIGHT_PWM,     TRUE,       PIDBANK_WHEEL_MIN,  PIDBANK_WHEEL_MAX},
+    {"linear",  PID_TYPE_LINEAR,    PID_LOOP_OUTER, DEBUG_UNIPID_ENABLE_BIT,    PID_SOURCE_LINEAR_MPS,  Control_GetCmdLinearVelocity,   PID_SINK_LINEAR_CORR,   FALSE,      PIDBANK_LINEAR_MIN, PIDBANK_LINEAR_MAX},
+    {"angular", PID_TYPE_ANGULAR,   PID_LOOP_OUTER, DEBUG_ANGPID_ENABLE_BIT,    PID_SOURCE_ANGULAR_RPS, Control_GetCmdAngularVelocity,  PID_SINK_ANGULAR_CORR,  FALSE,      PIDBANK_ANGULAR_MIN,PIDBANK_ANGULAR_MAX},
+};
+
+static PID_BANK_TYPE bank;
+static CAL_PID_SCHED_TYPE schedules[PIDBANK_NUM_PIDS];
+static FLOAT sample_time_sec[PID_LOOP_LAST] = {PIDBANK_SAMPLE_TIME_SEC, PIDBANK_OUTER_SAMPLE_TIME_SEC};
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/    
+
+#if defined (LEFT_PID_DUMP_ENABLED) || defined (RIGHT_PID_DUMP_ENABLED)
+static void DumpPid(UINT8 index)
+{
+    if ( Debug_IsEnabled(pid_desc[index].debug_bit) )
+    {
+        DEBUG_PRINT_ARG("{\"%s pid\": {\"set_point\":%.3f, \"input\":%.3f, \"error\":%.3f, \"last_input\":%.3f, \"iterm\":%.3f, \"output\":%.3f }}\r\n",
+            pid_desc[index].name, 
+            IS_NAN_DEFAULT(bank.setpoint[index], 0), 
+            IS_NAN_DEFAULT(bank.input[index], 0), 
+            IS_NAN_DEFAULT(bank.setpoint[index] - bank.input[index], 0), 
+            IS_NAN_DEFAULT(bank.last_input[index], 0), 
+            IS_NAN_DEFAULT(bank.iterm[index], 0), 
+            IS_NAN_DEFAULT(bank.output[index], 0)
+        );
+    }
+}
+#endif
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: FindPid
+ * Description: Returns the bank index of the specified controller.
+ * Parameters: id - the controller identifier
+ * Return: the bank index or PIDBANK_INVALID_INDEX if the controller is not in the bank.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static UINT8 FindPid(PID_ENUM_TYPE id)
+{
+    UINT8 ii;
+    
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (pid_desc[ii].id == id)
+        {
+            return ii;
+        }
+    }
+    
+    ASSERTION(FALSE, "Unknown PID");
+    return PIDBANK_INVALID_INDEX;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ReadSource
+ * Description: Returns the current value of the specified input source.
+ * Parameters: source - the input source
+ * Return: FLOAT - the input value
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static FLOAT ReadSource(PID_SOURCE_TYPE source)
+{
+    FLOAT left_cps;
+    FLOAT right_cps;
+    FLOAT linear;
+    FLOAT angular;
+    
+    switch (source)
+    {
+        case PID_SOURCE_LEFT_CPS:
+            return Encoder_LeftGetCntsPerSec();
+            
+        case PID_SOURCE_RIGHT_CPS:
+            return Encoder_RightGetCntsPerSec();
+            
+        case PID_SOURCE_LINEAR_MPS:
+        case PID_SOURCE_ANGULAR_RPS:
+            /* Note: The robot velocity is calculated from the encoders rather than read from odometry
+               because odometry is updated at a lower rate than the outer loop may run.
+               The encoders are read into locals so that the read order (left, then right) is defined.
+             */
+            left_cps = Encoder_LeftGetCntsPerSec();
+            right_cps = Encoder_RightGetCntsPerSec();
+            DiffToUni(left_cps * WHEEL_RADIAN_PER_COUNT, right_cps * WHEEL_RADIAN_PER_COUNT, &linear, &angular);
+            return source == PID_SOURCE_LINEAR_MPS ? linear : angular;
+            
+        default:
+            ASSERTION(FALSE, "Unknown PID source");
+            return 0.0;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: WriteSink
+ * Description: Writes a value to the specified output sink.
+ * Parameters: sink - the output sink
+ *             value - the value to write
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void WriteSink(PID_SINK_TYPE sink, FLOAT value)
+{
+    switch (sink)
+    {
+        case PID_SINK_LEFT_PWM:
+            Motor_LeftSetPwm(Cal_CpsToPwm(WHEEL_LEFT, value));
+            break;
+            
+        case PID_SINK_RIGHT_PWM:
+            Motor_RightSetPwm(Cal_CpsToPwm(WHEEL_RIGHT, value));
+            break;
+            
+        case PID_SINK_LINEAR_CORR:
+            Control_SetLinearCorrection(value);
+            break;
+            
+        case PID_SINK_ANGULAR_CORR:
+            Control_SetAngularCorrection(value);
+            break;
+            
+        default:
+            ASSERTION(FALSE, "Unknown PID sink");
+            break;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: StoreGains
+ * Description: Stores the gains of a controller, altering them for the sample time.
+ * Parameters: index - the bank index
+ *             kp - the proportional gain
+ *             ki - the integral gain
+ *             kd - the derivative gain
+ *             kf - the feedforward gain
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void StoreGains(UINT8 index, FLOAT kp, FLOAT ki, FLOAT kd, FLOAT kf)
+{
+    FLOAT dt = sample_time_sec[pid_desc[index].loop];
+    
+    bank.disp_kp[index] = kp;
+    bank.disp_ki[index] = ki;
+    bank.disp_kd[index] = kd;
+    bank.disp_kf[index] = kf;
+    
+    bank.kp[index] = kp;
+    bank.ki[index] = ki * dt;
+    bank.kd[index] = kd / dt;
+    bank.kf[index] = kf;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ApplySchedule
+ * Description: Interpolates the gains of a controller from its schedule at the current setpoint.
+ * Parameters: index - the bank index
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void ApplySchedule(UINT8 index)
+{
+    CAL_PID_SCHED_TYPE *p_sched = &schedules[index];
+    CAL_PID_TYPE *lower;
+    CAL_PID_TYPE *upper;
+    FLOAT cps;
+    FLOAT frac;
+    UINT8 ii;
+    
+    cps = bank.setpoint[index];
+    cps = abs(cps);
+    bank.sched_setpoint[index] = bank.setpoint[index];
+    
+    /* Outside the schedule the end bands are used */
+    if (p_sched->num_bands == 1 || cps <= p_sched->cps[0])
+    {
+        lower = &p_sched->gains[0];
+        StoreGains(index, lower->kp, lower->ki, lower->kd, lower->kf);
+        return;
+    }
+    
+    if (cps >= p_sched->cps[p_sched->num_bands - 1])
+    {
+        upper = &p_sched->gains[p_sched->num_bands - 1];
+        StoreGains(index, upper->kp, upper->ki, upper->kd, upper->kf);
+        return;
+    }
+    
+    /* Find the bands that bracket the setpoint and interpolate */
+    ii = 1;
+    while (ii < p_sched->num_bands - 1 && cps > p_sched->cps[ii])
+    {
+        ++ii;
+    }
+    
+    lower = &p_sched->gains[ii - 1];
+    upper = &p_sched->gains[ii];
+    frac = (cps - p_sched->cps[ii - 1]) / (FLOAT) (p_sched->cps[ii] - p_sched->cps[ii - 1]);
+    
+    StoreGains(index, 
+               lower->kp + frac * (upper->kp - lower->kp),
+               lower->ki + frac * (upper->ki - lower->ki),
+               lower->kd + frac * (upper->kd - lower->kd),
+               lower->kf + frac * (upper->kf - lower->kf));
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Init
+ * Description: Initializes module variables to default values.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Init()
+{
+    UINT8 ii;
+    
+    memset(&bank, 0, sizeof bank);
+    memset(schedules, 0, sizeof schedules);
+    sample_time_sec[PID_LOOP_INNER] = PIDBANK_SAMPLE_TIME_SEC;
+    sample_time_sec[PID_LOOP_OUTER] = PIDBANK_OUTER_SAMPLE_TIME_SEC;
+    
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        bank.sign[ii] = 1.0;
+        bank.out_min[ii] = pid_desc[ii].out_min;
+        bank.out_max[ii] = pid_desc[ii].out_max;
+        bank.enabled[ii] = FALSE;
+        bank.automatic[ii] = TRUE;
+        bank.target_source[ii] = pid_desc[ii].target;
+        bank.old_target_source[ii] = NULL;
+        bank.sample_hook[ii] = NULL;
+        bank.feedforward[ii] = FALSE;
+    }
+}
+    
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Start
+ * Description: Obtains the PID gains from EEPROM and sets them into each controller.  The inner
+ *              controllers are enabled.  The outer controllers are enabled from the console.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Start()
+{
+    UINT8 ii;
+    CAL_PID_TYPE *p_gains;
+    CAL_PID_SCHED_TYPE *p_sched;
+    
+    // Note: the PID gains are stored in EEPROM.  The EEPROM cannot be accessed until the EEPROM
+    // component is started which is handled in the Nvstore module.  
+    // Pid_Start is called after Nvstore_Start.
+    
+    if (!Cal_GetCalibrationStatusBit(CAL_PID_BIT))
+    {
+        Ser_PutString("No valid PID calibration\r\n");
+    }
+    
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (pid_desc[ii].loop == PID_LOOP_OUTER)
+        {
+            if (Cal_GetCalibrationStatusBit(CAL_CASCADE_BIT))
+            {
+                p_gains = Cal_GetPidGains(pid_desc[ii].id);
+                PidBank_SetGains(pid_desc[ii].id, p_gains->kp, p_gains->ki, p_gains->kd, p_gains->kf);
+            }
+            continue;
+        }
+        
+        if (Cal_GetCalibrationStatusBit(CAL_PID_BIT))
+        {
+            p_gains = Cal_GetPidGains(pid_desc[ii].id);
+            PidBank_SetGains(pid_desc[ii].id, p_gains->kp, p_gains->ki, p_gains->kd, p_gains->kf);
+        }
+        
+        /* Note: A stored gain schedule takes precedence over the single gain set */
+        p_sched = Cal_GetPidSchedule(pid_desc[ii].id);
+        if (Cal_IsPidScheduleValid(p_sched))
+        {
+            PidBank_SetSchedule(pid_desc[ii].id, p_sched);
+        }
+        bank.enabled[ii] = TRUE;
+    }
+    
+    PidBank_LoadFeedforward();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_LoadFeedforward
+ * Description: Sets the feedforward of the wheel controllers from the motor models stored in EEPROM.  
+ *              The feedforward is used only when the models of both directions are valid.  Note: erased
+ *              EEPROM reads as zero (see calstore.h) so an erased model is not valid; valid is compared to
+ *              TRUE so that any other non-zero value is not valid either.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_LoadFeedforward()
+{
+    CAL_MOTOR_MODEL_TYPE *p_fwd;
+    CAL_MOTOR_MODEL_TYPE *p_bwd;
+    
+    p_fwd = Cal_GetMotorModel(WHEEL_LEFT, DIR_FORWARD);
+    p_bwd = Cal_GetMotorModel(WHEEL_LEFT, DIR_BACKWARD);
+    PidBank_SetFeedforward(PID_TYPE_LEFT, p_fwd->valid == TRUE && p_bwd->valid == TRUE, p_fwd->tau, p_bwd->tau);
+    
+    p_fwd = Cal_GetMotorModel(WHEEL_RIGHT, DIR_FORWARD);
+    p_bwd = Cal_GetMotorModel(WHEEL_RIGHT, DIR_BACKWARD);
+    PidBank_SetFeedforward(PID_TYPE_RIGHT, p_fwd->valid == TRUE && p_bwd->valid == TRUE, p_fwd->tau, p_bwd->tau);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetFeedforward
+ * Description: Enables/Disables the model-based feedforward of a controller.  When disabled, the 
+ *              feedforward is kf * setpoint.
+ * Parameters: id - the controller identifier
+ *             value - TRUE to enable; FALSE to disable.
+ *             fwd_tau - the motor time constant (second) in the forward direction
+ *             bwd_tau - the motor time constant (second) in the backward direction
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetFeedforward(PID_ENUM_TYPE id, BOOL value, FLOAT fwd_tau, FLOAT bwd_tau)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.feedforward[index] = value;
+        bank.ff_tau[index][DIR_FORWARD] = fwd_tau;
+        bank.ff_tau[index][DIR_BACKWARD] = bwd_tau;
+        bank.last_setpoint[index] = bank.setpoint[index];
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Process
+ * Description: Runs one sample of every enabled controller of a loop.
+ * Parameters: loop - the inner or outer loop
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Process(PID_LOOP_TYPE loop)
+{
+    UINT8 ii;
+    FLOAT value;
+    FLOAT error;
+    FLOAT output;
+    FLOAT ff;
+    
+    /* Gather: sample the target and input of each enabled controller */
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (bank.enabled[ii] && pid_desc[ii].loop == loop)
+        {
+            value = bank.target_source[ii]();
+            bank.target[ii] = value;
+            bank.sign[ii] = value >= 0.0 ? 1.0 : -1.0;
+            bank.setpoint[ii] = pid_desc[ii].magnitude ? bank.sign[ii] * value : value;
+            
+            value = ReadSource(pid_desc[ii].source);
+            bank.input[ii] = pid_desc[ii].magnitude ? abs(value) : value;
+            
+            if (bank.scheduled[ii] && bank.setpoint[ii] != bank.sched_setpoint[ii])
+            {
+                ApplySchedule(ii);
+            }
+        }
+    }
+    
+    /* Compute: the PID calculation with derivative on measurement and integrator clamping.
+       Note: MANUAL (bypassed) controllers are not computed and keep their state.
+     */
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (bank.enabled[ii] && bank.automatic[ii] && pid_desc[ii].loop == loop)
+        {
+            error = bank.setpoint[ii] - bank.input[ii];
+
+            bank.iterm[ii] += bank.ki[ii] * error;
+            bank.iterm[ii] = constrain(bank.iterm[ii], bank.out_min[ii], bank.out_max[ii]);
+
+            ff = bank.kf[ii] * bank.setpoint[ii];
+            if (bank.feedforward[ii])
+            {
+                ff = bank.setpoint[ii] + 
+                     bank.ff_tau[ii][bank.sign[ii] < 0.0 ? DIR_BACKWARD : DIR_FORWARD] * 
+                     (bank.setpoint[ii] - bank.last_setpoint[ii]) / sample_time_sec[loop];
+            }
+
+            output = ff + 
+                     bank.kp[ii] * error + 
+                     bank.iterm[ii] - 
+                     bank.kd[ii] * (bank.input[ii] - bank.last_input[ii]);
+            bank.output[ii] = constrain(output, bank.out_min[ii], bank.out_max[ii]);
+
+            bank.last_input[ii] = bank.input[ii];
+            bank.last_setpoint[ii] = bank.setpoint[ii];
+        }
+    }
+
+    /* Scatter: write the output (or the unmodified target when bypassed) to each sink.  Note: an outer
+       controller outputs a correction, so when bypassed it corrects nothing.
+     */
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (bank.enabled[ii] && pid_desc[ii].loop == loop)
+        {
+            value = pid_desc[ii].loop == PID_LOOP_OUTER ? 0.0 : bank.target[ii];
+            if (bank.automatic[ii])
+            {
+                value = pid_desc[ii].magnitude ? bank.output[ii] * bank.sign[ii] : bank.output[ii];
+            }
+            WriteSink(pid_desc[ii].sink, value);
+            PIDBANK_DUMP(ii);
+            
+            if (bank.sample_hook[ii])
+            {
+                bank.sample_hook[ii](bank.setpoint[ii], bank.input[ii], bank.output[ii], bank.iterm[ii]);
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetTarget
+ * Description: Sets the target source of a controller to the specified function.
+ *              Note: This is done during calibration to allow internal control of the wheel speed.
+ * Parameters: id - the controller identifier
+ *             target - the function that will be the source of the target.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetTarget(PID_ENUM_TYPE id, GET_TARGET_FUNC_TYPE target)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.old_target_source[index] = bank.target_source[index];
+        bank.target_source[index] = target;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_RestoreTarget
+ * Description: Restores the target source of a controller to the previous function.
+ * Parameters: id - the controller identifier
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_RestoreTarget(PID_ENUM_TYPE id)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.target_source[index] = bank.old_target_source[index];
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetSampleHook
+ * Description: Sets a function which is called with the controller state after each sample of the
+ *              controller.  The function is called from the PID sample, so it must be short.
+ * Parameters: id - the controller identifier
+ *             hook - the function to call or NULL to remove the hook
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetSampleHook(PID_ENUM_TYPE id, PIDBANK_SAMPLE_FUNC_TYPE hook)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.sample_hook[index] = hook;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Reset
+ * Description: Resets the controller state.
+ * Parameters: id - the controller identifier
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Reset(PID_ENUM_TYPE id)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.input[index] = 0;
+        bank.iterm[index] = 0;
+        bank.last_input[index] = 0;
+        bank.setpoint[index] = 0;
+        bank.last_setpoint[index] = 0;
+        bank.output[index] = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: SetMode
+ * Description: Sets the controller to AUTOMATIC or MANUAL mode.  On the transition from MANUAL to
+ *              AUTOMATIC, the integrator is seeded from the last output to avoid a bump.
+ * Parameters: index - the bank index
+ *             automatic - TRUE for AUTOMATIC mode; FALSE for MANUAL mode.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void SetMode(UINT8 index, BOOL automatic)
+{
+    if (automatic && !bank.automatic[index])
+    {
+        bank.iterm[index] = constrain(bank.output[index], bank.out_min[index], bank.out_max[index]);
+        bank.last_input[index] = bank.input[index];
+    }
+    
+    bank.automatic[index] = automatic;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Enable
+ * Description: Enables/Disables PID processing of a controller (see PidBank_Process).  There are 
+ *              times when the PID needs to be completely disabled but still callable from the main
+ *              loop.  Disabling an outer controller removes its correction.
+ * Parameters: id - the controller identifier
+ *             value - TRUE to enable; FALSE to disable.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Enable(PID_ENUM_TYPE id, BOOL value)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.enabled[index] = value;
+        if (value)
+        {
+            SetMode(index, TRUE);
+        }
+        else if (pid_desc[index].loop == PID_LOOP_OUTER)
+        {
+            WriteSink(pid_desc[index].sink, 0.0);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_IsEnabled
+ * Description: Returns the enabled state of a controller.
+ * Parameters: id - the controller identifier
+ * Return: BOOL - TRUE if the controller is enabled; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL PidBank_IsEnabled(PID_ENUM_TYPE id)
+{
+    UINT8 index = FindPid(id);
+    
+    return index != PIDBANK_INVALID_INDEX ? bank.enabled[index] : FALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_Bypass
+ * Description: Bypassing the PID calculation by setting the PID mode to either MANUAL or AUTOMATIC.
+ *              MANUAL mode bypasses the PID control calculation and uses the unmodified target value.
+ *              AUTOMATIC mode performs the PID control calculation and uses the PID output value.
+ * Parameters: id - the controller identifier
+ *             value - TRUE if the PID calculation is to be bypassed; otherwise, FALSE.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_Bypass(PID_ENUM_TYPE id, BOOL value)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        /* Note: To bypass the PID calculation, PID processing must be enabled. */
+        if (value)
+        {
+            bank.enabled[index] = TRUE;
+        }
+        
+        SetMode(index, !value);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetGains
+ * Description: Sets the gains of a controller.  Any gain schedule is disabled so that the gains are 
+ *              used as given, e.g., during PID calibration.
+ * Parameters: id - the controller identifier
+ *             kp - the proportional gain
+ *             ki - the integral gain
+ *             kd - the derivative gain
+ *             kf - the feedforward gain
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetGains(PID_ENUM_TYPE id, FLOAT kp, FLOAT ki, FLOAT kd, FLOAT kf)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.scheduled[index] = FALSE;
+        StoreGains(index, kp, ki, kd, kf);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetSchedule
+ * Description: Sets the speed-scheduled gains of a controller.  The gains are interpolated on the 
+ *              next sample.
+ * Parameters: id - the controller identifier
+ *             sched - the gain schedule; NULL or an invalid schedule disables scheduling.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetSchedule(PID_ENUM_TYPE id, CAL_PID_SCHED_TYPE* const sched)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        bank.scheduled[index] = Cal_IsPidScheduleValid(sched);
+        if (bank.scheduled[index])
+        {
+            memcpy(&schedules[index], sched, sizeof(*sched));
+            
+            /* Force interpolation on the next sample */
+            bank.sched_setpoint[index] = NAN;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_SetSampleTime
+ * Description: Sets the sample time of a loop and re-discretizes the gains of its controllers.
+ * Parameters: loop - the inner or outer loop
+ *             sample_time - the sample time in seconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_SetSampleTime(PID_LOOP_TYPE loop, FLOAT sample_time)
+{
+    UINT8 ii;
+    
+    sample_time_sec[loop] = sample_time;
+    
+    for (ii = 0; ii < PIDBANK_NUM_PIDS; ++ii)
+    {
+        if (pid_desc[ii].loop == loop)
+        {
+            StoreGains(ii, bank.disp_kp[ii], bank.disp_ki[ii], bank.disp_kd[ii], bank.disp_kf[ii]);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PidBank_GetGains
+ * Description: Returns the gains of a controller.
+ * Parameters: id - the controller identifier
+ *             kp - the proportional gain
+ *             ki - the integral gain
+ *             kd - the derivative gain
+ *             kf - the feedforward gain
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void PidBank_GetGains(PID_ENUM_TYPE id, FLOAT* const kp, FLOAT* const ki, FLOAT* const kd, FLOAT* const kf)
+{
+    UINT8 index = FindPid(id);
+    
+    if (index != PIDBANK_INVALID_INDEX)
+    {
+        *kp = bank.disp_kp[index];
+        *ki = bank.disp_ki[index];
+        *kd = bank.disp_kd[index];
+        *kf = bank.disp_kf[index];
+    }
+}
+
+/* [] END OF FILE */
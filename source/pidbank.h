@@ -0,0 +1,103 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a bank of PID controllers.  All controllers are described by a
+   single descriptor table, their state is held in a structure-of-arrays layout, and the bank is
+   computed in one pass per PID sample.
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef PIDBANK_H
+#define PIDBANK_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/    
+#include "freesoc.h"
+#include "pidtypes.h"
+#include "consts.h"
+#include "calstore.h"
+    
+/*---------------------------------------------------------------------------------------------------
+ * Macros
+ *-------------------------------------------------------------------------------------------------*/    
+// Wheel PID min/max in count/sec
+#define PIDBANK_WHEEL_MIN (0)
+#define PIDBANK_WHEEL_MAX (min(MAX_WHEEL_FORWARD_COUNT_PER_SEC, abs(MAX_WHEEL_BACKWARD_COUNT_PER_SEC)))
+
+// Outer PID correction limits in meter/sec and radian/sec.  The outer PIDs correct the commanded velocity
+// rather than replace it, so the correction is limited to a fraction of the maximum velocity.
+#define PIDBANK_LINEAR_MAX (MAX_WHEEL_METER_PER_SECOND / 4)
+#define PIDBANK_LINEAR_MIN (-PIDBANK_LINEAR_MAX)
+#define PIDBANK_ANGULAR_MAX (MAX_ROBOT_RADIAN_PER_SECOND / 4)
+#define PIDBANK_ANGULAR_MIN (-PIDBANK_ANGULAR_MAX)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {PID_SOURCE_LEFT_CPS, PID_SOURCE_RIGHT_CPS, PID_SOURCE_LINEAR_MPS, PID_SOURCE_ANGULAR_RPS} PID_SOURCE_TYPE;
+typedef enum {PID_SINK_LEFT_PWM, PID_SINK_RIGHT_PWM, PID_SINK_LINEAR_CORR, PID_SINK_ANGULAR_CORR} PID_SINK_TYPE;
+
+typedef struct _pid_desc_tag
+{
+    char name[8];
+    PID_ENUM_TYPE id;
+    PID_LOOP_TYPE loop;
+    UINT16 debug_bit;
+    PID_SOURCE_TYPE source;
+    GET_TARGET_FUNC_TYPE target;
+    PID_SINK_TYPE sink;
+    BOOL magnitude;         /* TRUE if the controller operates on |target| and |input| */
+    FLOAT out_min;
+    FLOAT out_max;
+} PID_DESC_TYPE;
+
+/* Called with the controller state after each sample, e.g., to capture a step response */
+typedef void (*PIDBANK_SAMPLE_FUNC_TYPE)(FLOAT setpoint, FLOAT input, FLOAT output, FLOAT iterm);
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/    
+void PidBank_Init();
+void PidBank_Start();
+void PidBank_Process(PID_LOOP_TYPE loop);
+
+void PidBank_SetGains(PID_ENUM_TYPE id, FLOAT kp, FLOAT ki, FLOAT kd, FLOAT kf);
+void PidBank_GetGains(PID_ENUM_TYPE id, FLOAT* const kp, FLOAT* const ki, FLOAT* const kd, FLOAT* const kf);
+void PidBank_SetSchedule(PID_ENUM_TYPE id, CAL_PID_SCHED_TYPE* const sched);
+void PidBank_SetSampleTime(PID_LOOP_TYPE loop, FLOAT sample_time);
+BOOL PidBank_IsEnabled(PID_ENUM_TYPE id);
+
+void PidBank_SetTarget(PID_ENUM_TYPE id, GET_TARGET_FUNC_TYPE target);
+void PidBank_RestoreTarget(PID_ENUM_TYPE id);
+void PidBank_SetSampleHook(PID_ENUM_TYPE id, PIDBANK_SAMPLE_FUNC_TYPE hook);
+void PidBank_SetFeedforward(PID_ENUM_TYPE id, BOOL value, FLOAT fwd_tau, FLOAT bwd_tau);
+void PidBank_LoadFeedforward();
+
+void PidBank_Reset(PID_ENUM_TYPE id);
+void PidBank_Enable(PID_ENUM_TYPE id, BOOL value);
+void PidBank_Bypass(PID_ENUM_TYPE id, BOOL value);
+
+#endif
+
+/* [] END OF FILE */
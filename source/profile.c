@@ -0,0 +1,300 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a jerk-limited velocity profile generator.  The profile ramps the
+   velocity from its current state (velocity and acceleration) to a target velocity:
+   
+       - the acceleration changes no faster than max_jerk and is limited to max_accel
+       - the acceleration is chosen so that, ramped down at max_jerk, it reaches zero exactly as the
+         velocity reaches the target, i.e., there is no overshoot and no asymptotic approach
+       
+   From rest, a change in velocity dv takes (see Profile_RampTime):
+   
+       dv / max_accel + max_accel / max_jerk    when max_accel is reached (S-curve)
+       2 * sqrt(dv / max_jerk)                  otherwise
+       dv / max_accel                           when max_jerk is 0 (trapezoid)
+       
+   A new target is taken from the current state, so a target change in the middle of a ramp does not
+   step the acceleration.
+   
+   Profile_Benchmark measures the cycles per update (see 'config bench').
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <math.h>
+#include "profile.h"
+#include "serial.h"
+#include "time.h"
+#include "utils.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define PROFILE_BENCH_NUM_TICKS (100)
+#define PROFILE_BENCH_DT (0.02f)
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+/* Keeps the benchmark calculations from being optimized away */
+static volatile FLOAT bench_sink;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_Init
+ * Description: Initializes a profile at rest with the specified limits.
+ * Parameters: profile - the profile
+ *             max_accel - the maximum acceleration
+ *             max_jerk - the maximum jerk, 0 for a trapezoid ramp
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Profile_Init(PROFILE_TYPE* const profile, FLOAT max_accel, FLOAT max_jerk)
+{
+    Profile_SetLimits(profile, max_accel, max_jerk);
+    Profile_Reset(profile, 0.0f);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_SetLimits
+ * Description: Sets the acceleration and jerk limits of a profile.  The limits take effect on the next
+ *              update.
+ * Parameters: profile - the profile
+ *             max_accel - the maximum acceleration
+ *             max_jerk - the maximum jerk, 0 for a trapezoid ramp
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Profile_SetLimits(PROFILE_TYPE* const profile, FLOAT max_accel, FLOAT max_jerk)
+{
+    profile->max_accel = abs(max_accel);
+    profile->max_jerk = abs(max_jerk);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_Reset
+ * Description: Sets the profile velocity with zero acceleration, e.g., when the velocity is commanded
+ *              without the profile.
+ * Parameters: profile - the profile
+ *             velocity - the velocity
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Profile_Reset(PROFILE_TYPE* const profile, FLOAT velocity)
+{
+    profile->velocity = velocity;
+    profile->accel = 0.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: RampGain
+ * Description: Calculates the velocity gained over one tick at the specified acceleration followed by 
+ *              ramping the acceleration down to zero at max_jerk.  The acceleration is linear over each
+ *              tick, so a ramp down from k * max_jerk * dt gains exactly accel^2 / (2 * max_jerk).
+ * Parameters: profile - the profile
+ *             last_accel - the acceleration at the start of the tick
+ *             accel - the acceleration at the end of the tick
+ *             dt - the tick time (second)
+ * Return: FLOAT - the velocity gained
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static FLOAT RampGain(PROFILE_TYPE* const profile, FLOAT last_accel, FLOAT accel, FLOAT dt)
+{
+    FLOAT gain;
+    
+    gain = 0.5f * (last_accel + accel) * dt;
+    if (accel > 0.0f)
+    {
+        gain += accel * accel / (2.0f * profile->max_jerk);
+    }
+    
+    return gain;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_Update
+ * Description: Advances the profile by one tick towards the target velocity.
+ * Parameters: profile - the profile
+ *             target - the target velocity
+ *             dt - the tick time (second)
+ * Return: FLOAT - the profiled velocity
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Profile_Update(PROFILE_TYPE* const profile, FLOAT target, FLOAT dt)
+{
+    FLOAT error;
+    FLOAT direction;
+    FLOAT sign;
+    FLOAT last_accel;
+    FLOAT accel;
+    FLOAT step;
+    FLOAT gain;
+    
+    if (dt <= 0.0f)
+    {
+        return profile->velocity;
+    }
+    
+    error = target - profile->velocity;
+    direction = error;
+    
+    if (profile->max_jerk == 0.0f)
+    {
+        accel = error / dt;
+        accel = constrain(accel, -profile->max_accel, profile->max_accel);
+        gain = accel * dt;
+        
+        /* The acceleration steps */
+        step = profile->max_accel;
+    }
+    else
+    {
+        /* Work in the direction of the target so that a positive acceleration moves towards it */
+        sign = error < 0.0f ? -1.0f : 1.0f;
+        error = sign * error;
+        last_accel = sign * profile->accel;
+        step = profile->max_jerk * dt;
+        
+        /* The last ramp is shorter than one tick of jerk */
+        if (error <= step * dt && abs(last_accel) <= step)
+        {
+            Profile_Reset(profile, target);
+            return target;
+        }
+        
+        /* Increase the acceleration, hold it or decrease it: the first which can still ramp down to
+           zero acceleration without passing the target 
+         */
+        accel = min(last_accel + step, profile->max_accel);
+        if (RampGain(profile, last_accel, accel, dt) > error)
+        {
+            accel = min(last_accel, profile->max_accel);
+            if (RampGain(profile, last_accel, accel, dt) > error)
+            {
+                accel = max(last_accel - step, -profile->max_accel);
+            }
+        }
+        
+        gain = sign * 0.5f * (last_accel + accel) * dt;
+        accel = sign * accel;
+    }
+    
+    profile->velocity += gain;
+    profile->accel = accel;
+    
+    /* The last tick of a ramp lands on the target.  Note: when the target changes such that the ramp cannot 
+       stop in time, the velocity passes the target and ramps back rather than stepping the acceleration.
+     */
+    if (((direction >= 0.0f && profile->velocity >= target) || (direction <= 0.0f && profile->velocity <= target)) &&
+        abs(accel) <= step)
+    {
+        Profile_Reset(profile, target);
+    }
+    
+    return profile->velocity;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_RampTime
+ * Description: Calculates the time of a ramp from rest.
+ * Parameters: max_accel - the maximum acceleration
+ *             max_jerk - the maximum jerk, 0 for a trapezoid ramp
+ *             delta_velocity - the change in velocity
+ * Return: FLOAT - the ramp time (second)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+FLOAT Profile_RampTime(FLOAT max_accel, FLOAT max_jerk, FLOAT delta_velocity)
+{
+    delta_velocity = abs(delta_velocity);
+    
+    if (max_accel == 0.0f)
+    {
+        return delta_velocity == 0.0f ? 0.0f : INFINITY;
+    }
+    
+    if (max_jerk == 0.0f)
+    {
+        return delta_velocity / max_accel;
+    }
+    
+    if (delta_velocity >= max_accel * max_accel / max_jerk)
+    {
+        return delta_velocity / max_accel + max_accel / max_jerk;
+    }
+    
+    return 2.0f * sqrtf(delta_velocity / max_jerk);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Profile_Benchmark
+ * Description: Measures the average cycles of a profile update over a full S-curve ramp and its 
+ *              settling, and prints the ramp time against the exact ramp time.
+ * Parameters: as_json - if TRUE, print as JSON; otherwise, print as plain text.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Profile_Benchmark(BOOL as_json)
+{
+    PROFILE_TYPE profile;
+    UINT32 start;
+    UINT32 elapsed;
+    UINT8 ii;
+    UINT8 ramp_ticks;
+    
+    /* Note: a 1 m/s ramp at 1 m/s^2 and 4 m/s^3 takes 1.25 sec, i.e., most of the ticks are ramping */
+    Profile_Init(&profile, 1.0f, 4.0f);
+    ramp_ticks = 0;
+    
+    start = cycles();
+    for (ii = 0; ii < PROFILE_BENCH_NUM_TICKS; ++ii)
+    {
+        bench_sink = Profile_Update(&profile, 1.0f, PROFILE_BENCH_DT);
+        ramp_ticks += bench_sink < 1.0f ? 1 : 0;
+    }
+    elapsed = cycles() - start;
+    
+    if (as_json)
+    {
+        Ser_PutStringFormat("{\"profile\":{\"cycles\":%ld,\"ramp_time\":%.3f,\"exact_time\":%.3f}}\r\n",
+                            elapsed / PROFILE_BENCH_NUM_TICKS,
+                            (ramp_ticks + 1) * PROFILE_BENCH_DT,
+                            Profile_RampTime(1.0f, 4.0f, 1.0f));
+    }
+    else
+    {
+        Ser_PutStringFormat("%-14s: %5ld cycles, ramp %.3f sec (exact %.3f sec)\r\n", 
+                            "profile",
+                            elapsed / PROFILE_BENCH_NUM_TICKS,
+                            (ramp_ticks + 1) * PROFILE_BENCH_DT,
+                            Profile_RampTime(1.0f, 4.0f, 1.0f));
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,61 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a jerk-limited velocity profile generator.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef PROFILE_H
+#define PROFILE_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef struct _profile_tag
+{
+    FLOAT velocity;     /* the profiled velocity */
+    FLOAT accel;        /* the profiled acceleration */
+    FLOAT max_accel;    /* velocity units/sec */
+    FLOAT max_jerk;     /* velocity units/sec^2, 0 for a trapezoid ramp */
+} PROFILE_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Profile_Init(PROFILE_TYPE* const profile, FLOAT max_accel, FLOAT max_jerk);
+void Profile_SetLimits(PROFILE_TYPE* const profile, FLOAT max_accel, FLOAT max_jerk);
+void Profile_Reset(PROFILE_TYPE* const profile, FLOAT velocity);
+FLOAT Profile_Update(PROFILE_TYPE* const profile, FLOAT target, FLOAT dt);
+FLOAT Profile_RampTime(FLOAT max_accel, FLOAT max_jerk, FLOAT delta_velocity);
+
+void Profile_Benchmark(BOOL as_json);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,593 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides an on-board pure pursuit path follower.  A path of up to
+   PURSUIT_MAX_POINTS points is uploaded in a burst (I2C path window, see i2cif.c, or the console 
+   'motion path' command) and then followed from the main loop at the odometry sample rate, so the
+   tracking does not depend on the bus latency or the load of the host.
+   
+   Each update:
+   
+       - the point on the path nearest the robot is found, searching forward from the last nearest 
+         segment (limited to the lookahead distance so a path which crosses itself is not short cut)
+       - the goal point is the point one lookahead distance further along the path
+       - the goal point is transformed into the robot frame (x forward, y left) and the arc through it
+         is commanded: curvature = 2 y / (x^2 + y^2), angular = linear * curvature
+       - the linear velocity is the cruise speed reduced on the approach to the end of the path
+       
+   If the goal point is behind the robot, e.g., the path starts behind it, the robot turns in place
+   towards it.
+   
+   The path is done when the robot is within the goal tolerance of the last point or has passed the
+   end of the last segment.  The path fails when the cross-track error exceeds PURSUIT_MAX_CROSS_TRACK,
+   e.g., the robot was blocked.  Either way the command velocity is returned to the control interface.
+   
+   The progress (fraction of the path length) and cross-track error are published in the read-only 
+   block of the control interface.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <math.h>
+#include "pursuit.h"
+#include "traj.h"
+#include "control.h"
+#include "odom.h"
+#include "angle.h"
+#include "ccif.h"
+#include "time.h"
+#include "utils.h"
+#include "consts.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define PURSUIT_SAMPLE_TIME_MS  SAMPLE_TIME_MS(ODOM_SAMPLE_RATE)
+
+#define PURSUIT_MIN_LOOKAHEAD   (0.1f)  /* meter */
+#define PURSUIT_GOAL_TOLERANCE  (0.03f) /* meter */
+#define PURSUIT_MAX_CROSS_TRACK (0.5f)  /* meter */
+#define PURSUIT_MIN_SPEED       (0.02f) /* meter/sec */
+#define PURSUIT_TURN_SPEED      (0.5f)  /* radian/sec */
+
+/* The approach to the end of the path is planned at a fraction of the maximum linear acceleration
+   (see traj.c)
+ */
+#define PURSUIT_BRAKE_FRACTION  (0.5f)
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static FLOAT x_points[PURSUIT_MAX_POINTS];
+static FLOAT y_points[PURSUIT_MAX_POINTS];
+/* Path length from the first point to each point */
+static FLOAT lengths[PURSUIT_MAX_POINTS];
+static UINT8 num_points;
+
+static PURSUIT_STATE_TYPE state;
+static UINT32 sample_time_ms;
+static UINT32 last_update_time;
+
+static FLOAT cruise_speed;
+static FLOAT lookahead;
+static FLOAT brake_accel;
+
+static UINT8 segment;
+static FLOAT along;
+static FLOAT cross_track;
+
+static FLOAT cmd_linear;
+static FLOAT cmd_angular;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: ProjectOnSegment
+ * Description: Projects a position onto a path segment.
+ * Parameters: index - the segment, i.e., from point index to point index + 1
+ *             x - the x position (meter)
+ *             y - the y position (meter)
+ *             (out) s - the path length at the projection (meter)
+ *             (out) cross - the signed distance from the segment, positive to the left (meter)
+ * Return: FLOAT - the squared distance from the projection (meter^2)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static FLOAT ProjectOnSegment(UINT8 index, FLOAT x, FLOAT y, FLOAT* const s, FLOAT* const cross)
+{
+    FLOAT seg_x;
+    FLOAT seg_y;
+    FLOAT seg_length;
+    FLOAT dx;
+    FLOAT dy;
+    FLOAT t;
+    FLOAT px;
+    FLOAT py;
+    
+    seg_x = x_points[index + 1] - x_points[index];
+    seg_y = y_points[index + 1] - y_points[index];
+    seg_length = lengths[index + 1] - lengths[index];
+    dx = x - x_points[index];
+    dy = y - y_points[index];
+    
+    if (seg_length == 0.0f)
+    {
+        *s = lengths[index];
+        *cross = 0.0f;
+        return dx * dx + dy * dy;
+    }
+    
+    t = (dx * seg_x + dy * seg_y) / (seg_length * seg_length);
+    t = constrain(t, 0.0f, 1.0f);
+    
+    *s = lengths[index] + t * seg_length;
+    *cross = (seg_x * dy - seg_y * dx) / seg_length;
+    
+    px = dx - t * seg_x;
+    py = dy - t * seg_y;
+    return px * px + py * py;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: FindNearest
+ * Description: Updates the nearest segment, the path length and the cross-track error from the robot
+ *              position.  Only the segments starting within one lookahead distance of the last nearest
+ *              point are searched, so the nearest segment only moves forward.
+ * Parameters: x - the x position (meter)
+ *             y - the y position (meter)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void FindNearest(FLOAT x, FLOAT y)
+{
+    UINT8 ii;
+    FLOAT distance;
+    FLOAT best_distance;
+    FLOAT s;
+    FLOAT cross;
+    FLOAT limit;
+    
+    limit = along + lookahead;
+    best_distance = ProjectOnSegment(segment, x, y, &along, &cross_track);
+    
+    for (ii = segment + 1; ii < num_points - 1 && lengths[ii] <= limit; ++ii)
+    {
+        distance = ProjectOnSegment(ii, x, y, &s, &cross);
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            segment = ii;
+            along = s;
+            cross_track = cross;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: GetGoalPoint
+ * Description: Returns the point on the path at the specified path length, clamped to the last point.
+ * Parameters: s - the path length (meter)
+ *             (out) x - the x position (meter)
+ *             (out) y - the y position (meter)
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void GetGoalPoint(FLOAT s, FLOAT* const x, FLOAT* const y)
+{
+    UINT8 ii;
+    FLOAT t;
+    FLOAT seg_length;
+    
+    for (ii = segment; ii < num_points - 1; ++ii)
+    {
+        if (s <= lengths[ii + 1])
+        {
+            seg_length = lengths[ii + 1] - lengths[ii];
+            t = seg_length > 0.0f ? (s - lengths[ii]) / seg_length : 1.0f;
+            *x = x_points[ii] + t * (x_points[ii + 1] - x_points[ii]);
+            *y = y_points[ii] + t * (y_points[ii + 1] - y_points[ii]);
+            return;
+        }
+    }
+    
+    *x = x_points[num_points - 1];
+    *y = y_points[num_points - 1];
+}
+
+static FLOAT CalcProgress()
+{
+    FLOAT length = num_points > 1 ? lengths[num_points - 1] : 0.0f;
+    
+    return length > 0.0f ? along / length : 0.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Finish
+ * Description: Ends the path, stops the robot and returns the command velocity to the control 
+ *              interface.
+ * Parameters: final_state - the state of the ended path
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Finish(PURSUIT_STATE_TYPE final_state)
+{
+    state = final_state;
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+    Control_RestoreCommandVelocityFunc();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Track
+ * Description: Calculates the pure pursuit command velocity from the robot pose.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Track()
+{
+    FLOAT x;
+    FLOAT y;
+    FLOAT sine;
+    FLOAT cosine;
+    FLOAT goal_x;
+    FLOAT goal_y;
+    FLOAT dx;
+    FLOAT dy;
+    FLOAT local_x;
+    FLOAT local_y;
+    FLOAT end_distance;
+    FLOAT speed;
+    
+    Odom_GetXYPosition(&x, &y);
+    Angle_SinCos(Odom_GetHeading(), &sine, &cosine);
+    
+    FindNearest(x, y);
+    
+    dx = x_points[num_points - 1] - x;
+    dy = y_points[num_points - 1] - y;
+    end_distance = sqrtf(dx * dx + dy * dy);
+    
+    if (end_distance < PURSUIT_GOAL_TOLERANCE || along >= lengths[num_points - 1])
+    {
+        Finish(PURSUIT_STATE_DONE);
+        return;
+    }
+    
+    if (abs(cross_track) > PURSUIT_MAX_CROSS_TRACK)
+    {
+        Finish(PURSUIT_STATE_FAILED);
+        return;
+    }
+    
+    GetGoalPoint(along + lookahead, &goal_x, &goal_y);
+    dx = goal_x - x;
+    dy = goal_y - y;
+    local_x = cosine * dx + sine * dy;
+    local_y = cosine * dy - sine * dx;
+    
+    if (local_x <= 0.0f)
+    {
+        cmd_linear = 0.0f;
+        cmd_angular = local_y < 0.0f ? -PURSUIT_TURN_SPEED : PURSUIT_TURN_SPEED;
+        return;
+    }
+    
+    speed = sqrtf(2.0f * brake_accel * end_distance);
+    speed = min(speed, cruise_speed);
+    speed = max(speed, PURSUIT_MIN_SPEED);
+    
+    cmd_linear = speed;
+    cmd_angular = speed * 2.0f * local_y / (local_x * local_x + local_y * local_y);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PollUpload
+ * Description: Applies a path window or a path command received over the control interface.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PollUpload()
+{
+    FLOAT points[2 * PATH_WINDOW_NUM_POINTS];
+    FLOAT speed;
+    FLOAT distance;
+    UINT8 control;
+    UINT8 index;
+    UINT8 count;
+    UINT8 ii;
+    
+    control = ReadPathControl(&index, &count, &speed, &distance, points);
+    
+    if (control & PATH_CONTROL_STOP_BIT)
+    {
+        Pursuit_Stop();
+    }
+    
+    if (control & PATH_CONTROL_CLEAR_BIT)
+    {
+        Pursuit_Clear();
+    }
+    
+    if (control & PATH_CONTROL_LOAD_BIT)
+    {
+        count = min(count, PATH_WINDOW_NUM_POINTS);
+        for (ii = 0; ii < count; ++ii)
+        {
+            Pursuit_SetPoint(index + ii, points[2 * ii], points[2 * ii + 1]);
+        }
+    }
+    
+    if (control & PATH_CONTROL_START_BIT)
+    {
+        Pursuit_Execute(speed, distance);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CommandVelocity
+ * Description: The command velocity function installed in the control module while a path runs.
+ * Parameters: linear - the linear velocity (meter/sec)
+ *             angular - the angular velocity (radian/sec)
+ *             timeout - the command timeout, always 0
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void CommandVelocity(FLOAT *linear, FLOAT *angular, UINT32 *timeout)
+{
+    *linear = cmd_linear;
+    *angular = cmd_angular;
+    *timeout = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Init
+ * Description: Initializes the path follower.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Init()
+{
+    num_points = 0;
+    state = PURSUIT_STATE_IDLE;
+    sample_time_ms = PURSUIT_SAMPLE_TIME_MS;
+    segment = 0;
+    along = 0.0f;
+    cross_track = 0.0f;
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Start
+ * Description: Performs actions to activate objects that operate independently of this module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Start()
+{
+    last_update_time = millis();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Update
+ * Description: Called from the main loop.  Internally, it enforces the odometry sampling rate.  Each 
+ *              update applies any path upload, tracks a running path and publishes the path status.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Update()
+{
+    UINT32 delta_time;
+    
+    delta_time = millis() - last_update_time;
+    if (delta_time < sample_time_ms)
+    {
+        return;
+    }
+    last_update_time = millis();
+    
+    PollUpload();
+    
+    if (state == PURSUIT_STATE_RUNNING)
+    {
+        Track();
+    }
+    
+    WritePathStatus(state, num_points, segment, CalcProgress(), cross_track);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_SetSampleTime
+ * Description: Sets the path follower sampling period (see Rate_Set).
+ * Parameters: period - the sampling period in milliseconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_SetSampleTime(UINT32 period)
+{
+    sample_time_ms = period;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Clear
+ * Description: Empties the path.  A running path is not affected (see Pursuit_Stop).
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Clear()
+{
+    if (state != PURSUIT_STATE_RUNNING)
+    {
+        num_points = 0;
+        state = PURSUIT_STATE_IDLE;
+        segment = 0;
+        along = 0.0f;
+        cross_track = 0.0f;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_SetPoint
+ * Description: Sets a path point.  Points are set in any order within the loaded points or appended,
+ *              e.g., the I2C path window loads the points a few at a time.  The path cannot be changed
+ *              while it is running.
+ * Parameters: index - the point index
+ *             x - the x position (meter)
+ *             y - the y position (meter)
+ * Return: BOOL - TRUE if the point was set; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Pursuit_SetPoint(UINT8 index, FLOAT x, FLOAT y)
+{
+    if (state == PURSUIT_STATE_RUNNING || index >= PURSUIT_MAX_POINTS || index > num_points || isnan(x) || isnan(y))
+    {
+        return FALSE;
+    }
+    
+    x_points[index] = x;
+    y_points[index] = y;
+    if (index == num_points)
+    {
+        num_points++;
+    }
+    
+    return TRUE;
+}
+
+BOOL Pursuit_AddPoint(FLOAT x, FLOAT y)
+{
+    return Pursuit_SetPoint(num_points, x, y);
+}
+
+BOOL Pursuit_GetPoint(UINT8 index, FLOAT* const x, FLOAT* const y)
+{
+    if (index >= num_points)
+    {
+        return FALSE;
+    }
+    
+    *x = x_points[index];
+    *y = y_points[index];
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Execute
+ * Description: Starts following the path from the current odometry pose.  The path takes over the
+ *              control command velocity until it ends or Pursuit_Stop is called.
+ * Parameters: speed - the cruise speed (meter/sec), 0 for PURSUIT_DEFAULT_SPEED
+ *             distance - the lookahead distance (meter), 0 for PURSUIT_DEFAULT_LOOKAHEAD
+ * Return: BOOL - TRUE if the path was started; otherwise, FALSE, i.e., fewer than two points, already
+ *         running, a trajectory (see traj.c) owns the command velocity or the robot is too far from the
+ *         path.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Pursuit_Execute(FLOAT speed, FLOAT distance)
+{
+    UINT8 ii;
+    FLOAT dx;
+    FLOAT dy;
+    FLOAT x;
+    FLOAT y;
+    FLOAT linear_accel;
+    FLOAT linear_jerk;
+    FLOAT angular_accel;
+    FLOAT angular_jerk;
+    
+    if (num_points < 2 || state == PURSUIT_STATE_RUNNING || Traj_OwnsCommand())
+    {
+        return FALSE;
+    }
+    
+    lengths[0] = 0.0f;
+    for (ii = 1; ii < num_points; ++ii)
+    {
+        dx = x_points[ii] - x_points[ii - 1];
+        dy = y_points[ii] - y_points[ii - 1];
+        lengths[ii] = lengths[ii - 1] + sqrtf(dx * dx + dy * dy);
+    }
+    
+    cruise_speed = speed > 0.0f ? speed : PURSUIT_DEFAULT_SPEED;
+    lookahead = distance > 0.0f ? max(distance, PURSUIT_MIN_LOOKAHEAD) : PURSUIT_DEFAULT_LOOKAHEAD;
+    
+    Control_GetProfileLimits(&linear_accel, &linear_jerk, &angular_accel, &angular_jerk);
+    brake_accel = PURSUIT_BRAKE_FRACTION * linear_accel;
+    
+    segment = 0;
+    along = 0.0f;
+    Odom_GetXYPosition(&x, &y);
+    FindNearest(x, y);
+    if (abs(cross_track) > PURSUIT_MAX_CROSS_TRACK)
+    {
+        return FALSE;
+    }
+    
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+    Control_SetCommandVelocityFunc(CommandVelocity);
+    state = PURSUIT_STATE_RUNNING;
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Pursuit_Stop
+ * Description: Stops a running path.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Stop()
+{
+    if (state == PURSUIT_STATE_RUNNING)
+    {
+        Finish(PURSUIT_STATE_IDLE);
+    }
+}
+
+BOOL Pursuit_IsRunning()
+{
+    return state == PURSUIT_STATE_RUNNING;
+}
+
+void Pursuit_GetStatus(PURSUIT_STATUS_TYPE* const status)
+{
+    status->state = state;
+    status->num_points = num_points;
+    status->segment = segment;
+    status->progress = CalcProgress();
+    status->cross_track = cross_track;
+}
+
+/* [] END OF FILE */
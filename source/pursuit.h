@@ -0,0 +1,79 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides an on-board pure pursuit path follower.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef PURSUIT_H
+#define PURSUIT_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define PURSUIT_MAX_POINTS (32)
+
+#define PURSUIT_DEFAULT_SPEED     (0.2)   /* meter/sec */
+#define PURSUIT_DEFAULT_LOOKAHEAD (0.3)   /* meter */
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {PURSUIT_STATE_IDLE, PURSUIT_STATE_RUNNING, PURSUIT_STATE_DONE, PURSUIT_STATE_FAILED} PURSUIT_STATE_TYPE;
+
+typedef struct _pursuit_status_tag
+{
+    PURSUIT_STATE_TYPE state;
+    UINT8 num_points;
+    UINT8 segment;      /* the path segment nearest the robot */
+    FLOAT progress;     /* fraction of the path length travelled, 0.0 - 1.0 */
+    FLOAT cross_track;  /* signed distance from the path, positive to the left of the path (meter) */
+} PURSUIT_STATUS_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Pursuit_Init();
+void Pursuit_Start();
+void Pursuit_Update();
+void Pursuit_SetSampleTime(UINT32 period);
+
+void Pursuit_Clear();
+BOOL Pursuit_SetPoint(UINT8 index, FLOAT x, FLOAT y);
+BOOL Pursuit_AddPoint(FLOAT x, FLOAT y);
+BOOL Pursuit_GetPoint(UINT8 index, FLOAT* const x, FLOAT* const y);
+BOOL Pursuit_Execute(FLOAT speed, FLOAT lookahead);
+void Pursuit_Stop();
+BOOL Pursuit_IsRunning();
+void Pursuit_GetStatus(PURSUIT_STATUS_TYPE* const status);
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+'''Usage:
+    ramreport.py <map> [--top=<count>] [--ram=<bytes>]
+
+Reports the SRAM used by the firmware from the linker map file, e.g.,
+freesoc.cydsn/CortexM3/ARM_GCC_541/Debug/freesoc.map.  The report can be run
+as a Post Build command of the project (Build Settings, User Commands).
+
+The report lists:
+    * the size of each RAM output section (.data, .bss, .noinit, .heap, .stack),
+    * the RAM used by each object file, largest first,
+    * the largest variables (when the objects are compiled with data sections,
+      i.e., each variable in its own .data.<name>/.bss.<name> input section).
+
+The buffers which are only needed while a command runs are allocated from the
+mode arena (see arena.c) and show up once, as the arena variable.
+
+Options:
+    --top=<count>       Number of objects and variables listed [default: 20]
+    --ram=<bytes>       Size of the SRAM [default: 65536]
+'''
+
+import re
+
+
+RAM_SECTIONS = ('.ramvectors', '.noinit', '.data', '.bss', '.heap', '.stack')
+
+OUTPUT_RE = re.compile(r'^(\.[\w.]+)(?:\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)(?:\s+load address.*)?)?\s*$')
+INPUT_RE = re.compile(r'^ (\.[\w.]+|COMMON)(?:\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*))?\s*$')
+WRAPPED_RE = re.compile(r'^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)(?:\s+(\S.*))?$')
+
+
+class MapFile(object):
+    '''Collects the RAM input sections of a GNU ld map file'''
+
+    def __init__(self, text):
+        self.sections = {}
+        self.objects = {}
+        self.variables = {}
+        self.parse(text)
+
+    def parse(self, text):
+        in_memory_map = False
+        output = None
+        pending = None
+
+        for line in text.splitlines():
+            if line.startswith('Linker script and memory map'):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+
+            match = OUTPUT_RE.match(line)
+            if match:
+                name = match.group(1).split('.')[1]
+                output = '.' + name if '.' + name in RAM_SECTIONS else None
+                if output and match.group(3):
+                    self.sections[output] = int(match.group(3), 16)
+                pending = None
+                continue
+
+            if output is None:
+                continue
+
+            match = INPUT_RE.match(line)
+            if match:
+                if match.group(2):
+                    self.add(output, match.group(1), int(match.group(3), 16), match.group(4))
+                    pending = None
+                else:
+                    # Note: a long input section name wraps the address, size and object to the next line
+                    pending = match.group(1)
+                continue
+
+            match = WRAPPED_RE.match(line)
+            if match and pending and match.group(3):
+                self.add(output, pending, int(match.group(2), 16), match.group(3))
+            elif match and not pending and output not in self.sections:
+                # Note: a long output section name also wraps
+                self.sections[output] = int(match.group(2), 16)
+            pending = None
+
+    def add(self, output, input_section, size, obj):
+        if size == 0:
+            return
+
+        obj = re.split(r'[\\/]', obj.strip())[-1]
+        self.objects[obj] = self.objects.get(obj, 0) + size
+
+        prefix = output + '.'
+        if input_section.startswith(prefix):
+            variable = '%s (%s)' % (input_section[len(prefix):], obj)
+            self.variables[variable] = self.variables.get(variable, 0) + size
+
+    def report(self, top, ram):
+        total = sum(self.sections.values())
+
+        print('RAM: %d of %d bytes (%.1f%%)' % (total, ram, 100.0 * total / ram))
+        for name in RAM_SECTIONS:
+            if name in self.sections:
+                print('    %-12s %6d' % (name, self.sections[name]))
+
+        print('\nObjects:')
+        for obj, size in sorted(self.objects.items(), key=lambda item: -item[1])[:top]:
+            print('    %-32s %6d' % (obj, size))
+
+        if self.variables:
+            print('\nVariables:')
+            for variable, size in sorted(self.variables.items(), key=lambda item: -item[1])[:top]:
+                print('    %-48s %6d' % (variable, size))
+
+
+if __name__ == "__main__":
+    import docopt
+
+    args = docopt.docopt(__doc__)
+    map_file = MapFile(open(args['<map>']).read())
+    map_file.report(int(args['--top']), int(args['--ram']))
@@ -0,0 +1,231 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides the runtime sample rates of the encoder, PID, odometry and outer loop updates.
+   
+   The rates default to the compile-time rates (see consts.h) and may be changed from the console and
+   stored in EEPROM.  A rate change is applied to each module: the encoder filters are rescaled to span
+   the same time, the PID gains are re-discretized for the new sample time, and odometry is published at
+   its own (typically slower) rate.  Trajectories and paths are followed at the odometry rate (see traj.c and pursuit.c).
+   
+   The PID reads the encoder speed, so the PID rate may not be faster than the encoder rate.  Likewise, the
+   outer (linear/angular velocity) loop corrects the inner (wheel) loop, so it may not be faster than the
+   PID rate.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "rate.h"
+#include "cal.h"
+#include "diag.h"
+#include "encoder.h"
+#include "odom.h"
+#include "pid.h"
+#include "serial.h"
+#include "traj.h"
+#include "pursuit.h"
+#include "time.h"
+#include "utils.h"
+#include "consts.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static UINT16 rates[RATE_LAST];
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Init
+ * Description: Initializes the sample rates to the default rates.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Rate_Init()
+{
+    rates[RATE_ENC] = ENC_SAMPLE_RATE;
+    rates[RATE_PID] = PID_SAMPLE_RATE;
+    rates[RATE_ODOM] = ODOM_SAMPLE_RATE;
+    rates[RATE_OUTER] = OUTER_SAMPLE_RATE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Start
+ * Description: Applies the sample rates stored in EEPROM, if valid.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Rate_Start()
+{
+    CAL_RATE_TYPE *p_rates = Cal_GetSampleRates();
+    UINT16 outer_rate;
+    
+    // Note: the sample rates are stored in EEPROM.  The EEPROM cannot be accessed until the EEPROM
+    // component is started which is handled in the Nvstore module.  
+    // Rate_Start is called after Nvstore_Start.
+    
+    /* Rates saved before the outer loop existed have a zero outer rate, so use the default */
+    outer_rate = p_rates->outer_hz ? p_rates->outer_hz : OUTER_SAMPLE_RATE;
+    
+    if (Rate_IsValid(p_rates->enc_hz, p_rates->pid_hz, p_rates->odom_hz, outer_rate))
+    {
+        Rate_Set(p_rates->enc_hz, p_rates->pid_hz, p_rates->odom_hz, outer_rate);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_IsValid
+ * Description: Checks that each rate is within the supported range, that the PID does not sample
+ *              faster than the encoder and that the outer loop does not sample faster than the PID.
+ * Parameters: enc_rate - the encoder sample rate (Hz)
+ *             pid_rate - the PID sample rate (Hz)
+ *             odom_rate - the odometry sample rate (Hz)
+ *             outer_rate - the outer loop sample rate (Hz)
+ * Return: BOOL - TRUE if the rates are valid; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Rate_IsValid(UINT16 enc_rate, UINT16 pid_rate, UINT16 odom_rate, UINT16 outer_rate)
+{
+    return in_range(enc_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE) && 
+           in_range(pid_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE) && 
+           in_range(odom_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE) && 
+           in_range(outer_rate, MIN_SAMPLE_RATE, MAX_SAMPLE_RATE) && 
+           pid_rate <= enc_rate && 
+           outer_rate <= pid_rate;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Set
+ * Description: Sets the sample rates and applies them to the encoder, PID and odometry modules.
+ * Parameters: enc_rate - the encoder sample rate (Hz)
+ *             pid_rate - the PID sample rate (Hz)
+ *             odom_rate - the odometry sample rate (Hz)
+ *             outer_rate - the outer loop sample rate (Hz)
+ * Return: BOOL - TRUE if the rates were set; FALSE if the rates are invalid.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Rate_Set(UINT16 enc_rate, UINT16 pid_rate, UINT16 odom_rate, UINT16 outer_rate)
+{
+    if (!Rate_IsValid(enc_rate, pid_rate, odom_rate, outer_rate))
+    {
+        return FALSE;
+    }
+    
+    rates[RATE_ENC] = enc_rate;
+    rates[RATE_PID] = pid_rate;
+    rates[RATE_ODOM] = odom_rate;
+    rates[RATE_OUTER] = outer_rate;
+    
+    Encoder_SetSampleTime(Rate_GetPeriod(RATE_ENC));
+    Pid_SetSampleTime(PID_LOOP_INNER, Rate_GetPeriod(RATE_PID));
+    Pid_SetSampleTime(PID_LOOP_OUTER, Rate_GetPeriod(RATE_OUTER));
+    Odom_SetSampleTime(Rate_GetPeriod(RATE_ODOM));
+    Traj_SetSampleTime(Rate_GetPeriod(RATE_ODOM));
+    Pursuit_SetSampleTime(Rate_GetPeriod(RATE_ODOM));
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Get
+ * Description: Returns the sample rate.
+ * Parameters: rate - the rate
+ * Return: UINT16 - the sample rate (Hz)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT16 Rate_Get(RATE_ENUM_TYPE rate)
+{
+    return rates[rate];
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_GetPeriod
+ * Description: Returns the sampling period.  Note, the period is in whole milliseconds so the actual
+ *              rate may differ slightly from the requested rate, e.g., 300 Hz is sampled at 333 Hz.
+ * Parameters: rate - the rate
+ * Return: UINT32 - the sampling period (ms)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 Rate_GetPeriod(RATE_ENUM_TYPE rate)
+{
+    return RATE_TO_PERIOD_MS(rates[rate]);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Save
+ * Description: Writes the sample rates to EEPROM.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Rate_Save()
+{
+    CAL_RATE_TYPE cal_rates;
+    
+    memset(&cal_rates, 0, sizeof cal_rates);
+    cal_rates.enc_hz = rates[RATE_ENC];
+    cal_rates.pid_hz = rates[RATE_PID];
+    cal_rates.odom_hz = rates[RATE_ODOM];
+    cal_rates.outer_hz = rates[RATE_OUTER];
+    
+    Cal_SetSampleRates(&cal_rates);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Rate_Print
+ * Description: Prints the sample rates and the main loop rate.  The main loop rate is a measure of
+ *              the CPU headroom left by the sample rates.
+ * Parameters: as_json - if TRUE, print as JSON; otherwise, print as plain text.
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Rate_Print(BOOL as_json)
+{
+    if (as_json)
+    {
+        Ser_PutStringFormat("{\"enc\":%d,\"pid\":%d,\"odom\":%d,\"outer\":%d,\"loop\":%ld}\r\n",
+                            rates[RATE_ENC],
+                            rates[RATE_PID],
+                            rates[RATE_ODOM],
+                            rates[RATE_OUTER],
+                            Diag_GetLoopRate());
+    }
+    else
+    {
+        Ser_PutStringFormat("Encoder   : %d Hz (%ld ms)\r\n", rates[RATE_ENC], Rate_GetPeriod(RATE_ENC));
+        Ser_PutStringFormat("PID       : %d Hz (%ld ms)\r\n", rates[RATE_PID], Rate_GetPeriod(RATE_PID));
+        Ser_PutStringFormat("Odometry  : %d Hz (%ld ms)\r\n", rates[RATE_ODOM], Rate_GetPeriod(RATE_ODOM));
+        Ser_PutStringFormat("Outer PID : %d Hz (%ld ms)\r\n", rates[RATE_OUTER], Rate_GetPeriod(RATE_OUTER));
+        Ser_PutStringFormat("Main Loop : %ld Hz\r\n", Diag_GetLoopRate());
+    }
+}
+
+/* [] END OF FILE */
@@ -244,6 +244,20 @@ void Ser_WriteByte(UINT8 value)
     USBIF_PutChar(value);
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: Ser_WriteData
+ * Description: Writes a block of data to the serial port without waiting (see Emit_Chunk).
+ * Parameters: data - the data
+ *             length - the number of bytes
+ * Return: BOOL - FALSE if the port is still sending the previous block, i.e., nothing was written;
+ *         otherwise, TRUE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Ser_WriteData(UINT8 const * const data, UINT16 length)
+{
+    return USBIF_PutData(data, length);
+}
+
 void Ser_WriteLine(CHAR* const line, BOOL newline)
 {
     Ser_PutStringFormat("%s%s", line, newline == TRUE? "\r\n" : "");
@@ -54,6 +54,7 @@ UINT8 Ser_ReadData(CHAR * const data);
 UINT8 Ser_ReadByte();
 INT8 Ser_ReadLine(CHAR* const line, BOOL echo, UINT8 max_length);
 void Ser_WriteByte(UINT8 value);
+BOOL Ser_WriteData(UINT8 const * const data, UINT16 length);
 void Ser_WriteLine(CHAR* const line, BOOL newline);
 
 UINT8 Ser_GetConnectState(void);
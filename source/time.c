@@ -34,7 +34,7 @@ SOFTWARE.
 /*---------------------------------------------------------------------------------------------------
  * Variables
  *-------------------------------------------------------------------------------------------------*/    
-static UINT32 ms_counter;
+static volatile UINT32 ms_counter;
 
 /*---------------------------------------------------------------------------------------------------
  * Prototypes
@@ -104,6 +104,11 @@ void Time_Start()
             break;
         }
     }
+    
+    /* Start the DWT cycle counter used for benchmarking (see cycles) */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 #endif    
 }
 
@@ -120,4 +125,55 @@ UINT32 millis()
     return ms_counter;
 }
 
+/*---------------------------------------------------------------------------------------------------
+ * Name: micros
+ * Description: Returns the current microsecond count value.  The microseconds within the current
+ *              millisecond are read from the system tick counter.  This is intended for measuring
+ *              short intervals, e.g., processing time.
+ *  
+ * Parameters: None
+ * Return: UINT32 - microseconds (wraps after about 71 minutes)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 micros()
+{
+#ifndef FREESOC_TEST    
+    UINT32 ms;
+    UINT32 ticks;
+    UINT32 reload;
+    
+    /* Note: The system tick counts down from the reload value, and the millisecond count is re-read in
+       case the tick interrupt occurs between the reads.
+     */
+    reload = CySysTickGetReload() + 1;
+    do
+    {
+        ms = ms_counter;
+        ticks = CySysTickGetValue();
+    } while (ms != ms_counter);
+    
+    return ms * 1000 + ((reload - 1 - ticks) * 1000) / reload;
+#else
+    return ms_counter * 1000;
+#endif    
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: cycles
+ * Description: Returns the CPU cycle count from the DWT cycle counter.  This is intended for
+ *              benchmarking code which runs in less than a microsecond.
+ *  
+ * Parameters: None
+ * Return: UINT32 - CPU cycles (wraps after about a minute at the bus clock)
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 cycles()
+{
+#ifndef FREESOC_TEST     
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
 /* [] END OF FILE */
@@ -47,6 +47,8 @@ SOFTWARE.
 void Time_Init();
 void Time_Start();
 UINT32 millis();
+UINT32 micros();
+UINT32 cycles();
 
 #endif
 
@@ -0,0 +1,181 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module traces the control loop so that it can be replayed on the host (see 
+   test/support/replay.c and tools/replay.py).
+   
+   When trace debug is enabled, a record is written at each encoder sample:
+   
+       {"trace":[time, linear, angular, timeout, left count, right count, left pwm, right pwm, x, y, heading]}
+       
+   where the time is the time of the sample, linear/angular/timeout is the velocity command as read by the
+   control module, the counts are the sampled encoder counts, and the pwm and pose follow from the sample.
+   
+   Before the first record, the settings which the replay needs to reproduce the control loop are written: 
+   the sample periods (millisecond), the left/right PID gains and the motor models.
+   
+       {"trace_periods":[enc, pid, odom, outer]}
+       {"trace_gains":[left kp, ki, kd, kf, right kp, ki, kd, kf]}
+       {"trace_models":[left fwd gain, tau, deadband, valid, left bwd ..., right fwd ..., right bwd ...]}
+       
+   At the default encoder rate (50 Hz), a record is about 100 characters, i.e., 5 KB/s.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "trace.h"
+#include "debug.h"
+#include "control.h"
+#include "encoder.h"
+#include "motor.h"
+#include "odom.h"
+#include "pidbank.h"
+#include "cal.h"
+#include "rate.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL is_tracing;
+static UINT32 last_sample_time;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PrintSettings
+ * Description: Writes the sample periods, PID gains and motor models in effect.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PrintSettings()
+{
+    FLOAT left[4];
+    FLOAT right[4];
+    CAL_MOTOR_MODEL_TYPE *models[4];
+    
+    DEBUG_PRINT_ARG("{\"trace_periods\":[%lu,%lu,%lu,%lu]}\r\n",
+                    Rate_GetPeriod(RATE_ENC), 
+                    Rate_GetPeriod(RATE_PID), 
+                    Rate_GetPeriod(RATE_ODOM), 
+                    Rate_GetPeriod(RATE_OUTER));
+
+    PidBank_GetGains(PID_TYPE_LEFT, &left[0], &left[1], &left[2], &left[3]);
+    PidBank_GetGains(PID_TYPE_RIGHT, &right[0], &right[1], &right[2], &right[3]);
+    DEBUG_PRINT_ARG("{\"trace_gains\":[%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g]}\r\n",
+                    left[0], left[1], left[2], left[3], right[0], right[1], right[2], right[3]);
+    
+    models[0] = Cal_GetMotorModel(WHEEL_LEFT, DIR_FORWARD);
+    models[1] = Cal_GetMotorModel(WHEEL_LEFT, DIR_BACKWARD);
+    models[2] = Cal_GetMotorModel(WHEEL_RIGHT, DIR_FORWARD);
+    models[3] = Cal_GetMotorModel(WHEEL_RIGHT, DIR_BACKWARD);
+    DEBUG_PRINT_ARG("{\"trace_models\":[%.6g,%.6g,%u,%u,%.6g,%.6g,%u,%u,%.6g,%.6g,%u,%u,%.6g,%.6g,%u,%u]}\r\n",
+                    models[0]->gain, models[0]->tau, models[0]->deadband, models[0]->valid == TRUE,
+                    models[1]->gain, models[1]->tau, models[1]->deadband, models[1]->valid == TRUE,
+                    models[2]->gain, models[2]->tau, models[2]->deadband, models[2]->valid == TRUE,
+                    models[3]->gain, models[3]->tau, models[3]->deadband, models[3]->valid == TRUE);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Trace_Init
+ * Description: Initializes the module variables.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Trace_Init()
+{
+    is_tracing = FALSE;
+    last_sample_time = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Trace_Start
+ * Description: Starts the module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Trace_Start()
+{
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Trace_Update
+ * Description: Writes a trace record when the encoder has been sampled since the last record.  This 
+ *              routine is called from the main loop after the odometry update.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Trace_Update()
+{
+    UINT32 sample_time;
+    INT32 left_count;
+    INT32 right_count;
+    FLOAT linear;
+    FLOAT angular;
+    UINT32 timeout;
+    PWM_TYPE left_pwm;
+    PWM_TYPE right_pwm;
+    FLOAT x;
+    FLOAT y;
+    
+    if (!Debug_IsEnabled(DEBUG_TRACE_ENABLE_BIT))
+    {
+        is_tracing = FALSE;
+        return;
+    }
+    
+    Encoder_GetSample(&sample_time, &left_count, &right_count);
+    
+    /* Note: The first record is the next sample so that the settings always precede the records */
+    if (!is_tracing)
+    {
+        PrintSettings();
+        last_sample_time = sample_time;
+        is_tracing = TRUE;
+        return;
+    }
+    
+    if (sample_time == last_sample_time)
+    {
+        return;
+    }
+    last_sample_time = sample_time;
+    
+    Control_GetInputVelocity(&linear, &angular, &timeout);
+    Motor_GetPwm(&left_pwm, &right_pwm);
+    Odom_GetXYPosition(&x, &y);
+    
+    DEBUG_PRINT_ARG("{\"trace\":[%lu,%.4f,%.4f,%lu,%ld,%ld,%u,%u,%.4f,%.4f,%.4f]}\r\n",
+                    sample_time, linear, angular, timeout, left_count, right_count, left_pwm, right_pwm, 
+                    x, y, Odom_GetHeading());
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,712 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a trajectory executor for a queue of line, arc, turn and pause
+   segments.  A trajectory is queued (Traj_Add*) and then executed (Traj_Execute) from the main loop
+   at the odometry sample rate, i.e., the command velocity is generated on-board rather than streamed
+   by the host.
+   
+   When a trajectory is executed it is planned once:
+   
+       - consecutive line/arc segments in the same direction are blended, i.e., the robot does not stop
+         at the boundary but passes it at the lower of the two cruise speeds
+       - a backward pass limits each boundary speed so the following segments can still brake to their
+         own exit speed (v_exit^2 <= v_next^2 + 2 * brake_accel * next_length)
+       - turns and pauses always start and end at rest
+       
+   During execution, the speed along the segment is the lower of the cruise speed and the braking curve
+   to the planned exit speed, ramped by a jerk-limited profile (see profile.c) with the control profile
+   limits (see Control_GetProfileLimits).  The control profile is bypassed while a trajectory runs so
+   the ramps are not applied twice.
+   
+   Goal checks use the along-track progress measured by odometry from the pose at the start of the
+   segment:
+   
+       line  - the displacement projected on the start heading
+       arc   - the angle swept about the arc center times the radius
+       turn  - the accumulated heading change
+       pause - the elapsed time
+       
+   A segment ends when its progress reaches its length.  The progress past the end of a blended segment
+   is carried into the next segment.  A segment which does not end within twice its expected time (plus
+   a margin) fails the trajectory, e.g., a stalled wheel.
+ *-------------------------------------------------------------------------------------------------*/    
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <math.h>
+#include "traj.h"
+#include "pursuit.h"
+#include "profile.h"
+#include "control.h"
+#include "odom.h"
+#include "angle.h"
+#include "time.h"
+#include "utils.h"
+#include "consts.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define TRAJ_SAMPLE_TIME_MS  SAMPLE_TIME_MS(ODOM_SAMPLE_RATE)
+
+/* The braking curve is planned at a fraction of the maximum acceleration which leaves the jerk-limited 
+   profile room to catch up with the curve as it bends towards the exit speed.
+ */
+#define TRAJ_BRAKE_FRACTION (0.5f)
+
+/* The speed is not allowed to fall below these on the final approach, otherwise the braking curve 
+   (sqrt of the remaining distance) makes for a long creep to the goal.
+ */
+#define TRAJ_MIN_LINEAR_SPEED  (0.02f)   /* meter/sec */
+#define TRAJ_MIN_ANGULAR_SPEED (0.05f)   /* radian/sec */
+
+#define TRAJ_TIMEOUT_FACTOR (2.0f)
+#define TRAJ_TIMEOUT_MARGIN (2.0f)       /* second */
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static TRAJ_SEGMENT_TYPE segments[TRAJ_MAX_SEGMENTS];
+static UINT8 num_segments;
+static UINT8 seg_index;
+static TRAJ_STATE_TYPE state;
+/* The trajectory holds the control command velocity from Traj_Execute until Traj_Stop */
+static BOOL owns_command;
+static UINT32 sample_time_ms;
+static UINT32 last_update_time;
+
+/* Profile limits captured when the trajectory is executed */
+static FLOAT linear_accel;
+static FLOAT linear_jerk;
+static FLOAT angular_accel;
+static FLOAT angular_jerk;
+
+/* The speed along the executing segment */
+static PROFILE_TYPE profile;
+static FLOAT brake_accel;
+static FLOAT min_speed;
+
+/* Pose at the start of the executing segment and the along-track progress from it */
+static FLOAT start_x;
+static FLOAT start_y;
+static FLOAT start_cos;
+static FLOAT start_sin;
+static FLOAT center_x;
+static FLOAT center_y;
+static FLOAT last_angle;
+static FLOAT swept;
+static FLOAT carry;
+static FLOAT progress;
+static UINT32 seg_start_time;
+static UINT32 seg_timeout;
+
+static FLOAT cmd_linear;
+static FLOAT cmd_angular;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+static FLOAT Sign(FLOAT value)
+{
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+static FLOAT Length(TRAJ_SEGMENT_TYPE const * const seg)
+{
+    return seg->length < 0.0f ? -seg->length : seg->length;
+}
+
+static BOOL IsTranslating(TRAJ_SEGMENT_TYPE const * const seg)
+{
+    return seg->kind == TRAJ_SEG_LINE || seg->kind == TRAJ_SEG_ARC;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: IsBlended
+ * Description: Determines if the robot passes the boundary between two segments without stopping, 
+ *              i.e., both are lines/arcs driven in the same direction.
+ * Parameters: seg - the segment
+ *             next - the following segment
+ * Return: BOOL - TRUE if the segments are blended; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL IsBlended(TRAJ_SEGMENT_TYPE const * const seg, TRAJ_SEGMENT_TYPE const * const next)
+{
+    return IsTranslating(seg) && IsTranslating(next) && Sign(seg->length) == Sign(next->length);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: AddSegment
+ * Description: Appends a segment to the trajectory queue.  The queue cannot be changed while a 
+ *              trajectory is running.
+ * Parameters: kind - the segment kind
+ *             length - the signed length (see TRAJ_SEGMENT_TYPE)
+ *             speed - the cruise speed
+ *             curvature - the arc curvature
+ * Return: BOOL - TRUE if the segment was added; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL AddSegment(TRAJ_SEG_KIND_TYPE kind, FLOAT length, FLOAT speed, FLOAT curvature)
+{
+    TRAJ_SEGMENT_TYPE *seg;
+    
+    if (state == TRAJ_STATE_RUNNING || num_segments >= TRAJ_MAX_SEGMENTS || length == 0.0f || isnan(length))
+    {
+        return FALSE;
+    }
+    
+    seg = &segments[num_segments];
+    seg->kind = kind;
+    seg->length = length;
+    seg->speed = abs(speed);
+    seg->curvature = curvature;
+    seg->exit_speed = 0.0f;
+    
+    num_segments++;
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: PlanSegments
+ * Description: Calculates the exit speed of each segment.  Blended boundaries take the lower of the 
+ *              cruise speeds which is then limited, from the last segment back, by the distance the 
+ *              following segment has to brake to its own exit speed.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void PlanSegments()
+{
+    INT8 ii;
+    TRAJ_SEGMENT_TYPE *seg;
+    TRAJ_SEGMENT_TYPE *next;
+    FLOAT brake_speed;
+    
+    for (ii = 0; ii < num_segments; ++ii)
+    {
+        segments[ii].exit_speed = 0.0f;
+    }
+    
+    for (ii = num_segments - 2; ii >= 0; --ii)
+    {
+        seg = &segments[ii];
+        next = &segments[ii + 1];
+        
+        if (IsBlended(seg, next))
+        {
+            brake_speed = sqrtf(next->exit_speed * next->exit_speed + 
+                                2.0f * TRAJ_BRAKE_FRACTION * linear_accel * Length(next));
+            seg->exit_speed = min(seg->speed, next->speed);
+            seg->exit_speed = min(seg->exit_speed, brake_speed);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: StartSegment
+ * Description: Captures the odometry pose from which the progress of the executing segment is measured 
+ *              and sets the profile for the segment.  The profile velocity is kept across a blended
+ *              boundary.
+ * Parameters: blended - TRUE if the segment continues from a blended boundary
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void StartSegment(BOOL blended)
+{
+    TRAJ_SEGMENT_TYPE *seg = &segments[seg_index];
+    FLOAT heading;
+    FLOAT accel;
+    FLOAT jerk;
+    FLOAT expected;
+    
+    Odom_GetXYPosition(&start_x, &start_y);
+    heading = Odom_GetHeading();
+    Angle_SinCos(heading, &start_sin, &start_cos);
+    
+    swept = 0.0f;
+    progress = 0.0f;
+    if (!blended)
+    {
+        carry = 0.0f;
+    }
+    
+    if (seg->kind == TRAJ_SEG_ARC)
+    {
+        /* The center is one radius to the left of the heading (to the right for a negative curvature) */
+        center_x = start_x - start_sin / seg->curvature;
+        center_y = start_y + start_cos / seg->curvature;
+        last_angle = Angle_Atan2(start_y - center_y, start_x - center_x);
+    }
+    else
+    {
+        last_angle = heading;
+    }
+    
+    if (IsTranslating(seg))
+    {
+        accel = linear_accel;
+        jerk = linear_jerk;
+        min_speed = TRAJ_MIN_LINEAR_SPEED;
+    }
+    else
+    {
+        accel = angular_accel;
+        jerk = angular_jerk;
+        min_speed = TRAJ_MIN_ANGULAR_SPEED;
+    }
+    
+    brake_accel = TRAJ_BRAKE_FRACTION * accel;
+    Profile_SetLimits(&profile, accel, jerk);
+    if (!blended)
+    {
+        Profile_Reset(&profile, 0.0f);
+    }
+    
+    if (seg->kind == TRAJ_SEG_PAUSE)
+    {
+        expected = Length(seg);
+    }
+    else
+    {
+        expected = Length(seg) / max(seg->speed, min_speed) + Profile_RampTime(accel, jerk, seg->speed);
+    }
+    seg_timeout = (UINT32) ((TRAJ_TIMEOUT_FACTOR * expected + TRAJ_TIMEOUT_MARGIN) * MILLIS_PER_SECOND);
+    seg_start_time = millis();
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CalcProgress
+ * Description: Calculates the along-track progress of the executing segment from odometry.
+ * Parameters: seg - the executing segment
+ * Return: FLOAT - the progress in the units of the segment length, positive towards the end
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static FLOAT CalcProgress(TRAJ_SEGMENT_TYPE const * const seg)
+{
+    FLOAT x;
+    FLOAT y;
+    FLOAT angle;
+    FLOAT along;
+    
+    Odom_GetXYPosition(&x, &y);
+    
+    switch (seg->kind)
+    {
+        case TRAJ_SEG_LINE:
+            along = (x - start_x) * start_cos + (y - start_y) * start_sin;
+            break;
+            
+        case TRAJ_SEG_ARC:
+            /* The swept angle is accumulated so that arcs longer than half a circle are measured */
+            angle = Angle_Atan2(y - center_y, x - center_x);
+            swept += Angle_Error(angle, last_angle);
+            last_angle = angle;
+            along = swept / seg->curvature;
+            break;
+            
+        case TRAJ_SEG_TURN:
+            angle = Odom_GetHeading();
+            swept += Angle_Error(angle, last_angle);
+            last_angle = angle;
+            along = swept;
+            break;
+            
+        case TRAJ_SEG_PAUSE:
+        default:
+            return (millis() - seg_start_time) / (FLOAT) MILLIS_PER_SECOND;
+    }
+    
+    return along * Sign(seg->length) + carry;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Finish
+ * Description: Ends the trajectory and commands the robot to stop.
+ * Parameters: final_state - the state of the ended trajectory
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void Finish(TRAJ_STATE_TYPE final_state)
+{
+    state = final_state;
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+    Profile_Reset(&profile, 0.0f);
+    Control_EnableAcceleration(TRUE);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: NextSegment
+ * Description: Advances to the next segment or ends the trajectory after the last segment.
+ * Parameters: None
+ * Return: BOOL - TRUE if a segment is executing; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static BOOL NextSegment()
+{
+    TRAJ_SEGMENT_TYPE *seg = &segments[seg_index];
+    BOOL blended;
+    
+    if (seg_index + 1 >= num_segments)
+    {
+        Finish(TRAJ_STATE_DONE);
+        return FALSE;
+    }
+    
+    blended = IsBlended(seg, &segments[seg_index + 1]);
+    carry = blended ? progress - Length(seg) : 0.0f;
+    
+    seg_index++;
+    StartSegment(blended);
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: SetCommand
+ * Description: Converts the speed along the executing segment into the linear/angular velocity command.
+ * Parameters: seg - the executing segment
+ *             speed - the speed along the segment
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void SetCommand(TRAJ_SEGMENT_TYPE const * const seg, FLOAT speed)
+{
+    FLOAT velocity = Sign(seg->length) * speed;
+    
+    switch (seg->kind)
+    {
+        case TRAJ_SEG_LINE:
+            cmd_linear = velocity;
+            cmd_angular = 0.0f;
+            break;
+            
+        case TRAJ_SEG_ARC:
+            cmd_linear = velocity;
+            cmd_angular = velocity * seg->curvature;
+            break;
+            
+        case TRAJ_SEG_TURN:
+            cmd_linear = 0.0f;
+            cmd_angular = velocity;
+            break;
+            
+        case TRAJ_SEG_PAUSE:
+        default:
+            cmd_linear = 0.0f;
+            cmd_angular = 0.0f;
+            break;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: CommandVelocity
+ * Description: The command velocity function installed in the control module while a trajectory runs.
+ * Parameters: linear - the linear velocity (meter/sec)
+ *             angular - the angular velocity (radian/sec)
+ *             timeout - the command timeout, always 0
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+static void CommandVelocity(FLOAT *linear, FLOAT *angular, UINT32 *timeout)
+{
+    *linear = cmd_linear;
+    *angular = cmd_angular;
+    *timeout = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Init
+ * Description: Initializes the trajectory module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Init()
+{
+    num_segments = 0;
+    seg_index = 0;
+    state = TRAJ_STATE_IDLE;
+    owns_command = FALSE;
+    sample_time_ms = TRAJ_SAMPLE_TIME_MS;
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+    Profile_Init(&profile, 0.0f, 0.0f);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Start
+ * Description: Performs actions to activate objects that operate independently of this module.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Start()
+{
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Update
+ * Description: Called from the main loop.  Internally, it enforces the odometry sampling rate so that
+ *              each update sees new progress.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Update()
+{
+    TRAJ_SEGMENT_TYPE *seg;
+    UINT32 delta_time;
+    FLOAT dt;
+    FLOAT target;
+    FLOAT speed;
+    
+    if (state != TRAJ_STATE_RUNNING)
+    {
+        return;
+    }
+    
+    delta_time = millis() - last_update_time;
+    if (delta_time < sample_time_ms)
+    {
+        return;
+    }
+    last_update_time = millis();
+    dt = delta_time / (FLOAT) MILLIS_PER_SECOND;
+    
+    seg = &segments[seg_index];
+    progress = CalcProgress(seg);
+    if (progress >= Length(seg))
+    {
+        if (!NextSegment())
+        {
+            return;
+        }
+        seg = &segments[seg_index];
+        progress = CalcProgress(seg);
+    }
+    else if (millis() - seg_start_time > seg_timeout)
+    {
+        Finish(TRAJ_STATE_FAILED);
+        return;
+    }
+    
+    if (seg->kind == TRAJ_SEG_PAUSE)
+    {
+        speed = 0.0f;
+    }
+    else
+    {
+        target = sqrtf(seg->exit_speed * seg->exit_speed + 2.0f * brake_accel * max(Length(seg) - progress, 0.0f));
+        target = min(target, seg->speed);
+        target = max(target, min_speed);
+        speed = Profile_Update(&profile, target, dt);
+    }
+    
+    SetCommand(seg, speed);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_SetSampleTime
+ * Description: Sets the trajectory sampling period (see Rate_Set).
+ * Parameters: period - the sampling period in milliseconds
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_SetSampleTime(UINT32 period)
+{
+    sample_time_ms = period;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Clear
+ * Description: Empties the trajectory queue.  A running trajectory is not affected (see Traj_Stop).
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Clear()
+{
+    if (state != TRAJ_STATE_RUNNING)
+    {
+        num_segments = 0;
+        seg_index = 0;
+        state = TRAJ_STATE_IDLE;
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_AddLine
+ * Description: Queues a straight line.
+ * Parameters: distance - the distance (meter), negative drives backward
+ *             speed - the cruise speed (meter/sec)
+ * Return: BOOL - TRUE if the segment was queued; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_AddLine(FLOAT distance, FLOAT speed)
+{
+    return AddSegment(TRAJ_SEG_LINE, distance, speed, 0.0f);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_AddArc
+ * Description: Queues an arc of constant radius.
+ * Parameters: distance - the distance along the arc (meter), negative drives backward
+ *             radius - the radius (meter), positive turns CCW, negative turns CW
+ *             speed - the cruise speed (meter/sec)
+ * Return: BOOL - TRUE if the segment was queued; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_AddArc(FLOAT distance, FLOAT radius, FLOAT speed)
+{
+    if (radius == 0.0f || isnan(radius))
+    {
+        return FALSE;
+    }
+    
+    return AddSegment(TRAJ_SEG_ARC, distance, speed, 1.0f / radius);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_AddTurn
+ * Description: Queues a turn in place.
+ * Parameters: angle - the angle (radian), positive turns CCW, negative turns CW
+ *             speed - the cruise speed (radian/sec)
+ * Return: BOOL - TRUE if the segment was queued; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_AddTurn(FLOAT angle, FLOAT speed)
+{
+    return AddSegment(TRAJ_SEG_TURN, angle, speed, 0.0f);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_AddPause
+ * Description: Queues a pause at rest.
+ * Parameters: duration - the duration (second)
+ * Return: BOOL - TRUE if the segment was queued; otherwise, FALSE.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_AddPause(FLOAT duration)
+{
+    return duration > 0.0f && AddSegment(TRAJ_SEG_PAUSE, duration, 0.0f, 0.0f);
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Execute
+ * Description: Plans the queued trajectory and starts executing it from the current odometry pose.
+ *              The trajectory takes over the control command velocity until Traj_Stop is called.
+ * Parameters: None
+ * Return: BOOL - TRUE if the trajectory was started; otherwise, FALSE, i.e., empty, running or a path
+ *         (see pursuit.c) owns the command velocity.
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_Execute()
+{
+    if (num_segments == 0 || state == TRAJ_STATE_RUNNING || Pursuit_IsRunning())
+    {
+        return FALSE;
+    }
+    
+    Control_GetProfileLimits(&linear_accel, &linear_jerk, &angular_accel, &angular_jerk);
+    PlanSegments();
+    
+    seg_index = 0;
+    carry = 0.0f;
+    StartSegment(FALSE);
+    
+    cmd_linear = 0.0f;
+    cmd_angular = 0.0f;
+    Control_SetCommandVelocityFunc(CommandVelocity);
+    Control_EnableAcceleration(FALSE);
+    owns_command = TRUE;
+    
+    last_update_time = millis();
+    state = TRAJ_STATE_RUNNING;
+    
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_Stop
+ * Description: Stops a running trajectory and returns the command velocity to the control module.
+ *              Note: the command velocity is only restored if the trajectory owns it, so that stopping
+ *              an idle trajectory does not take the command velocity from a path.
+ * Parameters: None
+ * Return: None
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Stop()
+{
+    if (state == TRAJ_STATE_RUNNING)
+    {
+        Finish(TRAJ_STATE_IDLE);
+    }
+    
+    if (owns_command)
+    {
+        Control_RestoreCommandVelocityFunc();
+        owns_command = FALSE;
+    }
+}
+
+BOOL Traj_IsRunning()
+{
+    return state == TRAJ_STATE_RUNNING;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Traj_OwnsCommand
+ * Description: Indicates whether the trajectory holds the control command velocity, i.e., it is running
+ *              or it has ended and is holding the robot stopped until Traj_Stop is called.
+ * Parameters: None
+ * Return: BOOL - TRUE if the trajectory owns the command velocity; otherwise, FALSE
+ * 
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Traj_OwnsCommand()
+{
+    return owns_command;
+}
+
+void Traj_GetStatus(TRAJ_STATUS_TYPE* const status)
+{
+    status->state = state;
+    status->segment = seg_index;
+    status->num_segments = num_segments;
+    status->progress = progress;
+    status->speed = profile.velocity;
+}
+
+TRAJ_SEGMENT_TYPE const * Traj_GetSegment(UINT8 index)
+{
+    return index < num_segments ? &segments[index] : (TRAJ_SEGMENT_TYPE const *) NULL;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,92 @@
+/* 
+MIT License
+
+Copyright (c) 2017 Tim Slator
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*---------------------------------------------------------------------------------------------------
+   Description: This module provides a trajectory executor for a queue of line, arc, turn and pause
+   segments.
+ *-------------------------------------------------------------------------------------------------*/    
+
+#ifndef TRAJ_H
+#define TRAJ_H
+    
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include "freesoc.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+#define TRAJ_MAX_SEGMENTS (16)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {TRAJ_SEG_LINE, TRAJ_SEG_ARC, TRAJ_SEG_TURN, TRAJ_SEG_PAUSE} TRAJ_SEG_KIND_TYPE;
+
+typedef enum {TRAJ_STATE_IDLE, TRAJ_STATE_RUNNING, TRAJ_STATE_DONE, TRAJ_STATE_FAILED} TRAJ_STATE_TYPE;
+
+typedef struct _traj_segment_tag
+{
+    TRAJ_SEG_KIND_TYPE kind;
+    FLOAT length;       /* line/arc: distance (meter), turn: angle (radian), pause: duration (second); 
+                           a negative distance is driven backward, a negative angle is CW */
+    FLOAT speed;        /* cruise speed: meter/sec for line/arc, radian/sec for turn */
+    FLOAT curvature;    /* arc: 1/radius (1/meter), positive turns CCW */
+    FLOAT exit_speed;   /* planned speed at the end of the segment, non-zero when blended into the next */
+} TRAJ_SEGMENT_TYPE;
+
+typedef struct _traj_status_tag
+{
+    TRAJ_STATE_TYPE state;
+    UINT8 segment;      /* the executing segment */
+    UINT8 num_segments;
+    FLOAT progress;     /* along-track progress of the executing segment (meter, radian or second) */
+    FLOAT speed;        /* the commanded speed along the segment */
+} TRAJ_STATUS_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+void Traj_Init();
+void Traj_Start();
+void Traj_Update();
+void Traj_SetSampleTime(UINT32 period);
+
+void Traj_Clear();
+BOOL Traj_AddLine(FLOAT distance, FLOAT speed);
+BOOL Traj_AddArc(FLOAT distance, FLOAT radius, FLOAT speed);
+BOOL Traj_AddTurn(FLOAT angle, FLOAT speed);
+BOOL Traj_AddPause(FLOAT duration);
+BOOL Traj_Execute();
+void Traj_Stop();
+BOOL Traj_IsRunning();
+BOOL Traj_OwnsCommand();
+void Traj_GetStatus(TRAJ_STATUS_TYPE* const status);
+TRAJ_SEGMENT_TYPE const * Traj_GetSegment(UINT8 index);
+
+#endif
+
+/* [] END OF FILE */
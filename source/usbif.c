@@ -168,6 +168,28 @@ void USBIF_PutChar(CHAR value)
     }
 }
 
+/* Note: The data is sent as one packet when length is at most USBUART_BUFFER_SIZE.  Unlike the other
+   writes, this does not wait for the previous packet: it returns FALSE if the CDC is not ready and the
+   caller tries again later (see Emit_Chunk).  When nothing is connected, the data is dropped.
+ */
+BOOL USBIF_PutData(UINT8 const * const data, UINT16 length)
+{
+    if (0u == USBUART_GetConfiguration())
+    {
+        is_connected = FALSE;
+        return TRUE;
+    }
+    
+    if (0u == USBUART_CDCIsReady())
+    {
+        return FALSE;
+    }
+    
+    is_connected = TRUE;
+    USBUART_PutData(data, length);
+    return TRUE;
+}
+
 /*---------------------------------------------------------------------------------------------------
  * Name: Ser_GetConnectState
  * Description: Returns the connection state of the serial interface.
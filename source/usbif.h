@@ -15,6 +15,7 @@ void USBIF_PutString(CHAR* const str);
 UINT8 USBIF_GetAll(CHAR* const data);
 UINT8 USBIF_GetChar(void);
 void USBIF_PutChar(CHAR value);
+BOOL USBIF_PutData(UINT8 const * const data, UINT16 length);
 UINT8 USBIF_GetConnectState(void);
 
 #endif // USBIF_H
@@ -34,6 +34,7 @@ SOFTWARE.
 #include <math.h>
 #include "time.h"
 #include "utils.h"
+#include "angle.h"
 #include "config.h"
 #include "consts.h"
 #include "assertion.h"
@@ -469,21 +470,7 @@ FLOAT CalcHeading(FLOAT left_count, FLOAT right_count, FLOAT radius, FLOAT width
  *-------------------------------------------------------------------------------------------------*/
 FLOAT NormalizeHeading(FLOAT heading)
 {
-    FLOAT result = 0.0;
-
-    result = heading;
-    
-    result -= (FLOAT)( (int)(result/TWOPI) ) * TWOPI;
-    if (result < -PI) 
-    { 
-        result += TWOPI;
-    }
-    else if (result > PI)
-    {
-        result -= TWOPI; 
-    }
-
-    return result;
+    return Angle_Wrap(heading);
 }
 
 
@@ -605,114 +592,6 @@ void EnsureAngularVelocity(FLOAT* const v, FLOAT* const w)
     }
 }
 
-/*---------------------------------------------------------------------------------------------------
- * Name: AdjustVelocity
- * Description: Calculates a new velocity based on the last velocity, max velocity and specified
- *              response time.
- * Parameters: last_velocity - the last adjusted velocity
- *             curr_velocity - the currently commanded velocity
- *             max_velocity  - the maximum allowed velocity
- *             response_time - the response time, i.e., how long to go from 0 to max velocity
- *             last_time     - the last time (in milliseconds) 
- * Return: limited velocity
- * 
- *-------------------------------------------------------------------------------------------------*/ 
-static FLOAT AdjustVelocity(FLOAT last_velocity, FLOAT curr_velocity, FLOAT max_velocity, FLOAT response_time, UINT32* const last_time)
-/*
-    Explanation: The approach here is to limit acceleration in terms of a response time, e.g., wheel should reach new 
-    speed within X seconds.  The worst case is 0 to max speed.  On each call delta time, delta velocity and percent
-    change are calculated.  The velocity adjustment is proportional to the worst case velocity change.  The velocity is
-    adjusted until the newly command velocity is reached.  The resulting response is an S curve due to the percent
-    change getting increasingly smaller as the target velocity is reached.
-*/
-{
-    FLOAT delta_time;
-    FLOAT delta_velocity;
-    FLOAT percent_change;
-    FLOAT adjust;
-    FLOAT velocity;
-    FLOAT now;
-    
-    ASSERTION(last_time != NULL, "last_time is NULL");
-    RETURN_VALUE_ON_FAILURE(last_time == NULL, 0);
-    
-    velocity = 0.0;
-    
-    now = millis();
-    delta_time = (FLOAT) (now - *last_time) / 1000.0;
-    *last_time = now;
-    delta_velocity = curr_velocity - last_velocity;
-    
-    percent_change = abs(delta_velocity / max_velocity);
-    adjust = IS_NAN_DEFAULT(delta_velocity / (response_time * percent_change / delta_time), 0.0);
-    
-    if (adjust > 0.0 && adjust < 0.0001)
-    {
-        adjust = 0.0;
-    }
-    else if (adjust < 0.0 && adjust > -0.0001)
-    {
-        adjust = 0.0;
-    }
-    
-    if (last_velocity <= curr_velocity)
-    {
-        velocity = min(last_velocity + adjust, curr_velocity);
-    }
-    else if (last_velocity > curr_velocity)
-    {
-        velocity = max(last_velocity + adjust, curr_velocity);
-    }
-
-    return velocity;
-}
-
-/*---------------------------------------------------------------------------------------------------
- * Name: LimitLinearAccel
- * Description: Limits linear velocity based on the defined linear response time.
- * Parameters: linear_velocity - the linear velocity to be limited.
- *             max_linear      - maximum linear velocity.
- *             response_time   - maximum time (in milliseconds) in which to acheive specified velocity.
- * Return: updated velocity
- * 
- *-------------------------------------------------------------------------------------------------*/ 
-FLOAT LimitLinearAccel(FLOAT linear_velocity, FLOAT max_linear, FLOAT response_time)
-{
-    static FLOAT last_velocity = 0.0;
-    static UINT32 last_time = 0;
-    
-    last_velocity = AdjustVelocity(last_velocity, 
-                                   linear_velocity, 
-                                   max_linear, 
-                                   response_time, 
-                                   &last_time);
-
-    return last_velocity;
-}
-
-/*---------------------------------------------------------------------------------------------------
- * Name: LimitAngularAccel
- * Description: Limits angular velocity based on the defined angular response time.
- * Parameters: angular_velocity - the angular velocity to be limited.
- *             max_angular      - maximum angular velocity.
- *             response_time    - maximum time (in milliseconds) in which to acheive specified velocity.
- * Return: updated velocity
- * 
- *-------------------------------------------------------------------------------------------------*/ 
-FLOAT LimitAngularAccel(FLOAT angular_velocity, FLOAT max_angular, FLOAT response_time)
-{
-    static FLOAT last_velocity = 0.0;
-    static UINT32 last_time = 0;
-
-    last_velocity = AdjustVelocity(last_velocity, 
-                                   angular_velocity, 
-                                   max_angular, 
-                                   response_time, 
-                                   &last_time);
-
-    return last_velocity;    
-}
-
 FLOAT CalcMaxLinearVelocity()
 {
     FLOAT max_linear;
@@ -728,7 +607,7 @@ FLOAT CalcMaxAngularVelocity()
     FLOAT max_angular;
     FLOAT dont_care;
     
-    DiffToUni(MAX_WHEEL_RADIAN_PER_SECOND, -MAX_WHEEL_RADIAN_PER_SECOND, &dont_care, &max_angular);
+    DiffToUni(-MAX_WHEEL_RADIAN_PER_SECOND, MAX_WHEEL_RADIAN_PER_SECOND, &dont_care, &max_angular);
     
     return max_angular;
 }
@@ -762,7 +641,7 @@ CHAR * format_string(CHAR *str, FORMAT_TYPE format)
     return str;
 }
 
-CHAR * const WheelToString(WHEEL_TYPE wheel, FORMAT_TYPE format)
+CHAR const * WheelToString(WHEEL_TYPE wheel, FORMAT_TYPE format)
 {
     switch (wheel)
     {
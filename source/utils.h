@@ -152,14 +152,12 @@ FLOAT NormalizeHeading(FLOAT heading);
 void CalcTriangularProfile(UINT8 num_points, FLOAT lower_limit, FLOAT upper_limit, FLOAT *profile);
 void EnsureAngularVelocity(FLOAT* const linear_cmd_velocity, FLOAT* const angular_cmd_velocity);
 
-FLOAT LimitLinearAccel(FLOAT linear_velocity, FLOAT max_linear, FLOAT response_time);
-FLOAT LimitAngularAccel(FLOAT angular_velocity, FLOAT max_angular, FLOAT response_time);
 
 FLOAT CalcMaxLinearVelocity();
 FLOAT CalcMaxAngularVelocity();
 FLOAT CalcMaxDiffVelocity();
 
-CHAR * const WheelToString(WHEEL_TYPE wheel, FORMAT_TYPE format);
+CHAR const * WheelToString(WHEEL_TYPE wheel, FORMAT_TYPE format);
 CHAR * format_string(CHAR *str, FORMAT_TYPE format);
 
 #endif
@@ -38,6 +38,7 @@ SOFTWARE.
 #include "pid.h"
 #include "time.h"
 #include "utils.h"
+#include "angle.h"
 #include "serial.h"
 #include "nvstore.h"
 #include "debug.h"
@@ -113,38 +114,10 @@ static UINT8 IsMoveFinished(DIR_TYPE direction)
     
     FLOAT curr_heading = Odom_GetHeading();
     
-    if (direction == DIR_CCW)
+    /* Note: The rotation has finished when the heading reaches or just passes 0 in the direction of rotation */
+    if (direction == DIR_CCW || direction == DIR_CW)
     {
-        if (curr_heading < 0.0)
-        {
-            return FALSE;
-        }
-        else
-        {
-            if (curr_heading >= -TOLERANCE && curr_heading <= TOLERANCE)
-            {
-                return TRUE;
-            }
-
-            return FALSE;
-        }
-    }
-
-    else if (direction == DIR_CW)
-    {
-        if (curr_heading > 0.0)
-        {
-            return FALSE;
-        }
-        else
-        {
-            if (curr_heading >= -TOLERANCE && curr_heading <= TOLERANCE)
-            {
-                return TRUE;
-            }
-
-            return FALSE;
-        }                
+        return Angle_IsReached(0.0, curr_heading, direction == DIR_CCW ? 1 : -1, TOLERANCE);
     }
 
     return FALSE;
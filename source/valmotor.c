@@ -52,14 +52,13 @@ SOFTWARE.
 #include "pwm.h"
 #include "nvstore.h"
 #include "serial.h"
+#include "emit.h"
 #include "encoder.h"
 #include "time.h"
 #include "utils.h"
 #include "debug.h"
 #include "pid.h"
 
-#include "pidleft.h"
-#include "pidright.h"
 
 /*---------------------------------------------------------------------------------------------------
  * Constants
@@ -220,8 +219,16 @@ static UINT8 num_profile_data_points;
 
 void PrintWheelVelocity(FLOAT cps)
 {    
-    Ser_PutStringFormat("{\"calc cps\":%.3f,\"meas cps\":%.3f,\"diff\":%.3f, \"%% diff\":%.3f}\r\n", 
-        cps, val_params->get_cps(), cps - val_params->get_cps(), 100.0 * (cps - val_params->get_cps())/cps);
+    FLOAT meas_cps = val_params->get_cps();
+    
+    Emit_ObjectBegin(NULL);
+    Emit_KeyFixed("calc cps", cps, 3);
+    Emit_KeyFixed("meas cps", meas_cps, 3);
+    Emit_KeyFixed("diff", cps - meas_cps, 3);
+    Emit_KeyFixed("% diff", 100.0 * (cps - meas_cps)/cps, 3);
+    Emit_ObjectEnd();
+    Emit_Newline();
+    Emit_Flush();
 }
 
 /*---------------------------------------------------------------------------------------------------
@@ -38,8 +38,7 @@ SOFTWARE.
 #include "serial.h"
 #include "nvstore.h"
 #include "pid.h"
-#include "pidleft.h"
-#include "pidright.h"
+#include "pidbank.h"
 #include "utils.h"
 #include "encoder.h"
 #include "motor.h"
@@ -114,14 +113,14 @@ static void CalcValidationProfile(FLOAT low_percent, FLOAT high_percent, UINT8 n
     {
         start = (FLOAT) min(Cal_GetMotorData(WHEEL_LEFT, DIR_FORWARD)->cps_min, Cal_GetMotorData(WHEEL_RIGHT, DIR_FORWARD)->cps_min);
         stop = (FLOAT) min(Cal_GetMotorData(WHEEL_LEFT, DIR_FORWARD)->cps_max, Cal_GetMotorData(WHEEL_RIGHT, DIR_FORWARD)->cps_max);
-        stop = min(stop, (FLOAT) min(LEFTPID_MAX, RIGHTPID_MAX));
+        stop = min(stop, (FLOAT) PIDBANK_WHEEL_MAX);
     }
     else if (p_pid_val->direction == DIR_BACKWARD)
     {
         /* Note: backward count/sec values are negative, i.e., swap min/max and negative PID max */
         start = (FLOAT) min(Cal_GetMotorData(WHEEL_LEFT, DIR_BACKWARD)->cps_max, Cal_GetMotorData(WHEEL_RIGHT, DIR_BACKWARD)->cps_max);
         stop = (FLOAT) max(Cal_GetMotorData(WHEEL_LEFT, DIR_BACKWARD)->cps_min, Cal_GetMotorData(WHEEL_RIGHT, DIR_BACKWARD)->cps_min);
-        stop = max(stop, (FLOAT) max(-LEFTPID_MAX, -RIGHTPID_MAX));
+        stop = max(stop, (FLOAT) -PIDBANK_WHEEL_MAX);
     }
     
     start = low_percent * stop;
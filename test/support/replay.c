@@ -0,0 +1,488 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module replays a control loop trace through the firmware on the host.
+
+   The trace is written by the robot when trace debug is enabled (see source/trace.c) and converted to CSV
+   by tools/replay.py:
+
+       # periods,<enc>,<pid>,<odom>,<outer>
+       # gains,<left kp>,<ki>,<kd>,<kf>,<right kp>,<ki>,<kd>,<kf>
+       # models,<left fwd gain>,<tau>,<deadband>,<valid>,<left bwd ...>,<right fwd ...>,<right bwd ...>
+       time,linear,angular,timeout,left_count,right_count,left_pwm,right_pwm,x,y,heading
+       ...
+
+   Each record is the control loop at an encoder sample.  The replay runs the main loop updates (control,
+   motor, encoder, PID and odometry) on a virtual millisecond clock.  Between two records, the loop runs every
+   millisecond, but never reaches the next encoder sample before the time of the next record, so that the
+   replayed encoder samples the recorded counts at the recorded time.  Between samples, the counts are
+   interpolated (odometry reads the live count) and the command of the previous record is held.
+
+   The first record is the reference: the odometry is reset there and the recorded pose is compared relative
+   to it.  A trace should start with the robot at rest since the filters and PIDs start from rest.
+
+   The motor calibration is reproduced by the traced motor models rather than by the calibration tables, so
+   the replayed pwm only approximates the pwm of the robot.  tools/replay.py rebase takes the pwm of a replay
+   as the baseline of the trace.  A recorded pwm of 0 is not compared.
+
+   The time spent in each update is measured with the host microsecond clock.  A single call is shorter than the
+   resolution, but the mean over the calls of a replay is not.
+
+   The clock only moves forward because the update functions keep their last update time in function statics.
+ *-------------------------------------------------------------------------------------------------*/
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include <math.h>
+#include <sys/time.h>
+#include "replay.h"
+#include "control.h"
+#include "motor.h"
+#include "encoder.h"
+#include "pid.h"
+#include "odom.h"
+#include "angle.h"
+#include "utils.h"
+#include "rate.h"
+#include "consts.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* Time between replays so that every update samples at the first record */
+#define REPLAY_GAP_MS   (1000)
+
+#define MAX_LINE_LENGTH (256)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef void (*REPLAY_UPDATE_FUNC_TYPE)();
+
+/*---------------------------------------------------------------------------------------------------
+ * Variables
+ *-------------------------------------------------------------------------------------------------*/
+static REPLAY_TRACE_TYPE const *p_trace;
+static UINT32 now;
+static INT32 counters[2];
+static PWM_TYPE pwms[2];
+static FLOAT cmd_linear;
+static FLOAT cmd_angular;
+static UINT32 cmd_timeout;
+
+static REPLAY_UPDATE_FUNC_TYPE const updates[REPLAY_MODULE_LAST] = {
+    Control_Update, Motor_Update, Encoder_Update, Pid_Update, Odom_Update
+};
+
+static char const * const module_names[REPLAY_MODULE_LAST] = {
+    "control", "motor", "encoder", "pid", "odom"
+};
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+
+static BOOL ParseSettings(char const *line, REPLAY_TRACE_TYPE* const trace)
+{
+    unsigned long periods[REPLAY_PERIOD_LAST];
+    FLOAT gains[8];
+    FLOAT gain[4];
+    FLOAT tau[4];
+    unsigned int deadband[4];
+    unsigned int valid[4];
+    UINT8 ii;
+
+    if (sscanf(line, "# periods,%lu,%lu,%lu,%lu", &periods[0], &periods[1], &periods[2], &periods[3]) == 4)
+    {
+        for (ii = 0; ii < REPLAY_PERIOD_LAST; ++ii)
+        {
+            trace->periods[ii] = periods[ii];
+        }
+        return TRUE;
+    }
+
+    if (sscanf(line, "# gains,%f,%f,%f,%f,%f,%f,%f,%f",
+               &gains[0], &gains[1], &gains[2], &gains[3], &gains[4], &gains[5], &gains[6], &gains[7]) == 8)
+    {
+        for (ii = 0; ii < 2; ++ii)
+        {
+            trace->gains[ii].kp = gains[4 * ii];
+            trace->gains[ii].ki = gains[4 * ii + 1];
+            trace->gains[ii].kd = gains[4 * ii + 2];
+            trace->gains[ii].kf = gains[4 * ii + 3];
+        }
+        return TRUE;
+    }
+
+    if (sscanf(line, "# models,%f,%f,%u,%u,%f,%f,%u,%u,%f,%f,%u,%u,%f,%f,%u,%u",
+               &gain[0], &tau[0], &deadband[0], &valid[0], &gain[1], &tau[1], &deadband[1], &valid[1],
+               &gain[2], &tau[2], &deadband[2], &valid[2], &gain[3], &tau[3], &deadband[3], &valid[3]) == 16)
+    {
+        for (ii = 0; ii < 4; ++ii)
+        {
+            CAL_MOTOR_MODEL_TYPE *model = &trace->models[ii / 2][ii % 2];
+
+            model->gain = gain[ii];
+            model->tau = tau[ii];
+            model->deadband = deadband[ii];
+            model->valid = valid[ii] ? TRUE : FALSE;
+        }
+        return TRUE;
+    }
+
+    /* Note: Other comments are allowed */
+    return line[0] == '#';
+}
+
+static BOOL ParseRecord(char const *line, REPLAY_RECORD_TYPE* const record)
+{
+    unsigned long time;
+    unsigned long timeout;
+    long left_count;
+    long right_count;
+    unsigned int left_pwm;
+    unsigned int right_pwm;
+
+    if (sscanf(line, "%lu,%f,%f,%lu,%ld,%ld,%u,%u,%f,%f,%f",
+               &time, &record->linear, &record->angular, &timeout, &left_count, &right_count, &left_pwm, &right_pwm,
+               &record->x, &record->y, &record->heading) != 11)
+    {
+        return FALSE;
+    }
+
+    record->time = time;
+    record->timeout = timeout;
+    record->left_count = left_count;
+    record->right_count = right_count;
+    record->left_pwm = left_pwm;
+    record->right_pwm = right_pwm;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Replay_Load
+ * Description: Reads a trace from a CSV file.  The settings default to the compile-time sample rates and
+ *              to no motor models.
+ * Parameters: path - the trace file
+ *             (out) trace - the trace
+ * Return: BOOL - TRUE if the file was read and holds at least two records, otherwise FALSE
+ *
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Replay_Load(char const * const path, REPLAY_TRACE_TYPE* const trace)
+{
+    FILE *file;
+    char line[MAX_LINE_LENGTH];
+    BOOL result = TRUE;
+
+    memset(trace, 0, sizeof *trace);
+    trace->periods[REPLAY_PERIOD_ENC] = RATE_TO_PERIOD_MS(ENC_SAMPLE_RATE);
+    trace->periods[REPLAY_PERIOD_PID] = RATE_TO_PERIOD_MS(PID_SAMPLE_RATE);
+    trace->periods[REPLAY_PERIOD_ODOM] = RATE_TO_PERIOD_MS(ODOM_SAMPLE_RATE);
+    trace->periods[REPLAY_PERIOD_OUTER] = RATE_TO_PERIOD_MS(OUTER_SAMPLE_RATE);
+
+    file = fopen(path, "r");
+    if (!file)
+    {
+        return FALSE;
+    }
+
+    while (result && fgets(line, sizeof line, file))
+    {
+        if (line[0] == '#')
+        {
+            result = ParseSettings(line, trace);
+        }
+        else if (line[0] >= '0' && line[0] <= '9')
+        {
+            result = trace->num_records < REPLAY_MAX_RECORDS && ParseRecord(line, &trace->records[trace->num_records]);
+            trace->num_records += result ? 1 : 0;
+        }
+        /* Note: The column header and empty lines are skipped */
+    }
+
+    fclose(file);
+    return result && trace->num_records >= 2;
+}
+
+static UINT32 TimeOf(REPLAY_RECORD_TYPE const * const record)
+{
+    return record->time - p_trace->records[0].time;
+}
+
+static INT32 InterpolateCount(INT32 from, INT32 to, UINT32 elapsed, UINT32 span)
+{
+    return from + (INT32) lround((FLOAT) (to - from) * elapsed / span);
+}
+
+static void SetInputs(REPLAY_RECORD_TYPE const * const record)
+{
+    counters[WHEEL_LEFT] = record->left_count - p_trace->records[0].left_count;
+    counters[WHEEL_RIGHT] = record->right_count - p_trace->records[0].right_count;
+    cmd_linear = record->linear;
+    cmd_angular = record->angular;
+    cmd_timeout = record->timeout;
+}
+
+static void RunLoop(REPLAY_RESULT_TYPE* const result)
+{
+    struct timeval start;
+    struct timeval end;
+    REPLAY_TIMING_TYPE *timing;
+    UINT32 us;
+    UINT8 ii;
+
+    for (ii = 0; ii < REPLAY_MODULE_LAST; ++ii)
+    {
+        gettimeofday(&start, NULL);
+        updates[ii]();
+        gettimeofday(&end, NULL);
+
+        us = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        timing = &result->timing[ii];
+        timing->calls++;
+        timing->total_us += us;
+        timing->max_us = max(timing->max_us, us);
+    }
+}
+
+static void StartFirmware()
+{
+    Control_Init();
+    Motor_Init();
+    Encoder_Init();
+    Pid_Init();
+    Odom_Init();
+
+    Control_Start();
+    Motor_Start();
+    Encoder_Start();
+    Pid_Start();
+    Odom_Start();
+
+    Encoder_SetSampleTime(p_trace->periods[REPLAY_PERIOD_ENC]);
+    Pid_SetSampleTime(PID_LOOP_INNER, p_trace->periods[REPLAY_PERIOD_PID]);
+    Pid_SetSampleTime(PID_LOOP_OUTER, p_trace->periods[REPLAY_PERIOD_OUTER]);
+    Odom_SetSampleTime(p_trace->periods[REPLAY_PERIOD_ODOM]);
+}
+
+static void Compare(REPLAY_RECORD_TYPE const * const record, REPLAY_RESULT_TYPE* const result, UINT32* const sum_pwm_error)
+{
+    REPLAY_RECORD_TYPE const *first = &p_trace->records[0];
+    FLOAT sin_heading;
+    FLOAT cos_heading;
+    FLOAT dx;
+    FLOAT dy;
+    FLOAT x;
+    FLOAT y;
+    UINT16 error;
+
+    if (record->left_pwm && record->right_pwm)
+    {
+        error = max(abs(Replay_ReadPwm(WHEEL_LEFT) - record->left_pwm), abs(Replay_ReadPwm(WHEEL_RIGHT) - record->right_pwm));
+        result->max_pwm_error = max(result->max_pwm_error, error);
+        *sum_pwm_error += error;
+    }
+
+    /* The recorded pose relative to the first record */
+    Angle_SinCos(first->heading, &sin_heading, &cos_heading);
+    dx = record->x - first->x;
+    dy = record->y - first->y;
+
+    Odom_GetXYPosition(&x, &y);
+    x -= dx * cos_heading + dy * sin_heading;
+    y -= dy * cos_heading - dx * sin_heading;
+    result->max_position_error = max(result->max_position_error, sqrt(x * x + y * y));
+    result->max_heading_error = max(result->max_heading_error,
+                                    fabs(Angle_Wrap(Odom_GetHeading() - (record->heading - first->heading))));
+
+    result->num_compared++;
+}
+
+static void Output(FILE* const output, REPLAY_RECORD_TYPE const * const record)
+{
+    FLOAT x;
+    FLOAT y;
+
+    Odom_GetXYPosition(&x, &y);
+    fprintf(output, "%lu,%u,%u,%.4f,%.4f,%.4f\n",
+            (unsigned long) record->time, Replay_ReadPwm(WHEEL_LEFT), Replay_ReadPwm(WHEEL_RIGHT), x, y, Odom_GetHeading());
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Replay_Run
+ * Description: Replays a trace through the firmware and compares the pwm and pose with the trace.
+ * Parameters: trace - the trace
+ *             output - file to which the replayed pwm and pose are written (CSV), or NULL
+ *             (out) result - the comparison and the time spent in each update
+ * Return: None
+ *
+ *-------------------------------------------------------------------------------------------------*/
+void Replay_Run(REPLAY_TRACE_TYPE const * const trace, FILE* const output, REPLAY_RESULT_TYPE* const result)
+{
+    REPLAY_RECORD_TYPE const *prev;
+    REPLAY_RECORD_TYPE const *record;
+    UINT32 base;
+    UINT32 start;
+    UINT32 end;
+    UINT32 last;
+    UINT32 sample_time;
+    INT32 left_count;
+    INT32 right_count;
+    UINT32 sum_pwm_error = 0;
+    UINT16 ii;
+
+    memset(result, 0, sizeof *result);
+    p_trace = trace;
+    now += REPLAY_GAP_MS;
+    base = now;
+
+    pwms[WHEEL_LEFT] = PWM_STOP;
+    pwms[WHEEL_RIGHT] = PWM_STOP;
+    SetInputs(&trace->records[0]);
+    StartFirmware();
+
+    /* Note: Odometry keeps the last counts in function statics, so the reset follows the first sample */
+    RunLoop(result);
+    Odom_Reset();
+
+    if (output)
+    {
+        fprintf(output, "time,left_pwm,right_pwm,x,y,heading\n");
+        Output(output, &trace->records[0]);
+    }
+
+    for (ii = 1; ii < trace->num_records; ++ii)
+    {
+        prev = &trace->records[ii - 1];
+        record = &trace->records[ii];
+        start = base + TimeOf(prev);
+        end = base + TimeOf(record);
+        last = min(end, start + trace->periods[REPLAY_PERIOD_ENC]);
+
+        for (now = start + 1; now < last; ++now)
+        {
+            counters[WHEEL_LEFT] = InterpolateCount(prev->left_count, record->left_count, now - start, end - start) - trace->records[0].left_count;
+            counters[WHEEL_RIGHT] = InterpolateCount(prev->right_count, record->right_count, now - start, end - start) - trace->records[0].right_count;
+            cmd_timeout = prev->timeout + now - start;
+            RunLoop(result);
+        }
+
+        now = end;
+        SetInputs(record);
+        RunLoop(result);
+
+        Encoder_GetSample(&sample_time, &left_count, &right_count);
+        result->num_unsampled += sample_time != now ? 1 : 0;
+
+        Compare(record, result, &sum_pwm_error);
+        if (output)
+        {
+            Output(output, record);
+        }
+    }
+
+    result->mean_pwm_error = result->num_compared ? sum_pwm_error / (FLOAT) result->num_compared : 0.0;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Replay_PrintResult
+ * Description: Prints the comparison and the time spent in each update.
+ * Parameters: result - the result of a replay
+ * Return: None
+ *
+ *-------------------------------------------------------------------------------------------------*/
+void Replay_PrintResult(REPLAY_RESULT_TYPE const * const result)
+{
+    REPLAY_TIMING_TYPE const *timing;
+    UINT8 ii;
+
+    printf("replay: %u records, %u unsampled\n", result->num_compared, result->num_unsampled);
+    printf("    pwm error: max %u, mean %.2f\n", result->max_pwm_error, result->mean_pwm_error);
+    printf("    pose error: max %.4f m, %.4f rad\n", result->max_position_error, result->max_heading_error);
+    printf("    %-8s %8s %10s %10s\n", "update", "calls", "mean ns", "max us");
+    for (ii = 0; ii < REPLAY_MODULE_LAST; ++ii)
+    {
+        timing = &result->timing[ii];
+        printf("    %-8s %8u %10.0f %10u\n", module_names[ii], timing->calls,
+               timing->calls ? 1000.0 * timing->total_us / timing->calls : 0.0, timing->max_us);
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Host HAL
+ *-------------------------------------------------------------------------------------------------*/
+UINT32 Replay_Millis()
+{
+    return now;
+}
+
+INT32 Replay_GetCounter(WHEEL_TYPE wheel)
+{
+    return counters[wheel];
+}
+
+void Replay_SetCounter(WHEEL_TYPE wheel, INT32 count)
+{
+    /* Note: Only the encoder start clears the counter, which the replay has already done */
+    (void) wheel;
+    (void) count;
+}
+
+void Replay_WritePwm(WHEEL_TYPE wheel, PWM_TYPE pwm)
+{
+    pwms[wheel] = pwm;
+}
+
+PWM_TYPE Replay_ReadPwm(WHEEL_TYPE wheel)
+{
+    return pwms[wheel];
+}
+
+void Replay_ReadCmdVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout)
+{
+    *linear = cmd_linear;
+    *angular = cmd_angular;
+    *timeout = cmd_timeout;
+}
+
+/*---------------------------------------------------------------------------------------------------
+ * Name: Replay_CpsToPwm
+ * Description: Converts count/sec to pwm with the traced motor model, i.e., pwm offset = deadband + cps / gain.
+ *              Like the calibration table, a speed below 1 count/sec is a stop.
+ * Parameters: wheel - left/right wheel
+ *             cps - count/second
+ * Return: PWM_TYPE - PWM
+ *
+ *-------------------------------------------------------------------------------------------------*/
+PWM_TYPE Replay_CpsToPwm(WHEEL_TYPE wheel, FLOAT cps)
+{
+    CAL_MOTOR_MODEL_TYPE const *model;
+    FLOAT offset;
+    INT16 sign;
+
+    if ((INT16) cps == 0)
+    {
+        return PWM_STOP;
+    }
+
+    model = &p_trace->models[wheel][cps > 0 ? DIR_FORWARD : DIR_BACKWARD];
+    if (model->gain == 0.0)
+    {
+        return PWM_STOP;
+    }
+
+    offset = model->deadband + fabs(cps / model->gain);
+    sign = (cps > 0) == (wheel == WHEEL_LEFT) ? 1 : -1;
+
+    return constrain((INT32) lround(PWM_STOP + sign * offset), MIN_PWM_VALUE, MAX_PWM_VALUE);
+}
+
+CAL_PID_TYPE* Replay_GetPidGains(PID_ENUM_TYPE pid)
+{
+    return (CAL_PID_TYPE *) &p_trace->gains[pid == PID_TYPE_RIGHT ? 1 : 0];
+}
+
+CAL_MOTOR_MODEL_TYPE* Replay_GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir)
+{
+    return (CAL_MOTOR_MODEL_TYPE *) &p_trace->models[wheel][dir];
+}
@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------------------------------------
+   Description: This module replays a control loop trace (see source/trace.c and tools/replay.py) through
+   the firmware on the host.  It is also the host HAL of the replay: the test routes the mocked clock,
+   encoder counters, PWM compare registers, I2C command velocity and calibration to the functions below.
+ *-------------------------------------------------------------------------------------------------*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/*---------------------------------------------------------------------------------------------------
+ * Includes
+ *-------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include "freesoc.h"
+#include "cal.h"
+#include "pwm.h"
+
+/*---------------------------------------------------------------------------------------------------
+ * Constants
+ *-------------------------------------------------------------------------------------------------*/
+/* About 5 minutes at the default encoder rate */
+#define REPLAY_MAX_RECORDS  (16384)
+
+/*---------------------------------------------------------------------------------------------------
+ * Types
+ *-------------------------------------------------------------------------------------------------*/
+typedef enum {REPLAY_PERIOD_ENC, REPLAY_PERIOD_PID, REPLAY_PERIOD_ODOM, REPLAY_PERIOD_OUTER, REPLAY_PERIOD_LAST} REPLAY_PERIOD_TYPE;
+
+typedef enum {REPLAY_MODULE_CONTROL, REPLAY_MODULE_MOTOR, REPLAY_MODULE_ENCODER, REPLAY_MODULE_PID, REPLAY_MODULE_ODOM, REPLAY_MODULE_LAST} REPLAY_MODULE_TYPE;
+
+/* One record of the trace, i.e., the control loop at an encoder sample */
+typedef struct _replay_record_tag
+{
+    UINT32 time;        /* millisecond */
+    FLOAT linear;       /* commanded linear velocity (meter/sec) */
+    FLOAT angular;      /* commanded angular velocity (rad/sec) */
+    UINT32 timeout;     /* time since the last command (millisecond) */
+    INT32 left_count;
+    INT32 right_count;
+    PWM_TYPE left_pwm;
+    PWM_TYPE right_pwm;
+    FLOAT x;            /* meter */
+    FLOAT y;            /* meter */
+    FLOAT heading;      /* radian */
+} REPLAY_RECORD_TYPE;
+
+typedef struct _replay_trace_tag
+{
+    UINT32 periods[REPLAY_PERIOD_LAST];
+    CAL_PID_TYPE gains[2];                  /* left, right */
+    CAL_MOTOR_MODEL_TYPE models[2][2];      /* [wheel][dir] */
+    UINT16 num_records;
+    REPLAY_RECORD_TYPE records[REPLAY_MAX_RECORDS];
+} REPLAY_TRACE_TYPE;
+
+/* Host time spent in a module update */
+typedef struct _replay_timing_tag
+{
+    UINT32 calls;
+    uint64_t total_us;
+    UINT32 max_us;
+} REPLAY_TIMING_TYPE;
+
+typedef struct _replay_result_tag
+{
+    UINT16 num_compared;
+    UINT16 num_unsampled;       /* records at which the replayed encoder did not sample */
+    UINT16 max_pwm_error;
+    FLOAT mean_pwm_error;
+    FLOAT max_position_error;   /* meter */
+    FLOAT max_heading_error;    /* radian */
+    REPLAY_TIMING_TYPE timing[REPLAY_MODULE_LAST];
+} REPLAY_RESULT_TYPE;
+
+/*---------------------------------------------------------------------------------------------------
+ * Functions
+ *-------------------------------------------------------------------------------------------------*/
+BOOL Replay_Load(char const * const path, REPLAY_TRACE_TYPE* const trace);
+void Replay_Run(REPLAY_TRACE_TYPE const * const trace, FILE* const output, REPLAY_RESULT_TYPE* const result);
+void Replay_PrintResult(REPLAY_RESULT_TYPE const * const result);
+
+/* Host HAL */
+UINT32 Replay_Millis();
+INT32 Replay_GetCounter(WHEEL_TYPE wheel);
+void Replay_SetCounter(WHEEL_TYPE wheel, INT32 count);
+void Replay_WritePwm(WHEEL_TYPE wheel, PWM_TYPE pwm);
+PWM_TYPE Replay_ReadPwm(WHEEL_TYPE wheel);
+void Replay_ReadCmdVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout);
+PWM_TYPE Replay_CpsToPwm(WHEEL_TYPE wheel, FLOAT cps);
+CAL_PID_TYPE* Replay_GetPidGains(PID_ENUM_TYPE pid);
+CAL_MOTOR_MODEL_TYPE* Replay_GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir);
+
+#endif
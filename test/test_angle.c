@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <math.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "angle.h"
+#include "mock_serial.h"
+#include "mock_time.h"
+
+#define SWEEP_MIN       (-3.0 * ANGLE_TWOPI)
+#define SWEEP_MAX       (3.0 * ANGLE_TWOPI)
+#define SWEEP_STEP      (0.001)
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenAngleInRange_ThenWrapUnchanged(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(0.0, Angle_Wrap(0.0));
+    TEST_ASSERT_EQUAL_FLOAT(3.14159, Angle_Wrap(3.14159));
+    TEST_ASSERT_EQUAL_FLOAT(-3.14159, Angle_Wrap(-3.14159));
+}
+
+void test_WhenAngleOutOfRange_ThenWrapToPlusMinusPI(void)
+{
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, -ANGLE_HALFPI, Angle_Wrap(1.5 * ANGLE_PI));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, ANGLE_HALFPI, Angle_Wrap(-1.5 * ANGLE_PI));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 1.0, Angle_Wrap(1.0 + 4.0 * ANGLE_TWOPI));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, -1.0, Angle_Wrap(-1.0 - 4.0 * ANGLE_TWOPI));
+}
+
+void test_WhenTargetAcrossPI_ThenErrorIsShortestWay(void)
+{
+    /* From just below PI to just above -PI is a small positive rotation, not almost a revolution */
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 0.2, Angle_Error(-ANGLE_PI + 0.1, ANGLE_PI - 0.1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, -0.2, Angle_Error(ANGLE_PI - 0.1, -ANGLE_PI + 0.1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5, 0.5, Angle_Error(1.0, 0.5));
+}
+
+void test_WhenRotatingCCW_ThenReachedOnlyAtOrJustPastTarget(void)
+{
+    TEST_ASSERT_FALSE(Angle_IsReached(0.0, -0.005, 1, 0.01));
+    TEST_ASSERT_TRUE(Angle_IsReached(0.0, 0.0, 1, 0.01));
+    TEST_ASSERT_TRUE(Angle_IsReached(0.0, 0.005, 1, 0.01));
+    TEST_ASSERT_FALSE(Angle_IsReached(0.0, 0.02, 1, 0.01));
+}
+
+void test_WhenRotatingCW_ThenReachedOnlyAtOrJustPastTarget(void)
+{
+    TEST_ASSERT_FALSE(Angle_IsReached(0.0, 0.005, -1, 0.01));
+    TEST_ASSERT_TRUE(Angle_IsReached(0.0, -0.005, -1, 0.01));
+    TEST_ASSERT_FALSE(Angle_IsReached(0.0, -0.02, -1, 0.01));
+}
+
+void test_WhenTargetIsPI_ThenReachedAcrossWrap(void)
+{
+    TEST_ASSERT_TRUE(Angle_IsReached(ANGLE_PI, -ANGLE_PI + 0.005, 1, 0.01));
+    TEST_ASSERT_TRUE(Angle_IsReached(-ANGLE_PI, ANGLE_PI - 0.005, -1, 0.01));
+}
+
+void test_WhenSinCos_ThenMatchesLibm(void)
+{
+    FLOAT angle;
+    FLOAT sine;
+    FLOAT cosine;
+    
+    for (angle = SWEEP_MIN; angle < SWEEP_MAX; angle += SWEEP_STEP)
+    {
+        Angle_SinCos(angle, &sine, &cosine);
+        TEST_ASSERT_FLOAT_WITHIN(2e-6, sin(angle), sine);
+        TEST_ASSERT_FLOAT_WITHIN(2e-6, cos(angle), cosine);
+    }
+}
+
+void test_WhenAtan2_ThenMatchesLibm(void)
+{
+    FLOAT angle;
+    FLOAT y;
+    FLOAT x;
+    
+    for (angle = -ANGLE_PI + SWEEP_STEP; angle < ANGLE_PI; angle += SWEEP_STEP)
+    {
+        y = 2.5 * sin(angle);
+        x = 2.5 * cos(angle);
+        TEST_ASSERT_FLOAT_WITHIN(1.2e-5, atan2(y, x), Angle_Atan2(y, x));
+    }
+}
+
+void test_WhenAtan2OfZeroVector_ThenZero(void)
+{
+    TEST_ASSERT_EQUAL_FLOAT(0.0, Angle_Atan2(0.0, 0.0));
+    TEST_ASSERT_EQUAL_INT16(0, Angle_Atan2Brad(0, 0));
+}
+
+void test_WhenRadToBrad_ThenRevolutionIs65536(void)
+{
+    TEST_ASSERT_EQUAL_INT16(0, Angle_RadToBrad(0.0));
+    TEST_ASSERT_EQUAL_INT16(ANGLE_BRAD_HALFPI, Angle_RadToBrad(ANGLE_HALFPI));
+    TEST_ASSERT_EQUAL_INT16(-ANGLE_BRAD_HALFPI, Angle_RadToBrad(-ANGLE_HALFPI));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4, ANGLE_HALFPI, Angle_BradToRad(ANGLE_BRAD_HALFPI));
+}
+
+void test_WhenSinCosQ15_ThenMatchesLibm(void)
+{
+    INT32 brad;
+    FLOAT angle;
+    
+    for (brad = -32768; brad < 32768; brad += 7)
+    {
+        angle = Angle_BradToRad((ANGLE_BRAD_TYPE) brad);
+        TEST_ASSERT_INT16_WITHIN(4, (INT16) lround(sin(angle) * ANGLE_Q15_ONE), Angle_SinQ15((ANGLE_BRAD_TYPE) brad));
+        TEST_ASSERT_INT16_WITHIN(4, (INT16) lround(cos(angle) * ANGLE_Q15_ONE), Angle_CosQ15((ANGLE_BRAD_TYPE) brad));
+    }
+}
+
+void test_WhenAtan2Brad_ThenMatchesLibm(void)
+{
+    FLOAT angle;
+    INT16 expected;
+    INT16 actual;
+    
+    for (angle = -ANGLE_PI + SWEEP_STEP; angle < ANGLE_PI; angle += SWEEP_STEP)
+    {
+        expected = Angle_RadToBrad(angle);
+        actual = Angle_Atan2Brad((INT32) (100000 * sin(angle)), (INT32) (100000 * cos(angle)));
+        /* Note: the difference is taken as a brad so that it wraps at +/-PI */
+        TEST_ASSERT_INT16_WITHIN(45, 0, (INT16) (actual - expected));
+    }
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "arena.h"
+
+void setUp(void)
+{
+    Arena_Init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenBlocksAllocated_ThenAlignedAndZeroed(void)
+{
+    UINT8 *p_first;
+    UINT8 *p_second;
+
+    p_first = Arena_Alloc(ARENA_OWNER_CALMOTOR, 5);
+    p_first[0] = 0xAA;
+    p_second = Arena_Alloc(ARENA_OWNER_CALMOTOR, 8);
+
+    TEST_ASSERT_NOT_NULL(p_first);
+    TEST_ASSERT_EQUAL_PTR(p_first + 8, p_second);
+    TEST_ASSERT_EQUAL_UINT8(0, p_second[0]);
+    TEST_ASSERT_EQUAL_UINT16(16, Arena_GetUsed());
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_CALMOTOR, Arena_GetOwner());
+}
+
+void test_WhenOwnedByAnotherModule_ThenAllocFails(void)
+{
+    Arena_Alloc(ARENA_OWNER_CALMOTOR, 16);
+
+    TEST_ASSERT_NULL(Arena_Alloc(ARENA_OWNER_CALPID, 16));
+
+    Arena_Release(ARENA_OWNER_CALPID);
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_CALMOTOR, Arena_GetOwner());
+
+    Arena_Release(ARENA_OWNER_CALMOTOR);
+    TEST_ASSERT_NOT_NULL(Arena_Alloc(ARENA_OWNER_CALPID, 16));
+}
+
+void test_WhenBlockDoesNotFit_ThenAllocFails(void)
+{
+    TEST_ASSERT_NOT_NULL(Arena_Alloc(ARENA_OWNER_CALPID, ARENA_SIZE));
+    TEST_ASSERT_NULL(Arena_Alloc(ARENA_OWNER_CALPID, 1));
+
+    Arena_Release(ARENA_OWNER_CALPID);
+
+    TEST_ASSERT_EQUAL_UINT16(0, Arena_GetUsed());
+    TEST_ASSERT_EQUAL_UINT16(ARENA_SIZE, Arena_GetPeak());
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "calmotor.h"
+#include "arena.h"
+#include "caltable.h"
+#include "mock_motor.h"
+#include "mock_encoder.h"
+#include "mock_time.h"
+#include "mock_serial.h"
+#include "mock_cal.h"
+#include "mock_pidbank.h"
+
+#define MAX_DWELL (250)     /* PWM_TEST_TIME, the maximum dwell per pwm step (millisecond) */
+#define MAX_STEPS (2 * CAL_NUM_SAMPLES)
+#define MAX_UPDATES (100000)
+
+/* The simulated left wheel: the speed follows the pwm immediately, optionally with alternating counts
+   added on each encoder read so that the count/sec samples never settle.
+*/
+static UINT32 now;
+static PWM_TYPE pwm;
+static FLOAT cps_per_pwm;
+static FLOAT position;
+static INT32 jitter;
+static UINT8 num_reads;
+
+static UINT32 step_start[MAX_STEPS];
+static UINT8 num_steps;
+static CAL_DATA_TYPE motor_data[2];
+static CAL_MOTOR_MODEL_TYPE motor_model;
+
+static UINT32 Millis(int cmock_num_calls)
+{
+    return now;
+}
+
+static void LeftSetPwm(PWM_TYPE value, int cmock_num_calls)
+{
+    pwm = value;
+    if (value != PWM_STOP && num_steps < MAX_STEPS)
+    {
+        step_start[num_steps++] = now;
+    }
+}
+
+static INT32 LeftGetRawCount(int cmock_num_calls)
+{
+    num_reads++;
+    return (INT32) position + (num_reads % 2 ? jitter : 0);
+}
+
+static void SetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_DATA_TYPE* data, int cmock_num_calls)
+{
+    memcpy(&motor_data[dir], data, sizeof(CAL_DATA_TYPE));
+}
+
+static CAL_MOTOR_MODEL_TYPE* GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, int cmock_num_calls)
+{
+    return &motor_model;
+}
+
+/* Runs the left wheel calibration, one update per millisecond, and returns the number of steps */
+static UINT8 RunCalibration(FLOAT cps, INT32 counts)
+{
+    UINT32 ii;
+    UINT8 result;
+
+    cps_per_pwm = cps;
+    jitter = counts;
+
+    TEST_ASSERT_TRUE(CalMotor_Init(WHEEL_LEFT, 1, FALSE));
+
+    result = CAL_OK;
+    for (ii = 0; ii < MAX_UPDATES && result != CAL_COMPLETE; ++ii)
+    {
+        result = CalMotor_Update();
+        now++;
+        position += cps_per_pwm * ((INT16) pwm - PWM_STOP) / 1000.0;
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(CAL_COMPLETE, result);
+
+    return num_steps;
+}
+
+void setUp(void)
+{
+    now = 0;
+    pwm = PWM_STOP;
+    position = 0.0;
+    num_reads = 0;
+    num_steps = 0;
+    memset(motor_data, 0, sizeof motor_data);
+    memset(&motor_model, 0, sizeof motor_model);
+
+    Arena_Init();
+
+    millis_StubWithCallback(Millis);
+    Motor_SetPwm_Ignore();
+    Motor_LeftSetPwm_StubWithCallback(LeftSetPwm);
+    Motor_LeftRampDown_Ignore();
+    Motor_LeftRampDone_IgnoreAndReturn(TRUE);
+    Encoder_LeftReset_Ignore();
+    Encoder_LeftGetRawCount_StubWithCallback(LeftGetRawCount);
+    Ser_PutString_Ignore();
+    Ser_PutStringFormat_Ignore();
+    Cal_SetMotorData_StubWithCallback(SetMotorData);
+    Cal_SetMotorModel_Ignore();
+    Cal_GetMotorModel_StubWithCallback(GetMotorModel);
+    Cal_PrintMotorModel_Ignore();
+    PidBank_LoadFeedforward_Ignore();
+}
+
+void tearDown(void)
+{
+    CalMotor_Release();
+}
+
+void test_WhenSpeedIsSteady_ThenStepsSettleBeforeMaxDwell(void)
+{
+    UINT8 ii;
+    UINT8 steps;
+
+    steps = RunCalibration(10.0, 0);
+
+    TEST_ASSERT_EQUAL_UINT8(MAX_STEPS - 2, steps);
+    for (ii = 1; ii < steps; ++ii)
+    {
+        TEST_ASSERT_TRUE(step_start[ii] - step_start[ii - 1] < MAX_DWELL);
+    }
+
+    /* The count/sec follows the pwm: 10 count/sec per pwm */
+    TEST_ASSERT_INT_WITHIN(80, 10 * (motor_data[DIR_FORWARD].pwm_data[CAL_NUM_SAMPLES - 1] - PWM_STOP),
+                           motor_data[DIR_FORWARD].cps_data[CAL_NUM_SAMPLES - 1]);
+    TEST_ASSERT_INT_WITHIN(80, 10 * (motor_data[DIR_BACKWARD].pwm_data[0] - PWM_STOP),
+                           motor_data[DIR_BACKWARD].cps_data[0]);
+    TEST_ASSERT_TRUE(CalMotor_GetConfidence(WHEEL_LEFT, 0) > 90);
+}
+
+void test_WhenSpeedIsNoisy_ThenStepsRunToMaxDwell(void)
+{
+    UINT8 ii;
+    UINT8 steps;
+
+    /* Alternating 20 counts per sample is ~770 count/sec of noise */
+    steps = RunCalibration(10.0, 20);
+
+    TEST_ASSERT_EQUAL_UINT8(MAX_STEPS - 2, steps);
+    for (ii = 1; ii < steps; ++ii)
+    {
+        /* Note: the last step of a direction is followed by the ramp down */
+        TEST_ASSERT_TRUE(step_start[ii] - step_start[ii - 1] >= MAX_DWELL);
+    }
+
+    /* The count/sec is the mean of the window, but the confidence is low */
+    TEST_ASSERT_INT_WITHIN(80, 10 * (motor_data[DIR_BACKWARD].pwm_data[0] - PWM_STOP),
+                           motor_data[DIR_BACKWARD].cps_data[0]);
+    TEST_ASSERT_TRUE(CalMotor_GetConfidence(WHEEL_LEFT, 0) < 90);
+}
+
+void test_WhenWheelDoesNotTurn_ThenStepsSettleWithFullConfidence(void)
+{
+    UINT8 ii;
+    UINT8 steps;
+
+    /* Zero mean and zero variance */
+    steps = RunCalibration(0.0, 0);
+
+    for (ii = 1; ii < steps; ++ii)
+    {
+        TEST_ASSERT_TRUE(step_start[ii] - step_start[ii - 1] < MAX_DWELL);
+    }
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        TEST_ASSERT_EQUAL_INT16(0, motor_data[DIR_FORWARD].cps_data[ii]);
+        TEST_ASSERT_EQUAL_INT16(0, motor_data[DIR_BACKWARD].cps_data[ii]);
+    }
+
+    /* Note: the backward sweep was the last, its PWM_STOP sample (the last) is not measured */
+    for (ii = 0; ii < CAL_NUM_SAMPLES - 1; ++ii)
+    {
+        TEST_ASSERT_EQUAL_UINT8(100, CalMotor_GetConfidence(WHEEL_LEFT, ii));
+    }
+}
+
+void test_WhenWheelJittersAroundZero_ThenNoConfidence(void)
+{
+    UINT8 ii;
+
+    /* Zero mean, but not zero variance */
+    RunCalibration(0.0, 20);
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES - 1; ++ii)
+    {
+        TEST_ASSERT_EQUAL_UINT8(0, CalMotor_GetConfidence(WHEEL_LEFT, ii));
+    }
+}
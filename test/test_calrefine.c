@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "calrefine.h"
+#include "mock_cal.h"
+#include "mock_motor.h"
+#include "mock_encoder.h"
+#include "mock_time.h"
+
+#define UPDATE_TIME      (100)      /* ms, the refine sample period */
+#define PERSIST_TIME     (300000)   /* ms, REFINE_PERSIST_TIME_MS */
+#define MAX_STEP_CPS     (5)        /* REFINE_MAX_STEP_CPS */
+#define MAX_DEVIATION    (150)      /* REFINE_MAX_DEVIATION_CPS */
+
+/* Segment 25 - 26 of the table, at its middle the errors are split equally between the entries */
+#define PWM_MID_25       (PWM_STOP + 255)
+#define CPS_MID_25       (2550.0)
+
+/* Note: time only moves forward as CalRefine_Update keeps its last update time */
+static UINT32 now;
+static PWM_TYPE left_pwm;
+static FLOAT left_cps;
+static CAL_DATA_TYPE ram_data;
+static CAL_DATA_TYPE eeprom_data;
+static UINT8 num_persists;
+
+static UINT32 Millis(int cmock_num_calls)
+{
+    return now;
+}
+
+static PWM_TYPE LeftGetPwm(int cmock_num_calls)
+{
+    return left_pwm;
+}
+
+static FLOAT LeftGetCntsPerSec(int cmock_num_calls)
+{
+    return left_cps;
+}
+
+static CAL_DATA_TYPE* GetRamMotorData(WHEEL_TYPE wheel, DIR_TYPE dir, int cmock_num_calls)
+{
+    return &ram_data;
+}
+
+static CAL_DATA_TYPE* GetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir, int cmock_num_calls)
+{
+    return &eeprom_data;
+}
+
+static void SetMotorData(WHEEL_TYPE wheel, DIR_TYPE dir, CAL_DATA_TYPE* data, int cmock_num_calls)
+{
+    TEST_ASSERT_EQUAL_PTR(&ram_data, data);
+    memcpy(&eeprom_data, data, sizeof(CAL_DATA_TYPE));
+    num_persists++;
+}
+
+/* Holds the left wheel at the pwm and count/sec for the number of refine samples */
+static void Run(PWM_TYPE pwm, FLOAT cps, UINT16 num_samples)
+{
+    UINT16 ii;
+
+    left_pwm = pwm;
+    left_cps = cps;
+    for (ii = 0; ii < num_samples; ++ii)
+    {
+        now += UPDATE_TIME;
+        CalRefine_Update();
+    }
+}
+
+/* The wheel must be held for REFINE_STEADY_COUNT samples before it is observed */
+static void RunSteady(PWM_TYPE pwm, FLOAT cps, UINT16 num_updates)
+{
+    Run(pwm, cps, 6 + num_updates);
+}
+
+void setUp(void)
+{
+    UINT8 ii;
+
+    now += PERSIST_TIME;
+    left_pwm = PWM_STOP;
+    left_cps = 0.0;
+    num_persists = 0;
+
+    /* Left forward: 10 pwm and 100 count/sec per entry */
+    memset(&ram_data, 0, sizeof ram_data);
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        ram_data.pwm_data[ii] = PWM_STOP + 10 * ii;
+        ram_data.cps_data[ii] = 100 * ii;
+    }
+    ram_data.cps_min = ram_data.cps_data[0];
+    ram_data.cps_max = ram_data.cps_data[CAL_NUM_SAMPLES - 1];
+    memcpy(&eeprom_data, &ram_data, sizeof ram_data);
+
+    millis_StubWithCallback(Millis);
+    Motor_LeftGetPwm_StubWithCallback(LeftGetPwm);
+    Motor_RightGetPwm_IgnoreAndReturn(PWM_STOP);
+    Encoder_LeftGetCntsPerSec_StubWithCallback(LeftGetCntsPerSec);
+    Encoder_RightGetCntsPerSec_IgnoreAndReturn(0.0);
+    Cal_GetCalibrationStatusBit_IgnoreAndReturn(CAL_MOTOR_BIT);
+    Cal_GetRamMotorData_StubWithCallback(GetRamMotorData);
+    Cal_GetMotorData_StubWithCallback(GetMotorData);
+    Cal_UpdateMotorTable_IgnoreAndReturn(0);
+    Cal_SetMotorData_StubWithCallback(SetMotorData);
+
+    CalRefine_Init();
+    CalRefine_Enable(TRUE);
+    CalRefine_Start();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenDisabled_ThenTableNotRefined(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    CalRefine_Enable(FALSE);
+    RunSteady(PWM_MID_25, CPS_MID_25 + 1000.0, 1);
+
+    CalRefine_GetStats(&stats);
+    TEST_ASSERT_FALSE(CalRefine_IsEnabled());
+    TEST_ASSERT_EQUAL_UINT32(0, stats.num_observations);
+    TEST_ASSERT_EQUAL_INT16(2500, ram_data.cps_data[25]);
+}
+
+void test_WhenWheelIsNotSteady_ThenTableNotRefined(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    Run(PWM_MID_25, CPS_MID_25 + 1000.0, 5);
+
+    CalRefine_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.num_observations);
+    TEST_ASSERT_EQUAL_INT16(2500, ram_data.cps_data[25]);
+}
+
+void test_WhenErrorIsLarge_ThenAdjustmentIsBoundedPerUpdate(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    RunSteady(PWM_MID_25, CPS_MID_25 + 1000.0, 1);
+
+    CalRefine_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.num_observations);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.num_updates);
+    TEST_ASSERT_EQUAL_INT16(2500 + MAX_STEP_CPS, ram_data.cps_data[25]);
+    TEST_ASSERT_EQUAL_INT16(2600 + MAX_STEP_CPS, ram_data.cps_data[26]);
+    TEST_ASSERT_EQUAL_INT16(2400, ram_data.cps_data[24]);
+    TEST_ASSERT_EQUAL_INT16(2700, ram_data.cps_data[27]);
+}
+
+void test_WhenErrorPersists_ThenDeviationFromEepromIsBounded(void)
+{
+    RunSteady(PWM_MID_25, CPS_MID_25 + 1000.0, 100);
+
+    TEST_ASSERT_EQUAL_INT16(2500 + MAX_DEVIATION, ram_data.cps_data[25]);
+
+    /* Note: the upper entry is held at the next entry before it reaches the bound */
+    TEST_ASSERT_EQUAL_INT16(2700, ram_data.cps_data[26]);
+}
+
+void test_WhenErrorIsWithinNoise_ThenTableNotChanged(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    RunSteady(PWM_MID_25, CPS_MID_25 + 10.0, 1);
+
+    CalRefine_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.num_observations);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.num_updates);
+    TEST_ASSERT_EQUAL_INT16(2500, ram_data.cps_data[25]);
+}
+
+void test_WhenAdjustmentPassesNeighbor_ThenTableStaysAscending(void)
+{
+    UINT8 ii;
+
+    /* The entry below is 2 count/sec under the entry being lowered */
+    ram_data.cps_data[24] = 2498;
+    eeprom_data.cps_data[24] = 2498;
+
+    RunSteady(PWM_MID_25, CPS_MID_25 - 1000.0, 1);
+
+    TEST_ASSERT_EQUAL_INT16(2498, ram_data.cps_data[25]);
+    TEST_ASSERT_EQUAL_INT16(2600 - MAX_STEP_CPS, ram_data.cps_data[26]);
+    for (ii = 1; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        TEST_ASSERT_TRUE(ram_data.cps_data[ii] >= ram_data.cps_data[ii - 1]);
+    }
+}
+
+void test_WhenPwmIsNearStop_ThenStopEntryNotChanged(void)
+{
+    /* Segment 0 - 1, close to the stop entry */
+    RunSteady(PWM_STOP + 9, 900.0 + 1000.0, 1);
+
+    TEST_ASSERT_EQUAL_INT16(0, ram_data.cps_data[0]);
+    TEST_ASSERT_EQUAL_INT16(100 + MAX_STEP_CPS, ram_data.cps_data[1]);
+}
+
+void test_WhenTableRefined_ThenPersistedPeriodicallyWhileStopped(void)
+{
+    CAL_REFINE_STATS_TYPE stats;
+
+    RunSteady(PWM_MID_25, CPS_MID_25 + 1000.0, 1);
+    TEST_ASSERT_EQUAL_UINT8(0, num_persists);
+
+    /* Not while the wheel is moving */
+    Run(PWM_MID_25, CPS_MID_25, PERSIST_TIME / UPDATE_TIME);
+    TEST_ASSERT_EQUAL_UINT8(0, num_persists);
+
+    /* Once stopped and the persist time has passed */
+    Run(PWM_STOP, 0.0, 1);
+    TEST_ASSERT_EQUAL_UINT8(1, num_persists);
+    TEST_ASSERT_EQUAL_INT16(2500 + MAX_STEP_CPS, eeprom_data.cps_data[25]);
+
+    /* Nothing to persist until the table is refined again */
+    Run(PWM_STOP, 0.0, PERSIST_TIME / UPDATE_TIME);
+    TEST_ASSERT_EQUAL_UINT8(1, num_persists);
+
+    CalRefine_GetStats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.num_persists);
+}
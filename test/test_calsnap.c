@@ -0,0 +1,304 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include "unity.h"
+#include "calsnap.h"
+#include "calstore.h"
+#include "arena.h"
+#include "mock_nvstore.h"
+#include "mock_cal.h"
+#include "mock_pidbank.h"
+#include "mock_rate.h"
+#include "mock_emit.h"
+
+#define BIAS_OFFSET  (offsetof(CAL_EEPROM_TYPE, linear_bias))
+#define RATES_OFFSET (offsetof(CAL_EEPROM_TYPE, rates))
+
+UINT8 nvstore_test_eeprom[NVSTORE_CAL_EEPROM_SIZE];
+
+static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static UINT8 snapshot[CALSNAP_MAX_SIZE];
+static UINT16 snapshot_length;
+
+static UINT8 written[sizeof(CAL_EEPROM_TYPE)];
+static UINT8 num_writes;
+static UINT16 status_set;
+static UINT16 status_cleared;
+static BOOL rates_valid;
+static UINT8 num_feedforward_loads;
+
+static void WriteBytes(UINT8* const bytes, UINT16 num_bytes, UINT16 offset, int cmock_num_calls)
+{
+    memcpy(&written[offset], bytes, num_bytes);
+    num_writes++;
+}
+
+static void SetStatusBit(UINT16 bit, int cmock_num_calls)
+{
+    status_set |= bit;
+}
+
+static void ClearStatusBit(UINT16 bit, int cmock_num_calls)
+{
+    status_cleared |= bit;
+}
+
+static void LoadFeedforward(int cmock_num_calls)
+{
+    num_feedforward_loads++;
+}
+
+static BOOL IsPidScheduleValid(CAL_PID_SCHED_TYPE* const sched, int cmock_num_calls)
+{
+    return TRUE;
+}
+
+static BOOL IsRateValid(UINT16 enc_rate, UINT16 pid_rate, UINT16 odom_rate, UINT16 outer_rate, int cmock_num_calls)
+{
+    return rates_valid;
+}
+
+static void BeginSnapshot(UINT8 sections, UINT16 status)
+{
+    CALSNAP_HEADER_TYPE header = {CALSNAP_MAGIC, CALSNAP_VERSION, sections, status, 0};
+
+    memcpy(snapshot, &header, sizeof header);
+    snapshot_length = sizeof header;
+}
+
+static void AddRecord(UINT16 offset, void const * const bytes, UINT16 size)
+{
+    CALSNAP_RECORD_TYPE record = {offset, size};
+
+    memcpy(&snapshot[snapshot_length], &record, sizeof record);
+    snapshot_length += sizeof record;
+    memcpy(&snapshot[snapshot_length], bytes, size);
+    snapshot_length += size;
+}
+
+static void EndSnapshot()
+{
+    CALSNAP_HEADER_TYPE *p_header = (CALSNAP_HEADER_TYPE *) snapshot;
+    UINT16 crc;
+
+    p_header->length = snapshot_length - sizeof(CALSNAP_HEADER_TYPE);
+    crc = CalSnap_Crc16(0xFFFF, snapshot, snapshot_length);
+    memcpy(&snapshot[snapshot_length], &crc, sizeof crc);
+    snapshot_length += sizeof crc;
+}
+
+/* Imports the snapshot as base64 chunks, as sent by the host */
+static CALSNAP_RESULT_TYPE Import()
+{
+    CALSNAP_RESULT_TYPE result;
+    char chunk[CALSNAP_CHUNK_LENGTH + 1];
+    UINT8 length = 0;
+    UINT32 bits;
+    UINT16 ii;
+    UINT8 jj;
+    UINT8 num_bytes;
+
+    result = CalSnap_ImportBegin();
+    for (ii = 0; ii < snapshot_length && result == CALSNAP_OK; ii += 3)
+    {
+        num_bytes = snapshot_length - ii < 3 ? snapshot_length - ii : 3;
+        bits = 0;
+        for (jj = 0; jj < 3; ++jj)
+        {
+            bits = (bits << 8) | (jj < num_bytes ? snapshot[ii + jj] : 0);
+        }
+        for (jj = 0; jj < 4; ++jj)
+        {
+            chunk[length++] = jj <= num_bytes ? base64_chars[(bits >> (18 - 6 * jj)) & 0x3F] : '=';
+        }
+
+        if (length == CALSNAP_CHUNK_LENGTH || ii + 3 >= snapshot_length)
+        {
+            chunk[length] = '\0';
+            result = CalSnap_ImportData(chunk);
+            length = 0;
+        }
+    }
+
+    return result;
+}
+
+static void AddBias(FLOAT linear, FLOAT angular)
+{
+    FLOAT bias[2] = {linear, angular};
+
+    AddRecord(BIAS_OFFSET, bias, sizeof bias);
+}
+
+void setUp(void)
+{
+    memset(written, 0, sizeof written);
+    num_writes = 0;
+    status_set = 0;
+    status_cleared = 0;
+    rates_valid = TRUE;
+    num_feedforward_loads = 0;
+
+    Nvstore_WriteBytes_StubWithCallback(WriteBytes);
+    Cal_SetCalibrationStatusBit_StubWithCallback(SetStatusBit);
+    Cal_ClearCalibrationStatusBit_StubWithCallback(ClearStatusBit);
+    Cal_IsPidScheduleValid_StubWithCallback(IsPidScheduleValid);
+    Cal_LoadMotorData_Ignore();
+    PidBank_Start_Ignore();
+    PidBank_LoadFeedforward_StubWithCallback(LoadFeedforward);
+    Rate_IsValid_StubWithCallback(IsRateValid);
+
+    Arena_Init();
+    CalSnap_Init();
+}
+
+void tearDown(void)
+{
+    CalSnap_ImportAbort();
+}
+
+void test_WhenCrcOfCheckString_ThenMatchesCcitt(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, CalSnap_Crc16(0xFFFF, (UINT8 const *) "123456789", 9));
+}
+
+void test_WhenAllSections_ThenSizeFitsImportBuffer(void)
+{
+    TEST_ASSERT_TRUE(CalSnap_GetSize(CALSNAP_ALL_BITS) <= CALSNAP_MAX_SIZE);
+    TEST_ASSERT_EQUAL_UINT16(8 + 4 + 8 + 2, CalSnap_GetSize(CALSNAP_BIAS_BIT));
+}
+
+void test_WhenValidSnapshotCommitted_ThenWrittenAndStatusSet(void)
+{
+    FLOAT bias[2];
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_BIAS_BIT, CAL_LINEAR_BIT | CAL_MOTOR_BIT);
+    AddBias(1.02, 0.97);
+    EndSnapshot();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_OK, Import());
+    TEST_ASSERT_EQUAL_INT(snapshot_length, CalSnap_GetImportLength());
+    TEST_ASSERT_EQUAL_INT(CALSNAP_OK, CalSnap_ImportCommit(&sections));
+
+    memcpy(bias, &written[BIAS_OFFSET], sizeof bias);
+    TEST_ASSERT_EQUAL_INT(1, num_writes);
+    TEST_ASSERT_EQUAL_FLOAT(1.02, bias[0]);
+    TEST_ASSERT_EQUAL_FLOAT(0.97, bias[1]);
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BIAS_BIT, sections);
+    /* Only the status bits of the imported sections are changed */
+    TEST_ASSERT_EQUAL_UINT16(CAL_LINEAR_BIT, status_set);
+    TEST_ASSERT_EQUAL_UINT16(CAL_ANGULAR_BIT, status_cleared);
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_NONE, Arena_GetOwner());
+}
+
+void test_WhenMotorSectionCommitted_ThenFeedforwardLoaded(void)
+{
+    static UINT8 zeros[4 * sizeof(CAL_DATA_TYPE)];
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_MOTOR_BIT, CAL_MOTOR_BIT);
+    AddRecord(offsetof(CAL_EEPROM_TYPE, left_table_fwd), zeros, 4 * sizeof(CAL_TABLE_TYPE));
+    AddRecord(offsetof(CAL_EEPROM_TYPE, left_model_fwd), zeros, 4 * sizeof(CAL_MOTOR_MODEL_TYPE));
+    AddRecord(offsetof(CAL_EEPROM_TYPE, left_motor_fwd), zeros, 4 * sizeof(CAL_DATA_TYPE));
+    EndSnapshot();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_OK, Import());
+    TEST_ASSERT_EQUAL_INT(CALSNAP_OK, CalSnap_ImportCommit(&sections));
+
+    TEST_ASSERT_EQUAL_INT(3, num_writes);
+    TEST_ASSERT_EQUAL_INT(1, num_feedforward_loads);
+}
+
+void test_WhenCrcCorrupted_ThenNothingWritten(void)
+{
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_BIAS_BIT, CAL_LINEAR_BIT);
+    AddBias(1.02, 0.97);
+    EndSnapshot();
+    snapshot[snapshot_length - 3] ^= 0x01;
+
+    Import();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_CRC, CalSnap_ImportCommit(&sections));
+    TEST_ASSERT_EQUAL_INT(0, num_writes);
+    TEST_ASSERT_EQUAL_UINT16(0, status_set | status_cleared);
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_NONE, Arena_GetOwner());
+}
+
+void test_WhenSectionRecordMissing_ThenBadRecord(void)
+{
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_BIAS_BIT | CALSNAP_RATE_BIT, 0);
+    AddBias(1.0, 1.0);
+    EndSnapshot();
+
+    Import();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_RECORD, CalSnap_ImportCommit(&sections));
+    TEST_ASSERT_EQUAL_INT(0, num_writes);
+}
+
+void test_WhenRecordDoesNotMatchLayout_ThenBadRecord(void)
+{
+    FLOAT bias = 1.0;
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_BIAS_BIT, 0);
+    AddRecord(BIAS_OFFSET, &bias, sizeof bias);
+    EndSnapshot();
+
+    Import();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_RECORD, CalSnap_ImportCommit(&sections));
+    TEST_ASSERT_EQUAL_INT(0, num_writes);
+}
+
+void test_WhenValuesInvalid_ThenBadContent(void)
+{
+    CAL_RATE_TYPE rates = {100, 200, 50, 25};
+    UINT8 sections = 0;
+
+    BeginSnapshot(CALSNAP_BIAS_BIT | CALSNAP_RATE_BIT, 0);
+    AddBias(NAN, 1.0);
+    AddRecord(RATES_OFFSET, &rates, sizeof rates);
+    EndSnapshot();
+    Import();
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_CONTENT, CalSnap_ImportCommit(&sections));
+
+    rates_valid = FALSE;
+    BeginSnapshot(CALSNAP_RATE_BIT, 0);
+    AddRecord(RATES_OFFSET, &rates, sizeof rates);
+    EndSnapshot();
+    Import();
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_CONTENT, CalSnap_ImportCommit(&sections));
+
+    TEST_ASSERT_EQUAL_INT(0, num_writes);
+}
+
+void test_WhenDataNotBase64_ThenBadEncoding(void)
+{
+    TEST_ASSERT_EQUAL_INT(CALSNAP_NOT_STARTED, CalSnap_ImportData("Q1MB"));
+
+    CalSnap_ImportBegin();
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_ENCODING, CalSnap_ImportData("Q1M"));
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_ENCODING, CalSnap_ImportData("Q1M*"));
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_ENCODING, CalSnap_ImportData("Q=MB"));
+    TEST_ASSERT_EQUAL_INT(CALSNAP_OK, CalSnap_ImportData("Q1M="));
+    /* Nothing may follow the padding */
+    TEST_ASSERT_EQUAL_INT(CALSNAP_BAD_ENCODING, CalSnap_ImportData("Q1MB"));
+    TEST_ASSERT_EQUAL_INT(2, CalSnap_GetImportLength());
+}
+
+void test_WhenArenaInUse_ThenImportNotStarted(void)
+{
+    Arena_Alloc(ARENA_OWNER_CALMOTOR, 16);
+
+    TEST_ASSERT_EQUAL_INT(CALSNAP_NO_MEMORY, CalSnap_ImportBegin());
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_CALMOTOR, Arena_GetOwner());
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "caltable.h"
+
+static CAL_DATA_TYPE cal_data;
+static CAL_TABLE_TYPE cal_table;
+static CAL_TABLE_EVAL_TYPE cal_eval;
+
+/* Builds a forward table with a deadband of 40 pwm and a response that flattens towards full speed */
+static void BuildForwardData(INT16 sign)
+{
+    UINT8 ii;
+    UINT16 offset;
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        offset = CalTable_SampleOffset(ii, 500);
+        cal_data.pwm_data[ii] = PWM_STOP + sign * offset;
+        cal_data.cps_data[ii] = offset < 40 ? 0 : (INT16) ((offset - 40) * (1000 - offset) / 100);
+    }
+    cal_data.cps_min = cal_data.cps_data[0];
+    cal_data.cps_max = cal_data.cps_data[CAL_NUM_SAMPLES - 1];
+}
+
+void setUp(void)
+{
+    memset(&cal_data, 0, sizeof(cal_data));
+    memset(&cal_table, 0, sizeof(cal_table));
+    memset(&cal_eval, 0, sizeof(cal_eval));
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenSampleOffset_ThenDenseNearStopAndSparseAtFullSpeed(void)
+{
+    UINT16 first_step;
+    UINT16 last_step;
+    
+    first_step = CalTable_SampleOffset(1, 500) - CalTable_SampleOffset(0, 500);
+    last_step = CalTable_SampleOffset(CAL_NUM_SAMPLES - 1, 500) - CalTable_SampleOffset(CAL_NUM_SAMPLES - 2, 500);
+
+    TEST_ASSERT_EQUAL_UINT16(0, CalTable_SampleOffset(0, 500));
+    TEST_ASSERT_EQUAL_UINT16(500, CalTable_SampleOffset(CAL_NUM_SAMPLES - 1, 500));
+    TEST_ASSERT_TRUE(first_step < last_step);
+    TEST_ASSERT_TRUE(first_step > 0);
+}
+
+void test_WhenCompressAllZeroData_ThenTableInvalid(void)
+{
+    TEST_ASSERT_EQUAL_UINT8(0, CalTable_Compress(&cal_data, &cal_table));
+    TEST_ASSERT_FALSE(CalTable_Decode(&cal_table, &cal_eval));
+    TEST_ASSERT_EQUAL_UINT8(0, cal_eval.num_knots);
+}
+
+void test_WhenCompressForwardData_ThenFewerKnotsThanSamples(void)
+{
+    UINT8 num_knots;
+    
+    BuildForwardData(1);
+
+    num_knots = CalTable_Compress(&cal_data, &cal_table);
+    
+    TEST_ASSERT_TRUE(num_knots >= 2);
+    TEST_ASSERT_TRUE(num_knots <= CAL_TABLE_MAX_KNOTS);
+    TEST_ASSERT_EQUAL_UINT8(CAL_TABLE_VALID, cal_table.flags);
+    TEST_ASSERT_TRUE(CalTable_Decode(&cal_table, &cal_eval));
+    TEST_ASSERT_EQUAL_UINT8(num_knots, cal_eval.num_knots);
+}
+
+void test_WhenEvaluateCompressedTable_ThenWithinTolerance(void)
+{
+    UINT8 ii;
+    INT16 pwm;
+    
+    BuildForwardData(1);
+    CalTable_Compress(&cal_data, &cal_table);
+    CalTable_Decode(&cal_table, &cal_eval);
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        if (cal_data.cps_data[ii] > 0)
+        {
+            pwm = (INT16) CalTable_CpsToPwm(&cal_eval, cal_data.cps_data[ii]);
+            TEST_ASSERT_INT16_WITHIN(4, cal_data.pwm_data[ii], pwm);
+        }
+    }
+}
+
+void test_WhenEvaluateDescendingTable_ThenWithinTolerance(void)
+{
+    UINT8 ii;
+    INT16 pwm;
+    
+    BuildForwardData(-1);
+    CalTable_Compress(&cal_data, &cal_table);
+    
+    TEST_ASSERT_EQUAL_UINT8(CAL_TABLE_VALID | CAL_TABLE_DESCENDING, cal_table.flags);
+    TEST_ASSERT_TRUE(CalTable_Decode(&cal_table, &cal_eval));
+
+    for (ii = 0; ii < CAL_NUM_SAMPLES; ++ii)
+    {
+        if (cal_data.cps_data[ii] > 0)
+        {
+            pwm = (INT16) CalTable_CpsToPwm(&cal_eval, cal_data.cps_data[ii]);
+            TEST_ASSERT_INT16_WITHIN(4, cal_data.pwm_data[ii], pwm);
+        }
+    }
+}
+
+void test_WhenLowCps_ThenDeadbandEdge(void)
+{
+    BuildForwardData(1);
+    CalTable_Compress(&cal_data, &cal_table);
+    CalTable_Decode(&cal_table, &cal_eval);
+
+    /* The first knot is the last pwm with zero count/sec */
+    TEST_ASSERT_EQUAL_INT16(0, cal_eval.cps[0]);
+    TEST_ASSERT_TRUE(cal_eval.pwm[0] > PWM_STOP);
+    TEST_ASSERT_TRUE(CalTable_CpsToPwm(&cal_eval, 1) >= cal_eval.pwm[0]);
+}
+
+void test_WhenCpsOutOfRange_ThenLimited(void)
+{
+    BuildForwardData(1);
+    CalTable_Compress(&cal_data, &cal_table);
+    CalTable_Decode(&cal_table, &cal_eval);
+
+    TEST_ASSERT_EQUAL_UINT16(cal_data.pwm_data[CAL_NUM_SAMPLES - 1], CalTable_CpsToPwm(&cal_eval, 32000));
+    TEST_ASSERT_EQUAL_UINT16(cal_eval.pwm[0], CalTable_CpsToPwm(&cal_eval, -100));
+}
+
+void test_WhenCorruptTable_ThenDecodeFails(void)
+{
+    BuildForwardData(1);
+    CalTable_Compress(&cal_data, &cal_table);
+    
+    cal_table.cps_knots[1] = cal_table.cps_knots[0];
+    
+    TEST_ASSERT_FALSE(CalTable_Decode(&cal_table, &cal_eval));
+    TEST_ASSERT_EQUAL_UINT8(0, cal_eval.num_knots);
+}
@@ -0,0 +1,64 @@
+#include <stdio.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "caltune.h"
+#include "mock_cal.h"
+#include "mock_control.h"
+#include "mock_encoder.h"
+#include "mock_pid.h"
+#include "mock_pidbank.h"
+#include "mock_serial.h"
+#include "mock_time.h"
+#include "mock_utils.h"
+#include "mock_assertion.h"
+
+void setUp(void)
+{
+    assertion_Ignore();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenRuleNameIsKnown_ThenRuleIsParsed(void)
+{
+    CAL_TUNE_RULE_TYPE rule;
+
+    TEST_ASSERT_TRUE(CalTune_ParseRule("zn", &rule));
+    TEST_ASSERT_EQUAL_INT(CAL_TUNE_RULE_ZN, rule);
+
+    TEST_ASSERT_TRUE(CalTune_ParseRule("tl-pi", &rule));
+    TEST_ASSERT_EQUAL_INT(CAL_TUNE_RULE_TL_PI, rule);
+}
+
+void test_WhenRuleNameIsUnknown_ThenRuleIsNotParsed(void)
+{
+    CAL_TUNE_RULE_TYPE rule;
+
+    TEST_ASSERT_FALSE(CalTune_ParseRule("foo", &rule));
+}
+
+void test_WhenZieglerNichols_ThenClassicGains(void)
+{
+    CAL_PID_TYPE gains;
+
+    /* Kp = 0.6 Ku, Ti = Tu / 2, Td = Tu / 8 */
+    CalTune_ComputeGains(CAL_TUNE_RULE_ZN, 5.0, 0.4, &gains);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3.0, gains.kp);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 15.0, gains.ki);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.15, gains.kd);
+}
+
+void test_WhenTyreusLuybenPi_ThenNoDerivativeGain(void)
+{
+    CAL_PID_TYPE gains;
+
+    /* Kp = Ku / 3.2, Ti = 2.2 Tu */
+    CalTune_ComputeGains(CAL_TUNE_RULE_TL_PI, 5.0, 0.4, &gains);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 1.5625, gains.kp);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 1.776, gains.ki);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, gains.kd);
+}
@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "conparser.h"
+
+
+static DocoptArgs args;
+static char line[128];
+
+static CONPARSER_RESULT_TYPE Parse(const char *text)
+{
+    strcpy(line, text);
+    return ConParser_Parse(line, &args);
+}
+
+void setUp(void)
+{
+    memset(&args, 0, sizeof args);
+    memset(line, 0, sizeof line);
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenConfigRate_ThenRouteAndOptionsSet(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("config rate --pid-rate=200 --save");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_CONFIG_RATE, args.route);
+    TEST_ASSERT_EQUAL_INT(1, args.config);
+    TEST_ASSERT_EQUAL_INT(1, args.rate);
+    TEST_ASSERT_EQUAL_INT(1, args.save);
+    TEST_ASSERT_EQUAL_STRING("200", args.pid_rate);
+    TEST_ASSERT_NULL(args.enc_rate);
+}
+
+void test_WhenSubCommandIsNotRouted_ThenGroupRouteUsed(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("motor --left-speed=0.2 --right-speed 0.3");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_MOTOR, args.route);
+    TEST_ASSERT_EQUAL_STRING("0.2", args.left_speed);
+    TEST_ASSERT_EQUAL_STRING("0.3", args.right_speed);
+}
+
+void test_WhenOptionNotGiven_ThenDefaultSet(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("motion val square left");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_MOTION_VAL, args.route);
+    TEST_ASSERT_EQUAL_INT(1, args.square);
+    TEST_ASSERT_EQUAL_INT(1, args.left);
+    TEST_ASSERT_EQUAL_STRING("1.0", args.side);
+    TEST_ASSERT_EQUAL_STRING("5", args.duration);
+}
+
+void test_WhenShortOptions_ThenLongOptionsSet(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("motor rep right -f 0.1 -o0.3 -qj");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_MOTOR_REP, args.route);
+    TEST_ASSERT_EQUAL_STRING("0.1", args.first);
+    TEST_ASSERT_EQUAL_STRING("0.3", args.second);
+    TEST_ASSERT_EQUAL_INT(1, args.no_pid);
+    TEST_ASSERT_EQUAL_INT(1, args.no_accel);
+    TEST_ASSERT_EQUAL_INT(0, args.no_control);
+}
+
+void test_WhenLongOptionAbbreviated_ThenUniquePrefixMatched(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("pid tune left --ru=tl");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_PID_TUNE, args.route);
+    TEST_ASSERT_EQUAL_STRING("tl", args.rule);
+}
+
+void test_WhenUnknownWord_ThenUnknownWordReturned(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("config frobnicate");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_UNKNOWN_WORD, result);
+}
+
+void test_WhenAmbiguousPrefix_ThenUnknownWordReturned(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("config rate --o=10");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_UNKNOWN_WORD, result);
+}
+
+void test_WhenOptionArgumentMissing_ThenMissingArgumentReturned(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("pid cascade linear --gains");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_MISSING_ARGUMENT, result);
+}
+
+void test_WhenFlagGivenArgument_ThenUnexpectedArgumentReturned(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("config bench --plain-text=1");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_UNEXPECTED_ARGUMENT, result);
+}
+
+void test_WhenKillJobId_ThenKillRouteAndIdSet(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("kill --id=3");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_KILL, args.route);
+    TEST_ASSERT_EQUAL_STRING("3", args.id);
+    TEST_ASSERT_EQUAL_STRING("kill", conparser_routes[args.route]);
+}
+
+void test_WhenMotionPathStart_ThenPathRouteAndOptionsSet(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("motion path start --linear-speed=0.3 --lookahead=0.4");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_MOTION_PATH, args.route);
+    TEST_ASSERT_EQUAL_INT(1, args.start);
+    TEST_ASSERT_EQUAL_STRING("0.3", args.linear_speed);
+    TEST_ASSERT_EQUAL_STRING("0.4", args.lookahead);
+}
+
+void test_WhenConfigImportData_ThenBase64ArgumentKept(void)
+{
+    CONPARSER_RESULT_TYPE result = Parse("config import --data=Q1MBDw+/AAA=");
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_CONFIG_IMPORT, args.route);
+    TEST_ASSERT_EQUAL_INT(1, args.import);
+    TEST_ASSERT_EQUAL_STRING("Q1MBDw+/AAA=", args.data);
+}
+
+void test_WhenCompiledCommandLoaded_ThenArgsMatchParse(void)
+{
+    UINT8 code[64];
+    UINT8 length;
+    CONPARSER_RESULT_TYPE result;
+
+    Parse("config rate --pid-rate=200 --save");
+    length = ConParser_Compile(&args, code, sizeof code);
+    memset(line, 0, sizeof line);
+    result = ConParser_Load(code, length, &args);
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, result);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_ROUTE_CONFIG_RATE, args.route);
+    TEST_ASSERT_EQUAL_INT(1, args.config);
+    TEST_ASSERT_EQUAL_INT(1, args.rate);
+    TEST_ASSERT_EQUAL_INT(1, args.save);
+    TEST_ASSERT_EQUAL_STRING("200", args.pid_rate);
+    TEST_ASSERT_NULL(args.enc_rate);
+}
+
+void test_WhenArgumentIsDefault_ThenNotCompiled(void)
+{
+    UINT8 code[64];
+    UINT8 length;
+
+    Parse("motion val square left");
+    length = ConParser_Compile(&args, code, sizeof code);
+
+    /* route, motion, val, square and left */
+    TEST_ASSERT_EQUAL_INT(5, length);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, ConParser_Load(code, length, &args));
+    TEST_ASSERT_EQUAL_STRING("1.0", args.side);
+}
+
+void test_WhenCompiledCommandDecompiled_ThenSameCommand(void)
+{
+    UINT8 code[64];
+    UINT8 recompiled[64];
+    UINT8 length;
+    char text[128];
+
+    Parse("pid tune left --rule=tl");
+    length = ConParser_Compile(&args, code, sizeof code);
+
+    TEST_ASSERT_TRUE(ConParser_Decompile(code, length, text, sizeof text) > 0);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(text, "pid tune ", 9));
+
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, Parse(text));
+    TEST_ASSERT_EQUAL_INT(length, ConParser_Compile(&args, recompiled, sizeof recompiled));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(code, recompiled, length));
+}
+
+void test_WhenCompiledCommandTruncated_ThenLoadFails(void)
+{
+    UINT8 code[64];
+    UINT8 length;
+
+    Parse("kill --id=3");
+    length = ConParser_Compile(&args, code, sizeof code);
+
+    TEST_ASSERT_EQUAL_INT(0, ConParser_Compile(&args, code, 4));
+    TEST_ASSERT_EQUAL_INT(CONPARSER_MISSING_ARGUMENT, ConParser_Load(code, length - 2, &args));
+}
@@ -1,15 +1,152 @@
 #include <stdio.h>
 #include "unity.h"
+#include "freesoc.h"
+#include "consts.h"
+#include "control.h"
+#include "utils.h"
+#include "profile.h"
+#include "angle.h"
+#include "mock_i2cif.h"
+#include "mock_motor.h"
+#include "mock_cal.h"
+#include "mock_odom.h"
+#include "mock_serial.h"
+#include "mock_debug.h"
+#include "mock_time.h"
+#include "mock_assertion.h"
+
+static FLOAT cmd_linear;
+static FLOAT cmd_angular;
+
+static void CmdVelocity(FLOAT *linear, FLOAT *angular, UINT32 *timeout)
+{
+    *linear = cmd_linear;
+    *angular = cmd_angular;
+    *timeout = 0;
+}
+
+static void RunUpdate(FLOAT linear, FLOAT angular)
+{
+    cmd_linear = linear;
+    cmd_angular = angular;
+    Control_Update();
+}
 
 void setUp(void)
 {
+    /* Note: the real UniToDiff (utils.c) asserts on its arguments */
+    assertion_Ignore();
+    millis_IgnoreAndReturn(0);
+    I2CIF_ReadDeviceControl_IgnoreAndReturn(0);
+    I2CIF_ReadDebugControl_IgnoreAndReturn(0);
+    Debug_Disable_Ignore();
+
+    Control_Init();
+    Control_Start();
+    Control_SetCommandVelocityFunc(CmdVelocity);
+    Control_EnableAcceleration(FALSE);
 }
 
 void tearDown(void)
 {
 }
 
-void test_NeedImplementation(void)
+void test_WhenCommandWithinEnvelope_ThenNotShaped(void)
+{
+    FLOAT linear;
+    FLOAT angular;
+    CONTROL_SHAPE_STATS_TYPE stats;
+
+    RunUpdate(0.1, 0.2);
+
+    Control_GetCmdVelocity(&linear, &angular);
+    Control_GetShapeStats(&stats);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.1, linear);
+    TEST_ASSERT_EQUAL_FLOAT(0.2, angular);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.events);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.updates);
+}
+
+void test_WhenCurvaturePolicyAndSaturated_ThenCurvaturePreserved(void)
+{
+    FLOAT max_linear = CalcMaxLinearVelocity();
+    FLOAT max_angular = CalcMaxAngularVelocity();
+    FLOAT linear;
+    FLOAT angular;
+    FLOAT left;
+    FLOAT right;
+
+    Control_SetShapePolicy(CONTROL_SHAPE_CURVATURE);
+    I2CIF_SetDeviceStatusBit_Expect(STATUS_CMD_SATURATED_BIT);
+    RunUpdate(max_linear, max_angular / 2);
+
+    Control_GetCmdVelocity(&linear, &angular);
+    left = Control_LeftGetCmdVelocityCps();
+    right = Control_RightGetCmdVelocityCps();
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, (max_angular / 2) / max_linear, angular / linear);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, MAX_WHEEL_COUNT_PER_SECOND, right);
+    TEST_ASSERT_TRUE(left < right);
+}
+
+void test_WhenAngularPolicyAndSaturated_ThenAngularPreserved(void)
+{
+    FLOAT max_linear = CalcMaxLinearVelocity();
+    FLOAT max_angular = CalcMaxAngularVelocity();
+    FLOAT linear;
+    FLOAT angular;
+    FLOAT right;
+
+    Control_SetShapePolicy(CONTROL_SHAPE_ANGULAR);
+    I2CIF_SetDeviceStatusBit_Expect(STATUS_CMD_SATURATED_BIT);
+    RunUpdate(max_linear, max_angular / 2);
+
+    Control_GetCmdVelocity(&linear, &angular);
+    right = Control_RightGetCmdVelocityCps();
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, max_angular / 2, angular);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, max_linear / 2, linear);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, MAX_WHEEL_COUNT_PER_SECOND, right);
+}
+
+void test_WhenAngularPolicyAndAngularExceedsEnvelope_ThenSpinInPlace(void)
 {
-    TEST_IGNORE_MESSAGE("Need to Implement Control Tests");
-}
\ No newline at end of file
+    FLOAT max_angular = CalcMaxAngularVelocity();
+    FLOAT linear;
+    FLOAT angular;
+
+    Control_SetShapePolicy(CONTROL_SHAPE_ANGULAR);
+    I2CIF_SetDeviceStatusBit_Expect(STATUS_CMD_SATURATED_BIT);
+    RunUpdate(0.1, -2 * max_angular);
+
+    Control_GetCmdVelocity(&linear, &angular);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -max_angular, angular);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, linear);
+}
+
+void test_WhenCommandSaturates_ThenEventCountedAndStatusReported(void)
+{
+    FLOAT max_linear = CalcMaxLinearVelocity();
+    CONTROL_SHAPE_STATS_TYPE stats;
+
+    I2CIF_SetDeviceStatusBit_Expect(STATUS_CMD_SATURATED_BIT);
+    RunUpdate(2 * max_linear, 0.0);
+    RunUpdate(2 * max_linear, 0.0);
+    I2CIF_ClearDeviceStatusBit_Expect(STATUS_CMD_SATURATED_BIT);
+    RunUpdate(0.0, 0.0);
+
+    Control_GetShapeStats(&stats);
+
+    TEST_ASSERT_EQUAL_UINT32(1, stats.events);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.saturated);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.updates);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2.0, stats.peak_demand);
+
+    Control_ResetShapeStats();
+    Control_GetShapeStats(&stats);
+
+    TEST_ASSERT_EQUAL_UINT32(0, stats.events);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.updates);
+}
@@ -3,6 +3,12 @@
 #include "unity.h"
 #include "disp.h"
 #include "concmd.h"
+#include "conparser.h"
+#include "mock_calsnap.h"
+#include "arena.h"
+#include "mock_serial.h"
+#include "mock_macro.h"
+#include "mock_emit.h"
 #include "mock_conconfig.h"
 #include "mock_conmotor.h"
 #include "mock_conpid.h"
@@ -12,10 +18,110 @@
 static COMMAND_TYPE cmd;
 static CONCMD_IF_TYPE *p_concmd;
 static CONCMD_IF_TYPE concmd;
+static CONCMD_IF_TYPE other_concmd;
+static UINT8 num_stops;
+static UINT8 num_results;
+static UINT8 macro_steps[2][MACRO_MAX_CODE_LENGTH];
+static UINT8 macro_step_lengths[2];
+static BOOL is_recording;
+
+static BOOL IsRecording(int cmock_num_calls)
+{
+    return is_recording;
+}
+
+static BOOL StatusRunning(void)
+{
+    return TRUE;
+}
+
+static BOOL UpdateRunning(void)
+{
+    return TRUE;
+}
+
+static BOOL UpdateDone(void)
+{
+    return FALSE;
+}
+
+static void CountStop(void)
+{
+    num_stops++;
+}
+
+static void CountResults(void)
+{
+    num_results++;
+}
+
+/* A calibration holds the arena from its start until its results are reported */
+static BOOL UpdateCalDone(void)
+{
+    Arena_Alloc(ARENA_OWNER_CALMOTOR, 16);
+    return FALSE;
+}
+
+static void ReleaseResults(void)
+{
+    Arena_Release(ARENA_OWNER_CALMOTOR);
+    num_results++;
+}
+
+static MACRO_RESULT_TYPE OpenMacro(CHAR const * const name, MACRO_CURSOR_TYPE* const cursor, int cmock_num_calls)
+{
+    memset(cursor, 0, sizeof *cursor);
+    strcpy(cursor->name, name);
+    cursor->num_steps = 2;
+    return MACRO_OK;
+}
+
+static MACRO_RESULT_TYPE NextMacroStep(MACRO_CURSOR_TYPE* const cursor, int cmock_num_calls)
+{
+    if (cursor->step >= cursor->num_steps)
+    {
+        return MACRO_NOT_FOUND;
+    }
+
+    memcpy(cursor->code, macro_steps[cursor->step], macro_step_lengths[cursor->step]);
+    cursor->length = macro_step_lengths[cursor->step];
+    cursor->step++;
+    return MACRO_OK;
+}
+
+static void CompileMacroStep(UINT8 step, const char *text)
+{
+    char line[64];
+    DocoptArgs args;
+
+    strcpy(line, text);
+    ConParser_Parse(line, &args);
+    macro_step_lengths[step] = ConParser_Compile(&args, macro_steps[step], MACRO_MAX_CODE_LENGTH);
+}
+
+static void DispatchMotionValSquare(CONCMD_IF_TYPE *p_cmd)
+{
+    COMMAND_TYPE square;
+
+    memset(&square, 0, sizeof square);
+    square.args.motion = 1;
+    square.args.val = 1;
+    square.args.square = 1;
+    square.args.left = 1;
+    square.args.side = "1.0";
+    square.args.route = CONPARSER_ROUTE_MOTION_VAL;
+
+    ConMotion_InitMotionValSquare_ExpectAndReturn(1, 1.0, p_cmd);
+
+    Disp_Dispatch(&square);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, square.is_valid);
+}
 
 
 void setUp(void)
 {
+    Macro_Init_Expect();
     ConConfig_Init_Expect();
     ConMotor_Init_Expect();
     ConPid_Init_Expect();
@@ -24,13 +130,21 @@ void setUp(void)
     ConMotor_Start_Expect();
     ConPid_Start_Expect();
     ConMotion_Start_Expect();
+    Ser_PutString_Ignore();
+    Ser_PutStringFormat_Ignore();
+    Macro_IsRecording_StubWithCallback(IsRecording);
 
+    Arena_Init();
     Disp_Init();
     Disp_Start();
 
     memset(&cmd, 0, sizeof cmd);
     p_concmd = 0;
     memset(&concmd, 0, sizeof concmd);
+    memset(&other_concmd, 0, sizeof other_concmd);
+    num_stops = 0;
+    num_results = 0;
+    is_recording = FALSE;
 }
 
 void tearDown(void)
@@ -54,6 +168,7 @@ void test_WhenValidConfigCommandButActiveCommandNotAssigned_ThenReturnsIsValidFa
     cmd.args.debug = 1;
     cmd.args.enable = 1;
     cmd.args.mask = "1";
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_DEBUG;
 
     ConConfig_InitConfigDebug_ExpectAndReturn(cmd.args.enable, 0x0001, p_concmd);
 
@@ -69,6 +184,7 @@ void test_WhenConfigDebugMaskEnable_ThenIsValidTrue(void)
     cmd.args.debug = 1;
     cmd.args.enable = 1;
     cmd.args.mask = "1";
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_DEBUG;
 
     ConConfig_InitConfigDebug_ExpectAndReturn(cmd.args.enable, 0x0001, &concmd);
 
@@ -83,6 +199,7 @@ void test_WhenConfigDebugAllEnable_ThenIsValidTrue(void)
     cmd.args.debug = 1;
     cmd.args.enable = 1;
     cmd.args.all = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_DEBUG;
 
     ConConfig_InitConfigDebug_ExpectAndReturn(cmd.args.enable, 0x03FF, &concmd);
 
@@ -103,6 +220,7 @@ void test_WhenConfigDebugBitsEnable_ThenIsValidTrue(void)
     cmd.args.lmotor = 1;
     cmd.args.rmotor = 0;
     cmd.args.odom = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_DEBUG;
 
     ConConfig_InitConfigDebug_ExpectAndReturn(TRUE, 0x0055, &concmd);
 
@@ -121,6 +239,7 @@ void test_WhenConfigShowBits_ThenIsValidTrue(void)
     cmd.args.debug = 0;
     cmd.args.params = 1;
     cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_SHOW;
 
     ConConfig_InitConfigShow_ExpectAndReturn(0x0025, cmd.args.plain_text, &concmd);
 
@@ -135,6 +254,7 @@ void test_WhenConfigClearAll_ThenIsValidTrue(void)
     cmd.args.clear = 1;
     cmd.args.all = 1;
     cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_CLEAR;
 
     ConConfig_InitConfigClear_ExpectAndReturn(0x001F, cmd.args.plain_text, &concmd);
 
@@ -152,6 +272,7 @@ void test_WhenConfigClearBits_ThenIsValidTrue(void)
     cmd.args.bias = 0;
     cmd.args.debug = 1;
     cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_CLEAR;
 
     ConConfig_InitConfigClear_ExpectAndReturn(0x000B, cmd.args.plain_text, &concmd);
 
@@ -160,6 +281,85 @@ void test_WhenConfigClearBits_ThenIsValidTrue(void)
     TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
 }
 
+void test_WhenConfigRatePidSave_ThenIsValidTrue(void)
+{
+    cmd.args.config = 1;
+    cmd.args.rate = 1;
+    cmd.args.pid_rate = "200";
+    cmd.args.save = 1;
+    cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_RATE;
+
+    ConConfig_InitConfigRate_ExpectAndReturn(INT_MIN, 200, INT_MIN, INT_MIN, cmd.args.save, cmd.args.plain_text, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenConfigBench_ThenIsValidTrue(void)
+{
+    cmd.args.config = 1;
+    cmd.args.bench = 1;
+    cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_BENCH;
+
+    ConConfig_InitConfigBench_ExpectAndReturn(cmd.args.plain_text, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenConfigAccel_ThenIsValidTrue(void)
+{
+    cmd.args.config = 1;
+    cmd.args.accel = 1;
+    cmd.args.lin_accel = "0.5";
+    cmd.args.lin_jerk = "2.0";
+    cmd.args.ang_accel = "1.5";
+    cmd.args.ang_jerk = "6.0";
+    cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_ACCEL;
+
+    ConConfig_InitConfigAccel_ExpectAndReturn(0.5, 2.0, 1.5, 6.0, cmd.args.plain_text, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenConfigShapeAngularReset_ThenIsValidTrue(void)
+{
+    cmd.args.config = 1;
+    cmd.args.shape = 1;
+    cmd.args.angular = 1;
+    cmd.args.reset = 1;
+    cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_SHAPE;
+
+    ConConfig_InitConfigShape_ExpectAndReturn(0, 1, 1, cmd.args.plain_text, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenConfigRefineEnable_ThenIsValidTrue(void)
+{
+    cmd.args.config = 1;
+    cmd.args.refine = 1;
+    cmd.args.enable = 1;
+    cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_REFINE;
+
+    ConConfig_InitConfigRefine_ExpectAndReturn(1, 0, cmd.args.plain_text, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
 /* Test Motor commands */
 
 void test_WhenValidMotorCommandButActiveCommandNotAssigned_ThenReturnsIsValidFalse(void)
@@ -168,6 +368,7 @@ void test_WhenValidMotorCommandButActiveCommandNotAssigned_ThenReturnsIsValidFal
     cmd.args.show = 1;
     cmd.args.left = 1;
     cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_SHOW;
 
     ConMotor_InitMotorShow_ExpectAndReturn(WHEEL_LEFT, cmd.args.plain_text, p_concmd);
 
@@ -182,6 +383,7 @@ void test_WhenMotorShowLeftNoPlaintext_ThenIsValidTrue(void)
     cmd.args.show = 1;
     cmd.args.left = 1;
     cmd.args.plain_text = 0;
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_SHOW;
 
     ConMotor_InitMotorShow_ExpectAndReturn(WHEEL_LEFT, cmd.args.plain_text, &concmd);
 
@@ -201,6 +403,7 @@ void test_WhenMotorRepRight_ThenIsValidTrue(void)
     cmd.args.iters = "10.0";
     cmd.args.no_pid = 0;
     cmd.args.no_accel = 0;
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_REP;
 
     ConMotor_InitMotorRepeat_ExpectAndReturn(WHEEL_RIGHT, 0.2, 0.6, 5.0, 10.0, cmd.args.no_pid, cmd.args.no_accel, &concmd);
 
@@ -216,8 +419,24 @@ void test_WhenMotorCalLeftRightIters_ThenIsValidTrue(void)
     cmd.args.left = 1;
     cmd.args.right = 1;
     cmd.args.iters = "5.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_CAL;
+
+    ConMotor_InitMotorCal_ExpectAndReturn(WHEEL_BOTH, 5.0, FALSE, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenMotorCalParallel_ThenIsValidTrue(void)
+{
+    cmd.args.motor = 1;
+    cmd.args.cal = 1;
+    cmd.args.iters = "3";
+    cmd.args.parallel = 1;
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_CAL;
 
-    ConMotor_InitMotorCal_ExpectAndReturn(WHEEL_BOTH, 5.0, &concmd);
+    ConMotor_InitMotorCal_ExpectAndReturn(WHEEL_BOTH, 3, TRUE, &concmd);
 
     Disp_Dispatch(&cmd);
 
@@ -233,6 +452,7 @@ void test_WhenMotorValLeftBackward_ThenIsValidTrue(void)
     cmd.args.min_percent = "0.2";
     cmd.args.max_percent = "0.6";
     cmd.args.num_points = "7";
+    cmd.args.route = CONPARSER_ROUTE_MOTOR_VAL;
 
     ConMotor_InitMotorVal_ExpectAndReturn(WHEEL_LEFT, DIR_BACKWARD, 0.2, 0.6, 7, &concmd);
 
@@ -249,6 +469,7 @@ void test_WhenMotorMoveLeftRight_ThenIsValidTrue(void)
     cmd.args.duration = "10.0";
     cmd.args.no_pid = 0;
     cmd.args.no_accel = 0;
+    cmd.args.route = CONPARSER_ROUTE_MOTOR;
 
     ConMotor_InitMotorMove_ExpectAndReturn(0.2, -0.2, 10.0, 0, 0, &concmd);
 
@@ -265,6 +486,7 @@ void test_WhenValidPidCommandButActiveCommandNotAssigned_ThenReturnsIsValidFalse
     cmd.args.show = 1;
     cmd.args.right = 1;
     cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_PID_SHOW;
 
     ConPid_InitPidShow_ExpectAndReturn(WHEEL_RIGHT, 1, p_concmd);
 
@@ -279,6 +501,7 @@ void test_WhenPidShowRightPlaintext_ThenIsValidTrue(void)
     cmd.args.show = 1;
     cmd.args.right = 1;
     cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_PID_SHOW;
 
     ConPid_InitPidShow_ExpectAndReturn(WHEEL_RIGHT, 1, &concmd);
 
@@ -294,8 +517,25 @@ void test_WhenPidCalLeftImpulse_ThenIsValidTrue(void)
     cmd.args.left = 1;
     cmd.args.impulse = 1;
     cmd.args.with_debug = 0;
+    cmd.args.route = CONPARSER_ROUTE_PID_CAL;
+
+    ConPid_InitPidCal_ExpectAndReturn(WHEEL_LEFT, 1, 0, 0, 0, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenPidCalRightBinary_ThenIsValidTrue(void)
+{
+    cmd.args.pid = 1;
+    cmd.args.cal = 1;
+    cmd.args.right = 1;
+    cmd.args.step = "0.5";
+    cmd.args.binary = 1;
+    cmd.args.route = CONPARSER_ROUTE_PID_CAL;
 
-    ConPid_InitPidCal_ExpectAndReturn(WHEEL_LEFT, 1, 0, 0, &concmd);
+    ConPid_InitPidCal_ExpectAndReturn(WHEEL_RIGHT, 0, 0.5, 0, 1, &concmd);
 
     Disp_Dispatch(&cmd);
 
@@ -312,6 +552,7 @@ void test_WhenPidValLeftRightForward_ThenIsValidTrue(void)
     cmd.args.min_percent = "0.2";
     cmd.args.max_percent = "0.8";
     cmd.args.num_points = "11";
+    cmd.args.route = CONPARSER_ROUTE_PID_VAL;
 
     ConPid_InitPidVal_ExpectAndReturn(WHEEL_BOTH, DIR_FORWARD, 0.2, 0.8, 11, &concmd);
 
@@ -320,6 +561,68 @@ void test_WhenPidValLeftRightForward_ThenIsValidTrue(void)
     TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
 }
 
+void test_WhenPidSchedLeftBand_ThenIsValidTrue(void)
+{
+    cmd.args.pid = 1;
+    cmd.args.sched = 1;
+    cmd.args.left = 1;
+    cmd.args.band = "1";
+    cmd.args.cps = "300";
+    cmd.args.gains = "1.5,2.0,0.1,0.9";
+    cmd.args.route = CONPARSER_ROUTE_PID_SCHED;
+
+    ConPid_InitPidSched_ExpectAndReturn(WHEEL_LEFT, 0, 1, 300, "1.5,2.0,0.1,0.9", &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenPidCascadeShow_ThenIsValidTrue(void)
+{
+    cmd.args.pid = 1;
+    cmd.args.cascade = 1;
+    cmd.args.show = 1;
+    cmd.args.plain_text = 1;
+    cmd.args.route = CONPARSER_ROUTE_PID_CASCADE;
+
+    ConPid_InitPidCascade_ExpectAndReturn(CONPID_CASCADE_SHOW, 0, NULL, 1, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenPidCascadeAngularGains_ThenIsValidTrue(void)
+{
+    cmd.args.pid = 1;
+    cmd.args.cascade = 1;
+    cmd.args.angular = 1;
+    cmd.args.gains = "0.5,1.0,0.0,0.0";
+    cmd.args.route = CONPARSER_ROUTE_PID_CASCADE;
+
+    ConPid_InitPidCascade_ExpectAndReturn(CONPID_CASCADE_GAINS, CONPID_CASCADE_ANGULAR_BIT, "0.5,1.0,0.0,0.0", 0, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenPidTuneRightWithRule_ThenIsValidTrue(void)
+{
+    cmd.args.pid = 1;
+    cmd.args.tune = 1;
+    cmd.args.right = 1;
+    cmd.args.rule = "tl";
+    cmd.args.route = CONPARSER_ROUTE_PID_TUNE;
+
+    ConPid_InitPidTune_ExpectAndReturn(WHEEL_RIGHT, "tl", &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
 /* Test Motion commands */
 
 
@@ -329,6 +632,7 @@ void test_WhenValidMotionCommandButActiveCommandNotAssigned_ThenReturnsIsValidFa
     cmd.args.cal = 1;
     cmd.args.linear = 1;
     cmd.args.distance = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_CAL;
 
     ConMotion_InitCalLinear_ExpectAndReturn(1.0, p_concmd);
 
@@ -343,6 +647,7 @@ void test_WhenMotionCalLinear_ThenIsValidTrue(void)
     cmd.args.cal = 1;
     cmd.args.linear = 1;
     cmd.args.distance = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_CAL;
 
     ConMotion_InitCalLinear_ExpectAndReturn(1.0, &concmd);
 
@@ -357,6 +662,7 @@ void test_WhenMotionCalAngular_ThenIsValidTrue(void)
     cmd.args.cal = 1;
     cmd.args.angular = 1;
     cmd.args.angle = "360.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_CAL;
 
     ConMotion_InitMotionCalAngular_ExpectAndReturn(360.0, &concmd);
 
@@ -370,6 +676,7 @@ void test_WhenMotionCalUmbmark_ThenIsValidTrue(void)
     cmd.args.motion = 1;
     cmd.args.cal = 1;
     cmd.args.umbmark = 1;
+    cmd.args.route = CONPARSER_ROUTE_MOTION_CAL;
 
     ConMotion_InitMotionCalUmbmark_ExpectAndReturn(&concmd);
 
@@ -384,6 +691,7 @@ void test_WhenMotionValLinear_ThenIsValidTrue(void)
     cmd.args.val = 1;
     cmd.args.linear = 1;
     cmd.args.distance = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_VAL;
 
     ConMotion_InitMotionValLinear_ExpectAndReturn(1.0, &concmd);
 
@@ -398,6 +706,7 @@ void test_WhenMotionValAngular_ThenIsValidTrue(void)
     cmd.args.val = 1;
     cmd.args.angular = 1;
     cmd.args.angle = "360.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_VAL;
 
     ConMotion_InitMotionValAngular_ExpectAndReturn(360.0, &concmd);
 
@@ -413,6 +722,7 @@ void test_WhenMotionValSquare_ThenisValidTrue(void)
     cmd.args.square = 1;
     cmd.args.left = 1;
     cmd.args.side = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_VAL;
 
     ConMotion_InitMotionValSquare_ExpectAndReturn(1, 1.0, &concmd);
 
@@ -428,6 +738,7 @@ void test_WhenMotionValCircle_ThenisValidTrue(void)
     cmd.args.circle = 1;
     cmd.args.cw = 1;
     cmd.args.radius = "0.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_VAL;
 
     ConMotion_InitMotionValCircle_ExpectAndReturn(1, 0.0, &concmd);
 
@@ -442,6 +753,7 @@ void test_WhenMotionValOutAndBack_ThenisValidTrue(void)
     cmd.args.val = 1;
     cmd.args.out_and_back = 1;
     cmd.args.distance = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_VAL;
 
     ConMotion_InitMotionValOutAndBack_ExpectAndReturn(1.0, &concmd);
 
@@ -450,3 +762,385 @@ void test_WhenMotionValOutAndBack_ThenisValidTrue(void)
     TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
 }
 
+void test_WhenMotionPathAdd_ThenisValidTrue(void)
+{
+    cmd.args.motion = 1;
+    cmd.args.path = 1;
+    cmd.args.add = 1;
+    cmd.args.points = "0.0,0.0,1.0,0.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTION_PATH;
+
+    ConMotion_InitMotionPath_ExpectAndReturn(CONMOTION_PATH_ADD, "0.0,0.0,1.0,0.0", NAN, NAN, FALSE, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenMotionPathStartWhileValidationRunning_ThenisValidFalse(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.motion = 1;
+    cmd.args.path = 1;
+    cmd.args.start = 1;
+    cmd.args.route = CONPARSER_ROUTE_MOTION_PATH;
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+}
+
+void test_WhenMotionPathStartWhileMotorsInUse_ThenisValidFalse(void)
+{
+    COMMAND_TYPE move;
+
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+
+    memset(&move, 0, sizeof move);
+    move.args.motor = 1;
+    move.args.left_speed = "0.2";
+    move.args.right_speed = "0.2";
+    move.args.duration = "10.0";
+    move.args.route = CONPARSER_ROUTE_MOTOR;
+    ConMotor_InitMotorMove_ExpectAndReturn(0.2, 0.2, 10.0, 0, 0, &concmd);
+    Disp_Dispatch(&move);
+    TEST_ASSERT_EQUAL_INT(TRUE, move.is_valid);
+
+    /* Only path start drives the wheels */
+    cmd.args.motion = 1;
+    cmd.args.path = 1;
+    cmd.args.show = 1;
+    cmd.args.route = CONPARSER_ROUTE_MOTION_PATH;
+    ConMotion_InitMotionPath_ExpectAndReturn(CONMOTION_PATH_SHOW, NULL, NAN, NAN, FALSE, &other_concmd);
+    Disp_Dispatch(&cmd);
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+    Disp_Update();
+
+    memset(&cmd, 0, sizeof cmd);
+    cmd.args.motion = 1;
+    cmd.args.path = 1;
+    cmd.args.start = 1;
+    cmd.args.route = CONPARSER_ROUTE_MOTION_PATH;
+    Disp_Dispatch(&cmd);
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+}
+
+void test_WhenConfigExportWithoutSections_ThenAllSectionsExported(void)
+{
+    cmd.args.config = 1;
+    cmd.args.export = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_EXPORT;
+
+    ConConfig_InitConfigExport_ExpectAndReturn(CALSNAP_ALL_BITS, FALSE, FALSE, &concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+void test_WhenConfigImportWhileValidationRunning_ThenisValidFalse(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.config = 1;
+    cmd.args.import = 1;
+    cmd.args.commit = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_IMPORT;
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+}
+
+/* Test Jobs */
+
+void test_WhenJobsDoNotShareResources_ThenBothRun(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.config = 1;
+    cmd.args.show = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_SHOW;
+
+    ConConfig_InitConfigShow_ExpectAndReturn(0, 0, &other_concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_IsRunning());
+}
+
+void test_WhenJobClaimsMotorsInUse_ThenIsValidFalse(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.motor = 1;
+    cmd.args.left_speed = "0.2";
+    cmd.args.route = CONPARSER_ROUTE_MOTOR;
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+}
+
+void test_WhenJobDone_ThenResultsReportedAndJobRemoved(void)
+{
+    BOOL is_running;
+    BOOL is_reported;
+
+    concmd.update = UpdateDone;
+    concmd.results = CountResults;
+    DispatchMotionValSquare(&concmd);
+
+    is_running = Disp_Update();
+    is_reported = Disp_Results();
+
+    TEST_ASSERT_EQUAL_INT(FALSE, is_running);
+    TEST_ASSERT_EQUAL_INT(TRUE, is_reported);
+    TEST_ASSERT_EQUAL_INT(1, num_results);
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_IsRunning());
+}
+
+void test_WhenJobStillRunning_ThenNoResultsReported(void)
+{
+    BOOL is_reported;
+
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    concmd.results = CountResults;
+    DispatchMotionValSquare(&concmd);
+
+    Disp_Update();
+    is_reported = Disp_Results();
+
+    TEST_ASSERT_EQUAL_INT(FALSE, is_reported);
+    TEST_ASSERT_EQUAL_INT(0, num_results);
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_IsRunning());
+}
+
+void test_WhenKillJobId_ThenJobStoppedAndRemoved(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    concmd.results = CountResults;
+    concmd.stop = CountStop;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.kill = 1;
+    cmd.args.id = "1";
+    cmd.args.route = CONPARSER_ROUTE_KILL;
+
+    Disp_Dispatch(&cmd);
+    Disp_Update();
+    Disp_Results();
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+    TEST_ASSERT_EQUAL_INT(1, num_stops);
+    TEST_ASSERT_EQUAL_INT(0, num_results);
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_IsRunning());
+}
+
+void test_WhenKillUnknownJobId_ThenIsValidFalse(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    concmd.stop = CountStop;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.kill = 1;
+    cmd.args.id = "7";
+    cmd.args.route = CONPARSER_ROUTE_KILL;
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+    TEST_ASSERT_EQUAL_INT(0, num_stops);
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_IsRunning());
+}
+
+void test_WhenKilledJobReleasesMotors_ThenMotorCommandRuns(void)
+{
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+    concmd.stop = CountStop;
+    DispatchMotionValSquare(&concmd);
+
+    cmd.args.kill = 1;
+    cmd.args.all = 1;
+    cmd.args.route = CONPARSER_ROUTE_KILL;
+    Disp_Dispatch(&cmd);
+    Disp_Update();
+    Disp_Results();
+
+    memset(&cmd, 0, sizeof cmd);
+    cmd.args.motor = 1;
+    cmd.args.left_speed = "0.2";
+    cmd.args.right_speed = "0.2";
+    cmd.args.duration = "1.0";
+    cmd.args.route = CONPARSER_ROUTE_MOTOR;
+
+    ConMotor_InitMotorMove_ExpectAndReturn(0.2, 0.2, 1.0, 0, 0, &other_concmd);
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(1, num_stops);
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+}
+
+/* Test Macros */
+
+void test_WhenMacroRecording_ThenCommandRecordedInsteadOfRun(void)
+{
+    cmd.args.config = 1;
+    cmd.args.bench = 1;
+    cmd.args.route = CONPARSER_ROUTE_CONFIG_BENCH;
+
+    is_recording = TRUE;
+    Macro_Record_ExpectAndReturn(&cmd.args, MACRO_OK);
+    Macro_GetResultString_IgnoreAndReturn("ok");
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_IsRunning());
+}
+
+void test_WhenMacroRun_ThenStepsRunBackToBackAndResultsReportedAtEnd(void)
+{
+    CompileMacroStep(0, "config show motor");
+    CompileMacroStep(1, "motor show left");
+
+    concmd.update = UpdateDone;
+    concmd.results = CountResults;
+    other_concmd.update = UpdateDone;
+    other_concmd.results = CountResults;
+
+    Macro_Open_StubWithCallback(OpenMacro);
+    Macro_NextStep_StubWithCallback(NextMacroStep);
+    Macro_GetResultString_IgnoreAndReturn("ok");
+    ConConfig_InitConfigShow_ExpectAndReturn(CONCONFIG_MOTOR_BIT, 0, &concmd);
+    ConMotor_InitMotorShow_ExpectAndReturn(WHEEL_LEFT, 0, &other_concmd);
+
+    cmd.args.macro = 1;
+    cmd.args.run = 1;
+    cmd.args.name = "cal";
+    cmd.args.route = CONPARSER_ROUTE_MACRO_RUN;
+
+    Disp_Dispatch(&cmd);
+    TEST_ASSERT_EQUAL_INT(TRUE, cmd.is_valid);
+
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Update());
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Update());
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(0, num_results);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_Update());
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(2, num_results);
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_IsRunning());
+}
+
+void test_WhenMacroStepOfSameModule_ThenResultsReportedBeforeStep(void)
+{
+    CompileMacroStep(0, "config show motor");
+    CompileMacroStep(1, "config bench");
+
+    concmd.update = UpdateDone;
+    concmd.results = CountResults;
+    other_concmd.update = UpdateDone;
+    other_concmd.results = CountResults;
+
+    Macro_Open_StubWithCallback(OpenMacro);
+    Macro_NextStep_StubWithCallback(NextMacroStep);
+    Macro_GetResultString_IgnoreAndReturn("ok");
+    ConConfig_InitConfigShow_ExpectAndReturn(CONCONFIG_MOTOR_BIT, 0, &concmd);
+    ConConfig_InitConfigBench_ExpectAndReturn(0, &other_concmd);
+
+    cmd.args.macro = 1;
+    cmd.args.run = 1;
+    cmd.args.name = "cfg";
+    cmd.args.route = CONPARSER_ROUTE_MACRO_RUN;
+
+    Disp_Dispatch(&cmd);
+    Disp_Update();
+    Disp_Update();
+    TEST_ASSERT_EQUAL_INT(1, num_results);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_Update());
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(2, num_results);
+}
+
+void test_WhenMacroStepHoldsArena_ThenArenaReleasedBeforeNextStep(void)
+{
+    CompileMacroStep(0, "motor cal left --iters=3");
+    CompileMacroStep(1, "pid cal left --step=0.2");
+
+    concmd.update = UpdateCalDone;
+    concmd.results = ReleaseResults;
+    other_concmd.update = UpdateDone;
+    other_concmd.results = CountResults;
+
+    Macro_Open_StubWithCallback(OpenMacro);
+    Macro_NextStep_StubWithCallback(NextMacroStep);
+    Macro_GetResultString_IgnoreAndReturn("ok");
+    ConMotor_InitMotorCal_ExpectAndReturn(WHEEL_LEFT, 3, 0, &concmd);
+    ConPid_InitPidCal_ExpectAndReturn(WHEEL_LEFT, 0, 0.2, 0, 0, &other_concmd);
+
+    cmd.args.macro = 1;
+    cmd.args.run = 1;
+    cmd.args.name = "cal";
+    cmd.args.route = CONPARSER_ROUTE_MACRO_RUN;
+
+    Disp_Dispatch(&cmd);
+    Disp_Update();
+    Disp_Update();
+    TEST_ASSERT_EQUAL_INT(1, num_results);
+    TEST_ASSERT_EQUAL_INT(ARENA_OWNER_NONE, Arena_GetOwner());
+
+    TEST_ASSERT_EQUAL_INT(FALSE, Disp_Update());
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_Results());
+    TEST_ASSERT_EQUAL_INT(2, num_results);
+}
+
+void test_WhenMacroStepsClaimMotors_ThenMotorCommandBusy(void)
+{
+    CompileMacroStep(0, "motion val square left");
+    CompileMacroStep(1, "config bench");
+
+    concmd.update = UpdateRunning;
+    concmd.status = StatusRunning;
+
+    Macro_Open_StubWithCallback(OpenMacro);
+    Macro_NextStep_StubWithCallback(NextMacroStep);
+    ConMotion_InitMotionValSquare_ExpectAndReturn(1, 1.0, &concmd);
+
+    cmd.args.macro = 1;
+    cmd.args.run = 1;
+    cmd.args.name = "square";
+    cmd.args.route = CONPARSER_ROUTE_MACRO_RUN;
+    Disp_Dispatch(&cmd);
+    Disp_Update();
+
+    memset(&cmd, 0, sizeof cmd);
+    cmd.args.motor = 1;
+    cmd.args.left_speed = "0.2";
+    cmd.args.route = CONPARSER_ROUTE_MOTOR;
+
+    Disp_Dispatch(&cmd);
+
+    TEST_ASSERT_EQUAL_INT(FALSE, cmd.is_valid);
+    TEST_ASSERT_EQUAL_INT(TRUE, Disp_IsRunning());
+}
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "unity.h"
+#include "emit.h"
+#include "mock_serial.h"
+
+static char output[512];
+static UINT16 output_length;
+static UINT8 num_writes;
+static UINT16 max_write;
+static BOOL is_busy;
+static UINT8 num_rows;
+static INT32 first_value;
+
+static BOOL WriteData(UINT8 const * const data, UINT16 length, int cmock_num_calls)
+{
+    if (is_busy)
+    {
+        return FALSE;
+    }
+
+    memcpy(output + output_length, data, length);
+    output_length += length;
+    output[output_length] = '\0';
+    num_writes++;
+    if (length > max_write)
+    {
+        max_write = length;
+    }
+    return TRUE;
+}
+
+/* A dump of rows, about three packets */
+static void EmitRows(void)
+{
+    UINT8 ii;
+
+    Emit_ArrayBegin(NULL);
+    for (ii = 0; ii < num_rows; ++ii)
+    {
+        Emit_ObjectBegin(NULL);
+        Emit_KeyInt("cps", ii == 0 ? first_value : 100 * ii);
+        Emit_KeyFixed("pwm", 1500 + ii, 1);
+        Emit_ObjectEnd();
+    }
+    Emit_ArrayEnd();
+    Emit_Newline();
+    Emit_Flush();
+}
+
+void setUp(void)
+{
+    memset(output, 0, sizeof output);
+    output_length = 0;
+    num_writes = 0;
+    max_write = 0;
+    is_busy = FALSE;
+    num_rows = 8;
+    first_value = 0;
+
+    Ser_WriteData_StubWithCallback(WriteData);
+    Ser_PutString_Ignore();
+
+    Emit_Init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenObjectsAndArraysNested_ThenSeparatorsInserted(void)
+{
+    Emit_ObjectBegin(NULL);
+    Emit_KeyString("wheel", "left");
+    Emit_KeyInt("min", -4328);
+    Emit_ArrayBegin("values");
+    Emit_ObjectBegin(NULL);
+    Emit_KeyInt("cps", 0);
+    Emit_ObjectEnd();
+    Emit_ObjectBegin(NULL);
+    Emit_KeyInt("cps", 10);
+    Emit_ObjectEnd();
+    Emit_ArrayEnd();
+    Emit_KeyBool("valid", TRUE);
+    Emit_ObjectEnd();
+    Emit_Newline();
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_STRING("{\"wheel\":\"left\",\"min\":-4328,\"values\":[{\"cps\":0},{\"cps\":10}],\"valid\":true}\r\n", output);
+}
+
+void test_WhenFixedEmitted_ThenMatchesPrintf(void)
+{
+    Emit_Fixed(1.2345, 3);
+    Emit_Char(' ');
+    Emit_Fixed(-0.0625, 2);
+    Emit_Char(' ');
+    Emit_Fixed(0.9996, 3);
+    Emit_Char(' ');
+    Emit_Fixed(59.6, 0);
+    Emit_Char(' ');
+    Emit_Fixed(0.05, 4);
+    Emit_Char(' ');
+    Emit_Fixed(NAN, 3);
+    Emit_Char(' ');
+    Emit_Fixed(1.0e10, 1);
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_STRING("1.235 -0.06 1.000 60 0.0500 nan 10000000000.0", output);
+}
+
+void test_WhenIntEmitted_ThenFullRangeFormatted(void)
+{
+    Emit_Int(0);
+    Emit_Char(' ');
+    Emit_Int(2147483647);
+    Emit_Char(' ');
+    Emit_Int(-2147483647 - 1);
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_STRING("0 2147483647 -2147483648", output);
+}
+
+void test_WhenRowsEmitted_ThenCsvWritten(void)
+{
+    Emit_RowBegin();
+    Emit_ItemString("cps");
+    Emit_ItemString("pwm");
+    Emit_RowEnd();
+    Emit_RowBegin();
+    Emit_ItemInt(-50);
+    Emit_ItemFixed(1470, 1);
+    Emit_RowEnd();
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_STRING("cps,pwm\r\n-50,1470.0\r\n", output);
+}
+
+void test_WhenBufferFills_ThenFullPacketsWritten(void)
+{
+    UINT16 ii;
+
+    for (ii = 0; ii < 3 * EMIT_BUFFER_SIZE + 1; ++ii)
+    {
+        Emit_Char('a' + ii % 26);
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, num_writes);
+    TEST_ASSERT_EQUAL_INT(EMIT_BUFFER_SIZE, max_write);
+
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_INT(4, num_writes);
+    TEST_ASSERT_EQUAL_INT(3 * EMIT_BUFFER_SIZE + 1, output_length);
+    TEST_ASSERT_EQUAL_INT('a' + (3 * EMIT_BUFFER_SIZE) % 26, output[3 * EMIT_BUFFER_SIZE]);
+}
+
+void test_WhenHexEmitted_ThenMatchesPrintf(void)
+{
+    Emit_Hex(0x5, 2);
+    Emit_Char(' ');
+    Emit_Hex(0x1234, 2);
+    Emit_Char(' ');
+    Emit_Hex(0xFFFFFFFF, 0);
+    Emit_Flush();
+
+    TEST_ASSERT_EQUAL_STRING("05 1234 ffffffff", output);
+}
+
+void test_WhenStreamChunked_ThenOnePacketPerCallAndSameOutput(void)
+{
+    EMIT_STREAM_TYPE stream;
+    char expected[512];
+    UINT8 num_calls;
+
+    EmitRows();
+    strcpy(expected, output);
+    output_length = 0;
+    num_writes = 0;
+
+    Emit_StreamInit(&stream);
+    num_calls = 1;
+    while (Emit_Chunk(&stream, EmitRows))
+    {
+        TEST_ASSERT_EQUAL_INT(num_calls, num_writes);
+        num_calls++;
+    }
+
+    TEST_ASSERT_EQUAL_INT(num_calls, num_writes);
+    TEST_ASSERT_EQUAL_INT((strlen(expected) + EMIT_BUFFER_SIZE - 1) / EMIT_BUFFER_SIZE, num_writes);
+    TEST_ASSERT_EQUAL_INT(EMIT_BUFFER_SIZE, max_write);
+    TEST_ASSERT_EQUAL_STRING(expected, output);
+}
+
+void test_WhenEndpointBusy_ThenChunkSentLater(void)
+{
+    EMIT_STREAM_TYPE stream;
+
+    Emit_StreamInit(&stream);
+    TEST_ASSERT_TRUE(Emit_Chunk(&stream, EmitRows));
+    TEST_ASSERT_EQUAL_INT(EMIT_BUFFER_SIZE, output_length);
+
+    is_busy = TRUE;
+    TEST_ASSERT_TRUE(Emit_Chunk(&stream, EmitRows));
+    TEST_ASSERT_EQUAL_INT(EMIT_BUFFER_SIZE, output_length);
+
+    is_busy = FALSE;
+    TEST_ASSERT_TRUE(Emit_Chunk(&stream, EmitRows));
+    TEST_ASSERT_EQUAL_INT(2 * EMIT_BUFFER_SIZE, output_length);
+}
+
+void test_WhenOutputChangesBetweenChunks_ThenStreamEnds(void)
+{
+    EMIT_STREAM_TYPE stream;
+
+    Emit_StreamInit(&stream);
+    TEST_ASSERT_TRUE(Emit_Chunk(&stream, EmitRows));
+
+    /* The sent part changes but not its length */
+    first_value = 9;
+    TEST_ASSERT_FALSE(Emit_Chunk(&stream, EmitRows));
+    TEST_ASSERT_EQUAL_INT(1, num_writes);
+
+    /* The writer is free for the next output */
+    Emit_StreamInit(&stream);
+    TEST_ASSERT_TRUE(Emit_Chunk(&stream, EmitRows));
+    TEST_ASSERT_EQUAL_INT(2, num_writes);
+}
+
+void test_WhenStreamIsBeingSent_ThenOtherStreamWaitsUntilCancel(void)
+{
+    EMIT_STREAM_TYPE first;
+    EMIT_STREAM_TYPE second;
+
+    Emit_StreamInit(&first);
+    Emit_StreamInit(&second);
+    TEST_ASSERT_TRUE(Emit_Chunk(&first, EmitRows));
+
+    TEST_ASSERT_TRUE(Emit_Chunk(&second, EmitRows));
+    TEST_ASSERT_EQUAL_INT(1, num_writes);
+
+    Emit_Cancel(&first);
+    TEST_ASSERT_TRUE(Emit_Chunk(&second, EmitRows));
+    TEST_ASSERT_EQUAL_INT(2, num_writes);
+    TEST_ASSERT_EQUAL_INT(EMIT_BUFFER_SIZE, second.offset);
+}
@@ -0,0 +1,266 @@
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include "unity.h"
+#include "macro.h"
+#include "conparser.h"
+#include "calstore.h"
+#include "mock_nvstore.h"
+
+#define STORE_OFFSET  (offsetof(CAL_EEPROM_TYPE, macros))
+#define HEADER_SIZE   (11)      /* sizeof(MACRO_HEADER_TYPE) */
+
+UINT8 nvstore_test_eeprom[NVSTORE_CAL_EEPROM_SIZE];
+
+static CAL_MACRO_STORE_TYPE *p_store = (CAL_MACRO_STORE_TYPE *) &nvstore_test_eeprom[STORE_OFFSET];
+
+static void WriteBytes(UINT8* const bytes, UINT16 num_bytes, UINT16 offset, int cmock_num_calls)
+{
+    memcpy(&nvstore_test_eeprom[offset], bytes, num_bytes);
+}
+
+static MACRO_RESULT_TYPE RecordStep(const char *text)
+{
+    char line[64];
+    DocoptArgs args;
+
+    strcpy(line, text);
+    TEST_ASSERT_EQUAL_INT(CONPARSER_OK, ConParser_Parse(line, &args));
+    return Macro_Record(&args);
+}
+
+/* Records the macro with the given steps, NULL terminated */
+static void RecordMacro(const char *name, const char *steps[])
+{
+    UINT8 num_steps = 0;
+    UINT8 ii;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Begin(name));
+    for (ii = 0; steps[ii]; ++ii)
+    {
+        TEST_ASSERT_EQUAL_INT(MACRO_OK, RecordStep(steps[ii]));
+    }
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_End(&num_steps));
+    TEST_ASSERT_EQUAL_UINT8(ii, num_steps);
+}
+
+/* Opens the macro and checks the routes of its steps */
+static void AssertMacroSteps(const char *name, CONPARSER_ROUTE_TYPE const routes[], UINT8 num_routes)
+{
+    MACRO_CURSOR_TYPE cursor;
+    DocoptArgs args;
+    UINT8 ii;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Open(name, &cursor));
+    TEST_ASSERT_EQUAL_STRING(name, cursor.name);
+    TEST_ASSERT_EQUAL_UINT8(num_routes, cursor.num_steps);
+    for (ii = 0; ii < num_routes; ++ii)
+    {
+        TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_NextStep(&cursor));
+        TEST_ASSERT_EQUAL_INT(CONPARSER_OK, ConParser_Load(cursor.code, cursor.length, &args));
+        TEST_ASSERT_EQUAL_INT(routes[ii], args.route);
+    }
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_NextStep(&cursor));
+}
+
+static const char *cal_steps[] = {"motor cal left --iters=3", "pid cal left --step=0.2", NULL};
+static const char *show_steps[] = {"config show motor", NULL};
+static const char *bench_steps[] = {"config bench", "motor show right", NULL};
+
+static const CONPARSER_ROUTE_TYPE cal_routes[] = {CONPARSER_ROUTE_MOTOR_CAL, CONPARSER_ROUTE_PID_CAL};
+static const CONPARSER_ROUTE_TYPE show_routes[] = {CONPARSER_ROUTE_CONFIG_SHOW};
+static const CONPARSER_ROUTE_TYPE bench_routes[] = {CONPARSER_ROUTE_CONFIG_BENCH, CONPARSER_ROUTE_MOTOR_SHOW};
+
+void setUp(void)
+{
+    /* Note: erased EEPROM reads as zero, i.e., an empty store */
+    memset(nvstore_test_eeprom, 0, sizeof nvstore_test_eeprom);
+
+    Nvstore_WriteBytes_StubWithCallback(WriteBytes);
+
+    Macro_Init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenMacrosStored_ThenOpenedByNameAndIndex(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+
+    RecordMacro("cal", cal_steps);
+    RecordMacro("show", show_steps);
+
+    AssertMacroSteps("cal", cal_routes, 2);
+    AssertMacroSteps("show", show_routes, 1);
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_OpenIndex(1, &cursor));
+    TEST_ASSERT_EQUAL_STRING("show", cursor.name);
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_OpenIndex(2, &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Open("bench", &cursor));
+    TEST_ASSERT_EQUAL_UINT16(CONPARSER_SIGNATURE, p_store->signature);
+    TEST_ASSERT_EQUAL_UINT16(CAL_MACRO_DATA_SIZE - p_store->length, Macro_GetFree());
+}
+
+void test_WhenMacroRecordedAgain_ThenReplaced(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+
+    RecordMacro("cal", show_steps);
+    RecordMacro("show", show_steps);
+    RecordMacro("cal", cal_steps);
+
+    AssertMacroSteps("cal", cal_routes, 2);
+    /* The macro being recorded is the last one */
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_OpenIndex(1, &cursor));
+    TEST_ASSERT_EQUAL_STRING("cal", cursor.name);
+}
+
+void test_WhenMacroHasNoSteps_ThenRemoved(void)
+{
+    UINT8 num_steps = 0xFF;
+    MACRO_CURSOR_TYPE cursor;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Begin("empty"));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_End(&num_steps));
+
+    TEST_ASSERT_EQUAL_UINT8(0, num_steps);
+    TEST_ASSERT_EQUAL_UINT16(0, p_store->length);
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Open("empty", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_RECORDING, RecordStep("config bench"));
+}
+
+void test_WhenMacroNameInvalid_ThenNotRecording(void)
+{
+    TEST_ASSERT_EQUAL_INT(MACRO_BAD_NAME, Macro_Begin(""));
+    TEST_ASSERT_EQUAL_INT(MACRO_BAD_NAME, Macro_Begin("toolong8"));
+    TEST_ASSERT_FALSE(Macro_IsRecording());
+}
+
+void test_WhenStoreDamaged_ThenMacrosBeforeDamageStillRead(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+    UINT16 second;
+
+    RecordMacro("cal", cal_steps);
+    second = p_store->length;
+    RecordMacro("show", show_steps);
+
+    /* The size of the second macro runs past the store length, e.g., an interrupted write */
+    p_store->data[second] = 0xFF;
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Open("show", &cursor));
+    AssertMacroSteps("cal", cal_routes, 2);
+
+    /* A step length past the end of the macro */
+    p_store->data[HEADER_SIZE] = MACRO_MAX_CODE_LENGTH;
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Open("cal", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_STALE, Macro_NextStep(&cursor));
+
+    /* An empty step */
+    p_store->data[HEADER_SIZE] = 0;
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Open("cal", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_STALE, Macro_NextStep(&cursor));
+}
+
+void test_WhenSignatureDiffers_ThenStoreStaleUntilNextRecord(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+
+    RecordMacro("cal", cal_steps);
+    RecordMacro("show", show_steps);
+    p_store->signature = CONPARSER_SIGNATURE + 1;
+
+    TEST_ASSERT_TRUE(Macro_IsStale());
+    TEST_ASSERT_EQUAL_INT(MACRO_STALE, Macro_Open("cal", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_STALE, Macro_OpenIndex(0, &cursor));
+    TEST_ASSERT_EQUAL_UINT16(CAL_MACRO_DATA_SIZE, Macro_GetFree());
+
+    /* The next record discards the stale macros */
+    RecordMacro("bench", bench_steps);
+
+    TEST_ASSERT_FALSE(Macro_IsStale());
+    AssertMacroSteps("bench", bench_routes, 2);
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Open("cal", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_OpenIndex(1, &cursor));
+}
+
+void test_WhenStoreLengthInvalid_ThenStale(void)
+{
+    RecordMacro("cal", cal_steps);
+    p_store->length = CAL_MACRO_DATA_SIZE + 1;
+
+    TEST_ASSERT_TRUE(Macro_IsStale());
+}
+
+void test_WhenMacroDeleted_ThenFollowingMacrosMovedDown(void)
+{
+    MACRO_CURSOR_TYPE cursor;
+    UINT16 length;
+    UINT16 cal_size;
+
+    RecordMacro("cal", cal_steps);
+    cal_size = p_store->length;
+    RecordMacro("show", show_steps);
+    RecordMacro("bench", bench_steps);
+    length = p_store->length;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Delete("cal"));
+
+    TEST_ASSERT_EQUAL_UINT16(length - cal_size, p_store->length);
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Open("cal", &cursor));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_OpenIndex(0, &cursor));
+    TEST_ASSERT_EQUAL_STRING("show", cursor.name);
+    AssertMacroSteps("show", show_routes, 1);
+    AssertMacroSteps("bench", bench_routes, 2);
+
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Delete("cal"));
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_FOUND, Macro_Delete(NULL));
+}
+
+void test_WhenMacroDeletedWhileRecording_ThenRecordingContinues(void)
+{
+    UINT8 num_steps = 0;
+
+    RecordMacro("cal", cal_steps);
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Begin("bench"));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, RecordStep("config bench"));
+
+    /* The macro being recorded moves down */
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Delete("cal"));
+    TEST_ASSERT_TRUE(Macro_IsRecording());
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, RecordStep("motor show right"));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_End(&num_steps));
+
+    TEST_ASSERT_EQUAL_UINT8(2, num_steps);
+    AssertMacroSteps("bench", bench_routes, 2);
+}
+
+void test_WhenRecordedMacroDeleted_ThenRecordingStops(void)
+{
+    UINT8 num_steps = 0;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Begin("bench"));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, RecordStep("config bench"));
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Delete("bench"));
+
+    TEST_ASSERT_FALSE(Macro_IsRecording());
+    TEST_ASSERT_EQUAL_INT(MACRO_NOT_RECORDING, Macro_End(&num_steps));
+    TEST_ASSERT_EQUAL_UINT16(0, p_store->length);
+}
+
+void test_WhenStoreFull_ThenNoSpace(void)
+{
+    MACRO_RESULT_TYPE result = MACRO_OK;
+    UINT16 ii;
+
+    TEST_ASSERT_EQUAL_INT(MACRO_OK, Macro_Begin("full"));
+    for (ii = 0; ii < CAL_MACRO_DATA_SIZE && result == MACRO_OK; ++ii)
+    {
+        result = RecordStep("motor cal left --iters=3");
+    }
+
+    TEST_ASSERT_EQUAL_INT(MACRO_NO_SPACE, result);
+    TEST_ASSERT_TRUE(p_store->length <= CAL_MACRO_DATA_SIZE);
+    TEST_ASSERT_TRUE(Macro_GetFree() < 1 + MACRO_MAX_CODE_LENGTH);
+}
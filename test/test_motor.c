@@ -10,6 +10,7 @@
 #include "mock_debug.h"
 #include "mock_serial.h"
 #include "mock_control.h"
+#include "mock_time.h"
 #include "motor.h"
 
 void setUp(void)
@@ -120,4 +121,60 @@ void test_WhenMotorStop_ThenSuccessful(void)
     
     // When
     Motor_Stop();
+}
+
+void test_WhenLeftRampDown_ThenStepsToStopOnUpdate(void)
+{
+    /* 20 pwm in steps of 10 over 100 ms, i.e., a step every 50 ms */
+    Left_HB25_PWM_ReadCompare_ExpectAndReturn(1520);
+    millis_ExpectAndReturn(0);
+    
+    // When
+    Motor_LeftRampDown(100);
+    
+    // Then
+    TEST_ASSERT_FALSE(Motor_LeftRampDone());
+    
+    millis_ExpectAndReturn(50);
+    Left_HB25_PWM_ReadCompare_ExpectAndReturn(1520);
+    Left_HB25_PWM_WriteCompare_Expect(1510);
+    millis_ExpectAndReturn(50);
+    
+    // When
+    Motor_Update();
+    
+    // Then
+    TEST_ASSERT_FALSE(Motor_LeftRampDone());
+    
+    millis_ExpectAndReturn(100);
+    Left_HB25_PWM_ReadCompare_ExpectAndReturn(1510);
+    Left_HB25_PWM_WriteCompare_Expect(1500);
+    
+    // When
+    Motor_Update();
+    
+    // Then
+    TEST_ASSERT_TRUE(Motor_LeftRampDone());
+}
+
+void test_WhenMotorStopDuringRamp_ThenRampCanceled(void)
+{
+    Right_HB25_PWM_ReadCompare_ExpectAndReturn(1000);
+    millis_ExpectAndReturn(0);
+    Motor_RightRampDown(1000);
+    
+    Left_HB25_PWM_WriteCompare_Expect(1500);
+    Right_HB25_PWM_WriteCompare_Expect(1500);
+    Left_HB25_PWM_Stop_Expect();
+    Right_HB25_PWM_Stop_Expect();
+    Left_HB25_Enable_Pin_Write_Expect(1);
+    Right_HB25_Enable_Pin_Write_Expect(1);
+    Control_ClearDeviceStatusBit_Expect(STATUS_HB25_CNTRL_INIT_BIT);
+    
+    // When
+    Motor_Stop();
+    Motor_Update();
+    
+    // Then
+    TEST_ASSERT_TRUE(Motor_RightRampDone());
 }
\ No newline at end of file
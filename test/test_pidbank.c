@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "consts.h"
+#include "pidbank.h"
+#include "utils.h"
+#include "angle.h"
+#include "mock_encoder.h"
+#include "mock_motor.h"
+#include "mock_cal.h"
+#include "mock_control.h"
+#include "mock_debug.h"
+#include "mock_serial.h"
+#include "mock_time.h"
+#include "mock_assertion.h"
+
+static UINT8 num_left_writes;
+static FLOAT left_cps;
+static UINT8 num_linear_writes;
+static FLOAT linear_correction;
+static UINT8 num_hook_calls;
+static FLOAT hook_setpoint;
+static FLOAT hook_output;
+
+static PWM_TYPE CpsToPwm_Capture(WHEEL_TYPE wheel, FLOAT cps, int cmock_num_calls)
+{
+    if (wheel == WHEEL_LEFT)
+    {
+        num_left_writes++;
+        left_cps = cps;
+    }
+    return 1500;
+}
+
+static void LinearCorrection_Capture(FLOAT correction, int cmock_num_calls)
+{
+    num_linear_writes++;
+    linear_correction = correction;
+}
+
+static FLOAT TargetForward()
+{
+    return 100.0;
+}
+
+static void SampleHook_Capture(FLOAT setpoint, FLOAT input, FLOAT output, FLOAT iterm)
+{
+    num_hook_calls++;
+    hook_setpoint = setpoint;
+    hook_output = output;
+}
+
+static FLOAT TargetBackward()
+{
+    return -100.0;
+}
+
+static void EnableLeft(FLOAT kp, FLOAT ki, GET_TARGET_FUNC_TYPE target)
+{
+    PidBank_SetGains(PID_TYPE_LEFT, kp, ki, 0.0, 0.0);
+    PidBank_SetTarget(PID_TYPE_LEFT, target);
+    PidBank_Enable(PID_TYPE_LEFT, TRUE);
+}
+
+void setUp(void)
+{
+    num_left_writes = 0;
+    left_cps = 0.0;
+    num_linear_writes = 0;
+    linear_correction = 0.0;
+    num_hook_calls = 0;
+
+    assertion_Ignore();
+    Debug_IsEnabled_IgnoreAndReturn(FALSE);
+    Motor_LeftSetPwm_Ignore();
+    Motor_RightSetPwm_Ignore();
+    Cal_CpsToPwm_StubWithCallback(CpsToPwm_Capture);
+    Control_SetLinearCorrection_StubWithCallback(LinearCorrection_Capture);
+
+    PidBank_Init();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenPidNotEnabled_ThenNoOutput(void)
+{
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_UINT8(0, num_left_writes);
+}
+
+void test_WhenForwardTarget_ThenProportionalOutput(void)
+{
+    EnableLeft(1.0, 0.0, TargetForward);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_UINT8(1, num_left_writes);
+    TEST_ASSERT_EQUAL_FLOAT(60.0, left_cps);
+}
+
+void test_WhenBackwardTarget_ThenOutputHasTargetSign(void)
+{
+    EnableLeft(1.0, 0.0, TargetBackward);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(-40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_FLOAT(-60.0, left_cps);
+}
+
+void test_WhenIntegralGain_ThenIntegratorAccumulates(void)
+{
+    /* Note: ki is scaled by the sample time, i.e., 50.0 * 0.02 = 1.0 per sample */
+    EnableLeft(0.0, PID_SAMPLE_RATE, TargetForward);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 60.0, left_cps);
+
+    PidBank_Process(PID_LOOP_INNER);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 120.0, left_cps);
+}
+
+void test_WhenSampleTimeChanged_ThenIntegralGainIsRediscretized(void)
+{
+    /* Note: at 200 Hz, ki is scaled to 50.0 * 0.005 = 0.25 per sample */
+    EnableLeft(0.0, PID_SAMPLE_RATE, TargetForward);
+    PidBank_SetSampleTime(PID_LOOP_INNER, 0.005);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 15.0, left_cps);
+}
+
+void test_WhenOutputExceedsMax_ThenOutputIsClamped(void)
+{
+    EnableLeft(1000.0, 0.0, TargetForward);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(0.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01, MAX_WHEEL_FORWARD_COUNT_PER_SEC, left_cps);
+}
+
+void test_WhenBypassed_ThenTargetIsOutput(void)
+{
+    EnableLeft(1.0, 0.0, TargetForward);
+    PidBank_Bypass(PID_TYPE_LEFT, TRUE);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_FLOAT(100.0, left_cps);
+}
+
+void test_WhenGainsSet_ThenGainsReturned(void)
+{
+    FLOAT kp;
+    FLOAT ki;
+    FLOAT kd;
+    FLOAT kf;
+
+    PidBank_SetGains(PID_TYPE_RIGHT, 2.9, 2.72, 0.53, 1.0);
+    PidBank_GetGains(PID_TYPE_RIGHT, &kp, &ki, &kd, &kf);
+
+    TEST_ASSERT_EQUAL_FLOAT(2.9, kp);
+    TEST_ASSERT_EQUAL_FLOAT(2.72, ki);
+    TEST_ASSERT_EQUAL_FLOAT(0.53, kd);
+    TEST_ASSERT_EQUAL_FLOAT(1.0, kf);
+}
+
+static void SetLeftSchedule(void)
+{
+    CAL_PID_SCHED_TYPE sched;
+
+    memset(&sched, 0, sizeof sched);
+    sched.num_bands = 2;
+    sched.cps[0] = 100;
+    sched.gains[0].kp = 1.0;
+    sched.cps[1] = 300;
+    sched.gains[1].kp = 3.0;
+
+    Cal_IsPidScheduleValid_IgnoreAndReturn(TRUE);
+    PidBank_SetSchedule(PID_TYPE_LEFT, &sched);
+}
+
+static FLOAT TargetMidSchedule()
+{
+    return 200.0;
+}
+
+void test_WhenScheduledAndTargetBetweenBands_ThenGainsInterpolated(void)
+{
+    EnableLeft(0.0, 0.0, TargetMidSchedule);
+    SetLeftSchedule();
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(100.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    /* kp is halfway between 1.0 and 3.0 */
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 200.0, left_cps);
+}
+
+void test_WhenScheduledAndTargetBelowFirstBand_ThenFirstBandGains(void)
+{
+    FLOAT kp;
+    FLOAT ki;
+    FLOAT kd;
+    FLOAT kf;
+
+    EnableLeft(0.0, 0.0, TargetBackward);
+    SetLeftSchedule();
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(-40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+    PidBank_GetGains(PID_TYPE_LEFT, &kp, &ki, &kd, &kf);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0, kp);
+    TEST_ASSERT_EQUAL_FLOAT(-60.0, left_cps);
+}
+
+static FLOAT TargetLinear()
+{
+    return 0.05;
+}
+
+void test_WhenOuterLoopProcessed_ThenInnerLoopNotProcessed(void)
+{
+    EnableLeft(1.0, 0.0, TargetForward);
+
+    PidBank_Process(PID_LOOP_OUTER);
+
+    TEST_ASSERT_EQUAL_UINT8(0, num_left_writes);
+}
+
+void test_WhenLinearPidEnabled_ThenCorrectionWritten(void)
+{
+    PidBank_SetGains(PID_TYPE_LINEAR, 1.0, 0.0, 0.0, 0.0);
+    PidBank_SetTarget(PID_TYPE_LINEAR, TargetLinear);
+    PidBank_Enable(PID_TYPE_LINEAR, TRUE);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(0.0);
+    Encoder_RightGetCntsPerSec_ExpectAndReturn(0.0);
+
+    PidBank_Process(PID_LOOP_OUTER);
+
+    TEST_ASSERT_EQUAL_UINT8(1, num_linear_writes);
+    TEST_ASSERT_FLOAT_WITHIN(0.0001, 0.05, linear_correction);
+}
+
+void test_WhenLinearPidDisabled_ThenCorrectionCleared(void)
+{
+    PidBank_Enable(PID_TYPE_LINEAR, FALSE);
+
+    TEST_ASSERT_EQUAL_UINT8(1, num_linear_writes);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, linear_correction);
+}
+
+void test_WhenSampleHookSet_ThenCalledWithState(void)
+{
+    EnableLeft(1.0, 0.0, TargetForward);
+    PidBank_SetSampleHook(PID_TYPE_LEFT, SampleHook_Capture);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_UINT8(1, num_hook_calls);
+    TEST_ASSERT_EQUAL_FLOAT(100.0, hook_setpoint);
+    TEST_ASSERT_EQUAL_FLOAT(60.0, hook_output);
+}
+
+void test_WhenSampleHookRemoved_ThenNotCalled(void)
+{
+    EnableLeft(1.0, 0.0, TargetForward);
+    PidBank_SetSampleHook(PID_TYPE_LEFT, SampleHook_Capture);
+    PidBank_SetSampleHook(PID_TYPE_LEFT, NULL);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(40.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_EQUAL_UINT8(0, num_hook_calls);
+}
+
+void test_WhenFeedforwardEnabled_ThenSetpointRateIsFedForward(void)
+{
+    /* Note: the step of 100 cps over 0.02 sec with tau 0.01 sec adds 50 cps on the first sample only */
+    EnableLeft(0.0, 0.0, TargetForward);
+    PidBank_SetFeedforward(PID_TYPE_LEFT, TRUE, 0.01, 0.04);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(100.0);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(100.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 150.0, left_cps);
+
+    PidBank_Process(PID_LOOP_INNER);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 100.0, left_cps);
+}
+
+void test_WhenFeedforwardEnabledAndBackwardTarget_ThenBackwardTimeConstantUsed(void)
+{
+    EnableLeft(0.0, 0.0, TargetBackward);
+    PidBank_SetFeedforward(PID_TYPE_LEFT, TRUE, 0.01, 0.04);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(-100.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -300.0, left_cps);
+}
+
+void test_WhenFeedforwardDisabled_ThenNoFeedforward(void)
+{
+    /* Note: kf is 0.0 (see EnableLeft) */
+    EnableLeft(0.0, 0.0, TargetForward);
+    PidBank_SetFeedforward(PID_TYPE_LEFT, FALSE, 0.01, 0.04);
+    Encoder_LeftGetCntsPerSec_ExpectAndReturn(100.0);
+
+    PidBank_Process(PID_LOOP_INNER);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, left_cps);
+}
@@ -1,15 +0,0 @@
-#include <stdio.h>
-#include "unity.h"
-
-void setUp(void)
-{
-}
-
-void tearDown(void)
-{
-}
-
-void test_NeedImplementation(void)
-{
-    TEST_IGNORE_MESSAGE("Need to Implement Unicycle PID Tests");
-}
\ No newline at end of file
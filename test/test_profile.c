@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <math.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "profile.h"
+#include "mock_serial.h"
+#include "mock_time.h"
+
+#define DT          (0.02)
+#define MAX_TICKS   (1000)
+
+static PROFILE_TYPE profile;
+
+/* Runs the profile to the target and returns the number of ticks until the target is reached */
+static UINT16 RunToTarget(FLOAT target)
+{
+    UINT16 ticks;
+    
+    for (ticks = 1; ticks < MAX_TICKS; ++ticks)
+    {
+        if (Profile_Update(&profile, target, DT) == target)
+        {
+            break;
+        }
+    }
+    
+    return ticks;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenNoJerkLimit_ThenTrapezoidReachesTargetInExactTime(void)
+{
+    UINT16 ticks;
+    
+    Profile_Init(&profile, 1.0, 0.0);
+    ticks = RunToTarget(0.5);
+    
+    /* 0.5 m/s at 1 m/s^2 is 0.5 sec, i.e., 25 ticks */
+    TEST_ASSERT_EQUAL_UINT16(25, ticks);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.5, profile.velocity);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, profile.accel);
+}
+
+void test_WhenJerkLimited_ThenSCurveReachesTargetInExactTime(void)
+{
+    FLOAT exact;
+    FLOAT ramp_time;
+    
+    Profile_Init(&profile, 1.0, 4.0);
+    exact = Profile_RampTime(1.0, 4.0, 1.0);
+    ramp_time = RunToTarget(1.0) * DT;
+    
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 1.25, exact);
+    TEST_ASSERT_FLOAT_WITHIN(2 * DT, exact, ramp_time);
+}
+
+void test_WhenJerkLimited_ThenAccelerationAndJerkAreLimited(void)
+{
+    UINT16 ii;
+    FLOAT last_accel;
+    FLOAT last_velocity;
+    
+    Profile_Init(&profile, 1.0, 4.0);
+    last_accel = 0.0;
+    last_velocity = 0.0;
+    
+    for (ii = 0; ii < 100; ++ii)
+    {
+        Profile_Update(&profile, 1.0, DT);
+        TEST_ASSERT_TRUE(profile.accel <= 1.0 + 1e-6);
+        TEST_ASSERT_TRUE(profile.velocity <= 1.0);
+        TEST_ASSERT_TRUE(profile.velocity >= last_velocity);
+        /* Note: the last tick of the ramp lands on the target with zero acceleration */
+        if (profile.velocity < 1.0)
+        {
+            TEST_ASSERT_TRUE(fabs(profile.accel - last_accel) <= 4.0 * DT + 1e-6);
+        }
+        last_accel = profile.accel;
+        last_velocity = profile.velocity;
+    }
+    
+    TEST_ASSERT_EQUAL_FLOAT(1.0, profile.velocity);
+}
+
+void test_WhenTargetChangesMidRamp_ThenAccelerationDoesNotStep(void)
+{
+    UINT16 ii;
+    FLOAT last_accel;
+    
+    Profile_Init(&profile, 1.0, 4.0);
+    for (ii = 0; ii < 20; ++ii)
+    {
+        Profile_Update(&profile, 1.0, DT);
+    }
+    
+    last_accel = profile.accel;
+    TEST_ASSERT_TRUE(last_accel > 0.5);
+    
+    Profile_Update(&profile, -1.0, DT);
+    
+    TEST_ASSERT_FLOAT_WITHIN(4.0 * DT + 1e-6, last_accel, profile.accel);
+    TEST_ASSERT_TRUE(RunToTarget(-1.0) < MAX_TICKS);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0, profile.velocity);
+}
+
+void test_WhenBackwardRamp_ThenMirrorsForwardRamp(void)
+{
+    UINT16 forward;
+    UINT16 backward;
+    
+    Profile_Init(&profile, 1.0, 4.0);
+    forward = RunToTarget(0.8);
+    
+    Profile_Init(&profile, 1.0, 4.0);
+    backward = RunToTarget(-0.8);
+    
+    TEST_ASSERT_EQUAL_UINT16(forward, backward);
+}
+
+void test_WhenReset_ThenVelocitySetWithoutAcceleration(void)
+{
+    Profile_Init(&profile, 1.0, 4.0);
+    Profile_Update(&profile, 1.0, DT);
+    
+    Profile_Reset(&profile, 0.3);
+    
+    TEST_ASSERT_EQUAL_FLOAT(0.3, profile.velocity);
+    TEST_ASSERT_EQUAL_FLOAT(0.0, profile.accel);
+}
+
+void test_WhenZeroTickTime_ThenProfileUnchanged(void)
+{
+    Profile_Init(&profile, 1.0, 4.0);
+    
+    TEST_ASSERT_EQUAL_FLOAT(0.0, Profile_Update(&profile, 1.0, 0.0));
+}
+
+void test_WhenShortRamp_ThenRampTimeIsTriangular(void)
+{
+    /* 0.1 m/s is below 1^2 / 4 so max acceleration is not reached */
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 2.0 * sqrt(0.1 / 4.0), Profile_RampTime(1.0, 4.0, 0.1));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.5, Profile_RampTime(2.0, 0.0, -1.0));
+}
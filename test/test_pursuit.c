@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <math.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "pursuit.h"
+#include "angle.h"
+#include "mock_odom.h"
+#include "mock_control.h"
+#include "mock_time.h"
+#include "mock_i2cif.h"
+#include "mock_serial.h"
+#include "mock_traj.h"
+
+#define DT_MS       (20)
+#define MAX_TICKS   (5000)
+
+static COMMAND_FUNC_TYPE cmd_func;
+static UINT32 now;
+static FLOAT x_pos;
+static FLOAT y_pos;
+static FLOAT heading;
+static FLOAT linear;
+static FLOAT angular;
+static UINT8 path_control;
+static FLOAT path_points[2 * PATH_WINDOW_NUM_POINTS];
+static UINT8 path_count;
+static BOOL is_traj_owner;
+
+static UINT32 Millis(int cmock_num_calls)
+{
+    return now;
+}
+
+static void GetXYPosition(FLOAT* const x, FLOAT* const y, int cmock_num_calls)
+{
+    *x = x_pos;
+    *y = y_pos;
+}
+
+static FLOAT GetHeading(int cmock_num_calls)
+{
+    return heading;
+}
+
+static void GetProfileLimits(FLOAT* const linear_accel, FLOAT* const linear_jerk,
+                             FLOAT* const angular_accel, FLOAT* const angular_jerk, int cmock_num_calls)
+{
+    *linear_accel = 0.5;
+    *linear_jerk = 2.0;
+    *angular_accel = 2.0;
+    *angular_jerk = 8.0;
+}
+
+static void SetCommandVelocityFunc(COMMAND_FUNC_TYPE cmd, int cmock_num_calls)
+{
+    cmd_func = cmd;
+}
+
+static BOOL TrajOwnsCommand(int cmock_num_calls)
+{
+    return is_traj_owner;
+}
+
+/* Returns the pending path window once, as the I2C interface clears the control after a read */
+static UINT8 ReadPathControl(UINT8* const index, UINT8* const count, FLOAT* const speed, FLOAT* const lookahead,
+                             FLOAT* const points, int cmock_num_calls)
+{
+    UINT8 control = path_control;
+    UINT8 ii;
+
+    *index = 0;
+    *count = path_count;
+    *speed = 0.0;
+    *lookahead = 0.0;
+    for (ii = 0; ii < 2 * PATH_WINDOW_NUM_POINTS; ++ii)
+    {
+        points[ii] = path_points[ii];
+    }
+
+    path_control = 0;
+    return control;
+}
+
+/* Advances the simulated robot one tick at the commanded velocity */
+static void Step()
+{
+    UINT32 timeout;
+    FLOAT dt = DT_MS / 1000.0;
+    FLOAT mid_heading;
+
+    now += DT_MS;
+    Pursuit_Update();
+    if (cmd_func)
+    {
+        cmd_func(&linear, &angular, &timeout);
+    }
+
+    mid_heading = heading + angular * dt / 2;
+    x_pos += linear * cos(mid_heading) * dt;
+    y_pos += linear * sin(mid_heading) * dt;
+    heading = Angle_Wrap(heading + angular * dt);
+}
+
+static FLOAT RunToEnd()
+{
+    PURSUIT_STATUS_TYPE status;
+    FLOAT max_cross_track = 0.0;
+    UINT16 ticks;
+
+    for (ticks = 0; ticks < MAX_TICKS && Pursuit_IsRunning(); ++ticks)
+    {
+        Step();
+        Pursuit_GetStatus(&status);
+        max_cross_track = fmax(max_cross_track, fabs(status.cross_track));
+    }
+
+    return max_cross_track;
+}
+
+void setUp(void)
+{
+    now = 1000;
+    x_pos = 0.0;
+    y_pos = 0.0;
+    heading = 0.0;
+    linear = 0.0;
+    angular = 0.0;
+    cmd_func = NULL;
+    path_control = 0;
+    path_count = 0;
+    is_traj_owner = FALSE;
+
+    millis_StubWithCallback(Millis);
+    Odom_GetXYPosition_StubWithCallback(GetXYPosition);
+    Odom_GetHeading_StubWithCallback(GetHeading);
+    Control_GetProfileLimits_StubWithCallback(GetProfileLimits);
+    Control_SetCommandVelocityFunc_StubWithCallback(SetCommandVelocityFunc);
+    Control_RestoreCommandVelocityFunc_Ignore();
+    I2CIF_ReadPathControl_StubWithCallback(ReadPathControl);
+    I2CIF_WritePathStatus_Ignore();
+    Traj_OwnsCommand_StubWithCallback(TrajOwnsCommand);
+
+    Pursuit_Init();
+    Pursuit_Start();
+    Pursuit_SetSampleTime(DT_MS);
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenStraightPathExecuted_ThenStopsAtEnd(void)
+{
+    PURSUIT_STATUS_TYPE status;
+
+    TEST_ASSERT_TRUE(Pursuit_AddPoint(0.0, 0.0));
+    TEST_ASSERT_TRUE(Pursuit_AddPoint(1.0, 0.0));
+    TEST_ASSERT_TRUE(Pursuit_Execute(0.3, 0.3));
+
+    RunToEnd();
+    Pursuit_GetStatus(&status);
+
+    TEST_ASSERT_EQUAL_INT(PURSUIT_STATE_DONE, status.state);
+    TEST_ASSERT_FLOAT_WITHIN(0.04, 1.0, x_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, y_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 1.0, status.progress);
+}
+
+void test_WhenCornerPathExecuted_ThenStaysNearPath(void)
+{
+    PURSUIT_STATUS_TYPE status;
+    FLOAT max_cross_track;
+
+    Pursuit_AddPoint(0.0, 0.0);
+    Pursuit_AddPoint(1.0, 0.0);
+    Pursuit_AddPoint(1.0, 1.0);
+    TEST_ASSERT_TRUE(Pursuit_Execute(NAN, NAN));
+
+    max_cross_track = RunToEnd();
+    Pursuit_GetStatus(&status);
+
+    TEST_ASSERT_EQUAL_INT(PURSUIT_STATE_DONE, status.state);
+    TEST_ASSERT_EQUAL_INT(1, status.segment);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 1.0, x_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 1.0, y_pos);
+    TEST_ASSERT_TRUE(max_cross_track < 0.15);
+}
+
+void test_WhenWindowUploaded_ThenPointsLoadedAndStarted(void)
+{
+    FLOAT x;
+    FLOAT y;
+
+    path_points[0] = 0.0;
+    path_points[1] = 0.0;
+    path_points[2] = 0.5;
+    path_points[3] = 0.5;
+    path_count = 2;
+    path_control = PATH_CONTROL_LOAD_BIT | PATH_CONTROL_START_BIT;
+
+    Step();
+
+    TEST_ASSERT_TRUE(Pursuit_IsRunning());
+    TEST_ASSERT_TRUE(Pursuit_GetPoint(1, &x, &y));
+    TEST_ASSERT_EQUAL_FLOAT(0.5, x);
+    TEST_ASSERT_EQUAL_FLOAT(0.5, y);
+
+    path_control = PATH_CONTROL_STOP_BIT | PATH_CONTROL_CLEAR_BIT;
+    Step();
+
+    TEST_ASSERT_FALSE(Pursuit_IsRunning());
+    TEST_ASSERT_FALSE(Pursuit_GetPoint(0, &x, &y));
+}
+
+void test_WhenStartIsFarFromPath_ThenNotExecuted(void)
+{
+    x_pos = 0.0;
+    y_pos = 1.0;
+
+    Pursuit_AddPoint(0.0, 0.0);
+    Pursuit_AddPoint(1.0, 0.0);
+
+    TEST_ASSERT_FALSE(Pursuit_Execute(0.2, 0.3));
+    TEST_ASSERT_FALSE(Pursuit_IsRunning());
+}
+
+void test_WhenTrajectoryOwnsCommand_ThenNotExecuted(void)
+{
+    is_traj_owner = TRUE;
+
+    Pursuit_AddPoint(0.0, 0.0);
+    Pursuit_AddPoint(1.0, 0.0);
+
+    TEST_ASSERT_FALSE(Pursuit_Execute(0.2, 0.3));
+    TEST_ASSERT_FALSE(Pursuit_IsRunning());
+    TEST_ASSERT_NULL(cmd_func);
+}
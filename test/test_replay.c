@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "consts.h"
+#include "replay.h"
+#include "control.h"
+#include "motor.h"
+#include "encoder.h"
+#include "pid.h"
+#include "pidbank.h"
+#include "odom.h"
+#include "profile.h"
+#include "angle.h"
+#include "utils.h"
+#include "mock_cal.h"
+#include "mock_debug.h"
+#include "mock_i2cif.h"
+#include "mock_serial.h"
+#include "mock_time.h"
+#include "mock_assertion.h"
+#include "mock_Left_HB25_Enable_Pin.h"
+#include "mock_Right_HB25_Enable_Pin.h"
+#include "mock_Left_HB25_PWM.h"
+#include "mock_Right_HB25_PWM.h"
+#include "mock_Left_QuadDec.h"
+#include "mock_Right_QuadDec.h"
+
+/* A synthetic trace (tools/replay.py synth) whose pwm is the replayed pwm (tools/replay.py rebase) */
+#define SAMPLE_TRACE            "test/traces/sample.csv"
+
+#define MAX_POSITION_ERROR      (0.005)
+#define MAX_HEADING_ERROR       (0.005)
+#define DEFAULT_PWM_TOLERANCE   (2)
+
+/* On the robot, odometry samples at its own offset from the encoder sample; the replay samples in phase */
+#define FIELD_POSITION_ERROR    (0.02)
+#define FIELD_HEADING_ERROR     (0.02)
+
+static REPLAY_TRACE_TYPE trace;
+static REPLAY_RESULT_TYPE result;
+static CAL_PID_SCHED_TYPE no_schedule;
+
+static UINT32 Millis(int cmock_num_calls)
+{
+    return Replay_Millis();
+}
+
+static UINT32 Micros(int cmock_num_calls)
+{
+    return Replay_Millis() * 1000;
+}
+
+static INT32 LeftGetCounter(int cmock_num_calls)
+{
+    return Replay_GetCounter(WHEEL_LEFT);
+}
+
+static INT32 RightGetCounter(int cmock_num_calls)
+{
+    return Replay_GetCounter(WHEEL_RIGHT);
+}
+
+static void LeftSetCounter(INT32 count, int cmock_num_calls)
+{
+    Replay_SetCounter(WHEEL_LEFT, count);
+}
+
+static void RightSetCounter(INT32 count, int cmock_num_calls)
+{
+    Replay_SetCounter(WHEEL_RIGHT, count);
+}
+
+static void LeftWriteCompare(UINT16 compare, int cmock_num_calls)
+{
+    Replay_WritePwm(WHEEL_LEFT, compare);
+}
+
+static void RightWriteCompare(UINT16 compare, int cmock_num_calls)
+{
+    Replay_WritePwm(WHEEL_RIGHT, compare);
+}
+
+static UINT16 LeftReadCompare(int cmock_num_calls)
+{
+    return Replay_ReadPwm(WHEEL_LEFT);
+}
+
+static UINT16 RightReadCompare(int cmock_num_calls)
+{
+    return Replay_ReadPwm(WHEEL_RIGHT);
+}
+
+static void ReadCmdVelocity(FLOAT* const linear, FLOAT* const angular, UINT32* const timeout, int cmock_num_calls)
+{
+    Replay_ReadCmdVelocity(linear, angular, timeout);
+}
+
+static PWM_TYPE CpsToPwm(WHEEL_TYPE wheel, FLOAT cps, int cmock_num_calls)
+{
+    return Replay_CpsToPwm(wheel, cps);
+}
+
+static CAL_PID_TYPE* GetPidGains(PID_ENUM_TYPE pid, int cmock_num_calls)
+{
+    return Replay_GetPidGains(pid);
+}
+
+static CAL_MOTOR_MODEL_TYPE* GetMotorModel(WHEEL_TYPE wheel, DIR_TYPE dir, int cmock_num_calls)
+{
+    return Replay_GetMotorModel(wheel, dir);
+}
+
+/* The robot is calibrated; the outer loop keeps its default gains */
+static UINT16 GetCalibrationStatusBit(UINT16 bit, int cmock_num_calls)
+{
+    return bit == CAL_MOTOR_BIT || bit == CAL_PID_BIT;
+}
+
+static FLOAT GetEnvFloat(char const * const name, FLOAT value)
+{
+    char const *text = getenv(name);
+
+    return text ? atof(text) : value;
+}
+
+void setUp(void)
+{
+    /* Note: the real DiffToUni and UniToDiff (utils.c) assert on their arguments */
+    assertion_Ignore();
+    millis_StubWithCallback(Millis);
+    micros_StubWithCallback(Micros);
+    Left_QuadDec_GetCounter_StubWithCallback(LeftGetCounter);
+    Right_QuadDec_GetCounter_StubWithCallback(RightGetCounter);
+    Left_QuadDec_SetCounter_StubWithCallback(LeftSetCounter);
+    Right_QuadDec_SetCounter_StubWithCallback(RightSetCounter);
+    Left_QuadDec_Start_Ignore();
+    Right_QuadDec_Start_Ignore();
+    Left_HB25_PWM_WriteCompare_StubWithCallback(LeftWriteCompare);
+    Right_HB25_PWM_WriteCompare_StubWithCallback(RightWriteCompare);
+    Left_HB25_PWM_ReadCompare_StubWithCallback(LeftReadCompare);
+    Right_HB25_PWM_ReadCompare_StubWithCallback(RightReadCompare);
+    Left_HB25_PWM_Start_Ignore();
+    Right_HB25_PWM_Start_Ignore();
+    Left_HB25_PWM_Stop_Ignore();
+    Right_HB25_PWM_Stop_Ignore();
+    Left_HB25_Enable_Pin_Write_Ignore();
+    Right_HB25_Enable_Pin_Write_Ignore();
+
+    I2CIF_ReadCmdVelocity_StubWithCallback(ReadCmdVelocity);
+    I2CIF_ReadDeviceControl_IgnoreAndReturn(0);
+    I2CIF_ReadDebugControl_IgnoreAndReturn(0);
+    I2CIF_SetDeviceStatusBit_Ignore();
+    I2CIF_ClearDeviceStatusBit_Ignore();
+    I2CIF_WriteSpeed_Ignore();
+    I2CIF_WritePosition_Ignore();
+    I2CIF_WriteHeading_Ignore();
+
+    Cal_CpsToPwm_StubWithCallback(CpsToPwm);
+    Cal_GetPidGains_StubWithCallback(GetPidGains);
+    Cal_GetMotorModel_StubWithCallback(GetMotorModel);
+    Cal_GetCalibrationStatusBit_StubWithCallback(GetCalibrationStatusBit);
+    Cal_GetPidSchedule_IgnoreAndReturn(&no_schedule);
+    Cal_IsPidScheduleValid_IgnoreAndReturn(FALSE);
+
+    Debug_Enable_Ignore();
+    Debug_Disable_Ignore();
+    Debug_IsEnabled_IgnoreAndReturn(FALSE);
+    Ser_PutString_Ignore();
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenTraceMissing_ThenNotLoaded(void)
+{
+    TEST_ASSERT_FALSE(Replay_Load("test/traces/missing.csv", &trace));
+}
+
+void test_WhenSampleTraceReplayed_ThenEncoderSamplesEachRecord(void)
+{
+    TEST_ASSERT_TRUE(Replay_Load(SAMPLE_TRACE, &trace));
+
+    Replay_Run(&trace, NULL, &result);
+
+    TEST_ASSERT_EQUAL_INT(trace.num_records - 1, result.num_compared);
+    TEST_ASSERT_EQUAL_INT(0, result.num_unsampled);
+    TEST_ASSERT_TRUE(result.timing[REPLAY_MODULE_PID].calls > trace.num_records);
+}
+
+void test_WhenSampleTraceReplayed_ThenPoseMatchesTrace(void)
+{
+    TEST_ASSERT_TRUE(Replay_Load(SAMPLE_TRACE, &trace));
+
+    Replay_Run(&trace, NULL, &result);
+
+    TEST_ASSERT_TRUE(result.max_position_error < MAX_POSITION_ERROR);
+    TEST_ASSERT_TRUE(result.max_heading_error < MAX_HEADING_ERROR);
+}
+
+void test_WhenSampleTraceReplayed_ThenPwmMatchesBaseline(void)
+{
+    TEST_ASSERT_TRUE(Replay_Load(SAMPLE_TRACE, &trace));
+
+    Replay_Run(&trace, NULL, &result);
+
+    TEST_ASSERT_TRUE(result.max_pwm_error <= DEFAULT_PWM_TOLERANCE);
+}
+
+/* Replays the trace given by REPLAY_TRACE (see tools/replay.py run), or the sample trace, optionally writing the
+   pwm and pose to REPLAY_OUTPUT.  The pwm tolerance is REPLAY_PWM_TOLERANCE.
+ */
+void test_WhenTraceReplayed_ThenReplayMatchesTrace(void)
+{
+    char const *path = getenv("REPLAY_TRACE");
+    char const *output_path = getenv("REPLAY_OUTPUT");
+    FILE *output = NULL;
+
+    TEST_ASSERT_TRUE(Replay_Load(path ? path : SAMPLE_TRACE, &trace));
+    if (output_path)
+    {
+        output = fopen(output_path, "w");
+        TEST_ASSERT_NOT_NULL(output);
+    }
+
+    Replay_Run(&trace, output, &result);
+    if (output)
+    {
+        fclose(output);
+    }
+    Replay_PrintResult(&result);
+
+    TEST_ASSERT_EQUAL_INT(0, result.num_unsampled);
+    TEST_ASSERT_TRUE(result.max_position_error < FIELD_POSITION_ERROR);
+    TEST_ASSERT_TRUE(result.max_heading_error < FIELD_HEADING_ERROR);
+    TEST_ASSERT_TRUE(result.max_pwm_error <= GetEnvFloat("REPLAY_PWM_TOLERANCE", DEFAULT_PWM_TOLERANCE));
+}
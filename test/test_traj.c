@@ -0,0 +1,316 @@
+#include <stdio.h>
+#include <math.h>
+#include "unity.h"
+#include "freesoc.h"
+#include "traj.h"
+#include "profile.h"
+#include "angle.h"
+#include "mock_odom.h"
+#include "mock_control.h"
+#include "mock_time.h"
+#include "mock_serial.h"
+#include "mock_pursuit.h"
+
+#define DT_MS       (20)
+#define MAX_TICKS   (5000)
+
+static COMMAND_FUNC_TYPE cmd_func;
+static UINT32 now;
+static BOOL is_stalled;
+static FLOAT x_pos;
+static FLOAT y_pos;
+static FLOAT heading;
+static FLOAT linear;
+static FLOAT angular;
+static BOOL is_path_running;
+static UINT8 num_restores;
+
+static UINT32 Millis(int cmock_num_calls)
+{
+    return now;
+}
+
+static void GetXYPosition(FLOAT* const x, FLOAT* const y, int cmock_num_calls)
+{
+    *x = x_pos;
+    *y = y_pos;
+}
+
+static FLOAT GetHeading(int cmock_num_calls)
+{
+    return heading;
+}
+
+static void GetProfileLimits(FLOAT* const linear_accel, FLOAT* const linear_jerk, 
+                             FLOAT* const angular_accel, FLOAT* const angular_jerk, int cmock_num_calls)
+{
+    *linear_accel = 0.5;
+    *linear_jerk = 2.0;
+    *angular_accel = 2.0;
+    *angular_jerk = 8.0;
+}
+
+static void SetCommandVelocityFunc(COMMAND_FUNC_TYPE cmd, int cmock_num_calls)
+{
+    cmd_func = cmd;
+}
+
+static void RestoreCommandVelocityFunc(int cmock_num_calls)
+{
+    num_restores++;
+}
+
+static BOOL PursuitIsRunning(int cmock_num_calls)
+{
+    return is_path_running;
+}
+
+/* Advances the simulated robot one tick at the commanded velocity */
+static void Step()
+{
+    UINT32 timeout;
+    FLOAT dt = DT_MS / 1000.0;
+    FLOAT mid_heading;
+    
+    now += DT_MS;
+    Traj_Update();
+    cmd_func(&linear, &angular, &timeout);
+    
+    if (!is_stalled)
+    {
+        mid_heading = heading + angular * dt / 2;
+        x_pos += linear * cos(mid_heading) * dt;
+        y_pos += linear * sin(mid_heading) * dt;
+        heading = Angle_Wrap(heading + angular * dt);
+    }
+}
+
+static UINT16 RunToEnd()
+{
+    UINT16 ticks;
+    
+    for (ticks = 0; ticks < MAX_TICKS && Traj_IsRunning(); ++ticks)
+    {
+        Step();
+    }
+    
+    return ticks;
+}
+
+void setUp(void)
+{
+    now = 1000;
+    is_stalled = FALSE;
+    x_pos = 0.0;
+    y_pos = 0.0;
+    heading = 0.0;
+    cmd_func = NULL;
+    is_path_running = FALSE;
+    num_restores = 0;
+    
+    millis_StubWithCallback(Millis);
+    Odom_GetXYPosition_StubWithCallback(GetXYPosition);
+    Odom_GetHeading_StubWithCallback(GetHeading);
+    Control_GetProfileLimits_StubWithCallback(GetProfileLimits);
+    Control_SetCommandVelocityFunc_StubWithCallback(SetCommandVelocityFunc);
+    Control_EnableAcceleration_Ignore();
+    Control_RestoreCommandVelocityFunc_StubWithCallback(RestoreCommandVelocityFunc);
+    Pursuit_IsRunning_StubWithCallback(PursuitIsRunning);
+    
+    Traj_Init();
+    Traj_Start();
+    Traj_SetSampleTime(DT_MS);
+}
+
+void tearDown(void)
+{
+}
+
+void test_WhenLineExecuted_ThenStopsAtDistance(void)
+{
+    TRAJ_STATUS_TYPE status;
+    
+    TEST_ASSERT_TRUE(Traj_AddLine(1.0, 0.3));
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    Traj_GetStatus(&status);
+    
+    TEST_ASSERT_EQUAL_INT(TRAJ_STATE_DONE, status.state);
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 1.0, x_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, linear);
+}
+
+void test_WhenLineBackward_ThenDrivesBackward(void)
+{
+    TEST_ASSERT_TRUE(Traj_AddLine(-0.5, 0.2));
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.005, -0.5, x_pos);
+}
+
+void test_WhenSquareExecuted_ThenReturnsToStart(void)
+{
+    UINT8 ii;
+    
+    for (ii = 0; ii < 4; ++ii)
+    {
+        Traj_AddLine(0.5, 0.3);
+        Traj_AddPause(0.2);
+        Traj_AddTurn(ANGLE_HALFPI, 0.5);
+    }
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FALSE(Traj_IsRunning());
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0.0, x_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0.0, y_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.02, 0.0, heading);
+}
+
+void test_WhenLinesBlended_ThenBoundaryPassedWithoutStopping(void)
+{
+    TRAJ_STATUS_TYPE status;
+    FLOAT exit_speed;
+    
+    Traj_AddLine(0.5, 0.3);
+    Traj_AddLine(0.5, 0.2);
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    exit_speed = Traj_GetSegment(0)->exit_speed;
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.2, exit_speed);
+    
+    do
+    {
+        Step();
+        Traj_GetStatus(&status);
+    } while (status.segment == 0);
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.03, 0.2, linear);
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.005, 1.0, x_pos);
+}
+
+void test_WhenDirectionReverses_ThenNotBlended(void)
+{
+    FLOAT exit_speed;
+    
+    Traj_AddLine(0.5, 0.3);
+    Traj_AddLine(-0.5, 0.3);
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    exit_speed = Traj_GetSegment(0)->exit_speed;
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, exit_speed);
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, x_pos);
+}
+
+void test_WhenShortSegmentFollows_ThenBoundarySpeedLimitedByBraking(void)
+{
+    FLOAT exit_speed;
+    
+    /* The second line is too short to brake from 0.3 m/s at half of 0.5 m/s^2 */
+    Traj_AddLine(0.5, 0.3);
+    Traj_AddLine(0.05, 0.3);
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    exit_speed = Traj_GetSegment(0)->exit_speed;
+    TEST_ASSERT_FLOAT_WITHIN(0.001, sqrt(2 * 0.25 * 0.05), exit_speed);
+}
+
+void test_WhenArcExecuted_ThenEndsOnCircle(void)
+{
+    TEST_ASSERT_TRUE(Traj_AddArc(ANGLE_HALFPI * 0.5, 0.5, 0.2));
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.5, x_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 0.5, y_pos);
+    TEST_ASSERT_FLOAT_WITHIN(0.02, ANGLE_HALFPI, heading);
+}
+
+void test_WhenTurnExceedsHalfCircle_ThenFullAngleTurned(void)
+{
+    TEST_ASSERT_TRUE(Traj_AddTurn(-3 * ANGLE_HALFPI, 1.0));
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    
+    TEST_ASSERT_FLOAT_WITHIN(0.02, ANGLE_HALFPI, heading);
+}
+
+void test_WhenRobotStalls_ThenTrajectoryFails(void)
+{
+    TRAJ_STATUS_TYPE status;
+    
+    is_stalled = TRUE;
+    Traj_AddLine(1.0, 0.3);
+    TEST_ASSERT_TRUE(Traj_Execute());
+    
+    RunToEnd();
+    Traj_GetStatus(&status);
+    
+    TEST_ASSERT_EQUAL_INT(TRAJ_STATE_FAILED, status.state);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0.0, linear);
+}
+
+void test_WhenQueueFullOrRunning_ThenAddFails(void)
+{
+    UINT8 ii;
+    
+    for (ii = 0; ii < TRAJ_MAX_SEGMENTS; ++ii)
+    {
+        TEST_ASSERT_TRUE(Traj_AddPause(0.1));
+    }
+    TEST_ASSERT_FALSE(Traj_AddPause(0.1));
+    
+    Traj_Clear();
+    TEST_ASSERT_FALSE(Traj_Execute());
+    TEST_ASSERT_FALSE(Traj_AddArc(1.0, 0.0, 0.2));
+    
+    Traj_AddLine(1.0, 0.3);
+    Traj_Execute();
+    TEST_ASSERT_FALSE(Traj_AddLine(1.0, 0.3));
+    TEST_ASSERT_FALSE(Traj_Execute());
+    
+    Traj_Stop();
+    TEST_ASSERT_FALSE(Traj_IsRunning());
+}
+
+void test_WhenPathIsRunning_ThenNotExecuted(void)
+{
+    is_path_running = TRUE;
+    Traj_AddLine(1.0, 0.3);
+    
+    TEST_ASSERT_FALSE(Traj_Execute());
+    TEST_ASSERT_FALSE(Traj_OwnsCommand());
+    TEST_ASSERT_NULL(cmd_func);
+}
+
+void test_WhenStopped_ThenCommandVelocityRestoredOnlyIfOwned(void)
+{
+    /* An idle trajectory leaves the command velocity, e.g., to a running path */
+    Traj_Stop();
+    TEST_ASSERT_EQUAL_UINT8(0, num_restores);
+    
+    Traj_AddLine(1.0, 0.3);
+    TEST_ASSERT_TRUE(Traj_Execute());
+    RunToEnd();
+    
+    /* The ended trajectory holds the robot stopped until it is stopped */
+    TEST_ASSERT_TRUE(Traj_OwnsCommand());
+    Traj_Stop();
+    TEST_ASSERT_EQUAL_UINT8(1, num_restores);
+    TEST_ASSERT_FALSE(Traj_OwnsCommand());
+    
+    Traj_Stop();
+    TEST_ASSERT_EQUAL_UINT8(1, num_restores);
+}
@@ -3,45 +3,46 @@
 #include "freesoc.h"
 #include "utils.h"
 #include "consts.h"
+#include "angle.h"
 #include "mock_time.h"
+#include "mock_serial.h"
 #include "mock_assertion.h"
 
 /* Assertion macros - defined to limit line impacts due to code changes, i.e., define once, fix once */
 
-#define LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 363)
-#define RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 364)
-#define LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 397)
-#define ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 398)
+#define LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 364)
+#define RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 365)
+#define LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 398)
+#define ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 399)
 
-#define DATA_POINTS_IS_NOT_NULL() assertion_Expect(1, "data_points is NULL", "source/utils.c", 300)
-#define DATA_POINTS_IS_NULL() assertion_Expect(0, "data_points is NULL", "source/utils.c", 300)
-#define LOWER_INDEX_IS_NOT_NULL() assertion_Expect(1, "lower_index is NULL", "source/utils.c", 301)
-#define LOWER_INDEX_IS_NULL() assertion_Expect(0, "lower_index is NULL", "source/utils.c", 301)
-#define UPPER_INDEX_IS_NOT_NULL() assertion_Expect(1, "upper_index is NULL", "source/utils.c", 302)
-#define UPPER_INDEX_IS_NULL() assertion_Expect(0, "upper_index is NULL", "source/utils.c", 302)
-#define NUM_POINTS_GREATER_THAN_ONE() assertion_Expect(1, "num_points <= 1", "source/utils.c", 303)
-#define NUM_POINTS_LESS_THAN_EQUAL_ONE() assertion_Expect(0, "num_points <= 1", "source/utils.c", 303)
+#define DATA_POINTS_IS_NOT_NULL() assertion_Expect(1, "data_points is NULL", "source/utils.c", 301)
+#define DATA_POINTS_IS_NULL() assertion_Expect(0, "data_points is NULL", "source/utils.c", 301)
+#define LOWER_INDEX_IS_NOT_NULL() assertion_Expect(1, "lower_index is NULL", "source/utils.c", 302)
+#define LOWER_INDEX_IS_NULL() assertion_Expect(0, "lower_index is NULL", "source/utils.c", 302)
+#define UPPER_INDEX_IS_NOT_NULL() assertion_Expect(1, "upper_index is NULL", "source/utils.c", 303)
+#define UPPER_INDEX_IS_NULL() assertion_Expect(0, "upper_index is NULL", "source/utils.c", 303)
+#define NUM_POINTS_GREATER_THAN_ONE() assertion_Expect(1, "num_points <= 1", "source/utils.c", 304)
+#define NUM_POINTS_LESS_THAN_EQUAL_ONE() assertion_Expect(0, "num_points <= 1", "source/utils.c", 304)
 
-#define NUM_POINTS_IS_ODD() assertion_Expect(1, "num_points is not odd", "source/utils.c", 509)
-#define NUM_POINTS_IS_NOT_ODD() assertion_Expect(0, "num_points is not odd", "source/utils.c", 509)
-#define LOWER_LIMIT_LESS_THAN_UPPER_LIMIT() assertion_Expect(1, "lower_limit exceeds upper_limit", "source/utils.c", 511)
-#define LOWER_LIMIT_GREATER_THAN_UPPER_LIMIT() assertion_Expect(0, "lower_limit exceeds upper_limit", "source/utils.c", 511)
-#define LOWER_LIMIT_UPPER_LIMIT_WRONG_DOMAIN() assertion_Expect(0, "lower_limit exceeds upper_limit", "source/utils.c", 511)
+#define NUM_POINTS_IS_ODD() assertion_Expect(1, "num_points is not odd", "source/utils.c", 496)
+#define NUM_POINTS_IS_NOT_ODD() assertion_Expect(0, "num_points is not odd", "source/utils.c", 496)
+#define LOWER_LIMIT_LESS_THAN_UPPER_LIMIT() assertion_Expect(1, "lower_limit exceeds upper_limit", "source/utils.c", 498)
+#define LOWER_LIMIT_GREATER_THAN_UPPER_LIMIT() assertion_Expect(0, "lower_limit exceeds upper_limit", "source/utils.c", 498)
+#define LOWER_LIMIT_UPPER_LIMIT_WRONG_DOMAIN() assertion_Expect(0, "lower_limit exceeds upper_limit", "source/utils.c", 498)
 
-#define UNITODIFF_LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 364)
-#define UNITODIFF_RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 365)
+#define UNITODIFF_LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 365)
+#define UNITODIFF_RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 366)
 
-#define DIFFTOUNI_LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 398)
-#define DIFFTOUNI_ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 399)
+#define DIFFTOUNI_LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 399)
+#define DIFFTOUNI_ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 400)
 
-#define ENSUREANGULARVELOCITY_V_IS_NOT_NULL() assertion_Expect(1, "v is NULL", "source/utils.c", 564)
-#define ENSUREANGULARVELOCITY_W_IS_NOT_NULL() assertion_Expect(1, "w is NULL", "source/utils.c", 565)
-#define ENSUREANGULARVELOCITY_LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 364)
-#define ENSUREANGULARVELOCITY_RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 365)    
-#define ENSUREANGULARVELOCITY_LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 398)
-#define ENSUREANGULARVELOCITY_ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 399)
+#define ENSUREANGULARVELOCITY_V_IS_NOT_NULL() assertion_Expect(1, "v is NULL", "source/utils.c", 551)
+#define ENSUREANGULARVELOCITY_W_IS_NOT_NULL() assertion_Expect(1, "w is NULL", "source/utils.c", 552)
+#define ENSUREANGULARVELOCITY_LEFT_IS_NOT_NULL() assertion_Expect(1, "left is NULL", "source/utils.c", 365)
+#define ENSUREANGULARVELOCITY_RIGHT_IS_NOT_NULL() assertion_Expect(1, "right is NULL", "source/utils.c", 366)    
+#define ENSUREANGULARVELOCITY_LINEAR_IS_NOT_NULL() assertion_Expect(1, "linear is NULL", "source/utils.c", 399)
+#define ENSUREANGULARVELOCITY_ANGULAR_IS_NOT_NULL() assertion_Expect(1, "angular is NULL", "source/utils.c", 400)
 
-#define LIMITLINEARACCEL_LAST_TIME_IS_NOT_NULL() assertion_Expect(1, "last_time is NULL", "source/utils.c", 636)
 
 
 void EnsureAngularVelocity_contract_fulfilled()
@@ -94,7 +95,7 @@ void test_WhenTwoBytePatternValue_ThenValidUint16Value(void)
     {
         printf("Testing [0x%02X, 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], values[ii]);
         
-        assertion_Expect(1, "bytes is null", "source/utils.c", 203);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 204);
         
         // When
         value = TwoBytesToUint16(patterns[ii]);
@@ -118,7 +119,7 @@ void test_WhenTwoBytePatternValue_ThenValidInt16Value(void)
     {
         printf("Testing [0x%02X, 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], values[ii]);
 
-        assertion_Expect(1, "bytes is null", "source/utils.c", 203);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 204);
 
         // When
         value = TwoBytesToInt16(patterns[ii]);
@@ -145,7 +146,7 @@ void test_WhenFourBytePatternValue_ThenValidUint32Value(void)
     {
         printf("Testing [0x%02X 0x%02X 0x%02X 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], patterns[ii][2], patterns[ii][3], values[ii]);
         
-        assertion_Expect(1, "bytes is null", "source/utils.c", 233);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 234);
         
         // When
         value = FourBytesToUint32(patterns[ii]);
@@ -172,7 +173,7 @@ void test_WhenFourBytePatternValue_ThenValidInt32Value(void)
     {
         printf("Testing [0x%02X 0x%02X 0x%02X 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], patterns[ii][2], patterns[ii][3], values[ii]);
         
-        assertion_Expect(1, "bytes is null", "source/utils.c", 233);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 234);
         
         // When
         value = FourBytesToInt32(patterns[ii]);
@@ -199,7 +200,7 @@ void test_WhenUint32Value_ThenValidFourBytePatternValue(void)
     {
         printf("Testing [0x%02X 0x%02X 0x%02X 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], patterns[ii][2], patterns[ii][3], values[ii]);
 
-        assertion_Expect(1, "bytes is null", "source/utils.c", 144);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 145);
 
         // When
         Uint32ToFourBytes(values[ii], actual);
@@ -226,7 +227,7 @@ void test_WhenInt32Value_ThenValidFourBytesValue(void)
     {
         printf("Testing [0x%02X 0x%02X 0x%02X 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], patterns[ii][2], patterns[ii][3], values[ii]);
 
-        assertion_Expect(1, "bytes is null", "source/utils.c", 144);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 145);
 
         // When
         Int32ToFourBytes(values[ii], actual);
@@ -253,7 +254,7 @@ void test_WhenFloatValue_ThenValidFourBytesValue(void)
     {
         printf("Testing [0x%02X 0x%02X 0x%02X 0x%02X] => Expecting %d\n", patterns[ii][0], patterns[ii][1], patterns[ii][2], patterns[ii][3],values[ii]);
 
-        assertion_Expect(1, "bytes is null", "source/utils.c", 182);
+        assertion_Expect(1, "bytes is null", "source/utils.c", 183);
 
         // When
         FloatToFourBytes(values[ii], actual);
@@ -766,8 +767,8 @@ void test_WhenLinearAngularZero_ThenLeftRightZero(void)
 
     //TEST_IGNORE();
     
-    assertion_Expect(1, "left is NULL", "source/utils.c", 364);
-    assertion_Expect(1, "right is NULL", "source/utils.c", 365);
+    assertion_Expect(1, "left is NULL", "source/utils.c", 365);
+    assertion_Expect(1, "right is NULL", "source/utils.c", 366);
     
     // When
     UniToDiff(linear, angular, &left, &right);
@@ -787,8 +788,8 @@ void test_WhenLinearForwardMaxAngularZero_ThenLeftRightMax(void)
 
     //TEST_IGNORE();
     
-    assertion_Expect(1, "left is NULL", "source/utils.c", 364);
-    assertion_Expect(1, "right is NULL", "source/utils.c", 365);
+    assertion_Expect(1, "left is NULL", "source/utils.c", 365);
+    assertion_Expect(1, "right is NULL", "source/utils.c", 366);
     
     // When
     UniToDiff(linear, angular, &left, &right);
@@ -1160,53 +1161,3 @@ void test_WhenBackwardVGreaterThanZeroCWWMatch_ThenEnsureVIs0WUnchanged(void)
     TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.0, v);
     TEST_ASSERT_FLOAT_WITHIN(0.0001f, result, w);
 }
-
-/*-------------------------------------------------------------------------------------------------
-    AdjustVelocity
-  -----------------------------------------------------------------------------------------------*/
-
-void test_WhenNVGreaterThanLVAndNVLessThanMV_ThenNewVelocityAchieved(void)
-{
-    
-    FLOAT result;
-
-    //TEST_IGNORE();
-
-    LIMITLINEARACCEL_LAST_TIME_IS_NOT_NULL();
-    millis_ExpectAndReturn(100);
-    LIMITLINEARACCEL_LAST_TIME_IS_NOT_NULL();
-    millis_ExpectAndReturn(200);
-    
-    // When
-    result = LimitLinearAccel(0.5, 1.0, 0.1);
-    result = LimitLinearAccel(0.5, 1.0, 0.1);
-    
-    // Then
-    TEST_ASSERT_EQUAL_FLOAT(0.5, result);
-
-}
-
-void test_WhenNVLessThanLVAndNVLessThanMV_ThenNewVelocityAchieved(void)
-{
-    
-    FLOAT result;
-
-    //TEST_IGNORE();
-
-    LIMITLINEARACCEL_LAST_TIME_IS_NOT_NULL();
-    millis_ExpectAndReturn(300);
-    LIMITLINEARACCEL_LAST_TIME_IS_NOT_NULL();
-    millis_ExpectAndReturn(400);
-
-    /* Note: the LimitLinearAccel function maintains state.  The test of
-       the deceleration path depends on the previous test to set the 
-       last velocity.  Also, millis must continue to be incremented.
-     */
-    
-    // When
-    result = LimitLinearAccel(0.0, 1.0, 0.1);
-    result = LimitLinearAccel(0.0, 1.0, 0.1);
-    
-    // Then
-    TEST_ASSERT_EQUAL_FLOAT(0.0, result);
-}
\ No newline at end of file
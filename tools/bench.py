@@ -0,0 +1,175 @@
+'''Usage:
+    bench.py run [--opt=<level>] [--shift=<shift>] [--tolerance=<percent>] [--baseline=<baseline>]
+    bench.py baseline [--opt=<level>] [--shift=<shift>] [--baseline=<baseline>]
+    bench.py build [--opt=<level>]
+
+Cross-compiles the control loop hot paths for the Cortex-M3 and measures the
+instructions per call under QEMU (see bench/bench.c).
+
+    run         Builds and runs the benchmarks, and compares the instructions
+                per call against the baseline.  Exits with an error when a
+                benchmark costs more than the baseline plus the tolerance, or
+                when the run does not complete.  Without a baseline, the run is
+                written as the baseline, to be committed.
+    baseline    Builds and runs the benchmarks, and writes the result as the
+                baseline.  Commit the baseline with the change that moves it.
+    build       Builds build/bench/bench.elf only.
+
+The toolchain is arm-none-eabi-gcc (newlib) and qemu-system-arm, or the
+commands given by ARM_GCC and QEMU.  The counts depend on the compiler, so the
+baseline records the compiler and QEMU versions and run warns when they differ.
+
+Options:
+    -O --opt=<level>            Optimization level: s as the Release build, g as
+                                the Debug build [default: s]
+    -s --shift=<shift>          QEMU icount shift, i.e., 2^shift ns per
+                                instruction [default: 10]
+    -t --tolerance=<percent>    Allowed increase of a benchmark [default: 2]
+    -b --baseline=<baseline>    Baseline file, relative to the repository
+                                [default: bench/baseline.json]
+'''
+
+import json
+import os
+import subprocess
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+BUILD_DIR = os.path.join(ROOT, 'build', 'bench')
+ELF = os.path.join(BUILD_DIR, 'bench.elf')
+
+BENCH_SOURCES = ('bench.c', 'hal.c', 'target.c')
+
+# The benchmarked modules and the modules they call (see bench/bench.c)
+FIRMWARE_SOURCES = ('pid_controller.c', 'pidbank.c', 'utils.c', 'caltable.c', 'encoder.c', 'odom.c', 'angle.c',
+                    'conparser.c')
+
+# Note: -fcommon because headers such as cal.h define variables, -iquote so that source/time.h does not hide
+# <time.h>, and --gc-sections because the modules reference functions which are not linked (as the PSoC Creator
+# build with Remove Unused Functions).
+CFLAGS = ['-mcpu=cortex-m3', '-mthumb', '-mfloat-abi=soft', '-g', '-Wall', '-fcommon', '-ffunction-sections',
+          '-fdata-sections', '-iquote', 'source', '-iquote', 'bench', '-I', 'bench']
+LDFLAGS = ['-T', 'bench/lm3s6965.ld', '-nostartfiles', '--specs=nano.specs', '--specs=nosys.specs',
+           '-Wl,--gc-sections', '-lm']
+
+QEMU_TIMEOUT = 120
+
+
+def compiler():
+    return os.environ.get('ARM_GCC', 'arm-none-eabi-gcc')
+
+
+def qemu():
+    return os.environ.get('QEMU', 'qemu-system-arm')
+
+
+def version(command):
+    output = subprocess.check_output([command, '--version'], universal_newlines=True)
+    return output.splitlines()[0]
+
+
+def build(opt):
+    if not os.path.isdir(BUILD_DIR):
+        os.makedirs(BUILD_DIR)
+    sources = [os.path.join('bench', name) for name in BENCH_SOURCES] + \
+              [os.path.join('source', name) for name in FIRMWARE_SOURCES]
+    command = [compiler()] + CFLAGS + ['-O' + opt, '-o', ELF] + sources + LDFLAGS
+    if subprocess.call(command, cwd=ROOT):
+        raise SystemExit('build failed')
+
+
+def run_qemu(shift):
+    '''Returns the calibration and the instructions per call of each benchmark, or None if the run did not complete'''
+    command = [qemu(), '-M', 'lm3s6965evb', '-nographic', '-monitor', 'none',
+               '-serial', 'none', '-semihosting-config', 'enable=on,target=native',
+               '-icount', 'shift=%s,align=off,sleep=off' % shift, '-kernel', ELF]
+    output = subprocess.check_output(command, universal_newlines=True, timeout=QEMU_TIMEOUT)
+
+    calibration = None
+    results = {}
+    done = False
+    for line in output.splitlines():
+        if not line.startswith('{'):
+            continue
+        item = json.loads(line)
+        if 'calibration' in item:
+            calibration = item['calibration']['ticks']
+        elif 'bench' in item:
+            results[item['bench']] = item['insns']
+        elif 'done' in item:
+            done = item['done'] == len(results)
+        elif 'fault' in item:
+            print('fault after %s' % (', '.join(results) or 'start'))
+
+    if not done:
+        return calibration, None
+    return calibration, results
+
+
+def measure(opt, shift):
+    build(opt)
+    calibration, results = run_qemu(shift)
+    if not calibration:
+        raise SystemExit('no calibration, is -icount supported?')
+    if results is None:
+        raise SystemExit('the benchmark did not complete')
+    return results
+
+
+def write_baseline(opt, results, path):
+    with open(path, 'w') as output:
+        json.dump({'compiler': version(compiler()), 'qemu': version(qemu()), 'opt': opt, 'insns': results}, output,
+                  indent=4, sort_keys=True)
+        output.write('\n')
+
+
+def baseline(opt, shift, path):
+    results = measure(opt, shift)
+    write_baseline(opt, results, path)
+    for name in sorted(results):
+        print('%-20s %6d' % (name, results[name]))
+
+
+def run(opt, shift, tolerance, path):
+    results = measure(opt, shift)
+    base = {}
+    if os.path.exists(path):
+        with open(path) as baseline_file:
+            stored = json.load(baseline_file)
+        if stored['opt'] != opt:
+            raise SystemExit('the baseline is for -O%s' % stored['opt'])
+        if stored['compiler'] != version(compiler()):
+            print('warning: the baseline was measured with %s' % stored['compiler'])
+        if stored.get('qemu', '') != version(qemu()):
+            print('warning: the baseline was measured with %s' % stored.get('qemu', 'an unknown QEMU'))
+        base = stored['insns']
+
+    regressions = []
+    print('%-20s %6s %6s %7s' % ('benchmark', 'insns', 'base', 'change'))
+    for name in sorted(results):
+        insns = results[name]
+        if name not in base:
+            print('%-20s %6d %6s %7s' % (name, insns, '-', '-'))
+            continue
+        change = 100.0 * (insns - base[name]) / base[name]
+        print('%-20s %6d %6d %6.1f%%' % (name, insns, base[name], change))
+        if change > tolerance:
+            regressions.append(name)
+
+    if regressions:
+        raise SystemExit('regression: %s' % ', '.join(regressions))
+    if not base:
+        write_baseline(opt, results, path)
+        print('no baseline, wrote %s from this run, commit it' % os.path.relpath(path, ROOT))
+
+
+if __name__ == "__main__":
+    import docopt
+
+    args = docopt.docopt(__doc__)
+    path = os.path.join(ROOT, args['--baseline'])
+    if args['build']:
+        build(args['--opt'])
+    elif args['baseline']:
+        baseline(args['--opt'], args['--shift'], path)
+    elif args['run']:
+        run(args['--opt'], args['--shift'], float(args['--tolerance']), path)
@@ -0,0 +1,144 @@
+'''Usage:
+    calsnap.py export <port> <file> [motor] [pid] [bias] [rate]
+    calsnap.py import <port> <file>
+    calsnap.py show <file>
+
+Saves the calibration snapshot of a robot to a file (config export) and
+provisions another robot of the same build from the file (config import).
+Without sections, all sections (motor, pid, bias and rate) are exported.
+
+The file holds the binary snapshot (see source/calsnap.h):
+    header: magic (0x5343), version, sections, status, length of the records
+    records: EEPROM offset, size, bytes
+    CRC-16/CCITT of the header and the records
+
+The robot checks the CRC and the records before anything is written.  The
+imported motor data and PID gains are applied immediately and the sample
+rates at the next reset.
+
+Options:
+    -h --help       Show this screen
+'''
+
+import base64
+import json
+import struct
+
+import serial
+
+
+HEADER = struct.Struct('<HBBHH')
+RECORD = struct.Struct('<HH')
+MAGIC = 0x5343
+SECTIONS = ('motor', 'pid', 'bias', 'rate')
+CHUNK_LENGTH = 96
+
+
+def crc16(data, crc=0xFFFF):
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def check(snapshot):
+    '''Returns the header of the snapshot, raises ValueError if it is not valid'''
+    magic, version, sections, status, length = HEADER.unpack_from(snapshot)
+    if magic != MAGIC or len(snapshot) != HEADER.size + length + 2:
+        raise ValueError('not a calibration snapshot')
+    crc, = struct.unpack_from('<H', snapshot, len(snapshot) - 2)
+    if crc != crc16(snapshot[:-2]):
+        raise ValueError('CRC mismatch')
+    return version, sections, status, length
+
+
+def records(snapshot):
+    index = HEADER.size
+    while index < len(snapshot) - 2:
+        offset, size = RECORD.unpack_from(snapshot, index)
+        index += RECORD.size
+        yield offset, size
+        index += size
+
+
+class Console(object):
+    '''Sends console commands and reads the JSON response'''
+
+    def __init__(self, port):
+        self.serial = serial.Serial(port=port, baudrate=115200, timeout=5)
+
+    def command(self, line):
+        self.serial.write((line + '\r').encode('ascii'))
+        while True:
+            response = self.serial.readline().decode('ascii', 'replace').strip()
+            if not response:
+                raise IOError('no response to: %s' % line)
+            if response.startswith('{'):
+                return json.loads(response)
+
+    def close(self):
+        self.serial.close()
+
+
+def export_snapshot(port, filename, sections):
+    console = Console(port)
+    try:
+        response = console.command(' '.join(['config export'] + sections))
+    finally:
+        console.close()
+
+    snapshot = base64.b64decode(''.join(response['data']))
+    check(snapshot)
+    with open(filename, 'wb') as f:
+        f.write(snapshot)
+    print('Exported %d bytes to %s' % (len(snapshot), filename))
+
+
+def import_snapshot(port, filename):
+    with open(filename, 'rb') as f:
+        snapshot = f.read()
+    check(snapshot)
+
+    data = base64.b64encode(snapshot).decode('ascii')
+    console = Console(port)
+    try:
+        commands = ['config import begin']
+        commands += ['config import --data=%s' % data[ii:ii + CHUNK_LENGTH]
+                     for ii in range(0, len(data), CHUNK_LENGTH)]
+        commands += ['config import commit']
+        for line in commands:
+            response = console.command(line)
+            if response['result'] != 'ok':
+                console.command('config import abort')
+                raise ValueError('%s: %s' % (line.split('=')[0], response['result']))
+    finally:
+        console.close()
+
+    print('Imported %d bytes, sections: %s' % (len(snapshot), describe(response['sections'])))
+
+
+def describe(sections):
+    return ', '.join(name for ii, name in enumerate(SECTIONS) if sections & (1 << ii))
+
+
+def show(filename):
+    with open(filename, 'rb') as f:
+        snapshot = f.read()
+    version, sections, status, length = check(snapshot)
+
+    print('Version: %d, sections: %s, status: 0x%02x, length: %d' % (version, describe(sections), status, len(snapshot)))
+    for offset, size in records(snapshot):
+        print('    offset: %4d, size: %4d' % (offset, size))
+
+
+if __name__ == "__main__":
+    import docopt
+
+    args = docopt.docopt(__doc__)
+    if args['export']:
+        export_snapshot(args['<port>'], args['<file>'], [name for name in SECTIONS if args[name]])
+    elif args['import']:
+        import_snapshot(args['<port>'], args['<file>'])
+    else:
+        show(args['<file>'])
@@ -0,0 +1,187 @@
+'''Usage:
+    replay.py capture <port> <trace> [--seconds=<seconds>]
+    replay.py convert <log> <trace>
+    replay.py synth <trace>
+    replay.py run <trace> [--output=<output>] [--pwm-tolerance=<pwm>]
+    replay.py rebase <trace> <output>
+
+Captures control loop traces from a robot and replays them through the
+firmware on the host (see source/trace.c and test/support/replay.c).
+
+    capture     Reads the trace of a robot for a number of seconds and writes
+                it as CSV.  Trace debug must be enabled, i.e., bit 0x0020 of the
+                debug control register (or config debug enable trace).  Start
+                the capture with the robot at rest.
+    convert     Converts a serial log holding trace lines to CSV.
+    synth       Writes a synthetic trace: the wheel counts follow the commanded
+                wheel speeds through a first-order lag and the pose is the
+                odometry of the counts.  The pwm is not recorded (0).
+    run         Replays a trace with ceedling (test_replay) and optionally
+                writes the replayed pwm and pose to a CSV file.
+    rebase      Takes the pwm of a replay output as the pwm of the trace.  The
+                pwm of a field trace is produced by the calibration tables, but
+                the replay uses the motor models, so rebase a field trace once
+                and compare later changes against the replayed pwm.
+
+Options:
+    -s --seconds=<seconds>          Capture duration [default: 30]
+    -o --output=<output>            Replay output file
+    -p --pwm-tolerance=<pwm>        Allowed pwm difference [default: 2]
+'''
+
+import json
+import math
+import os
+import subprocess
+import time
+
+COLUMNS = ('time', 'linear', 'angular', 'timeout', 'left_count', 'right_count',
+           'left_pwm', 'right_pwm', 'x', 'y', 'heading')
+
+# Robot geometry, see source/consts.h
+WHEEL_RADIUS = 0.0775
+TRACK_WIDTH = 0.3968
+WHEEL_COUNT_PER_REV = 2000
+
+# Synthetic trace: (seconds, linear, angular) segments and robot settings
+SYNTH_SEGMENTS = ((1.0, 0.0, 0.0), (3.0, 0.2, 0.0), (3.0, 0.15, 0.5), (2.0, -0.1, -0.3), (2.0, 0.0, 0.0))
+SYNTH_PERIODS = (20, 20, 20, 100)
+SYNTH_GAINS = (1.5, 4.0, 0.05, 1.0, 1.5, 4.0, 0.05, 1.0)
+SYNTH_MODELS = (6.3, 0.15, 30, 1, 6.1, 0.15, 32, 1, 6.2, 0.16, 28, 1, 6.0, 0.16, 31, 1)
+SYNTH_LAG = 0.15
+SYNTH_START = 125000
+
+
+def write_trace(path, periods, gains, models, records, comment=None):
+    with open(path, 'w') as trace:
+        if comment:
+            trace.write('# %s\n' % comment)
+        trace.write('# periods,%s\n' % ','.join(str(value) for value in periods))
+        trace.write('# gains,%s\n' % ','.join('%g' % value for value in gains))
+        trace.write('# models,%s\n' % ','.join('%g' % value for value in models))
+        trace.write(','.join(COLUMNS) + '\n')
+        for record in records:
+            trace.write('%d,%.4f,%.4f,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f\n' % tuple(record))
+
+
+def parse_lines(lines):
+    '''Returns the settings and records of the trace lines in a serial log'''
+    settings = {'periods': SYNTH_PERIODS, 'gains': (0.0,) * 8, 'models': (0,) * 16}
+    records = []
+    for line in lines:
+        line = line.strip()
+        if not line.startswith('{"trace'):
+            continue
+        try:
+            item = json.loads(line)
+        except ValueError:
+            # Note: a line can be cut when the capture starts or the serial buffer overflows
+            continue
+        for key, value in item.items():
+            if key == 'trace':
+                records.append(value)
+            elif key.startswith('trace_'):
+                # Note: the settings precede the first record of a trace, so a restart of the trace starts over
+                settings[key[len('trace_'):]] = value
+                records = []
+    return settings, records
+
+
+def capture(port, path, seconds):
+    import serial
+
+    lines = []
+    with serial.Serial(port, 115200, timeout=1) as robot:
+        end = time.time() + seconds
+        while time.time() < end:
+            lines.append(robot.readline().decode('ascii', 'replace'))
+    convert(lines, path)
+
+
+def convert(lines, path):
+    settings, records = parse_lines(lines)
+    if len(records) < 2:
+        raise SystemExit('no trace records, is trace debug enabled?')
+    write_trace(path, settings['periods'], settings['gains'], settings['models'], records)
+    print('%d records, %.1f seconds' % (len(records), (records[-1][0] - records[0][0]) / 1000.0))
+
+
+def synth(path):
+    period = SYNTH_PERIODS[0]
+    counts_per_meter = WHEEL_COUNT_PER_REV / (2 * math.pi * WHEEL_RADIUS)
+    left_speed = right_speed = 0.0
+    left_count = right_count = 0.0
+    x = y = heading = 0.0
+    last_left = last_right = 0
+    now = SYNTH_START
+    records = []
+
+    for seconds, linear, angular in SYNTH_SEGMENTS:
+        for _ in range(int(seconds * 1000 / period)):
+            dt = period / 1000.0
+            alpha = dt / (SYNTH_LAG + dt)
+            left_speed += alpha * (linear - angular * TRACK_WIDTH / 2 - left_speed)
+            right_speed += alpha * (linear + angular * TRACK_WIDTH / 2 - right_speed)
+            left_count += left_speed * dt * counts_per_meter
+            right_count += right_speed * dt * counts_per_meter
+
+            # Same odometry as source/odom.c
+            left, right = int(round(left_count)), int(round(right_count))
+            left_dist = (left - last_left) / counts_per_meter
+            right_dist = (right - last_right) / counts_per_meter
+            last_left, last_right = left, right
+            heading = math.atan2(math.sin(heading + (right_dist - left_dist) / TRACK_WIDTH),
+                                 math.cos(heading + (right_dist - left_dist) / TRACK_WIDTH))
+            x += (left_dist + right_dist) / 2 * math.cos(heading)
+            y += (left_dist + right_dist) / 2 * math.sin(heading)
+
+            records.append((now, linear, angular, 0, left, right, 0, 0, x, y, heading))
+            now += period
+
+    write_trace(path, SYNTH_PERIODS, SYNTH_GAINS, SYNTH_MODELS, records,
+                'synthetic trace (replay.py synth), not a field capture')
+
+
+def run(path, output, pwm_tolerance):
+    env = dict(os.environ, REPLAY_TRACE=os.path.abspath(path), REPLAY_PWM_TOLERANCE=pwm_tolerance)
+    if output:
+        env['REPLAY_OUTPUT'] = os.path.abspath(output)
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    return subprocess.call(['ceedling', 'test:test_replay'], cwd=root, env=env)
+
+
+def rebase(path, output):
+    with open(output) as replay:
+        pwm = {}
+        for line in replay:
+            fields = line.strip().split(',')
+            if fields[0].isdigit():
+                pwm[fields[0]] = fields[1:3]
+
+    lines = []
+    with open(path) as trace:
+        for line in trace:
+            fields = line.rstrip('\n').split(',')
+            if fields[0].isdigit() and fields[0] in pwm:
+                fields[6:8] = pwm[fields[0]]
+            lines.append(','.join(fields) + '\n')
+
+    with open(path, 'w') as trace:
+        trace.writelines(lines)
+
+
+if __name__ == "__main__":
+    import docopt
+
+    args = docopt.docopt(__doc__)
+    if args['capture']:
+        capture(args['<port>'], args['<trace>'], float(args['--seconds']))
+    elif args['convert']:
+        with open(args['<log>']) as log:
+            convert(log, args['<trace>'])
+    elif args['synth']:
+        synth(args['<trace>'])
+    elif args['run']:
+        raise SystemExit(run(args['<trace>'], args['--output'], args['--pwm-tolerance']))
+    elif args['rebase']:
+        rebase(args['<trace>'], args['<output>'])